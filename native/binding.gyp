@@ -2,9 +2,7 @@
   "targets": [
     {
       "target_name": "keyboard",
-      "sources": [
-        "keyboard_mac.c"
-      ],
+      "sources": [],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
       ],
@@ -26,6 +24,26 @@
                 "-framework CoreFoundation",
                 "-framework ApplicationServices"
               ]
+            },
+            "sources": [
+              "keyboard_mac.c"
+            ]
+          }
+        ],
+        [
+          "OS=='linux'",
+          {
+            "cflags": [
+              "-O2"
+            ],
+            "sources": [
+              "keyboard_linux.c"
+            ],
+            "link_settings": {
+              "libraries": [
+                "-lpthread",
+                "-lm"
+              ]
             }
           }
         ]
@@ -34,7 +52,8 @@
     {
       "target_name": "renderer",
       "sources": [
-        "renderer_simd.c"
+        "renderer_simd.c",
+        "job_system.c"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
@@ -50,7 +69,6 @@
               "OTHER_CFLAGS": [
                 "-O3",
                 "-ffast-math",
-                "-march=native",
                 "-funroll-loops",
                 "-ftree-vectorize",
                 "-fno-strict-aliasing"
@@ -66,7 +84,6 @@
             "cflags": [
               "-O3",
               "-ffast-math",
-              "-march=native",
               "-funroll-loops",
               "-ftree-vectorize",
               "-fno-strict-aliasing",
@@ -76,10 +93,56 @@
         ]
       ]
     },
+    {
+      "target_name": "bvh",
+      "sources": [
+        "bvh_simd.c",
+        "job_system.c"
+      ],
+      "include_dirs": [
+        "<!@(node -p \"require('node-addon-api').include\")"
+      ],
+      "defines": [
+        "NAPI_DISABLE_CPP_EXCEPTIONS"
+      ],
+      "conditions": [
+        [
+          "OS=='mac'",
+          {
+            "xcode_settings": {
+              "OTHER_CFLAGS": [
+                "-O3",
+                "-funroll-loops",
+                "-fno-strict-aliasing"
+              ],
+              "MACOSX_DEPLOYMENT_TARGET": "10.15",
+              "GCC_OPTIMIZATION_LEVEL": "3"
+            }
+          }
+        ],
+        [
+          "OS=='linux'",
+          {
+            "cflags": [
+              "-O3",
+              "-funroll-loops",
+              "-fno-strict-aliasing"
+            ],
+            "link_settings": {
+              "libraries": [
+                "-lpthread",
+                "-lm"
+              ]
+            }
+          }
+        ]
+      ]
+    },
     {
       "target_name": "codec2",
       "sources": [
-        "codec2_node.c"
+        "codec2_node.c",
+        "job_system.c"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -70,7 +70,7 @@ function generateBindingGyp(includeCodec2, codec2Info) {
   const targets = [
     {
       target_name: "keyboard",
-      sources: ["keyboard_mac.c"],
+      sources: [],
       include_dirs: [
         "<!@(node -p \"require('node-addon-api').include\")"
       ],
@@ -88,13 +88,42 @@ function generateBindingGyp(includeCodec2, codec2Info) {
               "-framework CoreFoundation",
               "-framework ApplicationServices"
             ]
+          },
+          sources: ["keyboard_mac.c"]
+        }],
+        ["OS=='linux'", {
+          cflags: ["-O2"],
+          sources: ["keyboard_linux.c"],
+          link_settings: {
+            libraries: ["-lpthread", "-lm"]
           }
         }]
       ]
     },
     {
       target_name: "renderer",
-      sources: ["renderer_simd.c"],
+      sources: ["renderer_simd.c", "job_system.c"],
+      include_dirs: [
+        "<!@(node -p \"require('node-addon-api').include\")"
+      ],
+      defines: ["NAPI_DISABLE_CPP_EXCEPTIONS"],
+      conditions: [
+        ["OS=='mac'", {
+          xcode_settings: {
+            OTHER_CFLAGS: ["-O3", "-ffast-math", "-funroll-loops", "-ftree-vectorize", "-fno-strict-aliasing"],
+            MACOSX_DEPLOYMENT_TARGET: "10.15",
+            GCC_OPTIMIZATION_LEVEL: "3"
+          }
+        }],
+        ["OS=='linux'", {
+          cflags: ["-O3", "-ffast-math", "-funroll-loops", "-ftree-vectorize", "-fno-strict-aliasing", "-flto"]
+        }]
+      ]
+    },
+    {
+      // No -ffast-math: the slab test relies on IEEE inf for axis-parallel rays
+      target_name: "bvh",
+      sources: ["bvh_simd.c", "job_system.c"],
       include_dirs: [
         "<!@(node -p \"require('node-addon-api').include\")"
       ],
@@ -102,13 +131,16 @@ function generateBindingGyp(includeCodec2, codec2Info) {
       conditions: [
         ["OS=='mac'", {
           xcode_settings: {
-            OTHER_CFLAGS: ["-O3", "-ffast-math", "-march=native", "-funroll-loops", "-ftree-vectorize", "-fno-strict-aliasing"],
+            OTHER_CFLAGS: ["-O3", "-funroll-loops", "-fno-strict-aliasing"],
             MACOSX_DEPLOYMENT_TARGET: "10.15",
             GCC_OPTIMIZATION_LEVEL: "3"
           }
         }],
         ["OS=='linux'", {
-          cflags: ["-O3", "-ffast-math", "-march=native", "-funroll-loops", "-ftree-vectorize", "-fno-strict-aliasing", "-flto"]
+          cflags: ["-O3", "-funroll-loops", "-fno-strict-aliasing"],
+          link_settings: {
+            libraries: ["-lpthread", "-lm"]
+          }
         }]
       ]
     }
@@ -117,7 +149,7 @@ function generateBindingGyp(includeCodec2, codec2Info) {
   if (includeCodec2 && codec2Info.available) {
     const codec2Target = {
       target_name: "codec2",
-      sources: ["codec2_node.c"],
+      sources: ["codec2_node.c", "job_system.c"],
       include_dirs: [
         "<!@(node -p \"require('node-addon-api').include\")"
       ],
@@ -0,0 +1,1207 @@
+/**
+ * Native BVH and batched raycasts for CS-CLI
+ *
+ * - Binned SAH build (16 bins per axis), large subtrees split across the
+ *   shared job system (job_system.h)
+ * - Binary tree collapsed into a flat 4-wide BVH in depth-first order, so a
+ *   traversal walks memory mostly forwards and tests four child boxes at once
+ * - Leaves hold one packet of up to 4 triangles in SoA layout, tested with a
+ *   4-wide Moller-Trumbore (double-sided, same epsilons as MeshCollision.ts)
+ * - ARM NEON / SSE2 with a scalar fallback
+ * - raycastBatch: all rays of a frame in one N-API call, closest or any hit;
+ *   large batches are traced in parallel on the job system
+ * - querySphere: candidate triangles for capsule/sphere collision
+ * - serializeBVH / mapBVH: the flat tree written into a map cache and mmap'd
+ *   back read-only, so a cached map skips the build entirely
+ * - viewBVH: the flat tree used in place from a (Shared)ArrayBuffer, so
+ *   server room workers share one tree per map
+ *
+ * Each BVH is a napi_external owned by the thread that created it; trees are
+ * read-only after the build, so views of one blob can be traced from several
+ * threads at once.
+ */
+
+#include <node_api.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "job_system.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define USE_NEON 1
+#elif defined(__SSE2__)
+  #include <emmintrin.h>
+  #define USE_SSE2 1
+#endif
+
+#define NAPI_CALL(env, call) do { \
+    napi_status status = (call); \
+    if (status != napi_ok) { \
+      napi_throw_error(env, NULL, "N-API call failed"); \
+      return NULL; \
+    } \
+  } while (0)
+
+// Build configuration
+#define LEAF_SIZE 4              // Triangles per leaf (one SIMD packet)
+#define SAH_BINS 16
+#define MAX_BUILD_DEPTH 48       // Deeper nodes split at the median so depth stays bounded
+#define PARALLEL_MIN_TRIS 4096   // Splits with a smaller half are built on the current thread
+#define TRAVERSAL_STACK 256
+#define RAYCAST_PARALLEL_MIN 256 // Smaller batches are traced on the calling thread
+#define RAYCAST_CHUNK 64
+
+// Batch layouts (match NativeBVH.ts)
+#define RAY_STRIDE 7             // ox, oy, oz, dx, dy, dz, maxDistance
+#define HIT_STRIDE 5             // distance (-1 = miss), triangle index, nx, ny, nz
+
+// Serialized tree (serializeBVH / mapBVH)
+#define BLOB_MAGIC 0x48564251u   // "QBVH"
+#define BLOB_VERSION 1u
+#define BLOB_ALIGN 64            // Section alignment; blobs must start 64-byte aligned in the file
+
+// Same tolerances as rayTriangleIntersection() in MeshCollision.ts
+#define RAY_EPSILON 0.0000001f
+
+// ============================================================================
+// Data structures
+// ============================================================================
+
+typedef struct {
+  float min[3];
+  float max[3];
+} Box;
+
+// Binary node used only during the build
+typedef struct {
+  Box box;
+  int32_t left, right;       // Child node indices (inner nodes)
+  int32_t first, count;      // Triangle range in the index array (leaves, count > 0)
+} BuildNode;
+
+// 4-wide node: child boxes in SoA so one SIMD op tests all four (128 bytes)
+typedef struct {
+  float min_x[4], min_y[4], min_z[4];
+  float max_x[4], max_y[4], max_z[4];
+  int32_t child[4];          // >= 0 inner node, < 0 leaf packet ~index
+  int32_t count;             // Lanes in use (filled from lane 0)
+  int32_t pad[3];
+} QNode;
+
+// Up to four triangles in SoA, edges precomputed (160 bytes)
+typedef struct {
+  float v0x[4], v0y[4], v0z[4];
+  float e1x[4], e1y[4], e1z[4];
+  float e2x[4], e2y[4], e2z[4];
+  int32_t id[4];             // Original triangle index, -1 = padding
+} TriPacket;
+
+typedef struct {
+  QNode* nodes;
+  int node_count;
+  TriPacket* packets;
+  int packet_count;
+  float* normals;            // 3 per triangle
+  int triangle_count;
+  int build_threads;
+  double build_ms;
+  void* mapping;             // mmap'd file backing nodes/packets/normals (NULL = heap)
+  size_t mapping_size;
+  napi_ref backing;          // JS array holding the tree (viewBVH), NULL otherwise
+} BVH;
+
+// Header of a serialized tree; sections follow at 64-byte aligned offsets
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  int32_t node_count;
+  int32_t packet_count;
+  int32_t triangle_count;
+  uint32_t nodes_offset;     // Byte offsets from the start of the blob
+  uint32_t packets_offset;
+  uint32_t normals_offset;
+  uint32_t total_size;
+  uint32_t pad[7];
+} BlobHeader;
+
+// Shared build state
+typedef struct {
+  const float* tris;         // 9 floats per triangle
+  Box* tri_boxes;
+  float* centroids;          // 3 per triangle
+  int32_t* indices;
+  BuildNode* nodes;
+  int node_capacity;
+  int node_count;            // Atomic allocation counter
+  int parallel_splits;       // Atomic, splits whose halves ran as jobs
+} BuildContext;
+
+typedef struct {
+  BuildContext* ctx;
+  int node;
+  int first, count;
+  int depth;
+} BuildTask;
+
+// ============================================================================
+// Build
+// ============================================================================
+
+static void box_empty(Box* b) {
+  b->min[0] = b->min[1] = b->min[2] = FLT_MAX;
+  b->max[0] = b->max[1] = b->max[2] = -FLT_MAX;
+}
+
+static void box_grow(Box* b, const Box* o) {
+  for (int a = 0; a < 3; a++) {
+    if (o->min[a] < b->min[a]) b->min[a] = o->min[a];
+    if (o->max[a] > b->max[a]) b->max[a] = o->max[a];
+  }
+}
+
+static float box_area(const Box* b) {
+  float dx = b->max[0] - b->min[0];
+  float dy = b->max[1] - b->min[1];
+  float dz = b->max[2] - b->min[2];
+  if (dx < 0 || dy < 0 || dz < 0) return 0;
+  return 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+static int alloc_nodes(BuildContext* ctx, int n) {
+  return __atomic_fetch_add(&ctx->node_count, n, __ATOMIC_RELAXED);
+}
+
+static void build_halves(void* arg, int start, int end);
+
+/**
+ * Build the subtree for indices[first, first + count) into node.
+ * When both halves are large they are built as two jobs, so idle workers
+ * pick one up while this thread builds the other.
+ */
+static void build_node(BuildContext* ctx, int node_index, int first, int count, int depth) {
+  BuildNode* node = &ctx->nodes[node_index];
+
+  Box box, cbox;
+  box_empty(&box);
+  box_empty(&cbox);
+  for (int i = first; i < first + count; i++) {
+    int t = ctx->indices[i];
+    box_grow(&box, &ctx->tri_boxes[t]);
+    const float* c = &ctx->centroids[t * 3];
+    Box cb = { { c[0], c[1], c[2] }, { c[0], c[1], c[2] } };
+    box_grow(&cbox, &cb);
+  }
+  node->box = box;
+
+  if (count <= LEAF_SIZE) {
+    node->first = first;
+    node->count = count;
+    node->left = node->right = -1;
+    return;
+  }
+
+  // Binned SAH over all three axes
+  int best_axis = -1, best_split = 0;
+  float best_cost = FLT_MAX;
+
+  if (depth < MAX_BUILD_DEPTH) {
+    for (int axis = 0; axis < 3; axis++) {
+      float lo = cbox.min[axis], hi = cbox.max[axis];
+      if (hi - lo < 1e-6f) continue;
+      float scale = SAH_BINS / (hi - lo);
+
+      Box bin_box[SAH_BINS];
+      int bin_count[SAH_BINS] = { 0 };
+      for (int b = 0; b < SAH_BINS; b++) box_empty(&bin_box[b]);
+
+      for (int i = first; i < first + count; i++) {
+        int t = ctx->indices[i];
+        int b = (int)((ctx->centroids[t * 3 + axis] - lo) * scale);
+        if (b >= SAH_BINS) b = SAH_BINS - 1;
+        bin_count[b]++;
+        box_grow(&bin_box[b], &ctx->tri_boxes[t]);
+      }
+
+      // Sweep from the right, then score each split from the left
+      float right_area[SAH_BINS];
+      int right_count[SAH_BINS];
+      Box acc;
+      box_empty(&acc);
+      int n = 0;
+      for (int b = SAH_BINS - 1; b > 0; b--) {
+        box_grow(&acc, &bin_box[b]);
+        n += bin_count[b];
+        right_area[b] = box_area(&acc);
+        right_count[b] = n;
+      }
+
+      box_empty(&acc);
+      n = 0;
+      for (int b = 0; b < SAH_BINS - 1; b++) {
+        box_grow(&acc, &bin_box[b]);
+        n += bin_count[b];
+        if (n == 0 || right_count[b + 1] == 0) continue;
+        float cost = box_area(&acc) * n + right_area[b + 1] * right_count[b + 1];
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_axis = axis;
+          best_split = b + 1;
+        }
+      }
+    }
+  }
+
+  // Partition in place
+  int mid;
+  if (best_axis >= 0) {
+    float lo = cbox.min[best_axis];
+    float scale = SAH_BINS / (cbox.max[best_axis] - lo);
+    int i = first, j = first + count - 1;
+    while (i <= j) {
+      int b = (int)((ctx->centroids[ctx->indices[i] * 3 + best_axis] - lo) * scale);
+      if (b >= SAH_BINS) b = SAH_BINS - 1;
+      if (b < best_split) {
+        i++;
+      } else {
+        int tmp = ctx->indices[i];
+        ctx->indices[i] = ctx->indices[j];
+        ctx->indices[j] = tmp;
+        j--;
+      }
+    }
+    mid = i;
+  } else {
+    // Coincident centroids or too deep: split the range in half
+    mid = first + count / 2;
+  }
+  if (mid == first || mid == first + count) mid = first + count / 2;
+
+  int children = alloc_nodes(ctx, 2);
+  node->left = children;
+  node->right = children + 1;
+  node->first = 0;
+  node->count = 0;
+
+  int left_count = mid - first;
+  int right_count = first + count - mid;
+
+  if (left_count >= PARALLEL_MIN_TRIS && right_count >= PARALLEL_MIN_TRIS && jobs_worker_count() > 0) {
+    BuildTask tasks[2] = {
+      { ctx, children, first, left_count, depth + 1 },
+      { ctx, children + 1, mid, right_count, depth + 1 },
+    };
+    __atomic_add_fetch(&ctx->parallel_splits, 1, __ATOMIC_RELAXED);
+    jobs_parallel_for(JOB_TAG_COLLISION, build_halves, tasks, 0, 2, 1, 2);
+    return;
+  }
+
+  build_node(ctx, children, first, left_count, depth + 1);
+  build_node(ctx, children + 1, mid, right_count, depth + 1);
+}
+
+static void build_halves(void* arg, int start, int end) {
+  const BuildTask* tasks = (const BuildTask*)arg;
+  for (int i = start; i < end; i++) {
+    build_node(tasks[i].ctx, tasks[i].node, tasks[i].first, tasks[i].count, tasks[i].depth);
+  }
+}
+
+// Fill one SoA packet from a leaf's triangles
+static int emit_packet(BVH* bvh, const BuildContext* ctx, const BuildNode* leaf) {
+  int index = bvh->packet_count++;
+  TriPacket* p = &bvh->packets[index];
+
+  for (int lane = 0; lane < 4; lane++) {
+    if (lane < leaf->count) {
+      int t = ctx->indices[leaf->first + lane];
+      const float* v = &ctx->tris[t * 9];
+      p->v0x[lane] = v[0]; p->v0y[lane] = v[1]; p->v0z[lane] = v[2];
+      p->e1x[lane] = v[3] - v[0]; p->e1y[lane] = v[4] - v[1]; p->e1z[lane] = v[5] - v[2];
+      p->e2x[lane] = v[6] - v[0]; p->e2y[lane] = v[7] - v[1]; p->e2z[lane] = v[8] - v[2];
+      p->id[lane] = t;
+    } else {
+      // Degenerate padding: zero edges never pass the determinant test
+      p->v0x[lane] = p->v0y[lane] = p->v0z[lane] = 0;
+      p->e1x[lane] = p->e1y[lane] = p->e1z[lane] = 0;
+      p->e2x[lane] = p->e2y[lane] = p->e2z[lane] = 0;
+      p->id[lane] = -1;
+    }
+  }
+  return index;
+}
+
+static void set_child_box(QNode* q, int lane, const Box* b) {
+  q->min_x[lane] = b->min[0]; q->min_y[lane] = b->min[1]; q->min_z[lane] = b->min[2];
+  q->max_x[lane] = b->max[0]; q->max_y[lane] = b->max[1]; q->max_z[lane] = b->max[2];
+}
+
+/**
+ * Collapse a binary subtree into 4-wide nodes, depth first.
+ * Inner children with the largest area are opened until four remain.
+ */
+static int collapse(BVH* bvh, const BuildContext* ctx, int bin_index) {
+  int q_index = bvh->node_count++;
+
+  int kids[4];
+  int n = 0;
+  const BuildNode* root = &ctx->nodes[bin_index];
+  if (root->count > 0) {
+    kids[n++] = bin_index;  // Root is itself a leaf
+  } else {
+    kids[n++] = root->left;
+    kids[n++] = root->right;
+    while (n < 4) {
+      int open = -1;
+      float open_area = -1.0f;
+      for (int i = 0; i < n; i++) {
+        const BuildNode* c = &ctx->nodes[kids[i]];
+        if (c->count == 0) {
+          float area = box_area(&c->box);
+          if (area > open_area) {
+            open_area = area;
+            open = i;
+          }
+        }
+      }
+      if (open < 0) break;
+      const BuildNode* c = &ctx->nodes[kids[open]];
+      kids[open] = c->left;
+      kids[n++] = c->right;
+    }
+  }
+
+  // Children are written before recursing so this node's slot stays put
+  bvh->nodes[q_index].count = n;
+  for (int lane = 0; lane < 4; lane++) {
+    QNode* q = &bvh->nodes[q_index];
+    if (lane >= n) {
+      Box empty;
+      box_empty(&empty);
+      set_child_box(q, lane, &empty);
+      q->child[lane] = 0;
+      continue;
+    }
+    const BuildNode* c = &ctx->nodes[kids[lane]];
+    set_child_box(q, lane, &c->box);
+    if (c->count > 0) {
+      q->child[lane] = ~emit_packet(bvh, ctx, c);
+    } else {
+      int child = collapse(bvh, ctx, kids[lane]);
+      bvh->nodes[q_index].child[lane] = child;
+    }
+  }
+  return q_index;
+}
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void bvh_free(BVH* bvh) {
+  if (!bvh) return;
+  if (bvh->mapping) {
+    munmap(bvh->mapping, bvh->mapping_size);
+  } else if (!bvh->backing) {
+    free(bvh->nodes);
+    free(bvh->packets);
+    free(bvh->normals);
+  }
+  free(bvh);
+}
+
+static BVH* bvh_build(const float* tris, int count) {
+  double start = now_ms();
+  BVH* bvh = (BVH*)calloc(1, sizeof(BVH));
+  if (!bvh) return NULL;
+  bvh->triangle_count = count;
+
+  BuildContext ctx;
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.tris = tris;
+  ctx.tri_boxes = (Box*)malloc(sizeof(Box) * (size_t)count);
+  ctx.centroids = (float*)malloc(sizeof(float) * 3 * (size_t)count);
+  ctx.indices = (int32_t*)malloc(sizeof(int32_t) * (size_t)count);
+  ctx.node_capacity = 2 * count;
+  ctx.nodes = (BuildNode*)malloc(sizeof(BuildNode) * (size_t)ctx.node_capacity);
+  bvh->normals = (float*)malloc(sizeof(float) * 3 * (size_t)count);
+  // A 4-wide tree never has more nodes or leaves than the binary one
+  bvh->nodes = (QNode*)aligned_alloc(64, sizeof(QNode) * (size_t)(count > 1 ? count : 1));
+  bvh->packets = (TriPacket*)aligned_alloc(64, sizeof(TriPacket) * (size_t)count);
+
+  if (!ctx.tri_boxes || !ctx.centroids || !ctx.indices || !ctx.nodes ||
+      !bvh->normals || !bvh->nodes || !bvh->packets) {
+    free(ctx.tri_boxes); free(ctx.centroids); free(ctx.indices); free(ctx.nodes);
+    bvh_free(bvh);
+    return NULL;
+  }
+
+  for (int t = 0; t < count; t++) {
+    const float* v = &tris[t * 9];
+    Box* b = &ctx.tri_boxes[t];
+    for (int a = 0; a < 3; a++) {
+      b->min[a] = fminf(v[a], fminf(v[3 + a], v[6 + a]));
+      b->max[a] = fmaxf(v[a], fmaxf(v[3 + a], v[6 + a]));
+      ctx.centroids[t * 3 + a] = (v[a] + v[3 + a] + v[6 + a]) * (1.0f / 3.0f);
+    }
+    ctx.indices[t] = t;
+
+    float e1x = v[3] - v[0], e1y = v[4] - v[1], e1z = v[5] - v[2];
+    float e2x = v[6] - v[0], e2y = v[7] - v[1], e2z = v[8] - v[2];
+    float nx = e1y * e2z - e1z * e2y;
+    float ny = e1z * e2x - e1x * e2z;
+    float nz = e1x * e2y - e1y * e2x;
+    float len = sqrtf(nx * nx + ny * ny + nz * nz);
+    float inv = len > 0 ? 1.0f / len : 0.0f;
+    bvh->normals[t * 3 + 0] = nx * inv;
+    bvh->normals[t * 3 + 1] = ny * inv;
+    bvh->normals[t * 3 + 2] = nz * inv;
+  }
+
+  int root = alloc_nodes(&ctx, 1);
+  build_node(&ctx, root, 0, count, 0);
+  collapse(bvh, &ctx, root);
+
+  // Threads that could take part: this one plus the job system's workers
+  bvh->build_threads = __atomic_load_n(&ctx.parallel_splits, __ATOMIC_RELAXED) > 0 ? 1 + jobs_worker_count() : 1;
+  bvh->build_ms = now_ms() - start;
+
+  free(ctx.tri_boxes);
+  free(ctx.centroids);
+  free(ctx.indices);
+  free(ctx.nodes);
+  return bvh;
+}
+
+// ============================================================================
+// Serialization
+// ============================================================================
+
+static uint32_t align_up(uint32_t v) {
+  return (v + BLOB_ALIGN - 1) & ~(uint32_t)(BLOB_ALIGN - 1);
+}
+
+static void blob_layout(const BVH* bvh, BlobHeader* h) {
+  memset(h, 0, sizeof(*h));
+  h->magic = BLOB_MAGIC;
+  h->version = BLOB_VERSION;
+  h->node_count = bvh->node_count;
+  h->packet_count = bvh->packet_count;
+  h->triangle_count = bvh->triangle_count;
+  h->nodes_offset = align_up(sizeof(BlobHeader));
+  h->packets_offset = align_up(h->nodes_offset + (uint32_t)(sizeof(QNode) * (size_t)bvh->node_count));
+  h->normals_offset = align_up(h->packets_offset + (uint32_t)(sizeof(TriPacket) * (size_t)bvh->packet_count));
+  h->total_size = align_up(h->normals_offset + (uint32_t)(sizeof(float) * 3 * (size_t)bvh->triangle_count));
+}
+
+// Check a blob before traversing it: sizes, and every child index points
+// forwards (depth-first order) inside the arrays, so a corrupt cache can't
+// send traversal out of bounds or round in a cycle
+static bool blob_valid(const uint8_t* base, size_t length) {
+  if (length < sizeof(BlobHeader)) return false;
+  const BlobHeader* h = (const BlobHeader*)base;
+  if (h->magic != BLOB_MAGIC || h->version != BLOB_VERSION) return false;
+  if (h->node_count < 1 || h->packet_count < 1 || h->triangle_count < 1) return false;
+
+  BVH shape;
+  memset(&shape, 0, sizeof(shape));
+  shape.node_count = h->node_count;
+  shape.packet_count = h->packet_count;
+  shape.triangle_count = h->triangle_count;
+  BlobHeader expect;
+  blob_layout(&shape, &expect);
+  if (h->nodes_offset != expect.nodes_offset || h->packets_offset != expect.packets_offset ||
+      h->normals_offset != expect.normals_offset || h->total_size != expect.total_size ||
+      h->total_size > length) {
+    return false;
+  }
+
+  const QNode* nodes = (const QNode*)(base + h->nodes_offset);
+  for (int i = 0; i < h->node_count; i++) {
+    const QNode* q = &nodes[i];
+    if (q->count < 1 || q->count > 4) return false;
+    for (int lane = 0; lane < q->count; lane++) {
+      int32_t c = q->child[lane];
+      if (c >= 0 ? (c <= i || c >= h->node_count) : (~c >= h->packet_count)) return false;
+    }
+  }
+  const TriPacket* packets = (const TriPacket*)(base + h->packets_offset);
+  for (int i = 0; i < h->packet_count; i++) {
+    for (int lane = 0; lane < 4; lane++) {
+      if (packets[i].id[lane] >= h->triangle_count) return false;
+    }
+  }
+  return true;
+}
+
+// ============================================================================
+// Traversal kernels
+// ============================================================================
+
+typedef struct {
+  float ox, oy, oz;
+  float dx, dy, dz;
+  float ix, iy, iz;          // 1 / direction (zero components nudged off zero)
+} RayData;
+
+static float safe_inverse(float d) {
+  if (fabsf(d) < 1e-20f) d = d < 0 ? -1e-20f : 1e-20f;
+  return 1.0f / d;
+}
+
+/**
+ * Test a ray against a node's four child boxes.
+ * Returns a lane mask of hits and writes each lane's entry distance.
+ */
+static int intersect_children(const QNode* q, const RayData* r, float tmax, float* tnear) {
+#if defined(USE_SSE2)
+  __m128 ox = _mm_set1_ps(r->ox), oy = _mm_set1_ps(r->oy), oz = _mm_set1_ps(r->oz);
+  __m128 ix = _mm_set1_ps(r->ix), iy = _mm_set1_ps(r->iy), iz = _mm_set1_ps(r->iz);
+  __m128 tx0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(q->min_x), ox), ix);
+  __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(q->max_x), ox), ix);
+  __m128 ty0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(q->min_y), oy), iy);
+  __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(q->max_y), oy), iy);
+  __m128 tz0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(q->min_z), oz), iz);
+  __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(q->max_z), oz), iz);
+  __m128 t0 = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx0, tx1), _mm_min_ps(ty0, ty1)),
+                         _mm_max_ps(_mm_min_ps(tz0, tz1), _mm_setzero_ps()));
+  __m128 t1 = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx0, tx1), _mm_max_ps(ty0, ty1)),
+                         _mm_min_ps(_mm_max_ps(tz0, tz1), _mm_set1_ps(tmax)));
+  _mm_storeu_ps(tnear, t0);
+  return _mm_movemask_ps(_mm_cmple_ps(t0, t1));
+#elif defined(USE_NEON)
+  float32x4_t ox = vdupq_n_f32(r->ox), oy = vdupq_n_f32(r->oy), oz = vdupq_n_f32(r->oz);
+  float32x4_t ix = vdupq_n_f32(r->ix), iy = vdupq_n_f32(r->iy), iz = vdupq_n_f32(r->iz);
+  float32x4_t tx0 = vmulq_f32(vsubq_f32(vld1q_f32(q->min_x), ox), ix);
+  float32x4_t tx1 = vmulq_f32(vsubq_f32(vld1q_f32(q->max_x), ox), ix);
+  float32x4_t ty0 = vmulq_f32(vsubq_f32(vld1q_f32(q->min_y), oy), iy);
+  float32x4_t ty1 = vmulq_f32(vsubq_f32(vld1q_f32(q->max_y), oy), iy);
+  float32x4_t tz0 = vmulq_f32(vsubq_f32(vld1q_f32(q->min_z), oz), iz);
+  float32x4_t tz1 = vmulq_f32(vsubq_f32(vld1q_f32(q->max_z), oz), iz);
+  float32x4_t t0 = vmaxq_f32(vmaxq_f32(vminq_f32(tx0, tx1), vminq_f32(ty0, ty1)),
+                             vmaxq_f32(vminq_f32(tz0, tz1), vdupq_n_f32(0)));
+  float32x4_t t1 = vminq_f32(vminq_f32(vmaxq_f32(tx0, tx1), vmaxq_f32(ty0, ty1)),
+                             vminq_f32(vmaxq_f32(tz0, tz1), vdupq_n_f32(tmax)));
+  vst1q_f32(tnear, t0);
+  uint32_t m[4];
+  vst1q_u32(m, vcleq_f32(t0, t1));
+  return (m[0] & 1) | (m[1] & 2) | (m[2] & 4) | (m[3] & 8);
+#else
+  int mask = 0;
+  for (int i = 0; i < 4; i++) {
+    float tx0 = (q->min_x[i] - r->ox) * r->ix, tx1 = (q->max_x[i] - r->ox) * r->ix;
+    float ty0 = (q->min_y[i] - r->oy) * r->iy, ty1 = (q->max_y[i] - r->oy) * r->iy;
+    float tz0 = (q->min_z[i] - r->oz) * r->iz, tz1 = (q->max_z[i] - r->oz) * r->iz;
+    float t0 = fmaxf(fmaxf(fminf(tx0, tx1), fminf(ty0, ty1)), fmaxf(fminf(tz0, tz1), 0.0f));
+    float t1 = fminf(fminf(fmaxf(tx0, tx1), fmaxf(ty0, ty1)), fminf(fmaxf(tz0, tz1), tmax));
+    tnear[i] = t0;
+    if (t0 <= t1) mask |= 1 << i;
+  }
+  return mask;
+#endif
+}
+
+/**
+ * 4-wide Moller-Trumbore against one packet.
+ * Returns the lane with the nearest hit closer than tmax (or -1) and writes its distance.
+ */
+static int intersect_packet(const TriPacket* p, const RayData* r, float tmax, float* t_out) {
+  float t[4];
+  int mask;
+#if defined(USE_SSE2)
+  __m128 dx = _mm_set1_ps(r->dx), dy = _mm_set1_ps(r->dy), dz = _mm_set1_ps(r->dz);
+  __m128 e1x = _mm_load_ps(p->e1x), e1y = _mm_load_ps(p->e1y), e1z = _mm_load_ps(p->e1z);
+  __m128 e2x = _mm_load_ps(p->e2x), e2y = _mm_load_ps(p->e2y), e2z = _mm_load_ps(p->e2z);
+  // h = d x e2, a = e1 . h
+  __m128 hx = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+  __m128 hy = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+  __m128 hz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+  __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, hx), _mm_mul_ps(e1y, hy)), _mm_mul_ps(e1z, hz));
+  __m128 abs_a = _mm_andnot_ps(_mm_set1_ps(-0.0f), a);
+  __m128 valid = _mm_cmpge_ps(abs_a, _mm_set1_ps(RAY_EPSILON));
+  __m128 f = _mm_div_ps(_mm_set1_ps(1.0f), a);
+  // s = o - v0, u = f (s . h)
+  __m128 sx = _mm_sub_ps(_mm_set1_ps(r->ox), _mm_load_ps(p->v0x));
+  __m128 sy = _mm_sub_ps(_mm_set1_ps(r->oy), _mm_load_ps(p->v0y));
+  __m128 sz = _mm_sub_ps(_mm_set1_ps(r->oz), _mm_load_ps(p->v0z));
+  __m128 u = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, hx), _mm_mul_ps(sy, hy)), _mm_mul_ps(sz, hz)));
+  // q = s x e1, v = f (d . q), t = f (e2 . q)
+  __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+  __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+  __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+  __m128 v = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)));
+  __m128 tt = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)));
+  __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+  valid = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+  valid = _mm_and_ps(valid, _mm_cmple_ps(u, one));
+  valid = _mm_and_ps(valid, _mm_cmpge_ps(v, zero));
+  valid = _mm_and_ps(valid, _mm_cmple_ps(_mm_add_ps(u, v), one));
+  valid = _mm_and_ps(valid, _mm_cmpgt_ps(tt, _mm_set1_ps(RAY_EPSILON)));
+  valid = _mm_and_ps(valid, _mm_cmple_ps(tt, _mm_set1_ps(tmax)));
+  _mm_storeu_ps(t, tt);
+  mask = _mm_movemask_ps(valid);
+#elif defined(USE_NEON)
+  float32x4_t dx = vdupq_n_f32(r->dx), dy = vdupq_n_f32(r->dy), dz = vdupq_n_f32(r->dz);
+  float32x4_t e1x = vld1q_f32(p->e1x), e1y = vld1q_f32(p->e1y), e1z = vld1q_f32(p->e1z);
+  float32x4_t e2x = vld1q_f32(p->e2x), e2y = vld1q_f32(p->e2y), e2z = vld1q_f32(p->e2z);
+  float32x4_t hx = vsubq_f32(vmulq_f32(dy, e2z), vmulq_f32(dz, e2y));
+  float32x4_t hy = vsubq_f32(vmulq_f32(dz, e2x), vmulq_f32(dx, e2z));
+  float32x4_t hz = vsubq_f32(vmulq_f32(dx, e2y), vmulq_f32(dy, e2x));
+  float32x4_t a = vaddq_f32(vaddq_f32(vmulq_f32(e1x, hx), vmulq_f32(e1y, hy)), vmulq_f32(e1z, hz));
+  uint32x4_t valid = vcgeq_f32(vabsq_f32(a), vdupq_n_f32(RAY_EPSILON));
+  // Lanes with a == 0 produce inf/nan here and are masked out by valid
+  float32x4_t f = vrecpeq_f32(a);
+  f = vmulq_f32(f, vrecpsq_f32(a, f));
+  f = vmulq_f32(f, vrecpsq_f32(a, f));
+  float32x4_t sx = vsubq_f32(vdupq_n_f32(r->ox), vld1q_f32(p->v0x));
+  float32x4_t sy = vsubq_f32(vdupq_n_f32(r->oy), vld1q_f32(p->v0y));
+  float32x4_t sz = vsubq_f32(vdupq_n_f32(r->oz), vld1q_f32(p->v0z));
+  float32x4_t u = vmulq_f32(f, vaddq_f32(vaddq_f32(vmulq_f32(sx, hx), vmulq_f32(sy, hy)), vmulq_f32(sz, hz)));
+  float32x4_t qx = vsubq_f32(vmulq_f32(sy, e1z), vmulq_f32(sz, e1y));
+  float32x4_t qy = vsubq_f32(vmulq_f32(sz, e1x), vmulq_f32(sx, e1z));
+  float32x4_t qz = vsubq_f32(vmulq_f32(sx, e1y), vmulq_f32(sy, e1x));
+  float32x4_t v = vmulq_f32(f, vaddq_f32(vaddq_f32(vmulq_f32(dx, qx), vmulq_f32(dy, qy)), vmulq_f32(dz, qz)));
+  float32x4_t tt = vmulq_f32(f, vaddq_f32(vaddq_f32(vmulq_f32(e2x, qx), vmulq_f32(e2y, qy)), vmulq_f32(e2z, qz)));
+  float32x4_t zero = vdupq_n_f32(0), one = vdupq_n_f32(1.0f);
+  valid = vandq_u32(valid, vcgeq_f32(u, zero));
+  valid = vandq_u32(valid, vcleq_f32(u, one));
+  valid = vandq_u32(valid, vcgeq_f32(v, zero));
+  valid = vandq_u32(valid, vcleq_f32(vaddq_f32(u, v), one));
+  valid = vandq_u32(valid, vcgtq_f32(tt, vdupq_n_f32(RAY_EPSILON)));
+  valid = vandq_u32(valid, vcleq_f32(tt, vdupq_n_f32(tmax)));
+  vst1q_f32(t, tt);
+  uint32_t m[4];
+  vst1q_u32(m, valid);
+  mask = (m[0] & 1) | (m[1] & 2) | (m[2] & 4) | (m[3] & 8);
+#else
+  mask = 0;
+  for (int i = 0; i < 4; i++) {
+    float hx = r->dy * p->e2z[i] - r->dz * p->e2y[i];
+    float hy = r->dz * p->e2x[i] - r->dx * p->e2z[i];
+    float hz = r->dx * p->e2y[i] - r->dy * p->e2x[i];
+    float a = p->e1x[i] * hx + p->e1y[i] * hy + p->e1z[i] * hz;
+    if (fabsf(a) < RAY_EPSILON) continue;
+    float f = 1.0f / a;
+    float sx = r->ox - p->v0x[i], sy = r->oy - p->v0y[i], sz = r->oz - p->v0z[i];
+    float u = f * (sx * hx + sy * hy + sz * hz);
+    if (u < 0.0f || u > 1.0f) continue;
+    float qx = sy * p->e1z[i] - sz * p->e1y[i];
+    float qy = sz * p->e1x[i] - sx * p->e1z[i];
+    float qz = sx * p->e1y[i] - sy * p->e1x[i];
+    float v = f * (r->dx * qx + r->dy * qy + r->dz * qz);
+    if (v < 0.0f || u + v > 1.0f) continue;
+    t[i] = f * (p->e2x[i] * qx + p->e2y[i] * qy + p->e2z[i] * qz);
+    if (t[i] > RAY_EPSILON && t[i] <= tmax) mask |= 1 << i;
+  }
+#endif
+
+  int best = -1;
+  for (int i = 0; i < 4; i++) {
+    if ((mask & (1 << i)) && t[i] <= tmax) {
+      tmax = t[i];
+      best = i;
+    }
+  }
+  if (best >= 0) *t_out = tmax;
+  return best;
+}
+
+/**
+ * Trace one ray. Returns the hit triangle index (or -1) and its distance.
+ * any_hit stops at the first hit (occlusion / line of sight).
+ */
+static int trace_ray(const BVH* bvh, const RayData* r, float max_dist, bool any_hit, float* t_out) {
+  int stack[TRAVERSAL_STACK];
+  int sp = 0;
+  stack[sp++] = 0;
+
+  float tmax = max_dist;
+  int hit = -1;
+
+  while (sp > 0) {
+    const QNode* q = &bvh->nodes[stack[--sp]];
+    float tnear[4];
+    // Empty lanes can still pass the slab test for axis-parallel rays
+    int mask = intersect_children(q, r, tmax, tnear) & ((1 << q->count) - 1);
+    if (!mask) continue;
+
+    // Push hit children far to near so the nearest is traversed first
+    int order[4], n = 0;
+    for (int i = 0; i < 4; i++) {
+      if (!(mask & (1 << i))) continue;
+      int j = n++;
+      while (j > 0 && tnear[order[j - 1]] < tnear[i]) {
+        order[j] = order[j - 1];
+        j--;
+      }
+      order[j] = i;
+    }
+
+    for (int k = 0; k < n; k++) {
+      int child = q->child[order[k]];
+      if (child >= 0) {
+        if (sp < TRAVERSAL_STACK) stack[sp++] = child;
+        continue;
+      }
+      // Leaves are tested immediately so tmax shrinks before siblings are visited
+      const TriPacket* p = &bvh->packets[~child];
+      float t;
+      int lane = intersect_packet(p, r, tmax, &t);
+      if (lane >= 0) {
+        tmax = t;
+        hit = p->id[lane];
+        if (any_hit) {
+          *t_out = tmax;
+          return hit;
+        }
+      }
+    }
+  }
+
+  *t_out = tmax;
+  return hit;
+}
+
+static bool sphere_overlaps_box(const QNode* q, int i, float cx, float cy, float cz, float r2) {
+  float px = fmaxf(q->min_x[i], fminf(cx, q->max_x[i]));
+  float py = fmaxf(q->min_y[i], fminf(cy, q->max_y[i]));
+  float pz = fmaxf(q->min_z[i], fminf(cz, q->max_z[i]));
+  float dx = px - cx, dy = py - cy, dz = pz - cz;
+  return dx * dx + dy * dy + dz * dz <= r2;
+}
+
+// ============================================================================
+// N-API
+// ============================================================================
+
+static void finalize_bvh(napi_env env, void* data, void* hint) {
+  BVH* bvh = (BVH*)data;
+  if (bvh && bvh->backing) napi_delete_reference(env, bvh->backing);
+  bvh_free(bvh);
+}
+
+static BVH* get_bvh(napi_env env, napi_value value) {
+  void* data = NULL;
+  if (napi_get_value_external(env, value, &data) != napi_ok || !data) {
+    napi_throw_type_error(env, NULL, "Expected a BVH handle from createBVH");
+    return NULL;
+  }
+  return (BVH*)data;
+}
+
+static float* get_float_array(napi_env env, napi_value value, size_t* length) {
+  napi_typedarray_type type;
+  void* data = NULL;
+  bool is_typed = false;
+  if (napi_is_typedarray(env, value, &is_typed) != napi_ok || !is_typed ||
+      napi_get_typedarray_info(env, value, &type, length, &data, NULL, NULL) != napi_ok ||
+      type != napi_float32_array) {
+    napi_throw_type_error(env, NULL, "Expected a Float32Array");
+    return NULL;
+  }
+  return (float*)data;
+}
+
+/**
+ * createBVH(triangles: Float32Array) -> handle
+ * 9 floats per triangle (v0, v1, v2). Triangle indices in results refer to this order.
+ */
+static napi_value bvh_create(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  if (argc < 1) {
+    napi_throw_error(env, NULL, "Expected triangles");
+    return NULL;
+  }
+
+  size_t length;
+  float* tris = get_float_array(env, args[0], &length);
+  if (!tris) return NULL;
+  int count = (int)(length / 9);
+  if (count == 0) {
+    napi_throw_range_error(env, NULL, "createBVH needs at least one triangle");
+    return NULL;
+  }
+
+  BVH* bvh = bvh_build(tris, count);
+  if (!bvh) {
+    napi_throw_error(env, NULL, "Failed to allocate BVH");
+    return NULL;
+  }
+
+  napi_value result;
+  if (napi_create_external(env, bvh, finalize_bvh, NULL, &result) != napi_ok) {
+    bvh_free(bvh);
+    napi_throw_error(env, NULL, "Failed to create BVH handle");
+    return NULL;
+  }
+  return result;
+}
+
+typedef struct {
+  const BVH* bvh;
+  const float* rays;
+  float* hits;
+  bool any_hit;
+} RaycastJob;
+
+// Trace rays [start, end) of a raycastBatch() call (job system range callback)
+static void trace_rays(void* arg, int start, int end) {
+  const RaycastJob* job = (const RaycastJob*)arg;
+  const BVH* bvh = job->bvh;
+  for (int i = start; i < end; i++) {
+    const float* in = &job->rays[(size_t)i * RAY_STRIDE];
+    float* out = &job->hits[(size_t)i * HIT_STRIDE];
+    RayData r = {
+      in[0], in[1], in[2],
+      in[3], in[4], in[5],
+      safe_inverse(in[3]), safe_inverse(in[4]), safe_inverse(in[5]),
+    };
+    float max_dist = in[6] > 0 ? in[6] : 0;
+    if (isinf(max_dist) || max_dist > FLT_MAX) max_dist = FLT_MAX;
+
+    float t;
+    int tri = trace_ray(bvh, &r, max_dist, job->any_hit, &t);
+    if (tri >= 0) {
+      out[0] = t;
+      out[1] = (float)tri;
+      out[2] = bvh->normals[tri * 3 + 0];
+      out[3] = bvh->normals[tri * 3 + 1];
+      out[4] = bvh->normals[tri * 3 + 2];
+    } else {
+      out[0] = -1.0f;
+      out[1] = -1.0f;
+      out[2] = out[3] = out[4] = 0.0f;
+    }
+  }
+}
+
+/**
+ * raycastBatch(handle, rays: Float32Array, hits: Float32Array, anyHit?: boolean) -> ray count
+ * rays: RAY_STRIDE floats each (direction need not be normalized; distance is
+ * in units of its length). hits: HIT_STRIDE floats each.
+ */
+static napi_value bvh_raycast_batch(napi_env env, napi_callback_info info) {
+  size_t argc = 4;
+  napi_value args[4];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  if (argc < 3) {
+    napi_throw_error(env, NULL, "Expected handle, rays, hits");
+    return NULL;
+  }
+
+  BVH* bvh = get_bvh(env, args[0]);
+  if (!bvh) return NULL;
+  size_t ray_len, hit_len;
+  float* rays = get_float_array(env, args[1], &ray_len);
+  if (!rays) return NULL;
+  float* hits = get_float_array(env, args[2], &hit_len);
+  if (!hits) return NULL;
+  bool any_hit = false;
+  if (argc >= 4) napi_get_value_bool(env, args[3], &any_hit);
+
+  size_t count = ray_len / RAY_STRIDE;
+  if (hit_len < count * HIT_STRIDE) {
+    napi_throw_range_error(env, NULL, "hits buffer is too small for the rays");
+    return NULL;
+  }
+  if (count > INT32_MAX) count = INT32_MAX;
+
+  RaycastJob job = { bvh, rays, hits, any_hit };
+  jobs_parallel_for(JOB_TAG_COLLISION, trace_rays, &job, 0, (int)count, RAYCAST_CHUNK, RAYCAST_PARALLEL_MIN);
+
+  napi_value result;
+  NAPI_CALL(env, napi_create_uint32(env, (uint32_t)count, &result));
+  return result;
+}
+
+/**
+ * querySphere(handle, x, y, z, radius, out: Int32Array) -> count
+ * Writes indices of triangles in leaves overlapping the sphere (a superset of
+ * the triangles touching it). Stops when out is full.
+ */
+static napi_value bvh_query_sphere(napi_env env, napi_callback_info info) {
+  size_t argc = 6;
+  napi_value args[6];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  if (argc < 6) {
+    napi_throw_error(env, NULL, "Expected handle, x, y, z, radius, out");
+    return NULL;
+  }
+
+  BVH* bvh = get_bvh(env, args[0]);
+  if (!bvh) return NULL;
+  double cx, cy, cz, radius;
+  NAPI_CALL(env, napi_get_value_double(env, args[1], &cx));
+  NAPI_CALL(env, napi_get_value_double(env, args[2], &cy));
+  NAPI_CALL(env, napi_get_value_double(env, args[3], &cz));
+  NAPI_CALL(env, napi_get_value_double(env, args[4], &radius));
+
+  napi_typedarray_type type;
+  size_t capacity;
+  int32_t* out;
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[5], &type, &capacity, (void**)&out, NULL, NULL));
+  if (type != napi_int32_array) {
+    napi_throw_type_error(env, NULL, "querySphere expects an Int32Array");
+    return NULL;
+  }
+
+  float fx = (float)cx, fy = (float)cy, fz = (float)cz;
+  float r2 = (float)(radius * radius);
+  size_t count = 0;
+
+  int stack[TRAVERSAL_STACK];
+  int sp = 0;
+  stack[sp++] = 0;
+  while (sp > 0 && count < capacity) {
+    const QNode* q = &bvh->nodes[stack[--sp]];
+    for (int i = 0; i < q->count; i++) {
+      if (!sphere_overlaps_box(q, i, fx, fy, fz, r2)) continue;
+      int child = q->child[i];
+      if (child >= 0) {
+        if (sp < TRAVERSAL_STACK) stack[sp++] = child;
+        continue;
+      }
+      const TriPacket* p = &bvh->packets[~child];
+      for (int lane = 0; lane < 4 && count < capacity; lane++) {
+        if (p->id[lane] >= 0) out[count++] = p->id[lane];
+      }
+    }
+  }
+
+  napi_value result;
+  NAPI_CALL(env, napi_create_uint32(env, (uint32_t)count, &result));
+  return result;
+}
+
+/**
+ * getStats(handle) -> { triangles, nodes, leaves, buildMs, buildThreads, bytes, mapped }
+ */
+static napi_value bvh_get_stats(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  if (argc < 1) {
+    napi_throw_error(env, NULL, "Expected handle");
+    return NULL;
+  }
+  BVH* bvh = get_bvh(env, args[0]);
+  if (!bvh) return NULL;
+
+  napi_value result, v;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_create_int32(env, bvh->triangle_count, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "triangles", v));
+  NAPI_CALL(env, napi_create_int32(env, bvh->node_count, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "nodes", v));
+  NAPI_CALL(env, napi_create_int32(env, bvh->packet_count, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "leaves", v));
+  NAPI_CALL(env, napi_create_double(env, bvh->build_ms, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "buildMs", v));
+  NAPI_CALL(env, napi_create_int32(env, bvh->build_threads, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "buildThreads", v));
+  double bytes = (double)bvh->node_count * sizeof(QNode) + (double)bvh->packet_count * sizeof(TriPacket) +
+                 (double)bvh->triangle_count * 3 * sizeof(float);
+  NAPI_CALL(env, napi_create_double(env, bytes, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "bytes", v));
+  NAPI_CALL(env, napi_get_boolean(env, bvh->mapping != NULL, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "mapped", v));
+  return result;
+}
+
+/**
+ * serializeBVH(handle) -> ArrayBuffer
+ * Flat copy of the tree (header + nodes + packets + normals) for a map cache.
+ */
+static napi_value bvh_serialize(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  if (argc < 1) {
+    napi_throw_error(env, NULL, "Expected handle");
+    return NULL;
+  }
+  BVH* bvh = get_bvh(env, args[0]);
+  if (!bvh) return NULL;
+
+  BlobHeader h;
+  blob_layout(bvh, &h);
+  void* data;
+  napi_value result;
+  NAPI_CALL(env, napi_create_arraybuffer(env, h.total_size, &data, &result));
+  uint8_t* out = (uint8_t*)data;
+  memset(out, 0, h.total_size);
+  memcpy(out, &h, sizeof(h));
+  memcpy(out + h.nodes_offset, bvh->nodes, sizeof(QNode) * (size_t)bvh->node_count);
+  memcpy(out + h.packets_offset, bvh->packets, sizeof(TriPacket) * (size_t)bvh->packet_count);
+  memcpy(out + h.normals_offset, bvh->normals, sizeof(float) * 3 * (size_t)bvh->triangle_count);
+  return result;
+}
+
+/**
+ * mapBVH(path: string, byteOffset: number, byteLength: number) -> handle | null
+ * mmap a file read-only and use the serialized tree at byteOffset in place.
+ * Returns null if the file can't be mapped or the blob is stale or corrupt.
+ */
+static napi_value bvh_map(napi_env env, napi_callback_info info) {
+  size_t argc = 3;
+  napi_value args[3];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  if (argc < 3) {
+    napi_throw_error(env, NULL, "Expected path, byteOffset, byteLength");
+    return NULL;
+  }
+
+  char path[4096];
+  size_t path_len;
+  NAPI_CALL(env, napi_get_value_string_utf8(env, args[0], path, sizeof(path), &path_len));
+  double offset_d, length_d;
+  NAPI_CALL(env, napi_get_value_double(env, args[1], &offset_d));
+  NAPI_CALL(env, napi_get_value_double(env, args[2], &length_d));
+
+  napi_value null_value;
+  NAPI_CALL(env, napi_get_null(env, &null_value));
+  if (offset_d < 0 || length_d < 0 || fmod(offset_d, BLOB_ALIGN) != 0) return null_value;
+  size_t offset = (size_t)offset_d, length = (size_t)length_d;
+
+  double start = now_ms();
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return null_value;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < offset + length || length == 0) {
+    close(fd);
+    return null_value;
+  }
+  size_t size = (size_t)st.st_size;
+  void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) return null_value;
+
+  const uint8_t* base = (const uint8_t*)mapping + offset;
+  BVH* bvh = blob_valid(base, length) ? (BVH*)calloc(1, sizeof(BVH)) : NULL;
+  if (!bvh) {
+    munmap(mapping, size);
+    return null_value;
+  }
+
+  const BlobHeader* h = (const BlobHeader*)base;
+  bvh->mapping = mapping;
+  bvh->mapping_size = size;
+  bvh->node_count = h->node_count;
+  bvh->packet_count = h->packet_count;
+  bvh->triangle_count = h->triangle_count;
+  bvh->nodes = (QNode*)(base + h->nodes_offset);
+  bvh->packets = (TriPacket*)(base + h->packets_offset);
+  bvh->normals = (float*)(base + h->normals_offset);
+  bvh->build_threads = 0;
+  bvh->build_ms = now_ms() - start;
+
+  napi_value result;
+  if (napi_create_external(env, bvh, finalize_bvh, NULL, &result) != napi_ok) {
+    bvh_free(bvh);
+    napi_throw_error(env, NULL, "Failed to create BVH handle");
+    return NULL;
+  }
+  return result;
+}
+
+/**
+ * viewBVH(blob: Uint8Array) -> handle | null
+ * Use a serialized tree in place without copying it, e.g. one in a
+ * SharedArrayBuffer that every worker thread views, so a map's collision
+ * world exists once per process. The handle keeps the array alive.
+ * Returns null if the blob is stale, corrupt or not 16-byte aligned.
+ */
+static napi_value bvh_view(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  if (argc < 1) {
+    napi_throw_error(env, NULL, "Expected blob");
+    return NULL;
+  }
+
+  bool is_typed = false;
+  napi_typedarray_type type;
+  size_t length = 0;
+  void* data = NULL;
+  if (napi_is_typedarray(env, args[0], &is_typed) != napi_ok || !is_typed ||
+      napi_get_typedarray_info(env, args[0], &type, &length, &data, NULL, NULL) != napi_ok ||
+      type != napi_uint8_array) {
+    napi_throw_type_error(env, NULL, "Expected a Uint8Array");
+    return NULL;
+  }
+
+  napi_value null_value;
+  NAPI_CALL(env, napi_get_null(env, &null_value));
+  const uint8_t* base = (const uint8_t*)data;
+  if (!base || ((uintptr_t)base & 15) != 0 || !blob_valid(base, length)) return null_value;
+
+  double start = now_ms();
+  BVH* bvh = (BVH*)calloc(1, sizeof(BVH));
+  if (!bvh) return null_value;
+  if (napi_create_reference(env, args[0], 1, &bvh->backing) != napi_ok) {
+    free(bvh);
+    return null_value;
+  }
+
+  const BlobHeader* h = (const BlobHeader*)base;
+  bvh->node_count = h->node_count;
+  bvh->packet_count = h->packet_count;
+  bvh->triangle_count = h->triangle_count;
+  bvh->nodes = (QNode*)(base + h->nodes_offset);
+  bvh->packets = (TriPacket*)(base + h->packets_offset);
+  bvh->normals = (float*)(base + h->normals_offset);
+  bvh->build_threads = 0;
+  bvh->build_ms = now_ms() - start;
+
+  napi_value result;
+  if (napi_create_external(env, bvh, finalize_bvh, NULL, &result) != napi_ok) {
+    napi_delete_reference(env, bvh->backing);
+    free(bvh);
+    napi_throw_error(env, NULL, "Failed to create BVH handle");
+    return NULL;
+  }
+  return result;
+}
+
+static napi_value bvh_has_simd(napi_env env, napi_callback_info info) {
+  napi_value result;
+#if defined(USE_SSE2) || defined(USE_NEON)
+  NAPI_CALL(env, napi_get_boolean(env, true, &result));
+#else
+  NAPI_CALL(env, napi_get_boolean(env, false, &result));
+#endif
+  return result;
+}
+
+// Module init
+static napi_value Init(napi_env env, napi_value exports) {
+  napi_property_descriptor props[] = {
+    { "createBVH", NULL, bvh_create, NULL, NULL, NULL, napi_default, NULL },
+    { "raycastBatch", NULL, bvh_raycast_batch, NULL, NULL, NULL, napi_default, NULL },
+    { "querySphere", NULL, bvh_query_sphere, NULL, NULL, NULL, napi_default, NULL },
+    { "getStats", NULL, bvh_get_stats, NULL, NULL, NULL, napi_default, NULL },
+    { "serializeBVH", NULL, bvh_serialize, NULL, NULL, NULL, napi_default, NULL },
+    { "mapBVH", NULL, bvh_map, NULL, NULL, NULL, napi_default, NULL },
+    { "viewBVH", NULL, bvh_view, NULL, NULL, NULL, napi_default, NULL },
+    { "hasSIMD", NULL, bvh_has_simd, NULL, NULL, NULL, napi_default, NULL },
+    JOB_SYSTEM_PROPERTIES,
+  };
+
+  NAPI_CALL(env, napi_define_properties(env, exports, sizeof(props) / sizeof(props[0]), props));
+  return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
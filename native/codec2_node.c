@@ -12,12 +12,44 @@
  *   1300 bps - 40ms frames, 52 bits/frame, 320 samples @ 8kHz
  *   1200 bps - 40ms frames, 48 bits/frame, 320 samples @ 8kHz
  *   700C bps - 40ms frames, 28 bits/frame, 320 samples @ 8kHz
+ *
+ * Two APIs are exported:
+ *   - Stream handles (createEncoder/createDecoder + encodeInto/decodeInto):
+ *     each handle owns its own CODEC2 state and writes into caller buffers,
+ *     so every speaker decodes independently with no per-frame allocation.
+ *   - Legacy mode-string calls (encode/decode/encodeFrame/decodeFrame), which
+ *     share one instance per mode and return freshly allocated arrays.
+ *
+ * It also hosts the voice engine: a native thread that jitter-buffers,
+ * decodes and spatially mixes incoming voice so playback never waits on
+ * the JS main thread (see the Voice Engine section). With several senders
+ * talking, their frames are decoded in parallel on the shared job system
+ * (job_system.h).
+ *
+ * The effect mixer (see the Effect Mixer section) plays game sound effects
+ * from wavetables on a second native thread and can take the voice engine's
+ * output as one more input, so game and voice audio leave through one ring.
  */
 
 #include <node_api.h>
 #include <codec2/codec2.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include "job_system.h"
+
+// SIMD headers (SSE2 is baseline on x86-64; NEON on AArch64)
+#if defined(__aarch64__) && defined(__ARM_NEON)
+  #include <arm_neon.h>
+  #define USE_NEON 1
+#elif defined(__SSE2__)
+  #include <emmintrin.h>
+  #define USE_SSE2 1
+#endif
 
 // Store codec instances per mode for reuse
 static struct CODEC2* codec_instances[16] = {0};
@@ -44,6 +76,243 @@ static int mode_from_string(const char* mode_str) {
     return -1;
 }
 
+// ============================================================================
+// Stream Handles
+// ============================================================================
+
+// One encoder or decoder stream. Codec2 is stateful across frames, so each
+// speaker needs its own instance or their frames corrupt each other's state.
+typedef struct {
+    struct CODEC2* codec;
+    int samples_per_frame;
+    int bytes_per_frame;
+    bool is_decoder;
+} Codec2Stream;
+
+static void destroy_stream(Codec2Stream* stream) {
+    if (stream->codec) {
+        codec2_destroy(stream->codec);
+        stream->codec = NULL;
+    }
+}
+
+// GC finalizer for stream handles
+static void finalize_stream(napi_env env, void* data, void* hint) {
+    (void)env;
+    (void)hint;
+    Codec2Stream* stream = (Codec2Stream*)data;
+    destroy_stream(stream);
+    free(stream);
+}
+
+// Parse a mode argument and create a stream handle around a fresh instance
+static napi_value create_stream(napi_env env, napi_callback_info info, bool is_decoder) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "Expected codec2 mode");
+        return NULL;
+    }
+
+    char mode_str[16];
+    size_t mode_len;
+    if (napi_get_value_string_utf8(env, args[0], mode_str, sizeof(mode_str), &mode_len) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Expected codec2 mode string");
+        return NULL;
+    }
+
+    int mode = mode_from_string(mode_str);
+    if (mode < 0) {
+        napi_throw_error(env, NULL, "Invalid codec2 mode");
+        return NULL;
+    }
+
+    Codec2Stream* stream = calloc(1, sizeof(Codec2Stream));
+    if (!stream) {
+        napi_throw_error(env, NULL, "Failed to allocate codec2 stream");
+        return NULL;
+    }
+
+    stream->codec = codec2_create(mode);
+    if (!stream->codec) {
+        free(stream);
+        napi_throw_error(env, NULL, "Failed to create codec2 instance");
+        return NULL;
+    }
+    stream->samples_per_frame = codec2_samples_per_frame(stream->codec);
+    stream->bytes_per_frame = codec2_bytes_per_frame(stream->codec);
+    stream->is_decoder = is_decoder;
+
+    napi_value handle;
+    if (napi_create_external(env, stream, finalize_stream, NULL, &handle) != napi_ok) {
+        destroy_stream(stream);
+        free(stream);
+        napi_throw_error(env, NULL, "Failed to create codec2 handle");
+        return NULL;
+    }
+    return handle;
+}
+
+// Unwrap a live stream handle, throwing on anything else
+static Codec2Stream* get_stream(napi_env env, napi_value value) {
+    napi_valuetype type;
+    napi_typeof(env, value, &type);
+    if (type != napi_external) {
+        napi_throw_type_error(env, NULL, "Expected codec2 handle");
+        return NULL;
+    }
+
+    void* data;
+    napi_get_value_external(env, value, &data);
+    Codec2Stream* stream = (Codec2Stream*)data;
+    if (!stream || !stream->codec) {
+        napi_throw_error(env, NULL, "Codec2 handle has been destroyed");
+        return NULL;
+    }
+    return stream;
+}
+
+// Get typed array data, checking its element type
+static void* get_typed_data(napi_env env, napi_value value, napi_typedarray_type expected,
+                            size_t* length, const char* error) {
+    bool is_typedarray = false;
+    napi_is_typedarray(env, value, &is_typedarray);
+    if (!is_typedarray) {
+        napi_throw_type_error(env, NULL, error);
+        return NULL;
+    }
+
+    napi_typedarray_type type;
+    void* data;
+    napi_get_typedarray_info(env, value, &type, length, &data, NULL, NULL);
+    if (type != expected) {
+        napi_throw_type_error(env, NULL, error);
+        return NULL;
+    }
+    return data;
+}
+
+// createEncoder(mode: string) => handle
+static napi_value CreateEncoder(napi_env env, napi_callback_info info) {
+    return create_stream(env, info, false);
+}
+
+// createDecoder(mode: string) => handle
+static napi_value CreateDecoder(napi_env env, napi_callback_info info) {
+    return create_stream(env, info, true);
+}
+
+// Free a handle's codec state now instead of waiting for GC
+// destroy(handle) => void
+static napi_value Destroy(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc >= 1) {
+        napi_valuetype type;
+        napi_typeof(env, args[0], &type);
+        if (type == napi_external) {
+            void* data;
+            napi_get_value_external(env, args[0], &data);
+            if (data) destroy_stream((Codec2Stream*)data);
+        }
+    }
+    return NULL;
+}
+
+// Encode every complete frame of samples into the caller's buffer
+// encodeInto(handle, samples: Int16Array, out: Uint8Array) => bytes written
+static napi_value EncodeInto(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 3) {
+        napi_throw_type_error(env, NULL, "Expected (handle, samples, out)");
+        return NULL;
+    }
+
+    Codec2Stream* stream = get_stream(env, args[0]);
+    if (!stream) return NULL;
+    if (stream->is_decoder) {
+        napi_throw_error(env, NULL, "Codec2 handle is a decoder");
+        return NULL;
+    }
+
+    size_t length, out_length;
+    short* samples = get_typed_data(env, args[1], napi_int16_array, &length,
+                                    "Expected Int16Array for samples");
+    if (!samples) return NULL;
+    unsigned char* out = get_typed_data(env, args[2], napi_uint8_array, &out_length,
+                                        "Expected Uint8Array for out");
+    if (!out) return NULL;
+
+    size_t num_frames = length / (size_t)stream->samples_per_frame;
+    if (num_frames * (size_t)stream->bytes_per_frame > out_length) {
+        napi_throw_range_error(env, NULL, "Output buffer too small");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < num_frames; i++) {
+        codec2_encode(stream->codec, out + i * stream->bytes_per_frame,
+                      samples + i * stream->samples_per_frame);
+    }
+
+    napi_value result;
+    napi_create_uint32(env, (uint32_t)(num_frames * stream->bytes_per_frame), &result);
+    return result;
+}
+
+// Decode every complete frame of bytes into the caller's buffer
+// decodeInto(handle, bytes: Uint8Array, out: Int16Array) => samples written
+static napi_value DecodeInto(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 3) {
+        napi_throw_type_error(env, NULL, "Expected (handle, bytes, out)");
+        return NULL;
+    }
+
+    Codec2Stream* stream = get_stream(env, args[0]);
+    if (!stream) return NULL;
+    if (!stream->is_decoder) {
+        napi_throw_error(env, NULL, "Codec2 handle is an encoder");
+        return NULL;
+    }
+
+    size_t length, out_length;
+    unsigned char* bytes = get_typed_data(env, args[1], napi_uint8_array, &length,
+                                          "Expected Uint8Array for bytes");
+    if (!bytes) return NULL;
+    short* out = get_typed_data(env, args[2], napi_int16_array, &out_length,
+                                "Expected Int16Array for out");
+    if (!out) return NULL;
+
+    size_t num_frames = length / (size_t)stream->bytes_per_frame;
+    if (num_frames * (size_t)stream->samples_per_frame > out_length) {
+        napi_throw_range_error(env, NULL, "Output buffer too small");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < num_frames; i++) {
+        codec2_decode(stream->codec, out + i * stream->samples_per_frame,
+                      bytes + i * stream->bytes_per_frame);
+    }
+
+    napi_value result;
+    napi_create_uint32(env, (uint32_t)(num_frames * stream->samples_per_frame), &result);
+    return result;
+}
+
+// ============================================================================
+// Legacy Mode-String API
+// ============================================================================
+
 // Get mode info: { samplesPerFrame, bytesPerFrame, bitsPerFrame }
 static napi_value GetModeInfo(napi_env env, napi_callback_info info) {
     size_t argc = 1;
@@ -374,6 +643,1727 @@ static napi_value GetModes(napi_env env, napi_callback_info info) {
     return result;
 }
 
+// ============================================================================
+// Mix and Resample Kernels
+// ============================================================================
+//
+// Shared by the voice engine and the JS-facing mixInto/resampleInto exports.
+// Mixing accumulates in float and saturates to int16 once at the end;
+// resampling is a 6x polyphase FIR (8kHz codec output -> 48kHz device rate).
+
+#define RESAMPLE_FACTOR 6
+#define RESAMPLE_TAPS 8                  // Taps per phase (48-tap prototype)
+#define RESAMPLE_CUTOFF_HZ 3800.0        // Just under the 4kHz input Nyquist
+#define RESAMPLE_CHUNK 256               // Input frames per inner pass
+#define MIX_MAX_STREAMS 64
+#define VOICE_MIX_MAX_SAMPLES 512         // Mono samples per mixInto block
+
+// resample_coeffs[p][k] multiplies x[n - k] for output sample n * 6 + p
+static float resample_coeffs[RESAMPLE_FACTOR][RESAMPLE_TAPS];
+static pthread_once_t resample_once = PTHREAD_ONCE_INIT;
+
+// Blackman-windowed sinc, each phase normalized to unit DC gain
+static void init_resample_coeffs(void) {
+    const int len = RESAMPLE_FACTOR * RESAMPLE_TAPS;
+    const double fc = RESAMPLE_CUTOFF_HZ / (8000.0 * RESAMPLE_FACTOR);
+    const double center = (len - 1) / 2.0;
+    for (int p = 0; p < RESAMPLE_FACTOR; p++) {
+        double sum = 0.0;
+        for (int k = 0; k < RESAMPLE_TAPS; k++) {
+            int m = p + k * RESAMPLE_FACTOR;
+            double t = m - center;
+            double sinc = fabs(t) < 1e-9 ? 2.0 * fc : sin(2.0 * M_PI * fc * t) / (M_PI * t);
+            double window = 0.42 - 0.5 * cos(2.0 * M_PI * m / (len - 1)) +
+                            0.08 * cos(4.0 * M_PI * m / (len - 1));
+            resample_coeffs[p][k] = (float)(sinc * window);
+            sum += resample_coeffs[p][k];
+        }
+        for (int k = 0; k < RESAMPLE_TAPS; k++) resample_coeffs[p][k] /= (float)sum;
+    }
+}
+
+typedef struct {
+    int channels;
+    float history[2][RESAMPLE_TAPS - 1];  // Last input samples per channel
+} Resampler;
+
+/**
+ * acc[2i] += in[i] * left, acc[2i + 1] += in[i] * right, with gains ramping
+ * linearly by step_l/step_r per sample (sample i uses l + step_l * (i + 1)).
+ */
+static void mix_mono_into_stereo(float* acc, const int16_t* in, int n,
+                                 float l, float r, float step_l, float step_r) {
+    int i = 0;
+#if defined(USE_SSE2)
+    __m128 gl = _mm_setr_ps(l + step_l, l + 2 * step_l, l + 3 * step_l, l + 4 * step_l);
+    __m128 gr = _mm_setr_ps(r + step_r, r + 2 * step_r, r + 3 * step_r, r + 4 * step_r);
+    const __m128 dl = _mm_set1_ps(4 * step_l);
+    const __m128 dr = _mm_set1_ps(4 * step_r);
+    for (; i + 4 <= n; i += 4) {
+        __m128i x16 = _mm_loadl_epi64((const __m128i*)(in + i));
+        __m128 x = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x16, x16), 16));
+        __m128 vl = _mm_mul_ps(x, gl);
+        __m128 vr = _mm_mul_ps(x, gr);
+        float* a = acc + i * 2;
+        _mm_storeu_ps(a, _mm_add_ps(_mm_loadu_ps(a), _mm_unpacklo_ps(vl, vr)));
+        _mm_storeu_ps(a + 4, _mm_add_ps(_mm_loadu_ps(a + 4), _mm_unpackhi_ps(vl, vr)));
+        gl = _mm_add_ps(gl, dl);
+        gr = _mm_add_ps(gr, dr);
+    }
+#elif defined(USE_NEON)
+    const float ramp[4] = {1.0f, 2.0f, 3.0f, 4.0f};
+    const float32x4_t steps = vld1q_f32(ramp);
+    float32x4_t gl = vmlaq_n_f32(vdupq_n_f32(l), steps, step_l);
+    float32x4_t gr = vmlaq_n_f32(vdupq_n_f32(r), steps, step_r);
+    const float32x4_t dl = vdupq_n_f32(4 * step_l);
+    const float32x4_t dr = vdupq_n_f32(4 * step_r);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t x = vcvtq_f32_s32(vmovl_s16(vld1_s16(in + i)));
+        float32x4x2_t a = vld2q_f32(acc + i * 2);
+        a.val[0] = vmlaq_f32(a.val[0], x, gl);
+        a.val[1] = vmlaq_f32(a.val[1], x, gr);
+        vst2q_f32(acc + i * 2, a);
+        gl = vaddq_f32(gl, dl);
+        gr = vaddq_f32(gr, dr);
+    }
+#endif
+    for (; i < n; i++) {
+        float x = (float)in[i];
+        acc[i * 2] += x * (l + step_l * (float)(i + 1));
+        acc[i * 2 + 1] += x * (r + step_r * (float)(i + 1));
+    }
+}
+
+// Round and saturate float samples to int16
+static void saturate_to_int16(const float* in, int16_t* out, int count) {
+    int i = 0;
+#if defined(USE_SSE2)
+    const __m128 lo = _mm_set1_ps(-32768.0f);
+    const __m128 hi = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo), hi);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), lo), hi);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128((__m128i*)(out + i), packed);
+    }
+#elif defined(USE_NEON)
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t a = vcvtnq_s32_f32(vld1q_f32(in + i));
+        int32x4_t b = vcvtnq_s32_f32(vld1q_f32(in + i + 4));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+#endif
+    for (; i < count; i++) {
+        float v = in[i];
+        if (v > 32767.0f) v = 32767.0f;
+        else if (v < -32768.0f) v = -32768.0f;
+        out[i] = (int16_t)lrintf(v);
+    }
+}
+
+/**
+ * Upsample one channel by RESAMPLE_FACTOR.
+ *
+ * Args:
+ *   history: RESAMPLE_TAPS - 1 previous input samples (updated)
+ *   in: n input samples, n <= RESAMPLE_CHUNK
+ *   out: receives n * RESAMPLE_FACTOR samples at out[j * stride]
+ */
+static void resample_channel(float* history, const float* in, int n, float* out, int stride) {
+    float x[RESAMPLE_TAPS - 1 + RESAMPLE_CHUNK];
+    memcpy(x, history, sizeof(float) * (RESAMPLE_TAPS - 1));
+    memcpy(x + RESAMPLE_TAPS - 1, in, sizeof(float) * n);
+
+    // Input sample i sits at x[i + TAPS - 1]; output (i, p) = sum_k c[p][k] * x[i + TAPS - 1 - k]
+    int i = 0;
+#if defined(USE_SSE2) || defined(USE_NEON)
+    for (; i + 4 <= n; i += 4) {
+        for (int p = 0; p < RESAMPLE_FACTOR; p++) {
+            float lanes[4];
+#if defined(USE_SSE2)
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < RESAMPLE_TAPS; k++) {
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(resample_coeffs[p][k]),
+                                                 _mm_loadu_ps(x + i + RESAMPLE_TAPS - 1 - k)));
+            }
+            _mm_storeu_ps(lanes, acc);
+#else
+            float32x4_t acc = vdupq_n_f32(0.0f);
+            for (int k = 0; k < RESAMPLE_TAPS; k++) {
+                acc = vmlaq_n_f32(acc, vld1q_f32(x + i + RESAMPLE_TAPS - 1 - k), resample_coeffs[p][k]);
+            }
+            vst1q_f32(lanes, acc);
+#endif
+            for (int j = 0; j < 4; j++) {
+                out[((i + j) * RESAMPLE_FACTOR + p) * stride] = lanes[j];
+            }
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        for (int p = 0; p < RESAMPLE_FACTOR; p++) {
+            float acc = 0.0f;
+            for (int k = 0; k < RESAMPLE_TAPS; k++) {
+                acc += resample_coeffs[p][k] * x[i + RESAMPLE_TAPS - 1 - k];
+            }
+            out[(i * RESAMPLE_FACTOR + p) * stride] = acc;
+        }
+    }
+
+    memcpy(history, x + n, sizeof(float) * (RESAMPLE_TAPS - 1));
+}
+
+// Upsample interleaved float frames into interleaved out (frames * 6 frames)
+static void resample_frames(Resampler* rs, const float* in, int frames, float* out) {
+    float channel[RESAMPLE_CHUNK];
+    for (int base = 0; base < frames; base += RESAMPLE_CHUNK) {
+        int chunk = frames - base < RESAMPLE_CHUNK ? frames - base : RESAMPLE_CHUNK;
+        for (int c = 0; c < rs->channels; c++) {
+            for (int i = 0; i < chunk; i++) channel[i] = in[(base + i) * rs->channels + c];
+            resample_channel(rs->history[c], channel, chunk,
+                             out + base * rs->channels * RESAMPLE_FACTOR + c, rs->channels);
+        }
+    }
+}
+
+/**
+ * Mix mono streams into a stereo buffer with per-stream gains.
+ *
+ * Args:
+ *   streams: Array of Int16Array mono frames
+ *   gains: Float32Array of [left, right] per stream
+ *   out: Int16Array receiving stereo interleaved samples (saturated)
+ *
+ * Frames longer than out / 2 are truncated; shorter ones mix into the start.
+ * Returns the number of int16 values written (2 * longest frame).
+ */
+static napi_value MixInto(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 3) {
+        napi_throw_type_error(env, NULL, "Expected (streams, gains, out)");
+        return NULL;
+    }
+
+    uint32_t count = 0;
+    bool is_array = false;
+    napi_is_array(env, args[0], &is_array);
+    if (!is_array) {
+        napi_throw_type_error(env, NULL, "Expected array of Int16Array streams");
+        return NULL;
+    }
+    napi_get_array_length(env, args[0], &count);
+    if (count > MIX_MAX_STREAMS) count = MIX_MAX_STREAMS;
+
+    size_t gain_count, out_length;
+    float* gains = get_typed_data(env, args[1], napi_float32_array, &gain_count,
+                                  "Expected Float32Array for gains");
+    if (!gains) return NULL;
+    int16_t* out = get_typed_data(env, args[2], napi_int16_array, &out_length,
+                                  "Expected Int16Array for out");
+    if (!out) return NULL;
+    if (gain_count < (size_t)count * 2) {
+        napi_throw_range_error(env, NULL, "Expected two gains per stream");
+        return NULL;
+    }
+
+    const int max_frame = (int)(out_length / 2);
+    float acc[VOICE_MIX_MAX_SAMPLES * 2];
+    int longest = 0;
+
+    // Process in blocks so the accumulator stays on the stack
+    int16_t* streams[MIX_MAX_STREAMS];
+    int lengths[MIX_MAX_STREAMS];
+    for (uint32_t s = 0; s < count; s++) {
+        napi_value element;
+        napi_get_element(env, args[0], s, &element);
+        size_t length;
+        streams[s] = get_typed_data(env, element, napi_int16_array, &length,
+                                    "Expected Int16Array for stream");
+        if (!streams[s]) return NULL;
+        lengths[s] = (int)(length < (size_t)max_frame ? length : (size_t)max_frame);
+        if (lengths[s] > longest) longest = lengths[s];
+    }
+
+    for (int base = 0; base < longest; base += VOICE_MIX_MAX_SAMPLES) {
+        int block = longest - base < VOICE_MIX_MAX_SAMPLES ? longest - base : VOICE_MIX_MAX_SAMPLES;
+        memset(acc, 0, sizeof(float) * 2 * block);
+        for (uint32_t s = 0; s < count; s++) {
+            int n = lengths[s] - base;
+            if (n <= 0) continue;
+            if (n > block) n = block;
+            mix_mono_into_stereo(acc, streams[s] + base, n, gains[s * 2], gains[s * 2 + 1], 0.0f, 0.0f);
+        }
+        saturate_to_int16(acc, out + base * 2, block * 2);
+    }
+
+    napi_value result;
+    napi_create_uint32(env, (uint32_t)(longest * 2), &result);
+    return result;
+}
+
+static void finalize_resampler(napi_env env, void* data, void* hint) {
+    (void)env;
+    (void)hint;
+    free(data);
+}
+
+// createResampler(channels: 1 | 2) => handle (8kHz -> 48kHz)
+static napi_value CreateResampler(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    int32_t channels = 1;
+    if (argc >= 1) napi_get_value_int32(env, args[0], &channels);
+    if (channels != 1 && channels != 2) {
+        napi_throw_range_error(env, NULL, "Resampler supports 1 or 2 channels");
+        return NULL;
+    }
+
+    pthread_once(&resample_once, init_resample_coeffs);
+    Resampler* rs = calloc(1, sizeof(Resampler));
+    if (!rs) {
+        napi_throw_error(env, NULL, "Failed to allocate resampler");
+        return NULL;
+    }
+    rs->channels = channels;
+
+    napi_value handle;
+    if (napi_create_external(env, rs, finalize_resampler, NULL, &handle) != napi_ok) {
+        free(rs);
+        napi_throw_error(env, NULL, "Failed to create resampler handle");
+        return NULL;
+    }
+    return handle;
+}
+
+/**
+ * Upsample 8kHz int16 audio to 48kHz into a caller buffer.
+ *
+ * Args:
+ *   handle: From createResampler (keeps filter history between calls)
+ *   in: Int16Array, interleaved if stereo
+ *   out: Int16Array, at least 6 * in.length long
+ *
+ * Returns the number of int16 values written.
+ */
+static napi_value ResampleInto(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 3) {
+        napi_throw_type_error(env, NULL, "Expected (handle, in, out)");
+        return NULL;
+    }
+
+    napi_valuetype type;
+    napi_typeof(env, args[0], &type);
+    if (type != napi_external) {
+        napi_throw_type_error(env, NULL, "Expected resampler handle");
+        return NULL;
+    }
+    void* data;
+    napi_get_value_external(env, args[0], &data);
+    Resampler* rs = (Resampler*)data;
+
+    size_t in_length, out_length;
+    int16_t* in = get_typed_data(env, args[1], napi_int16_array, &in_length,
+                                 "Expected Int16Array for in");
+    if (!in) return NULL;
+    int16_t* out = get_typed_data(env, args[2], napi_int16_array, &out_length,
+                                  "Expected Int16Array for out");
+    if (!out) return NULL;
+
+    size_t frames = in_length / (size_t)rs->channels;
+    if (frames * rs->channels * RESAMPLE_FACTOR > out_length) {
+        napi_throw_range_error(env, NULL, "Output buffer too small");
+        return NULL;
+    }
+
+    float in_f[RESAMPLE_CHUNK * 2];
+    float out_f[RESAMPLE_CHUNK * 2 * RESAMPLE_FACTOR];
+    for (size_t base = 0; base < frames; base += RESAMPLE_CHUNK) {
+        int chunk = (int)(frames - base < RESAMPLE_CHUNK ? frames - base : RESAMPLE_CHUNK);
+        int values = chunk * rs->channels;
+        const int16_t* src = in + base * rs->channels;
+        for (int i = 0; i < values; i++) in_f[i] = (float)src[i];
+        resample_frames(rs, in_f, chunk, out_f);
+        saturate_to_int16(out_f, out + base * rs->channels * RESAMPLE_FACTOR, values * RESAMPLE_FACTOR);
+    }
+
+    napi_value result;
+    napi_create_uint32(env, (uint32_t)(frames * rs->channels * RESAMPLE_FACTOR), &result);
+    return result;
+}
+
+// ============================================================================
+// Voice Engine
+// ============================================================================
+//
+// A native thread ticks once per codec frame. Each tick it drains packets
+// pushed from JS, pops one frame per sender from that sender's jitter queue,
+// decodes it with the sender's own CODEC2 state, applies distance gain and
+// constant-power pan (same math as SpatialMixer) and mixes everything into a
+// stereo output ring (8kHz, or 48kHz through the polyphase resampler) that
+// JS drains into the audio device.
+//
+// Threading:
+//   - packet ring: single producer (JS thread), single consumer (engine)
+//   - output ring: single producer (engine), single consumer (JS thread, or
+//     the effect mixer thread while voice is routed into it)
+//   - listener/source positions and mix settings: a small struct guarded by
+//     a mutex, copied once per tick by the engine
+// Jitter queues and decoders are touched only by the engine thread.
+//
+// Each packet is expected to carry exactly one codec frame (VoiceClient sends
+// one frame per packet).
+
+#define VOICE_MAX_SOURCES 32
+#define VOICE_MAX_PAYLOAD 64
+#define VOICE_MAX_FRAME_SAMPLES 320
+#define VOICE_JITTER_SLOTS 16            // Power of two
+#define VOICE_PACKET_RING 256            // Power of two
+#define VOICE_OUTPUT_RING 131072         // int16 values (~1.4s stereo @ 48kHz), power of two
+#define VOICE_TARGET_DEPTH 1             // Frames buffered before playback starts
+#define VOICE_MAX_SILENT_FRAMES 5        // Lost frames in a row before a stream resets
+#define VOICE_SOURCE_IDLE_MS 10000.0     // Free a silent sender's decoder after this
+#define VOICE_REFERENCE_DISTANCE 5.0f    // Full volume inside this distance
+#define VOICE_MIN_VOLUME 0.01f           // Quieter than this is not mixed
+#define VOICE_PARALLEL_MIN_SOURCES 4     // Fewer playing senders decode on the engine thread
+#define VOICE_DECODE_CHUNK 4             // Source slots per decode job chunk
+
+typedef enum {
+    VOICE_MSG_PACKET,
+    VOICE_MSG_REMOVE,
+    VOICE_MSG_CLEAR,
+} VoiceMsgType;
+
+typedef struct {
+    uint8_t type;
+    uint8_t len;
+    uint32_t sender_id;
+    uint32_t sequence;
+    uint8_t bytes[VOICE_MAX_PAYLOAD];
+} VoiceMsg;
+
+typedef struct {
+    uint32_t sequence;
+    uint8_t len;  // 0 = empty
+    uint8_t bytes[VOICE_MAX_PAYLOAD];
+} VoiceJitterSlot;
+
+// Per-sender state, owned by the engine thread
+typedef struct {
+    bool used;
+    bool active;            // Jitter queue has started playing
+    bool has_gain;          // gain_l/gain_r hold the previous frame's gains
+    uint32_t sender_id;
+    struct CODEC2* decoder;
+    uint32_t next_seq;
+    int silent_frames;
+    double last_packet_ms;
+    float gain_l, gain_r;
+    VoiceJitterSlot slots[VOICE_JITTER_SLOTS];
+} VoiceSource;
+
+typedef struct {
+    bool used;
+    uint32_t sender_id;
+    float x, y, z;
+} VoicePosition;
+
+// Written by JS, copied by the engine each tick
+typedef struct {
+    float listener_x, listener_y, listener_z, listener_yaw;
+    float max_distance;
+    float output_volume;
+    bool spatial_enabled;
+    float effects_volume;   // Effect mixer master volume (audioSetVolume)
+    VoicePosition positions[VOICE_MAX_SOURCES];
+} VoiceParams;
+
+static pthread_t voice_thread;
+static bool voice_running = false;
+static bool voice_stop = false;
+static int voice_mode = -1;
+static int voice_samples_per_frame = 0;
+static int voice_bytes_per_frame = 0;
+static int voice_output_rate = 8000;
+static Resampler voice_resampler;
+
+static VoiceSource voice_sources[VOICE_MAX_SOURCES];
+
+static VoiceMsg voice_packets[VOICE_PACKET_RING];
+static uint32_t voice_packet_head = 0;  // Written by JS
+static uint32_t voice_packet_tail = 0;  // Written by the engine
+
+static int16_t voice_output[VOICE_OUTPUT_RING];
+static uint32_t voice_output_head = 0;  // Written by the engine
+static uint32_t voice_output_tail = 0;  // Written by JS (or the effect mixer)
+// Held by the effect mixer while it drains the output ring, and by shutdown
+// while it resets the ring
+static pthread_mutex_t voice_output_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bool voice_routed = false;       // audioStart() asked the effect mixer to drain the output ring
+static bool voice_is_routed(void);      // ...and the engine runs at the mixer's rate
+
+static pthread_mutex_t voice_params_mutex = PTHREAD_MUTEX_INITIALIZER;
+static VoiceParams voice_params = {
+    .max_distance = 50.0f,
+    .output_volume = 1.0f,
+    .spatial_enabled = true,
+    .effects_volume = 0.7f,
+};
+
+// Each slot's frame for the current tick, decoded before mixing
+static int16_t voice_pcm[VOICE_MAX_SOURCES][VOICE_MAX_FRAME_SAMPLES];
+static bool voice_decoded[VOICE_MAX_SOURCES];
+
+// Last time each engine slot played a frame, for speaking indicators
+static uint32_t voice_speaking_id[VOICE_MAX_SOURCES];
+static uint64_t voice_speaking_ms[VOICE_MAX_SOURCES];
+
+// Stats
+static uint32_t voice_stat_packets_dropped = 0;  // JS thread
+static uint32_t voice_stat_frames_mixed = 0;     // Engine thread
+static uint32_t voice_stat_frames_lost = 0;      // Engine thread and decode jobs
+static uint32_t voice_stat_output_overflows = 0; // Engine thread
+
+static double voice_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void voice_source_release(VoiceSource* src) {
+    if (src->decoder) codec2_destroy(src->decoder);
+    memset(src, 0, sizeof(VoiceSource));
+}
+
+// Drop buffered packets and wait for the next one to restart playback
+static void voice_source_reset(VoiceSource* src) {
+    for (int i = 0; i < VOICE_JITTER_SLOTS; i++) src->slots[i].len = 0;
+    src->active = false;
+    src->silent_frames = 0;
+}
+
+static VoiceSource* voice_find_source(uint32_t sender_id) {
+    for (int i = 0; i < VOICE_MAX_SOURCES; i++) {
+        if (voice_sources[i].used && voice_sources[i].sender_id == sender_id) {
+            return &voice_sources[i];
+        }
+    }
+    return NULL;
+}
+
+static VoiceSource* voice_acquire_source(uint32_t sender_id) {
+    VoiceSource* src = voice_find_source(sender_id);
+    if (src) return src;
+
+    for (int i = 0; i < VOICE_MAX_SOURCES; i++) {
+        if (voice_sources[i].used) continue;
+        src = &voice_sources[i];
+        src->decoder = codec2_create(voice_mode);
+        if (!src->decoder) return NULL;
+        src->used = true;
+        src->sender_id = sender_id;
+        __atomic_store_n(&voice_speaking_ms[i], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&voice_speaking_id[i], sender_id, __ATOMIC_RELAXED);
+        return src;
+    }
+    return NULL;
+}
+
+static inline bool voice_slot_holds(const VoiceSource* src, uint32_t seq) {
+    const VoiceJitterSlot* slot = &src->slots[seq & (VOICE_JITTER_SLOTS - 1)];
+    return slot->len > 0 && slot->sequence == seq;
+}
+
+// Queue a packet in its sender's jitter queue
+static void voice_source_push(VoiceSource* src, const VoiceMsg* msg, double now) {
+    src->last_packet_ms = now;
+
+    if (!src->active) {
+        src->next_seq = msg->sequence;
+        src->active = true;
+        src->silent_frames = 0;
+    }
+
+    int32_t ahead = (int32_t)(msg->sequence - src->next_seq);
+    if (ahead < 0) return;  // Already played or skipped
+
+    // Fell a whole queue behind: skip ahead so this packet plays next
+    if (ahead >= VOICE_JITTER_SLOTS) {
+        voice_source_reset(src);
+        src->next_seq = msg->sequence;
+        src->active = true;
+    }
+
+    VoiceJitterSlot* slot = &src->slots[msg->sequence & (VOICE_JITTER_SLOTS - 1)];
+    slot->sequence = msg->sequence;
+    slot->len = msg->len;
+    memcpy(slot->bytes, msg->bytes, msg->len);
+}
+
+// Decode the sender's next frame into out; false if nothing is ready to play.
+// A missing packet with later ones queued plays as silence (like JitterBuffer).
+static bool voice_source_pop(VoiceSource* src, int16_t* out) {
+    if (!src->active) return false;
+
+    int available = 0;
+    for (int i = 0; i < VOICE_TARGET_DEPTH + 2; i++) {
+        if (voice_slot_holds(src, src->next_seq + (uint32_t)i)) available++;
+    }
+    if (available < VOICE_TARGET_DEPTH) return false;
+
+    VoiceJitterSlot* slot = &src->slots[src->next_seq & (VOICE_JITTER_SLOTS - 1)];
+    if (voice_slot_holds(src, src->next_seq)) {
+        if (slot->len >= voice_bytes_per_frame) {
+            codec2_decode(src->decoder, out, slot->bytes);
+        } else {
+            memset(out, 0, sizeof(int16_t) * voice_samples_per_frame);
+        }
+        slot->len = 0;
+        src->silent_frames = 0;
+    } else {
+        if (++src->silent_frames > VOICE_MAX_SILENT_FRAMES) {
+            voice_source_reset(src);
+            return false;
+        }
+        memset(out, 0, sizeof(int16_t) * voice_samples_per_frame);
+        __atomic_fetch_add(&voice_stat_frames_lost, 1, __ATOMIC_RELAXED);
+    }
+    src->next_seq++;
+    return true;
+}
+
+// Distance attenuation and pan (-1 left .. 1 right) of a point heard by the
+// listener (mirrors SpatialMixer.calculateSpatial); shared with the effect mixer
+static void spatial_attenuation(const VoiceParams* params, float x, float y, float z,
+                                float max_distance, float* attenuation, float* pan) {
+    float dx = x - params->listener_x;
+    float dy = y - params->listener_y;
+    float dz = z - params->listener_z;
+    float distance = sqrtf(dx * dx + dy * dy + dz * dz);
+
+    *attenuation = 1.0f;
+    if (distance > VOICE_REFERENCE_DISTANCE) {
+        *attenuation = fminf(1.0f, VOICE_REFERENCE_DISTANCE / fmaxf(distance, 0.1f));
+    }
+    if (distance > max_distance) *attenuation = 0.0f;
+
+    float angle = atan2f(-dx, -dz) - params->listener_yaw;
+    angle = remainderf(angle, 2.0f * (float)M_PI);
+    *pan = sinf(angle);
+}
+
+// Constant-power left/right gains (mirrors SpatialMixer.applySpatial)
+static void pan_gains(float volume, float pan, float* gain_l, float* gain_r) {
+    if (volume < VOICE_MIN_VOLUME) volume = 0.0f;
+    float theta = (pan + 1.0f) * (float)M_PI / 4.0f;
+    *gain_l = volume * cosf(theta);
+    *gain_r = volume * sinf(theta);
+}
+
+// Left/right gains for a sender
+static void voice_spatial_gains(const VoiceParams* params, uint32_t sender_id,
+                                float* gain_l, float* gain_r) {
+    const VoicePosition* pos = NULL;
+    for (int i = 0; i < VOICE_MAX_SOURCES; i++) {
+        if (params->positions[i].used && params->positions[i].sender_id == sender_id) {
+            pos = &params->positions[i];
+            break;
+        }
+    }
+
+    // No known position (lobby) or spatial off: full volume, centered
+    float volume = params->output_volume;
+    float pan = 0.0f;
+    if (pos && params->spatial_enabled) {
+        float attenuation;
+        spatial_attenuation(params, pos->x, pos->y, pos->z, params->max_distance, &attenuation, &pan);
+        volume *= attenuation;
+    }
+    pan_gains(volume, pan, gain_l, gain_r);
+}
+
+static void voice_output_write(const int16_t* frame, int count) {
+    uint32_t head = voice_output_head;
+    uint32_t tail = __atomic_load_n(&voice_output_tail, __ATOMIC_ACQUIRE);
+    if (VOICE_OUTPUT_RING - (head - tail) < (uint32_t)count) {
+        voice_stat_output_overflows++;  // Nobody is draining; drop this frame
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        voice_output[(head + (uint32_t)i) & (VOICE_OUTPUT_RING - 1)] = frame[i];
+    }
+    __atomic_store_n(&voice_output_head, head + (uint32_t)count, __ATOMIC_RELEASE);
+}
+
+// Decode this tick's frame for source slots [start, end) (job system range callback)
+static void voice_decode_sources(void* ctx, int start, int end) {
+    (void)ctx;
+    for (int s = start; s < end; s++) {
+        VoiceSource* src = &voice_sources[s];
+        voice_decoded[s] = src->used && voice_source_pop(src, voice_pcm[s]);
+    }
+}
+
+static void voice_engine_tick(void) {
+    double now = voice_now_ms();
+
+    // Drain packets and control messages pushed from JS
+    uint32_t head = __atomic_load_n(&voice_packet_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = voice_packet_tail;
+    for (; tail != head; tail++) {
+        const VoiceMsg* msg = &voice_packets[tail & (VOICE_PACKET_RING - 1)];
+        if (msg->type == VOICE_MSG_PACKET) {
+            VoiceSource* src = voice_acquire_source(msg->sender_id);
+            if (src) voice_source_push(src, msg, now);
+        } else if (msg->type == VOICE_MSG_REMOVE) {
+            VoiceSource* src = voice_find_source(msg->sender_id);
+            if (src) voice_source_release(src);
+        } else {
+            for (int i = 0; i < VOICE_MAX_SOURCES; i++) {
+                if (voice_sources[i].used) voice_source_release(&voice_sources[i]);
+            }
+        }
+    }
+    __atomic_store_n(&voice_packet_tail, tail, __ATOMIC_RELEASE);
+
+    VoiceParams params;
+    pthread_mutex_lock(&voice_params_mutex);
+    params = voice_params;
+    pthread_mutex_unlock(&voice_params_mutex);
+
+    const int n = voice_samples_per_frame;
+    float mix[VOICE_MAX_FRAME_SAMPLES * 2];
+    bool mixed = false;
+    memset(mix, 0, sizeof(float) * 2 * n);
+
+    // Decoders are independent, so busy channels decode one sender per worker;
+    // mixing stays serial below to keep the sum order (and output) unchanged
+    int playing = 0;
+    for (int s = 0; s < VOICE_MAX_SOURCES; s++) {
+        if (voice_sources[s].used && voice_sources[s].active) playing++;
+    }
+    if (playing >= VOICE_PARALLEL_MIN_SOURCES) {
+        jobs_parallel_for(JOB_TAG_VOICE, voice_decode_sources, NULL, 0, VOICE_MAX_SOURCES, VOICE_DECODE_CHUNK, 0);
+    } else {
+        voice_decode_sources(NULL, 0, VOICE_MAX_SOURCES);
+    }
+
+    for (int s = 0; s < VOICE_MAX_SOURCES; s++) {
+        VoiceSource* src = &voice_sources[s];
+        if (!src->used) continue;
+
+        if (!voice_decoded[s]) {
+            if (!src->active && now - src->last_packet_ms > VOICE_SOURCE_IDLE_MS) {
+                voice_source_release(src);
+            }
+            continue;
+        }
+        __atomic_store_n(&voice_speaking_ms[s], (uint64_t)now, __ATOMIC_RELAXED);
+        mixed = true;
+
+        float gain_l, gain_r;
+        voice_spatial_gains(&params, src->sender_id, &gain_l, &gain_r);
+        if (!src->has_gain) {
+            src->gain_l = gain_l;
+            src->gain_r = gain_r;
+            src->has_gain = true;
+        }
+
+        // Ramp from last frame's gains so moving sources don't click
+        if (src->gain_l != 0.0f || src->gain_r != 0.0f || gain_l != 0.0f || gain_r != 0.0f) {
+            mix_mono_into_stereo(mix, voice_pcm[s], n, src->gain_l, src->gain_r,
+                                 (gain_l - src->gain_l) / (float)n,
+                                 (gain_r - src->gain_r) / (float)n);
+        }
+        src->gain_l = gain_l;
+        src->gain_r = gain_r;
+    }
+
+    if (!mixed) {
+        // Let the filter ring out into silence so the next talk spurt starts clean
+        memset(voice_resampler.history, 0, sizeof(voice_resampler.history));
+        return;
+    }
+
+    static int16_t frame[VOICE_MAX_FRAME_SAMPLES * 2 * RESAMPLE_FACTOR];
+    if (voice_output_rate == 48000) {
+        static float upsampled[VOICE_MAX_FRAME_SAMPLES * 2 * RESAMPLE_FACTOR];
+        resample_frames(&voice_resampler, mix, n, upsampled);
+        saturate_to_int16(upsampled, frame, n * 2 * RESAMPLE_FACTOR);
+        voice_output_write(frame, n * 2 * RESAMPLE_FACTOR);
+    } else {
+        saturate_to_int16(mix, frame, n * 2);
+        voice_output_write(frame, n * 2);
+    }
+    voice_stat_frames_mixed++;
+}
+
+static void* voice_thread_main(void* arg) {
+    (void)arg;
+    const double period_ms = (double)voice_samples_per_frame / 8.0;
+    double next = voice_now_ms();
+
+    while (!__atomic_load_n(&voice_stop, __ATOMIC_ACQUIRE)) {
+        voice_engine_tick();
+
+        next += period_ms;
+        double now = voice_now_ms();
+        // Way behind (process was suspended): resync instead of bursting frames
+        if (now - next > period_ms * 5.0) next = now;
+        double wait_ms = next - now;
+        if (wait_ms > 0.0) {
+            struct timespec ts;
+            ts.tv_sec = (time_t)(wait_ms / 1000.0);
+            ts.tv_nsec = (long)((wait_ms - ts.tv_sec * 1000.0) * 1e6);
+            nanosleep(&ts, NULL);
+        }
+    }
+    return NULL;
+}
+
+static void voice_engine_shutdown(void) {
+    if (!voice_running) return;
+    __atomic_store_n(&voice_stop, true, __ATOMIC_RELEASE);
+    pthread_join(voice_thread, NULL);
+    voice_running = false;
+
+    for (int i = 0; i < VOICE_MAX_SOURCES; i++) {
+        if (voice_sources[i].used) voice_source_release(&voice_sources[i]);
+        voice_speaking_id[i] = 0;
+        voice_speaking_ms[i] = 0;
+    }
+    voice_packet_head = voice_packet_tail = 0;
+    pthread_mutex_lock(&voice_output_mutex);
+    voice_output_head = voice_output_tail = 0;
+    pthread_mutex_unlock(&voice_output_mutex);
+}
+
+// Queue a message for the engine (JS thread only); false if the ring is full
+static bool voice_post(VoiceMsgType type, uint32_t sender_id, uint32_t sequence,
+                       const uint8_t* bytes, size_t len) {
+    uint32_t head = voice_packet_head;
+    uint32_t tail = __atomic_load_n(&voice_packet_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= VOICE_PACKET_RING) return false;
+
+    VoiceMsg* msg = &voice_packets[head & (VOICE_PACKET_RING - 1)];
+    msg->type = (uint8_t)type;
+    msg->sender_id = sender_id;
+    msg->sequence = sequence;
+    msg->len = (uint8_t)len;
+    if (len) memcpy(msg->bytes, bytes, len);
+    __atomic_store_n(&voice_packet_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * Start the voice engine thread.
+ *
+ * Args:
+ *   mode: Codec2 mode string used by every sender
+ *   outputRate: 8000 (default) or 48000 (upsampled with the polyphase resampler)
+ *
+ * Returns true on success. Restarting with a new mode or rate drops all streams.
+ */
+static napi_value VoiceEngineStart(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    char mode_str[16] = {0};
+    size_t mode_len;
+    if (argc < 1 || napi_get_value_string_utf8(env, args[0], mode_str, sizeof(mode_str), &mode_len) != napi_ok) {
+        napi_throw_type_error(env, NULL, "Expected codec2 mode string");
+        return NULL;
+    }
+
+    int mode = mode_from_string(mode_str);
+    if (mode < 0) {
+        napi_throw_error(env, NULL, "Invalid codec2 mode");
+        return NULL;
+    }
+
+    int32_t rate = 8000;
+    if (argc >= 2) napi_get_value_int32(env, args[1], &rate);
+    if (rate != 8000 && rate != 48000) {
+        napi_throw_range_error(env, NULL, "Voice output rate must be 8000 or 48000");
+        return NULL;
+    }
+
+    napi_value result;
+    if (voice_running && mode == voice_mode && rate == voice_output_rate) {
+        napi_get_boolean(env, true, &result);
+        return result;
+    }
+    voice_engine_shutdown();
+
+    struct CODEC2* probe = codec2_create(mode);
+    if (!probe) {
+        napi_throw_error(env, NULL, "Failed to create codec2 instance");
+        return NULL;
+    }
+    voice_samples_per_frame = codec2_samples_per_frame(probe);
+    voice_bytes_per_frame = codec2_bytes_per_frame(probe);
+    codec2_destroy(probe);
+
+    bool ok = voice_samples_per_frame <= VOICE_MAX_FRAME_SAMPLES &&
+              voice_bytes_per_frame <= VOICE_MAX_PAYLOAD;
+    if (ok) {
+        voice_mode = mode;
+        voice_output_rate = rate;
+        pthread_once(&resample_once, init_resample_coeffs);
+        memset(&voice_resampler, 0, sizeof(voice_resampler));
+        voice_resampler.channels = 2;
+        voice_stop = false;
+        voice_stat_packets_dropped = 0;
+        voice_stat_frames_mixed = 0;
+        voice_stat_frames_lost = 0;
+        voice_stat_output_overflows = 0;
+        ok = pthread_create(&voice_thread, NULL, voice_thread_main, NULL) == 0;
+        voice_running = ok;
+    }
+
+    napi_get_boolean(env, ok, &result);
+    return result;
+}
+
+// voiceEngineStop() => void
+static napi_value VoiceEngineStop(napi_env env, napi_callback_info info) {
+    (void)env;
+    (void)info;
+    voice_engine_shutdown();
+    return NULL;
+}
+
+/**
+ * Queue a received voice packet for playback.
+ *
+ * Args:
+ *   senderId: Truncated sender id (uint32)
+ *   sequence: Packet sequence number (uint32)
+ *   bytes: Codec2 payload (Uint8Array, one frame)
+ *
+ * Returns false if the packet was dropped (engine stopped, queue full, or
+ * payload too large).
+ */
+static napi_value VoiceEnginePush(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 3) {
+        napi_throw_type_error(env, NULL, "Expected (senderId, sequence, bytes)");
+        return NULL;
+    }
+
+    uint32_t sender_id, sequence;
+    napi_get_value_uint32(env, args[0], &sender_id);
+    napi_get_value_uint32(env, args[1], &sequence);
+
+    size_t length;
+    uint8_t* bytes = get_typed_data(env, args[2], napi_uint8_array, &length,
+                                    "Expected Uint8Array for bytes");
+    if (!bytes) return NULL;
+
+    bool ok = voice_running && length > 0 && length <= VOICE_MAX_PAYLOAD &&
+              voice_post(VOICE_MSG_PACKET, sender_id, sequence, bytes, length);
+    if (!ok) voice_stat_packets_dropped++;
+
+    napi_value result;
+    napi_get_boolean(env, ok, &result);
+    return result;
+}
+
+// Find or claim the position entry for a sender (params mutex held)
+static VoicePosition* voice_position_entry(uint32_t sender_id, bool create) {
+    VoicePosition* free_entry = NULL;
+    for (int i = 0; i < VOICE_MAX_SOURCES; i++) {
+        VoicePosition* pos = &voice_params.positions[i];
+        if (pos->used && pos->sender_id == sender_id) return pos;
+        if (!pos->used && !free_entry) free_entry = pos;
+    }
+    if (!create || !free_entry) return NULL;
+    free_entry->used = true;
+    free_entry->sender_id = sender_id;
+    return free_entry;
+}
+
+// voiceEngineSetListener(x, y, z, yaw) => void
+static napi_value VoiceEngineSetListener(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    double v[4] = {0};
+    for (size_t i = 0; i < 4 && i < argc; i++) napi_get_value_double(env, args[i], &v[i]);
+
+    pthread_mutex_lock(&voice_params_mutex);
+    voice_params.listener_x = (float)v[0];
+    voice_params.listener_y = (float)v[1];
+    voice_params.listener_z = (float)v[2];
+    voice_params.listener_yaw = (float)v[3];
+    pthread_mutex_unlock(&voice_params_mutex);
+    return NULL;
+}
+
+// voiceEngineSetSourcePosition(senderId, x, y, z) => void
+static napi_value VoiceEngineSetSourcePosition(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value args[4];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 4) {
+        napi_throw_type_error(env, NULL, "Expected (senderId, x, y, z)");
+        return NULL;
+    }
+
+    uint32_t sender_id;
+    double x, y, z;
+    napi_get_value_uint32(env, args[0], &sender_id);
+    napi_get_value_double(env, args[1], &x);
+    napi_get_value_double(env, args[2], &y);
+    napi_get_value_double(env, args[3], &z);
+
+    pthread_mutex_lock(&voice_params_mutex);
+    VoicePosition* pos = voice_position_entry(sender_id, true);
+    if (pos) {
+        pos->x = (float)x;
+        pos->y = (float)y;
+        pos->z = (float)z;
+    }
+    pthread_mutex_unlock(&voice_params_mutex);
+    return NULL;
+}
+
+// Drop a sender's stream, decoder and position
+// voiceEngineRemoveSource(senderId) => void
+static napi_value VoiceEngineRemoveSource(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    uint32_t sender_id = 0;
+    if (argc >= 1) napi_get_value_uint32(env, args[0], &sender_id);
+
+    pthread_mutex_lock(&voice_params_mutex);
+    VoicePosition* pos = voice_position_entry(sender_id, false);
+    if (pos) memset(pos, 0, sizeof(VoicePosition));
+    pthread_mutex_unlock(&voice_params_mutex);
+
+    if (voice_running && !voice_post(VOICE_MSG_REMOVE, sender_id, 0, NULL, 0)) {
+        voice_stat_packets_dropped++;
+    }
+    return NULL;
+}
+
+// Drop every stream and position (round restart, disconnect)
+// voiceEngineClear() => void
+static napi_value VoiceEngineClear(napi_env env, napi_callback_info info) {
+    (void)env;
+    (void)info;
+    pthread_mutex_lock(&voice_params_mutex);
+    memset(voice_params.positions, 0, sizeof(voice_params.positions));
+    pthread_mutex_unlock(&voice_params_mutex);
+
+    if (voice_running) voice_post(VOICE_MSG_CLEAR, 0, 0, NULL, 0);
+    return NULL;
+}
+
+/**
+ * Set mix parameters (same meaning as SpatialMixer's setters).
+ *
+ * Args:
+ *   maxDistance: Beyond this, voices are silent
+ *   outputVolume: 0-100
+ *   spatialEnabled: false = every voice centered at full volume
+ */
+static napi_value VoiceEngineSetMix(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value args[3];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 3) {
+        napi_throw_type_error(env, NULL, "Expected (maxDistance, outputVolume, spatialEnabled)");
+        return NULL;
+    }
+
+    double max_distance, volume;
+    bool spatial;
+    napi_get_value_double(env, args[0], &max_distance);
+    napi_get_value_double(env, args[1], &volume);
+    napi_get_value_bool(env, args[2], &spatial);
+
+    pthread_mutex_lock(&voice_params_mutex);
+    voice_params.max_distance = (float)fmax(1.0, max_distance);
+    voice_params.output_volume = (float)(fmin(100.0, fmax(0.0, volume)) / 100.0);
+    voice_params.spatial_enabled = spatial;
+    pthread_mutex_unlock(&voice_params_mutex);
+    return NULL;
+}
+
+/**
+ * Drain mixed audio (stereo interleaved int16 at the output rate) into a caller buffer.
+ *
+ * Args:
+ *   out: Int16Array to fill
+ *
+ * Returns the number of int16 values written (always even); 0 while the
+ * effect mixer plays voice (audioStart with routeVoice).
+ */
+static napi_value VoiceEngineRead(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "Expected Int16Array for out");
+        return NULL;
+    }
+
+    size_t length;
+    int16_t* out = get_typed_data(env, args[0], napi_int16_array, &length,
+                                  "Expected Int16Array for out");
+    if (!out) return NULL;
+
+    napi_value result;
+    if (voice_is_routed()) {
+        // Played through the effect mixer
+        napi_create_uint32(env, 0, &result);
+        return result;
+    }
+
+    uint32_t tail = voice_output_tail;
+    uint32_t head = __atomic_load_n(&voice_output_head, __ATOMIC_ACQUIRE);
+    uint32_t count = head - tail;
+    if (count > (uint32_t)(length & ~(size_t)1)) count = (uint32_t)(length & ~(size_t)1);
+
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = voice_output[(tail + i) & (VOICE_OUTPUT_RING - 1)];
+    }
+    __atomic_store_n(&voice_output_tail, tail + count, __ATOMIC_RELEASE);
+
+    napi_create_uint32(env, count, &result);
+    return result;
+}
+
+/**
+ * Senders the engine played a frame for recently.
+ *
+ * Args:
+ *   windowMs: How far back counts as speaking
+ *
+ * Returns an array of sender ids.
+ */
+static napi_value VoiceEngineGetSpeaking(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    double window_ms = 300.0;
+    if (argc >= 1) napi_get_value_double(env, args[0], &window_ms);
+
+    napi_value result;
+    napi_create_array(env, &result);
+    if (!voice_running) return result;
+
+    uint64_t now = (uint64_t)voice_now_ms();
+    uint32_t count = 0;
+    for (int i = 0; i < VOICE_MAX_SOURCES; i++) {
+        uint64_t played = __atomic_load_n(&voice_speaking_ms[i], __ATOMIC_RELAXED);
+        if (played == 0 || (double)(now - played) > window_ms) continue;
+
+        napi_value id;
+        napi_create_uint32(env, __atomic_load_n(&voice_speaking_id[i], __ATOMIC_RELAXED), &id);
+        napi_set_element(env, result, count++, id);
+    }
+    return result;
+}
+
+// voiceEngineGetStats() => { running, packetsDropped, framesMixed, framesLost, outputOverflows, outputQueued }
+static napi_value VoiceEngineGetStats(napi_env env, napi_callback_info info) {
+    (void)info;
+    napi_value result, val;
+    napi_create_object(env, &result);
+
+    napi_get_boolean(env, voice_running, &val);
+    napi_set_named_property(env, result, "running", val);
+
+#define SET_STAT(name, value) \
+    napi_create_uint32(env, (value), &val); \
+    napi_set_named_property(env, result, name, val)
+
+    SET_STAT("packetsDropped", voice_stat_packets_dropped);
+    SET_STAT("framesMixed", __atomic_load_n(&voice_stat_frames_mixed, __ATOMIC_RELAXED));
+    SET_STAT("framesLost", __atomic_load_n(&voice_stat_frames_lost, __ATOMIC_RELAXED));
+    SET_STAT("outputOverflows", __atomic_load_n(&voice_stat_output_overflows, __ATOMIC_RELAXED));
+    SET_STAT("outputQueued", __atomic_load_n(&voice_output_head, __ATOMIC_ACQUIRE) - voice_output_tail);
+#undef SET_STAT
+
+    return result;
+}
+
+// ============================================================================
+// Effect Mixer
+// ============================================================================
+//
+// Game sound effects (SoundEngine) used to be synthesized in JS per play and
+// each given its own audio device stream. Now JS renders every effect once
+// into a mono 48kHz wavetable (audioLoadEffect) and a native thread mixes a
+// fixed pool of playing voices into one stereo output ring:
+//
+//   - audioPlay queues a command (SPSC ring like the voice packet ring); the
+//     mixer starts it on a free voice or steals the lowest priority one
+//     (then the quietest, then the oldest). A sound that outranks nothing
+//     playing is dropped.
+//   - Positional voices use the voice engine's listener and the same
+//     distance/pan math as voice chat, recomputed every block and ramped
+//     across it so moving listeners don't click
+//   - With routeVoice the engine's 48kHz voice output is mixed in as well,
+//     so everything leaves through this ring instead of two device streams
+//   - The mixer keeps only targetMs of audio queued ahead of the reader (the
+//     device stream's read callback drains it through audioRead), which
+//     bounds latency for newly started sounds
+//
+// Threading mirrors the voice engine: commands JS -> mixer and output
+// mixer -> JS are single producer/single consumer rings; the listener and
+// master volume come from voice_params, copied once per block. Wavetables
+// are only replaced while the mixer is stopped.
+
+#define SFX_MAX_EFFECTS 64
+#define SFX_MAX_VOICES 32
+#define SFX_MAX_EFFECT_SAMPLES (48000 * 4)  // 4s per wavetable
+#define SFX_CMD_RING 256                   // Power of two
+#define SFX_OUTPUT_RING 32768              // int16 values (~340ms stereo @ 48kHz), power of two
+#define SFX_OUTPUT_RATE 48000
+#define SFX_BLOCK_FRAMES 240               // 5ms per mix block
+#define SFX_MAX_DISTANCE 60.0f             // Beyond this, effects are silent (SoundEngine)
+#define SFX_VOICE_MAX_BACKLOG 19200        // int16 values (200ms) of voice kept before dropping
+
+// The mixer has no resampler of its own, so voice at any other output rate
+// (e.g. codec2's native 8kHz) is not routed: voiceEngineRead keeps serving it
+static bool voice_is_routed(void) {
+    return __atomic_load_n(&voice_routed, __ATOMIC_ACQUIRE) &&
+           voice_running && voice_output_rate == SFX_OUTPUT_RATE;
+}
+
+typedef enum {
+    SFX_CMD_PLAY,
+    SFX_CMD_STOP_ALL,
+} SfxCmdType;
+
+typedef struct {
+    uint8_t type;
+    uint8_t effect;
+    uint8_t priority;
+    bool positional;
+    float x, y, z;
+    float volume;
+} SfxCmd;
+
+// A playing effect, owned by the mixer thread
+typedef struct {
+    bool active;
+    bool positional;
+    bool has_gain;          // gain_l/gain_r hold the previous block's gains
+    uint8_t effect;
+    uint8_t priority;
+    uint32_t pos;           // Next wavetable sample
+    uint32_t order;         // Start order, for stealing the oldest
+    float x, y, z;
+    float volume;
+    float gain_l, gain_r;
+} SfxVoice;
+
+static pthread_t sfx_thread;
+static bool sfx_running = false;
+static bool sfx_stop = false;
+static uint32_t sfx_target_depth = 0;  // int16 values kept queued ahead of the reader
+
+static int16_t* sfx_effects[SFX_MAX_EFFECTS];
+static uint32_t sfx_effect_len[SFX_MAX_EFFECTS];
+
+static SfxVoice sfx_voices[SFX_MAX_VOICES];
+static uint32_t sfx_order = 0;
+
+static SfxCmd sfx_cmds[SFX_CMD_RING];
+static uint32_t sfx_cmd_head = 0;  // Written by JS
+static uint32_t sfx_cmd_tail = 0;  // Written by the mixer
+
+static int16_t sfx_output[SFX_OUTPUT_RING];
+static uint32_t sfx_output_head = 0;  // Written by the mixer
+static uint32_t sfx_output_tail = 0;  // Written by JS
+
+// Stats
+static uint32_t sfx_stat_started = 0;    // Mixer thread
+static uint32_t sfx_stat_stolen = 0;     // Mixer thread
+static uint32_t sfx_stat_dropped = 0;    // Mixer thread and JS (full command ring)
+static uint32_t sfx_stat_underruns = 0;  // JS thread
+static uint32_t sfx_stat_voice_dropped = 0;  // Mixer thread
+
+// Loudest channel gain a voice currently plays at
+static inline float sfx_voice_level(const SfxVoice* v) {
+    return v->has_gain ? fmaxf(v->gain_l, v->gain_r) : v->volume;
+}
+
+// Start an effect, stealing a voice if the pool is full
+static void sfx_start(const SfxCmd* cmd, const VoiceParams* params) {
+    if (!sfx_effects[cmd->effect]) {
+        __atomic_fetch_add(&sfx_stat_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+    // Out of earshot when it starts: don't spend (or steal) a voice on it
+    if (cmd->positional) {
+        float attenuation, pan;
+        spatial_attenuation(params, cmd->x, cmd->y, cmd->z, SFX_MAX_DISTANCE, &attenuation, &pan);
+        if (attenuation * cmd->volume < VOICE_MIN_VOLUME) return;
+    }
+
+    SfxVoice* voice = NULL;
+    for (int i = 0; i < SFX_MAX_VOICES && !voice; i++) {
+        if (!sfx_voices[i].active) voice = &sfx_voices[i];
+    }
+    if (!voice) {
+        SfxVoice* victim = &sfx_voices[0];
+        for (int i = 1; i < SFX_MAX_VOICES; i++) {
+            SfxVoice* v = &sfx_voices[i];
+            if (v->priority != victim->priority) {
+                if (v->priority < victim->priority) victim = v;
+                continue;
+            }
+            float level = sfx_voice_level(v);
+            float victim_level = sfx_voice_level(victim);
+            if (level < victim_level || (level == victim_level && (int32_t)(v->order - victim->order) < 0)) {
+                victim = v;
+            }
+        }
+        if (victim->priority > cmd->priority) {
+            __atomic_fetch_add(&sfx_stat_dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        voice = victim;
+        sfx_stat_stolen++;
+    }
+
+    voice->active = true;
+    voice->positional = cmd->positional;
+    voice->has_gain = false;
+    voice->effect = cmd->effect;
+    voice->priority = cmd->priority;
+    voice->pos = 0;
+    voice->order = sfx_order++;
+    voice->x = cmd->x;
+    voice->y = cmd->y;
+    voice->z = cmd->z;
+    voice->volume = cmd->volume;
+    sfx_stat_started++;
+}
+
+// Add up to frames of routed voice output to acc, dropping a backlog nobody heard
+static void sfx_mix_voice(float* acc, int frames) {
+    pthread_mutex_lock(&voice_output_mutex);
+    uint32_t tail = voice_output_tail;
+    uint32_t head = __atomic_load_n(&voice_output_head, __ATOMIC_ACQUIRE);
+    uint32_t available = head - tail;
+    if (available > SFX_VOICE_MAX_BACKLOG) {
+        uint32_t skip = (available - SFX_VOICE_MAX_BACKLOG) & ~1u;
+        sfx_stat_voice_dropped += skip / 2;
+        tail += skip;
+        available -= skip;
+    }
+    uint32_t count = (uint32_t)frames * 2;
+    if (count > available) count = available;
+    for (uint32_t i = 0; i < count; i++) {
+        acc[i] += (float)voice_output[(tail + i) & (VOICE_OUTPUT_RING - 1)];
+    }
+    __atomic_store_n(&voice_output_tail, tail + count, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&voice_output_mutex);
+}
+
+// Mix one block of every playing voice (and routed voice chat) into the output ring
+static void sfx_mix_block(void) {
+    VoiceParams params;
+    pthread_mutex_lock(&voice_params_mutex);
+    params = voice_params;
+    pthread_mutex_unlock(&voice_params_mutex);
+
+    float mix[SFX_BLOCK_FRAMES * 2];
+    memset(mix, 0, sizeof(mix));
+
+    for (int i = 0; i < SFX_MAX_VOICES; i++) {
+        SfxVoice* v = &sfx_voices[i];
+        if (!v->active) continue;
+
+        float volume = v->volume * params.effects_volume;
+        float pan = 0.0f;
+        if (v->positional) {
+            float attenuation;
+            spatial_attenuation(&params, v->x, v->y, v->z, SFX_MAX_DISTANCE, &attenuation, &pan);
+            volume *= attenuation;
+        }
+        float gain_l, gain_r;
+        pan_gains(volume, pan, &gain_l, &gain_r);
+        if (!v->has_gain) {
+            v->gain_l = gain_l;
+            v->gain_r = gain_r;
+            v->has_gain = true;
+        }
+
+        // Out of earshot voices keep their place in the sound without mixing
+        uint32_t remaining = sfx_effect_len[v->effect] - v->pos;
+        int n = remaining < SFX_BLOCK_FRAMES ? (int)remaining : SFX_BLOCK_FRAMES;
+        if (v->gain_l != 0.0f || v->gain_r != 0.0f || gain_l != 0.0f || gain_r != 0.0f) {
+            mix_mono_into_stereo(mix, sfx_effects[v->effect] + v->pos, n, v->gain_l, v->gain_r,
+                                 (gain_l - v->gain_l) / (float)SFX_BLOCK_FRAMES,
+                                 (gain_r - v->gain_r) / (float)SFX_BLOCK_FRAMES);
+        }
+        v->gain_l = gain_l;
+        v->gain_r = gain_r;
+        v->pos += (uint32_t)n;
+        if (v->pos >= sfx_effect_len[v->effect]) v->active = false;
+    }
+
+    if (voice_is_routed()) {
+        sfx_mix_voice(mix, SFX_BLOCK_FRAMES);
+    }
+
+    int16_t block[SFX_BLOCK_FRAMES * 2];
+    saturate_to_int16(mix, block, SFX_BLOCK_FRAMES * 2);
+
+    uint32_t head = sfx_output_head;
+    for (int i = 0; i < SFX_BLOCK_FRAMES * 2; i++) {
+        sfx_output[(head + (uint32_t)i) & (SFX_OUTPUT_RING - 1)] = block[i];
+    }
+    __atomic_store_n(&sfx_output_head, head + SFX_BLOCK_FRAMES * 2, __ATOMIC_RELEASE);
+}
+
+static void* sfx_thread_main(void* arg) {
+    (void)arg;
+    while (!__atomic_load_n(&sfx_stop, __ATOMIC_ACQUIRE)) {
+        // Commands first, so a sound starts in the very next block
+        uint32_t head = __atomic_load_n(&sfx_cmd_head, __ATOMIC_ACQUIRE);
+        uint32_t tail = sfx_cmd_tail;
+        VoiceParams params;
+        if (tail != head) {
+            pthread_mutex_lock(&voice_params_mutex);
+            params = voice_params;
+            pthread_mutex_unlock(&voice_params_mutex);
+        }
+        for (; tail != head; tail++) {
+            const SfxCmd* cmd = &sfx_cmds[tail & (SFX_CMD_RING - 1)];
+            if (cmd->type == SFX_CMD_PLAY) {
+                sfx_start(cmd, &params);
+            } else {
+                for (int i = 0; i < SFX_MAX_VOICES; i++) sfx_voices[i].active = false;
+            }
+        }
+        __atomic_store_n(&sfx_cmd_tail, tail, __ATOMIC_RELEASE);
+
+        // Top the ring up to the target depth, then wait for the reader
+        uint32_t queued = sfx_output_head - __atomic_load_n(&sfx_output_tail, __ATOMIC_ACQUIRE);
+        if (queued + SFX_BLOCK_FRAMES * 2 <= sfx_target_depth) {
+            sfx_mix_block();
+            continue;
+        }
+        struct timespec ts = {0, (long)(SFX_BLOCK_FRAMES * 1e9 / SFX_OUTPUT_RATE / 4)};
+        nanosleep(&ts, NULL);
+    }
+    return NULL;
+}
+
+static void sfx_shutdown(void) {
+    if (!sfx_running) return;
+    __atomic_store_n(&sfx_stop, true, __ATOMIC_RELEASE);
+    pthread_join(sfx_thread, NULL);
+    sfx_running = false;
+    __atomic_store_n(&voice_routed, false, __ATOMIC_RELEASE);
+
+    memset(sfx_voices, 0, sizeof(sfx_voices));
+    sfx_cmd_head = sfx_cmd_tail = 0;
+    sfx_output_head = sfx_output_tail = 0;
+}
+
+// Queue a command for the mixer (JS thread only); false if the ring is full
+static bool sfx_post(const SfxCmd* cmd) {
+    uint32_t head = sfx_cmd_head;
+    uint32_t tail = __atomic_load_n(&sfx_cmd_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= SFX_CMD_RING) return false;
+    sfx_cmds[head & (SFX_CMD_RING - 1)] = *cmd;
+    __atomic_store_n(&sfx_cmd_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/**
+ * Store an effect's wavetable (mono 48kHz, samples in -1..1).
+ *
+ * Args:
+ *   id: Effect slot, 0-63
+ *   samples: Float32Array (at most 4s)
+ *
+ * Throws while the mixer is running (stop it to replace tables).
+ */
+static napi_value AudioLoadEffect(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 2) {
+        napi_throw_type_error(env, NULL, "Expected (id, samples)");
+        return NULL;
+    }
+
+    uint32_t id;
+    napi_get_value_uint32(env, args[0], &id);
+    if (id >= SFX_MAX_EFFECTS) {
+        napi_throw_range_error(env, NULL, "Effect id must be 0-63");
+        return NULL;
+    }
+    if (sfx_running) {
+        napi_throw_error(env, NULL, "Cannot load effects while the mixer is running");
+        return NULL;
+    }
+
+    size_t length;
+    float* samples = get_typed_data(env, args[1], napi_float32_array, &length,
+                                    "Expected Float32Array for samples");
+    if (!samples) return NULL;
+    if (length == 0 || length > SFX_MAX_EFFECT_SAMPLES) {
+        napi_throw_range_error(env, NULL, "Effect must be 1 to 192000 samples");
+        return NULL;
+    }
+
+    int16_t* table = realloc(sfx_effects[id], length * sizeof(int16_t));
+    if (!table) {
+        napi_throw_error(env, NULL, "Failed to allocate effect");
+        return NULL;
+    }
+    for (size_t i = 0; i < length; i++) {
+        float x = fminf(1.0f, fmaxf(-1.0f, samples[i]));
+        table[i] = (int16_t)lrintf(x * 32767.0f);
+    }
+    sfx_effects[id] = table;
+    sfx_effect_len[id] = (uint32_t)length;
+    return NULL;
+}
+
+/**
+ * Start the mixer thread (stereo int16 at 48kHz).
+ *
+ * Args:
+ *   targetMs: Audio kept queued ahead of the reader (default 40, 5-300)
+ *   routeVoice: Mix the voice engine's output in (its voiceEngineRead then returns 0)
+ *               while the engine outputs at 48kHz; at 8kHz voice is read as before
+ *
+ * Returns true on success. Restarting drops every playing sound.
+ */
+static napi_value AudioStart(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value args[2];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    double target_ms = 40.0;
+    bool route_voice = false;
+    if (argc >= 1) napi_get_value_double(env, args[0], &target_ms);
+    if (argc >= 2) napi_get_value_bool(env, args[1], &route_voice);
+    target_ms = fmin(300.0, fmax(5.0, target_ms));
+
+    sfx_shutdown();
+
+    uint32_t blocks = (uint32_t)ceil(target_ms * SFX_OUTPUT_RATE / 1000.0 / SFX_BLOCK_FRAMES);
+    sfx_target_depth = blocks * SFX_BLOCK_FRAMES * 2;
+    sfx_stop = false;
+    sfx_stat_started = 0;
+    sfx_stat_stolen = 0;
+    sfx_stat_dropped = 0;
+    sfx_stat_underruns = 0;
+    sfx_stat_voice_dropped = 0;
+
+    bool ok = pthread_create(&sfx_thread, NULL, sfx_thread_main, NULL) == 0;
+    sfx_running = ok;
+    __atomic_store_n(&voice_routed, ok && route_voice, __ATOMIC_RELEASE);
+
+    napi_value result;
+    napi_get_boolean(env, ok, &result);
+    return result;
+}
+
+// audioStop() => void
+static napi_value AudioStop(napi_env env, napi_callback_info info) {
+    (void)env;
+    (void)info;
+    sfx_shutdown();
+    return NULL;
+}
+
+/**
+ * Play an effect.
+ *
+ * Args:
+ *   id: Effect slot loaded with audioLoadEffect
+ *   x, y, z: Source position (ignored unless positional)
+ *   volume: 0-1
+ *   priority: 0-255; a full pool steals the lowest priority voice at or below this
+ *   positional: false = centered at full volume
+ *
+ * Returns false if the command could not be queued.
+ */
+static napi_value AudioPlay(napi_env env, napi_callback_info info) {
+    size_t argc = 7;
+    napi_value args[7];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 7) {
+        napi_throw_type_error(env, NULL, "Expected (id, x, y, z, volume, priority, positional)");
+        return NULL;
+    }
+
+    uint32_t id, priority;
+    double x, y, z, volume;
+    bool positional;
+    napi_get_value_uint32(env, args[0], &id);
+    napi_get_value_double(env, args[1], &x);
+    napi_get_value_double(env, args[2], &y);
+    napi_get_value_double(env, args[3], &z);
+    napi_get_value_double(env, args[4], &volume);
+    napi_get_value_uint32(env, args[5], &priority);
+    napi_get_value_bool(env, args[6], &positional);
+
+    SfxCmd cmd = {
+        .type = SFX_CMD_PLAY,
+        .effect = (uint8_t)(id < SFX_MAX_EFFECTS ? id : 0),
+        .priority = (uint8_t)(priority < 255 ? priority : 255),
+        .positional = positional,
+        .x = (float)x,
+        .y = (float)y,
+        .z = (float)z,
+        .volume = (float)fmin(1.0, fmax(0.0, volume)),
+    };
+    bool ok = sfx_running && id < SFX_MAX_EFFECTS && sfx_post(&cmd);
+    if (!ok && sfx_running) __atomic_fetch_add(&sfx_stat_dropped, 1, __ATOMIC_RELAXED);
+
+    napi_value result;
+    napi_get_boolean(env, ok, &result);
+    return result;
+}
+
+// Silence every playing effect (routed voice keeps playing)
+// audioStopAll() => void
+static napi_value AudioStopAll(napi_env env, napi_callback_info info) {
+    (void)env;
+    (void)info;
+    SfxCmd cmd = {.type = SFX_CMD_STOP_ALL};
+    if (sfx_running) sfx_post(&cmd);
+    return NULL;
+}
+
+// Effect master volume, 0-1
+// audioSetVolume(volume) => void
+static napi_value AudioSetVolume(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    double volume = 1.0;
+    if (argc >= 1) napi_get_value_double(env, args[0], &volume);
+
+    pthread_mutex_lock(&voice_params_mutex);
+    voice_params.effects_volume = (float)fmin(1.0, fmax(0.0, volume));
+    pthread_mutex_unlock(&voice_params_mutex);
+    return NULL;
+}
+
+/**
+ * Drain mixed audio (stereo interleaved int16 at 48kHz) into a caller buffer.
+ *
+ * Args:
+ *   out: Int16Array to fill
+ *
+ * Returns the number of int16 values written (always even). Asking for more
+ * than is queued counts an underrun.
+ */
+static napi_value AudioRead(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    if (argc < 1) {
+        napi_throw_type_error(env, NULL, "Expected Int16Array for out");
+        return NULL;
+    }
+
+    size_t length;
+    int16_t* out = get_typed_data(env, args[0], napi_int16_array, &length,
+                                  "Expected Int16Array for out");
+    if (!out) return NULL;
+
+    uint32_t wanted = (uint32_t)(length & ~(size_t)1);
+    uint32_t tail = sfx_output_tail;
+    uint32_t head = __atomic_load_n(&sfx_output_head, __ATOMIC_ACQUIRE);
+    uint32_t count = head - tail;
+    if (count > wanted) count = wanted;
+    if (sfx_running && count < wanted) sfx_stat_underruns++;
+
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = sfx_output[(tail + i) & (SFX_OUTPUT_RING - 1)];
+    }
+    __atomic_store_n(&sfx_output_tail, tail + count, __ATOMIC_RELEASE);
+
+    napi_value result;
+    napi_create_uint32(env, count, &result);
+    return result;
+}
+
+// audioGetStats() => { running, voiceRouted, activeVoices, started, stolen, dropped, underruns, voiceDropped, outputQueued }
+static napi_value AudioGetStats(napi_env env, napi_callback_info info) {
+    (void)info;
+    napi_value result, val;
+    napi_create_object(env, &result);
+
+    napi_get_boolean(env, sfx_running, &val);
+    napi_set_named_property(env, result, "running", val);
+    napi_get_boolean(env, voice_is_routed(), &val);
+    napi_set_named_property(env, result, "voiceRouted", val);
+
+    // Racy snapshot of the mixer's pool, good enough for a debug overlay
+    uint32_t active = 0;
+    for (int i = 0; i < SFX_MAX_VOICES; i++) {
+        if (__atomic_load_n(&sfx_voices[i].active, __ATOMIC_RELAXED)) active++;
+    }
+
+#define SET_STAT(name, value) \
+    napi_create_uint32(env, (value), &val); \
+    napi_set_named_property(env, result, name, val)
+
+    SET_STAT("activeVoices", active);
+    SET_STAT("started", __atomic_load_n(&sfx_stat_started, __ATOMIC_RELAXED));
+    SET_STAT("stolen", __atomic_load_n(&sfx_stat_stolen, __ATOMIC_RELAXED));
+    SET_STAT("dropped", __atomic_load_n(&sfx_stat_dropped, __ATOMIC_RELAXED));
+    SET_STAT("underruns", sfx_stat_underruns);
+    SET_STAT("voiceDropped", __atomic_load_n(&sfx_stat_voice_dropped, __ATOMIC_RELAXED));
+    SET_STAT("outputQueued", __atomic_load_n(&sfx_output_head, __ATOMIC_ACQUIRE) - sfx_output_tail);
+#undef SET_STAT
+
+    return result;
+}
+
+static void voice_engine_cleanup_hook(void* arg) {
+    (void)arg;
+    // The mixer drains the voice ring, so it stops first
+    sfx_shutdown();
+    voice_engine_shutdown();
+    for (int i = 0; i < SFX_MAX_EFFECTS; i++) {
+        free(sfx_effects[i]);
+        sfx_effects[i] = NULL;
+        sfx_effect_len[i] = 0;
+    }
+}
+
 // Module initialization
 static napi_value Init(napi_env env, napi_value exports) {
     napi_property_descriptor props[] = {
@@ -383,10 +2373,41 @@ static napi_value Init(napi_env env, napi_value exports) {
         {"encodeFrame", NULL, EncodeFrame, NULL, NULL, NULL, napi_default, NULL},
         {"decodeFrame", NULL, DecodeFrame, NULL, NULL, NULL, napi_default, NULL},
         {"getModes", NULL, GetModes, NULL, NULL, NULL, napi_default, NULL},
+        {"createEncoder", NULL, CreateEncoder, NULL, NULL, NULL, napi_default, NULL},
+        {"createDecoder", NULL, CreateDecoder, NULL, NULL, NULL, napi_default, NULL},
+        {"destroy", NULL, Destroy, NULL, NULL, NULL, napi_default, NULL},
+        {"encodeInto", NULL, EncodeInto, NULL, NULL, NULL, napi_default, NULL},
+        {"decodeInto", NULL, DecodeInto, NULL, NULL, NULL, napi_default, NULL},
+        {"mixInto", NULL, MixInto, NULL, NULL, NULL, napi_default, NULL},
+        {"createResampler", NULL, CreateResampler, NULL, NULL, NULL, napi_default, NULL},
+        {"resampleInto", NULL, ResampleInto, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEngineStart", NULL, VoiceEngineStart, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEngineStop", NULL, VoiceEngineStop, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEnginePush", NULL, VoiceEnginePush, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEngineSetListener", NULL, VoiceEngineSetListener, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEngineSetSourcePosition", NULL, VoiceEngineSetSourcePosition, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEngineRemoveSource", NULL, VoiceEngineRemoveSource, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEngineClear", NULL, VoiceEngineClear, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEngineSetMix", NULL, VoiceEngineSetMix, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEngineRead", NULL, VoiceEngineRead, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEngineGetSpeaking", NULL, VoiceEngineGetSpeaking, NULL, NULL, NULL, napi_default, NULL},
+        {"voiceEngineGetStats", NULL, VoiceEngineGetStats, NULL, NULL, NULL, napi_default, NULL},
+        {"audioLoadEffect", NULL, AudioLoadEffect, NULL, NULL, NULL, napi_default, NULL},
+        {"audioStart", NULL, AudioStart, NULL, NULL, NULL, napi_default, NULL},
+        {"audioStop", NULL, AudioStop, NULL, NULL, NULL, napi_default, NULL},
+        {"audioPlay", NULL, AudioPlay, NULL, NULL, NULL, napi_default, NULL},
+        {"audioStopAll", NULL, AudioStopAll, NULL, NULL, NULL, napi_default, NULL},
+        {"audioSetVolume", NULL, AudioSetVolume, NULL, NULL, NULL, napi_default, NULL},
+        {"audioRead", NULL, AudioRead, NULL, NULL, NULL, napi_default, NULL},
+        {"audioGetStats", NULL, AudioGetStats, NULL, NULL, NULL, napi_default, NULL},
+        JOB_SYSTEM_PROPERTIES,
     };
 
     napi_define_properties(env, exports, sizeof(props) / sizeof(props[0]), props);
 
+    // Join the engine and mixer threads before the addon is unloaded
+    napi_add_env_cleanup_hook(env, voice_engine_cleanup_hook, NULL);
+
     return exports;
 }
 
@@ -0,0 +1,562 @@
+/**
+ * Shared native job system (see job_system.h)
+ *
+ * A job occupies one of JOB_SLOTS slots while it runs. Workers scan the
+ * slots and claim chunks with an atomic add on the slot's next item, so
+ * independent submitters (JS thread, render thread, voice thread) never
+ * serialize on a lock. The submitter runs chunks of its own job, then waits
+ * on the slot's finished word. A slot is only reused once no worker is still
+ * looking at it (users == 0), so a late worker never runs a chunk of the
+ * next job with the previous job's function.
+ */
+
+#define _GNU_SOURCE
+#include "job_system.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+
+#ifdef __linux__
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+#endif
+#ifdef __APPLE__
+  #include <sys/sysctl.h>
+#endif
+
+#define JOB_SLOTS 16             // Jobs in flight at once; more run inline
+#define JOB_MAX_WORKERS 64
+#define JOB_SPIN_ITERATIONS 2000 // Empty scans before a worker parks
+#define JOB_MAX_CPUS 1024
+
+typedef enum {
+  SLOT_FREE = 0,
+  SLOT_SETUP,     // Submitter is filling it in
+  SLOT_RUNNING,   // Chunks may be claimed
+  SLOT_CLOSING,   // Done, waiting for workers to leave
+} SlotState;
+
+typedef struct __attribute__((aligned(64))) {
+  int state;          // SlotState
+  int users;          // Threads inside help_slot()
+  int tag;
+  JobRangeFn fn;
+  void* ctx;
+  int end;
+  int chunk;
+  int next;           // Next unclaimed item
+  int remaining;      // Items not finished yet
+  uint32_t finished;  // Futex word, 1 once remaining reaches 0
+  uint32_t waiting;   // Submitter is parked on finished
+} JobSlot;
+
+typedef struct JobPool JobPool;
+
+typedef struct {
+  JobPool* pool;
+  int index;
+  int cpu;            // CPU to pin to, -1 = unpinned
+} JobWorker;
+
+struct JobPool {
+  JobSystem api;      // First member: the handle other addons adopt
+  JobSlot slots[JOB_SLOTS];
+  pthread_t threads[JOB_MAX_WORKERS];
+  JobWorker workers[JOB_MAX_WORKERS];
+  int num_workers;
+  int physical_cores;
+  bool pinned;
+
+  uint32_t epoch;     // Futex word, bumped per submitted job; idle workers park on it
+  int sleepers;
+
+  JobSpanFn observer;
+  void* observer_user;
+
+  uint64_t stat_jobs;
+  uint64_t stat_inline_jobs;
+  uint64_t stat_parks;
+
+#ifndef __linux__
+  pthread_mutex_t park_mutex;
+  pthread_cond_t park_cond;
+#endif
+};
+
+// ============================================================================
+// Parking
+// ============================================================================
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+static uint64_t job_clock_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Sleep while *addr == expected (spurious returns are fine, callers re-check)
+static void park_wait(JobPool* p, uint32_t* addr, uint32_t expected) {
+#ifdef __linux__
+  (void)p;
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#else
+  pthread_mutex_lock(&p->park_mutex);
+  while (__atomic_load_n(addr, __ATOMIC_ACQUIRE) == expected) {
+    pthread_cond_wait(&p->park_cond, &p->park_mutex);
+  }
+  pthread_mutex_unlock(&p->park_mutex);
+#endif
+}
+
+// Wake every thread parked on addr (call after changing *addr)
+static void park_wake(JobPool* p, uint32_t* addr) {
+#ifdef __linux__
+  (void)p;
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+  (void)addr;
+  pthread_mutex_lock(&p->park_mutex);
+  pthread_cond_broadcast(&p->park_cond);
+  pthread_mutex_unlock(&p->park_mutex);
+#endif
+}
+
+// ============================================================================
+// Jobs
+// ============================================================================
+
+// Run chunks of one slot until none are left; true if any ran here
+static bool help_slot(JobPool* p, JobSlot* s, int* tag) {
+  bool ran = false;
+  __atomic_add_fetch(&s->users, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&s->state, __ATOMIC_SEQ_CST) == SLOT_RUNNING) {
+    *tag = s->tag;
+    JobRangeFn fn = s->fn;
+    void* ctx = s->ctx;
+    int end = s->end;
+    int chunk = s->chunk;
+    // Checking first keeps next from running far past end while the last chunk finishes
+    while (__atomic_load_n(&s->next, __ATOMIC_RELAXED) < end) {
+      int first = __atomic_fetch_add(&s->next, chunk, __ATOMIC_RELAXED);
+      if (first >= end) break;
+      int last = first + chunk < end ? first + chunk : end;
+      fn(ctx, first, last);
+      ran = true;
+      if (__atomic_sub_fetch(&s->remaining, last - first, __ATOMIC_ACQ_REL) == 0) {
+        __atomic_store_n(&s->finished, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&s->waiting, __ATOMIC_SEQ_CST)) park_wake(p, &s->finished);
+      }
+    }
+  }
+  __atomic_sub_fetch(&s->users, 1, __ATOMIC_RELEASE);
+  return ran;
+}
+
+static JobSlot* claim_slot(JobPool* p) {
+  for (int i = 0; i < JOB_SLOTS; i++) {
+    int expected = SLOT_FREE;
+    if (__atomic_compare_exchange_n(&p->slots[i].state, &expected, SLOT_SETUP, false,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      return &p->slots[i];
+    }
+  }
+  return NULL;
+}
+
+static void pool_parallel_for(JobSystem* js, int tag, JobRangeFn fn, void* ctx,
+                              int start, int end, int chunk, int min_parallel) {
+  JobPool* p = (JobPool*)js;
+  if (end <= start) return;
+  if (chunk < 1) chunk = 1;
+
+  JobSlot* s = NULL;
+  if (p->num_workers > 0 && end - start >= min_parallel && end - start > chunk) s = claim_slot(p);
+  if (!s) {
+    __atomic_fetch_add(&p->stat_inline_jobs, 1, __ATOMIC_RELAXED);
+    fn(ctx, start, end);
+    return;
+  }
+  __atomic_fetch_add(&p->stat_jobs, 1, __ATOMIC_RELAXED);
+
+  s->tag = tag;
+  s->fn = fn;
+  s->ctx = ctx;
+  s->end = end;
+  s->chunk = chunk;
+  s->next = start;
+  s->remaining = end - start;
+  s->finished = 0;
+  s->waiting = 0;
+  __atomic_store_n(&s->state, SLOT_RUNNING, __ATOMIC_SEQ_CST);
+
+  __atomic_add_fetch(&p->epoch, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&p->sleepers, __ATOMIC_SEQ_CST) > 0) park_wake(p, &p->epoch);
+
+  help_slot(p, s, &tag);
+
+  // Chunks still running on workers: spin, then park on the finished word
+  for (int spin = 0; !__atomic_load_n(&s->finished, __ATOMIC_ACQUIRE); spin++) {
+    if (spin < JOB_SPIN_ITERATIONS) {
+      cpu_relax();
+      continue;
+    }
+    __atomic_store_n(&s->waiting, 1, __ATOMIC_SEQ_CST);
+    while (!__atomic_load_n(&s->finished, __ATOMIC_ACQUIRE)) park_wait(p, &s->finished, 0);
+  }
+
+  __atomic_store_n(&s->state, SLOT_CLOSING, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(&s->users, __ATOMIC_SEQ_CST) > 0) cpu_relax();
+  __atomic_store_n(&s->state, SLOT_FREE, __ATOMIC_RELEASE);
+}
+
+static void* worker_main(void* arg) {
+  JobWorker* w = (JobWorker*)arg;
+  JobPool* p = w->pool;
+
+#ifdef __linux__
+  if (w->cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(w->cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  }
+#endif
+
+  uint64_t idle_start = job_clock_ns();
+  int spins = 0;
+  for (;;) {
+    uint32_t epoch = __atomic_load_n(&p->epoch, __ATOMIC_SEQ_CST);
+    bool found = false;
+
+    for (int i = 0; i < JOB_SLOTS; i++) {
+      JobSlot* s = &p->slots[i];
+      if (__atomic_load_n(&s->state, __ATOMIC_ACQUIRE) != SLOT_RUNNING) continue;
+      JobSpanFn observer = __atomic_load_n(&p->observer, __ATOMIC_ACQUIRE);
+      uint64_t busy_start = observer ? job_clock_ns() : 0;
+      int tag = 0;
+      if (!help_slot(p, s, &tag)) continue;
+      found = true;
+      if (observer) {
+        uint64_t busy_end = job_clock_ns();
+        void* user = __atomic_load_n(&p->observer_user, __ATOMIC_RELAXED);
+        observer(user, w->index, tag, false, idle_start, busy_start);
+        observer(user, w->index, tag, true, busy_start, busy_end);
+        idle_start = busy_end;
+      }
+    }
+
+    if (found) {
+      spins = 0;
+      continue;
+    }
+    if (++spins < JOB_SPIN_ITERATIONS) {
+      cpu_relax();
+      continue;
+    }
+
+    // Park until a job is submitted after the epoch read above
+    spins = 0;
+    __atomic_fetch_add(&p->stat_parks, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&p->sleepers, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&p->epoch, __ATOMIC_SEQ_CST) == epoch) park_wait(p, &p->epoch, epoch);
+    __atomic_sub_fetch(&p->sleepers, 1, __ATOMIC_SEQ_CST);
+  }
+  return NULL;
+}
+
+static int pool_worker_count(const JobSystem* js) {
+  return ((const JobPool*)js)->num_workers;
+}
+
+static void pool_set_observer(JobSystem* js, JobSpanFn fn, void* user) {
+  JobPool* p = (JobPool*)js;
+  __atomic_store_n(&p->observer_user, user, __ATOMIC_RELAXED);
+  __atomic_store_n(&p->observer, fn, __ATOMIC_RELEASE);
+}
+
+static void pool_get_stats(const JobSystem* js, void* out) {
+  const JobPool* p = (const JobPool*)js;
+  JobStats* stats = (JobStats*)out;
+  stats->workers = p->num_workers;
+  stats->physical_cores = p->physical_cores;
+  stats->pinned = p->pinned;
+  stats->jobs = __atomic_load_n(&p->stat_jobs, __ATOMIC_RELAXED);
+  stats->inline_jobs = __atomic_load_n(&p->stat_inline_jobs, __ATOMIC_RELAXED);
+  stats->parks = __atomic_load_n(&p->stat_parks, __ATOMIC_RELAXED);
+}
+
+// ============================================================================
+// Topology
+// ============================================================================
+
+#ifdef __linux__
+static int read_sysfs_int(int cpu, const char* name) {
+  char path[128];
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+  FILE* f = fopen(path, "r");
+  if (!f) return -1;
+  int value = -1;
+  if (fscanf(f, "%d", &value) != 1) value = -1;
+  fclose(f);
+  return value;
+}
+#endif
+
+/**
+ * Count physical cores this process may run on.
+ * Args: cpus receives one usable CPU per physical core (for pinning).
+ * Returns: core count (>= 1), or logical CPUs when topology is unknown.
+ */
+static int detect_physical_cores(int* cpus, int max_cpus) {
+#ifdef __linux__
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    int keys[JOB_MAX_CPUS];
+    int cores = 0;
+    bool topology = true;
+    for (int cpu = 0; cpu < CPU_SETSIZE && cpu < JOB_MAX_CPUS; cpu++) {
+      if (!CPU_ISSET(cpu, &set)) continue;
+      int core = read_sysfs_int(cpu, "core_id");
+      int package = read_sysfs_int(cpu, "physical_package_id");
+      if (core < 0) topology = false;
+      // Without topology every logical CPU counts as a core
+      int key = topology ? (package < 0 ? 0 : package) * 65536 + core : -1 - cpu;
+      bool seen = false;
+      for (int i = 0; i < cores && !seen; i++) seen = keys[i] == key;
+      if (seen || cores >= max_cpus) continue;
+      keys[cores] = key;
+      cpus[cores] = cpu;
+      cores++;
+    }
+    if (cores > 0) return cores;
+  }
+#elif defined(__APPLE__)
+  int physical = 0;
+  size_t size = sizeof(physical);
+  if (sysctlbyname("hw.physicalcpu", &physical, &size, NULL, 0) == 0 && physical > 0) {
+    for (int i = 0; i < physical && i < max_cpus; i++) cpus[i] = -1;
+    return physical;
+  }
+#endif
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n < 1) n = 1;
+  for (int i = 0; i < n && i < max_cpus; i++) cpus[i] = -1;
+  return (int)n;
+}
+
+// ============================================================================
+// Pool lifetime
+// ============================================================================
+
+static JobSystem* g_jobs = NULL;          // Adopted or local pool
+static bool g_jobs_local = false;         // g_jobs was created by this copy
+static int g_config_threads = -1;         // -1 = CSTERM_JOB_THREADS or physical cores - 1
+static int g_config_pin = -1;             // -1 = CSTERM_JOB_PIN
+static pthread_mutex_t g_jobs_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static JobSystem* pool_create(void) {
+  JobPool* p = (JobPool*)aligned_alloc(64, (sizeof(JobPool) + 63) & ~(size_t)63);
+  if (!p) return NULL;
+  memset(p, 0, sizeof(*p));
+  p->api.magic = JOB_SYSTEM_MAGIC;
+  p->api.abi = JOB_SYSTEM_ABI;
+  p->api.parallel_for = pool_parallel_for;
+  p->api.worker_count = pool_worker_count;
+  p->api.set_observer = pool_set_observer;
+  p->api.get_stats = pool_get_stats;
+#ifndef __linux__
+  pthread_mutex_init(&p->park_mutex, NULL);
+  pthread_cond_init(&p->park_cond, NULL);
+#endif
+
+  static int core_cpus[JOB_MAX_CPUS];
+  p->physical_cores = detect_physical_cores(core_cpus, JOB_MAX_CPUS);
+
+  int threads = g_config_threads;
+  const char* env = getenv("CSTERM_JOB_THREADS");
+  if (threads < 0 && env && *env) threads = atoi(env);
+  if (threads < 0) threads = p->physical_cores - 1;
+  if (threads > JOB_MAX_WORKERS) threads = JOB_MAX_WORKERS;
+
+  int pin = g_config_pin;
+  env = getenv("CSTERM_JOB_PIN");
+  if (pin < 0) pin = env && *env == '1';
+#ifdef __linux__
+  p->pinned = pin && threads > 0;
+#else
+  p->pinned = false;  // No hard affinity off Linux
+#endif
+
+  for (int i = 0; i < threads; i++) {
+    JobWorker* w = &p->workers[i];
+    w->pool = p;
+    w->index = i;
+    // Core 0 of the set is left to the submitting threads
+    w->cpu = p->pinned ? core_cpus[(i + 1) % p->physical_cores] : -1;
+    if (pthread_create(&p->threads[i], NULL, worker_main, w) != 0) break;
+    pthread_detach(p->threads[i]);
+    p->num_workers++;
+  }
+  return &p->api;
+}
+
+JobSystem* jobs_get(void) {
+  JobSystem* js = __atomic_load_n(&g_jobs, __ATOMIC_ACQUIRE);
+  if (js) return js;
+  pthread_mutex_lock(&g_jobs_mutex);
+  if (!g_jobs) {
+    js = pool_create();
+    g_jobs_local = js != NULL;
+    __atomic_store_n(&g_jobs, js, __ATOMIC_RELEASE);
+  }
+  js = g_jobs;
+  pthread_mutex_unlock(&g_jobs_mutex);
+  return js;
+}
+
+void jobs_parallel_for(int tag, JobRangeFn fn, void* ctx, int start, int end, int chunk, int min_parallel) {
+  JobSystem* js = jobs_get();
+  if (!js) {
+    if (end > start) fn(ctx, start, end);
+    return;
+  }
+  js->parallel_for(js, tag, fn, ctx, start, end, chunk, min_parallel);
+}
+
+int jobs_worker_count(void) {
+  JobSystem* js = jobs_get();
+  return js ? js->worker_count(js) : 0;
+}
+
+// ============================================================================
+// N-API
+// ============================================================================
+
+#define JOBS_NAPI_CALL(env, call) do { \
+    if ((call) != napi_ok) { \
+      napi_throw_error(env, NULL, "N-API call failed"); \
+      return NULL; \
+    } \
+  } while (0)
+
+/**
+ * getJobSystem() -> handle
+ * This addon's pool (created now if it has none), for setJobSystem() on another addon.
+ */
+napi_value jobs_napi_get_job_system(napi_env env, napi_callback_info info) {
+  JobSystem* js = jobs_get();
+  if (!js) {
+    napi_throw_error(env, NULL, "Failed to create job system");
+    return NULL;
+  }
+  napi_value result;
+  JOBS_NAPI_CALL(env, napi_create_external(env, js, NULL, NULL, &result));
+  return result;
+}
+
+/**
+ * setJobSystem(handle) -> boolean
+ * Schedule this addon's work on another addon's pool. Only possible before
+ * this addon created its own (false otherwise, or for an incompatible handle).
+ */
+napi_value jobs_napi_set_job_system(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  JOBS_NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  void* data = NULL;
+  if (argc < 1 || napi_get_value_external(env, args[0], &data) != napi_ok || !data) {
+    napi_throw_type_error(env, NULL, "Expected a handle from getJobSystem");
+    return NULL;
+  }
+
+  JobSystem* other = (JobSystem*)data;
+  bool adopted = false;
+  if (other->magic == JOB_SYSTEM_MAGIC && other->abi == JOB_SYSTEM_ABI) {
+    pthread_mutex_lock(&g_jobs_mutex);
+    if (!g_jobs || g_jobs == other) {
+      g_jobs_local = false;
+      __atomic_store_n(&g_jobs, other, __ATOMIC_RELEASE);
+      adopted = true;
+    }
+    pthread_mutex_unlock(&g_jobs_mutex);
+  }
+
+  napi_value result;
+  JOBS_NAPI_CALL(env, napi_get_boolean(env, adopted, &result));
+  return result;
+}
+
+/**
+ * configureJobs({ threads?, pin? }) -> boolean
+ * Worker count and core pinning for this addon's pool, before it starts
+ * (false once it has). Overrides CSTERM_JOB_THREADS / CSTERM_JOB_PIN.
+ */
+napi_value jobs_napi_configure(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  JOBS_NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  bool applied = false;
+  pthread_mutex_lock(&g_jobs_mutex);
+  if (!g_jobs && argc >= 1) {
+    napi_value v;
+    bool has = false;
+    if (napi_has_named_property(env, args[0], "threads", &has) == napi_ok && has &&
+        napi_get_named_property(env, args[0], "threads", &v) == napi_ok) {
+      int32_t threads;
+      if (napi_get_value_int32(env, v, &threads) == napi_ok) g_config_threads = threads < 0 ? 0 : threads;
+    }
+    if (napi_has_named_property(env, args[0], "pin", &has) == napi_ok && has &&
+        napi_get_named_property(env, args[0], "pin", &v) == napi_ok) {
+      bool pin;
+      if (napi_get_value_bool(env, v, &pin) == napi_ok) g_config_pin = pin ? 1 : 0;
+    }
+    applied = true;
+  }
+  pthread_mutex_unlock(&g_jobs_mutex);
+
+  napi_value result;
+  JOBS_NAPI_CALL(env, napi_get_boolean(env, applied, &result));
+  return result;
+}
+
+/**
+ * getJobStats() -> { workers, physicalCores, pinned, shared, jobs, inlineJobs, parks }
+ * shared: this addon runs on another addon's pool.
+ */
+napi_value jobs_napi_get_stats(napi_env env, napi_callback_info info) {
+  JobSystem* js = jobs_get();
+  JobStats stats;
+  memset(&stats, 0, sizeof(stats));
+  if (js) js->get_stats(js, &stats);
+
+  napi_value result, v;
+  JOBS_NAPI_CALL(env, napi_create_object(env, &result));
+  JOBS_NAPI_CALL(env, napi_create_int32(env, stats.workers, &v));
+  JOBS_NAPI_CALL(env, napi_set_named_property(env, result, "workers", v));
+  JOBS_NAPI_CALL(env, napi_create_int32(env, stats.physical_cores, &v));
+  JOBS_NAPI_CALL(env, napi_set_named_property(env, result, "physicalCores", v));
+  JOBS_NAPI_CALL(env, napi_get_boolean(env, stats.pinned, &v));
+  JOBS_NAPI_CALL(env, napi_set_named_property(env, result, "pinned", v));
+  JOBS_NAPI_CALL(env, napi_get_boolean(env, js && !g_jobs_local, &v));
+  JOBS_NAPI_CALL(env, napi_set_named_property(env, result, "shared", v));
+  JOBS_NAPI_CALL(env, napi_create_double(env, (double)stats.jobs, &v));
+  JOBS_NAPI_CALL(env, napi_set_named_property(env, result, "jobs", v));
+  JOBS_NAPI_CALL(env, napi_create_double(env, (double)stats.inline_jobs, &v));
+  JOBS_NAPI_CALL(env, napi_set_named_property(env, result, "inlineJobs", v));
+  JOBS_NAPI_CALL(env, napi_create_double(env, (double)stats.parks, &v));
+  JOBS_NAPI_CALL(env, napi_set_named_property(env, result, "parks", v));
+  return result;
+}
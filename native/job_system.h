@@ -0,0 +1,98 @@
+/**
+ * Shared native job system for CS-CLI addons
+ *
+ * One pool of worker threads that the renderer (raster), bvh (collision) and
+ * codec2 (voice) addons all schedule onto, instead of each spawning its own
+ * threads and oversubscribing the cores.
+ *
+ * - Worker count defaults to physical cores - 1 (the submitting thread runs
+ *   work too); CSTERM_JOB_THREADS overrides it, 0 runs everything inline
+ * - Optional pinning of each worker to its own physical core (CSTERM_JOB_PIN=1
+ *   or configureJobs({ pin: true })), within the process's CPU set
+ * - parallel_for() splits a range into chunks claimed with one atomic add,
+ *   no lock per chunk; several threads may submit at once
+ * - Idle workers spin briefly, then park on a futex (condvar off Linux)
+ *
+ * Every addon compiles its own copy of job_system.c. The first addon loaded
+ * owns the pool; the others adopt it through getJobSystem()/setJobSystem()
+ * before their first job (see src/engine/NativeJobs.ts). The JobSystem struct
+ * is the ABI between copies, so calls always go through its function pointers.
+ */
+
+#ifndef CSTERM_JOB_SYSTEM_H
+#define CSTERM_JOB_SYSTEM_H
+
+#include <node_api.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define JOB_SYSTEM_MAGIC 0x534a4f42u  // Checked before adopting another addon's pool
+#define JOB_SYSTEM_ABI 1u
+
+// Tags passed to parallel_for() and reported to the observer: addons use
+// their own values >= 0, the shared ones mark work from the other addons
+#define JOB_TAG_VOICE -2
+#define JOB_TAG_COLLISION -3
+
+// Run items [start, end) of a job
+typedef void (*JobRangeFn)(void* ctx, int start, int end);
+
+/**
+ * Worker activity callback, called on the worker thread.
+ * busy spans cover one worker's stay in one job (tag is the job's tag);
+ * idle spans cover spinning and parked time between jobs.
+ * Times are CLOCK_MONOTONIC nanoseconds.
+ */
+typedef void (*JobSpanFn)(void* user, int worker, int tag, bool busy, uint64_t start_ns, uint64_t end_ns);
+
+typedef struct JobSystem JobSystem;
+
+struct JobSystem {
+  uint32_t magic;  // JOB_SYSTEM_MAGIC
+  uint32_t abi;    // JOB_SYSTEM_ABI
+
+  /**
+   * Run fn over [start, end) in chunks of chunk items and return when every
+   * item is done. The calling thread runs chunks too. Runs inline when the
+   * range is smaller than min_parallel items or there are no workers.
+   */
+  void (*parallel_for)(JobSystem* js, int tag, JobRangeFn fn, void* ctx,
+                       int start, int end, int chunk, int min_parallel);
+  int (*worker_count)(const JobSystem* js);
+  void (*set_observer)(JobSystem* js, JobSpanFn fn, void* user);
+  // Fill stats (JobStats) for getJobStats()
+  void (*get_stats)(const JobSystem* js, void* stats);
+};
+
+typedef struct {
+  int workers;
+  int physical_cores;
+  bool pinned;
+  uint64_t jobs;         // parallel_for() calls that used the workers
+  uint64_t inline_jobs;  // parallel_for() calls run on the caller alone
+  uint64_t parks;        // Times a worker went to sleep
+} JobStats;
+
+// Hidden so two addons' copies never bind to each other's symbols
+#define JOBS_API __attribute__((visibility("hidden")))
+
+// This addon's job system: the adopted one, else a local pool created on first use
+JOBS_API JobSystem* jobs_get(void);
+
+// Shorthands through jobs_get()
+JOBS_API void jobs_parallel_for(int tag, JobRangeFn fn, void* ctx, int start, int end, int chunk, int min_parallel);
+JOBS_API int jobs_worker_count(void);
+
+// N-API exports shared by every addon (add to its property list)
+JOBS_API napi_value jobs_napi_get_job_system(napi_env env, napi_callback_info info);
+JOBS_API napi_value jobs_napi_set_job_system(napi_env env, napi_callback_info info);
+JOBS_API napi_value jobs_napi_configure(napi_env env, napi_callback_info info);
+JOBS_API napi_value jobs_napi_get_stats(napi_env env, napi_callback_info info);
+
+#define JOB_SYSTEM_PROPERTIES \
+  { "getJobSystem", NULL, jobs_napi_get_job_system, NULL, NULL, NULL, napi_default, NULL }, \
+  { "setJobSystem", NULL, jobs_napi_set_job_system, NULL, NULL, NULL, napi_default, NULL }, \
+  { "configureJobs", NULL, jobs_napi_configure, NULL, NULL, NULL, napi_default, NULL }, \
+  { "getJobStats", NULL, jobs_napi_get_stats, NULL, NULL, NULL, napi_default, NULL }
+
+#endif
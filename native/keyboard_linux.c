@@ -0,0 +1,671 @@
+// Native Linux keyboard/mouse input using evdev
+// Reads /dev/input/event* on a dedicated thread for raw relative mouse
+// movement and true key up/down state (terminal input loses both)
+//
+// Exposes the same API as keyboard_mac.c. Linux key codes are translated to
+// macOS virtual key codes so the JS key tables work unchanged. Events go
+// through the same lock-free ring and drainInput() layout.
+//
+// Needs read access to /dev/input (usually membership in the "input" group).
+
+#include <node_api.h>
+#include <linux/input.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <dirent.h>
+#include <time.h>
+#include <math.h>
+#include <sys/ioctl.h>
+
+// ============ Input event ring ============
+
+// Event types (match INPUT_EVENT_* in NativeKeyboard.ts)
+#define INPUT_EVENT_KEY     1   // code = keycode, value = 1 down / 0 up
+#define INPUT_EVENT_BUTTON  2   // code = button, value = 1 down / 0 up
+#define INPUT_EVENT_MOTION  3   // code = dx, value = dy (1/256 pixel units)
+
+#define INPUT_MOTION_SCALE 256.0
+
+// drainInput() output layout (Int32Array)
+#define DRAIN_COUNT        0    // Events written
+#define DRAIN_DROPPED      1    // Events lost to ring overflow since last drain
+#define DRAIN_KEYS         2    // 8 words: key state bitset (256 keys)
+#define DRAIN_BUTTONS      10   // Mouse button bitmask
+#define DRAIN_FLAGS        11   // Bit 0: cursor captured
+#define DRAIN_HEADER_SIZE  12
+#define DRAIN_EVENT_STRIDE 4    // type, code, value, age (us before the drain)
+
+#define INPUT_RING_SIZE 4096    // Power of two; ~0.5s of 8kHz mouse movement
+
+typedef struct {
+    uint64_t time;              // CLOCK_MONOTONIC nanoseconds
+    int32_t type;
+    int32_t code;
+    int32_t value;
+} InputEvent;
+
+static InputEvent input_ring[INPUT_RING_SIZE];
+static uint32_t input_head = 0;     // Written by the reader thread
+static uint32_t input_tail = 0;     // Written by the JS thread
+static uint32_t input_dropped = 0;
+
+// Motion that did not fit in the ring (reader thread only), merged into the next push
+static double pending_dx = 0.0;
+static double pending_dy = 0.0;
+static uint64_t pending_time = 0;
+
+// Key and mouse button state (written by the reader thread, read with atomic loads)
+static uint32_t key_bits[8] = {0};
+static uint32_t mouse_button_bits = 0;
+
+static bool cursor_captured = false;
+
+// ============ Devices ============
+
+#define MAX_INPUT_DEVICES 32
+
+typedef struct {
+    int fd;
+    bool is_mouse;              // Has relative X/Y axes
+    bool active;                // Cleared by the reader thread when unplugged
+    int rel_x;                  // Motion since the last SYN_REPORT
+    int rel_y;
+    uint32_t held_keys[8];      // Keys this device holds (reader thread only)
+    uint32_t held_buttons;
+} InputDevice;
+
+static InputDevice devices[MAX_INPUT_DEVICES];
+static int device_count = 0;
+static int wake_pipe[2] = {-1, -1};     // Written by stop() to end poll()
+static pthread_t reader_thread;
+static bool running = false;
+
+// Debug counters
+static int event_count = 0;
+static int last_keycode = -1;
+static int last_event_type = -1;
+
+// ============ Key mapping ============
+
+// Linux KEY_* -> macOS virtual key code, stored +1 so 0 means unmapped
+#define MAP(linux_code, mac_code) [linux_code] = (mac_code) + 1
+
+static const int16_t linux_to_mac[KEY_MAX + 1] = {
+    MAP(KEY_A, 0), MAP(KEY_S, 1), MAP(KEY_D, 2), MAP(KEY_F, 3), MAP(KEY_H, 4),
+    MAP(KEY_G, 5), MAP(KEY_Z, 6), MAP(KEY_X, 7), MAP(KEY_C, 8), MAP(KEY_V, 9),
+    MAP(KEY_B, 11), MAP(KEY_Q, 12), MAP(KEY_W, 13), MAP(KEY_E, 14), MAP(KEY_R, 15),
+    MAP(KEY_Y, 16), MAP(KEY_T, 17), MAP(KEY_O, 31), MAP(KEY_U, 32), MAP(KEY_I, 34),
+    MAP(KEY_P, 35), MAP(KEY_L, 37), MAP(KEY_J, 38), MAP(KEY_K, 40), MAP(KEY_N, 45),
+    MAP(KEY_M, 46),
+
+    MAP(KEY_1, 18), MAP(KEY_2, 19), MAP(KEY_3, 20), MAP(KEY_4, 21), MAP(KEY_5, 23),
+    MAP(KEY_6, 22), MAP(KEY_7, 26), MAP(KEY_8, 28), MAP(KEY_9, 25), MAP(KEY_0, 29),
+
+    MAP(KEY_EQUAL, 24), MAP(KEY_MINUS, 27), MAP(KEY_RIGHTBRACE, 30), MAP(KEY_LEFTBRACE, 33),
+    MAP(KEY_APOSTROPHE, 39), MAP(KEY_SEMICOLON, 41), MAP(KEY_BACKSLASH, 42),
+    MAP(KEY_COMMA, 43), MAP(KEY_SLASH, 44), MAP(KEY_DOT, 47), MAP(KEY_GRAVE, 50),
+
+    MAP(KEY_ENTER, 36), MAP(KEY_TAB, 48), MAP(KEY_SPACE, 49), MAP(KEY_BACKSPACE, 51),
+    MAP(KEY_ESC, 53), MAP(KEY_CAPSLOCK, 57), MAP(KEY_DELETE, 117), MAP(KEY_INSERT, 114),
+    MAP(KEY_HOME, 115), MAP(KEY_END, 119), MAP(KEY_PAGEUP, 116), MAP(KEY_PAGEDOWN, 121),
+
+    MAP(KEY_LEFT, 123), MAP(KEY_RIGHT, 124), MAP(KEY_DOWN, 125), MAP(KEY_UP, 126),
+
+    MAP(KEY_LEFTMETA, 55), MAP(KEY_RIGHTMETA, 54), MAP(KEY_LEFTSHIFT, 56),
+    MAP(KEY_RIGHTSHIFT, 60), MAP(KEY_LEFTALT, 58), MAP(KEY_RIGHTALT, 61),
+    MAP(KEY_LEFTCTRL, 59), MAP(KEY_RIGHTCTRL, 62),
+
+    MAP(KEY_F1, 122), MAP(KEY_F2, 120), MAP(KEY_F3, 99), MAP(KEY_F4, 118),
+    MAP(KEY_F5, 96), MAP(KEY_F6, 97), MAP(KEY_F7, 98), MAP(KEY_F8, 100),
+    MAP(KEY_F9, 101), MAP(KEY_F10, 109), MAP(KEY_F11, 103), MAP(KEY_F12, 111),
+};
+
+#undef MAP
+
+// Mouse BTN_* -> button index (0 left, 1 right, 2 middle, 3+ side buttons)
+static int mouse_button_index(int code) {
+    if (code >= BTN_LEFT && code < BTN_LEFT + 8) {
+        switch (code) {
+            case BTN_LEFT: return 0;
+            case BTN_RIGHT: return 1;
+            case BTN_MIDDLE: return 2;
+            default: return code - BTN_LEFT;
+        }
+    }
+    return -1;
+}
+
+// ============ Ring buffer ============
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Push one event (reader thread only). Returns false if the ring is full.
+static bool push_event(uint64_t time, int32_t type, int32_t code, int32_t value) {
+    uint32_t head = input_head;
+    uint32_t tail = __atomic_load_n(&input_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= INPUT_RING_SIZE) {
+        return false;
+    }
+    InputEvent *e = &input_ring[head & (INPUT_RING_SIZE - 1)];
+    e->time = time;
+    e->type = type;
+    e->code = code;
+    e->value = value;
+    __atomic_store_n(&input_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void push_or_drop(uint64_t time, int32_t type, int32_t code, int32_t value) {
+    if (!push_event(time, type, code, value)) {
+        __atomic_fetch_add(&input_dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Queue mouse movement; if the ring is full it is kept and merged into the next event
+static void push_motion(uint64_t time, double dx, double dy) {
+    pending_dx += dx;
+    pending_dy += dy;
+    if (pending_time == 0) pending_time = time;
+
+    int32_t fx = (int32_t)lround(pending_dx * INPUT_MOTION_SCALE);
+    int32_t fy = (int32_t)lround(pending_dy * INPUT_MOTION_SCALE);
+    if (push_event(pending_time, INPUT_EVENT_MOTION, fx, fy)) {
+        pending_dx = 0.0;
+        pending_dy = 0.0;
+        pending_time = 0;
+    }
+}
+
+// Update one bit of a state word (single writer, so load/store is enough)
+static void set_state_bit(uint32_t *word, int bit, bool on) {
+    uint32_t bits = __atomic_load_n(word, __ATOMIC_RELAXED);
+    bits = on ? (bits | (1u << bit)) : (bits & ~(1u << bit));
+    __atomic_store_n(word, bits, __ATOMIC_RELEASE);
+}
+
+static bool get_state_bit(const uint32_t *word, int bit) {
+    return (__atomic_load_n(word, __ATOMIC_ACQUIRE) >> bit) & 1u;
+}
+
+// ============ Device handling ============
+
+#define BITS_PER_LONG (sizeof(unsigned long) * 8)
+#define NLONGS(n) (((n) + BITS_PER_LONG - 1) / BITS_PER_LONG)
+
+static bool test_bit(const unsigned long *bits, int bit) {
+    return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1ul;
+}
+
+// Open an event device if it is a keyboard or a relative mouse
+static bool open_device(const char *path, InputDevice *dev) {
+    int fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    unsigned long ev_bits[NLONGS(EV_MAX + 1)] = {0};
+    unsigned long key_caps[NLONGS(KEY_MAX + 1)] = {0};
+    unsigned long rel_caps[NLONGS(REL_MAX + 1)] = {0};
+    ioctl(fd, EVIOCGBIT(0, sizeof(ev_bits)), ev_bits);
+    if (test_bit(ev_bits, EV_KEY)) ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(key_caps)), key_caps);
+    if (test_bit(ev_bits, EV_REL)) ioctl(fd, EVIOCGBIT(EV_REL, sizeof(rel_caps)), rel_caps);
+
+    bool is_keyboard = test_bit(key_caps, KEY_A) && test_bit(key_caps, KEY_SPACE);
+    bool is_mouse = test_bit(rel_caps, REL_X) && test_bit(rel_caps, REL_Y) && test_bit(key_caps, BTN_LEFT);
+    if (!is_keyboard && !is_mouse) {
+        close(fd);
+        return false;
+    }
+
+    // Event timestamps on the same clock as drainInput()
+    int clock = CLOCK_MONOTONIC;
+    ioctl(fd, EVIOCSCLOCKID, &clock);
+
+    dev->fd = fd;
+    dev->is_mouse = is_mouse;
+    dev->active = true;
+    dev->rel_x = 0;
+    dev->rel_y = 0;
+    memset(dev->held_keys, 0, sizeof(dev->held_keys));
+    dev->held_buttons = 0;
+    return true;
+}
+
+static void close_devices(void) {
+    for (int i = 0; i < device_count; i++) {
+        if (devices[i].fd >= 0) close(devices[i].fd);
+        devices[i].fd = -1;
+    }
+    device_count = 0;
+}
+
+// Grab or release every mouse so the desktop pointer stops moving while captured
+static void grab_mice(bool grab) {
+    for (int i = 0; i < device_count; i++) {
+        if (devices[i].fd >= 0 && devices[i].is_mouse) {
+            ioctl(devices[i].fd, EVIOCGRAB, grab ? (void *)1 : (void *)0);
+        }
+    }
+}
+
+// The shared state is held while any active device holds it (several
+// keyboards may report the same key); only real transitions are events
+static void set_key_held(InputDevice *dev, int keycode, bool down, uint64_t time) {
+    int word = keycode >> 5;
+    uint32_t bit = 1u << (keycode & 31);
+    dev->held_keys[word] = down ? (dev->held_keys[word] | bit) : (dev->held_keys[word] & ~bit);
+
+    bool held = down;
+    for (int i = 0; i < device_count && !held; i++) {
+        held = (devices[i].held_keys[word] & bit) != 0;
+    }
+    if (get_state_bit(&key_bits[word], keycode & 31) != held) {
+        set_state_bit(&key_bits[word], keycode & 31, held);
+        push_or_drop(time, INPUT_EVENT_KEY, keycode, held ? 1 : 0);
+    }
+}
+
+static void set_button_held(InputDevice *dev, int button, bool down, uint64_t time) {
+    uint32_t bit = 1u << button;
+    dev->held_buttons = down ? (dev->held_buttons | bit) : (dev->held_buttons & ~bit);
+
+    bool held = down;
+    for (int i = 0; i < device_count && !held; i++) {
+        held = (devices[i].held_buttons & bit) != 0;
+    }
+    if (get_state_bit(&mouse_button_bits, button) != held) {
+        set_state_bit(&mouse_button_bits, button, held);
+        push_or_drop(time, INPUT_EVENT_BUTTON, button, held ? 1 : 0);
+    }
+}
+
+static void handle_event(InputDevice *dev, const struct input_event *ev) {
+    event_count++;
+    uint64_t time = (uint64_t)ev->input_event_sec * 1000000000ull + (uint64_t)ev->input_event_usec * 1000ull;
+
+    if (ev->type == EV_REL) {
+        if (ev->code == REL_X) dev->rel_x += ev->value;
+        else if (ev->code == REL_Y) dev->rel_y += ev->value;
+        return;
+    }
+
+    if (ev->type == EV_SYN && ev->code == SYN_REPORT) {
+        // One motion event per hardware report
+        if (dev->rel_x != 0 || dev->rel_y != 0) {
+            push_motion(time, dev->rel_x, dev->rel_y);
+            dev->rel_x = 0;
+            dev->rel_y = 0;
+        }
+        return;
+    }
+
+    if (ev->type != EV_KEY || ev->value == 2) {
+        return;  // Auto-repeat is not a state change
+    }
+
+    bool down = ev->value != 0;
+    last_keycode = ev->code;
+    last_event_type = ev->type;
+
+    int button = mouse_button_index(ev->code);
+    if (button >= 0) {
+        set_button_held(dev, button, down, time);
+        return;
+    }
+
+    if (ev->code > KEY_MAX || linux_to_mac[ev->code] == 0) {
+        return;
+    }
+    set_key_held(dev, linux_to_mac[ev->code] - 1, down, time);
+}
+
+// An unplugged device releases everything it held (else e.g. W stays down)
+static void release_device(InputDevice *dev) {
+    uint64_t time = monotonic_ns();
+    for (int word = 0; word < 8; word++) {
+        while (dev->held_keys[word]) {
+            int bit = __builtin_ctz(dev->held_keys[word]);
+            set_key_held(dev, word * 32 + bit, false, time);
+        }
+    }
+    while (dev->held_buttons) {
+        set_button_held(dev, __builtin_ctz(dev->held_buttons), false, time);
+    }
+}
+
+// Thread function: poll every device and translate events
+static void* reader_thread_func(void* arg) {
+    struct pollfd fds[MAX_INPUT_DEVICES + 1];
+    struct input_event events[64];
+
+    while (true) {
+        int n = 0;
+        fds[n].fd = wake_pipe[0];
+        fds[n].events = POLLIN;
+        n++;
+        for (int i = 0; i < device_count; i++) {
+            // Negative fds are ignored by poll()
+            fds[n].fd = __atomic_load_n(&devices[i].active, __ATOMIC_RELAXED) ? devices[i].fd : -1;
+            fds[n].events = POLLIN;
+            n++;
+        }
+
+        if (poll(fds, (nfds_t)n, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents) break;  // stop()
+
+        for (int i = 0; i < device_count; i++) {
+            short revents = fds[i + 1].revents;
+            if (!revents) continue;
+
+            if (revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                // Unplugged: stop polling it (fd is closed on stop)
+                __atomic_store_n(&devices[i].active, false, __ATOMIC_RELAXED);
+                release_device(&devices[i]);
+                continue;
+            }
+
+            ssize_t bytes;
+            while ((bytes = read(devices[i].fd, events, sizeof(events))) > 0) {
+                size_t count = (size_t)bytes / sizeof(struct input_event);
+                for (size_t e = 0; e < count; e++) {
+                    handle_event(&devices[i], &events[e]);
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+// ============ N-API functions ============
+
+// Start the input reader
+static napi_value start(napi_env env, napi_callback_info info) {
+    napi_value result;
+
+    if (running) {
+        napi_get_boolean(env, true, &result);
+        return result;
+    }
+
+    DIR *dir = opendir("/dev/input");
+    if (dir) {
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL && device_count < MAX_INPUT_DEVICES) {
+            if (strncmp(entry->d_name, "event", 5) != 0) continue;
+            char path[300];
+            snprintf(path, sizeof(path), "/dev/input/%s", entry->d_name);
+            if (open_device(path, &devices[device_count])) {
+                device_count++;
+            }
+        }
+        closedir(dir);
+    }
+
+    // No readable devices: no permission, or none exist (e.g. WSL without usbipd)
+    if (device_count == 0) {
+        napi_get_boolean(env, false, &result);
+        return result;
+    }
+
+    if (pipe(wake_pipe) != 0) {
+        close_devices();
+        napi_get_boolean(env, false, &result);
+        return result;
+    }
+
+    running = true;
+    if (pthread_create(&reader_thread, NULL, reader_thread_func, NULL) != 0) {
+        running = false;
+        close_devices();
+        close(wake_pipe[0]);
+        close(wake_pipe[1]);
+        wake_pipe[0] = wake_pipe[1] = -1;
+        napi_get_boolean(env, false, &result);
+        return result;
+    }
+
+    napi_get_boolean(env, true, &result);
+    return result;
+}
+
+// Stop the input reader
+static napi_value stop(napi_env env, napi_callback_info info) {
+    napi_value result;
+
+    if (!running) {
+        napi_get_boolean(env, true, &result);
+        return result;
+    }
+
+    running = false;
+
+    // Wake the reader thread and wait for it
+    char byte = 1;
+    ssize_t written = write(wake_pipe[1], &byte, 1);
+    (void)written;
+    pthread_join(reader_thread, NULL);
+
+    if (__atomic_load_n(&cursor_captured, __ATOMIC_ACQUIRE)) {
+        grab_mice(false);
+        __atomic_store_n(&cursor_captured, false, __ATOMIC_RELEASE);
+    }
+    close_devices();
+    close(wake_pipe[0]);
+    close(wake_pipe[1]);
+    wake_pipe[0] = wake_pipe[1] = -1;
+
+    // Clear all states (reader thread has exited, so nothing else writes them)
+    for (int i = 0; i < 8; i++) {
+        __atomic_store_n(&key_bits[i], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&mouse_button_bits, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&input_tail, __atomic_load_n(&input_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    __atomic_store_n(&input_dropped, 0, __ATOMIC_RELAXED);
+    pending_dx = 0.0;
+    pending_dy = 0.0;
+    pending_time = 0;
+
+    napi_get_boolean(env, true, &result);
+    return result;
+}
+
+// Check if a key is currently held down (macOS key code)
+static napi_value is_key_down(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    int32_t keycode;
+    napi_get_value_int32(env, args[0], &keycode);
+
+    napi_value result;
+    if (keycode >= 0 && keycode < 256) {
+        napi_get_boolean(env, get_state_bit(&key_bits[keycode >> 5], keycode & 31), &result);
+    } else {
+        napi_get_boolean(env, false, &result);
+    }
+
+    return result;
+}
+
+// Drain queued input events and current key/button state in one call
+// Args: out (Int32Array, DRAIN_HEADER_SIZE + n * DRAIN_EVENT_STRIDE values)
+// Events that do not fit stay queued for the next drain.
+// Returns: number of events written (also stored in out[0])
+static napi_value drain_input(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    napi_value result;
+    napi_typedarray_type type;
+    size_t length;
+    void *data;
+    napi_value buffer;
+    size_t offset;
+    if (argc < 1 ||
+        napi_get_typedarray_info(env, args[0], &type, &length, &data, &buffer, &offset) != napi_ok ||
+        type != napi_int32_array) {
+        napi_throw_type_error(env, NULL, "drainInput expects an Int32Array");
+        return NULL;
+    }
+    if (length < DRAIN_HEADER_SIZE) {
+        napi_throw_range_error(env, NULL, "drainInput buffer is smaller than the header");
+        return NULL;
+    }
+
+    int32_t *out = (int32_t *)data;
+    uint32_t capacity = (uint32_t)((length - DRAIN_HEADER_SIZE) / DRAIN_EVENT_STRIDE);
+
+    uint32_t tail = input_tail;
+    uint32_t head = __atomic_load_n(&input_head, __ATOMIC_ACQUIRE);
+    uint32_t count = head - tail;
+    if (count > capacity) count = capacity;
+
+    uint64_t now = monotonic_ns();
+    int32_t *ev = out + DRAIN_HEADER_SIZE;
+    for (uint32_t i = 0; i < count; i++) {
+        const InputEvent *e = &input_ring[(tail + i) & (INPUT_RING_SIZE - 1)];
+        uint64_t age_us = e->time < now ? (now - e->time) / 1000 : 0;
+        ev[0] = e->type;
+        ev[1] = e->code;
+        ev[2] = e->value;
+        ev[3] = age_us > INT32_MAX ? INT32_MAX : (int32_t)age_us;
+        ev += DRAIN_EVENT_STRIDE;
+    }
+    __atomic_store_n(&input_tail, tail + count, __ATOMIC_RELEASE);
+
+    out[DRAIN_COUNT] = (int32_t)count;
+    out[DRAIN_DROPPED] = (int32_t)__atomic_exchange_n(&input_dropped, 0, __ATOMIC_RELAXED);
+    for (int i = 0; i < 8; i++) {
+        out[DRAIN_KEYS + i] = (int32_t)__atomic_load_n(&key_bits[i], __ATOMIC_ACQUIRE);
+    }
+    out[DRAIN_BUTTONS] = (int32_t)__atomic_load_n(&mouse_button_bits, __ATOMIC_ACQUIRE);
+    out[DRAIN_FLAGS] = __atomic_load_n(&cursor_captured, __ATOMIC_ACQUIRE) ? 1 : 0;
+
+    napi_create_uint32(env, count, &result);
+    return result;
+}
+
+// Check if running
+static napi_value is_running(napi_env env, napi_callback_info info) {
+    napi_value result;
+    napi_get_boolean(env, running, &result);
+    return result;
+}
+
+// Get event count (for debugging)
+static napi_value get_event_count(napi_env env, napi_callback_info info) {
+    napi_value result;
+    napi_create_int32(env, event_count, &result);
+    return result;
+}
+
+// Get last keycode (for debugging, Linux KEY_* code)
+static napi_value get_last_keycode(napi_env env, napi_callback_info info) {
+    napi_value result;
+    napi_create_int32(env, last_keycode, &result);
+    return result;
+}
+
+// Get last event type (for debugging, Linux EV_* type)
+static napi_value get_last_event_type(napi_env env, napi_callback_info info) {
+    napi_value result;
+    napi_create_int32(env, last_event_type, &result);
+    return result;
+}
+
+// ============ Mouse functions ============
+
+// Check if mouse button is down
+static napi_value is_mouse_button_down(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    int32_t button;
+    napi_get_value_int32(env, args[0], &button);
+
+    napi_value result;
+    if (button >= 0 && button < 8) {
+        napi_get_boolean(env, get_state_bit(&mouse_button_bits, button), &result);
+    } else {
+        napi_get_boolean(env, false, &result);
+    }
+
+    return result;
+}
+
+// ============ Cursor capture functions ============
+
+// Capture/release the mouse - grabs the mouse devices so the desktop pointer
+// stays still while we keep receiving relative motion
+static napi_value set_cursor_captured(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value args[1];
+    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+
+    bool capture;
+    napi_get_value_bool(env, args[0], &capture);
+
+    napi_value result;
+    if (!running) {
+        napi_get_boolean(env, false, &result);
+        return result;
+    }
+
+    // Only the JS thread changes capture
+    if (capture != cursor_captured) {
+        grab_mice(capture);
+        __atomic_store_n(&cursor_captured, capture, __ATOMIC_RELEASE);
+    }
+
+    napi_get_boolean(env, true, &result);
+    return result;
+}
+
+// Check if cursor is captured
+static napi_value is_cursor_captured(napi_env env, napi_callback_info info) {
+    napi_value result;
+    napi_get_boolean(env, cursor_captured, &result);
+    return result;
+}
+
+// Module initialization
+static napi_value init(napi_env env, napi_value exports) {
+    napi_property_descriptor props[] = {
+        // Keyboard
+        {"start", NULL, start, NULL, NULL, NULL, napi_default, NULL},
+        {"stop", NULL, stop, NULL, NULL, NULL, napi_default, NULL},
+        {"isKeyDown", NULL, is_key_down, NULL, NULL, NULL, napi_default, NULL},
+        {"drainInput", NULL, drain_input, NULL, NULL, NULL, napi_default, NULL},
+        {"isRunning", NULL, is_running, NULL, NULL, NULL, napi_default, NULL},
+        // Mouse
+        {"isMouseButtonDown", NULL, is_mouse_button_down, NULL, NULL, NULL, napi_default, NULL},
+        // Cursor capture
+        {"setCursorCaptured", NULL, set_cursor_captured, NULL, NULL, NULL, napi_default, NULL},
+        {"isCursorCaptured", NULL, is_cursor_captured, NULL, NULL, NULL, napi_default, NULL},
+        // Debug
+        {"getEventCount", NULL, get_event_count, NULL, NULL, NULL, napi_default, NULL},
+        {"getLastKeycode", NULL, get_last_keycode, NULL, NULL, NULL, napi_default, NULL},
+        {"getLastEventType", NULL, get_last_event_type, NULL, NULL, NULL, napi_default, NULL},
+    };
+
+    napi_define_properties(env, exports, sizeof(props) / sizeof(props[0]), props);
+
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, init)
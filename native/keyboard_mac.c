@@ -1,31 +1,69 @@
 // Native macOS keyboard input using CGEventTap
 // Captures global keyboard events for responsive FPS-style input
+//
+// The tap thread never takes a lock. Every key, button and mouse move is
+// pushed as a timestamped event into a single-producer/single-consumer
+// ring, and key/button state is kept in atomic bitsets. JS drains the ring
+// and reads both bitsets with one drainInput() call per frame.
 
 #include <node_api.h>
 #include <CoreGraphics/CoreGraphics.h>
 #include <CoreFoundation/CoreFoundation.h>
 #include <ApplicationServices/ApplicationServices.h>
+#include <mach/mach_time.h>
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+// ============ Input event ring ============
+
+// Event types (match INPUT_EVENT_* in NativeKeyboard.ts)
+#define INPUT_EVENT_KEY     1   // code = keycode, value = 1 down / 0 up
+#define INPUT_EVENT_BUTTON  2   // code = button, value = 1 down / 0 up
+#define INPUT_EVENT_MOTION  3   // code = dx, value = dy (1/256 pixel units)
+
+#define INPUT_MOTION_SCALE 256.0
+
+// drainInput() output layout (Int32Array)
+#define DRAIN_COUNT        0    // Events written
+#define DRAIN_DROPPED      1    // Events lost to ring overflow since last drain
+#define DRAIN_KEYS         2    // 8 words: key state bitset (256 keys)
+#define DRAIN_BUTTONS      10   // Mouse button bitmask
+#define DRAIN_FLAGS        11   // Bit 0: cursor captured
+#define DRAIN_HEADER_SIZE  12
+#define DRAIN_EVENT_STRIDE 4    // type, code, value, age (us before the drain)
+
+#define INPUT_RING_SIZE 4096    // Power of two; ~0.5s of 8kHz mouse movement
+
+typedef struct {
+    uint64_t time;              // mach_absolute_time units
+    int32_t type;
+    int32_t code;
+    int32_t value;
+} InputEvent;
+
+static InputEvent input_ring[INPUT_RING_SIZE];
+static uint32_t input_head = 0;     // Written by the tap thread
+static uint32_t input_tail = 0;     // Written by the JS thread
+static uint32_t input_dropped = 0;
+
+// Motion that did not fit in the ring (tap thread only), merged into the next push
+static double pending_dx = 0.0;
+static double pending_dy = 0.0;
+static uint64_t pending_time = 0;
+
+static mach_timebase_info_data_t timebase = {0, 0};
+
+// Key and mouse button state (written by the tap thread, read with atomic loads)
+static uint32_t key_bits[8] = {0};
+static uint32_t mouse_button_bits = 0;
 
-// Key state tracking (256 possible key codes)
-static bool key_states[256] = {false};
-static bool key_just_pressed[256] = {false};
-static bool key_just_released[256] = {false};
-
-// Mouse state tracking
-static double mouse_delta_x = 0.0;
-static double mouse_delta_y = 0.0;
-static bool mouse_button_states[8] = {false};  // Up to 8 mouse buttons
-static bool mouse_button_just_pressed[8] = {false};
-static bool mouse_button_just_released[8] = {false};
 static bool cursor_captured = false;  // Whether cursor is captured
 static CGFloat lock_x = 0;  // Screen position to lock cursor to
 static CGFloat lock_y = 0;
 static int warp_skip_count = 0;  // Number of events to skip after warp (warp can generate 1-2 events)
 
-static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
-
 // Event tap and run loop
 static CFMachPortRef event_tap = NULL;
 static CFRunLoopSourceRef run_loop_source = NULL;
@@ -38,6 +76,64 @@ static int event_count = 0;
 static int last_keycode = -1;
 static int last_event_type = -1;
 
+// Push one event (tap thread only). Returns false if the ring is full.
+static bool push_event(uint64_t time, int32_t type, int32_t code, int32_t value) {
+    uint32_t head = input_head;
+    uint32_t tail = __atomic_load_n(&input_tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= INPUT_RING_SIZE) {
+        return false;
+    }
+    InputEvent *e = &input_ring[head & (INPUT_RING_SIZE - 1)];
+    e->time = time;
+    e->type = type;
+    e->code = code;
+    e->value = value;
+    __atomic_store_n(&input_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static void push_or_drop(uint64_t time, int32_t type, int32_t code, int32_t value) {
+    if (!push_event(time, type, code, value)) {
+        __atomic_fetch_add(&input_dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// Queue mouse movement; if the ring is full it is kept and merged into the next event
+static void push_motion(uint64_t time, double dx, double dy) {
+    pending_dx += dx;
+    pending_dy += dy;
+    if (pending_time == 0) pending_time = time;
+
+    int32_t fx = (int32_t)lround(pending_dx * INPUT_MOTION_SCALE);
+    int32_t fy = (int32_t)lround(pending_dy * INPUT_MOTION_SCALE);
+    if (push_event(pending_time, INPUT_EVENT_MOTION, fx, fy)) {
+        pending_dx = 0.0;
+        pending_dy = 0.0;
+        pending_time = 0;
+    }
+}
+
+// Update one bit of a state word (single writer, so load/store is enough)
+static void set_state_bit(uint32_t *word, int bit, bool on) {
+    uint32_t bits = __atomic_load_n(word, __ATOMIC_RELAXED);
+    bits = on ? (bits | (1u << bit)) : (bits & ~(1u << bit));
+    __atomic_store_n(word, bits, __ATOMIC_RELEASE);
+}
+
+static bool get_state_bit(const uint32_t *word, int bit) {
+    return (__atomic_load_n(word, __ATOMIC_ACQUIRE) >> bit) & 1u;
+}
+
+static void set_key(uint64_t time, int keycode, bool down) {
+    set_state_bit(&key_bits[keycode >> 5], keycode & 31, down);
+    push_or_drop(time, INPUT_EVENT_KEY, keycode, down ? 1 : 0);
+}
+
+static void set_mouse_button(uint64_t time, int button, bool down) {
+    set_state_bit(&mouse_button_bits, button, down);
+    push_or_drop(time, INPUT_EVENT_BUTTON, button, down ? 1 : 0);
+}
+
 // Callback for keyboard and mouse events
 static CGEventRef event_callback(
     CGEventTapProxy proxy,
@@ -53,16 +149,17 @@ static CGEventRef event_callback(
         return event;
     }
 
+    // Event time from the HID system (same clock as mach_absolute_time)
+    uint64_t time = CGEventGetTimestamp(event);
+    if (time == 0) time = mach_absolute_time();
+
     // Handle mouse movement
     if (type == kCGEventMouseMoved || type == kCGEventLeftMouseDragged ||
         type == kCGEventRightMouseDragged || type == kCGEventOtherMouseDragged) {
 
-        pthread_mutex_lock(&state_mutex);
-
         // If this is movement from our warp, skip it
-        if (warp_skip_count > 0) {
-            warp_skip_count--;
-            pthread_mutex_unlock(&state_mutex);
+        if (__atomic_load_n(&warp_skip_count, __ATOMIC_RELAXED) > 0) {
+            __atomic_fetch_sub(&warp_skip_count, 1, __ATOMIC_RELAXED);
             return event;
         }
 
@@ -70,67 +167,33 @@ static CGEventRef event_callback(
         double dx = CGEventGetDoubleValueField(event, kCGMouseEventDeltaX);
         double dy = CGEventGetDoubleValueField(event, kCGMouseEventDeltaY);
 
-        mouse_delta_x += dx;
-        mouse_delta_y += dy;
+        if (dx != 0 || dy != 0) {
+            push_motion(time, dx, dy);
+        }
 
         // If captured, warp cursor back to lock position
-        if (cursor_captured && (dx != 0 || dy != 0)) {
-            warp_skip_count = 2;  // Skip next 1-2 events from warp
-            pthread_mutex_unlock(&state_mutex);
-            // Warp cursor back to lock position (outside mutex to avoid deadlock)
+        if (__atomic_load_n(&cursor_captured, __ATOMIC_ACQUIRE) && (dx != 0 || dy != 0)) {
+            __atomic_store_n(&warp_skip_count, 2, __ATOMIC_RELAXED);  // Skip next 1-2 events from warp
             CGWarpMouseCursorPosition(CGPointMake(lock_x, lock_y));
-            return event;
         }
-
-        pthread_mutex_unlock(&state_mutex);
         return event;
     }
 
     // Handle mouse buttons
     if (type == kCGEventLeftMouseDown || type == kCGEventLeftMouseUp) {
-        pthread_mutex_lock(&state_mutex);
-        if (type == kCGEventLeftMouseDown) {
-            if (!mouse_button_states[0]) {
-                mouse_button_just_pressed[0] = true;
-            }
-            mouse_button_states[0] = true;
-        } else {
-            mouse_button_states[0] = false;
-            mouse_button_just_released[0] = true;
-        }
-        pthread_mutex_unlock(&state_mutex);
+        set_mouse_button(time, 0, type == kCGEventLeftMouseDown);
         return event;
     }
 
     if (type == kCGEventRightMouseDown || type == kCGEventRightMouseUp) {
-        pthread_mutex_lock(&state_mutex);
-        if (type == kCGEventRightMouseDown) {
-            if (!mouse_button_states[1]) {
-                mouse_button_just_pressed[1] = true;
-            }
-            mouse_button_states[1] = true;
-        } else {
-            mouse_button_states[1] = false;
-            mouse_button_just_released[1] = true;
-        }
-        pthread_mutex_unlock(&state_mutex);
+        set_mouse_button(time, 1, type == kCGEventRightMouseDown);
         return event;
     }
 
     if (type == kCGEventOtherMouseDown || type == kCGEventOtherMouseUp) {
         int64_t button = CGEventGetIntegerValueField(event, kCGMouseEventButtonNumber);
         if (button >= 0 && button < 8) {
-            pthread_mutex_lock(&state_mutex);
-            if (type == kCGEventOtherMouseDown) {
-                if (!mouse_button_states[button]) {
-                    mouse_button_just_pressed[button] = true;
-                }
-                mouse_button_states[button] = true;
-            } else {
-                mouse_button_states[button] = false;
-                mouse_button_just_released[button] = true;
-            }
-            pthread_mutex_unlock(&state_mutex);
+            set_mouse_button(time, (int)button, type == kCGEventOtherMouseDown);
         }
         return event;
     }
@@ -145,16 +208,13 @@ static CGEventRef event_callback(
     last_event_type = (int)type;
 
     if (keycode < 256) {
-        pthread_mutex_lock(&state_mutex);
+        bool was_down = get_state_bit(&key_bits[keycode >> 5], keycode & 31);
 
         if (type == kCGEventKeyDown) {
-            if (!key_states[keycode]) {
-                key_just_pressed[keycode] = true;
-            }
-            key_states[keycode] = true;
+            // Auto-repeat arrives as more key downs; only the first is an event
+            if (!was_down) set_key(time, keycode, true);
         } else if (type == kCGEventKeyUp) {
-            key_states[keycode] = false;
-            key_just_released[keycode] = true;
+            set_key(time, keycode, false);
         } else if (type == kCGEventFlagsChanged) {
             // Handle modifier keys (shift, ctrl, etc.)
             CGEventFlags flags = CGEventGetFlags(event);
@@ -178,18 +238,13 @@ static CGEventRef event_callback(
                     is_pressed = (flags & kCGEventFlagMaskCommand) != 0;
                     break;
                 default:
-                    is_pressed = key_states[keycode];
+                    is_pressed = was_down;
             }
 
-            if (is_pressed && !key_states[keycode]) {
-                key_just_pressed[keycode] = true;
-            } else if (!is_pressed && key_states[keycode]) {
-                key_just_released[keycode] = true;
+            if (is_pressed != was_down) {
+                set_key(time, keycode, is_pressed);
             }
-            key_states[keycode] = is_pressed;
         }
-
-        pthread_mutex_unlock(&state_mutex);
     }
 
     // Return event unchanged (we're just observing, not blocking)
@@ -292,6 +347,10 @@ static napi_value start(napi_env env, napi_callback_info info) {
         return result;
     }
 
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+
     running = true;
     pthread_create(&tap_thread, NULL, tap_thread_func, NULL);
 
@@ -313,8 +372,8 @@ static napi_value stop(napi_env env, napi_callback_info info) {
     // Release cursor if captured
     if (cursor_captured) {
         CGDisplayShowCursor(kCGDirectMainDisplay);
-        cursor_captured = false;
-        warp_skip_count = 0;
+        __atomic_store_n(&cursor_captured, false, __ATOMIC_RELEASE);
+        __atomic_store_n(&warp_skip_count, 0, __ATOMIC_RELAXED);
     }
 
     if (tap_run_loop) {
@@ -335,21 +394,16 @@ static napi_value stop(napi_env env, napi_callback_info info) {
 
     tap_run_loop = NULL;
 
-    // Clear all states
-    pthread_mutex_lock(&state_mutex);
-    for (int i = 0; i < 256; i++) {
-        key_states[i] = false;
-        key_just_pressed[i] = false;
-        key_just_released[i] = false;
-    }
-    mouse_delta_x = 0.0;
-    mouse_delta_y = 0.0;
+    // Clear all states (tap thread has exited, so nothing else writes them)
     for (int i = 0; i < 8; i++) {
-        mouse_button_states[i] = false;
-        mouse_button_just_pressed[i] = false;
-        mouse_button_just_released[i] = false;
+        __atomic_store_n(&key_bits[i], 0, __ATOMIC_RELAXED);
     }
-    pthread_mutex_unlock(&state_mutex);
+    __atomic_store_n(&mouse_button_bits, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&input_tail, __atomic_load_n(&input_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    __atomic_store_n(&input_dropped, 0, __ATOMIC_RELAXED);
+    pending_dx = 0.0;
+    pending_dy = 0.0;
+    pending_time = 0;
 
     napi_get_boolean(env, true, &result);
     return result;
@@ -366,9 +420,7 @@ static napi_value is_key_down(napi_env env, napi_callback_info info) {
 
     napi_value result;
     if (keycode >= 0 && keycode < 256) {
-        pthread_mutex_lock(&state_mutex);
-        napi_get_boolean(env, key_states[keycode], &result);
-        pthread_mutex_unlock(&state_mutex);
+        napi_get_boolean(env, get_state_bit(&key_bits[keycode >> 5], keycode & 31), &result);
     } else {
         napi_get_boolean(env, false, &result);
     }
@@ -376,66 +428,66 @@ static napi_value is_key_down(napi_env env, napi_callback_info info) {
     return result;
 }
 
-// Check if a key was just pressed this frame
-static napi_value was_key_just_pressed(napi_env env, napi_callback_info info) {
+// Drain queued input events and current key/button state in one call
+// Args: out (Int32Array, DRAIN_HEADER_SIZE + n * DRAIN_EVENT_STRIDE values)
+// Events that do not fit stay queued for the next drain.
+// Returns: number of events written (also stored in out[0])
+static napi_value drain_input(napi_env env, napi_callback_info info) {
     size_t argc = 1;
     napi_value args[1];
     napi_get_cb_info(env, info, &argc, args, NULL, NULL);
 
-    int32_t keycode;
-    napi_get_value_int32(env, args[0], &keycode);
-
     napi_value result;
-    if (keycode >= 0 && keycode < 256) {
-        pthread_mutex_lock(&state_mutex);
-        napi_get_boolean(env, key_just_pressed[keycode], &result);
-        pthread_mutex_unlock(&state_mutex);
-    } else {
-        napi_get_boolean(env, false, &result);
+    napi_typedarray_type type;
+    size_t length;
+    void *data;
+    napi_value buffer;
+    size_t offset;
+    if (argc < 1 ||
+        napi_get_typedarray_info(env, args[0], &type, &length, &data, &buffer, &offset) != napi_ok ||
+        type != napi_int32_array) {
+        napi_throw_type_error(env, NULL, "drainInput expects an Int32Array");
+        return NULL;
     }
-
-    return result;
-}
-
-// Check if a key was just released this frame
-static napi_value was_key_just_released(napi_env env, napi_callback_info info) {
-    size_t argc = 1;
-    napi_value args[1];
-    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-
-    int32_t keycode;
-    napi_get_value_int32(env, args[0], &keycode);
-
-    napi_value result;
-    if (keycode >= 0 && keycode < 256) {
-        pthread_mutex_lock(&state_mutex);
-        napi_get_boolean(env, key_just_released[keycode], &result);
-        pthread_mutex_unlock(&state_mutex);
-    } else {
-        napi_get_boolean(env, false, &result);
+    if (length < DRAIN_HEADER_SIZE) {
+        napi_throw_range_error(env, NULL, "drainInput buffer is smaller than the header");
+        return NULL;
     }
 
-    return result;
-}
-
-// Clear the "just pressed/released" flags (call once per frame)
-static napi_value update(napi_env env, napi_callback_info info) {
-    pthread_mutex_lock(&state_mutex);
-    for (int i = 0; i < 256; i++) {
-        key_just_pressed[i] = false;
-        key_just_released[i] = false;
+    int32_t *out = (int32_t *)data;
+    uint32_t capacity = (uint32_t)((length - DRAIN_HEADER_SIZE) / DRAIN_EVENT_STRIDE);
+
+    uint32_t tail = input_tail;
+    uint32_t head = __atomic_load_n(&input_head, __ATOMIC_ACQUIRE);
+    uint32_t count = head - tail;
+    if (count > capacity) count = capacity;
+
+    // Ages are relative to now so JS never needs the mach clock
+    uint64_t now = mach_absolute_time();
+    uint32_t numer = timebase.numer ? timebase.numer : 1;
+    uint32_t denom = timebase.denom ? timebase.denom : 1;
+
+    int32_t *ev = out + DRAIN_HEADER_SIZE;
+    for (uint32_t i = 0; i < count; i++) {
+        const InputEvent *e = &input_ring[(tail + i) & (INPUT_RING_SIZE - 1)];
+        uint64_t age_us = e->time < now ? (now - e->time) * numer / denom / 1000 : 0;
+        ev[0] = e->type;
+        ev[1] = e->code;
+        ev[2] = e->value;
+        ev[3] = age_us > INT32_MAX ? INT32_MAX : (int32_t)age_us;
+        ev += DRAIN_EVENT_STRIDE;
     }
-    // Clear mouse delta (accumulated since last update)
-    mouse_delta_x = 0.0;
-    mouse_delta_y = 0.0;
+    __atomic_store_n(&input_tail, tail + count, __ATOMIC_RELEASE);
+
+    out[DRAIN_COUNT] = (int32_t)count;
+    out[DRAIN_DROPPED] = (int32_t)__atomic_exchange_n(&input_dropped, 0, __ATOMIC_RELAXED);
     for (int i = 0; i < 8; i++) {
-        mouse_button_just_pressed[i] = false;
-        mouse_button_just_released[i] = false;
+        out[DRAIN_KEYS + i] = (int32_t)__atomic_load_n(&key_bits[i], __ATOMIC_ACQUIRE);
     }
-    pthread_mutex_unlock(&state_mutex);
+    out[DRAIN_BUTTONS] = (int32_t)__atomic_load_n(&mouse_button_bits, __ATOMIC_ACQUIRE);
+    out[DRAIN_FLAGS] = __atomic_load_n(&cursor_captured, __ATOMIC_ACQUIRE) ? 1 : 0;
 
-    napi_value result;
-    napi_get_undefined(env, &result);
+    napi_create_uint32(env, count, &result);
     return result;
 }
 
@@ -469,26 +521,6 @@ static napi_value get_last_event_type(napi_env env, napi_callback_info info) {
 
 // ============ Mouse functions ============
 
-// Get mouse delta and reset it (returns {x, y} object)
-static napi_value get_mouse_delta(napi_env env, napi_callback_info info) {
-    napi_value result;
-    napi_create_object(env, &result);
-
-    pthread_mutex_lock(&state_mutex);
-    double dx = mouse_delta_x;
-    double dy = mouse_delta_y;
-    pthread_mutex_unlock(&state_mutex);
-
-    napi_value x_val, y_val;
-    napi_create_double(env, dx, &x_val);
-    napi_create_double(env, dy, &y_val);
-
-    napi_set_named_property(env, result, "x", x_val);
-    napi_set_named_property(env, result, "y", y_val);
-
-    return result;
-}
-
 // Check if mouse button is down
 static napi_value is_mouse_button_down(napi_env env, napi_callback_info info) {
     size_t argc = 1;
@@ -500,51 +532,7 @@ static napi_value is_mouse_button_down(napi_env env, napi_callback_info info) {
 
     napi_value result;
     if (button >= 0 && button < 8) {
-        pthread_mutex_lock(&state_mutex);
-        napi_get_boolean(env, mouse_button_states[button], &result);
-        pthread_mutex_unlock(&state_mutex);
-    } else {
-        napi_get_boolean(env, false, &result);
-    }
-
-    return result;
-}
-
-// Check if mouse button was just pressed
-static napi_value was_mouse_button_just_pressed(napi_env env, napi_callback_info info) {
-    size_t argc = 1;
-    napi_value args[1];
-    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-
-    int32_t button;
-    napi_get_value_int32(env, args[0], &button);
-
-    napi_value result;
-    if (button >= 0 && button < 8) {
-        pthread_mutex_lock(&state_mutex);
-        napi_get_boolean(env, mouse_button_just_pressed[button], &result);
-        pthread_mutex_unlock(&state_mutex);
-    } else {
-        napi_get_boolean(env, false, &result);
-    }
-
-    return result;
-}
-
-// Check if mouse button was just released
-static napi_value was_mouse_button_just_released(napi_env env, napi_callback_info info) {
-    size_t argc = 1;
-    napi_value args[1];
-    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-
-    int32_t button;
-    napi_get_value_int32(env, args[0], &button);
-
-    napi_value result;
-    if (button >= 0 && button < 8) {
-        pthread_mutex_lock(&state_mutex);
-        napi_get_boolean(env, mouse_button_just_released[button], &result);
-        pthread_mutex_unlock(&state_mutex);
+        napi_get_boolean(env, get_state_bit(&mouse_button_bits, button), &result);
     } else {
         napi_get_boolean(env, false, &result);
     }
@@ -564,8 +552,7 @@ static napi_value set_cursor_captured(napi_env env, napi_callback_info info) {
     bool capture;
     napi_get_value_bool(env, args[0], &capture);
 
-    pthread_mutex_lock(&state_mutex);
-
+    // Only the JS thread changes capture; the tap thread reads it atomically
     if (capture && !cursor_captured) {
         // Get current cursor position as lock point
         CGEventRef event = CGEventCreate(NULL);
@@ -574,20 +561,18 @@ static napi_value set_cursor_captured(napi_env env, napi_callback_info info) {
 
         lock_x = cursor.x;
         lock_y = cursor.y;
-        warp_skip_count = 0;
-        cursor_captured = true;
+        __atomic_store_n(&warp_skip_count, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&cursor_captured, true, __ATOMIC_RELEASE);
 
         // Hide cursor while captured
         CGDisplayHideCursor(kCGDirectMainDisplay);
     } else if (!capture && cursor_captured) {
         // Release: show cursor
         CGDisplayShowCursor(kCGDirectMainDisplay);
-        cursor_captured = false;
-        warp_skip_count = 0;
+        __atomic_store_n(&cursor_captured, false, __ATOMIC_RELEASE);
+        __atomic_store_n(&warp_skip_count, 0, __ATOMIC_RELAXED);
     }
 
-    pthread_mutex_unlock(&state_mutex);
-
     napi_value result;
     napi_get_boolean(env, true, &result);
     return result;
@@ -607,15 +592,10 @@ static napi_value init(napi_env env, napi_value exports) {
         {"start", NULL, start, NULL, NULL, NULL, napi_default, NULL},
         {"stop", NULL, stop, NULL, NULL, NULL, napi_default, NULL},
         {"isKeyDown", NULL, is_key_down, NULL, NULL, NULL, napi_default, NULL},
-        {"wasKeyJustPressed", NULL, was_key_just_pressed, NULL, NULL, NULL, napi_default, NULL},
-        {"wasKeyJustReleased", NULL, was_key_just_released, NULL, NULL, NULL, napi_default, NULL},
-        {"update", NULL, update, NULL, NULL, NULL, napi_default, NULL},
+        {"drainInput", NULL, drain_input, NULL, NULL, NULL, napi_default, NULL},
         {"isRunning", NULL, is_running, NULL, NULL, NULL, napi_default, NULL},
         // Mouse
-        {"getMouseDelta", NULL, get_mouse_delta, NULL, NULL, NULL, napi_default, NULL},
         {"isMouseButtonDown", NULL, is_mouse_button_down, NULL, NULL, NULL, napi_default, NULL},
-        {"wasMouseButtonJustPressed", NULL, was_mouse_button_just_pressed, NULL, NULL, NULL, napi_default, NULL},
-        {"wasMouseButtonJustReleased", NULL, was_mouse_button_just_released, NULL, NULL, NULL, napi_default, NULL},
         // Cursor capture
         {"setCursorCaptured", NULL, set_cursor_captured, NULL, NULL, NULL, napi_default, NULL},
         {"isCursorCaptured", NULL, is_cursor_captured, NULL, NULL, NULL, napi_default, NULL},
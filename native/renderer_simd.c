@@ -3,65 +3,91 @@
  *
  * High-performance software rasterizer with:
  * - ARM NEON / SSE2 SIMD acceleration
- * - Per-face lighting (ambient + directional)
- * - Texture mapping with perspective-correct interpolation
+ * - Per-face lighting (ambient + directional, precomputed for resident meshes)
+ *   or baked lightmaps sampled per pixel
+ * - Texture mapping with perspective-correct interpolation and tiled mip chains
+ *   (nearest, bilinear, trilinear, pixelated and block-average filters)
  * - Backface culling toggle
- * - Proper MSAA with sub-pixel sample positions
+ * - Single-pass MSAA: per-pixel coverage masks, shaded once per pixel
  * - Zero-copy N-API TypedArray integration
- * - Multi-threaded parallel rendering with pthreads
+ * - Resident meshes and textures (uploaded once, used by handle)
+ * - BSP leaf/PVS visibility: per-frame list of draw batches worth submitting
+ * - Multi-threaded parallel rendering on the shared job system (job_system.h)
+ * - Frame profiler: per-stage and per-thread timers, Chrome trace export
+ * - Vertex stage: each referenced vertex transformed once per draw (SoA,
+ *   vectorized) with outcodes for trivial accept/reject before clipping
+ * - Tiled rasterization: parallel triangle setup, 32x32 screen bins,
+ *   one worker per tile at flush time
  */
 
 #include <node_api.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+#include "job_system.h"
 
 // SIMD headers
+// x86 kernels are compiled with per-function target attributes and chosen at
+// runtime, so the addon does not depend on the build host's -march.
 #if defined(__ARM_NEON) || defined(__ARM_NEON__)
   #include <arm_neon.h>
   #define USE_NEON 1
-#elif defined(__SSE2__)
-  #include <emmintrin.h>
-  #define USE_SSE2 1
+#elif defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+  #define USE_X86_DISPATCH 1
 #endif
 
+// Helpers called from the vector kernels must be inlined into them so they are
+// compiled with the kernel's ISA (avoids SSE/AVX transition stalls on calls)
+#define FORCE_INLINE static inline __attribute__((always_inline))
+
 // Threading configuration
-#define MAX_THREADS 8
 #define MIN_ROWS_PER_THREAD 16
 
-// Thread pool state
+// Work types dispatched to the job system (also the job tags the profiler sees)
+#define WORK_NONE 0
+#define WORK_CLEAR 1
+#define WORK_MSAA_RESOLVE 2
+#define WORK_RASTER_TILES 3
+#define WORK_SETUP_TRIANGLES 4
+#define WORK_TRANSFORM_VERTICES 5
+
+// Parameters of one dispatched job
 typedef struct {
-  pthread_t threads[MAX_THREADS];
-  pthread_mutex_t mutex;
-  pthread_cond_t work_ready;
-  pthread_cond_t work_done;
-  int num_threads;
-  int active_workers;
-  bool shutdown;
-
-  // Work parameters (set by main thread before signaling)
-  int work_type;  // 0=none, 1=clear, 2=msaa_resolve
-  int row_start;
-  int row_end;
-  int next_row;  // Atomic row counter for work stealing
+  int work_type;  // WORK_* constant
   uint8_t clear_r, clear_g, clear_b;
-} ThreadPool;
+} WorkJob;
 
-static ThreadPool* g_thread_pool = NULL;
-
-// Renderer state
+/*
+ * Renderer state. init() sets the output size; setRenderScale() can shrink
+ * the scene below it, and g_width/g_height are then the scene size from
+ * clear until present_scene() upscales the frame to the output size for
+ * overlays and encoding.
+ */
 static int g_width = 0;
 static int g_height = 0;
 static int g_msaa_samples = 1;
+static int g_out_width = 0;
+static int g_out_height = 0;
+static int g_max_msaa_samples = 1;     // Samples requested at init (upper bound for setRenderScale)
+static uint32_t g_scene_request = 0;   // Packed scene size/samples applied at the next clear (0 = output size)
+static bool g_scene_pending = false;   // Scene drawn below the output size, not upscaled yet
+
+// Buffers only grow; a smaller reinit or scene reuses them
+static size_t g_pixel_capacity = 0;    // Pixels in the framebuffer and depth buffer
+static size_t g_msaa_capacity = 0;     // Samples in the MSAA buffers
 
 // Framebuffers
 static uint8_t* g_framebuffer = NULL;       // RGB output
 static float* g_depth_buffer = NULL;        // Depth values
-static uint8_t* g_msaa_buffer = NULL;       // MSAA color samples
-static float* g_msaa_depth = NULL;          // MSAA depth samples
+static uint8_t* g_msaa_buffer = NULL;       // MSAA color samples (interleaved per pixel)
+static float* g_msaa_depth = NULL;          // MSAA depth samples (interleaved per pixel)
 
 // Lighting parameters (matching JS renderer defaults)
 static float g_ambient_light = 0.3f;
@@ -71,10 +97,48 @@ static float g_light_dir[3] = {0.4319f, 0.8639f, 0.2592f};  // normalized (0.5,
 static bool g_enable_backface_culling = false;
 static bool g_enable_textures = true;
 
+/**
+ * Texture image with a full mip chain.
+ * Levels are power-of-two (other sizes are resampled at upload) so UV wrap
+ * is a mask. Each level is stored as 4x4 tiles of 0x00BBGGRR texels, Morton
+ * order inside a tile and tiles row-major, so a bilinear footprint usually
+ * stays within one 64-byte tile. Levels narrower than 4 texels are padded.
+ */
+#define TEX_MAX_LEVELS 13  // 4096 -> 1
+
+typedef struct {
+  uint32_t* texels;                     // All levels in one block, NULL if empty
+  size_t level_offset[TEX_MAX_LEVELS];  // Texel offset of each level
+  int log2_w, log2_h;                   // Level-0 size
+  int levels;
+  size_t bytes;
+} TexImage;
+
+// Texture filter modes (setTextureFilter)
+typedef enum {
+  TEX_FILTER_NEAREST = 0,
+  TEX_FILTER_BILINEAR,
+  TEX_FILTER_TRILINEAR,
+  TEX_FILTER_PIXELATED,  // Nearest texel at the center of each block
+  TEX_FILTER_BLOCKAVG    // Nearest texel of the mip whose texels are one block
+} TexFilter;
+
+static TexFilter g_texture_filter = TEX_FILTER_NEAREST;
+static int g_texture_block_log2 = 2;  // Block size for pixelated/blockavg (4)
+
 // Current texture (set per-mesh before rendering)
-static uint8_t* g_current_texture = NULL;
-static int g_texture_width = 0;
+static const TexImage* g_current_texture = NULL;
+static int g_texture_width = 0;   // Size as uploaded (before POT resampling)
 static int g_texture_height = 0;
+static int32_t g_bound_texture_id = 0;  // Resident texture id (0 = none / legacy setTexture buffer)
+
+// Current lightmap atlas (resident texture), applied to meshes with lightmap UVs
+static const TexImage* g_current_lightmap = NULL;
+static int32_t g_bound_lightmap_id = 0;
+static const TexImage* g_draw_lightmap = NULL;  // Lightmap of the draw being set up (NULL = face lighting)
+
+// Lightmap texels are stored so 128 = 1x light (2x overbright, like Quake)
+#define LIGHTMAP_SCALE (2.0f / 255.0f)
 
 // MSAA 4x sample positions (rotated grid pattern)
 static const float msaa4_offsets[4][2] = {
@@ -116,160 +180,387 @@ static inline float fast_rsqrt(float x) {
   return x;
 }
 
+// Piecewise-linear log2 from the float's exponent and mantissa (error < 0.09)
+static inline float fast_log2(float x) {
+  union { float f; uint32_t i; } v = { x };
+  float e = (float)((int)((v.i >> 23) & 255) - 128);
+  v.i = (v.i & 0x007FFFFFu) | 0x3F800000u;
+  return e + v.f;
+}
+
 // ========================================
-// Thread Pool Implementation
+// Frame Profiler
 // ========================================
 
-// Forward declarations for thread work
-static void do_clear_rows(int start_row, int end_row, uint8_t r, uint8_t g, uint8_t b);
-static void do_msaa_resolve_rows(int start_row, int end_row);
-
-// Worker thread function
-static void* thread_worker(void* arg) {
-  ThreadPool* pool = (ThreadPool*)arg;
+/*
+ * Scoped timers around each renderer stage, off until setProfiling(true).
+ * Every thread appends finished scopes to one lock-free ring of the last
+ * PROF_EVENTS events: a slot is claimed with an atomic increment and
+ * published by storing its sequence number last, so getProfileTrace() skips
+ * slots still being written. Stage times are also summed per frame (a frame
+ * ends at the next setOptions) into a ring of the last PROF_FRAMES frames
+ * for getProfileStats() percentiles.
+ */
+#define PROF_EVENTS 65536  // Power of two
+#define PROF_FRAMES 256
+
+typedef enum {
+  PROF_SUBMIT,          // submit(): decode and, outside a recorded frame, execute
+  PROF_CLEAR,
+  PROF_SETUP,           // Triangle transform, clip and binning
+  PROF_RASTER,          // Tile rasterization (flush)
+  PROF_MSAA_RESOLVE,
+  PROF_FRAME_EXECUTE,   // Replay of a recorded frame (render thread)
+  PROF_FRAME_ENCODE,    // Terminal encoding of a recorded frame (render thread)
+  PROF_FRAME_WAIT,      // JS thread blocked on the frame in flight
+  PROF_WORKER_BUSY,     // Job system worker running a job
+  PROF_WORKER_IDLE,     // Job system worker waiting for a job
+  PROF_JS_FRAME,        // Reported from JS with recordProfileEvent()
+  PROF_JS_COPY,
+  PROF_JS_OUTPUT,
+  PROF_VOICE,           // Worker time on voice decode jobs (codec2 addon)
+  PROF_COLLISION,       // Worker time on BVH build and raycast jobs (bvh addon)
+  PROF_UPSCALE,         // Scene upscale to the output size (dynamic resolution)
+  PROF_VERTEX,          // Vertex stage: transform and outcodes (part of setup)
+  PROF_STAGE_COUNT
+} ProfStage;
+
+static const char* const g_prof_stage_names[PROF_STAGE_COUNT] = {
+  "submit", "clear", "setup", "raster", "msaaResolve", "frameExecute", "frameEncode",
+  "frameWait", "workerBusy", "workerIdle", "jsFrame", "jsCopy", "jsOutput", "voice", "collision",
+  "upscale", "vertex"
+};
 
-  while (1) {
-    pthread_mutex_lock(&pool->mutex);
+// Trace thread ids: JS thread, render thread, then one per job system worker
+#define PROF_TID_JS 0
+#define PROF_TID_RENDER 1
+#define PROF_TID_WORKER0 2
 
-    // Wait for work
-    while (pool->work_type == 0 && !pool->shutdown) {
-      pthread_cond_wait(&pool->work_ready, &pool->mutex);
-    }
+typedef struct {
+  uint64_t seq;       // Claim index + 1 once written, 0 while being written
+  uint64_t start_ns;  // Since g_prof_epoch_ns
+  uint64_t dur_ns;
+  uint32_t frame;
+  uint16_t stage;     // ProfStage
+  uint8_t tid;
+  uint8_t job;        // Stage a worker ran (PROF_WORKER_BUSY only)
+} ProfEvent;
 
-    if (pool->shutdown) {
-      pthread_mutex_unlock(&pool->mutex);
-      break;
-    }
+typedef struct {
+  uint32_t frame;
+  uint64_t stage_ns[PROF_STAGE_COUNT];
+} ProfFrame;
+
+static ProfEvent g_prof_events[PROF_EVENTS];
+static ProfFrame g_prof_frames[PROF_FRAMES];
+static bool g_prof_enabled = false;
+static uint64_t g_prof_epoch_ns = 0;
+static uint64_t g_prof_head = 0;                    // Events claimed since enabled
+static uint32_t g_prof_frame = 0;                   // Frame new events belong to
+static uint32_t g_prof_frames_done = 0;             // Frames summed into g_prof_frames
+static uint64_t g_prof_stage_ns[PROF_STAGE_COUNT];  // Current frame's totals
+static __thread uint8_t t_prof_tid = PROF_TID_JS;
+
+static uint64_t prof_clock_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
 
-    int work_type = pool->work_type;
-    uint8_t cr = pool->clear_r, cg = pool->clear_g, cb = pool->clear_b;
+// Start a scope; 0 while profiling is off, which makes prof_end() a no-op
+static inline uint64_t prof_begin(void) {
+  if (!__atomic_load_n(&g_prof_enabled, __ATOMIC_RELAXED)) return 0;
+  return prof_clock_ns();
+}
 
-    // Work stealing: grab next available row chunk
-    int chunk_size = 8;  // Process 8 rows at a time
-    int my_start = pool->next_row;
-    pool->next_row += chunk_size;
-    int my_end = MIN(my_start + chunk_size, pool->row_end);
+static void prof_record_tid(int tid, int stage, int job, uint64_t start, uint64_t end) {
+  // Scopes opened before profiling was (re)enabled
+  if (start < g_prof_epoch_ns || end < start) return;
+
+  uint64_t index = __atomic_fetch_add(&g_prof_head, 1, __ATOMIC_RELAXED);
+  ProfEvent* e = &g_prof_events[index & (PROF_EVENTS - 1)];
+  __atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  e->start_ns = start - g_prof_epoch_ns;
+  e->dur_ns = end - start;
+  e->frame = __atomic_load_n(&g_prof_frame, __ATOMIC_RELAXED);
+  e->stage = (uint16_t)stage;
+  e->tid = (uint8_t)tid;
+  e->job = (uint8_t)job;
+  __atomic_store_n(&e->seq, index + 1, __ATOMIC_RELEASE);
+
+  __atomic_fetch_add(&g_prof_stage_ns[stage], end - start, __ATOMIC_RELAXED);
+}
 
-    pthread_mutex_unlock(&pool->mutex);
+static inline void prof_record(int stage, int job, uint64_t start, uint64_t end) {
+  prof_record_tid(t_prof_tid, stage, job, start, end);
+}
 
-    // Process rows while there's work
-    while (my_start < pool->row_end) {
-      if (work_type == 1) {
-        do_clear_rows(my_start, my_end, cr, cg, cb);
-      } else if (work_type == 2) {
-        do_msaa_resolve_rows(my_start, my_end);
-      }
+// End a scope started with prof_begin()
+static inline void prof_end(int stage, uint64_t start) {
+  if (start) prof_record(stage, 0, start, prof_clock_ns());
+}
 
-      // Grab more work
-      pthread_mutex_lock(&pool->mutex);
-      my_start = pool->next_row;
-      pool->next_row += chunk_size;
-      my_end = MIN(my_start + chunk_size, pool->row_end);
-      pthread_mutex_unlock(&pool->mutex);
-    }
+// Close the current frame's stage totals (frames are ended by one thread at a time)
+static void prof_end_frame(void) {
+  if (!__atomic_load_n(&g_prof_enabled, __ATOMIC_RELAXED)) return;
+  ProfFrame* f = &g_prof_frames[g_prof_frames_done % PROF_FRAMES];
+  f->frame = g_prof_frame;
+  for (int s = 0; s < PROF_STAGE_COUNT; s++) {
+    f->stage_ns[s] = __atomic_exchange_n(&g_prof_stage_ns[s], 0, __ATOMIC_RELAXED);
+  }
+  __atomic_store_n(&g_prof_frames_done, g_prof_frames_done + 1, __ATOMIC_RELEASE);
+  __atomic_fetch_add(&g_prof_frame, 1, __ATOMIC_RELAXED);
+}
 
-    // Signal completion
-    pthread_mutex_lock(&pool->mutex);
-    pool->active_workers--;
-    if (pool->active_workers == 0) {
-      pool->work_type = 0;  // Reset work type
-      pthread_cond_signal(&pool->work_done);
-    }
-    pthread_mutex_unlock(&pool->mutex);
+// Profiler stage of a job system job (its tag)
+static int prof_work_stage(int tag) {
+  switch (tag) {
+    case WORK_CLEAR: return PROF_CLEAR;
+    case WORK_MSAA_RESOLVE: return PROF_MSAA_RESOLVE;
+    case WORK_RASTER_TILES: return PROF_RASTER;
+    case WORK_SETUP_TRIANGLES: return PROF_SETUP;
+    case WORK_TRANSFORM_VERTICES: return PROF_VERTEX;
+    case JOB_TAG_VOICE: return PROF_VOICE;
+    case JOB_TAG_COLLISION: return PROF_COLLISION;
+    default: return PROF_WORKER_BUSY;
   }
+}
 
-  return NULL;
+/**
+ * Job system observer (set while profiling): worker busy/idle spans, busy
+ * ones named after the job. Other addons' jobs on the shared pool also add
+ * to their own stage, as renderer stages already include their workers.
+ */
+static void prof_job_span(void* user, int worker, int tag, bool busy, uint64_t start_ns, uint64_t end_ns) {
+  if (!__atomic_load_n(&g_prof_enabled, __ATOMIC_ACQUIRE)) return;
+  int tid = MIN(PROF_TID_WORKER0 + worker, 255);
+  int job = prof_work_stage(tag);
+  prof_record_tid(tid, busy ? PROF_WORKER_BUSY : PROF_WORKER_IDLE, job, start_ns, end_ns);
+  if (busy && tag < 0 && job != PROF_WORKER_BUSY && end_ns > start_ns) {
+    __atomic_fetch_add(&g_prof_stage_ns[job], end_ns - start_ns, __ATOMIC_RELAXED);
+  }
 }
 
-// Initialize thread pool
-static void init_thread_pool(int num_threads) {
-  if (g_thread_pool) return;  // Already initialized
+// ========================================
+// Parallel Work
+// ========================================
 
-  g_thread_pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
-  if (!g_thread_pool) return;
+// Forward declarations for thread work
+static void do_clear_rows(int start_row, int end_row, uint8_t r, uint8_t g, uint8_t b);
+static void do_msaa_resolve_rows(int start_row, int end_row);
+static void do_raster_tiles(int start_tile, int end_tile);
+static void do_setup_chunks(int start_chunk, int end_chunk);
+static void do_transform_vertices(int start_chunk, int end_chunk);
+static void flush_tiles(void);
+static void discard_pending_tiles(void);
+static bool init_tile_bins(void);
+static void free_tile_bins(void);
+static bool init_hiz(void);
+static void reset_hiz(void);
+static void free_hiz(void);
+static bool init_glyph_layer(size_t pixel_count);
+static void clear_glyph_layer(void);
+static void free_glyph_layer(void);
+static void set_active_size(int width, int height);
+static void present_scene(void);
+static void apply_options(bool backface_culling, bool textures);
+static void shutdown_frame_pipeline(void);
+
+// Run one claimed range of work items
+static void run_work_range(int work_type, int start, int end, uint8_t cr, uint8_t cg, uint8_t cb) {
+  switch (work_type) {
+    case WORK_CLEAR: do_clear_rows(start, end, cr, cg, cb); break;
+    case WORK_MSAA_RESOLVE: do_msaa_resolve_rows(start, end); break;
+    case WORK_RASTER_TILES: do_raster_tiles(start, end); break;
+    case WORK_SETUP_TRIANGLES: do_setup_chunks(start, end); break;
+    case WORK_TRANSFORM_VERTICES: do_transform_vertices(start, end); break;
+    default: break;
+  }
+}
 
-  pthread_mutex_init(&g_thread_pool->mutex, NULL);
-  pthread_cond_init(&g_thread_pool->work_ready, NULL);
-  pthread_cond_init(&g_thread_pool->work_done, NULL);
+static void run_work_job(void* ctx, int start, int end) {
+  const WorkJob* job = (const WorkJob*)ctx;
+  run_work_range(job->work_type, start, end, job->clear_r, job->clear_g, job->clear_b);
+}
 
-  // Limit threads
-  if (num_threads <= 0) num_threads = 4;
-  if (num_threads > MAX_THREADS) num_threads = MAX_THREADS;
-  g_thread_pool->num_threads = num_threads;
-  g_thread_pool->shutdown = false;
-  g_thread_pool->work_type = 0;
+/**
+ * Run work items [start, end) on the shared job system in chunks of
+ * chunk_size, this thread included. Runs inline when there are no workers
+ * or fewer than min_parallel items.
+ */
+static void dispatch_parallel_work(int work_type, int start, int end, int chunk_size, int min_parallel,
+                                   uint8_t cr, uint8_t cg, uint8_t cb) {
+  WorkJob job = { work_type, cr, cg, cb };
+  jobs_parallel_for(work_type, run_work_job, &job, start, end, MAX(chunk_size, 1), min_parallel);
+}
 
-  // Create worker threads
-  for (int i = 0; i < num_threads; i++) {
-    pthread_create(&g_thread_pool->threads[i], NULL, thread_worker, g_thread_pool);
-  }
+// Dispatch row-based work (clear / MSAA resolve) in 8-row chunks
+static void dispatch_row_work(int work_type, uint8_t cr, uint8_t cg, uint8_t cb) {
+  dispatch_parallel_work(work_type, 0, g_height, 8, MIN_ROWS_PER_THREAD * 2, cr, cg, cb);
 }
 
-// Shutdown thread pool
-static void shutdown_thread_pool(void) {
-  if (!g_thread_pool) return;
+// ========================================
+// Frame Recording
+// ========================================
 
-  pthread_mutex_lock(&g_thread_pool->mutex);
-  g_thread_pool->shutdown = true;
-  pthread_cond_broadcast(&g_thread_pool->work_ready);
-  pthread_mutex_unlock(&g_thread_pool->mutex);
+/*
+ * Between beginFrame() and submitFrame(), frame state and draw calls are
+ * recorded into a command list instead of executing. The render thread
+ * replays a submitted list (raster, MSAA resolve, overlays, terminal encode)
+ * while JS records the next frame into the other list. Every other call that
+ * touches renderer state first waits for the frame in flight.
+ */
+typedef enum {
+  FCMD_CLEAR,
+  FCMD_SET_OPTIONS,
+  FCMD_BIND_TEXTURE,
+  FCMD_BIND_LIGHTMAP,
+  FCMD_DRAW_MESH,
+  FCMD_FLUSH,
+  FCMD_RESOLVE_MSAA,
+  FCMD_DRAW_GLYPHS,
+  FCMD_COMPOSITE_CELLS,
+  FCMD_TINT_GLYPHS
+} FrameCmdType;
 
-  for (int i = 0; i < g_thread_pool->num_threads; i++) {
-    pthread_join(g_thread_pool->threads[i], NULL);
-  }
+typedef struct {
+  int32_t type;      // FCMD_* constant
+  int32_t args[4];   // clear/tint rgb, options, texture/lightmap id, mesh handle, cell count
+  float amount;      // Tint amount
+  float mvp[16];
+  size_t payload;    // Byte offset of cell data in the list's payload
+} FrameCmd;
 
-  pthread_mutex_destroy(&g_thread_pool->mutex);
-  pthread_cond_destroy(&g_thread_pool->work_ready);
-  pthread_cond_destroy(&g_thread_pool->work_done);
+// Terminal encoding run at the end of a frame
+enum { FRAME_ENCODE_NONE, FRAME_ENCODE_HALF_BLOCK, FRAME_ENCODE_HALF_BLOCK_DIFF, FRAME_ENCODE_SIXEL };
 
-  free(g_thread_pool);
-  g_thread_pool = NULL;
+typedef struct {
+  FrameCmd* cmds;
+  int count;
+  int capacity;
+  uint8_t* payload;
+  size_t payload_len;
+  size_t payload_cap;
+  int encode;        // FRAME_ENCODE_* constant
+  int width, height; // Frame size the list was recorded for
+  int32_t sixel_scale, sixel_quant, sixel_max_colors;
+  int id;
+  // Meshes/textures destroyed while this list was recording; freed once its
+  // replay is done so the handles it stores stay valid (and unreused) until then
+  int32_t* deferred_meshes;
+  int deferred_mesh_count, deferred_mesh_cap;
+  int32_t* deferred_textures;
+  int deferred_texture_count, deferred_texture_cap;
+} FrameList;
+
+static FrameList g_frame_lists[2];
+static FrameList* g_recording = NULL;   // List being recorded (NULL = immediate mode)
+static int g_record_slot = 0;
+
+// Render thread hand-off (pending = submitted and not yet finished)
+static pthread_mutex_t g_frame_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_frame_submitted = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t g_frame_finished = PTHREAD_COND_INITIALIZER;
+static FrameList* g_frame_pending = NULL;
+static bool g_frame_thread_running = false;
+static double g_frame_render_ms = 0;    // Last frame's replay + encode time on the render thread
+static double g_frame_wait_ms = 0;      // Last time submitFrame() blocked on the previous frame
+
+static void destroy_mesh_now(int32_t handle);
+static void destroy_texture_now(int32_t id);
+
+// Queue a handle on a list's deferred destroys (false on allocation failure)
+static bool defer_handle(int32_t** list, int* count, int* cap, int32_t handle) {
+  if (*count >= *cap) {
+    int capacity = *cap ? *cap * 2 : 16;
+    int32_t* grown = (int32_t*)realloc(*list, sizeof(int32_t) * capacity);
+    if (!grown) return false;
+    *list = grown;
+    *cap = capacity;
+  }
+  (*list)[(*count)++] = handle;
+  return true;
 }
 
-// Dispatch parallel work
-static void dispatch_parallel_work(int work_type, int row_start, int row_end,
-                                   uint8_t cr, uint8_t cg, uint8_t cb) {
-  if (!g_thread_pool || g_thread_pool->num_threads <= 0) {
-    // Fallback to single-threaded
-    if (work_type == 1) {
-      do_clear_rows(row_start, row_end, cr, cg, cb);
-    } else if (work_type == 2) {
-      do_msaa_resolve_rows(row_start, row_end);
-    }
-    return;
+// Run the deferred destroys of every list that is neither recording nor in flight
+static void flush_deferred_destroys(void) {
+  pthread_mutex_lock(&g_frame_mutex);
+  const FrameList* pending = g_frame_pending;
+  pthread_mutex_unlock(&g_frame_mutex);
+
+  for (int i = 0; i < 2; i++) {
+    FrameList* f = &g_frame_lists[i];
+    if (f == g_recording || f == pending) continue;
+    for (int j = 0; j < f->deferred_mesh_count; j++) destroy_mesh_now(f->deferred_meshes[j]);
+    for (int j = 0; j < f->deferred_texture_count; j++) destroy_texture_now(f->deferred_textures[j]);
+    f->deferred_mesh_count = 0;
+    f->deferred_texture_count = 0;
   }
+}
 
-  // Only use threads if there's enough work
-  int rows = row_end - row_start;
-  if (rows < MIN_ROWS_PER_THREAD * 2) {
-    if (work_type == 1) {
-      do_clear_rows(row_start, row_end, cr, cg, cb);
-    } else if (work_type == 2) {
-      do_msaa_resolve_rows(row_start, row_end);
+// Block until the render thread has finished the frame in flight
+static void wait_frame_idle(void) {
+  if (g_frame_thread_running) {
+    uint64_t prof = prof_begin();
+    pthread_mutex_lock(&g_frame_mutex);
+    bool waited = g_frame_pending != NULL;
+    while (g_frame_pending) {
+      pthread_cond_wait(&g_frame_finished, &g_frame_mutex);
     }
-    return;
+    pthread_mutex_unlock(&g_frame_mutex);
+    if (waited) prof_end(PROF_FRAME_WAIT, prof);
   }
+  flush_deferred_destroys();
+}
 
-  pthread_mutex_lock(&g_thread_pool->mutex);
-
-  g_thread_pool->work_type = work_type;
-  g_thread_pool->row_start = row_start;
-  g_thread_pool->row_end = row_end;
-  g_thread_pool->next_row = row_start;
-  g_thread_pool->clear_r = cr;
-  g_thread_pool->clear_g = cg;
-  g_thread_pool->clear_b = cb;
-  g_thread_pool->active_workers = g_thread_pool->num_threads;
+// Append a command to the list being recorded (NULL on allocation failure)
+static FrameCmd* record_cmd(int type) {
+  FrameList* f = g_recording;
+  if (f->count >= f->capacity) {
+    int capacity = f->capacity ? f->capacity * 2 : 256;
+    FrameCmd* grown = (FrameCmd*)realloc(f->cmds, sizeof(FrameCmd) * capacity);
+    if (!grown) return NULL;
+    f->cmds = grown;
+    f->capacity = capacity;
+  }
+  FrameCmd* cmd = &f->cmds[f->count++];
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->type = type;
+  return cmd;
+}
 
-  // Wake all workers
-  pthread_cond_broadcast(&g_thread_pool->work_ready);
+// Drop the command just recorded (its payload could not be stored)
+static FrameCmd* discard_cmd(void) {
+  g_recording->count--;
+  return NULL;
+}
 
-  // Wait for completion
-  while (g_thread_pool->active_workers > 0) {
-    pthread_cond_wait(&g_thread_pool->work_done, &g_thread_pool->mutex);
+// Copy command data into the list's payload; returns its offset (SIZE_MAX on failure)
+static size_t record_payload(const void* data, size_t bytes) {
+  FrameList* f = g_recording;
+  size_t offset = ALIGN_UP(f->payload_len, 16);
+  if (offset + bytes > f->payload_cap) {
+    size_t capacity = MAX(f->payload_cap * 2, offset + bytes);
+    uint8_t* grown = (uint8_t*)realloc(f->payload, capacity);
+    if (!grown) return SIZE_MAX;
+    f->payload = grown;
+    f->payload_cap = capacity;
   }
+  memcpy(f->payload + offset, data, bytes);
+  f->payload_len = offset + bytes;
+  return offset;
+}
 
-  pthread_mutex_unlock(&g_thread_pool->mutex);
+// Result of a recording-mode call (throws if the command could not be stored)
+static napi_value recorded_result(napi_env env, FrameCmd* cmd) {
+  if (!cmd) {
+    napi_throw_error(env, NULL, "Failed to record frame command");
+    return NULL;
+  }
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
 }
 
 // ========================================
@@ -292,17 +583,15 @@ static void do_clear_rows(int start_row, int end_row, uint8_t r, uint8_t g, uint
       g_depth_buffer[i] = 1.0f;
     }
 
-    // Clear MSAA buffers if active
+    // Clear MSAA buffers if active (samples are interleaved per pixel)
     if (g_msaa_samples > 1 && g_msaa_buffer && g_msaa_depth) {
-      for (int s = 0; s < g_msaa_samples; s++) {
-        size_t sample_row_start = s * g_width * g_height + row_start;
-        for (int x = 0; x < g_width; x++) {
-          size_t i = sample_row_start + x;
-          g_msaa_buffer[i * 3] = r;
-          g_msaa_buffer[i * 3 + 1] = g;
-          g_msaa_buffer[i * 3 + 2] = b;
-          g_msaa_depth[i] = 1.0f;
-        }
+      size_t first = row_start * g_msaa_samples;
+      size_t last = first + (size_t)g_width * g_msaa_samples;
+      for (size_t i = first; i < last; i++) {
+        g_msaa_buffer[i * 3] = r;
+        g_msaa_buffer[i * 3 + 1] = g;
+        g_msaa_buffer[i * 3 + 2] = b;
+        g_msaa_depth[i] = 1.0f;
       }
     }
   }
@@ -312,25 +601,22 @@ static void do_clear_rows(int start_row, int end_row, uint8_t r, uint8_t g, uint
 static void do_msaa_resolve_rows(int start_row, int end_row) {
   if (!g_framebuffer || !g_msaa_buffer || g_msaa_samples <= 1) return;
 
-  size_t pixel_count = (size_t)g_width * g_height;
+  int samples = g_msaa_samples;
 
   for (int y = start_row; y < end_row && y < g_height; y++) {
     for (int x = 0; x < g_width; x++) {
       size_t i = (size_t)y * g_width + x;
+      const uint8_t* color = g_msaa_buffer + i * samples * 3;
+      const float* depth = g_msaa_depth + i * samples;
 
       uint32_t r_sum = 0, g_sum = 0, b_sum = 0;
       float min_depth = 1.0f;
 
-      for (int s = 0; s < g_msaa_samples; s++) {
-        size_t sample_idx = (s * pixel_count + i) * 3;
-        r_sum += g_msaa_buffer[sample_idx];
-        g_sum += g_msaa_buffer[sample_idx + 1];
-        b_sum += g_msaa_buffer[sample_idx + 2];
-
-        size_t depth_idx = s * pixel_count + i;
-        if (g_msaa_depth[depth_idx] < min_depth) {
-          min_depth = g_msaa_depth[depth_idx];
-        }
+      for (int s = 0; s < samples; s++) {
+        r_sum += color[s * 3];
+        g_sum += color[s * 3 + 1];
+        b_sum += color[s * 3 + 2];
+        min_depth = MIN(min_depth, depth[s]);
       }
 
       g_framebuffer[i * 3] = (uint8_t)(r_sum / g_msaa_samples);
@@ -341,27 +627,184 @@ static void do_msaa_resolve_rows(int start_row, int end_row) {
   }
 }
 
-// Sample texture at UV coordinates (with wrapping)
-static inline void sample_texture(float u, float v, uint8_t* r, uint8_t* g, uint8_t* b) {
-  if (!g_current_texture || g_texture_width <= 0 || g_texture_height <= 0) {
-    *r = 200; *g = 200; *b = 200;
-    return;
+// ========================================
+// Texture Images
+// ========================================
+
+// Morton index of (x, y) inside a 4x4 tile, indexed by (y << 2) | x
+static const uint8_t k_tile_morton[16] = {
+  0, 1, 4, 5,
+  2, 3, 6, 7,
+  8, 9, 12, 13,
+  10, 11, 14, 15
+};
+
+static inline int ceil_log2(int n) {
+  int l = 0;
+  while ((1 << l) < n) l++;
+  return l;
+}
+
+// Texel count of a level once padded to whole tiles
+static inline size_t tex_level_texels(int lw, int lh) {
+  return (size_t)(1 << MAX(lw, 2)) << MAX(lh, 2);
+}
+
+static void free_tex_image(TexImage* img) {
+  free(img->texels);
+  memset(img, 0, sizeof(*img));
+}
+
+// Average 2x2 packed texels per channel (rounded)
+static inline uint32_t tex_average4(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+  uint32_t rb = (a & 0x00FF00FFu) + (b & 0x00FF00FFu) + (c & 0x00FF00FFu) + (d & 0x00FF00FFu) + 0x00020002u;
+  uint32_t g = (a & 0x0000FF00u) + (b & 0x0000FF00u) + (c & 0x0000FF00u) + (d & 0x0000FF00u) + 0x00000200u;
+  return ((rb >> 2) & 0x00FF00FFu) | ((g >> 2) & 0x0000FF00u);
+}
+
+/**
+ * Build a mip-mapped, tiled image from row-major RGB.
+ * Non-power-of-two sizes are point-resampled up to the next power of two;
+ * each further level is a 2x2 box filter of the previous one.
+ * Returns false on allocation failure (img left empty).
+ */
+static bool build_tex_image(TexImage* img, const uint8_t* rgb, int width, int height) {
+  memset(img, 0, sizeof(*img));
+  int lw = ceil_log2(width), lh = ceil_log2(height);
+  int levels = MAX(lw, lh) + 1;
+
+  size_t total = 0;
+  for (int l = 0; l < levels; l++) {
+    img->level_offset[l] = total;
+    total += tex_level_texels(MAX(lw - l, 0), MAX(lh - l, 0));
+  }
+
+  // Linear staging for the level being swizzled and the next one down
+  size_t level0 = (size_t)1 << (lw + lh);
+  uint32_t* texels = (uint32_t*)calloc(total, sizeof(uint32_t));
+  uint32_t* cur = (uint32_t*)malloc(level0 * sizeof(uint32_t));
+  uint32_t* next = (uint32_t*)malloc(MAX(level0 / 2, 1) * sizeof(uint32_t));
+  if (!texels || !cur || !next) {
+    free(texels); free(cur); free(next);
+    return false;
+  }
+
+  int w = 1 << lw, h = 1 << lh;
+  for (int y = 0; y < h; y++) {
+    const uint8_t* row = rgb + (size_t)((y * 2 + 1) * height / (h * 2)) * width * 3;
+    for (int x = 0; x < w; x++) {
+      const uint8_t* p = row + (size_t)((x * 2 + 1) * width / (w * 2)) * 3;
+      cur[(size_t)y * w + x] = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    }
+  }
+
+  for (int l = 0; l < levels; l++) {
+    int tile_shift = MAX(lw - l - 2, 0);
+    uint32_t* dst = texels + img->level_offset[l];
+    for (int y = 0; y < h; y++) {
+      for (int x = 0; x < w; x++) {
+        dst[((((y >> 2) << tile_shift) + (x >> 2)) << 4) | k_tile_morton[((y & 3) << 2) | (x & 3)]] =
+            cur[(size_t)y * w + x];
+      }
+    }
+    if (l + 1 == levels) break;
+
+    int nw = MAX(w >> 1, 1), nh = MAX(h >> 1, 1);
+    int sx = w > 1 ? 1 : 0, sy = h > 1 ? w : 0;
+    for (int y = 0; y < nh; y++) {
+      for (int x = 0; x < nw; x++) {
+        const uint32_t* s = cur + (size_t)(y << (h > 1)) * w + (x << (w > 1));
+        next[(size_t)y * nw + x] = tex_average4(s[0], s[sx], s[sy], s[sy + sx]);
+      }
+    }
+    uint32_t* t = cur; cur = next; next = t;
+    w = nw; h = nh;
+  }
+  free(cur);
+  free(next);
+
+  img->texels = texels;
+  img->log2_w = lw;
+  img->log2_h = lh;
+  img->levels = levels;
+  img->bytes = total * sizeof(uint32_t);
+  return true;
+}
+
+// Blend two packed texels by w/256
+static inline uint32_t tex_lerp(uint32_t a, uint32_t b, uint32_t w) {
+  uint32_t iw = 256 - w;
+  uint32_t rb = ((a & 0x00FF00FFu) * iw + (b & 0x00FF00FFu) * w) >> 8;
+  uint32_t g = ((a & 0x0000FF00u) * iw + (b & 0x0000FF00u) * w) >> 8;
+  return (rb & 0x00FF00FFu) | (g & 0x0000FF00u);
+}
+
+FORCE_INLINE uint32_t tex_fetch(const uint32_t* level, int tile_shift, int x, int y) {
+  return level[((((y >> 2) << tile_shift) + (x >> 2)) << 4) | k_tile_morton[((y & 3) << 2) | (x & 3)]];
+}
+
+// Nearest texel of a level; u, v already wrapped to [0, 1]. snap > 0 selects
+// the center texel of each (1 << snap)^2 block (pixelated filter).
+FORCE_INLINE uint32_t tex_nearest(const TexImage* img, int level, float u, float v, int snap) {
+  int lw = MAX(img->log2_w - level, 0), lh = MAX(img->log2_h - level, 0);
+  int x = (int)(u * (float)(1 << lw)) & ((1 << lw) - 1);
+  int y = (int)(v * (float)(1 << lh)) & ((1 << lh) - 1);
+  if (snap > 0) {
+    int sx = MIN(snap, lw), sy = MIN(snap, lh);
+    x = ((x >> sx) << sx) | ((1 << sx) >> 1);
+    y = ((y >> sy) << sy) | ((1 << sy) >> 1);
   }
+  return tex_fetch(img->texels + img->level_offset[level], MAX(lw - 2, 0), x, y);
+}
 
-  // Wrap UVs
+// Bilinear sample of a level (texel centers at half-integers, wrapped)
+FORCE_INLINE uint32_t tex_bilinear(const TexImage* img, int level, float u, float v) {
+  int lw = MAX(img->log2_w - level, 0), lh = MAX(img->log2_h - level, 0);
+  int mask_x = (1 << lw) - 1, mask_y = (1 << lh) - 1;
+  float px = u * (float)(1 << lw) - 0.5f;
+  float py = v * (float)(1 << lh) - 0.5f;
+  int x0 = (int)(px + 1.0f) - 1;  // floor for px >= -1
+  int y0 = (int)(py + 1.0f) - 1;
+  uint32_t wx = (uint32_t)((px - (float)x0) * 256.0f);
+  uint32_t wy = (uint32_t)((py - (float)y0) * 256.0f);
+  int x1 = (x0 + 1) & mask_x, y1 = (y0 + 1) & mask_y;
+  x0 &= mask_x; y0 &= mask_y;
+
+  const uint32_t* t = img->texels + img->level_offset[level];
+  int shift = MAX(lw - 2, 0);
+  uint32_t top = tex_lerp(tex_fetch(t, shift, x0, y0), tex_fetch(t, shift, x1, y0), wx);
+  uint32_t bottom = tex_lerp(tex_fetch(t, shift, x0, y1), tex_fetch(t, shift, x1, y1), wx);
+  return tex_lerp(top, bottom, wy);
+}
+
+/**
+ * Sample a texture image with the current filter mode.
+ * w is the pixel's clip w and lod_base the triangle's LOD at w = 1
+ * (only used by trilinear).
+ */
+FORCE_INLINE uint32_t sample_texture(const TexImage* img, float u, float v, float w, float lod_base) {
   u = u - floorf(u);
   v = v - floorf(v);
 
-  // Convert to pixel coordinates
-  int tx = (int)(u * g_texture_width) % g_texture_width;
-  int ty = (int)(v * g_texture_height) % g_texture_height;
-  if (tx < 0) tx += g_texture_width;
-  if (ty < 0) ty += g_texture_height;
-
-  size_t idx = (ty * g_texture_width + tx) * 3;
-  *r = g_current_texture[idx];
-  *g = g_current_texture[idx + 1];
-  *b = g_current_texture[idx + 2];
+  switch (g_texture_filter) {
+    case TEX_FILTER_BILINEAR:
+      return tex_bilinear(img, 0, u, v);
+    case TEX_FILTER_TRILINEAR: {
+      float lod = lod_base + 1.5f * fast_log2(w);
+      if (lod <= 0.0f) return tex_bilinear(img, 0, u, v);
+      int top = img->levels - 1;
+      if (lod >= (float)top) return tex_bilinear(img, top, u, v);
+      int l0 = (int)lod;
+      uint32_t t = (uint32_t)((lod - (float)l0) * 256.0f);
+      return tex_lerp(tex_bilinear(img, l0, u, v), tex_bilinear(img, l0 + 1, u, v), t);
+    }
+    case TEX_FILTER_PIXELATED:
+      return tex_nearest(img, 0, u, v, g_texture_block_log2);
+    case TEX_FILTER_BLOCKAVG:
+      return tex_nearest(img, MIN(g_texture_block_log2, img->levels - 1), u, v, 0);
+    default:
+      return tex_nearest(img, 0, u, v, 0);
+  }
 }
 
 /**
@@ -388,28 +831,52 @@ static napi_value render_init(napi_env env, napi_callback_info info) {
   }
   if (msaa != 1 && msaa != 4 && msaa != 16) msaa = 1;
 
-  // Free existing buffers
-  free(g_framebuffer);
-  free(g_depth_buffer);
-  free(g_msaa_buffer);
-  free(g_msaa_depth);
+  wait_frame_idle();
 
-  g_width = width;
-  g_height = height;
+  // A frame being recorded and pending triangles belong to the old framebuffer size
+  g_recording = NULL;
+  discard_pending_tiles();
+
+  g_out_width = width;
+  g_out_height = height;
+  g_max_msaa_samples = msaa;
   g_msaa_samples = msaa;
+  g_scene_request = 0;
+  g_scene_pending = false;
 
   size_t pixel_count = (size_t)width * height;
+  size_t sample_count = msaa > 1 ? pixel_count * msaa : 0;
 
-  // Allocate with alignment for SIMD (aligned_alloc requires size to be multiple of alignment)
-  size_t fb_size = ALIGN_UP(pixel_count * 3, 16);
-  size_t depth_size = ALIGN_UP(pixel_count * sizeof(float), 16);
+  // Reallocate only when the new size or sample count exceeds what is held
+  if (pixel_count > g_pixel_capacity) {
+    free(g_framebuffer);
+    free(g_depth_buffer);
+    g_pixel_capacity = 0;
 
-  g_framebuffer = (uint8_t*)aligned_alloc(16, fb_size);
-  g_depth_buffer = (float*)aligned_alloc(16, depth_size);
+    // Allocate with alignment for SIMD (aligned_alloc requires size to be multiple of alignment)
+    g_framebuffer = (uint8_t*)aligned_alloc(16, ALIGN_UP(pixel_count * 3, 16));
+    g_depth_buffer = (float*)aligned_alloc(16, ALIGN_UP(pixel_count * sizeof(float), 16));
 
-  if (!g_framebuffer || !g_depth_buffer) {
-    napi_throw_error(env, NULL, "Failed to allocate framebuffer");
-    return NULL;
+    if (!g_framebuffer || !g_depth_buffer) {
+      napi_throw_error(env, NULL, "Failed to allocate framebuffer");
+      return NULL;
+    }
+    g_pixel_capacity = pixel_count;
+  }
+
+  if (sample_count > g_msaa_capacity) {
+    free(g_msaa_buffer);
+    free(g_msaa_depth);
+    g_msaa_capacity = 0;
+
+    g_msaa_buffer = (uint8_t*)aligned_alloc(16, ALIGN_UP(sample_count * 3, 16));
+    g_msaa_depth = (float*)aligned_alloc(16, ALIGN_UP(sample_count * sizeof(float), 16));
+
+    if (!g_msaa_buffer || !g_msaa_depth) {
+      napi_throw_error(env, NULL, "Failed to allocate MSAA buffers");
+      return NULL;
+    }
+    g_msaa_capacity = sample_count;
   }
 
   memset(g_framebuffer, 0, pixel_count * 3);
@@ -419,36 +886,52 @@ static napi_value render_init(napi_env env, napi_callback_info info) {
     g_depth_buffer[i] = 1.0f;
   }
 
-  // MSAA buffers
   if (msaa > 1) {
-    size_t msaa_fb_size = ALIGN_UP(pixel_count * 3 * msaa, 16);
-    size_t msaa_depth_size = ALIGN_UP(pixel_count * msaa * sizeof(float), 16);
-
-    g_msaa_buffer = (uint8_t*)aligned_alloc(16, msaa_fb_size);
-    g_msaa_depth = (float*)aligned_alloc(16, msaa_depth_size);
-
-    if (!g_msaa_buffer || !g_msaa_depth) {
-      napi_throw_error(env, NULL, "Failed to allocate MSAA buffers");
-      return NULL;
-    }
-
-    memset(g_msaa_buffer, 0, pixel_count * 3 * msaa);
-    for (size_t i = 0; i < pixel_count * msaa; i++) {
+    memset(g_msaa_buffer, 0, sample_count * 3);
+    for (size_t i = 0; i < sample_count; i++) {
       g_msaa_depth[i] = 1.0f;
     }
-  } else {
-    g_msaa_buffer = NULL;
-    g_msaa_depth = NULL;
   }
 
-  // Initialize thread pool (use 4 threads by default)
-  init_thread_pool(4);
+  // Screen tiles for binned rasterization
+  if (!init_tile_bins() || !init_hiz() || !init_glyph_layer(pixel_count)) {
+    napi_throw_error(env, NULL, "Failed to allocate tile bins");
+    return NULL;
+  }
+  g_width = 0;
+  set_active_size(width, height);
+
+  // Start (or reuse) the shared job system before the first frame
+  jobs_get();
 
   napi_value result;
   NAPI_CALL(env, napi_get_boolean(env, true, &result));
   return result;
 }
 
+// Clear framebuffer, depth and overlays for a new frame
+static void clear_frame(uint8_t r, uint8_t g, uint8_t b) {
+  if (!g_framebuffer) return;
+
+  // Triangles still waiting in tile bins would be overwritten anyway
+  discard_pending_tiles();
+
+  // Start the frame at the scene size and sample count from setRenderScale()
+  uint32_t scene = __atomic_load_n(&g_scene_request, __ATOMIC_RELAXED);
+  int width = scene ? (int)(scene >> 18) : g_out_width;
+  int height = scene ? (int)((scene >> 5) & 0x1FFF) : g_out_height;
+  g_msaa_samples = scene ? (int)(scene & 0x1F) : g_max_msaa_samples;
+  g_scene_pending = width != g_out_width || height != g_out_height;
+  set_active_size(width, height);
+  reset_hiz();
+  clear_glyph_layer();
+
+  // Dispatch parallel clear
+  uint64_t prof = prof_begin();
+  dispatch_row_work(WORK_CLEAR, r, g, b);
+  prof_end(PROF_CLEAR, prof);
+}
+
 /**
  * Clear framebuffer and depth (parallel).
  */
@@ -464,13 +947,23 @@ static napi_value render_clear(napi_env env, napi_callback_info info) {
     napi_get_value_int32(env, args[2], &b);
   }
 
+  if (g_recording) {
+    FrameCmd* cmd = record_cmd(FCMD_CLEAR);
+    if (cmd) {
+      cmd->args[0] = r;
+      cmd->args[1] = g;
+      cmd->args[2] = b;
+    }
+    return recorded_result(env, cmd);
+  }
+
+  wait_frame_idle();
   if (!g_framebuffer) {
     napi_throw_error(env, NULL, "Renderer not initialized");
     return NULL;
   }
 
-  // Dispatch parallel clear (work type 1)
-  dispatch_parallel_work(1, 0, g_height, (uint8_t)r, (uint8_t)g, (uint8_t)b);
+  clear_frame((uint8_t)r, (uint8_t)g, (uint8_t)b);
 
   napi_value result;
   NAPI_CALL(env, napi_get_undefined(env, &result));
@@ -480,13 +973,24 @@ static napi_value render_clear(napi_env env, napi_callback_info info) {
 // Debug counters
 static int g_debug_frame = 0;
 static int g_debug_textures_set = 0;
+static int g_debug_texture_uploads = 0;
 static int g_debug_triangles_with_uv = 0;
 static int g_debug_triangles_textured = 0;
+static int g_debug_triangles_lightmapped = 0;
 static int g_debug_backface_culled = 0;
 static int g_debug_near_clipped = 0;
+static int g_debug_triangles_clipped = 0;      // Sent to the near-plane clipper
+static int g_debug_vertices_transformed = 0;   // By the vertex stage
 static int g_debug_frustum_culled = 0;
 static int g_debug_degenerate = 0;
 static int g_debug_total_tris = 0;
+static int g_debug_hiz_culled = 0;           // Whole triangles rejected before binning
+static int g_debug_hiz_blocks_rejected = 0;  // Triangle/8x8-block pairs skipped in tiles
+static int g_debug_occlusion_tests = 0;
+static int g_debug_occluded_objects = 0;
+static int g_debug_overlay_cells = 0;        // Glyph-layer cells written
+static int g_debug_submitted_draws = 0;      // Draws rendered from command buffers
+static int g_debug_texture_binds = 0;        // Texture switches (same-texture binds are free)
 
 /**
  * Set rendering options (backface culling, textures enabled).
@@ -496,32 +1000,63 @@ static napi_value render_set_options(napi_env env, napi_callback_info info) {
   napi_value args[2];
   NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
 
+  bool backface_culling = g_enable_backface_culling;
+  bool textures = g_enable_textures;
   if (argc >= 1) {
-    NAPI_CALL(env, napi_get_value_bool(env, args[0], &g_enable_backface_culling));
+    NAPI_CALL(env, napi_get_value_bool(env, args[0], &backface_culling));
   }
   if (argc >= 2) {
-    NAPI_CALL(env, napi_get_value_bool(env, args[1], &g_enable_textures));
+    NAPI_CALL(env, napi_get_value_bool(env, args[1], &textures));
+  }
+
+  if (g_recording) {
+    FrameCmd* cmd = record_cmd(FCMD_SET_OPTIONS);
+    if (cmd) {
+      cmd->args[0] = backface_culling;
+      cmd->args[1] = textures;
+    }
+    return recorded_result(env, cmd);
   }
 
+  wait_frame_idle();
+  apply_options(backface_culling, textures);
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+// Set options and reset debug counters (start of frame)
+static void apply_options(bool backface_culling, bool textures) {
+  g_enable_backface_culling = backface_culling;
+  g_enable_textures = textures;
+
   // Reset debug counters at start of frame
+  prof_end_frame();
   g_debug_frame++;
   g_debug_textures_set = 0;
+  g_debug_texture_uploads = 0;
   g_debug_triangles_with_uv = 0;
   g_debug_triangles_textured = 0;
+  g_debug_triangles_lightmapped = 0;
   g_debug_backface_culled = 0;
   g_debug_near_clipped = 0;
+  g_debug_triangles_clipped = 0;
+  g_debug_vertices_transformed = 0;
   g_debug_frustum_culled = 0;
   g_debug_degenerate = 0;
   g_debug_total_tris = 0;
-
-  napi_value result;
-  NAPI_CALL(env, napi_get_undefined(env, &result));
-  return result;
+  g_debug_hiz_culled = 0;
+  g_debug_hiz_blocks_rejected = 0;
+  g_debug_occlusion_tests = 0;
+  g_debug_occluded_objects = 0;
+  g_debug_overlay_cells = 0;
+  g_debug_submitted_draws = 0;
+  g_debug_texture_binds = 0;
 }
 
-// Owned texture buffer (copied from JS to avoid GC issues)
-static uint8_t* g_texture_buffer = NULL;
-static size_t g_texture_buffer_size = 0;
+// Owned texture image (built from the JS data to avoid GC issues)
+static TexImage g_texture_image;
 
 /**
  * Set current texture for subsequent rendering.
@@ -535,10 +1070,14 @@ static napi_value render_set_texture(napi_env env, napi_callback_info info) {
   napi_value args[3];
   NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
 
+  wait_frame_idle();
+
   // Check for null/undefined first arg (no texture)
   napi_valuetype type;
   NAPI_CALL(env, napi_typeof(env, args[0], &type));
 
+  g_bound_texture_id = 0;
+
   if (type == napi_null || type == napi_undefined) {
     g_current_texture = NULL;
     g_texture_width = 0;
@@ -550,18 +1089,15 @@ static napi_value render_set_texture(napi_env env, napi_callback_info info) {
     NAPI_CALL(env, napi_get_value_int32(env, args[1], &g_texture_width));
     NAPI_CALL(env, napi_get_value_int32(env, args[2], &g_texture_height));
 
-    // Reallocate buffer if needed
-    size_t needed_size = (size_t)g_texture_width * g_texture_height * 3;
-    if (needed_size > g_texture_buffer_size) {
-      free(g_texture_buffer);
-      g_texture_buffer = (uint8_t*)malloc(needed_size);
-      g_texture_buffer_size = needed_size;
-    }
+    // Binned triangles may still point at the old image
+    flush_tiles();
+    free_tex_image(&g_texture_image);
 
-    // Copy texture data
-    if (g_texture_buffer && tex_len >= needed_size) {
-      memcpy(g_texture_buffer, src_data, needed_size);
-      g_current_texture = g_texture_buffer;
+    // Build the mip chain from the texture data
+    size_t needed_size = (size_t)g_texture_width * g_texture_height * 3;
+    if (g_texture_width > 0 && g_texture_height > 0 && g_texture_width <= 4096 && g_texture_height <= 4096 &&
+        tex_len >= needed_size && build_tex_image(&g_texture_image, src_data, g_texture_width, g_texture_height)) {
+      g_current_texture = &g_texture_image;
       g_debug_textures_set++;
     } else {
       g_current_texture = NULL;
@@ -573,491 +1109,4701 @@ static napi_value render_set_texture(napi_env env, napi_callback_info info) {
   return result;
 }
 
-// Near plane threshold (matches JS Rasterizer.nearPlane = 0.05)
-#define NEAR_PLANE 0.05f
-
-// Clip vertex structure for near plane clipping
-typedef struct {
-  float cx, cy, cz, cw;  // Clip space position
-  float u, v;             // UV coordinates
-  uint8_t r, g, b;        // Color
-} ClipVert;
-
 /**
- * Transform vertex by MVP matrix.
+ * Select the texture filter used by subsequent frames.
+ * Args: mode ("nearest" | "bilinear" | "trilinear" | "pixelated" | "blockavg"),
+ *       blockSize (optional, texels per block for pixelated/blockavg; rounded
+ *       to a power of two, default 4)
  */
-static inline void transform_vertex(
-    float x, float y, float z,
-    const float* __restrict mvp,
-    float* __restrict out_x, float* __restrict out_y,
-    float* __restrict out_z, float* __restrict out_w
-) {
-  *out_x = mvp[0] * x + mvp[4] * y + mvp[8]  * z + mvp[12];
-  *out_y = mvp[1] * x + mvp[5] * y + mvp[9]  * z + mvp[13];
-  *out_z = mvp[2] * x + mvp[6] * y + mvp[10] * z + mvp[14];
-  *out_w = mvp[3] * x + mvp[7] * y + mvp[11] * z + mvp[15];
-}
+static napi_value render_set_texture_filter(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value args[2];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
 
-/**
- * Lerp between two clip vertices at parameter t.
- */
-static inline ClipVert lerp_clip_vert(const ClipVert* a, const ClipVert* b, float t) {
-  ClipVert result;
-  result.cx = a->cx + (b->cx - a->cx) * t;
-  result.cy = a->cy + (b->cy - a->cy) * t;
-  result.cz = a->cz + (b->cz - a->cz) * t;
-  result.cw = a->cw + (b->cw - a->cw) * t;
-  result.u = a->u + (b->u - a->u) * t;
-  result.v = a->v + (b->v - a->v) * t;
-  result.r = (uint8_t)(a->r + (b->r - a->r) * t);
-  result.g = (uint8_t)(a->g + (b->g - a->g) * t);
-  result.b = (uint8_t)(a->b + (b->b - a->b) * t);
+  if (argc < 1) {
+    napi_throw_error(env, NULL, "Expected filter mode");
+    return NULL;
+  }
+
+  char mode[16];
+  size_t len;
+  NAPI_CALL(env, napi_get_value_string_utf8(env, args[0], mode, sizeof(mode), &len));
+
+  TexFilter filter;
+  if (strcmp(mode, "nearest") == 0) filter = TEX_FILTER_NEAREST;
+  else if (strcmp(mode, "bilinear") == 0) filter = TEX_FILTER_BILINEAR;
+  else if (strcmp(mode, "trilinear") == 0) filter = TEX_FILTER_TRILINEAR;
+  else if (strcmp(mode, "pixelated") == 0) filter = TEX_FILTER_PIXELATED;
+  else if (strcmp(mode, "blockavg") == 0) filter = TEX_FILTER_BLOCKAVG;
+  else {
+    napi_throw_error(env, NULL, "Unknown texture filter mode");
+    return NULL;
+  }
+
+  int32_t block_size = 4;
+  if (argc >= 2) {
+    napi_valuetype type;
+    NAPI_CALL(env, napi_typeof(env, args[1], &type));
+    if (type == napi_number) NAPI_CALL(env, napi_get_value_int32(env, args[1], &block_size));
+  }
+
+  // Binned triangles sample with the filter at flush time
+  wait_frame_idle();
+  flush_tiles();
+  g_texture_filter = filter;
+  g_texture_block_log2 = ceil_log2(CLAMP(block_size, 1, 4096));
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
   return result;
 }
 
+// ========================================
+// Resident Texture Pool
+// ========================================
+
+// Default memory budget for resident textures (LRU-evicted above this)
+#define DEFAULT_TEXTURE_BUDGET (128u * 1024u * 1024u)
+
 /**
- * Clip triangle against near plane (w >= NEAR_PLANE).
- * Returns number of output triangles (0, 1, or 2).
- * out_tris should have space for 6 vertices (2 triangles).
+ * Texture uploaded once and bound by id.
+ * Evicted entries keep their slot (image == NULL) so a stale id is
+ * reported as non-resident instead of aliasing a newer texture.
+ * The image is heap-allocated so binned triangles keep a stable pointer
+ * when the slot table grows.
  */
-static int clip_triangle_near_plane(
-    const ClipVert* v0, const ClipVert* v1, const ClipVert* v2,
-    ClipVert* out_tris
-) {
-  // Classify vertices
-  int inside0 = (v0->cw >= NEAR_PLANE) ? 1 : 0;
-  int inside1 = (v1->cw >= NEAR_PLANE) ? 1 : 0;
-  int inside2 = (v2->cw >= NEAR_PLANE) ? 1 : 0;
-  int inside_count = inside0 + inside1 + inside2;
+typedef struct {
+  TexImage* image;        // Mip chain, NULL if evicted
+  int width;              // Size as uploaded
+  int height;
+  size_t bytes;           // Resident bytes (all mip levels)
+  uint64_t last_used;     // LRU clock value at last bind
+  bool in_use;            // Slot allocated (resident or evicted)
+} NativeTexture;
+
+static NativeTexture* g_textures = NULL;
+static int g_texture_capacity = 0;
+static uint64_t g_texture_clock = 0;
+static size_t g_texture_budget = DEFAULT_TEXTURE_BUDGET;
+static size_t g_texture_resident_bytes = 0;
+static int g_texture_resident_count = 0;
+static int g_texture_evictions = 0;
+
+static inline NativeTexture* get_native_texture(int32_t id) {
+  if (id <= 0 || id > g_texture_capacity || !g_textures[id - 1].in_use) return NULL;
+  return &g_textures[id - 1];
+}
 
-  // All inside - no clipping needed
-  if (inside_count == 3) {
-    out_tris[0] = *v0;
-    out_tris[1] = *v1;
-    out_tris[2] = *v2;
-    return 1;
-  }
+static void unbind_texture(void) {
+  g_current_texture = NULL;
+  g_texture_width = 0;
+  g_texture_height = 0;
+  g_bound_texture_id = 0;
+}
 
-  // All outside - cull entire triangle
+static void unbind_lightmap(void) {
+  g_current_lightmap = NULL;
+  g_bound_lightmap_id = 0;
+}
+
+static void evict_texture(int32_t id) {
+  NativeTexture* tex = &g_textures[id - 1];
+  if (!tex->image) return;
+  flush_tiles();  // Binned triangles may still sample this texture
+  if (g_bound_texture_id == id) unbind_texture();
+  if (g_bound_lightmap_id == id) unbind_lightmap();
+  free_tex_image(tex->image);
+  free(tex->image);
+  tex->image = NULL;
+  g_texture_resident_bytes -= tex->bytes;
+  g_texture_resident_count--;
+}
+
+// Evict least-recently-bound textures until `incoming` more bytes fit the budget.
+// The currently bound texture and lightmap are never evicted.
+static void make_texture_room(size_t incoming) {
+  while (g_texture_resident_bytes + incoming > g_texture_budget) {
+    int32_t victim = 0;
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < g_texture_capacity; i++) {
+      NativeTexture* tex = &g_textures[i];
+      if (tex->image && i + 1 != g_bound_texture_id && i + 1 != g_bound_lightmap_id &&
+          tex->last_used < oldest) {
+        oldest = tex->last_used;
+        victim = i + 1;
+      }
+    }
+    if (victim == 0) break;  // Nothing evictable; allow going over budget
+    evict_texture(victim);
+    g_texture_evictions++;
+  }
+}
+
+// Find a free slot, growing the table if needed. Returns id or 0.
+static int32_t alloc_texture_slot(void) {
+  for (int i = 0; i < g_texture_capacity; i++) {
+    if (!g_textures[i].in_use) return i + 1;
+  }
+
+  int new_capacity = g_texture_capacity > 0 ? g_texture_capacity * 2 : 256;
+  NativeTexture* grown = (NativeTexture*)realloc(g_textures, sizeof(NativeTexture) * new_capacity);
+  if (!grown) return 0;
+  memset(grown + g_texture_capacity, 0, sizeof(NativeTexture) * (new_capacity - g_texture_capacity));
+
+  int slot = g_texture_capacity;
+  g_textures = grown;
+  g_texture_capacity = new_capacity;
+  return slot + 1;
+}
+
+static void destroy_all_textures(void) {
+  for (int i = 0; i < g_texture_capacity; i++) {
+    if (g_textures[i].image) free_tex_image(g_textures[i].image);
+    free(g_textures[i].image);
+  }
+  free(g_textures);
+  g_textures = NULL;
+  g_texture_capacity = 0;
+  g_texture_resident_bytes = 0;
+  g_texture_resident_count = 0;
+  if (g_bound_texture_id != 0) unbind_texture();
+  if (g_bound_lightmap_id != 0) unbind_lightmap();
+}
+
+/**
+ * Upload a texture into the resident pool.
+ * Args: textureData (Uint8Array RGB), width, height
+ * Returns: texture id (> 0)
+ */
+static napi_value render_upload_texture(napi_env env, napi_callback_info info) {
+  size_t argc = 3;
+  napi_value args[3];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  wait_frame_idle();
+
+  if (argc < 3) {
+    napi_throw_error(env, NULL, "Expected 3 arguments: data, width, height");
+    return NULL;
+  }
+
+  uint8_t* src_data;
+  size_t tex_len;
+  int32_t width, height;
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[0], NULL, &tex_len, (void**)&src_data, NULL, NULL));
+  NAPI_CALL(env, napi_get_value_int32(env, args[1], &width));
+  NAPI_CALL(env, napi_get_value_int32(env, args[2], &height));
+
+  if (width <= 0 || height <= 0 || width > 4096 || height > 4096) {
+    napi_throw_error(env, NULL, "Invalid texture dimensions (must be 1-4096)");
+    return NULL;
+  }
+
+  if (tex_len < (size_t)width * height * 3) {
+    napi_throw_error(env, NULL, "Texture data smaller than width * height * 3");
+    return NULL;
+  }
+
+  int32_t id = alloc_texture_slot();
+  if (id == 0) {
+    napi_throw_error(env, NULL, "Failed to allocate texture slot");
+    return NULL;
+  }
+
+  // Padded power-of-two levels come to at most 4/3 of level 0's size
+  int lw = ceil_log2(width), lh = ceil_log2(height);
+  size_t bytes = 0;
+  for (int l = 0; l <= MAX(lw, lh); l++) {
+    bytes += tex_level_texels(MAX(lw - l, 0), MAX(lh - l, 0)) * sizeof(uint32_t);
+  }
+  make_texture_room(bytes);
+
+  TexImage* image = (TexImage*)malloc(sizeof(TexImage));
+  if (!image || !build_tex_image(image, src_data, width, height)) {
+    free(image);
+    napi_throw_error(env, NULL, "Failed to allocate texture");
+    return NULL;
+  }
+
+  NativeTexture* tex = &g_textures[id - 1];
+  tex->image = image;
+  tex->width = width;
+  tex->height = height;
+  tex->bytes = image->bytes;
+  tex->last_used = ++g_texture_clock;
+  tex->in_use = true;
+
+  g_texture_resident_bytes += bytes;
+  g_texture_resident_count++;
+  g_debug_texture_uploads++;
+
+  napi_value result;
+  NAPI_CALL(env, napi_create_int32(env, id, &result));
+  return result;
+}
+
+// Bind a resident texture for subsequent draws (0 = untextured). Returns false if not resident.
+static bool bind_texture_id(int32_t id) {
+  if (id == 0) {
+    unbind_texture();
+    return true;
+  }
+  if (id == g_bound_texture_id && g_current_texture) return true;
+
+  NativeTexture* tex = get_native_texture(id);
+  if (!tex || !tex->image) {
+    unbind_texture();
+    return false;
+  }
+
+  tex->last_used = ++g_texture_clock;
+  g_debug_texture_binds++;
+  g_current_texture = tex->image;
+  g_texture_width = tex->width;
+  g_texture_height = tex->height;
+  g_bound_texture_id = id;
+  return true;
+}
+
+// Bind a resident texture as the lightmap atlas (0 = none). Returns false if not resident.
+static bool bind_lightmap_id(int32_t id) {
+  if (id == 0) {
+    unbind_lightmap();
+    return true;
+  }
+  NativeTexture* tex = get_native_texture(id);
+  if (!tex || !tex->image) {
+    unbind_lightmap();
+    return false;
+  }
+  tex->last_used = ++g_texture_clock;
+  g_current_lightmap = tex->image;
+  g_bound_lightmap_id = id;
+  return true;
+}
+
+/**
+ * Bind a resident texture for subsequent draws.
+ * Args: id (0 = no texture)
+ * Returns: false if the id was evicted or is invalid (caller should re-upload)
+ */
+static napi_value render_bind_texture(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  int32_t id = 0;
+  if (argc >= 1) {
+    NAPI_CALL(env, napi_get_value_int32(env, args[0], &id));
+  }
+
+  napi_value result;
+  if (g_recording) {
+    // Residency is reported now; the bind itself is replayed with the frame
+    FrameCmd* cmd = record_cmd(FCMD_BIND_TEXTURE);
+    if (!cmd) return recorded_result(env, cmd);
+    cmd->args[0] = id;
+    NativeTexture* tex = id ? get_native_texture(id) : NULL;
+    NAPI_CALL(env, napi_get_boolean(env, id == 0 || (tex && tex->image), &result));
+    return result;
+  }
+
+  wait_frame_idle();
+  NAPI_CALL(env, napi_get_boolean(env, bind_texture_id(id), &result));
+  return result;
+}
+
+/**
+ * Bind a resident texture as the lightmap atlas for subsequent draws.
+ * Meshes created with lightmap UVs are modulated per pixel by it instead of
+ * per-face lighting; other meshes ignore it.
+ * Args: id (0 = no lightmap)
+ * Returns: false if the id was evicted or is invalid (caller should re-upload)
+ */
+static napi_value render_bind_lightmap(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  int32_t id = 0;
+  if (argc >= 1) {
+    NAPI_CALL(env, napi_get_value_int32(env, args[0], &id));
+  }
+
+  napi_value result;
+  if (g_recording) {
+    FrameCmd* cmd = record_cmd(FCMD_BIND_LIGHTMAP);
+    if (!cmd) return recorded_result(env, cmd);
+    cmd->args[0] = id;
+    NativeTexture* tex = id ? get_native_texture(id) : NULL;
+    NAPI_CALL(env, napi_get_boolean(env, id == 0 || (tex && tex->image), &result));
+    return result;
+  }
+
+  wait_frame_idle();
+  NAPI_CALL(env, napi_get_boolean(env, bind_lightmap_id(id), &result));
+  return result;
+}
+
+/**
+ * Free a texture and release its id.
+ * Args: id
+ */
+static napi_value render_destroy_texture(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  int32_t id = 0;
+  if (argc >= 1) {
+    NAPI_CALL(env, napi_get_value_int32(env, args[0], &id));
+  }
+
+  // The frame being recorded may bind it; destroy once that frame has rendered
+  if (g_recording && get_native_texture(id)) {
+    FrameList* f = g_recording;
+    if (!defer_handle(&f->deferred_textures, &f->deferred_texture_count, &f->deferred_texture_cap, id)) {
+      napi_throw_error(env, NULL, "Failed to defer texture destroy");
+      return NULL;
+    }
+  } else {
+    wait_frame_idle();
+    destroy_texture_now(id);
+  }
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+static void destroy_texture_now(int32_t id) {
+  NativeTexture* tex = get_native_texture(id);
+  if (tex) {
+    evict_texture(id);
+    memset(tex, 0, sizeof(NativeTexture));
+  }
+}
+
+/**
+ * Set the resident texture memory budget in bytes (evicts immediately if over).
+ */
+static napi_value render_set_texture_budget(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  wait_frame_idle();
+
+  double budget = DEFAULT_TEXTURE_BUDGET;
+  if (argc >= 1) {
+    NAPI_CALL(env, napi_get_value_double(env, args[0], &budget));
+  }
+  g_texture_budget = budget > 0 ? (size_t)budget : DEFAULT_TEXTURE_BUDGET;
+  make_texture_room(0);
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+// Near plane threshold (matches JS Rasterizer.nearPlane = 0.05)
+#define NEAR_PLANE 0.05f
+
+// Clip vertex structure for near plane clipping
+typedef struct {
+  float cx, cy, cz, cw;  // Clip space position
+  float u, v;             // UV coordinates
+  float lu, lv;           // Lightmap UV coordinates
+  uint8_t r, g, b;        // Color
+} ClipVert;
+
+// ========================================
+// Tiled Deferred Rasterization
+// ========================================
+
+// Screen tile size for binning (pixels)
+#define TILE_SIZE 32
+
+// Triangles per setup work chunk (each chunk may emit up to 2x after near clipping)
+#define SETUP_CHUNK 256
+
+// Hierarchical-Z block size (pixels, must divide TILE_SIZE)
+#define HIZ_BLOCK 8
+#define HIZ_BLOCKS_PER_TILE (TILE_SIZE / HIZ_BLOCK)
+
+// Refresh a tile's dirty hi-Z blocks after this many triangles
+#define HIZ_REFRESH_TRIS 16
+
+// Flush pending tiles once this many triangles are queued, so hi-Z stays
+// fresh enough to reject later draws in the same frame
+#define HIZ_FLUSH_TRIS 8192
+
+/**
+ * Screen-space triangle ready for rasterization.
+ * Winding is normalized so the rasterizer's edge functions are positive inside.
+ */
+typedef struct {
+  float x[3], y[3], z[3], w[3];   // Screen x/y, NDC z, clip w
+  float u[3], v[3];
+  const TexImage* texture;        // NULL = use base color
+  float lod_base;                 // Mip LOD at clip w = 1 (LOD grows as 1.5 * log2(w))
+  const TexImage* lightmap;       // NULL = flat per-face light only
+  float lm[6];                    // Lightmap UV = (lm0 u + lm1 v + lm2, lm3 u + lm4 v + lm5)
+  uint8_t base_r, base_g, base_b;
+  float light;
+  int min_x, min_y, max_x, max_y; // Screen bounds (inclusive, includes MSAA sample offsets)
+} RasterTri;
+
+// Inclusive pixel rectangle a tile worker may write to
+typedef struct {
+  int x0, y0, x1, y1;
+} TileRect;
+
+// Per-tile list of triangle indices in submission order
+typedef struct {
+  uint32_t* tris;
+  int count;
+  int capacity;
+} TileBin;
+
+// Triangle setup counters (accumulated per chunk, then merged into g_debug_*)
+typedef struct {
+  int total;
+  int with_uv;
+  int textured;
+  int lightmapped;
+  int near_clipped;
+  int clipped;          // Straddled the near plane and went through the clipper
+  int frustum_culled;
+  int backface_culled;
+  int degenerate;
+} SetupCounters;
+
+// Pending triangles for this frame (rasterized on flush)
+static RasterTri* g_raster_tris = NULL;
+static int g_raster_count = 0;
+static int g_raster_capacity = 0;
+
+// Tile grid (allocated for the output size, the scene uses the top-left tiles_x * tiles_y)
+static TileBin* g_tile_bins = NULL;
+static int g_tile_bin_capacity = 0;
+static int g_tiles_x = 0;
+static int g_tiles_y = 0;
+
+/*
+ * Hierarchical-Z: max depth per HIZ_BLOCK x HIZ_BLOCK block (over all MSAA
+ * samples). Values are only ever refreshed after rasterization, so a stale
+ * block is always >= the true max and rejection stays conservative. Blocks
+ * are owned by the tile that contains them, like the depth buffer.
+ */
+static float* g_hiz = NULL;
+static int g_hiz_capacity = 0;
+static int g_hiz_w = 0;
+static int g_hiz_h = 0;
+
+static void free_hiz(void) {
+  free(g_hiz);
+  g_hiz = NULL;
+  g_hiz_capacity = 0;
+  g_hiz_w = 0;
+  g_hiz_h = 0;
+}
+
+static void reset_hiz(void) {
+  for (int i = 0; i < g_hiz_w * g_hiz_h; i++) {
+    g_hiz[i] = 1.0f;
+  }
+}
+
+// Size hi-Z for the output size (set_active_size() picks the blocks in use)
+static bool init_hiz(void) {
+  int blocks = ((g_out_width + HIZ_BLOCK - 1) / HIZ_BLOCK) * ((g_out_height + HIZ_BLOCK - 1) / HIZ_BLOCK);
+  if (blocks <= g_hiz_capacity) return true;
+  free_hiz();
+  g_hiz = (float*)malloc(sizeof(float) * blocks);
+  if (!g_hiz) return false;
+  g_hiz_capacity = blocks;
+  return true;
+}
+
+// Recompute one block's max depth from the depth buffer(s)
+static void refresh_hiz_block(int bx, int by) {
+  int x0 = bx * HIZ_BLOCK, x1 = MIN(x0 + HIZ_BLOCK, g_width);
+  int y0 = by * HIZ_BLOCK, y1 = MIN(y0 + HIZ_BLOCK, g_height);
+  int samples = g_msaa_samples > 1 ? g_msaa_samples : 1;
+  const float* base = g_msaa_samples > 1 ? g_msaa_depth : g_depth_buffer;
+  float max_depth = 0.0f;
+
+  // MSAA depth is interleaved, so a block row is one contiguous run of samples
+  for (int y = y0; y < y1; y++) {
+    const float* row = base + ((size_t)y * g_width + x0) * samples;
+    size_t count = (size_t)(x1 - x0) * samples;
+    for (size_t i = 0; i < count; i++) {
+      max_depth = MAX(max_depth, row[i]);
+    }
+  }
+  g_hiz[by * g_hiz_w + bx] = max_depth;
+}
+
+// True if every hi-Z block overlapping the pixel rect is nearer than min_z
+static bool hiz_rect_occluded(int x0, int y0, int x1, int y1, float min_z) {
+  if (!g_hiz) return false;
+  x0 = MAX(x0, 0); y0 = MAX(y0, 0);
+  x1 = MIN(x1, g_width - 1); y1 = MIN(y1, g_height - 1);
+  if (x0 > x1 || y0 > y1) return false;
+
+  for (int by = y0 / HIZ_BLOCK; by <= y1 / HIZ_BLOCK; by++) {
+    const float* row = g_hiz + by * g_hiz_w;
+    for (int bx = x0 / HIZ_BLOCK; bx <= x1 / HIZ_BLOCK; bx++) {
+      if (min_z < row[bx]) return false;
+    }
+  }
+  return true;
+}
+
+static void free_tile_bins(void) {
+  if (g_tile_bins) {
+    for (int i = 0; i < g_tile_bin_capacity; i++) {
+      free(g_tile_bins[i].tris);
+    }
+  }
+  free(g_tile_bins);
+  g_tile_bins = NULL;
+  g_tile_bin_capacity = 0;
+  g_tiles_x = 0;
+  g_tiles_y = 0;
+  g_raster_count = 0;
+}
+
+// Grow the tile grid to cover the output size (bins keep their triangle arrays)
+static bool init_tile_bins(void) {
+  int tiles = ((g_out_width + TILE_SIZE - 1) / TILE_SIZE) * ((g_out_height + TILE_SIZE - 1) / TILE_SIZE);
+  if (tiles <= g_tile_bin_capacity) return true;
+  free_tile_bins();
+  g_tile_bins = (TileBin*)calloc((size_t)tiles, sizeof(TileBin));
+  if (!g_tile_bins) return false;
+  g_tile_bin_capacity = tiles;
+  return true;
+}
+
+/**
+ * Switch the size being drawn at (scene or output). Buffers are indexed
+ * with the active width as stride, so this only recomputes the tile and
+ * hi-Z grids over the arrays allocated for the output size.
+ */
+static void set_active_size(int width, int height) {
+  if (width == g_width && height == g_height) return;
+  g_width = width;
+  g_height = height;
+  g_tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+  g_tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+  g_hiz_w = (width + HIZ_BLOCK - 1) / HIZ_BLOCK;
+  g_hiz_h = (height + HIZ_BLOCK - 1) / HIZ_BLOCK;
+  reset_hiz();
+}
+
+/**
+ * Upscale the scene (nearest, pixel centers) from the top-left
+ * g_width x g_height of the color and depth buffers to the output size, in
+ * place. Walking the output backwards is safe because a source pixel never
+ * lies after its destination when scaling up.
+ */
+static void upscale_scene(void) {
+  static int src_x[4096];
+  int sw = g_width, sh = g_height;
+  int ow = g_out_width, oh = g_out_height;
+
+  for (int x = 0; x < ow; x++) {
+    src_x[x] = (int)(((int64_t)(2 * x + 1) * sw) / (2 * ow));
+  }
+
+  for (int y = oh - 1; y >= 0; y--) {
+    size_t src_row = (size_t)(((int64_t)(2 * y + 1) * sh) / (2 * oh)) * sw;
+    size_t dst_row = (size_t)y * ow;
+    for (int x = ow - 1; x >= 0; x--) {
+      size_t src = src_row + src_x[x];
+      size_t dst = dst_row + x;
+      g_framebuffer[dst * 3] = g_framebuffer[src * 3];
+      g_framebuffer[dst * 3 + 1] = g_framebuffer[src * 3 + 1];
+      g_framebuffer[dst * 3 + 2] = g_framebuffer[src * 3 + 2];
+      g_depth_buffer[dst] = g_depth_buffer[src];
+    }
+  }
+}
+
+// Finish the scene before anything reads or composes over it at the output size
+static void present_scene(void) {
+  flush_tiles();
+  if (!g_scene_pending) return;
+  g_scene_pending = false;
+
+  uint64_t prof = prof_begin();
+  upscale_scene();
+  set_active_size(g_out_width, g_out_height);
+  prof_end(PROF_UPSCALE, prof);
+}
+
+static bool ensure_raster_capacity(int extra) {
+  if (g_raster_count + extra <= g_raster_capacity) return true;
+
+  int new_capacity = g_raster_capacity > 0 ? g_raster_capacity : 4096;
+  while (new_capacity < g_raster_count + extra) new_capacity *= 2;
+
+  RasterTri* grown = (RasterTri*)realloc(g_raster_tris, sizeof(RasterTri) * new_capacity);
+  if (!grown) return false;
+  g_raster_tris = grown;
+  g_raster_capacity = new_capacity;
+  return true;
+}
+
+// Append triangles [first, last) to every tile their bounds touch
+static void bin_triangles(int first, int last) {
+  for (int i = first; i < last; i++) {
+    const RasterTri* tri = &g_raster_tris[i];
+    if (tri->min_x > tri->max_x || tri->min_y > tri->max_y) continue;
+
+    // Whole triangle behind already-rasterized depth
+    float min_z = MIN(MIN(tri->z[0], tri->z[1]), tri->z[2]);
+    if (hiz_rect_occluded(tri->min_x, tri->min_y, tri->max_x, tri->max_y, min_z)) {
+      g_debug_hiz_culled++;
+      continue;
+    }
+
+    int tx0 = tri->min_x / TILE_SIZE, tx1 = tri->max_x / TILE_SIZE;
+    int ty0 = tri->min_y / TILE_SIZE, ty1 = tri->max_y / TILE_SIZE;
+
+    for (int ty = ty0; ty <= ty1; ty++) {
+      for (int tx = tx0; tx <= tx1; tx++) {
+        TileBin* bin = &g_tile_bins[ty * g_tiles_x + tx];
+        if (bin->count == bin->capacity) {
+          int new_capacity = bin->capacity > 0 ? bin->capacity * 2 : 256;
+          uint32_t* grown = (uint32_t*)realloc(bin->tris, sizeof(uint32_t) * new_capacity);
+          if (!grown) continue;
+          bin->tris = grown;
+          bin->capacity = new_capacity;
+        }
+        bin->tris[bin->count++] = (uint32_t)i;
+      }
+    }
+  }
+}
+
+// Drop pending triangles without drawing them
+static void discard_pending_tiles(void) {
+  if (g_raster_count == 0) return;
+  for (int i = 0; i < g_tiles_x * g_tiles_y; i++) {
+    g_tile_bins[i].count = 0;
+  }
+  g_raster_count = 0;
+}
+
+/**
+ * Rasterize all binned triangles. Each tile is owned by exactly one worker,
+ * so color/depth writes never race and per-tile submission order is kept.
+ */
+static void flush_tiles(void) {
+  if (g_raster_count == 0 || !g_tile_bins) return;
+
+  uint64_t prof = prof_begin();
+  dispatch_parallel_work(WORK_RASTER_TILES, 0, g_tiles_x * g_tiles_y, 1, 2, 0, 0, 0);
+  prof_end(PROF_RASTER, prof);
+
+  for (int i = 0; i < g_tiles_x * g_tiles_y; i++) {
+    g_tile_bins[i].count = 0;
+  }
+  g_raster_count = 0;
+}
+
+
+/**
+ * Transform vertex by MVP matrix.
+ */
+static inline void transform_vertex(
+    float x, float y, float z,
+    const float* __restrict mvp,
+    float* __restrict out_x, float* __restrict out_y,
+    float* __restrict out_z, float* __restrict out_w
+) {
+  *out_x = mvp[0] * x + mvp[4] * y + mvp[8]  * z + mvp[12];
+  *out_y = mvp[1] * x + mvp[5] * y + mvp[9]  * z + mvp[13];
+  *out_z = mvp[2] * x + mvp[6] * y + mvp[10] * z + mvp[14];
+  *out_w = mvp[3] * x + mvp[7] * y + mvp[11] * z + mvp[15];
+}
+
+/**
+ * Lerp between two clip vertices at parameter t.
+ */
+static inline ClipVert lerp_clip_vert(const ClipVert* a, const ClipVert* b, float t) {
+  ClipVert result;
+  result.cx = a->cx + (b->cx - a->cx) * t;
+  result.cy = a->cy + (b->cy - a->cy) * t;
+  result.cz = a->cz + (b->cz - a->cz) * t;
+  result.cw = a->cw + (b->cw - a->cw) * t;
+  result.u = a->u + (b->u - a->u) * t;
+  result.v = a->v + (b->v - a->v) * t;
+  result.lu = a->lu + (b->lu - a->lu) * t;
+  result.lv = a->lv + (b->lv - a->lv) * t;
+  result.r = (uint8_t)(a->r + (b->r - a->r) * t);
+  result.g = (uint8_t)(a->g + (b->g - a->g) * t);
+  result.b = (uint8_t)(a->b + (b->b - a->b) * t);
+  return result;
+}
+
+/**
+ * Clip triangle against near plane (w >= NEAR_PLANE).
+ * Returns number of output triangles (0, 1, or 2).
+ * out_tris should have space for 6 vertices (2 triangles).
+ */
+static int clip_triangle_near_plane(
+    const ClipVert* v0, const ClipVert* v1, const ClipVert* v2,
+    ClipVert* out_tris
+) {
+  // Classify vertices
+  int inside0 = (v0->cw >= NEAR_PLANE) ? 1 : 0;
+  int inside1 = (v1->cw >= NEAR_PLANE) ? 1 : 0;
+  int inside2 = (v2->cw >= NEAR_PLANE) ? 1 : 0;
+  int inside_count = inside0 + inside1 + inside2;
+
+  // All inside - no clipping needed
+  if (inside_count == 3) {
+    out_tris[0] = *v0;
+    out_tris[1] = *v1;
+    out_tris[2] = *v2;
+    return 1;
+  }
+
+  // All outside - cull entire triangle
   if (inside_count == 0) {
     return 0;
   }
 
-  // Partially clipped
-  if (inside_count == 1) {
-    // One vertex inside, two outside - creates one smaller triangle
-    const ClipVert *vi, *vo1, *vo2;
-    if (inside0) { vi = v0; vo1 = v1; vo2 = v2; }
-    else if (inside1) { vi = v1; vo1 = v2; vo2 = v0; }
-    else { vi = v2; vo1 = v0; vo2 = v1; }
+  // Partially clipped
+  if (inside_count == 1) {
+    // One vertex inside, two outside - creates one smaller triangle
+    const ClipVert *vi, *vo1, *vo2;
+    if (inside0) { vi = v0; vo1 = v1; vo2 = v2; }
+    else if (inside1) { vi = v1; vo1 = v2; vo2 = v0; }
+    else { vi = v2; vo1 = v0; vo2 = v1; }
+
+    // Find intersection points
+    float t1 = (NEAR_PLANE - vi->cw) / (vo1->cw - vi->cw);
+    float t2 = (NEAR_PLANE - vi->cw) / (vo2->cw - vi->cw);
+
+    ClipVert new_v1 = lerp_clip_vert(vi, vo1, t1);
+    ClipVert new_v2 = lerp_clip_vert(vi, vo2, t2);
+
+    out_tris[0] = *vi;
+    out_tris[1] = new_v1;
+    out_tris[2] = new_v2;
+    return 1;
+  }
+
+  // Two vertices inside, one outside - creates two triangles (quad)
+  const ClipVert *vi0, *vi1, *vo;
+  if (!inside0) { vo = v0; vi0 = v1; vi1 = v2; }
+  else if (!inside1) { vo = v1; vi0 = v2; vi1 = v0; }
+  else { vo = v2; vi0 = v0; vi1 = v1; }
+
+  // Find intersection points on edges from inside vertices to outside vertex
+  float t0 = (NEAR_PLANE - vi0->cw) / (vo->cw - vi0->cw);
+  float t1 = (NEAR_PLANE - vi1->cw) / (vo->cw - vi1->cw);
+
+  ClipVert new_v0 = lerp_clip_vert(vi0, vo, t0);
+  ClipVert new_v1 = lerp_clip_vert(vi1, vo, t1);
+
+  // First triangle: vi0, vi1, new_v1
+  out_tris[0] = *vi0;
+  out_tris[1] = *vi1;
+  out_tris[2] = new_v1;
+
+  // Second triangle: vi0, new_v1, new_v0
+  out_tris[3] = *vi0;
+  out_tris[4] = new_v1;
+  out_tris[5] = new_v0;
+
+  return 2;
+}
+
+// ========================================
+// Vertex Stage
+// ========================================
+
+/*
+ * Before triangle setup, every vertex of a draw is transformed once into the
+ * vertex cache: SoA clip and screen positions plus an outcode per vertex,
+ * grown as needed and reused by every draw of every frame. Setup then reads
+ * three outcodes per triangle to reject it or accept it without clipping;
+ * only triangles straddling the near plane go through the clipper. Shared
+ * vertices are no longer transformed once per triangle that uses them.
+ */
+
+// Outcode bits: which clip planes a vertex is outside of
+#define OUT_LEFT 1        // x < -w
+#define OUT_RIGHT 2       // x > w
+#define OUT_BOTTOM 4      // y < -w
+#define OUT_TOP 8         // y > w
+#define OUT_NEAR 16       // w < NEAR_PLANE
+#define OUT_FRUSTUM (OUT_LEFT | OUT_RIGHT | OUT_BOTTOM | OUT_TOP)
+
+// Vertices per vertex stage work chunk
+#define VERTEX_CHUNK 2048
+
+typedef struct {
+  float* cx;         // Clip space position
+  float* cy;
+  float* cz;
+  float* cw;
+  float* sx;         // Screen position and NDC z (only valid without OUT_NEAR)
+  float* sy;
+  float* sz;
+  uint8_t* outcode;
+  int capacity;      // Vertices (multiple of 8, arrays 32-byte aligned)
+} VertexCache;
+
+static VertexCache g_vertex_cache = {0};
+
+// Make room for count vertices (contents are not kept)
+static bool ensure_vertex_cache(int count) {
+  if (count <= g_vertex_cache.capacity) return true;
+
+  int capacity = ALIGN_UP(MAX(count, 1024), 8);
+  size_t floats = (size_t)capacity * 7;
+  float* block = (float*)aligned_alloc(32, ALIGN_UP(floats * sizeof(float) + (size_t)capacity, 32));
+  if (!block) return false;
+
+  free(g_vertex_cache.cx);
+  g_vertex_cache.cx = block;
+  g_vertex_cache.cy = block + capacity;
+  g_vertex_cache.cz = block + (size_t)capacity * 2;
+  g_vertex_cache.cw = block + (size_t)capacity * 3;
+  g_vertex_cache.sx = block + (size_t)capacity * 4;
+  g_vertex_cache.sy = block + (size_t)capacity * 5;
+  g_vertex_cache.sz = block + (size_t)capacity * 6;
+  g_vertex_cache.outcode = (uint8_t*)(block + floats);
+  g_vertex_cache.capacity = capacity;
+  return true;
+}
+
+static void free_vertex_cache(void) {
+  free(g_vertex_cache.cx);
+  memset(&g_vertex_cache, 0, sizeof(g_vertex_cache));
+}
+
+/*
+ * Transform vertices [start, end) into the vertex cache. Written as plain
+ * loops over SoA arrays so the compiler vectorizes them 4 wide (SSE2/NEON)
+ * or 8 wide (the AVX2 build below); stride is 1 for resident meshes and 3
+ * for interleaved immediate arrays, constant in each inlined copy.
+ */
+FORCE_INLINE void transform_vertices_strided(
+    const float* __restrict px, const float* __restrict py, const float* __restrict pz,
+    const int stride, const float* __restrict mvp, int start, int end
+) {
+  float* __restrict cx = g_vertex_cache.cx;
+  float* __restrict cy = g_vertex_cache.cy;
+  float* __restrict cz = g_vertex_cache.cz;
+  float* __restrict cw = g_vertex_cache.cw;
+  float* __restrict sx = g_vertex_cache.sx;
+  float* __restrict sy = g_vertex_cache.sy;
+  float* __restrict sz = g_vertex_cache.sz;
+  uint8_t* __restrict outcode = g_vertex_cache.outcode;
+
+  const float m0 = mvp[0], m1 = mvp[1], m2 = mvp[2], m3 = mvp[3];
+  const float m4 = mvp[4], m5 = mvp[5], m6 = mvp[6], m7 = mvp[7];
+  const float m8 = mvp[8], m9 = mvp[9], m10 = mvp[10], m11 = mvp[11];
+  const float m12 = mvp[12], m13 = mvp[13], m14 = mvp[14], m15 = mvp[15];
+  const float halfW = g_width * 0.5f;
+  const float halfH = g_height * 0.5f;
+
+  for (int i = start; i < end; i++) {
+    float x = px[(size_t)i * stride], y = py[(size_t)i * stride], z = pz[(size_t)i * stride];
+    float ox = m0 * x + m4 * y + m8  * z + m12;
+    float oy = m1 * x + m5 * y + m9  * z + m13;
+    float oz = m2 * x + m6 * y + m10 * z + m14;
+    float ow = m3 * x + m7 * y + m11 * z + m15;
+    cx[i] = ox;
+    cy[i] = oy;
+    cz[i] = oz;
+    cw[i] = ow;
+
+    // Same divide as clipped vertices get in setup (garbage behind the near plane, never read)
+    sx[i] = (ox / ow + 1) * halfW;
+    sy[i] = (1 - oy / ow) * halfH;
+    sz[i] = oz / ow;
+
+    outcode[i] = (uint8_t)((ox < -ow ? OUT_LEFT : 0) | (ox > ow ? OUT_RIGHT : 0) |
+                           (oy < -ow ? OUT_BOTTOM : 0) | (oy > ow ? OUT_TOP : 0) |
+                           (ow < NEAR_PLANE ? OUT_NEAR : 0));
+  }
+}
+
+FORCE_INLINE void transform_vertices_any(const float* px, const float* py, const float* pz, int stride,
+                                         const float* mvp, int start, int end) {
+  if (stride == 1) {
+    transform_vertices_strided(px, py, pz, 1, mvp, start, end);
+  } else {
+    transform_vertices_strided(px, py, pz, 3, mvp, start, end);
+  }
+}
+
+static void vertex_kernel_default(const float* px, const float* py, const float* pz, int stride,
+                                  const float* mvp, int start, int end) {
+  transform_vertices_any(px, py, pz, stride, mvp, start, end);
+}
+
+#if defined(USE_X86_DISPATCH)
+__attribute__((target("avx2")))
+static void vertex_kernel_avx2(const float* px, const float* py, const float* pz, int stride,
+                               const float* mvp, int start, int end) {
+  transform_vertices_any(px, py, pz, stride, mvp, start, end);
+}
+#endif
+
+// Selected with the raster kernel (select_raster_kernel)
+typedef void (*VertexKernelFn)(const float*, const float*, const float*, int, const float*, int, int);
+static VertexKernelFn g_vertex_kernel = vertex_kernel_default;
+
+// Vertex stage job (one at a time, like the setup job)
+static struct {
+  const float* px;
+  const float* py;
+  const float* pz;
+  int stride;
+  const float* mvp;
+  int start;
+  int end;
+} g_vertex_job;
+
+// Vertex stage work function (called by workers)
+static void do_transform_vertices(int start_chunk, int end_chunk) {
+  int start = g_vertex_job.start + start_chunk * VERTEX_CHUNK;
+  int end = MIN(g_vertex_job.start + end_chunk * VERTEX_CHUNK, g_vertex_job.end);
+  g_vertex_kernel(g_vertex_job.px, g_vertex_job.py, g_vertex_job.pz, g_vertex_job.stride,
+                  g_vertex_job.mvp, start, end);
+}
+
+/**
+ * Transform vertices [start, end) into the same slots of the vertex cache
+ * (in parallel chunks when large). Returns false if the cache could not grow.
+ */
+static bool run_vertex_stage(const float* px, const float* py, const float* pz, int stride,
+                             const float* mvp, int start, int end) {
+  if (!ensure_vertex_cache(end)) return false;
+
+  uint64_t prof = prof_begin();
+  int num_chunks = (end - start + VERTEX_CHUNK - 1) / VERTEX_CHUNK;
+  if (jobs_worker_count() > 0 && num_chunks >= 2) {
+    g_vertex_job.px = px;
+    g_vertex_job.py = py;
+    g_vertex_job.pz = pz;
+    g_vertex_job.stride = stride;
+    g_vertex_job.mvp = mvp;
+    g_vertex_job.start = start;
+    g_vertex_job.end = end;
+    dispatch_parallel_work(WORK_TRANSFORM_VERTICES, 0, num_chunks, 1, 2, 0, 0, 0);
+  } else {
+    g_vertex_kernel(px, py, pz, stride, mvp, start, end);
+  }
+  prof_end(PROF_VERTEX, prof);
+  return true;
+}
+
+// ========================================
+// Rasterization Kernels
+// ========================================
+
+/**
+ * Per-triangle raster setup shared by all kernels.
+ * Coordinates already include the MSAA sample offset.
+ */
+typedef struct {
+  int minX, maxX, minY, maxY;     // Pixel bounds clipped to the tile
+  float x0, y0, x1, y1, x2, y2;
+  float z0, z1, z2;
+  float dx01, dy01, dx12, dy12, dx20, dy20;
+  float invArea;
+  float inv_w0, inv_w1, inv_w2;
+  float u0_w, v0_w, u1_w, v1_w, u2_w, v2_w;
+} RasterSetup;
+
+// Returns false if the triangle covers nothing inside the tile
+FORCE_INLINE bool prepare_raster(const RasterTri* tri, float ox, float oy,
+                                  const TileRect* rect, RasterSetup* rs) {
+  rs->x0 = tri->x[0] + ox; rs->y0 = tri->y[0] + oy; rs->z0 = tri->z[0];
+  rs->x1 = tri->x[1] + ox; rs->y1 = tri->y[1] + oy; rs->z1 = tri->z[1];
+  rs->x2 = tri->x[2] + ox; rs->y2 = tri->y[2] + oy; rs->z2 = tri->z[2];
+
+  // Bounding box, clipped to tile
+  rs->minX = MAX((int)floorf(MIN(MIN(rs->x0, rs->x1), rs->x2)), rect->x0);
+  rs->maxX = MIN((int)ceilf(MAX(MAX(rs->x0, rs->x1), rs->x2)), rect->x1);
+  rs->minY = MAX((int)floorf(MIN(MIN(rs->y0, rs->y1), rs->y2)), rect->y0);
+  rs->maxY = MIN((int)ceilf(MAX(MAX(rs->y0, rs->y1), rs->y2)), rect->y1);
+  if (rs->minX > rs->maxX || rs->minY > rs->maxY) return false;
+
+  // Edge equations
+  rs->dx01 = rs->x1 - rs->x0; rs->dy01 = rs->y1 - rs->y0;
+  rs->dx12 = rs->x2 - rs->x1; rs->dy12 = rs->y2 - rs->y1;
+  rs->dx20 = rs->x0 - rs->x2; rs->dy20 = rs->y0 - rs->y2;
+
+  // Triangle area (2x)
+  float area = rs->dx01 * (rs->y2 - rs->y0) - rs->dy01 * (rs->x2 - rs->x0);
+  if (fabsf(area) < 0.0001f) return false;  // Degenerate (counted at setup)
+  rs->invArea = 1.0f / area;
+
+  // Precompute 1/w and UV/w for perspective-correct interpolation
+  rs->inv_w0 = 1.0f / tri->w[0];
+  rs->inv_w1 = 1.0f / tri->w[1];
+  rs->inv_w2 = 1.0f / tri->w[2];
+  rs->u0_w = tri->u[0] * rs->inv_w0; rs->v0_w = tri->v[0] * rs->inv_w0;
+  rs->u1_w = tri->u[1] * rs->inv_w1; rs->v1_w = tri->v[1] * rs->inv_w1;
+  rs->u2_w = tri->u[2] * rs->inv_w2; rs->v2_w = tri->v[2] * rs->inv_w2;
+  return true;
+}
+
+// Write the lit color of one covered pixel (u, v, w only used when textured or lightmapped)
+FORCE_INLINE void shade_pixel(const RasterTri* tri, float u, float v, float w,
+                               uint8_t* __restrict color_buf, size_t idx) {
+  float light_factor = tri->light;
+  uint8_t src_r, src_g, src_b;
+
+  if (tri->texture) {
+    uint32_t texel = sample_texture(tri->texture, u, v, w, tri->lod_base);
+    src_r = (uint8_t)texel; src_g = (uint8_t)(texel >> 8); src_b = (uint8_t)(texel >> 16);
+  } else {
+    src_r = tri->base_r; src_g = tri->base_g; src_b = tri->base_b;
+  }
+
+  if (tri->lightmap) {
+    // Baked light per pixel (bilinear, the atlas pads each face's block)
+    float lu = tri->lm[0] * u + tri->lm[1] * v + tri->lm[2];
+    float lv = tri->lm[3] * u + tri->lm[4] * v + tri->lm[5];
+    uint32_t lm = tex_bilinear(tri->lightmap, 0, lu - floorf(lu), lv - floorf(lv));
+    float scale = light_factor * LIGHTMAP_SCALE;
+    color_buf[idx * 3] = (uint8_t)CLAMP(src_r * (float)(lm & 255) * scale, 0, 255);
+    color_buf[idx * 3 + 1] = (uint8_t)CLAMP(src_g * (float)((lm >> 8) & 255) * scale, 0, 255);
+    color_buf[idx * 3 + 2] = (uint8_t)CLAMP(src_b * (float)((lm >> 16) & 255) * scale, 0, 255);
+    return;
+  }
+
+  color_buf[idx * 3] = (uint8_t)CLAMP(src_r * light_factor, 0, 255);
+  color_buf[idx * 3 + 1] = (uint8_t)CLAMP(src_g * light_factor, 0, 255);
+  color_buf[idx * 3 + 2] = (uint8_t)CLAMP(src_b * light_factor, 0, 255);
+}
+
+/**
+ * Scalar reference kernel: three edge functions, depth test and divide per pixel.
+ * (ox, oy) is the MSAA sub-pixel sample offset.
+ */
+static void raster_kernel_scalar(
+    const RasterTri* __restrict tri,
+    float ox, float oy,
+    const TileRect* rect,
+    uint8_t* __restrict color_buf,
+    float* __restrict depth_buf,
+    int stride
+) {
+  RasterSetup rs;
+  if (!prepare_raster(tri, ox, oy, rect, &rs)) return;
+
+  for (int py = rs.minY; py <= rs.maxY; py++) {
+    float fy = py + 0.5f;
+    int row_start = py * stride;
+
+    for (int px = rs.minX; px <= rs.maxX; px++) {
+      float fx = px + 0.5f;
+
+      // Edge functions
+      float e0 = rs.dx12 * (fy - rs.y1) - rs.dy12 * (fx - rs.x1);
+      float e1 = rs.dx20 * (fy - rs.y2) - rs.dy20 * (fx - rs.x2);
+      float e2 = rs.dx01 * (fy - rs.y0) - rs.dy01 * (fx - rs.x0);
+
+      // Inside test
+      if (e0 >= -0.001f && e1 >= -0.001f && e2 >= -0.001f) {
+        // Barycentric coordinates
+        float bary0 = e0 * rs.invArea;
+        float bary1 = e1 * rs.invArea;
+        float bary2 = 1.0f - bary0 - bary1;
+
+        // Depth test
+        float depth = bary0 * rs.z0 + bary1 * rs.z1 + bary2 * rs.z2;
+        size_t idx = row_start + px;
+        if (depth < depth_buf[idx]) {
+          depth_buf[idx] = depth;
+
+          float u = 0, v = 0, w = 0;
+          if (tri->texture || tri->lightmap) {
+            // Perspective-correct UV interpolation
+            float interp_inv_w = bary0 * rs.inv_w0 + bary1 * rs.inv_w1 + bary2 * rs.inv_w2;
+            u = (bary0 * rs.u0_w + bary1 * rs.u1_w + bary2 * rs.u2_w) / interp_inv_w;
+            v = (bary0 * rs.v0_w + bary1 * rs.v1_w + bary2 * rs.v2_w) / interp_inv_w;
+            w = 1.0f / interp_inv_w;
+          }
+          shade_pixel(tri, u, v, w, color_buf, idx);
+        }
+      }
+    }
+  }
+}
+
+/*
+ * Vector kernels evaluate 4 (SSE4.1/NEON) or 8 (AVX2) horizontally adjacent
+ * pixels per step. Edge values are computed exactly at the start of each row
+ * and then stepped by -dy * LANES, depth is tested/written under the coverage
+ * mask, and 1/w uses a reciprocal estimate refined by one Newton-Raphson step.
+ * Groups that would cross the tile's right edge fall back to per-lane
+ * loads/stores so a worker never touches pixels outside its tile.
+ * Texel fetch stays per covered lane (textures are tiled mip chains, see TexImage).
+ */
+
+#if defined(USE_X86_DISPATCH)
+
+__attribute__((target("sse4.1")))
+static void raster_kernel_sse41(
+    const RasterTri* __restrict tri,
+    float ox, float oy,
+    const TileRect* rect,
+    uint8_t* __restrict color_buf,
+    float* __restrict depth_buf,
+    int stride
+) {
+  RasterSetup rs;
+  if (!prepare_raster(tri, ox, oy, rect, &rs)) return;
+
+  const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+  const __m128 eps = _mm_set1_ps(-0.001f);
+  const __m128 inv_area = _mm_set1_ps(rs.invArea);
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+  const __m128 step0 = _mm_set1_ps(-rs.dy12 * 4.0f);
+  const __m128 step1 = _mm_set1_ps(-rs.dy20 * 4.0f);
+  const __m128 step2 = _mm_set1_ps(-rs.dy01 * 4.0f);
+  const bool has_uv = tri->texture != NULL || tri->lightmap != NULL;
+
+  float us[4], vs[4], ws[4], ds[4];
+
+  for (int py = rs.minY; py <= rs.maxY; py++) {
+    float fy = py + 0.5f;
+    int row_start = py * stride;
+
+    // Exact edge values at the first group of the row
+    __m128 fx = _mm_add_ps(_mm_set1_ps(rs.minX + 0.5f), lane);
+    __m128 e0 = _mm_sub_ps(_mm_set1_ps(rs.dx12 * (fy - rs.y1)),
+                           _mm_mul_ps(_mm_set1_ps(rs.dy12), _mm_sub_ps(fx, _mm_set1_ps(rs.x1))));
+    __m128 e1 = _mm_sub_ps(_mm_set1_ps(rs.dx20 * (fy - rs.y2)),
+                           _mm_mul_ps(_mm_set1_ps(rs.dy20), _mm_sub_ps(fx, _mm_set1_ps(rs.x2))));
+    __m128 e2 = _mm_sub_ps(_mm_set1_ps(rs.dx01 * (fy - rs.y0)),
+                           _mm_mul_ps(_mm_set1_ps(rs.dy01), _mm_sub_ps(fx, _mm_set1_ps(rs.x0))));
+
+    for (int px = rs.minX; px <= rs.maxX; px += 4,
+         e0 = _mm_add_ps(e0, step0), e1 = _mm_add_ps(e1, step1), e2 = _mm_add_ps(e2, step2)) {
+      __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, eps), _mm_cmpge_ps(e1, eps)),
+                                 _mm_cmpge_ps(e2, eps));
+      int lanes = MIN(4, rs.maxX - px + 1);
+      int cover = _mm_movemask_ps(inside) & ((1 << lanes) - 1);
+      if (!cover) continue;
+
+      __m128 b0 = _mm_mul_ps(e0, inv_area);
+      __m128 b1 = _mm_mul_ps(e1, inv_area);
+      __m128 b2 = _mm_sub_ps(_mm_sub_ps(one, b0), b1);
+      __m128 depth = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(rs.z0)),
+                                           _mm_mul_ps(b1, _mm_set1_ps(rs.z1))),
+                                _mm_mul_ps(b2, _mm_set1_ps(rs.z2)));
+
+      // Masked depth test and write
+      float* dptr = depth_buf + row_start + px;
+      int pass;
+      if (lanes == 4) {
+        __m128 old = _mm_loadu_ps(dptr);
+        __m128 closer = _mm_and_ps(_mm_cmplt_ps(depth, old), inside);
+        pass = _mm_movemask_ps(closer);
+        if (!pass) continue;
+        _mm_storeu_ps(dptr, _mm_blendv_ps(old, depth, closer));
+      } else {
+        _mm_storeu_ps(ds, depth);
+        pass = 0;
+        for (int l = 0; l < lanes; l++) {
+          if ((cover >> l) & 1 && ds[l] < dptr[l]) {
+            dptr[l] = ds[l];
+            pass |= 1 << l;
+          }
+        }
+        if (!pass) continue;
+      }
+
+      if (has_uv) {
+        // Perspective-correct UVs with refined reciprocal of interpolated 1/w
+        __m128 iw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(rs.inv_w0)),
+                                          _mm_mul_ps(b1, _mm_set1_ps(rs.inv_w1))),
+                               _mm_mul_ps(b2, _mm_set1_ps(rs.inv_w2)));
+        __m128 r = _mm_rcp_ps(iw);
+        r = _mm_mul_ps(r, _mm_sub_ps(two, _mm_mul_ps(iw, r)));
+        __m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(rs.u0_w)),
+                                         _mm_mul_ps(b1, _mm_set1_ps(rs.u1_w))),
+                              _mm_mul_ps(b2, _mm_set1_ps(rs.u2_w)));
+        __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, _mm_set1_ps(rs.v0_w)),
+                                         _mm_mul_ps(b1, _mm_set1_ps(rs.v1_w))),
+                              _mm_mul_ps(b2, _mm_set1_ps(rs.v2_w)));
+        _mm_storeu_ps(us, _mm_mul_ps(u, r));
+        _mm_storeu_ps(vs, _mm_mul_ps(v, r));
+        _mm_storeu_ps(ws, r);
+      }
+
+      for (int l = 0; l < lanes; l++) {
+        if ((pass >> l) & 1) {
+          shade_pixel(tri, has_uv ? us[l] : 0, has_uv ? vs[l] : 0, has_uv ? ws[l] : 0, color_buf,
+                      (size_t)row_start + px + l);
+        }
+      }
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+static void raster_kernel_avx2(
+    const RasterTri* __restrict tri,
+    float ox, float oy,
+    const TileRect* rect,
+    uint8_t* __restrict color_buf,
+    float* __restrict depth_buf,
+    int stride
+) {
+  RasterSetup rs;
+  if (!prepare_raster(tri, ox, oy, rect, &rs)) return;
+
+  const __m256 lane = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+  const __m256 eps = _mm256_set1_ps(-0.001f);
+  const __m256 inv_area = _mm256_set1_ps(rs.invArea);
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 two = _mm256_set1_ps(2.0f);
+  const __m256 step0 = _mm256_set1_ps(-rs.dy12 * 8.0f);
+  const __m256 step1 = _mm256_set1_ps(-rs.dy20 * 8.0f);
+  const __m256 step2 = _mm256_set1_ps(-rs.dy01 * 8.0f);
+  const bool has_uv = tri->texture != NULL || tri->lightmap != NULL;
+
+  float us[8], vs[8], ws[8], ds[8];
+
+  for (int py = rs.minY; py <= rs.maxY; py++) {
+    float fy = py + 0.5f;
+    int row_start = py * stride;
+
+    // Exact edge values at the first group of the row
+    __m256 fx = _mm256_add_ps(_mm256_set1_ps(rs.minX + 0.5f), lane);
+    __m256 e0 = _mm256_sub_ps(_mm256_set1_ps(rs.dx12 * (fy - rs.y1)),
+                              _mm256_mul_ps(_mm256_set1_ps(rs.dy12), _mm256_sub_ps(fx, _mm256_set1_ps(rs.x1))));
+    __m256 e1 = _mm256_sub_ps(_mm256_set1_ps(rs.dx20 * (fy - rs.y2)),
+                              _mm256_mul_ps(_mm256_set1_ps(rs.dy20), _mm256_sub_ps(fx, _mm256_set1_ps(rs.x2))));
+    __m256 e2 = _mm256_sub_ps(_mm256_set1_ps(rs.dx01 * (fy - rs.y0)),
+                              _mm256_mul_ps(_mm256_set1_ps(rs.dy01), _mm256_sub_ps(fx, _mm256_set1_ps(rs.x0))));
+
+    for (int px = rs.minX; px <= rs.maxX; px += 8,
+         e0 = _mm256_add_ps(e0, step0), e1 = _mm256_add_ps(e1, step1), e2 = _mm256_add_ps(e2, step2)) {
+      __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, eps, _CMP_GE_OQ),
+                                                  _mm256_cmp_ps(e1, eps, _CMP_GE_OQ)),
+                                    _mm256_cmp_ps(e2, eps, _CMP_GE_OQ));
+      int lanes = MIN(8, rs.maxX - px + 1);
+      int cover = _mm256_movemask_ps(inside) & ((1 << lanes) - 1);
+      if (!cover) continue;
+
+      __m256 b0 = _mm256_mul_ps(e0, inv_area);
+      __m256 b1 = _mm256_mul_ps(e1, inv_area);
+      __m256 b2 = _mm256_sub_ps(_mm256_sub_ps(one, b0), b1);
+      __m256 depth = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b0, _mm256_set1_ps(rs.z0)),
+                                                 _mm256_mul_ps(b1, _mm256_set1_ps(rs.z1))),
+                                   _mm256_mul_ps(b2, _mm256_set1_ps(rs.z2)));
+
+      // Masked depth test and write
+      float* dptr = depth_buf + row_start + px;
+      int pass;
+      if (lanes == 8) {
+        __m256 old = _mm256_loadu_ps(dptr);
+        __m256 closer = _mm256_and_ps(_mm256_cmp_ps(depth, old, _CMP_LT_OQ), inside);
+        pass = _mm256_movemask_ps(closer);
+        if (!pass) continue;
+        _mm256_storeu_ps(dptr, _mm256_blendv_ps(old, depth, closer));
+      } else {
+        _mm256_storeu_ps(ds, depth);
+        pass = 0;
+        for (int l = 0; l < lanes; l++) {
+          if ((cover >> l) & 1 && ds[l] < dptr[l]) {
+            dptr[l] = ds[l];
+            pass |= 1 << l;
+          }
+        }
+        if (!pass) continue;
+      }
+
+      if (has_uv) {
+        // Perspective-correct UVs with refined reciprocal of interpolated 1/w
+        __m256 iw = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b0, _mm256_set1_ps(rs.inv_w0)),
+                                                _mm256_mul_ps(b1, _mm256_set1_ps(rs.inv_w1))),
+                                  _mm256_mul_ps(b2, _mm256_set1_ps(rs.inv_w2)));
+        __m256 r = _mm256_rcp_ps(iw);
+        r = _mm256_mul_ps(r, _mm256_sub_ps(two, _mm256_mul_ps(iw, r)));
+        __m256 u = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b0, _mm256_set1_ps(rs.u0_w)),
+                                               _mm256_mul_ps(b1, _mm256_set1_ps(rs.u1_w))),
+                                 _mm256_mul_ps(b2, _mm256_set1_ps(rs.u2_w)));
+        __m256 v = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(b0, _mm256_set1_ps(rs.v0_w)),
+                                               _mm256_mul_ps(b1, _mm256_set1_ps(rs.v1_w))),
+                                 _mm256_mul_ps(b2, _mm256_set1_ps(rs.v2_w)));
+        _mm256_storeu_ps(us, _mm256_mul_ps(u, r));
+        _mm256_storeu_ps(vs, _mm256_mul_ps(v, r));
+        _mm256_storeu_ps(ws, r);
+      }
+
+      for (int l = 0; l < lanes; l++) {
+        if ((pass >> l) & 1) {
+          shade_pixel(tri, has_uv ? us[l] : 0, has_uv ? vs[l] : 0, has_uv ? ws[l] : 0, color_buf,
+                      (size_t)row_start + px + l);
+        }
+      }
+    }
+  }
+}
+
+#endif  // USE_X86_DISPATCH
+
+#if defined(USE_NEON)
+
+static void raster_kernel_neon(
+    const RasterTri* __restrict tri,
+    float ox, float oy,
+    const TileRect* rect,
+    uint8_t* __restrict color_buf,
+    float* __restrict depth_buf,
+    int stride
+) {
+  RasterSetup rs;
+  if (!prepare_raster(tri, ox, oy, rect, &rs)) return;
+
+  static const float lane_init[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+  static const uint32_t lane_bits_init[4] = {1, 2, 4, 8};
+  const float32x4_t lane = vld1q_f32(lane_init);
+  const uint32x4_t lane_bits = vld1q_u32(lane_bits_init);
+  const float32x4_t eps = vdupq_n_f32(-0.001f);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const float32x4_t step0 = vdupq_n_f32(-rs.dy12 * 4.0f);
+  const float32x4_t step1 = vdupq_n_f32(-rs.dy20 * 4.0f);
+  const float32x4_t step2 = vdupq_n_f32(-rs.dy01 * 4.0f);
+  const bool has_uv = tri->texture != NULL || tri->lightmap != NULL;
+
+  float us[4], vs[4], ws[4], ds[4];
+
+  for (int py = rs.minY; py <= rs.maxY; py++) {
+    float fy = py + 0.5f;
+    int row_start = py * stride;
+
+    // Exact edge values at the first group of the row
+    float32x4_t fx = vaddq_f32(vdupq_n_f32(rs.minX + 0.5f), lane);
+    float32x4_t e0 = vsubq_f32(vdupq_n_f32(rs.dx12 * (fy - rs.y1)),
+                               vmulq_n_f32(vsubq_f32(fx, vdupq_n_f32(rs.x1)), rs.dy12));
+    float32x4_t e1 = vsubq_f32(vdupq_n_f32(rs.dx20 * (fy - rs.y2)),
+                               vmulq_n_f32(vsubq_f32(fx, vdupq_n_f32(rs.x2)), rs.dy20));
+    float32x4_t e2 = vsubq_f32(vdupq_n_f32(rs.dx01 * (fy - rs.y0)),
+                               vmulq_n_f32(vsubq_f32(fx, vdupq_n_f32(rs.x0)), rs.dy01));
+
+    for (int px = rs.minX; px <= rs.maxX; px += 4,
+         e0 = vaddq_f32(e0, step0), e1 = vaddq_f32(e1, step1), e2 = vaddq_f32(e2, step2)) {
+      uint32x4_t inside = vandq_u32(vandq_u32(vcgeq_f32(e0, eps), vcgeq_f32(e1, eps)), vcgeq_f32(e2, eps));
+      int lanes = MIN(4, rs.maxX - px + 1);
+      int cover = (int)vaddvq_u32(vandq_u32(inside, lane_bits)) & ((1 << lanes) - 1);
+      if (!cover) continue;
+
+      float32x4_t b0 = vmulq_n_f32(e0, rs.invArea);
+      float32x4_t b1 = vmulq_n_f32(e1, rs.invArea);
+      float32x4_t b2 = vsubq_f32(vsubq_f32(one, b0), b1);
+      float32x4_t depth = vaddq_f32(vaddq_f32(vmulq_n_f32(b0, rs.z0), vmulq_n_f32(b1, rs.z1)),
+                                    vmulq_n_f32(b2, rs.z2));
+
+      // Masked depth test and write
+      float* dptr = depth_buf + row_start + px;
+      int pass;
+      if (lanes == 4) {
+        float32x4_t old = vld1q_f32(dptr);
+        uint32x4_t closer = vandq_u32(vcltq_f32(depth, old), inside);
+        pass = (int)vaddvq_u32(vandq_u32(closer, lane_bits));
+        if (!pass) continue;
+        vst1q_f32(dptr, vbslq_f32(closer, depth, old));
+      } else {
+        vst1q_f32(ds, depth);
+        pass = 0;
+        for (int l = 0; l < lanes; l++) {
+          if ((cover >> l) & 1 && ds[l] < dptr[l]) {
+            dptr[l] = ds[l];
+            pass |= 1 << l;
+          }
+        }
+        if (!pass) continue;
+      }
+
+      if (has_uv) {
+        // Perspective-correct UVs with refined reciprocal of interpolated 1/w
+        float32x4_t iw = vaddq_f32(vaddq_f32(vmulq_n_f32(b0, rs.inv_w0), vmulq_n_f32(b1, rs.inv_w1)),
+                                   vmulq_n_f32(b2, rs.inv_w2));
+        float32x4_t r = vrecpeq_f32(iw);
+        r = vmulq_f32(r, vrecpsq_f32(iw, r));
+        r = vmulq_f32(r, vrecpsq_f32(iw, r));
+        float32x4_t u = vaddq_f32(vaddq_f32(vmulq_n_f32(b0, rs.u0_w), vmulq_n_f32(b1, rs.u1_w)),
+                                  vmulq_n_f32(b2, rs.u2_w));
+        float32x4_t v = vaddq_f32(vaddq_f32(vmulq_n_f32(b0, rs.v0_w), vmulq_n_f32(b1, rs.v1_w)),
+                                  vmulq_n_f32(b2, rs.v2_w));
+        vst1q_f32(us, vmulq_f32(u, r));
+        vst1q_f32(vs, vmulq_f32(v, r));
+        vst1q_f32(ws, r);
+      }
+
+      for (int l = 0; l < lanes; l++) {
+        if ((pass >> l) & 1) {
+          shade_pixel(tri, has_uv ? us[l] : 0, has_uv ? vs[l] : 0, has_uv ? ws[l] : 0, color_buf,
+                      (size_t)row_start + px + l);
+        }
+      }
+    }
+  }
+}
+
+#endif  // USE_NEON
+
+/**
+ * Multisample kernel: one pass per triangle. Each pixel evaluates the edge
+ * functions at all sample positions into a coverage mask, depth-tests every
+ * covered sample, and is shaded once (at the pixel center) for the samples
+ * that pass. Samples are interleaved per pixel (SAMPLES colors/depths in a
+ * row), so the per-sample loops are contiguous and vectorize.
+ */
+FORCE_INLINE void raster_kernel_msaa(const RasterTri* tri, const TileRect* rect,
+                                     const float (*offsets)[2], const int SAMPLES) {
+  // Sample offsets reach up to half a pixel outside the center bounding box
+  TileRect wide = { rect->x0 - 1, rect->y0 - 1, rect->x1 + 1, rect->y1 + 1 };
+  RasterSetup rs;
+  if (!prepare_raster(tri, 0.0f, 0.0f, &wide, &rs)) return;
+  rs.minX = MAX(rs.minX - 1, rect->x0); rs.maxX = MIN(rs.maxX + 1, rect->x1);
+  rs.minY = MAX(rs.minY - 1, rect->y0); rs.maxY = MIN(rs.maxY + 1, rect->y1);
+  if (rs.minX > rs.maxX || rs.minY > rs.maxY) return;
+
+  // Edge and depth deltas from the pixel center to each sample (sample s sits
+  // at center - offset); edges and depth are linear, so per pixel each sample
+  // costs a few adds and compares
+  const float dz0 = (rs.z0 - rs.z2) * rs.invArea, dz1 = (rs.z1 - rs.z2) * rs.invArea;
+  float de0[16], de1[16], de2[16], ddz[16];
+  float reach0 = 0, reach1 = 0, reach2 = 0;
+  for (int s = 0; s < SAMPLES; s++) {
+    float ox = offsets[s][0], oy = offsets[s][1];
+    de0[s] = rs.dy12 * ox - rs.dx12 * oy;
+    de1[s] = rs.dy20 * ox - rs.dx20 * oy;
+    de2[s] = rs.dy01 * ox - rs.dx01 * oy;
+    ddz[s] = dz0 * de0[s] + dz1 * de1[s];
+    reach0 = MAX(reach0, de0[s]);
+    reach1 = MAX(reach1, de1[s]);
+    reach2 = MAX(reach2, de2[s]);
+  }
+  const float eps = -0.001f;
+  const bool has_uv = tri->texture != NULL || tri->lightmap != NULL;
+
+  for (int py = rs.minY; py <= rs.maxY; py++) {
+    float fy = py + 0.5f;
+    float fx0 = rs.minX + 0.5f;
+
+    // Exact center edge values at the start of the row, stepped per pixel
+    float c0 = rs.dx12 * (fy - rs.y1) - rs.dy12 * (fx0 - rs.x1);
+    float c1 = rs.dx20 * (fy - rs.y2) - rs.dy20 * (fx0 - rs.x2);
+    float c2 = rs.dx01 * (fy - rs.y0) - rs.dy01 * (fx0 - rs.x0);
+
+    for (int px = rs.minX; px <= rs.maxX; px++, c0 -= rs.dy12, c1 -= rs.dy20, c2 -= rs.dy01) {
+      // Skip pixels none of whose samples can be inside
+      if (c0 + reach0 < eps || c1 + reach1 < eps || c2 + reach2 < eps) continue;
+
+      size_t pixel = (size_t)py * g_width + px;
+      float* __restrict depth = g_msaa_depth + pixel * SAMPLES;
+      float center_z = rs.z2 + dz0 * c0 + dz1 * c1;
+      int passed[16];
+      int pass_any = 0;
+
+      // Coverage mask and per-sample depth test
+      for (int s = 0; s < SAMPLES; s++) {
+        float d = center_z + ddz[s];
+        int hit = (c0 + de0[s] >= eps) & (c1 + de1[s] >= eps) & (c2 + de2[s] >= eps) & (d < depth[s]);
+        depth[s] = hit ? d : depth[s];
+        passed[s] = hit;
+        pass_any |= hit;
+      }
+      if (!pass_any) continue;
+
+      // Shade once per pixel
+      float u = 0, v = 0, w = 0;
+      if (has_uv) {
+        float b0 = c0 * rs.invArea;
+        float b1 = c1 * rs.invArea;
+        float b2 = 1.0f - b0 - b1;
+        float interp_inv_w = b0 * rs.inv_w0 + b1 * rs.inv_w1 + b2 * rs.inv_w2;
+        u = (b0 * rs.u0_w + b1 * rs.u1_w + b2 * rs.u2_w) / interp_inv_w;
+        v = (b0 * rs.v0_w + b1 * rs.v1_w + b2 * rs.v2_w) / interp_inv_w;
+        w = 1.0f / interp_inv_w;
+      }
+      uint8_t rgb[3];
+      shade_pixel(tri, u, v, w, rgb, 0);
+
+      uint8_t* __restrict color = g_msaa_buffer + pixel * SAMPLES * 3;
+      for (int s = 0; s < SAMPLES; s++) {
+        if (passed[s]) {
+          color[s * 3] = rgb[0];
+          color[s * 3 + 1] = rgb[1];
+          color[s * 3 + 2] = rgb[2];
+        }
+      }
+    }
+  }
+}
+
+// Sample count specializations (the AVX2 builds vectorize the sample loops 8 wide)
+static void raster_kernel_msaa4(const RasterTri* tri, const TileRect* rect) {
+  raster_kernel_msaa(tri, rect, msaa4_offsets, 4);
+}
+
+static void raster_kernel_msaa16(const RasterTri* tri, const TileRect* rect) {
+  raster_kernel_msaa(tri, rect, msaa16_offsets, 16);
+}
+
+#if defined(USE_X86_DISPATCH)
+__attribute__((target("avx2")))
+static void raster_kernel_msaa4_avx2(const RasterTri* tri, const TileRect* rect) {
+  raster_kernel_msaa(tri, rect, msaa4_offsets, 4);
+}
+
+__attribute__((target("avx2")))
+static void raster_kernel_msaa16_avx2(const RasterTri* tri, const TileRect* rect) {
+  raster_kernel_msaa(tri, rect, msaa16_offsets, 16);
+}
+#endif
+
+// Selected at init from the running CPU's features (not the build machine's)
+typedef void (*RasterKernelFn)(const RasterTri*, float, float, const TileRect*, uint8_t*, float*, int);
+static RasterKernelFn g_raster_kernel = raster_kernel_scalar;
+static const char* g_raster_kernel_name = "scalar";
+
+typedef void (*MsaaKernelFn)(const RasterTri*, const TileRect*);
+static MsaaKernelFn g_msaa4_kernel = raster_kernel_msaa4;
+static MsaaKernelFn g_msaa16_kernel = raster_kernel_msaa16;
+
+// Pick a kernel by name ("auto" = best supported). Returns false if unsupported here.
+static bool select_raster_kernel(const char* name) {
+  bool want_auto = strcmp(name, "auto") == 0;
+
+#if defined(USE_X86_DISPATCH)
+  __builtin_cpu_init();
+  g_msaa4_kernel = raster_kernel_msaa4;
+  g_msaa16_kernel = raster_kernel_msaa16;
+  g_vertex_kernel = vertex_kernel_default;
+  if ((want_auto || strcmp(name, "avx2") == 0) && __builtin_cpu_supports("avx2")) {
+    g_raster_kernel = raster_kernel_avx2;
+    g_msaa4_kernel = raster_kernel_msaa4_avx2;
+    g_msaa16_kernel = raster_kernel_msaa16_avx2;
+    g_vertex_kernel = vertex_kernel_avx2;
+    g_raster_kernel_name = "avx2";
+    return true;
+  }
+  if ((want_auto || strcmp(name, "sse4.1") == 0) && __builtin_cpu_supports("sse4.1")) {
+    g_raster_kernel = raster_kernel_sse41;
+    g_raster_kernel_name = "sse4.1";
+    return true;
+  }
+#elif defined(USE_NEON)
+  if (want_auto || strcmp(name, "neon") == 0) {
+    g_raster_kernel = raster_kernel_neon;
+    g_raster_kernel_name = "neon";
+    return true;
+  }
+#endif
+
+  if (want_auto || strcmp(name, "scalar") == 0) {
+    g_raster_kernel = raster_kernel_scalar;
+    g_raster_kernel_name = "scalar";
+    return true;
+  }
+  return false;
+}
+
+// Rasterize one binned triangle into one tile (all MSAA samples in one pass)
+static void raster_tile_triangle(const RasterTri* tri, const TileRect* rect) {
+  if (g_msaa_samples == 4) {
+    g_msaa4_kernel(tri, rect);
+  } else if (g_msaa_samples == 16) {
+    g_msaa16_kernel(tri, rect);
+  } else {
+    g_raster_kernel(tri, 0.0f, 0.0f, rect, g_framebuffer, g_depth_buffer, g_width);
+  }
+}
+
+// Recompute the tile's hi-Z blocks flagged in dirty (bit = by * HIZ_BLOCKS_PER_TILE + bx)
+static void refresh_tile_hiz(int tx, int ty, uint32_t dirty) {
+  while (dirty) {
+    int bit = __builtin_ctz(dirty);
+    dirty &= dirty - 1;
+    refresh_hiz_block(tx * HIZ_BLOCKS_PER_TILE + bit % HIZ_BLOCKS_PER_TILE,
+                      ty * HIZ_BLOCKS_PER_TILE + bit / HIZ_BLOCKS_PER_TILE);
+  }
+}
+
+/**
+ * Rasterize a triangle into a tile, skipping 8x8 blocks whose hi-Z max depth
+ * is already nearer than the triangle. Visible blocks are rasterized as
+ * horizontal runs. Returns the number of blocks skipped.
+ */
+static int raster_tile_triangle_hiz(const RasterTri* tri, const TileRect* rect,
+                                    int tx, int ty, uint32_t* dirty) {
+  TileRect clip = {
+    MAX(rect->x0, tri->min_x), MAX(rect->y0, tri->min_y),
+    MIN(rect->x1, tri->max_x), MIN(rect->y1, tri->max_y)
+  };
+  if (clip.x0 > clip.x1 || clip.y0 > clip.y1) return 0;
+
+  float min_z = MIN(MIN(tri->z[0], tri->z[1]), tri->z[2]);
+  int bx0 = clip.x0 / HIZ_BLOCK, bx1 = clip.x1 / HIZ_BLOCK;
+  int rejected = 0;
+
+  for (int by = clip.y0 / HIZ_BLOCK; by <= clip.y1 / HIZ_BLOCK; by++) {
+    const float* hiz_row = g_hiz + by * g_hiz_w;
+    int run_start = -1;
+
+    for (int bx = bx0; bx <= bx1 + 1; bx++) {
+      bool visible = bx <= bx1 && min_z < hiz_row[bx];
+      if (visible) {
+        if (run_start < 0) run_start = bx;
+        *dirty |= 1u << ((by - ty * HIZ_BLOCKS_PER_TILE) * HIZ_BLOCKS_PER_TILE +
+                         (bx - tx * HIZ_BLOCKS_PER_TILE));
+        continue;
+      }
+      if (bx <= bx1) rejected++;
+      if (run_start >= 0) {
+        TileRect run = {
+          MAX(clip.x0, run_start * HIZ_BLOCK), MAX(clip.y0, by * HIZ_BLOCK),
+          MIN(clip.x1, bx * HIZ_BLOCK - 1), MIN(clip.y1, (by + 1) * HIZ_BLOCK - 1)
+        };
+        raster_tile_triangle(tri, &run);
+        run_start = -1;
+      }
+    }
+  }
+  return rejected;
+}
+
+// Tile work function (called by workers)
+static void do_raster_tiles(int start_tile, int end_tile) {
+  int rejected = 0;
+
+  for (int t = start_tile; t < end_tile; t++) {
+    const TileBin* bin = &g_tile_bins[t];
+    if (bin->count == 0) continue;
+
+    int tx = t % g_tiles_x, ty = t / g_tiles_x;
+    TileRect rect = {
+      tx * TILE_SIZE, ty * TILE_SIZE,
+      MIN((tx + 1) * TILE_SIZE, g_width) - 1, MIN((ty + 1) * TILE_SIZE, g_height) - 1
+    };
+
+    uint32_t dirty = 0;
+    for (int i = 0; i < bin->count; i++) {
+      rejected += raster_tile_triangle_hiz(&g_raster_tris[bin->tris[i]], &rect, tx, ty, &dirty);
+
+      // Keep hi-Z current so later triangles in this tile can be rejected
+      if ((i + 1) % HIZ_REFRESH_TRIS == 0) {
+        refresh_tile_hiz(tx, ty, dirty);
+        dirty = 0;
+      }
+    }
+    refresh_tile_hiz(tx, ty, dirty);
+  }
+
+  if (rejected) {
+    __atomic_fetch_add(&g_debug_hiz_blocks_rejected, rejected, __ATOMIC_RELAXED);
+  }
+}
+
+/**
+ * Cull and set up a projected triangle for binning. Positions are screen x/y
+ * and NDC z per vertex; the ClipVerts supply clip w and the attributes.
+ * Returns 1 if emitted, 0 if culled.
+ */
+static int setup_screen_triangle(
+    const ClipVert* cv0, const ClipVert* cv1, const ClipVert* cv2,
+    float sx0, float sy0, float ndcZ0,
+    float sx1, float sy1, float ndcZ1,
+    float sx2, float sy2, float ndcZ2,
+    float light_factor,
+    RasterTri* out,
+    SetupCounters* counters
+) {
+  // Compute signed area for winding check
+  float signed_area = (sx1 - sx0) * (sy2 - sy0) - (sx2 - sx0) * (sy1 - sy0);
+
+  // Backface culling
+  if (g_enable_backface_culling && signed_area < 0) {
+    counters->backface_culled++;
+    return 0;
+  }
+
+  // Degenerate (same area test the rasterizer applies)
+  if (fabsf(signed_area) < 0.0001f) {
+    counters->degenerate++;
+    return 0;
+  }
+
+  // If area is negative but culling is off, swap v1 and v2
+  const ClipVert* a = cv1;
+  const ClipVert* b = cv2;
+  float ax = sx1, ay = sy1, az = ndcZ1;
+  float bx = sx2, by = sy2, bz = ndcZ2;
+  if (signed_area < 0) {
+    a = cv2; b = cv1;
+    ax = sx2; ay = sy2; az = ndcZ2;
+    bx = sx1; by = sy1; bz = ndcZ1;
+  }
+
+  out->x[0] = sx0; out->y[0] = sy0; out->z[0] = ndcZ0; out->w[0] = cv0->cw;
+  out->x[1] = ax;  out->y[1] = ay;  out->z[1] = az;    out->w[1] = a->cw;
+  out->x[2] = bx;  out->y[2] = by;  out->z[2] = bz;    out->w[2] = b->cw;
+  out->u[0] = cv0->u; out->v[0] = cv0->v;
+  out->u[1] = a->u;   out->v[1] = a->v;
+  out->u[2] = b->u;   out->v[2] = b->v;
+  out->base_r = cv0->r; out->base_g = cv0->g; out->base_b = cv0->b;
+  out->light = light_factor;
+
+  bool use_texture = g_enable_textures && g_current_texture != NULL;
+  out->texture = use_texture ? g_current_texture : NULL;
+  out->lod_base = 0.0f;
+  float du1 = out->u[1] - out->u[0], dv1 = out->v[1] - out->v[0];
+  float du2 = out->u[2] - out->u[0], dv2 = out->v[2] - out->v[0];
+  float uv_det = du1 * dv2 - du2 * dv1;
+  if (use_texture) {
+    // Texels per pixel at w = 1: 0.5 * log2(texel area / screen area), with
+    // the perspective term w^3 / (w0 w1 w2) folded in per pixel
+    float uv_area = fabsf(uv_det) * (float)(1 << (g_current_texture->log2_w + g_current_texture->log2_h));
+    out->lod_base = uv_area > 0.0f
+        ? 0.5f * (fast_log2(uv_area / fabsf(signed_area)) -
+                  fast_log2(out->w[0]) - fast_log2(out->w[1]) - fast_log2(out->w[2]))
+        : -64.0f;
+  }
+
+  out->lightmap = g_draw_lightmap;
+  if (out->lightmap) {
+    float lu0 = cv0->lu, lu1 = a->lu, lu2 = b->lu;
+    float lv0 = cv0->lv, lv1 = a->lv, lv2 = b->lv;
+    if (!use_texture) {
+      // Nothing else needs the UV slots: interpolate the lightmap UVs directly
+      out->u[0] = lu0; out->u[1] = lu1; out->u[2] = lu2;
+      out->v[0] = lv0; out->v[1] = lv1; out->v[2] = lv2;
+      const float identity[6] = {1, 0, 0, 0, 1, 0};
+      memcpy(out->lm, identity, sizeof(identity));
+    } else if (fabsf(uv_det) > 1e-12f) {
+      // Both UV sets are linear over the triangle, so lightmap UV is an
+      // exact affine function of texture UV
+      float inv = 1.0f / uv_det;
+      float dl1 = lu1 - lu0, dl2 = lu2 - lu0;
+      float dm1 = lv1 - lv0, dm2 = lv2 - lv0;
+      out->lm[0] = (dl1 * dv2 - dl2 * dv1) * inv;
+      out->lm[1] = (du1 * dl2 - du2 * dl1) * inv;
+      out->lm[2] = lu0 - out->lm[0] * out->u[0] - out->lm[1] * out->v[0];
+      out->lm[3] = (dm1 * dv2 - dm2 * dv1) * inv;
+      out->lm[4] = (du1 * dm2 - du2 * dm1) * inv;
+      out->lm[5] = lv0 - out->lm[3] * out->u[0] - out->lm[4] * out->v[0];
+    } else {
+      // Degenerate texture mapping samples one texel; light it by the centroid
+      out->lm[0] = out->lm[1] = out->lm[3] = out->lm[4] = 0;
+      out->lm[2] = (lu0 + lu1 + lu2) * (1.0f / 3.0f);
+      out->lm[5] = (lv0 + lv1 + lv2) * (1.0f / 3.0f);
+    }
+  }
+
+  // Screen bounds, widened by a pixel to cover MSAA sample offsets
+  float fminx = MIN(MIN(sx0, sx1), sx2), fmaxx = MAX(MAX(sx0, sx1), sx2);
+  float fminy = MIN(MIN(sy0, sy1), sy2), fmaxy = MAX(MAX(sy0, sy1), sy2);
+  out->min_x = (int)CLAMP(floorf(fminx) - 1.0f, 0.0f, (float)g_width);
+  out->max_x = (int)CLAMP(ceilf(fmaxx) + 1.0f, -1.0f, (float)(g_width - 1));
+  out->min_y = (int)CLAMP(floorf(fminy) - 1.0f, 0.0f, (float)g_height);
+  out->max_y = (int)CLAMP(ceilf(fmaxy) + 1.0f, -1.0f, (float)(g_height - 1));
+
+  return 1;
+}
+
+/**
+ * Perspective divide, cull and set up a single clipped triangle for binning.
+ * Returns 1 if emitted, 0 if culled.
+ */
+static int setup_clipped_triangle(
+    const ClipVert* cv0, const ClipVert* cv1, const ClipVert* cv2,
+    float light_factor,
+    float halfW, float halfH,
+    RasterTri* out,
+    SetupCounters* counters
+) {
+  // Perspective divide
+  float ndcX0 = cv0->cx / cv0->cw, ndcY0 = cv0->cy / cv0->cw, ndcZ0 = cv0->cz / cv0->cw;
+  float ndcX1 = cv1->cx / cv1->cw, ndcY1 = cv1->cy / cv1->cw, ndcZ1 = cv1->cz / cv1->cw;
+  float ndcX2 = cv2->cx / cv2->cw, ndcY2 = cv2->cy / cv2->cw, ndcZ2 = cv2->cz / cv2->cw;
+
+  // Frustum cull (only cull if ALL vertices are on same side)
+  if ((ndcX0 < -1 && ndcX1 < -1 && ndcX2 < -1) ||
+      (ndcX0 > 1 && ndcX1 > 1 && ndcX2 > 1) ||
+      (ndcY0 < -1 && ndcY1 < -1 && ndcY2 < -1) ||
+      (ndcY0 > 1 && ndcY1 > 1 && ndcY2 > 1)) {
+    counters->frustum_culled++;
+    return 0;
+  }
+
+  return setup_screen_triangle(cv0, cv1, cv2,
+                               (ndcX0 + 1) * halfW, (1 - ndcY0) * halfH, ndcZ0,
+                               (ndcX1 + 1) * halfW, (1 - ndcY1) * halfH, ndcZ1,
+                               (ndcX2 + 1) * halfW, (1 - ndcY2) * halfH, ndcZ2,
+                               light_factor, out, counters);
+}
+
+/**
+ * Normalize a vector in place (leaves near-zero vectors untouched).
+ */
+static inline void normalize3(float* nx, float* ny, float* nz) {
+  float len_sq = *nx * *nx + *ny * *ny + *nz * *nz;
+  if (len_sq > 0.0001f) {
+    float inv_len = fast_rsqrt(len_sq);
+    *nx *= inv_len;
+    *ny *= inv_len;
+    *nz *= inv_len;
+  }
+}
+
+/**
+ * Per-face light factor (ambient + directional) for a normalized face normal.
+ */
+static inline float compute_light_factor(float nx, float ny, float nz) {
+  float nDotL = nx * g_light_dir[0] + ny * g_light_dir[1] + nz * g_light_dir[2];
+  if (nDotL < 0) nDotL = 0;
+  return g_ambient_light + (1.0f - g_ambient_light) * nDotL;
+}
+
+/**
+ * Near-clip a clip-space triangle and set up the resulting pieces.
+ * Only triangles straddling the near plane get here (see setup_triangle_range).
+ * Writes up to 2 triangles to out; returns the number written.
+ */
+static int setup_clip_triangle(
+    const ClipVert* cv0, const ClipVert* cv1, const ClipVert* cv2,
+    float light_factor,
+    float halfW, float halfH,
+    RasterTri* out,
+    SetupCounters* counters
+) {
+  // Clip triangle against near plane - may produce 0, 1, or 2 triangles
+  ClipVert clipped[6];  // Space for 2 triangles
+  int num_tris = clip_triangle_near_plane(cv0, cv1, cv2, clipped);
+
+  if (num_tris == 0) {
+    counters->near_clipped++;
+    return 0;
+  }
+
+  // Process each clipped triangle
+  int emitted = 0;
+  for (int ct = 0; ct < num_tris; ct++) {
+    ClipVert* t0 = &clipped[ct * 3];
+    ClipVert* t1 = &clipped[ct * 3 + 1];
+    ClipVert* t2 = &clipped[ct * 3 + 2];
+
+    emitted += setup_clipped_triangle(t0, t1, t2, light_factor, halfW, halfH, &out[emitted], counters);
+  }
+  return emitted;
+}
+
+/**
+ * Source of triangles for the setup stage (immediate arrays or a resident mesh).
+ * Positions go through the vertex stage first; fetch() fills in triangle t's
+ * attributes (UVs, lightmap UVs, colors) and face light.
+ */
+typedef struct TriangleSource TriangleSource;
+struct TriangleSource {
+  void (*fetch)(const TriangleSource* src, int t, uint32_t i0, uint32_t i1, uint32_t i2,
+                ClipVert* cv0, ClipVert* cv1, ClipVert* cv2, float* light);
+  int triangle_count;
+  int vertex_start;             // Vertices the indices reference: [vertex_start, vertex_end)
+  int vertex_end;
+  const float* mvp;
+  const uint32_t* indices;      // 3 per triangle
+  const float* px;              // Positions for the vertex stage (x of vertex i at px[i * stride])
+  const float* py;
+  const float* pz;
+  int position_stride;
+  const float* uvs;             // Batch UVs, interleaved (NULL for meshes)
+  size_t uv_count;              // Floats of UVs; triangles with a vertex past it have none
+
+  // Immediate batch arrays (render_triangles_batch)
+  const float* vertices;
+  const uint8_t* colors;
+  const float* normals;
+  size_t normal_count;
+
+  // Resident mesh (render_draw_mesh)
+  const struct NativeMesh* mesh;
+};
+
+// Set up triangles [t_start, t_end) from a source; returns number of RasterTris written
+static int setup_triangle_range(const TriangleSource* src, int t_start, int t_end,
+                                RasterTri* out, SetupCounters* counters) {
+  const VertexCache* vc = &g_vertex_cache;
+  const uint8_t* outcode = vc->outcode;
+  const uint32_t vertex_count = (uint32_t)src->vertex_end;
+  const bool textured = g_enable_textures && g_current_texture != NULL;
+  const bool lightmapped = g_draw_lightmap != NULL;
+  float halfW = g_width * 0.5f;
+  float halfH = g_height * 0.5f;
+  int emitted = 0;
+
+  for (int t = t_start; t < t_end; t++) {
+    const uint32_t* tri = src->indices + (size_t)t * 3;
+    uint32_t i0 = tri[0], i1 = tri[1], i2 = tri[2];
+
+    counters->total++;
+    // Immediate batches are not validated up front (vertex_end is clamped to the array)
+    if (i0 >= vertex_count || i1 >= vertex_count || i2 >= vertex_count) {
+      counters->degenerate++;
+      continue;
+    }
+    if (src->uv_count >= ((size_t)i2 + 1) * 2) counters->with_uv++;
+
+    // Trivial reject: all three vertices outside the same plane
+    uint8_t all_out = outcode[i0] & outcode[i1] & outcode[i2];
+    uint8_t any_out = outcode[i0] | outcode[i1] | outcode[i2];
+    if (all_out & OUT_NEAR) {
+      counters->near_clipped++;
+      continue;
+    }
+    if (textured) counters->textured++;
+    if (lightmapped) counters->lightmapped++;
+    if (all_out & OUT_FRUSTUM) {
+      counters->frustum_culled++;
+      continue;
+    }
+
+    ClipVert cv0, cv1, cv2;
+    float light_factor;
+    src->fetch(src, t, i0, i1, i2, &cv0, &cv1, &cv2, &light_factor);
+    cv0.cw = vc->cw[i0];
+    cv1.cw = vc->cw[i1];
+    cv2.cw = vc->cw[i2];
+
+    if (any_out & OUT_NEAR) {
+      // Straddles the near plane: clip, then project the pieces
+      counters->clipped++;
+      cv0.cx = vc->cx[i0]; cv0.cy = vc->cy[i0]; cv0.cz = vc->cz[i0];
+      cv1.cx = vc->cx[i1]; cv1.cy = vc->cy[i1]; cv1.cz = vc->cz[i1];
+      cv2.cx = vc->cx[i2]; cv2.cy = vc->cy[i2]; cv2.cz = vc->cz[i2];
+      emitted += setup_clip_triangle(&cv0, &cv1, &cv2, light_factor, halfW, halfH, &out[emitted], counters);
+    } else {
+      // In front of the near plane: already projected by the vertex stage
+      emitted += setup_screen_triangle(&cv0, &cv1, &cv2,
+                                       vc->sx[i0], vc->sy[i0], vc->sz[i0],
+                                       vc->sx[i1], vc->sy[i1], vc->sz[i1],
+                                       vc->sx[i2], vc->sy[i2], vc->sz[i2],
+                                       light_factor, &out[emitted], counters);
+    }
+  }
+  return emitted;
+}
+
+static void merge_setup_counters(const SetupCounters* c) {
+  g_debug_total_tris += c->total;
+  g_debug_triangles_with_uv += c->with_uv;
+  g_debug_triangles_textured += c->textured;
+  g_debug_triangles_lightmapped += c->lightmapped;
+  g_debug_near_clipped += c->near_clipped;
+  g_debug_triangles_clipped += c->clipped;
+  g_debug_frustum_culled += c->frustum_culled;
+  g_debug_backface_culled += c->backface_culled;
+  g_debug_degenerate += c->degenerate;
+}
+
+// Parallel setup job (one at a time, owned by the JS thread while dispatched)
+static struct {
+  const TriangleSource* src;
+  RasterTri* out_base;        // Chunk k writes at out_base + k * SETUP_CHUNK * 2
+  int* chunk_counts;
+  int chunk_capacity;
+  SetupCounters counters;
+  pthread_mutex_t counters_mutex;
+} g_setup_job = { .counters_mutex = PTHREAD_MUTEX_INITIALIZER };
+
+// Setup work function (called by workers)
+static void do_setup_chunks(int start_chunk, int end_chunk) {
+  const TriangleSource* src = g_setup_job.src;
+  SetupCounters local = {0};
+
+  for (int k = start_chunk; k < end_chunk; k++) {
+    int t_start = k * SETUP_CHUNK;
+    int t_end = MIN(t_start + SETUP_CHUNK, src->triangle_count);
+    g_setup_job.chunk_counts[k] = setup_triangle_range(
+      src, t_start, t_end, g_setup_job.out_base + (size_t)k * SETUP_CHUNK * 2, &local);
+  }
+
+  pthread_mutex_lock(&g_setup_job.counters_mutex);
+  g_setup_job.counters.total += local.total;
+  g_setup_job.counters.with_uv += local.with_uv;
+  g_setup_job.counters.textured += local.textured;
+  g_setup_job.counters.lightmapped += local.lightmapped;
+  g_setup_job.counters.near_clipped += local.near_clipped;
+  g_setup_job.counters.clipped += local.clipped;
+  g_setup_job.counters.frustum_culled += local.frustum_culled;
+  g_setup_job.counters.backface_culled += local.backface_culled;
+  g_setup_job.counters.degenerate += local.degenerate;
+  pthread_mutex_unlock(&g_setup_job.counters_mutex);
+}
+
+/**
+ * Transform a source's vertices, then clip and set up every triangle and bin
+ * the results. Large draws are set up in parallel chunks; chunk outputs are
+ * compacted in order so tile bins keep submission order.
+ * Returns number of triangles queued for rasterization.
+ */
+static int submit_triangles(const TriangleSource* src) {
+  int n = src->triangle_count;
+  if (n <= 0 || src->vertex_end <= src->vertex_start) return 0;
+
+  // Near clipping can split each triangle in two
+  if (!ensure_raster_capacity(n * 2)) return 0;
+
+  int first = g_raster_count;
+  RasterTri* out = g_raster_tris + first;
+  int emitted = 0;
+  int num_chunks = (n + SETUP_CHUNK - 1) / SETUP_CHUNK;
+  uint64_t prof = prof_begin();
+
+  if (!run_vertex_stage(src->px, src->py, src->pz, src->position_stride, src->mvp,
+                        src->vertex_start, src->vertex_end)) {
+    return 0;
+  }
+  g_debug_vertices_transformed += src->vertex_end - src->vertex_start;
+
+  if (jobs_worker_count() > 0 && num_chunks >= 2) {
+    if (num_chunks > g_setup_job.chunk_capacity) {
+      int* grown = (int*)realloc(g_setup_job.chunk_counts, sizeof(int) * num_chunks);
+      if (!grown) return 0;
+      g_setup_job.chunk_counts = grown;
+      g_setup_job.chunk_capacity = num_chunks;
+    }
+
+    g_setup_job.src = src;
+    g_setup_job.out_base = out;
+    memset(&g_setup_job.counters, 0, sizeof(SetupCounters));
+
+    dispatch_parallel_work(WORK_SETUP_TRIANGLES, 0, num_chunks, 1, 2, 0, 0, 0);
+
+    // Compact chunk outputs in order (destination never passes source)
+    for (int k = 0; k < num_chunks; k++) {
+      int count = g_setup_job.chunk_counts[k];
+      RasterTri* chunk_out = out + (size_t)k * SETUP_CHUNK * 2;
+      if (chunk_out != out + emitted && count > 0) {
+        memmove(out + emitted, chunk_out, sizeof(RasterTri) * count);
+      }
+      emitted += count;
+    }
+    merge_setup_counters(&g_setup_job.counters);
+  } else {
+    SetupCounters counters = {0};
+    emitted = setup_triangle_range(src, 0, n, out, &counters);
+    merge_setup_counters(&counters);
+  }
+
+  g_raster_count += emitted;
+  bin_triangles(first, g_raster_count);
+  prof_end(PROF_SETUP, prof);
+
+  if (g_raster_count >= HIZ_FLUSH_TRIS) {
+    flush_tiles();
+  }
+  return emitted;
+}
+
+// Fetch triangle t's attributes from immediate (interleaved) arrays
+static void fetch_batch_triangle(const TriangleSource* src, int t, uint32_t i0, uint32_t i1, uint32_t i2,
+                                 ClipVert* cv0, ClipVert* cv1, ClipVert* cv2, float* light) {
+  const float* vertices = src->vertices;
+  const float* normals = src->normals;
+  const float* uvs = src->uvs;
+  const uint8_t* colors = src->colors;
+
+  // Get colors and UVs for original vertices
+  cv0->r = colors[i0 * 3]; cv0->g = colors[i0 * 3 + 1]; cv0->b = colors[i0 * 3 + 2];
+  cv1->r = colors[i1 * 3]; cv1->g = colors[i1 * 3 + 1]; cv1->b = colors[i1 * 3 + 2];
+  cv2->r = colors[i2 * 3]; cv2->g = colors[i2 * 3 + 1]; cv2->b = colors[i2 * 3 + 2];
+
+  bool has_uv = uvs && src->uv_count >= (i2 + 1) * 2;
+  if (has_uv) {
+    cv0->u = uvs[i0 * 2]; cv0->v = uvs[i0 * 2 + 1];
+    cv1->u = uvs[i1 * 2]; cv1->v = uvs[i1 * 2 + 1];
+    cv2->u = uvs[i2 * 2]; cv2->v = uvs[i2 * 2 + 1];
+  } else {
+    cv0->u = cv0->v = cv1->u = cv1->v = cv2->u = cv2->v = 0;
+  }
+  cv0->lu = cv0->lv = cv1->lu = cv1->lv = cv2->lu = cv2->lv = 0;
+
+  // Compute face normal for lighting (using original vertices)
+  float nx, ny, nz;
+  if (src->normal_count >= (i2 + 1) * 3) {
+    nx = (normals[i0 * 3] + normals[i1 * 3] + normals[i2 * 3]) * 0.333333f;
+    ny = (normals[i0 * 3 + 1] + normals[i1 * 3 + 1] + normals[i2 * 3 + 1]) * 0.333333f;
+    nz = (normals[i0 * 3 + 2] + normals[i1 * 3 + 2] + normals[i2 * 3 + 2]) * 0.333333f;
+  } else {
+    float vx0 = vertices[i0 * 3], vy0 = vertices[i0 * 3 + 1], vz0 = vertices[i0 * 3 + 2];
+    float e1x = vertices[i1 * 3] - vx0, e1y = vertices[i1 * 3 + 1] - vy0, e1z = vertices[i1 * 3 + 2] - vz0;
+    float e2x = vertices[i2 * 3] - vx0, e2y = vertices[i2 * 3 + 1] - vy0, e2z = vertices[i2 * 3 + 2] - vz0;
+    nx = e1y * e2z - e1z * e2y;
+    ny = e1z * e2x - e1x * e2z;
+    nz = e1x * e2y - e1y * e2x;
+  }
+  normalize3(&nx, &ny, &nz);
+  *light = compute_light_factor(nx, ny, nz);
+}
+
+/**
+ * Render triangles with lighting, textures, and MSAA support.
+ *
+ * Args:
+ *   vertices: Float32Array (x,y,z per vertex)
+ *   indices: Uint32Array (3 per triangle)
+ *   mvpMatrix: Float32Array (16 floats)
+ *   colors: Uint8Array (r,g,b per vertex)
+ *   normals: Float32Array (nx,ny,nz per vertex)
+ *   uvs: Float32Array (u,v per vertex) - can be null/empty
+ */
+static napi_value render_triangles_batch(napi_env env, napi_callback_info info) {
+  size_t argc = 6;
+  napi_value args[6];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  if (argc < 5) {
+    napi_throw_error(env, NULL, "Expected at least 5 arguments: vertices, indices, mvp, colors, normals");
+    return NULL;
+  }
+
+  // Immediate vertex arrays are not copied, so they cannot be replayed later
+  if (g_recording) {
+    napi_throw_error(env, NULL, "renderTrianglesBatch cannot be recorded; use createMesh/drawMesh");
+    return NULL;
+  }
+  wait_frame_idle();
+
+  if (!g_framebuffer) {
+    napi_throw_error(env, NULL, "Renderer not initialized");
+    return NULL;
+  }
+
+  // Get typed arrays
+  float* vertices;
+  uint32_t* indices;
+  float* mvp;
+  uint8_t* colors;
+  float* normals;
+  float* uvs = NULL;
+
+  size_t vertex_count, index_count, mvp_len, color_count, normal_count, uv_count = 0;
+  napi_typedarray_type type;
+
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[0], &type, &vertex_count, (void**)&vertices, NULL, NULL));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[1], &type, &index_count, (void**)&indices, NULL, NULL));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[2], &type, &mvp_len, (void**)&mvp, NULL, NULL));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[3], &type, &color_count, (void**)&colors, NULL, NULL));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[4], &type, &normal_count, (void**)&normals, NULL, NULL));
+
+  // UVs are optional (6th argument)
+  if (argc >= 6) {
+    napi_valuetype uv_type;
+    NAPI_CALL(env, napi_typeof(env, args[5], &uv_type));
+    if (uv_type != napi_null && uv_type != napi_undefined) {
+      NAPI_CALL(env, napi_get_typedarray_info(env, args[5], &type, &uv_count, (void**)&uvs, NULL, NULL));
+    }
+  }
+
+  // Only the vertices the indices reference go through the vertex stage (an
+  // immediate batch may draw a slice of a larger vertex array)
+  index_count -= index_count % 3;
+  uint32_t min_index = UINT32_MAX, max_index = 0;
+  for (size_t i = 0; i < index_count; i++) {
+    min_index = MIN(min_index, indices[i]);
+    max_index = MAX(max_index, indices[i]);
+  }
+  if (index_count == 0 || min_index >= vertex_count / 3) {
+    napi_value result;
+    NAPI_CALL(env, napi_create_int32(env, 0, &result));
+    return result;
+  }
+
+  // Setup reads the JS arrays synchronously; only screen-space results outlive this call
+  TriangleSource src = {
+    .fetch = fetch_batch_triangle,
+    .triangle_count = (int)(index_count / 3),
+    .vertex_start = (int)min_index,
+    .vertex_end = (int)MIN((size_t)max_index + 1, vertex_count / 3),
+    .mvp = mvp,
+    .indices = indices,
+    .px = vertices,
+    .py = vertices + 1,
+    .pz = vertices + 2,
+    .position_stride = 3,
+    .uvs = uvs,
+    .uv_count = uvs ? uv_count : 0,
+    .vertices = vertices,
+    .colors = colors,
+    .normals = normals,
+    .normal_count = normal_count,
+  };
+  int rendered = submit_triangles(&src);
+
+  napi_value result;
+  NAPI_CALL(env, napi_create_int32(env, rendered, &result));
+  return result;
+}
+
+// ========================================
+// Resident Mesh Registry
+// ========================================
+
+/**
+ * Mesh stored once in native memory (SoA layout).
+ * Static geometry is uploaded at load time and drawn by handle,
+ * so vertex data never crosses the N-API boundary per frame.
+ */
+typedef struct NativeMesh {
+  int vertex_count;
+  int triangle_count;
+
+  // Per-vertex attributes (SoA, 16-byte aligned)
+  float* px;
+  float* py;
+  float* pz;
+  float* u;
+  float* v;
+  float* lu;              // Lightmap UVs (NULL if the mesh has none)
+  float* lv;
+  uint8_t* r;
+  uint8_t* g;
+  uint8_t* b;
+
+  // Per-triangle data
+  uint32_t* indices;      // 3 per triangle, validated against vertex_count
+  float* face_light;      // Static ambient + directional light (precomputed at upload)
+
+  float bounds[6];        // Local-space AABB: min x/y/z, max x/y/z
+  bool has_uvs;
+  size_t bytes;           // Total native memory held by this mesh
+} NativeMesh;
+
+static NativeMesh** g_meshes = NULL;
+static int g_mesh_capacity = 0;
+static int g_mesh_count = 0;
+static size_t g_mesh_bytes = 0;
+
+// Allocate a 16-byte aligned array (aligned_alloc requires a size multiple of the alignment)
+static void* alloc_aligned(size_t bytes, size_t* total) {
+  size_t size = ALIGN_UP(MAX(bytes, (size_t)1), 16);
+  *total += size;
+  return aligned_alloc(16, size);
+}
+
+static void free_native_mesh(NativeMesh* mesh) {
+  if (!mesh) return;
+  free(mesh->px);
+  free(mesh->py);
+  free(mesh->pz);
+  free(mesh->u);
+  free(mesh->v);
+  free(mesh->r);
+  free(mesh->g);
+  free(mesh->b);
+  free(mesh->indices);
+  free(mesh->lu);
+  free(mesh->lv);
+  free(mesh->face_light);
+  free(mesh);
+}
+
+// Look up a mesh by handle (handles are slot index + 1, 0 is never valid)
+static inline NativeMesh* get_native_mesh(int32_t handle) {
+  if (handle <= 0 || handle > g_mesh_capacity) return NULL;
+  return g_meshes[handle - 1];
+}
+
+// Store mesh in the first free slot, growing the table if needed. Returns handle or 0.
+static int32_t register_native_mesh(NativeMesh* mesh) {
+  for (int i = 0; i < g_mesh_capacity; i++) {
+    if (!g_meshes[i]) {
+      g_meshes[i] = mesh;
+      g_mesh_count++;
+      g_mesh_bytes += mesh->bytes;
+      return i + 1;
+    }
+  }
+
+  int new_capacity = g_mesh_capacity > 0 ? g_mesh_capacity * 2 : 64;
+  NativeMesh** grown = (NativeMesh**)realloc(g_meshes, sizeof(NativeMesh*) * new_capacity);
+  if (!grown) return 0;
+  memset(grown + g_mesh_capacity, 0, sizeof(NativeMesh*) * (new_capacity - g_mesh_capacity));
+
+  int slot = g_mesh_capacity;
+  g_meshes = grown;
+  g_mesh_capacity = new_capacity;
+  g_meshes[slot] = mesh;
+  g_mesh_count++;
+  g_mesh_bytes += mesh->bytes;
+  return slot + 1;
+}
+
+static void destroy_all_meshes(void) {
+  for (int i = 0; i < g_mesh_capacity; i++) {
+    free_native_mesh(g_meshes[i]);
+  }
+  free(g_meshes);
+  g_meshes = NULL;
+  g_mesh_capacity = 0;
+  g_mesh_count = 0;
+  g_mesh_bytes = 0;
+}
+
+/**
+ * Upload a mesh to native memory.
+ *
+ * Args:
+ *   vertices: Float32Array (x,y,z per vertex)
+ *   indices: Uint32Array (3 per triangle)
+ *   colors: Uint8Array (r,g,b per vertex)
+ *   normals: Float32Array (nx,ny,nz per vertex) - may be empty
+ *   uvs: Float32Array (u,v per vertex) - can be null/empty
+ *   lightmapUvs: Float32Array (u,v per vertex into the lightmap atlas) - optional;
+ *     when present, draws with a bound lightmap use it instead of face lighting
+ *
+ * Returns: integer mesh handle (> 0)
+ */
+static napi_value render_create_mesh(napi_env env, napi_callback_info info) {
+  size_t argc = 6;
+  napi_value args[6];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  wait_frame_idle();
+
+  if (argc < 4) {
+    napi_throw_error(env, NULL, "Expected at least 4 arguments: vertices, indices, colors, normals");
+    return NULL;
+  }
+
+  float* vertices;
+  uint32_t* indices;
+  uint8_t* colors;
+  float* normals;
+  float* uvs = NULL;
+  float* lightmap_uvs = NULL;
+
+  size_t vertex_len, index_count, color_len, normal_len, uv_len = 0, lightmap_uv_len = 0;
+  napi_typedarray_type type;
+
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[0], &type, &vertex_len, (void**)&vertices, NULL, NULL));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[1], &type, &index_count, (void**)&indices, NULL, NULL));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[2], &type, &color_len, (void**)&colors, NULL, NULL));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[3], &type, &normal_len, (void**)&normals, NULL, NULL));
+
+  if (argc >= 5) {
+    napi_valuetype uv_type;
+    NAPI_CALL(env, napi_typeof(env, args[4], &uv_type));
+    if (uv_type != napi_null && uv_type != napi_undefined) {
+      NAPI_CALL(env, napi_get_typedarray_info(env, args[4], &type, &uv_len, (void**)&uvs, NULL, NULL));
+    }
+  }
+  if (argc >= 6) {
+    napi_valuetype lm_type;
+    NAPI_CALL(env, napi_typeof(env, args[5], &lm_type));
+    if (lm_type != napi_null && lm_type != napi_undefined) {
+      NAPI_CALL(env, napi_get_typedarray_info(env, args[5], &type, &lightmap_uv_len, (void**)&lightmap_uvs, NULL, NULL));
+    }
+  }
+
+  int vertex_count = (int)(vertex_len / 3);
+  int triangle_count = (int)(index_count / 3);
+
+  // Validate indices once so drawing never needs bounds checks
+  for (size_t i = 0; i < (size_t)triangle_count * 3; i++) {
+    if (indices[i] >= (uint32_t)vertex_count) {
+      napi_throw_range_error(env, NULL, "Mesh index out of range");
+      return NULL;
+    }
+  }
+
+  NativeMesh* mesh = (NativeMesh*)calloc(1, sizeof(NativeMesh));
+  if (!mesh) {
+    napi_throw_error(env, NULL, "Failed to allocate mesh");
+    return NULL;
+  }
+
+  size_t bytes = sizeof(NativeMesh);
+  size_t vf = (size_t)vertex_count * sizeof(float);
+  size_t tf = (size_t)triangle_count * sizeof(float);
+
+  mesh->vertex_count = vertex_count;
+  mesh->triangle_count = triangle_count;
+  mesh->px = (float*)alloc_aligned(vf, &bytes);
+  mesh->py = (float*)alloc_aligned(vf, &bytes);
+  mesh->pz = (float*)alloc_aligned(vf, &bytes);
+  mesh->u = (float*)alloc_aligned(vf, &bytes);
+  mesh->v = (float*)alloc_aligned(vf, &bytes);
+  mesh->r = (uint8_t*)alloc_aligned(vertex_count, &bytes);
+  mesh->g = (uint8_t*)alloc_aligned(vertex_count, &bytes);
+  mesh->b = (uint8_t*)alloc_aligned(vertex_count, &bytes);
+  mesh->indices = (uint32_t*)alloc_aligned((size_t)triangle_count * 3 * sizeof(uint32_t), &bytes);
+  mesh->face_light = (float*)alloc_aligned(tf, &bytes);
+  bool has_lightmap = lightmap_uvs != NULL && lightmap_uv_len >= (size_t)vertex_count * 2;
+  if (has_lightmap) {
+    mesh->lu = (float*)alloc_aligned(vf, &bytes);
+    mesh->lv = (float*)alloc_aligned(vf, &bytes);
+  }
+  mesh->bytes = bytes;
+
+  if (!mesh->px || !mesh->py || !mesh->pz || !mesh->u || !mesh->v ||
+      !mesh->r || !mesh->g || !mesh->b || !mesh->indices || !mesh->face_light ||
+      (has_lightmap && (!mesh->lu || !mesh->lv))) {
+    free_native_mesh(mesh);
+    napi_throw_error(env, NULL, "Failed to allocate mesh");
+    return NULL;
+  }
+
+  // Deinterleave vertex attributes
+  bool has_colors = color_len >= (size_t)vertex_count * 3;
+  mesh->has_uvs = uvs != NULL && uv_len >= (size_t)vertex_count * 2;
+
+  for (int k = 0; k < 3; k++) {
+    mesh->bounds[k] = vertex_count > 0 ? vertices[k] : 0;
+    mesh->bounds[k + 3] = mesh->bounds[k];
+  }
+
+  for (int i = 0; i < vertex_count; i++) {
+    mesh->px[i] = vertices[i * 3];
+    mesh->py[i] = vertices[i * 3 + 1];
+    mesh->pz[i] = vertices[i * 3 + 2];
+
+    for (int k = 0; k < 3; k++) {
+      mesh->bounds[k] = MIN(mesh->bounds[k], vertices[i * 3 + k]);
+      mesh->bounds[k + 3] = MAX(mesh->bounds[k + 3], vertices[i * 3 + k]);
+    }
+
+    if (mesh->has_uvs) {
+      mesh->u[i] = uvs[i * 2];
+      mesh->v[i] = uvs[i * 2 + 1];
+    } else {
+      mesh->u[i] = 0;
+      mesh->v[i] = 0;
+    }
+
+    if (has_lightmap) {
+      mesh->lu[i] = lightmap_uvs[i * 2];
+      mesh->lv[i] = lightmap_uvs[i * 2 + 1];
+    }
+
+    if (has_colors) {
+      mesh->r[i] = colors[i * 3];
+      mesh->g[i] = colors[i * 3 + 1];
+      mesh->b[i] = colors[i * 3 + 2];
+    } else {
+      mesh->r[i] = 200;
+      mesh->g[i] = 200;
+      mesh->b[i] = 200;
+    }
+  }
+
+  memcpy(mesh->indices, indices, (size_t)triangle_count * 3 * sizeof(uint32_t));
+
+  // Precompute static face lighting (same rules as render_triangles_batch)
+  bool has_normals = normal_len >= (size_t)vertex_count * 3;
+  for (int t = 0; t < triangle_count; t++) {
+    uint32_t i0 = indices[t * 3], i1 = indices[t * 3 + 1], i2 = indices[t * 3 + 2];
+    float nx, ny, nz;
+
+    if (has_normals) {
+      nx = (normals[i0 * 3] + normals[i1 * 3] + normals[i2 * 3]) * 0.333333f;
+      ny = (normals[i0 * 3 + 1] + normals[i1 * 3 + 1] + normals[i2 * 3 + 1]) * 0.333333f;
+      nz = (normals[i0 * 3 + 2] + normals[i1 * 3 + 2] + normals[i2 * 3 + 2]) * 0.333333f;
+    } else {
+      float e1x = mesh->px[i1] - mesh->px[i0], e1y = mesh->py[i1] - mesh->py[i0], e1z = mesh->pz[i1] - mesh->pz[i0];
+      float e2x = mesh->px[i2] - mesh->px[i0], e2y = mesh->py[i2] - mesh->py[i0], e2z = mesh->pz[i2] - mesh->pz[i0];
+      nx = e1y * e2z - e1z * e2y;
+      ny = e1z * e2x - e1x * e2z;
+      nz = e1x * e2y - e1y * e2x;
+    }
+    normalize3(&nx, &ny, &nz);
+    mesh->face_light[t] = compute_light_factor(nx, ny, nz);
+  }
+
+  int32_t handle = register_native_mesh(mesh);
+  if (handle == 0) {
+    free_native_mesh(mesh);
+    napi_throw_error(env, NULL, "Failed to register mesh");
+    return NULL;
+  }
+
+  napi_value result;
+  NAPI_CALL(env, napi_create_int32(env, handle, &result));
+  return result;
+}
+
+/**
+ * Free a resident mesh.
+ * Args: handle
+ */
+static napi_value render_destroy_mesh(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  int32_t handle = 0;
+  if (argc >= 1) {
+    NAPI_CALL(env, napi_get_value_int32(env, args[0], &handle));
+  }
+
+  // The frame being recorded may draw it; destroy once that frame has rendered
+  // (the slot stays taken until then, so the handle cannot be reused)
+  if (g_recording && get_native_mesh(handle)) {
+    FrameList* f = g_recording;
+    if (!defer_handle(&f->deferred_meshes, &f->deferred_mesh_count, &f->deferred_mesh_cap, handle)) {
+      napi_throw_error(env, NULL, "Failed to defer mesh destroy");
+      return NULL;
+    }
+  } else {
+    wait_frame_idle();
+    destroy_mesh_now(handle);
+  }
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+static void destroy_mesh_now(int32_t handle) {
+  NativeMesh* mesh = get_native_mesh(handle);
+  if (mesh) {
+    g_mesh_bytes -= mesh->bytes;
+    g_mesh_count--;
+    free_native_mesh(mesh);
+    g_meshes[handle - 1] = NULL;
+  }
+}
+
+// Fetch triangle t's attributes from a resident mesh
+static void fetch_mesh_triangle(const TriangleSource* src, int t, uint32_t i0, uint32_t i1, uint32_t i2,
+                                ClipVert* cv0, ClipVert* cv1, ClipVert* cv2, float* light) {
+  const NativeMesh* mesh = src->mesh;
+
+  cv0->u = mesh->u[i0]; cv0->v = mesh->v[i0];
+  cv1->u = mesh->u[i1]; cv1->v = mesh->v[i1];
+  cv2->u = mesh->u[i2]; cv2->v = mesh->v[i2];
+  cv0->r = mesh->r[i0]; cv0->g = mesh->g[i0]; cv0->b = mesh->b[i0];
+  cv1->r = mesh->r[i1]; cv1->g = mesh->g[i1]; cv1->b = mesh->b[i1];
+  cv2->r = mesh->r[i2]; cv2->g = mesh->g[i2]; cv2->b = mesh->b[i2];
+
+  if (g_draw_lightmap) {
+    // Baked lighting replaces the face term
+    cv0->lu = mesh->lu[i0]; cv0->lv = mesh->lv[i0];
+    cv1->lu = mesh->lu[i1]; cv1->lv = mesh->lv[i1];
+    cv2->lu = mesh->lu[i2]; cv2->lv = mesh->lv[i2];
+    *light = 1.0f;
+  } else {
+    cv0->lu = cv0->lv = cv1->lu = cv1->lv = cv2->lu = cv2->lv = 0;
+    *light = mesh->face_light[t];
+  }
+}
+
+// Set up and bin a resident mesh's triangles
+static int draw_mesh_now(const NativeMesh* mesh, const float* mvp) {
+  TriangleSource src = {
+    .fetch = fetch_mesh_triangle,
+    .triangle_count = mesh->triangle_count,
+    .vertex_start = 0,
+    .vertex_end = mesh->vertex_count,
+    .mvp = mvp,
+    .indices = mesh->indices,
+    .px = mesh->px,
+    .py = mesh->py,
+    .pz = mesh->pz,
+    .position_stride = 1,
+    .uv_count = mesh->has_uvs ? (size_t)mesh->vertex_count * 2 : 0,
+    .mesh = mesh,
+  };
+  g_draw_lightmap = mesh->lu ? g_current_lightmap : NULL;
+  int emitted = submit_triangles(&src);
+  g_draw_lightmap = NULL;
+  return emitted;
+}
+
+/**
+ * Draw a resident mesh with the current texture and options.
+ * Args: handle, mvpMatrix (Float32Array, 16 floats), textureId (optional, binds before drawing)
+ * Returns: number of triangles rendered
+ */
+static napi_value render_draw_mesh(napi_env env, napi_callback_info info) {
+  size_t argc = 3;
+  napi_value args[3];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  if (argc < 2) {
+    napi_throw_error(env, NULL, "Expected 2 arguments: handle, mvp");
+    return NULL;
+  }
+
+  if (!g_framebuffer) {
+    napi_throw_error(env, NULL, "Renderer not initialized");
+    return NULL;
+  }
+
+  int32_t handle;
+  float* mvp;
+  size_t mvp_len;
+  napi_typedarray_type type;
+
+  NAPI_CALL(env, napi_get_value_int32(env, args[0], &handle));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[1], &type, &mvp_len, (void**)&mvp, NULL, NULL));
+
+  NativeMesh* mesh = get_native_mesh(handle);
+  if (!mesh) {
+    napi_throw_error(env, NULL, "Invalid mesh handle");
+    return NULL;
+  }
+  if (mvp_len < 16) {
+    napi_throw_error(env, NULL, "MVP matrix must have 16 elements");
+    return NULL;
+  }
+
+  // Optional per-draw texture id
+  bool has_texture = false;
+  int32_t texture_id = 0;
+  if (argc >= 3) {
+    napi_valuetype tex_type;
+    NAPI_CALL(env, napi_typeof(env, args[2], &tex_type));
+    if (tex_type == napi_number) {
+      NAPI_CALL(env, napi_get_value_int32(env, args[2], &texture_id));
+      has_texture = true;
+    }
+  }
+
+  if (g_recording) {
+    FrameCmd* cmd;
+    if (has_texture) {
+      cmd = record_cmd(FCMD_BIND_TEXTURE);
+      if (!cmd) return recorded_result(env, cmd);
+      cmd->args[0] = texture_id;
+    }
+    // Replayed draws do their own occlusion test (isMeshOccluded can't see the frame yet)
+    cmd = record_cmd(FCMD_DRAW_MESH);
+    if (!cmd) return recorded_result(env, cmd);
+    cmd->args[0] = handle;
+    memcpy(cmd->mvp, mvp, sizeof(cmd->mvp));
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_int32(env, 0, &result));
+    return result;
+  }
+
+  wait_frame_idle();
+  if (has_texture) bind_texture_id(texture_id);
+  int rendered = draw_mesh_now(mesh, mvp);
+
+  napi_value result;
+  NAPI_CALL(env, napi_create_int32(env, rendered, &result));
+  return result;
+}
+
+// ========================================
+// Occlusion Queries
+// ========================================
+
+/**
+ * Test a local-space AABB (min xyz, max xyz) against hi-Z.
+ * Uses the hi-Z from the last tile flush, which is conservative; call
+ * flush() after drawing big occluders for tighter results.
+ */
+static bool aabb_occluded(const float* bounds, const float* mvp) {
+  float sx0 = 1e30f, sy0 = 1e30f, sx1 = -1e30f, sy1 = -1e30f;
+  float min_z = 1e30f;
+  float halfW = g_width * 0.5f, halfH = g_height * 0.5f;
+
+  g_debug_occlusion_tests++;
+
+  for (int c = 0; c < 8; c++) {
+    float cx, cy, cz, cw;
+    transform_vertex(bounds[(c & 1) ? 3 : 0], bounds[(c & 2) ? 4 : 1], bounds[(c & 4) ? 5 : 2],
+                     mvp, &cx, &cy, &cz, &cw);
+
+    // Box crosses the near plane: can't bound it on screen
+    if (cw < NEAR_PLANE) return false;
+
+    float inv_w = 1.0f / cw;
+    float sx = (cx * inv_w + 1) * halfW, sy = (1 - cy * inv_w) * halfH;
+    sx0 = MIN(sx0, sx); sx1 = MAX(sx1, sx);
+    sy0 = MIN(sy0, sy); sy1 = MAX(sy1, sy);
+    min_z = MIN(min_z, cz * inv_w);
+  }
+
+  bool occluded = hiz_rect_occluded((int)floorf(sx0) - 1, (int)floorf(sy0) - 1,
+                                    (int)ceilf(sx1) + 1, (int)ceilf(sy1) + 1, min_z);
+  if (occluded) g_debug_occluded_objects++;
+  return occluded;
+}
+
+/**
+ * Test a bounding box against the hierarchical depth buffer.
+ * Args: bounds (Float32Array[6]: minX, minY, minZ, maxX, maxY, maxZ), mvp (Float32Array[16])
+ * Returns true if the box is certainly hidden behind drawn geometry.
+ */
+static napi_value render_test_occlusion(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value args[2];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  if (argc < 2) {
+    napi_throw_error(env, NULL, "Expected 2 arguments: bounds, mvp");
+    return NULL;
+  }
+
+  float* bounds;
+  float* mvp;
+  size_t bounds_len, mvp_len;
+  napi_typedarray_type type;
+
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[0], &type, &bounds_len, (void**)&bounds, NULL, NULL));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[1], &type, &mvp_len, (void**)&mvp, NULL, NULL));
+
+  if (bounds_len < 6 || mvp_len < 16) {
+    napi_throw_error(env, NULL, "Expected bounds[6] and mvp[16]");
+    return NULL;
+  }
+
+  // While recording, this frame's depth doesn't exist yet: nothing is occluded
+  if (!g_recording) wait_frame_idle();
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_boolean(env, !g_recording && g_framebuffer && aabb_occluded(bounds, mvp), &result));
+  return result;
+}
+
+/**
+ * Test a resident mesh's bounding box against the hierarchical depth buffer.
+ * Args: handle, mvp (Float32Array[16])
+ */
+static napi_value render_is_mesh_occluded(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value args[2];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  if (argc < 2) {
+    napi_throw_error(env, NULL, "Expected 2 arguments: handle, mvp");
+    return NULL;
+  }
+
+  int32_t handle;
+  float* mvp;
+  size_t mvp_len;
+  napi_typedarray_type type;
+
+  NAPI_CALL(env, napi_get_value_int32(env, args[0], &handle));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[1], &type, &mvp_len, (void**)&mvp, NULL, NULL));
+
+  NativeMesh* mesh = get_native_mesh(handle);
+  if (!mesh) {
+    napi_throw_error(env, NULL, "Invalid mesh handle");
+    return NULL;
+  }
+  if (mvp_len < 16) {
+    napi_throw_error(env, NULL, "MVP matrix must have 16 elements");
+    return NULL;
+  }
+
+  if (!g_recording) wait_frame_idle();
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_boolean(env, !g_recording && g_framebuffer && aabb_occluded(mesh->bounds, mvp), &result));
+  return result;
+}
+
+// ============================================================================
+// BSP visibility: leaf tree + decompressed PVS, culled to a list of draw batches
+// ============================================================================
+
+typedef struct {
+  int node_count;
+  float* planes;            // nx, ny, nz, dist per node (engine space)
+  int32_t* children;        // 2 per node (front, back): >= 0 node, < 0 ~leaf
+  int leaf_count;
+  int32_t* leaf_cluster;    // Cluster per leaf, -1 = solid / outside the vis data
+  int cluster_count;
+  int row_bytes;            // Bytes per decompressed PVS row (0 = no PVS)
+  uint8_t* pvs;             // cluster_count rows, bit c set if cluster c is potentially visible
+  int batch_count;
+  float* batch_bounds;      // Engine-space AABB per batch: min x/y/z, max x/y/z
+  int32_t* batch_offsets;   // batch_count + 1 offsets into batch_clusters
+  int32_t* batch_clusters;  // Clusters each batch's faces lie in (empty = always in PVS)
+} VisWorld;
+
+static VisWorld* g_vis = NULL;
+static int g_debug_vis_leaf = -1;           // Camera leaf at the last cullVisible
+static int g_debug_vis_cluster = -1;
+static int g_debug_vis_pvs_culled = 0;      // Batches rejected by the PVS
+static int g_debug_vis_frustum_culled = 0;  // Batches rejected by the frustum
+static int g_debug_vis_visible = 0;
+
+static void free_vis_world(VisWorld* vis) {
+  if (!vis) return;
+  free(vis->planes);
+  free(vis->children);
+  free(vis->leaf_cluster);
+  free(vis->pvs);
+  free(vis->batch_bounds);
+  free(vis->batch_offsets);
+  free(vis->batch_clusters);
+  free(vis);
+}
+
+// Copy a typed array argument into a new allocation; returns element count or -1
+static int copy_typed_array(napi_env env, napi_value value, napi_typedarray_type expected,
+                            size_t element_size, void** out) {
+  napi_typedarray_type type;
+  size_t length;
+  void* data;
+  if (napi_get_typedarray_info(env, value, &type, &length, &data, NULL, NULL) != napi_ok ||
+      type != expected) {
+    return -1;
+  }
+  *out = malloc(MAX(length, (size_t)1) * element_size);
+  if (!*out) return -1;
+  if (length > 0) memcpy(*out, data, length * element_size);
+  return (int)length;
+}
+
+// Walk the node tree to the leaf containing a point (-1 if the tree is empty)
+static int vis_find_leaf(const VisWorld* vis, float x, float y, float z) {
+  if (vis->node_count == 0) return vis->leaf_count > 0 ? 0 : -1;
+  int node = 0;
+  for (int steps = 0; steps < vis->node_count + 1; steps++) {
+    const float* p = &vis->planes[node * 4];
+    float d = p[0] * x + p[1] * y + p[2] * z - p[3];
+    int child = vis->children[node * 2 + (d >= 0 ? 0 : 1)];
+    if (child < 0) {
+      int leaf = ~child;
+      return leaf < vis->leaf_count ? leaf : -1;
+    }
+    if (child >= vis->node_count) return -1;
+    node = child;
+  }
+  return -1;  // Malformed tree (cycle)
+}
+
+// Conservative AABB vs frustum side/far planes (near is implied by the side planes)
+static bool vis_box_outside(const float* planes, int plane_count, const float* b) {
+  for (int i = 0; i < plane_count; i++) {
+    const float* p = &planes[i * 4];
+    // Corner furthest along the plane normal
+    float x = p[0] >= 0 ? b[3] : b[0];
+    float y = p[1] >= 0 ? b[4] : b[1];
+    float z = p[2] >= 0 ? b[5] : b[2];
+    if (p[0] * x + p[1] * y + p[2] * z + p[3] < 0) return true;
+  }
+  return false;
+}
+
+/**
+ * Set the world's visibility data (replaces the previous map's; no arguments clears it).
+ *
+ * Args:
+ *   planes: Float32Array (nx, ny, nz, dist per node, engine space; front is n.p >= dist)
+ *   children: Int32Array (front, back per node; >= 0 node, < 0 ~leaf)
+ *   leafClusters: Int32Array (cluster per leaf, -1 = solid)
+ *   pvs: Uint8Array (decompressed, clusterCount rows of rowBytes) - may be empty
+ *   rowBytes: number
+ *   batchBounds: Float32Array (6 per batch)
+ *   batchOffsets: Int32Array (batchCount + 1)
+ *   batchClusters: Int32Array
+ *
+ * Returns: batch count
+ */
+static napi_value render_set_visibility(napi_env env, napi_callback_info info) {
+  size_t argc = 8;
+  napi_value args[8];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  free_vis_world(g_vis);
+  g_vis = NULL;
+
+  napi_value result;
+  if (argc == 0) {
+    NAPI_CALL(env, napi_create_int32(env, 0, &result));
+    return result;
+  }
+  if (argc < 8) {
+    napi_throw_error(env, NULL, "Expected 8 arguments: planes, children, leafClusters, pvs, rowBytes, batchBounds, batchOffsets, batchClusters");
+    return NULL;
+  }
+
+  VisWorld* vis = (VisWorld*)calloc(1, sizeof(VisWorld));
+  if (!vis) {
+    napi_throw_error(env, NULL, "Failed to allocate visibility data");
+    return NULL;
+  }
+
+  int plane_len = copy_typed_array(env, args[0], napi_float32_array, sizeof(float), (void**)&vis->planes);
+  int child_len = copy_typed_array(env, args[1], napi_int32_array, sizeof(int32_t), (void**)&vis->children);
+  int leaf_len = copy_typed_array(env, args[2], napi_int32_array, sizeof(int32_t), (void**)&vis->leaf_cluster);
+  int pvs_len = copy_typed_array(env, args[3], napi_uint8_array, 1, (void**)&vis->pvs);
+  int32_t row_bytes = 0;
+  NAPI_CALL(env, napi_get_value_int32(env, args[4], &row_bytes));
+  int bounds_len = copy_typed_array(env, args[5], napi_float32_array, sizeof(float), (void**)&vis->batch_bounds);
+  int offset_len = copy_typed_array(env, args[6], napi_int32_array, sizeof(int32_t), (void**)&vis->batch_offsets);
+  int cluster_len = copy_typed_array(env, args[7], napi_int32_array, sizeof(int32_t), (void**)&vis->batch_clusters);
+
+  if (plane_len < 0 || child_len < 0 || leaf_len < 0 || pvs_len < 0 ||
+      bounds_len < 0 || offset_len < 1 || cluster_len < 0 ||
+      plane_len / 4 != child_len / 2 || bounds_len / 6 != offset_len - 1) {
+    free_vis_world(vis);
+    napi_throw_error(env, NULL, "Invalid visibility arrays");
+    return NULL;
+  }
+
+  vis->node_count = plane_len / 4;
+  vis->leaf_count = leaf_len;
+  vis->row_bytes = row_bytes > 0 ? row_bytes : 0;
+  vis->cluster_count = vis->row_bytes > 0 ? pvs_len / vis->row_bytes : 0;
+  vis->batch_count = offset_len - 1;
+
+  // Offsets must stay inside batch_clusters
+  for (int b = 0; b <= vis->batch_count; b++) {
+    int32_t off = vis->batch_offsets[b];
+    if (off < 0 || off > cluster_len || (b > 0 && off < vis->batch_offsets[b - 1])) {
+      free_vis_world(vis);
+      napi_throw_error(env, NULL, "Invalid batch cluster offsets");
+      return NULL;
+    }
+  }
+
+  g_vis = vis;
+  NAPI_CALL(env, napi_create_int32(env, vis->batch_count, &result));
+  return result;
+}
+
+/**
+ * Cull the world's draw batches for a camera.
+ *
+ * Finds the camera's leaf, keeps batches whose clusters are in that cluster's
+ * PVS, then rejects batches outside the view frustum. A camera outside the
+ * vis data (solid leaf, noclip) skips the PVS step.
+ *
+ * Args: x, y, z (camera position), viewProjection (Float32Array[16]), out (Int32Array)
+ * Returns: number of batch indices written to out (ascending)
+ */
+static napi_value render_cull_visible(napi_env env, napi_callback_info info) {
+  size_t argc = 5;
+  napi_value args[5];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  if (argc < 5) {
+    napi_throw_error(env, NULL, "Expected 5 arguments: x, y, z, viewProjection, out");
+    return NULL;
+  }
+
+  double cx, cy, cz;
+  NAPI_CALL(env, napi_get_value_double(env, args[0], &cx));
+  NAPI_CALL(env, napi_get_value_double(env, args[1], &cy));
+  NAPI_CALL(env, napi_get_value_double(env, args[2], &cz));
+
+  float* m;
+  int32_t* out;
+  size_t m_len, out_len;
+  napi_typedarray_type type;
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[3], &type, &m_len, (void**)&m, NULL, NULL));
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[4], &type, &out_len, (void**)&out, NULL, NULL));
+  if (m_len < 16) {
+    napi_throw_error(env, NULL, "viewProjection must have 16 elements");
+    return NULL;
+  }
+
+  napi_value result;
+  const VisWorld* vis = g_vis;
+  if (!vis) {
+    NAPI_CALL(env, napi_create_int32(env, 0, &result));
+    return result;
+  }
+
+  // Frustum planes from the (column-major) view-projection rows: w +/- x, w +/- y
+  // and w - z (far, the same for either depth range)
+  float planes[5 * 4];
+  for (int i = 0; i < 4; i++) {
+    int row = i >> 1;
+    float sign = (i & 1) ? -1.0f : 1.0f;
+    for (int c = 0; c < 4; c++) {
+      planes[i * 4 + c] = m[c * 4 + 3] + sign * m[c * 4 + row];
+    }
+  }
+  for (int c = 0; c < 4; c++) planes[16 + c] = m[c * 4 + 3] - m[c * 4 + 2];
+
+  int leaf = vis_find_leaf(vis, (float)cx, (float)cy, (float)cz);
+  int cluster = leaf >= 0 ? vis->leaf_cluster[leaf] : -1;
+  const uint8_t* row = (cluster >= 0 && cluster < vis->cluster_count)
+    ? vis->pvs + (size_t)cluster * vis->row_bytes
+    : NULL;
+
+  int count = 0, pvs_culled = 0, frustum_culled = 0;
+  for (int b = 0; b < vis->batch_count && (size_t)count < out_len; b++) {
+    if (row) {
+      int first = vis->batch_offsets[b], last = vis->batch_offsets[b + 1];
+      bool potentially_visible = first == last;
+      for (int i = first; i < last && !potentially_visible; i++) {
+        int c = vis->batch_clusters[i];
+        // The camera's own cluster is always visible, even if its PVS bit is clear
+        potentially_visible = c == cluster ||
+          (c >= 0 && c < vis->cluster_count && (row[c >> 3] & (1 << (c & 7))));
+      }
+      if (!potentially_visible) {
+        pvs_culled++;
+        continue;
+      }
+    }
+
+    if (vis_box_outside(planes, 5, &vis->batch_bounds[b * 6])) {
+      frustum_culled++;
+      continue;
+    }
+
+    out[count++] = b;
+  }
+
+  g_debug_vis_leaf = leaf;
+  g_debug_vis_cluster = cluster;
+  g_debug_vis_pvs_culled = pvs_culled;
+  g_debug_vis_frustum_culled = frustum_culled;
+  g_debug_vis_visible = count;
+
+  NAPI_CALL(env, napi_create_int32(env, count, &result));
+  return result;
+}
+
+static void resolve_msaa_now(void) {
+  if (!g_framebuffer) return;
+
+  // Rasterize any binned triangles, then dispatch parallel MSAA resolve
+  flush_tiles();
+  if (g_msaa_samples > 1 && g_msaa_buffer) {
+    uint64_t prof = prof_begin();
+    dispatch_row_work(WORK_MSAA_RESOLVE, 0, 0, 0);
+    prof_end(PROF_MSAA_RESOLVE, prof);
+  }
+  present_scene();
+}
+
+/**
+ * Resolve MSAA samples to framebuffer (parallel).
+ * Also resolves depth buffer (minimum depth across samples) for sprite occlusion.
+ */
+static napi_value render_resolve_msaa(napi_env env, napi_callback_info info) {
+  if (g_recording) return recorded_result(env, record_cmd(FCMD_RESOLVE_MSAA));
+
+  wait_frame_idle();
+  resolve_msaa_now();
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+/**
+ * Rasterize all triangles queued since the last flush.
+ * Reading the framebuffer/depth buffer or resolving MSAA flushes implicitly.
+ */
+static napi_value render_flush(napi_env env, napi_callback_info info) {
+  if (g_recording) return recorded_result(env, record_cmd(FCMD_FLUSH));
+
+  wait_frame_idle();
+  flush_tiles();
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+/**
+ * Get framebuffer as Uint8Array (zero-copy).
+ */
+static napi_value render_get_framebuffer(napi_env env, napi_callback_info info) {
+  if (!g_framebuffer) {
+    napi_throw_error(env, NULL, "Renderer not initialized");
+    return NULL;
+  }
+
+  wait_frame_idle();
+  present_scene();
+
+  size_t byte_length = (size_t)g_width * g_height * 3;
+
+  napi_value array_buffer;
+  NAPI_CALL(env, napi_create_external_arraybuffer(
+    env, g_framebuffer, byte_length, NULL, NULL, &array_buffer
+  ));
+
+  napi_value result;
+  NAPI_CALL(env, napi_create_typedarray(
+    env, napi_uint8_array, byte_length, array_buffer, 0, &result
+  ));
+
+  return result;
+}
+
+/**
+ * Get depth buffer as Float32Array for JS occlusion testing.
+ */
+static napi_value render_get_depth_buffer(napi_env env, napi_callback_info info) {
+  if (!g_depth_buffer) {
+    napi_throw_error(env, NULL, "Renderer not initialized");
+    return NULL;
+  }
+
+  wait_frame_idle();
+  present_scene();
+
+  size_t byte_length = (size_t)g_width * g_height * sizeof(float);
+
+  napi_value array_buffer;
+  NAPI_CALL(env, napi_create_external_arraybuffer(
+    env, g_depth_buffer, byte_length, NULL, NULL, &array_buffer
+  ));
+
+  napi_value result;
+  NAPI_CALL(env, napi_create_typedarray(
+    env, napi_float32_array, (size_t)g_width * g_height, array_buffer, 0, &result
+  ));
+
+  return result;
+}
+
+// ========================================
+// Overlay Compositing
+// ========================================
+
+/*
+ * Glyph layer composed over the resolved scene (HUD text, sprites, tracers,
+ * decals). A cell's bg color is written straight into g_framebuffer and its
+ * code point/fg go into the layer (code point 0 = plain pixel), so the frame
+ * has the same bg/fg/glyph layout as Framebuffer.packCells() and the terminal
+ * encoders read it in place.
+ */
+#define GLYPH_CELL_FLOATS 6   // x, y, depth, codePoint, fg, bg
+#define OVERLAY_CELL_WORDS 4  // pixel index, codePoint, fg, bg
+
+static uint32_t* g_glyphs = NULL;
+static uint8_t* g_glyph_fg = NULL;
+static bool g_glyphs_dirty = false;
+static size_t g_glyph_capacity = 0;
+
+// Empty glyph layer for pixel_count pixels (the arrays are kept when large enough)
+static bool init_glyph_layer(size_t pixel_count) {
+  g_glyphs_dirty = false;
+  if (g_glyphs && g_glyph_fg && pixel_count <= g_glyph_capacity) {
+    // Also clears glyphs a larger frame left past the new size
+    memset(g_glyphs, 0, g_glyph_capacity * sizeof(uint32_t));
+    return true;
+  }
+  free(g_glyphs);
+  free(g_glyph_fg);
+  g_glyphs = (uint32_t*)calloc(pixel_count, sizeof(uint32_t));
+  g_glyph_fg = (uint8_t*)calloc(pixel_count * 3, 1);
+  g_glyph_capacity = g_glyphs && g_glyph_fg ? pixel_count : 0;
+  return g_glyph_capacity > 0;
+}
+
+static void clear_glyph_layer(void) {
+  if (!g_glyphs_dirty) return;
+  memset(g_glyphs, 0, (size_t)g_out_width * g_out_height * sizeof(uint32_t));
+  g_glyphs_dirty = false;
+}
+
+static void free_glyph_layer(void) {
+  free(g_glyphs);
+  free(g_glyph_fg);
+  g_glyphs = NULL;
+  g_glyph_fg = NULL;
+  g_glyphs_dirty = false;
+  g_glyph_capacity = 0;
+}
+
+// NaN check that survives -ffast-math
+static inline bool float_is_nan(float f) {
+  uint32_t bits;
+  memcpy(&bits, &f, sizeof(bits));
+  return (bits & 0x7FFFFFFFu) > 0x7F800000u;
+}
+
+// Depth test matching DepthBuffer.testAndSet(); NaN depth draws untested
+static inline bool overlay_depth_test(size_t i, float z) {
+  if (float_is_nan(z)) return true;
+  if (z < -1.5f || z > 1.5f) return false;
+  if (z < g_depth_buffer[i]) {
+    g_depth_buffer[i] = z;
+    return true;
+  }
+  return false;
+}
+
+// Write one cell; full blocks and spaces are solid pixels (bg color only)
+static inline void put_overlay_cell(size_t i, uint32_t ch, uint32_t fg, uint32_t bg) {
+  uint8_t* px = g_framebuffer + i * 3;
+  px[0] = (uint8_t)(bg >> 16);
+  px[1] = (uint8_t)(bg >> 8);
+  px[2] = (uint8_t)bg;
+
+  if (ch == 0x2588 || ch == ' ') {
+    g_glyphs[i] = 0;
+  } else {
+    uint8_t* f = g_glyph_fg + i * 3;
+    f[0] = (uint8_t)(fg >> 16);
+    f[1] = (uint8_t)(fg >> 8);
+    f[2] = (uint8_t)fg;
+    g_glyphs[i] = ch;
+    g_glyphs_dirty = true;
+  }
+  g_debug_overlay_cells++;
+}
+
+static int draw_glyph_cells(const float* cells, int count) {
+  // Overlays go over the finished scene
+  present_scene();
+
+  int drawn = 0;
+  for (int c = 0; c < count; c++) {
+    const float* cell = cells + (size_t)c * GLYPH_CELL_FLOATS;
+    if (!(cell[0] >= 0 && cell[0] < g_width && cell[1] >= 0 && cell[1] < g_height)) continue;
+
+    size_t i = (size_t)(int)cell[1] * g_width + (int)cell[0];
+    if (!overlay_depth_test(i, cell[2])) continue;
+
+    put_overlay_cell(i, (uint32_t)cell[3], (uint32_t)cell[4], (uint32_t)cell[5]);
+    drawn++;
+  }
+  return drawn;
+}
+
+/**
+ * Draw a batch of depth-tested overlay cells (decals, billboards, tracer
+ * segments, sprites) on top of the scene. Depth writes follow the test, so
+ * later cells behind earlier ones are hidden, as with DepthBuffer.testAndSet().
+ * Args: cells (Float32Array, 6 floats per cell: x, y, depth (NaN = on top),
+ *       codePoint, fg 0xRRGGBB, bg 0xRRGGBB), count
+ * Returns the number of cells drawn (0 while recording a frame).
+ */
+static napi_value render_draw_glyphs(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value args[2];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  if (argc < 2) {
+    napi_throw_error(env, NULL, "Expected 2 arguments: cells, count");
+    return NULL;
+  }
+  if (!g_framebuffer || !g_glyphs) {
+    napi_throw_error(env, NULL, "Renderer not initialized");
+    return NULL;
+  }
+
+  float* cells;
+  size_t cells_len;
+  int32_t count;
+  napi_typedarray_type type;
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[0], &type, &cells_len, (void**)&cells, NULL, NULL));
+  NAPI_CALL(env, napi_get_value_int32(env, args[1], &count));
+
+  if (type != napi_float32_array) {
+    napi_throw_error(env, NULL, "Cells must be a Float32Array");
+    return NULL;
+  }
+  count = (int32_t)MIN((size_t)MAX(count, 0), cells_len / GLYPH_CELL_FLOATS);
+
+  if (g_recording) {
+    FrameCmd* cmd = record_cmd(FCMD_DRAW_GLYPHS);
+    if (cmd) {
+      cmd->args[0] = count;
+      cmd->payload = record_payload(cells, sizeof(float) * GLYPH_CELL_FLOATS * count);
+      if (cmd->payload == SIZE_MAX) cmd = discard_cmd();
+    }
+    if (!cmd) return recorded_result(env, cmd);
+
+    napi_value result;
+    NAPI_CALL(env, napi_create_int32(env, 0, &result));
+    return result;
+  }
+
+  wait_frame_idle();
+  int drawn = draw_glyph_cells(cells, count);
+
+  napi_value result;
+  NAPI_CALL(env, napi_create_int32(env, drawn, &result));
+  return result;
+}
+
+static void composite_cell_words(const uint32_t* cells, int count) {
+  present_scene();
+
+  size_t pixel_count = (size_t)g_width * g_height;
+  for (int c = 0; c < count; c++) {
+    const uint32_t* cell = cells + (size_t)c * OVERLAY_CELL_WORDS;
+    if (cell[0] >= pixel_count) continue;
+    put_overlay_cell(cell[0], cell[1], cell[2], cell[3]);
+  }
+}
+
+/**
+ * Composite screen-space UI cells (no depth test) over the frame, e.g. the
+ * cells of the JS Framebuffer touched by HUD drawing this frame.
+ * Args: cells (Uint32Array, 4 words per cell: pixel index, codePoint,
+ *       fg 0xRRGGBB, bg 0xRRGGBB), count
+ */
+static napi_value render_composite_cells(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value args[2];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  if (argc < 2) {
+    napi_throw_error(env, NULL, "Expected 2 arguments: cells, count");
+    return NULL;
+  }
+  if (!g_framebuffer || !g_glyphs) {
+    napi_throw_error(env, NULL, "Renderer not initialized");
+    return NULL;
+  }
+
+  uint32_t* cells;
+  size_t cells_len;
+  int32_t count;
+  napi_typedarray_type type;
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[0], &type, &cells_len, (void**)&cells, NULL, NULL));
+  NAPI_CALL(env, napi_get_value_int32(env, args[1], &count));
+
+  if (type != napi_uint32_array) {
+    napi_throw_error(env, NULL, "Cells must be a Uint32Array");
+    return NULL;
+  }
+  count = (int32_t)MIN((size_t)MAX(count, 0), cells_len / OVERLAY_CELL_WORDS);
+
+  if (g_recording) {
+    FrameCmd* cmd = record_cmd(FCMD_COMPOSITE_CELLS);
+    if (cmd) {
+      cmd->args[0] = count;
+      cmd->payload = record_payload(cells, sizeof(uint32_t) * OVERLAY_CELL_WORDS * count);
+      if (cmd->payload == SIZE_MAX) cmd = discard_cmd();
+    }
+    return recorded_result(env, cmd);
+  }
+
+  wait_frame_idle();
+  composite_cell_words(cells, count);
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+static void tint_glyph_layer(const int32_t* tint, float t) {
+  if (!g_glyphs || !g_glyphs_dirty) return;
+
+  size_t pixel_count = (size_t)g_out_width * g_out_height;
+  for (size_t i = 0; i < pixel_count; i++) {
+    if (!g_glyphs[i]) continue;
+    uint8_t* f = g_glyph_fg + i * 3;
+    for (int c = 0; c < 3; c++) {
+      f[c] = (uint8_t)CLAMP(lroundf(f[c] + (tint[c] - f[c]) * t), 0, 255);
+    }
+  }
+}
+
+/**
+ * Blend the fg color of every glyph cell toward a tint (death fade).
+ * Args: r, g, b, amount (0-1)
+ */
+static napi_value render_tint_glyphs(napi_env env, napi_callback_info info) {
+  size_t argc = 4;
+  napi_value args[4];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  if (argc < 4) {
+    napi_throw_error(env, NULL, "Expected 4 arguments: r, g, b, amount");
+    return NULL;
+  }
+
+  int32_t tint[3];
+  double amount;
+  NAPI_CALL(env, napi_get_value_int32(env, args[0], &tint[0]));
+  NAPI_CALL(env, napi_get_value_int32(env, args[1], &tint[1]));
+  NAPI_CALL(env, napi_get_value_int32(env, args[2], &tint[2]));
+  NAPI_CALL(env, napi_get_value_double(env, args[3], &amount));
+
+  if (g_recording) {
+    FrameCmd* cmd = record_cmd(FCMD_TINT_GLYPHS);
+    if (cmd) {
+      memcpy(cmd->args, tint, sizeof(tint));
+      cmd->amount = (float)amount;
+    }
+    return recorded_result(env, cmd);
+  }
+
+  wait_frame_idle();
+  tint_glyph_layer(tint, (float)amount);
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+// ========================================
+// Terminal Encoding
+// ========================================
+
+/*
+ * Escape streams are written into a caller-owned Buffer. If it is too small
+ * the writer keeps counting without storing, and the call returns the negated
+ * required size so the caller can grow the buffer and retry.
+ */
+typedef struct {
+  uint8_t* data;
+  size_t cap;
+  size_t len;
+} ByteWriter;
+
+static inline void bw_bytes(ByteWriter* w, const char* s, size_t n) {
+  if (w->len + n <= w->cap) memcpy(w->data + w->len, s, n);
+  w->len += n;
+}
+
+static inline void bw_byte(ByteWriter* w, char c) {
+  if (w->len < w->cap) w->data[w->len] = (uint8_t)c;
+  w->len++;
+}
+
+static inline void bw_uint(ByteWriter* w, unsigned v) {
+  char tmp[10];
+  int n = 0;
+  do {
+    tmp[n++] = (char)('0' + v % 10);
+    v /= 10;
+  } while (v);
+  while (n) bw_byte(w, tmp[--n]);
+}
+
+// UTF-8 encode one code point
+static inline void bw_utf8(ByteWriter* w, uint32_t cp) {
+  if (cp < 0x80) {
+    bw_byte(w, (char)cp);
+  } else if (cp < 0x800) {
+    bw_byte(w, (char)(0xC0 | (cp >> 6)));
+    bw_byte(w, (char)(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    bw_byte(w, (char)(0xE0 | (cp >> 12)));
+    bw_byte(w, (char)(0x80 | ((cp >> 6) & 0x3F)));
+    bw_byte(w, (char)(0x80 | (cp & 0x3F)));
+  } else {
+    bw_byte(w, (char)(0xF0 | (cp >> 18)));
+    bw_byte(w, (char)(0x80 | ((cp >> 12) & 0x3F)));
+    bw_byte(w, (char)(0x80 | ((cp >> 6) & 0x3F)));
+    bw_byte(w, (char)(0x80 | (cp & 0x3F)));
+  }
+}
+
+// Emit truecolor SGR: ESC[38;2;r;g;bm (fg) or ESC[48;2;r;g;bm (bg)
+static inline void bw_sgr_rgb(ByteWriter* w, bool background, const uint8_t* rgb) {
+  bw_bytes(w, background ? "\x1b[48;2;" : "\x1b[38;2;", 7);
+  bw_uint(w, rgb[0]); bw_byte(w, ';');
+  bw_uint(w, rgb[1]); bw_byte(w, ';');
+  bw_uint(w, rgb[2]); bw_byte(w, 'm');
+}
+
+static napi_value make_encode_result(napi_env env, const ByteWriter* w) {
+  napi_value result;
+  double n = w->len <= w->cap ? (double)w->len : -(double)w->len;
+  NAPI_CALL(env, napi_create_double(env, n, &result));
+  return result;
+}
+
+// Fetch a Buffer/Uint8Array argument (NULL data if null/undefined)
+static bool get_byte_arg(napi_env env, napi_value arg, uint8_t** data, size_t* len) {
+  napi_valuetype vt;
+  *data = NULL;
+  *len = 0;
+  if (napi_typeof(env, arg, &vt) != napi_ok) return false;
+  if (vt == napi_null || vt == napi_undefined) return true;
+
+  bool is_buffer = false;
+  napi_is_buffer(env, arg, &is_buffer);
+  if (is_buffer) {
+    return napi_get_buffer_info(env, arg, (void**)data, len) == napi_ok;
+  }
+
+  napi_typedarray_type type;
+  return napi_get_typedarray_info(env, arg, &type, len, (void**)data, NULL, NULL) == napi_ok;
+}
+
+// Encoder bandwidth counters (across all encoders, not reset per frame)
+static int g_encode_frames = 0;
+static int g_encode_last_bytes = 0;
+static int g_encode_last_full_bytes = 0;     // What a full redraw would have cost
+static int g_encode_last_changed_cells = 0;
+static int g_encode_last_total_cells = 0;
+static int g_encode_full_redraws = 0;
+static double g_encode_total_bytes = 0;
+static double g_encode_total_full_bytes = 0;
+
+static void record_encode(size_t bytes, size_t full_bytes, int changed, int total, bool full) {
+  g_encode_frames++;
+  g_encode_last_bytes = (int)bytes;
+  g_encode_last_full_bytes = (int)full_bytes;
+  g_encode_last_changed_cells = changed;
+  g_encode_last_total_cells = total;
+  if (full) g_encode_full_redraws++;
+  g_encode_total_bytes += (double)bytes;
+  g_encode_total_full_bytes += (double)full_bytes;
+}
+
+// Half-block encoder input (cell arrays from Framebuffer.packCells())
+typedef struct {
+  uint8_t* out;
+  size_t out_len;
+  int width, height;           // In pixels (two pixel rows per terminal row)
+  const uint8_t* bg;
+  const uint8_t* fg;           // NULL = all solid
+  const uint32_t* glyphs;      // NULL = all solid
+} HalfBlockInput;
+
+/**
+ * Logical terminal cell. Solid cells (ch == 0) hold top/bottom pixel colors in
+ * a/b; text cells hold the code point with fg in a and bg in b.
+ */
+typedef struct {
+  uint32_t ch;
+  uint8_t a[3];
+  uint8_t b[3];
+} TermCell;
+
+// Encoder input reading the natively composed frame in place
+static void native_frame_input(HalfBlockInput* in) {
+  present_scene();
+  in->width = g_width;
+  in->height = g_height;
+  in->bg = g_framebuffer;
+  in->fg = g_glyph_fg;
+  in->glyphs = g_glyphs;
+}
+
+// Args: out, width, height, bg, fg?, glyphs? (bg null = native composed frame)
+static bool parse_half_block_args(napi_env env, napi_callback_info info, HalfBlockInput* in) {
+  size_t argc = 6;
+  napi_value args[6];
+  if (napi_get_cb_info(env, info, &argc, args, NULL, NULL) != napi_ok) return false;
+
+  wait_frame_idle();
 
-    // Find intersection points
-    float t1 = (NEAR_PLANE - vi->cw) / (vo1->cw - vi->cw);
-    float t2 = (NEAR_PLANE - vi->cw) / (vo2->cw - vi->cw);
+  if (argc < 4) {
+    napi_throw_error(env, NULL, "Expected at least 4 arguments: out, width, height, bg");
+    return false;
+  }
 
-    ClipVert new_v1 = lerp_clip_vert(vi, vo1, t1);
-    ClipVert new_v2 = lerp_clip_vert(vi, vo2, t2);
+  uint8_t* bg;
+  uint8_t* fg = NULL;
+  uint8_t* glyph_bytes = NULL;
+  size_t bg_len, fg_len = 0, glyph_len = 0;
+  int32_t width, height;
+
+  if (napi_get_value_int32(env, args[1], &width) != napi_ok ||
+      napi_get_value_int32(env, args[2], &height) != napi_ok ||
+      !get_byte_arg(env, args[0], &in->out, &in->out_len) || !get_byte_arg(env, args[3], &bg, &bg_len) ||
+      (argc >= 5 && !get_byte_arg(env, args[4], &fg, &fg_len)) ||
+      (argc >= 6 && !get_byte_arg(env, args[5], &glyph_bytes, &glyph_len))) {
+    napi_throw_error(env, NULL, "Invalid buffer argument");
+    return false;
+  }
 
-    out_tris[0] = *vi;
-    out_tris[1] = new_v1;
-    out_tris[2] = new_v2;
-    return 1;
+  if (!bg && in->out) {
+    // No cell arrays: encode the natively composed frame (scene + glyph layer)
+    if (!g_framebuffer || !g_glyphs || width != g_out_width || height != g_out_height) {
+      napi_throw_error(env, NULL, "Native frame size mismatch");
+      return false;
+    }
+    native_frame_input(in);
+    return true;
   }
 
-  // Two vertices inside, one outside - creates two triangles (quad)
-  const ClipVert *vi0, *vi1, *vo;
-  if (!inside0) { vo = v0; vi0 = v1; vi1 = v2; }
-  else if (!inside1) { vo = v1; vi0 = v2; vi1 = v0; }
-  else { vo = v2; vi0 = v0; vi1 = v1; }
+  size_t cells = (size_t)MAX(width, 0) * MAX(height, 0);
+  if (!in->out || !bg || bg_len < cells * 3 || (fg && fg_len < cells * 3) ||
+      (glyph_bytes && glyph_len < cells * sizeof(uint32_t))) {
+    napi_throw_error(env, NULL, "Buffer too small for width x height");
+    return false;
+  }
 
-  // Find intersection points on edges from inside vertices to outside vertex
-  float t0 = (NEAR_PLANE - vi0->cw) / (vo->cw - vi0->cw);
-  float t1 = (NEAR_PLANE - vi1->cw) / (vo->cw - vi1->cw);
+  in->width = MAX(width, 0);
+  in->height = MAX(height, 0);
+  in->bg = bg;
+  in->fg = fg;
+  in->glyphs = (const uint32_t*)glyph_bytes;
+  return true;
+}
 
-  ClipVert new_v0 = lerp_clip_vert(vi0, vo, t0);
-  ClipVert new_v1 = lerp_clip_vert(vi1, vo, t1);
+// Resolve terminal cell (x, row) from its top and bottom pixels
+static inline void resolve_term_cell(const HalfBlockInput* in, int x, int row, TermCell* cell) {
+  size_t top = (size_t)row * 2 * in->width + x;
+  size_t bottom = (row * 2 + 1 < in->height) ? top + in->width : top;
+  uint32_t top_glyph = in->glyphs ? in->glyphs[top] : 0;
+  uint32_t bottom_glyph = in->glyphs ? in->glyphs[bottom] : 0;
+
+  if (top_glyph || bottom_glyph) {
+    // Text or box-drawing character: full cell with its own colors
+    size_t i = top_glyph ? top : bottom;
+    const uint8_t* fg = in->fg ? in->fg + i * 3 : in->bg + i * 3;
+    cell->ch = top_glyph ? top_glyph : bottom_glyph;
+    memcpy(cell->a, fg, 3);
+    memcpy(cell->b, in->bg + i * 3, 3);
+  } else {
+    cell->ch = 0;
+    memcpy(cell->a, in->bg + top * 3, 3);
+    memcpy(cell->b, in->bg + bottom * 3, 3);
+  }
+}
 
-  // First triangle: vi0, vi1, new_v1
-  out_tris[0] = *vi0;
-  out_tris[1] = *vi1;
-  out_tris[2] = new_v1;
+static inline int digit_count(unsigned v) {
+  return v >= 100 ? 3 : v >= 10 ? 2 : 1;
+}
 
-  // Second triangle: vi0, new_v1, new_v0
-  out_tris[3] = *vi0;
-  out_tris[4] = new_v1;
-  out_tris[5] = new_v0;
+// Length of ESC[38;2;r;g;bm / ESC[48;2;r;g;bm
+static inline int sgr_rgb_len(const uint8_t* rgb) {
+  return 10 + digit_count(rgb[0]) + digit_count(rgb[1]) + digit_count(rgb[2]);
+}
 
-  return 2;
+static inline int utf8_len(uint32_t cp) {
+  return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
 }
 
-/**
- * Rasterize textured triangle to a specific buffer.
- */
-static inline void rasterize_triangle_textured(
-    float x0, float y0, float z0, float w0, float u0, float v0,
-    float x1, float y1, float z1, float w1, float u1, float v1,
-    float x2, float y2, float z2, float w2, float u2, float v2,
-    uint8_t base_r, uint8_t base_g, uint8_t base_b,
-    float light_factor,
-    uint8_t* __restrict color_buf,
-    float* __restrict depth_buf,
-    int stride
-) {
-  // Bounding box
-  int minX = (int)floorf(MIN(MIN(x0, x1), x2));
-  int maxX = (int)ceilf(MAX(MAX(x0, x1), x2));
-  int minY = (int)floorf(MIN(MIN(y0, y1), y2));
-  int maxY = (int)ceilf(MAX(MAX(y0, y1), y2));
-
-  // Clip to screen
-  minX = MAX(minX, 0);
-  minY = MAX(minY, 0);
-  maxX = MIN(maxX, g_width - 1);
-  maxY = MIN(maxY, g_height - 1);
+static void encode_half_block(const HalfBlockInput* in, ByteWriter* w) {
+  int rows = (in->height + 1) / 2;
+  bool have_color = false;
+  uint8_t cur_fg[3], cur_bg[3];
 
-  // Edge equations
-  float dx01 = x1 - x0, dy01 = y1 - y0;
-  float dx12 = x2 - x1, dy12 = y2 - y1;
-  float dx20 = x0 - x2, dy20 = y0 - y2;
+  bw_bytes(w, "\x1b[H", 3);
 
-  // Triangle area (2x)
-  float area = dx01 * (y2 - y0) - dy01 * (x2 - x0);
-  if (fabsf(area) < 0.0001f) {
-    g_debug_degenerate++;
-    return;
-  }
-  float invArea = 1.0f / area;
+  for (int row = 0; row < rows; row++) {
+    if (row > 0) bw_byte(w, '\n');
 
-  // Precompute 1/w for perspective-correct interpolation
-  float inv_w0 = 1.0f / w0;
-  float inv_w1 = 1.0f / w1;
-  float inv_w2 = 1.0f / w2;
+    for (int x = 0; x < in->width; x++) {
+      TermCell cell;
+      resolve_term_cell(in, x, row, &cell);
 
-  // Perspective-correct UV divided by w
-  float u0_w = u0 * inv_w0, v0_w = v0 * inv_w0;
-  float u1_w = u1 * inv_w1, v1_w = v1 * inv_w1;
-  float u2_w = u2 * inv_w2, v2_w = v2 * inv_w2;
+      // Only emit color codes when they change
+      if (!have_color || memcmp(cell.a, cur_fg, 3) != 0 || memcmp(cell.b, cur_bg, 3) != 0) {
+        bw_sgr_rgb(w, false, cell.a);
+        bw_sgr_rgb(w, true, cell.b);
+        memcpy(cur_fg, cell.a, 3);
+        memcpy(cur_bg, cell.b, 3);
+        have_color = true;
+      }
 
-  bool use_texture = g_enable_textures && g_current_texture != NULL;
+      // Upper half block: fg = top pixel, bg = bottom pixel
+      bw_utf8(w, cell.ch ? cell.ch : 0x2580);
+    }
+  }
 
-  // Rasterize
-  for (int py = minY; py <= maxY; py++) {
-    float fy = py + 0.5f;
-    int row_start = py * stride;
+  bw_bytes(w, "\x1b[0m", 4);
+  if (w->len <= w->cap) {
+    record_encode(w->len, w->len, in->width * rows, in->width * rows, true);
+  }
+}
 
-    for (int px = minX; px <= maxX; px++) {
-      float fx = px + 0.5f;
+/**
+ * Encode cells as half-block ANSI (two pixel rows per terminal row), matching
+ * Framebuffer.toHalfBlockAnsiString().
+ * Args: out (Buffer), width, height, bg (RGB per cell), fg (RGB per cell or null),
+ *       glyphs (Uint32Array code points, 0 = solid pixel, or null)
+ *       Pass bg = null to encode the natively composed frame (scene + glyph layer).
+ * Returns bytes written, or -(bytes needed) if out is too small.
+ */
+static napi_value render_encode_half_block(napi_env env, napi_callback_info info) {
+  HalfBlockInput in;
+  if (!parse_half_block_args(env, info, &in)) return NULL;
 
-      // Edge functions
-      float e0 = dx12 * (fy - y1) - dy12 * (fx - x1);
-      float e1 = dx20 * (fy - y2) - dy20 * (fx - x2);
-      float e2 = dx01 * (fy - y0) - dy01 * (fx - x0);
+  ByteWriter w = { in.out, in.out_len, 0 };
+  encode_half_block(&in, &w);
+  return make_encode_result(env, &w);
+}
 
-      // Inside test
-      if (e0 >= -0.001f && e1 >= -0.001f && e2 >= -0.001f) {
-        // Barycentric coordinates
-        float bary0 = e0 * invArea;
-        float bary1 = e1 * invArea;
-        float bary2 = 1.0f - bary0 - bary1;
+// Previous frame's cells for the diff encoder
+static TermCell* g_prev_cells = NULL;
+static int g_prev_cells_w = 0;
+static int g_prev_cells_rows = 0;
+static bool g_prev_cells_valid = false;
+static uint64_t g_sixel_frame_hash = 0;  // Last native frame sent as Sixel
+static bool g_sixel_frame_valid = false;
 
-        // Interpolate depth (bary0 weights v0, bary1 weights v1, bary2 weights v2)
-        float depth = bary0 * z0 + bary1 * z1 + bary2 * z2;
+// Terminal SGR state while encoding a diff
+typedef struct {
+  bool fg_known, bg_known;
+  uint8_t fg[3], bg[3];
+} SgrState;
+
+// Set fg and/or bg, combining both into one sequence when both change
+static void bw_set_colors(ByteWriter* w, SgrState* st, const uint8_t* fg, const uint8_t* bg) {
+  bool set_fg = fg && (!st->fg_known || memcmp(st->fg, fg, 3) != 0);
+  bool set_bg = bg && (!st->bg_known || memcmp(st->bg, bg, 3) != 0);
+  if (!set_fg && !set_bg) return;
+
+  bw_bytes(w, "\x1b[", 2);
+  if (set_fg) {
+    bw_bytes(w, "38;2;", 5);
+    bw_uint(w, fg[0]); bw_byte(w, ';'); bw_uint(w, fg[1]); bw_byte(w, ';'); bw_uint(w, fg[2]);
+    memcpy(st->fg, fg, 3);
+    st->fg_known = true;
+  }
+  if (set_bg) {
+    bw_bytes(w, set_fg ? ";48;2;" : "48;2;", set_fg ? 6 : 5);
+    bw_uint(w, bg[0]); bw_byte(w, ';'); bw_uint(w, bg[1]); bw_byte(w, ';'); bw_uint(w, bg[2]);
+    memcpy(st->bg, bg, 3);
+    st->bg_known = true;
+  }
+  bw_byte(w, 'm');
+}
 
-        // Depth test
-        size_t idx = row_start + px;
-        if (depth < depth_buf[idx]) {
-          depth_buf[idx] = depth;
+static inline bool sgr_is(bool known, const uint8_t* cur, const uint8_t* rgb) {
+  return known && memcmp(cur, rgb, 3) == 0;
+}
 
-          uint8_t final_r, final_g, final_b;
+/**
+ * Emit one cell, picking the glyph that reuses the current colors where it can:
+ * a solid color can be ' ' (bg) or full block (fg), and a two-color cell can be
+ * upper or lower half block depending on which color is already set.
+ */
+static void bw_term_cell(ByteWriter* w, SgrState* st, const TermCell* cell) {
+  if (cell->ch) {
+    bw_set_colors(w, st, cell->a, cell->b);
+    bw_utf8(w, cell->ch);
+    return;
+  }
 
-          if (use_texture) {
-            // Perspective-correct UV interpolation
-            float interp_inv_w = bary0 * inv_w0 + bary1 * inv_w1 + bary2 * inv_w2;
-            float interp_u_w = bary0 * u0_w + bary1 * u1_w + bary2 * u2_w;
-            float interp_v_w = bary0 * v0_w + bary1 * v1_w + bary2 * v2_w;
+  const uint8_t* top = cell->a;
+  const uint8_t* bottom = cell->b;
+  bool fg_top = sgr_is(st->fg_known, st->fg, top), bg_top = sgr_is(st->bg_known, st->bg, top);
+  bool fg_bottom = sgr_is(st->fg_known, st->fg, bottom);
+
+  if (memcmp(top, bottom, 3) == 0) {
+    if (bg_top) { bw_byte(w, ' '); return; }
+    if (fg_top) { bw_utf8(w, 0x2588); return; }
+    bw_set_colors(w, st, NULL, top);
+    bw_byte(w, ' ');
+  } else if (fg_bottom || bg_top) {
+    // Lower half block: fg = bottom pixel, bg = top pixel
+    bw_set_colors(w, st, bottom, top);
+    bw_utf8(w, 0x2584);
+  } else {
+    bw_set_colors(w, st, top, bottom);
+    bw_utf8(w, 0x2580);
+  }
+}
 
-            float u = interp_u_w / interp_inv_w;
-            float v = interp_v_w / interp_inv_w;
+static inline bool term_cell_equal(const TermCell* a, const TermCell* b) {
+  return a->ch == b->ch && memcmp(a->a, b->a, 3) == 0 && memcmp(a->b, b->b, 3) == 0;
+}
 
-            uint8_t tex_r, tex_g, tex_b;
-            sample_texture(u, v, &tex_r, &tex_g, &tex_b);
+// Wide (2-column) glyphs would desync our cursor tracking
+static inline bool glyph_may_be_wide(uint32_t ch) {
+  return ch >= 0x1100;
+}
 
-            // Apply lighting to texture color
-            final_r = (uint8_t)CLAMP(tex_r * light_factor, 0, 255);
-            final_g = (uint8_t)CLAMP(tex_g * light_factor, 0, 255);
-            final_b = (uint8_t)CLAMP(tex_b * light_factor, 0, 255);
-          } else {
-            // Use base color with lighting
-            final_r = (uint8_t)CLAMP(base_r * light_factor, 0, 255);
-            final_g = (uint8_t)CLAMP(base_g * light_factor, 0, 255);
-            final_b = (uint8_t)CLAMP(base_b * light_factor, 0, 255);
+/**
+ * Encode only the cells that changed since the previous call, as half-block
+ * ANSI. Unchanged gaps are either skipped with a cursor move or re-sent,
+ * whichever is shorter, and color changes are coalesced.
+ * The first frame, a size change or resetEncoder() sends every cell.
+ * Args: same as encodeHalfBlock
+ * Returns bytes written (0 if nothing changed), or -(bytes needed) if out is
+ * too small (the previous frame is kept, so the retry sends the same diff).
+ */
+static bool encode_half_block_diff(const HalfBlockInput* in, ByteWriter* w) {
+  int rows = (in->height + 1) / 2;
+  int total = in->width * rows;
+  bool full = !g_prev_cells_valid || g_prev_cells_w != in->width || g_prev_cells_rows != rows;
+
+  if (full && (g_prev_cells_w * g_prev_cells_rows != total || !g_prev_cells)) {
+    TermCell* grown = (TermCell*)realloc(g_prev_cells, sizeof(TermCell) * MAX(total, 1));
+    if (!grown) return false;
+    g_prev_cells = grown;
+  }
+
+  SgrState st = {0};
+  size_t full_bytes = 3 + 4 + (rows > 0 ? rows - 1 : 0);
+  bool have_full_color = false;
+  uint8_t full_fg[3] = {0}, full_bg[3] = {0};
+  int changed = 0;
+
+  for (int row = 0; row < rows; row++) {
+    int cursor_x = -1;  // Column the terminal cursor is at on this row (-1 = unknown)
+
+    for (int x = 0; x < in->width; x++) {
+      TermCell cell;
+      resolve_term_cell(in, x, row, &cell);
+      const TermCell* prev = &g_prev_cells[row * in->width + x];
+
+      // Cost of the same frame through the full encoder (for savings stats)
+      if (!have_full_color || memcmp(cell.a, full_fg, 3) != 0 || memcmp(cell.b, full_bg, 3) != 0) {
+        full_bytes += sgr_rgb_len(cell.a) + sgr_rgb_len(cell.b);
+        memcpy(full_fg, cell.a, 3);
+        memcpy(full_bg, cell.b, 3);
+        have_full_color = true;
+      }
+      full_bytes += utf8_len(cell.ch ? cell.ch : 0x2580);
+
+      if (!full && term_cell_equal(&cell, prev)) continue;
+      changed++;
+
+      if (cursor_x != x) {
+        int gap = x - cursor_x;
+        int jump_len = 4 + digit_count(row + 1) + digit_count(x + 1);  // ESC[r;cH
+        int forward_len = 3 + (gap > 1 ? digit_count(gap) : 0);             // ESC[nC
+
+        // Re-sending a short unchanged gap can be cheaper than moving the cursor
+        int move_len = cursor_x >= 0 ? MIN(jump_len, forward_len) : jump_len;
+        bool resent = false;
+        if (cursor_x >= 0 && gap <= move_len) {
+          ByteWriter probe = { NULL, 0, 0 };
+          SgrState probe_st = st;
+          for (int gx = cursor_x; gx < x; gx++) {
+            bw_term_cell(&probe, &probe_st, &g_prev_cells[row * in->width + gx]);
           }
+          if ((int)probe.len <= move_len) {
+            for (int gx = cursor_x; gx < x; gx++) {
+              bw_term_cell(w, &st, &g_prev_cells[row * in->width + gx]);
+            }
+            resent = true;
+          }
+        }
 
-          color_buf[idx * 3] = final_r;
-          color_buf[idx * 3 + 1] = final_g;
-          color_buf[idx * 3 + 2] = final_b;
+        if (!resent) {
+          if (cursor_x >= 0 && forward_len < jump_len) {
+            bw_bytes(w, "\x1b[", 2);
+            if (gap > 1) bw_uint(w, gap);
+            bw_byte(w, 'C');
+          } else {
+            bw_bytes(w, "\x1b[", 2);
+            bw_uint(w, row + 1); bw_byte(w, ';'); bw_uint(w, x + 1);
+            bw_byte(w, 'H');
+          }
         }
       }
+
+      bw_term_cell(w, &st, &cell);
+      cursor_x = (cell.ch && glyph_may_be_wide(cell.ch)) || x + 1 >= in->width ? -1 : x + 1;
+    }
+  }
+
+  if (w->len > 0) bw_bytes(w, "\x1b[0m", 4);
+
+  // Out of space: keep the previous frame so the retry produces this diff again
+  if (w->len > w->cap) return true;
+
+  for (int row = 0; row < rows; row++) {
+    for (int x = 0; x < in->width; x++) {
+      resolve_term_cell(in, x, row, &g_prev_cells[row * in->width + x]);
     }
   }
+  g_prev_cells_w = in->width;
+  g_prev_cells_rows = rows;
+  g_prev_cells_valid = true;
+
+  record_encode(w->len, full_bytes, changed, total, full);
+  return true;
+}
+
+static napi_value render_encode_half_block_diff(napi_env env, napi_callback_info info) {
+  HalfBlockInput in;
+  if (!parse_half_block_args(env, info, &in)) return NULL;
+
+  ByteWriter w = { in.out, in.out_len, 0 };
+  if (!encode_half_block_diff(&in, &w)) {
+    napi_throw_error(env, NULL, "Failed to allocate encoder state");
+    return NULL;
+  }
+  return make_encode_result(env, &w);
 }
 
 /**
- * Process a single clipped triangle through perspective divide, culling, and rasterization.
- * Returns 1 if rendered, 0 if culled.
+ * Forget the previous frame so the next encodeHalfBlockDiff() redraws every
+ * cell and the next native-frame encodeSixel() is sent even if unchanged
+ * (call after the screen was cleared or written to by something else).
  */
-static int process_clipped_triangle(
-    const ClipVert* cv0, const ClipVert* cv1, const ClipVert* cv2,
-    float light_factor,
-    float halfW, float halfH
-) {
-  // Perspective divide
-  float ndcX0 = cv0->cx / cv0->cw, ndcY0 = cv0->cy / cv0->cw, ndcZ0 = cv0->cz / cv0->cw;
-  float ndcX1 = cv1->cx / cv1->cw, ndcY1 = cv1->cy / cv1->cw, ndcZ1 = cv1->cz / cv1->cw;
-  float ndcX2 = cv2->cx / cv2->cw, ndcY2 = cv2->cy / cv2->cw, ndcZ2 = cv2->cz / cv2->cw;
+static napi_value render_reset_encoder(napi_env env, napi_callback_info info) {
+  wait_frame_idle();
+  g_prev_cells_valid = false;
+  g_sixel_frame_valid = false;
 
-  // Frustum cull (only cull if ALL vertices are on same side)
-  if ((ndcX0 < -1 && ndcX1 < -1 && ndcX2 < -1) ||
-      (ndcX0 > 1 && ndcX1 > 1 && ndcX2 > 1) ||
-      (ndcY0 < -1 && ndcY1 < -1 && ndcY2 < -1) ||
-      (ndcY0 > 1 && ndcY1 > 1 && ndcY2 > 1)) {
-    g_debug_frustum_culled++;
-    return 0;
-  }
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+/**
+ * Get terminal encoder bandwidth stats.
+ */
+static napi_value render_get_encode_stats(napi_env env, napi_callback_info info) {
+  napi_value result, v;
+  NAPI_CALL(env, napi_create_object(env, &result));
 
-  // Screen space coordinates
-  float sx0 = (ndcX0 + 1) * halfW, sy0 = (1 - ndcY0) * halfH;
-  float sx1 = (ndcX1 + 1) * halfW, sy1 = (1 - ndcY1) * halfH;
-  float sx2 = (ndcX2 + 1) * halfW, sy2 = (1 - ndcY2) * halfH;
+  NAPI_CALL(env, napi_create_int32(env, g_encode_frames, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "frames", v));
 
-  // Compute signed area for winding check
-  float signed_area = (sx1 - sx0) * (sy2 - sy0) - (sx2 - sx0) * (sy1 - sy0);
+  NAPI_CALL(env, napi_create_int32(env, g_encode_last_bytes, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lastBytes", v));
 
-  // Backface culling
-  if (g_enable_backface_culling && signed_area < 0) {
-    g_debug_backface_culled++;
-    return 0;
+  NAPI_CALL(env, napi_create_int32(env, g_encode_last_full_bytes, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lastFullBytes", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_encode_last_changed_cells, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lastChangedCells", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_encode_last_total_cells, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "lastTotalCells", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_encode_full_redraws, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "fullRedraws", v));
+
+  NAPI_CALL(env, napi_create_double(env, g_encode_total_bytes, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "totalBytes", v));
+
+  NAPI_CALL(env, napi_create_double(env, g_encode_total_full_bytes, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "totalFullBytes", v));
+
+  return result;
+}
+
+// Sixel palette limit and hash table size (power of two, > 4x limit)
+#define SIXEL_MAX_COLORS 256
+#define SIXEL_HASH_SIZE 1024
+
+// Scratch for sixel encoding (grow-only)
+static uint16_t* g_sixel_indices = NULL;     // Palette index per source pixel
+static size_t g_sixel_indices_cap = 0;
+static uint8_t* g_sixel_bits = NULL;         // Per band-color sixel bits per column
+static size_t g_sixel_bits_cap = 0;
+
+static bool ensure_sixel_scratch(size_t pixels, size_t bits) {
+  if (pixels > g_sixel_indices_cap) {
+    uint16_t* grown = (uint16_t*)realloc(g_sixel_indices, pixels * sizeof(uint16_t));
+    if (!grown) return false;
+    g_sixel_indices = grown;
+    g_sixel_indices_cap = pixels;
   }
+  if (bits > g_sixel_bits_cap) {
+    uint8_t* grown = (uint8_t*)realloc(g_sixel_bits, bits);
+    if (!grown) return false;
+    g_sixel_bits = grown;
+    g_sixel_bits_cap = bits;
+  }
+  return true;
+}
 
-  // If area is negative but culling is off, swap v1 and v2
-  float rsx0 = sx0, rsy0 = sy0, rsz0 = ndcZ0, rcw0 = cv0->cw;
-  float rsx1 = sx1, rsy1 = sy1, rsz1 = ndcZ1, rcw1 = cv1->cw;
-  float rsx2 = sx2, rsy2 = sy2, rsz2 = ndcZ2, rcw2 = cv2->cw;
-  float ru0 = cv0->u, rv0 = cv0->v;
-  float ru1 = cv1->u, rv1 = cv1->v;
-  float ru2 = cv2->u, rv2 = cv2->v;
-  uint8_t rr0 = cv0->r, rg0 = cv0->g, rb0 = cv0->b;
+// Sixel encoder core; native_frame enables the unchanged-frame skip (0 bytes)
+static bool encode_sixel(ByteWriter* w, const uint8_t* rgb, int width, int height,
+                         int scale, int quant, int max_colors, bool native_frame) {
+  uint64_t frame_hash = 0;
+  if (native_frame) {
+    flush_tiles();
+    size_t rgb_len = (size_t)width * height * 3;
+    frame_hash = 1469598103934665603ull;  // FNV-1a
+    for (size_t i = 0; i < rgb_len; i++) {
+      frame_hash = (frame_hash ^ rgb[i]) * 1099511628211ull;
+    }
+    if (g_sixel_frame_valid && frame_hash == g_sixel_frame_hash) return true;
+  }
 
-  if (signed_area < 0) {
-    // Swap v1 and v2
-    rsx1 = sx2; rsy1 = sy2; rsz1 = ndcZ2; rcw1 = cv2->cw;
-    rsx2 = sx1; rsy2 = sy1; rsz2 = ndcZ1; rcw2 = cv1->cw;
-    ru1 = cv2->u; rv1 = cv2->v;
-    ru2 = cv1->u; rv2 = cv1->v;
-  }
-
-  // Rasterize based on MSAA mode
-  if (g_msaa_samples == 1) {
-    rasterize_triangle_textured(
-      rsx0, rsy0, rsz0, rcw0, ru0, rv0,
-      rsx1, rsy1, rsz1, rcw1, ru1, rv1,
-      rsx2, rsy2, rsz2, rcw2, ru2, rv2,
-      rr0, rg0, rb0, light_factor,
-      g_framebuffer, g_depth_buffer, g_width
-    );
-  } else {
-    const float (*offsets)[2] = (g_msaa_samples == 4) ? msaa4_offsets : msaa16_offsets;
+  width = MAX(width, 0);
+  height = MAX(height, 0);
+  scale = CLAMP(scale, 1, 16);
+  quant = CLAMP(quant, 1, 255);
+  max_colors = CLAMP(max_colors, 1, SIXEL_MAX_COLORS);
+
+  size_t pixels = (size_t)width * height;
+  int scaled_w = width * scale, scaled_h = height * scale;
+  if (!ensure_sixel_scratch(pixels, (size_t)SIXEL_MAX_COLORS * scaled_w)) return false;
+
+  // Build palette in first-appearance order (colors past the limit map to 0)
+  uint32_t hash_keys[SIXEL_HASH_SIZE];
+  uint16_t hash_vals[SIXEL_HASH_SIZE];
+  uint8_t palette[SIXEL_MAX_COLORS][3];
+  int num_colors = 0;
+  memset(hash_keys, 0xFF, sizeof(hash_keys));
+
+  for (size_t i = 0; i < pixels; i++) {
+    uint8_t qr = (uint8_t)(rgb[i * 3] / quant * quant);
+    uint8_t qg = (uint8_t)(rgb[i * 3 + 1] / quant * quant);
+    uint8_t qb = (uint8_t)(rgb[i * 3 + 2] / quant * quant);
+    uint32_t key = ((uint32_t)qr << 16) | ((uint32_t)qg << 8) | qb;
+    uint32_t slot = (key * 2654435761u) >> 22;
+
+    while (hash_keys[slot] != key && hash_keys[slot] != 0xFFFFFFFFu) {
+      slot = (slot + 1) & (SIXEL_HASH_SIZE - 1);
+    }
+    if (hash_keys[slot] == key) {
+      g_sixel_indices[i] = hash_vals[slot];
+    } else if (num_colors < max_colors) {
+      hash_keys[slot] = key;
+      hash_vals[slot] = (uint16_t)num_colors;
+      palette[num_colors][0] = qr; palette[num_colors][1] = qg; palette[num_colors][2] = qb;
+      g_sixel_indices[i] = (uint16_t)num_colors++;
+    } else {
+      g_sixel_indices[i] = 0;
+    }
+  }
+
+  bw_bytes(w, "\x1b[H\x1bPq", 6);
 
-    for (int s = 0; s < g_msaa_samples; s++) {
-      float ox = offsets[s][0];
-      float oy = offsets[s][1];
+  // Define colors (percent RGB)
+  for (int c = 0; c < num_colors; c++) {
+    bw_byte(w, '#'); bw_uint(w, c);
+    bw_bytes(w, ";2;", 3);
+    bw_uint(w, (unsigned)lroundf(palette[c][0] / 255.0f * 100)); bw_byte(w, ';');
+    bw_uint(w, (unsigned)lroundf(palette[c][1] / 255.0f * 100)); bw_byte(w, ';');
+    bw_uint(w, (unsigned)lroundf(palette[c][2] / 255.0f * 100));
+  }
+
+  int16_t band_slot[SIXEL_MAX_COLORS];
+  uint16_t band_colors[SIXEL_MAX_COLORS];
+
+  // Process sixel rows (6 pixels high each) in scaled space
+  for (int sy = 0; sy < scaled_h; sy += 6) {
+    int band_count = 0;
+    memset(band_slot, 0xFF, sizeof(band_slot));
+
+    for (int sx = 0; sx < scaled_w; sx++) {
+      int fx = sx / scale;
+      for (int dy = 0; dy < 6 && sy + dy < scaled_h; dy++) {
+        uint16_t c = g_sixel_indices[(size_t)((sy + dy) / scale) * width + fx];
+        if (band_slot[c] < 0) {
+          band_slot[c] = (int16_t)band_count;
+          band_colors[band_count] = c;
+          memset(g_sixel_bits + (size_t)band_count * scaled_w, 0, scaled_w);
+          band_count++;
+        }
+        g_sixel_bits[(size_t)band_slot[c] * scaled_w + sx] |= (uint8_t)(1 << dy);
+      }
+    }
 
-      size_t sample_offset = s * g_width * g_height;
-      uint8_t* sample_color = g_msaa_buffer + sample_offset * 3;
-      float* sample_depth = g_msaa_depth + sample_offset;
+    // Output data for each color that appears in this band
+    for (int k = 0; k < band_count; k++) {
+      const uint8_t* data = g_sixel_bits + (size_t)k * scaled_w;
+      bw_byte(w, '#'); bw_uint(w, band_colors[k]);
+
+      // RLE with extended counts
+      int i = 0;
+      while (i < scaled_w) {
+        uint8_t val = data[i];
+        int count = 1;
+        while (i + count < scaled_w && data[i + count] == val && count < 32767) count++;
+
+        char ch = (char)(63 + val);
+        if (count > 3) {
+          bw_byte(w, '!'); bw_uint(w, count); bw_byte(w, ch);
+        } else {
+          for (int r = 0; r < count; r++) bw_byte(w, ch);
+        }
+        i += count;
+      }
 
-      rasterize_triangle_textured(
-        rsx0 + ox, rsy0 + oy, rsz0, rcw0, ru0, rv0,
-        rsx1 + ox, rsy1 + oy, rsz1, rcw1, ru1, rv1,
-        rsx2 + ox, rsy2 + oy, rsz2, rcw2, ru2, rv2,
-        rr0, rg0, rb0, light_factor,
-        sample_color, sample_depth, g_width
-      );
+      bw_byte(w, '$');  // Carriage return
     }
+
+    bw_byte(w, '-');  // New sixel row
   }
 
-  return 1;
+  bw_bytes(w, "\x1b\\", 2);
+  if (w->len <= w->cap) {
+    record_encode(w->len, w->len, width * height, width * height, true);
+    if (native_frame) {
+      g_sixel_frame_hash = frame_hash;
+      g_sixel_frame_valid = true;
+    }
+  }
+  return true;
 }
 
 /**
- * Render triangles with lighting, textures, and MSAA support.
- *
- * Args:
- *   vertices: Float32Array (x,y,z per vertex)
- *   indices: Uint32Array (3 per triangle)
- *   mvpMatrix: Float32Array (16 floats)
- *   colors: Uint8Array (r,g,b per vertex)
- *   normals: Float32Array (nx,ny,nz per vertex)
- *   uvs: Float32Array (u,v per vertex) - can be null/empty
+ * Encode an RGB image as Sixel with palette quantization, matching
+ * Framebuffer.toScaledSixelString() (without its unchanged-frame skip).
+ * Args: out (Buffer), width, height, rgb, scale (default 1), quant (default 16),
+ *       maxColors (default 256, capped at 256)
+ *       Pass rgb = null to encode the natively composed frame; it returns 0
+ *       when that frame is unchanged since the last one sent.
+ * Returns bytes written, or -(bytes needed) if out is too small.
  */
-static napi_value render_triangles_batch(napi_env env, napi_callback_info info) {
-  size_t argc = 6;
-  napi_value args[6];
+static napi_value render_encode_sixel(napi_env env, napi_callback_info info) {
+  size_t argc = 7;
+  napi_value args[7];
   NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+  wait_frame_idle();
 
-  if (argc < 5) {
-    napi_throw_error(env, NULL, "Expected at least 5 arguments: vertices, indices, mvp, colors, normals");
+  if (argc < 4) {
+    napi_throw_error(env, NULL, "Expected at least 4 arguments: out, width, height, rgb");
     return NULL;
   }
 
-  if (!g_framebuffer) {
-    napi_throw_error(env, NULL, "Renderer not initialized");
+  uint8_t* out;
+  uint8_t* rgb;
+  size_t out_len, rgb_len;
+  int32_t width, height, scale = 1, quant = 16, max_colors = SIXEL_MAX_COLORS;
+
+  NAPI_CALL(env, napi_get_value_int32(env, args[1], &width));
+  NAPI_CALL(env, napi_get_value_int32(env, args[2], &height));
+  if (argc >= 5) NAPI_CALL(env, napi_get_value_int32(env, args[4], &scale));
+  if (argc >= 6) NAPI_CALL(env, napi_get_value_int32(env, args[5], &quant));
+  if (argc >= 7) NAPI_CALL(env, napi_get_value_int32(env, args[6], &max_colors));
+  if (!get_byte_arg(env, args[0], &out, &out_len) || !get_byte_arg(env, args[3], &rgb, &rgb_len)) {
+    napi_throw_error(env, NULL, "Invalid buffer argument");
     return NULL;
   }
 
-  // Get typed arrays
-  float* vertices;
-  uint32_t* indices;
-  float* mvp;
-  uint8_t* colors;
-  float* normals;
-  float* uvs = NULL;
+  bool native_frame = !rgb && out;
+  if (native_frame) {
+    if (!g_framebuffer || width != g_out_width || height != g_out_height) {
+      napi_throw_error(env, NULL, "Native frame size mismatch");
+      return NULL;
+    }
+    present_scene();
+    rgb = g_framebuffer;
+    rgb_len = (size_t)width * height * 3;
+  }
 
-  size_t vertex_count, index_count, mvp_len, color_count, normal_count, uv_count = 0;
-  napi_typedarray_type type;
+  size_t pixels = (size_t)MAX(width, 0) * MAX(height, 0);
+  if (!out || !rgb || rgb_len < pixels * 3) {
+    napi_throw_error(env, NULL, "Buffer too small for width x height");
+    return NULL;
+  }
 
-  NAPI_CALL(env, napi_get_typedarray_info(env, args[0], &type, &vertex_count, (void**)&vertices, NULL, NULL));
-  NAPI_CALL(env, napi_get_typedarray_info(env, args[1], &type, &index_count, (void**)&indices, NULL, NULL));
-  NAPI_CALL(env, napi_get_typedarray_info(env, args[2], &type, &mvp_len, (void**)&mvp, NULL, NULL));
-  NAPI_CALL(env, napi_get_typedarray_info(env, args[3], &type, &color_count, (void**)&colors, NULL, NULL));
-  NAPI_CALL(env, napi_get_typedarray_info(env, args[4], &type, &normal_count, (void**)&normals, NULL, NULL));
+  ByteWriter w = { out, out_len, 0 };
+  if (!encode_sixel(&w, rgb, width, height, scale, quant, max_colors, native_frame)) {
+    napi_throw_error(env, NULL, "Failed to allocate sixel scratch");
+    return NULL;
+  }
+  return make_encode_result(env, &w);
+}
 
-  // UVs are optional (6th argument)
-  if (argc >= 6) {
-    napi_valuetype uv_type;
-    NAPI_CALL(env, napi_typeof(env, args[5], &uv_type));
-    if (uv_type != napi_null && uv_type != napi_undefined) {
-      NAPI_CALL(env, napi_get_typedarray_info(env, args[5], &type, &uv_count, (void**)&uvs, NULL, NULL));
+// ========================================
+// Command Buffers
+// ========================================
+
+/*
+ * A frame's draw calls encoded by JS into one Int32Array (floats share the
+ * buffer through a Float32Array view) and decoded by a single submit() call.
+ *
+ * Header (SUBMIT_HEADER_WORDS words):
+ *   [0] words used (header included)   [1] flags (SUBMIT_SORT_BY_TEXTURE)
+ *   [2] out: draws rendered             [3] out: draws whose texture was not resident
+ * Commands: opcode word followed by its arguments:
+ *   CMD_CLEAR r g b | CMD_SET_STATE cull textures | CMD_BIND_MESH handle |
+ *   CMD_BIND_TEXTURE id | CMD_SET_MVP m0..m15 (floats) | CMD_DRAW |
+ *   CMD_FLUSH | CMD_RESOLVE_MSAA | CMD_BIND_LIGHTMAP id
+ * Missing lightmaps are counted in word 3 like missing textures.
+ */
+#define SUBMIT_HEADER_WORDS 4
+#define SUBMIT_SORT_BY_TEXTURE 1
+
+enum {
+  CMD_END = 0,
+  CMD_CLEAR = 1,
+  CMD_SET_STATE = 2,
+  CMD_BIND_MESH = 3,
+  CMD_BIND_TEXTURE = 4,
+  CMD_SET_MVP = 5,
+  CMD_DRAW = 6,
+  CMD_FLUSH = 7,
+  CMD_RESOLVE_MSAA = 8,
+  CMD_BIND_LIGHTMAP = 9
+};
+
+// Decoded commands, with each segment's draws in submission (or texture) order
+static FrameCmd* g_submit_cmds = NULL;
+static int g_submit_count = 0;
+static int g_submit_capacity = 0;
+
+static bool reserve_submit_cmds(int count) {
+  if (count <= g_submit_capacity) return true;
+  int capacity = MAX(g_submit_capacity * 2, MAX(count, 256));
+  FrameCmd* grown = (FrameCmd*)realloc(g_submit_cmds, sizeof(FrameCmd) * capacity);
+  if (!grown) return false;
+  g_submit_cmds = grown;
+  g_submit_capacity = capacity;
+  return true;
+}
+
+static FrameCmd* push_submit_cmd(int type) {
+  if (!reserve_submit_cmds(g_submit_count + 1)) return NULL;
+  FrameCmd* cmd = &g_submit_cmds[g_submit_count++];
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->type = type;
+  return cmd;
+}
+
+// Draws are decoded as FCMD_DRAW_MESH with the texture id in args[1] and lightmap id in args[3]
+static int compare_draw_texture(const void* a, const void* b) {
+  const FrameCmd* da = (const FrameCmd*)a;
+  const FrameCmd* db = (const FrameCmd*)b;
+  if (da->args[1] != db->args[1]) return da->args[1] < db->args[1] ? -1 : 1;
+  if (da->args[3] != db->args[3]) return da->args[3] < db->args[3] ? -1 : 1;
+  // Keep submission order within a texture (args[2] = sequence number)
+  return (da->args[2] > db->args[2]) - (da->args[2] < db->args[2]);
+}
+
+/**
+ * Run one decoded or recorded command. Mesh draws are occlusion-tested first.
+ * Returns true if the command drew a mesh.
+ */
+static bool execute_cmd(const FrameCmd* cmd, const uint8_t* payload) {
+  switch (cmd->type) {
+    case FCMD_CLEAR:
+      clear_frame((uint8_t)cmd->args[0], (uint8_t)cmd->args[1], (uint8_t)cmd->args[2]);
+      break;
+    case FCMD_SET_OPTIONS:
+      apply_options(cmd->args[0] != 0, cmd->args[1] != 0);
+      break;
+    case FCMD_BIND_TEXTURE:
+      bind_texture_id(cmd->args[0]);
+      break;
+    case FCMD_BIND_LIGHTMAP:
+      bind_lightmap_id(cmd->args[0]);
+      break;
+    case FCMD_DRAW_MESH: {
+      NativeMesh* mesh = get_native_mesh(cmd->args[0]);
+      if (!mesh || aabb_occluded(mesh->bounds, cmd->mvp)) return false;
+      draw_mesh_now(mesh, cmd->mvp);
+      return true;
+    }
+    case FCMD_FLUSH:
+      flush_tiles();
+      break;
+    case FCMD_RESOLVE_MSAA:
+      resolve_msaa_now();
+      break;
+    case FCMD_DRAW_GLYPHS:
+      draw_glyph_cells((const float*)(payload + cmd->payload), cmd->args[0]);
+      break;
+    case FCMD_COMPOSITE_CELLS:
+      composite_cell_words((const uint32_t*)(payload + cmd->payload), cmd->args[0]);
+      break;
+    case FCMD_TINT_GLYPHS:
+      tint_glyph_layer(cmd->args, cmd->amount);
+      break;
+  }
+  return false;
+}
+
+// Sort the draws decoded since the last state change, then emit their texture and lightmap binds
+static bool end_submit_segment(int first_draw, bool sort) {
+  int count = g_submit_count - first_draw;
+  if (count <= 0) return true;
+  if (sort) qsort(g_submit_cmds + first_draw, count, sizeof(FrameCmd), compare_draw_texture);
+
+  // Expand to bind + draw runs, binding only when the texture or lightmap changes
+  int binds = 0;
+  int32_t bound = -1, bound_lightmap = -1;
+  for (int i = first_draw; i < g_submit_count; i++) {
+    if (g_submit_cmds[i].args[1] != bound) {
+      bound = g_submit_cmds[i].args[1];
+      binds++;
+    }
+    if (g_submit_cmds[i].args[3] != bound_lightmap) {
+      bound_lightmap = g_submit_cmds[i].args[3];
+      binds++;
+    }
+  }
+  int total = g_submit_count + binds;
+  if (!reserve_submit_cmds(total)) return false;
+  g_submit_count = total;
+
+  int dst = total - 1;
+  for (int i = first_draw + count - 1; i >= first_draw; i--) {
+    FrameCmd draw = g_submit_cmds[i];
+    // Walking backwards, so compare against the previous draw distinct from this one
+    int prev_texture = -1, prev_lightmap = -1;
+    if (i > first_draw) {
+      prev_texture = g_submit_cmds[i - 1].args[1];
+      prev_lightmap = g_submit_cmds[i - 1].args[3];
+    }
+    g_submit_cmds[dst--] = draw;
+    if (prev_lightmap != draw.args[3]) {
+      FrameCmd* bind = &g_submit_cmds[dst--];
+      memset(bind, 0, sizeof(*bind));
+      bind->type = FCMD_BIND_LIGHTMAP;
+      bind->args[0] = draw.args[3];
+    }
+    if (prev_texture != draw.args[1]) {
+      FrameCmd* bind = &g_submit_cmds[dst--];
+      memset(bind, 0, sizeof(*bind));
+      bind->type = FCMD_BIND_TEXTURE;
+      bind->args[0] = draw.args[1];
+    }
+  }
+  return true;
+}
+
+/**
+ * Decode a command buffer into g_submit_cmds, validating everything first.
+ * Returns an error message, or NULL on success.
+ */
+static const char* decode_command_buffer(const int32_t* words, size_t words_len, int* missing_textures) {
+  g_submit_count = 0;
+  *missing_textures = 0;
+  if (words_len < SUBMIT_HEADER_WORDS) return "Command buffer too small";
+
+  size_t used = (size_t)MAX(words[0], 0);
+  if (used < SUBMIT_HEADER_WORDS || used > words_len) return "Command buffer length out of range";
+  bool sort = (words[1] & SUBMIT_SORT_BY_TEXTURE) != 0;
+
+  int32_t mesh = 0, texture = 0, lightmap = 0, seq = 0;
+  bool texture_missing = false, lightmap_missing = false;
+  float mvp[16];
+  bool have_mvp = false;
+  int first_draw = 0;
+
+  size_t pc = SUBMIT_HEADER_WORDS;
+  while (pc < used) {
+    int32_t op = words[pc++];
+    size_t argc = op == CMD_CLEAR ? 3 : op == CMD_SET_STATE ? 2 :
+                  op == CMD_BIND_MESH || op == CMD_BIND_TEXTURE || op == CMD_BIND_LIGHTMAP ? 1 :
+                  op == CMD_SET_MVP ? 16 : 0;
+    if (pc + argc > used) return "Truncated command";
+    const int32_t* a = words + pc;
+    pc += argc;
+
+    if (op == CMD_END) break;
+    switch (op) {
+      case CMD_BIND_MESH:
+        if (!get_native_mesh(a[0])) return "Invalid mesh handle";
+        mesh = a[0];
+        continue;
+      case CMD_BIND_TEXTURE: {
+        NativeTexture* tex = a[0] ? get_native_texture(a[0]) : NULL;
+        texture_missing = a[0] != 0 && (!tex || !tex->image);
+        texture = texture_missing ? 0 : a[0];
+        continue;
+      }
+      case CMD_BIND_LIGHTMAP: {
+        NativeTexture* tex = a[0] ? get_native_texture(a[0]) : NULL;
+        lightmap_missing = a[0] != 0 && (!tex || !tex->image);
+        lightmap = lightmap_missing ? 0 : a[0];
+        continue;
+      }
+      case CMD_SET_MVP:
+        memcpy(mvp, a, sizeof(mvp));
+        have_mvp = true;
+        continue;
+      case CMD_DRAW: {
+        if (!mesh) return "Draw without a bound mesh";
+        if (!have_mvp) return "Draw without an MVP matrix";
+        FrameCmd* cmd = push_submit_cmd(FCMD_DRAW_MESH);
+        if (!cmd) return "Failed to allocate command list";
+        cmd->args[0] = mesh;
+        cmd->args[1] = texture;
+        cmd->args[2] = seq++;
+        cmd->args[3] = lightmap;
+        memcpy(cmd->mvp, mvp, sizeof(mvp));
+        if (texture_missing || (lightmap_missing && get_native_mesh(mesh)->lu)) (*missing_textures)++;
+        continue;
+      }
+      case CMD_CLEAR:
+      case CMD_SET_STATE:
+      case CMD_FLUSH:
+      case CMD_RESOLVE_MSAA:
+        break;
+      default:
+        return "Unknown command opcode";
     }
+
+    // State changes and flushes end a sort segment
+    if (!end_submit_segment(first_draw, sort)) return "Failed to allocate command list";
+    FrameCmd* cmd = push_submit_cmd(op == CMD_CLEAR ? FCMD_CLEAR : op == CMD_SET_STATE ? FCMD_SET_OPTIONS :
+                                    op == CMD_FLUSH ? FCMD_FLUSH : FCMD_RESOLVE_MSAA);
+    if (!cmd) return "Failed to allocate command list";
+    for (size_t i = 0; i < argc; i++) cmd->args[i] = a[i];
+    first_draw = g_submit_count;
   }
+  if (!end_submit_segment(first_draw, sort)) return "Failed to allocate command list";
+  return NULL;
+}
 
-  int triangle_count = (int)(index_count / 3);
-  int rendered = 0;
+/**
+ * Execute a whole frame's draw calls from one command buffer (see the format
+ * above). Draws are occlusion-tested against hi-Z and, with
+ * SUBMIT_SORT_BY_TEXTURE, reordered by texture between state changes and
+ * flushes. Draws whose texture was evicted render untextured (and with face
+ * lighting if their lightmap was); re-upload and resubmit when header word 3
+ * is non-zero. While recording a frame the
+ * decoded commands are recorded and every draw counts as rendered.
+ * Args: commands (Int32Array)
+ * Returns: number of draws rendered (also written to header word 2)
+ */
+static napi_value render_submit(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
 
-  float halfW = g_width * 0.5f;
-  float halfH = g_height * 0.5f;
+  if (argc < 1) {
+    napi_throw_error(env, NULL, "Expected 1 argument: commands");
+    return NULL;
+  }
+  if (!g_framebuffer) {
+    napi_throw_error(env, NULL, "Renderer not initialized");
+    return NULL;
+  }
 
-  for (int t = 0; t < triangle_count; t++) {
-    uint32_t i0 = indices[t * 3];
-    uint32_t i1 = indices[t * 3 + 1];
-    uint32_t i2 = indices[t * 3 + 2];
+  napi_typedarray_type type;
+  size_t words_len;
+  int32_t* words;
+  NAPI_CALL(env, napi_get_typedarray_info(env, args[0], &type, &words_len, (void**)&words, NULL, NULL));
+  if (type != napi_int32_array) {
+    napi_throw_error(env, NULL, "Command buffer must be an Int32Array");
+    return NULL;
+  }
 
-    // Vertex positions
-    float vx0 = vertices[i0 * 3], vy0 = vertices[i0 * 3 + 1], vz0 = vertices[i0 * 3 + 2];
-    float vx1 = vertices[i1 * 3], vy1 = vertices[i1 * 3 + 1], vz1 = vertices[i1 * 3 + 2];
-    float vx2 = vertices[i2 * 3], vy2 = vertices[i2 * 3 + 1], vz2 = vertices[i2 * 3 + 2];
+  if (!g_recording) wait_frame_idle();
 
-    // Transform to clip space
-    float cx0, cy0, cz0, cw0;
-    float cx1, cy1, cz1, cw1;
-    float cx2, cy2, cz2, cw2;
+  uint64_t prof = prof_begin();
+  int missing = 0;
+  const char* error = decode_command_buffer(words, words_len, &missing);
+  if (error) {
+    napi_throw_error(env, NULL, error);
+    return NULL;
+  }
 
-    transform_vertex(vx0, vy0, vz0, mvp, &cx0, &cy0, &cz0, &cw0);
-    transform_vertex(vx1, vy1, vz1, mvp, &cx1, &cy1, &cz1, &cw1);
-    transform_vertex(vx2, vy2, vz2, mvp, &cx2, &cy2, &cz2, &cw2);
+  int drawn = 0;
+  for (int i = 0; i < g_submit_count; i++) {
+    const FrameCmd* cmd = &g_submit_cmds[i];
+    if (g_recording) {
+      FrameCmd* rec = record_cmd(cmd->type);
+      if (!rec) return recorded_result(env, rec);
+      *rec = *cmd;
+      if (cmd->type == FCMD_DRAW_MESH) drawn++;
+    } else if (execute_cmd(cmd, NULL)) {
+      drawn++;
+    }
+  }
+  g_debug_submitted_draws += drawn;
+  prof_end(PROF_SUBMIT, prof);
 
-    g_debug_total_tris++;
+  words[2] = drawn;
+  words[3] = missing;
 
-    // Get colors and UVs for original vertices
-    uint8_t r0 = colors[i0 * 3], g0 = colors[i0 * 3 + 1], b0 = colors[i0 * 3 + 2];
-    uint8_t r1 = colors[i1 * 3], g1 = colors[i1 * 3 + 1], b1 = colors[i1 * 3 + 2];
-    uint8_t r2 = colors[i2 * 3], g2 = colors[i2 * 3 + 1], b2 = colors[i2 * 3 + 2];
+  napi_value result;
+  NAPI_CALL(env, napi_create_int32(env, drawn, &result));
+  return result;
+}
 
-    float u0 = 0, v0 = 0, u1 = 0, v1 = 0, u2 = 0, v2 = 0;
-    if (uvs && uv_count >= (i2 + 1) * 2) {
-      u0 = uvs[i0 * 2]; v0 = uvs[i0 * 2 + 1];
-      u1 = uvs[i1 * 2]; v1 = uvs[i1 * 2 + 1];
-      u2 = uvs[i2 * 2]; v2 = uvs[i2 * 2 + 1];
-      g_debug_triangles_with_uv++;
-    }
+// ========================================
+// Frame Pipeline
+// ========================================
 
-    // Build ClipVert structures
-    ClipVert cv0 = { cx0, cy0, cz0, cw0, u0, v0, r0, g0, b0 };
-    ClipVert cv1 = { cx1, cy1, cz1, cw1, u1, v1, r1, g1, b1 };
-    ClipVert cv2 = { cx2, cy2, cz2, cw2, u2, v2, r2, g2, b2 };
+// Encoded frame handed from the render thread to the JS callback
+typedef struct {
+  uint8_t* data;
+  size_t len;
+  int id;
+  double render_ms;
+} FrameResult;
+
+static pthread_t g_frame_thread;
+static bool g_frame_thread_stop = false;
+static napi_threadsafe_function g_frame_callback = NULL;
+static int g_frame_next_id = 0;
+static size_t g_frame_out_hint = 64 * 1024;  // Grows to the largest encoded frame
+
+static double now_ms(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
 
-    // Clip triangle against near plane - may produce 0, 1, or 2 triangles
-    ClipVert clipped[6];  // Space for 2 triangles
-    int num_tris = clip_triangle_near_plane(&cv0, &cv1, &cv2, clipped);
+// Encode the finished frame into a malloc'd buffer (NULL if empty or out of memory)
+static uint8_t* encode_frame(const FrameList* f, size_t* out_len) {
+  *out_len = 0;
+  if (f->encode == FRAME_ENCODE_NONE) return NULL;
+
+  size_t cap = g_frame_out_hint;
+  for (;;) {
+    uint8_t* out = (uint8_t*)malloc(cap);
+    if (!out) return NULL;
+
+    ByteWriter w = { out, cap, 0 };
+    bool ok = true;
+    if (f->encode == FRAME_ENCODE_SIXEL) {
+      present_scene();
+      ok = encode_sixel(&w, g_framebuffer, g_width, g_height,
+                        f->sixel_scale, f->sixel_quant, f->sixel_max_colors, true);
+    } else {
+      HalfBlockInput in = { .out = out, .out_len = cap };
+      native_frame_input(&in);
+      if (f->encode == FRAME_ENCODE_HALF_BLOCK_DIFF) {
+        ok = encode_half_block_diff(&in, &w);
+      } else {
+        encode_half_block(&in, &w);
+      }
+    }
 
-    if (num_tris == 0) {
-      g_debug_near_clipped++;
+    // Encoders leave their state untouched on overflow, so retrying is safe
+    if (ok && w.len > w.cap) {
+      free(out);
+      cap = ALIGN_UP(w.len, 4096);
+      g_frame_out_hint = cap;
       continue;
     }
-
-    // Compute face normal for lighting (using original vertices)
-    float nx, ny, nz;
-    if (normal_count >= (i2 + 1) * 3) {
-      nx = (normals[i0 * 3] + normals[i1 * 3] + normals[i2 * 3]) * 0.333333f;
-      ny = (normals[i0 * 3 + 1] + normals[i1 * 3 + 1] + normals[i2 * 3 + 1]) * 0.333333f;
-      nz = (normals[i0 * 3 + 2] + normals[i1 * 3 + 2] + normals[i2 * 3 + 2]) * 0.333333f;
-    } else {
-      float e1x = vx1 - vx0, e1y = vy1 - vy0, e1z = vz1 - vz0;
-      float e2x = vx2 - vx0, e2y = vy2 - vy0, e2z = vz2 - vz0;
-      nx = e1y * e2z - e1z * e2y;
-      ny = e1z * e2x - e1x * e2z;
-      nz = e1x * e2y - e1y * e2x;
+    if (!ok || w.len == 0) {
+      free(out);
+      return NULL;
     }
+    *out_len = w.len;
+    return out;
+  }
+}
 
-    // Normalize
-    float len_sq = nx * nx + ny * ny + nz * nz;
-    if (len_sq > 0.0001f) {
-      float inv_len = fast_rsqrt(len_sq);
-      nx *= inv_len;
-      ny *= inv_len;
-      nz *= inv_len;
-    }
+// Replay a recorded frame (render thread)
+static void execute_frame(FrameList* f) {
+  // The renderer was resized after this frame was recorded
+  if (!g_framebuffer || f->width != g_out_width || f->height != g_out_height) return;
+
+  for (int c = 0; c < f->count; c++) {
+    execute_cmd(&f->cmds[c], f->payload);
+  }
+  flush_tiles();
+}
 
-    // Compute lighting
-    float nDotL = nx * g_light_dir[0] + ny * g_light_dir[1] + nz * g_light_dir[2];
-    if (nDotL < 0) nDotL = 0;
-    float light_factor = g_ambient_light + (1.0f - g_ambient_light) * nDotL;
+static void free_external_bytes(napi_env env, void* data, void* hint) {
+  free(data);
+}
+
+// Deliver an encoded frame to the JS callback: cb(frameId, data | null, renderMs)
+static void frame_call_js(napi_env env, napi_value js_cb, void* context, void* data) {
+  FrameResult* res = (FrameResult*)data;
+  if (!env) {
+    // Callback is being torn down
+    free(res->data);
+    free(res);
+    return;
+  }
 
-    // Track texture usage
-    if (g_enable_textures && g_current_texture != NULL) {
-      g_debug_triangles_textured++;
+  napi_value argv[3], undefined;
+  napi_create_int32(env, res->id, &argv[0]);
+  if (res->data) {
+    // Hand the encoded bytes to JS without copying; the finalizer frees them
+    if (napi_create_external_buffer(env, res->len, res->data, free_external_bytes, NULL, &argv[1]) != napi_ok) {
+      napi_create_buffer_copy(env, res->len, res->data, NULL, &argv[1]);
+      free(res->data);
     }
+  } else {
+    napi_get_null(env, &argv[1]);
+  }
+  napi_create_double(env, res->render_ms, &argv[2]);
+  napi_get_undefined(env, &undefined);
+  free(res);
 
-    // Process each clipped triangle
-    for (int ct = 0; ct < num_tris; ct++) {
-      ClipVert* t0 = &clipped[ct * 3];
-      ClipVert* t1 = &clipped[ct * 3 + 1];
-      ClipVert* t2 = &clipped[ct * 3 + 2];
+  napi_call_function(env, undefined, js_cb, 3, argv, NULL);
+}
 
-      if (process_clipped_triangle(t0, t1, t2, light_factor, halfW, halfH)) {
-        rendered++;
+static void* frame_thread_main(void* arg) {
+  t_prof_tid = PROF_TID_RENDER;
+  pthread_mutex_lock(&g_frame_mutex);
+  for (;;) {
+    while (!g_frame_pending && !g_frame_thread_stop) {
+      pthread_cond_wait(&g_frame_submitted, &g_frame_mutex);
+    }
+    if (!g_frame_pending) break;
+    FrameList* f = g_frame_pending;
+    pthread_mutex_unlock(&g_frame_mutex);
+
+    double start = now_ms();
+    uint64_t prof = prof_begin();
+    execute_frame(f);
+    prof_end(PROF_FRAME_EXECUTE, prof);
+    prof = prof_begin();
+    size_t len = 0;
+    uint8_t* data = encode_frame(f, &len);
+    prof_end(PROF_FRAME_ENCODE, prof);
+    g_frame_render_ms = now_ms() - start;
+
+    if (g_frame_callback && f->encode != FRAME_ENCODE_NONE) {
+      FrameResult* res = (FrameResult*)malloc(sizeof(FrameResult));
+      if (res) {
+        res->data = data;
+        res->len = len;
+        res->id = f->id;
+        res->render_ms = g_frame_render_ms;
+        if (napi_call_threadsafe_function(g_frame_callback, res, napi_tsfn_nonblocking) == napi_ok) {
+          data = NULL;
+          res = NULL;
+        }
       }
+      free(res);
     }
+    free(data);
+
+    pthread_mutex_lock(&g_frame_mutex);
+    g_frame_pending = NULL;
+    pthread_cond_broadcast(&g_frame_finished);
   }
+  pthread_mutex_unlock(&g_frame_mutex);
+  return NULL;
+}
 
-  napi_value result;
-  NAPI_CALL(env, napi_create_int32(env, rendered, &result));
-  return result;
+static bool start_frame_thread(void) {
+  if (g_frame_thread_running) return true;
+  g_frame_thread_stop = false;
+  if (pthread_create(&g_frame_thread, NULL, frame_thread_main, NULL) != 0) return false;
+  g_frame_thread_running = true;
+  return true;
+}
+
+// Finish the frame in flight, stop the render thread and drop recorded frames
+static void shutdown_frame_pipeline(void) {
+  if (g_frame_thread_running) {
+    pthread_mutex_lock(&g_frame_mutex);
+    g_frame_thread_stop = true;
+    pthread_cond_broadcast(&g_frame_submitted);
+    pthread_mutex_unlock(&g_frame_mutex);
+    pthread_join(g_frame_thread, NULL);
+    g_frame_thread_running = false;
+  }
+  if (g_frame_callback) {
+    napi_release_threadsafe_function(g_frame_callback, napi_tsfn_abort);
+    g_frame_callback = NULL;
+  }
+  // Deferred destroys are dropped: the caller frees every mesh and texture next
+  for (int i = 0; i < 2; i++) {
+    free(g_frame_lists[i].cmds);
+    free(g_frame_lists[i].payload);
+    free(g_frame_lists[i].deferred_meshes);
+    free(g_frame_lists[i].deferred_textures);
+    memset(&g_frame_lists[i], 0, sizeof(FrameList));
+  }
+  g_recording = NULL;
+  g_record_slot = 0;
 }
 
 /**
- * Resolve MSAA samples to framebuffer (parallel).
- * Also resolves depth buffer (minimum depth across samples) for sprite occlusion.
+ * Start recording a frame. Until submitFrame(), clear/setOptions/bindTexture/
+ * drawMesh/flush/resolveMSAA/drawGlyphs/compositeCells/tintGlyphs are stored
+ * and run later on the render thread (drawMesh always returns 0 here and
+ * occlusion queries return false). A frame recorded earlier but not
+ * submitted is discarded.
  */
-static napi_value render_resolve_msaa(napi_env env, napi_callback_info info) {
-  if (!g_framebuffer || g_msaa_samples <= 1 || !g_msaa_buffer) {
-    napi_value result;
-    NAPI_CALL(env, napi_get_undefined(env, &result));
-    return result;
+static napi_value render_begin_frame(napi_env env, napi_callback_info info) {
+  if (!g_framebuffer) {
+    napi_throw_error(env, NULL, "Renderer not initialized");
+    return NULL;
   }
 
-  // Dispatch parallel MSAA resolve (work type 2)
-  dispatch_parallel_work(2, 0, g_height, 0, 0, 0);
+  // This slot's last frame finished before the previous submit went out
+  flush_deferred_destroys();
+
+  FrameList* f = &g_frame_lists[g_record_slot];
+  f->count = 0;
+  f->payload_len = 0;
+  g_recording = f;
 
   napi_value result;
   NAPI_CALL(env, napi_get_undefined(env, &result));
@@ -1065,50 +5811,141 @@ static napi_value render_resolve_msaa(napi_env env, napi_callback_info info) {
 }
 
 /**
- * Get framebuffer as Uint8Array (zero-copy).
+ * Hand the recorded frame to the render thread and return immediately; the
+ * encoded output goes to the setFrameCallback() callback. Blocks only while
+ * the previous frame is still rendering (at most one frame in flight).
+ * Args: encode (0 = none, 1 = half-block, 2 = half-block diff, 3 = sixel),
+ *       sixelScale (default 1), sixelQuant (default 16), sixelMaxColors (default 256)
+ * Returns: frame id passed to the callback
  */
-static napi_value render_get_framebuffer(napi_env env, napi_callback_info info) {
-  if (!g_framebuffer) {
-    napi_throw_error(env, NULL, "Renderer not initialized");
+static napi_value render_submit_frame(napi_env env, napi_callback_info info) {
+  size_t argc = 4;
+  napi_value args[4];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  int32_t encode = FRAME_ENCODE_NONE, scale = 1, quant = 16, max_colors = SIXEL_MAX_COLORS;
+  if (argc >= 1) NAPI_CALL(env, napi_get_value_int32(env, args[0], &encode));
+  if (argc >= 2) NAPI_CALL(env, napi_get_value_int32(env, args[1], &scale));
+  if (argc >= 3) NAPI_CALL(env, napi_get_value_int32(env, args[2], &quant));
+  if (argc >= 4) NAPI_CALL(env, napi_get_value_int32(env, args[3], &max_colors));
+
+  if (!g_recording) {
+    napi_throw_error(env, NULL, "No frame being recorded (call beginFrame first)");
+    return NULL;
+  }
+  if (!start_frame_thread()) {
+    napi_throw_error(env, NULL, "Failed to start render thread");
     return NULL;
   }
 
-  size_t byte_length = (size_t)g_width * g_height * 3;
+  FrameList* f = g_recording;
+  f->encode = CLAMP(encode, FRAME_ENCODE_NONE, FRAME_ENCODE_SIXEL);
+  f->width = g_out_width;
+  f->height = g_out_height;
+  f->sixel_scale = scale;
+  f->sixel_quant = quant;
+  f->sixel_max_colors = max_colors;
+  f->id = ++g_frame_next_id;
+  g_recording = NULL;
+  g_record_slot ^= 1;
+
+  double start = now_ms();
+  uint64_t prof = prof_begin();
+  pthread_mutex_lock(&g_frame_mutex);
+  while (g_frame_pending) {
+    pthread_cond_wait(&g_frame_finished, &g_frame_mutex);
+  }
+  g_frame_wait_ms = now_ms() - start;
+  prof_end(PROF_FRAME_WAIT, prof);
+  g_frame_pending = f;
+  pthread_cond_signal(&g_frame_submitted);
+  pthread_mutex_unlock(&g_frame_mutex);
 
-  napi_value array_buffer;
-  NAPI_CALL(env, napi_create_external_arraybuffer(
-    env, g_framebuffer, byte_length, NULL, NULL, &array_buffer
-  ));
+  napi_value result;
+  NAPI_CALL(env, napi_create_int32(env, f->id, &result));
+  return result;
+}
+
+/**
+ * Block until the submitted frame has finished rendering.
+ */
+static napi_value render_wait_frame(napi_env env, napi_callback_info info) {
+  wait_frame_idle();
 
   napi_value result;
-  NAPI_CALL(env, napi_create_typedarray(
-    env, napi_uint8_array, byte_length, array_buffer, 0, &result
-  ));
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
 
+/**
+ * Set the function that receives encoded frames: cb(frameId, data, renderMs),
+ * where data is a Buffer, or null when nothing needs writing (unchanged sixel
+ * frame or empty diff). Pass null to drop output. The callback does not keep
+ * the process alive.
+ */
+static napi_value render_set_frame_callback(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  napi_valuetype type = napi_undefined;
+  if (argc >= 1) NAPI_CALL(env, napi_typeof(env, args[0], &type));
+
+  wait_frame_idle();
+  if (g_frame_callback) {
+    napi_release_threadsafe_function(g_frame_callback, napi_tsfn_release);
+    g_frame_callback = NULL;
+  }
+
+  if (type == napi_function) {
+    napi_value name;
+    NAPI_CALL(env, napi_create_string_utf8(env, "csterm-frame", NAPI_AUTO_LENGTH, &name));
+    NAPI_CALL(env, napi_create_threadsafe_function(env, args[0], NULL, name, 0, 1, NULL, NULL, NULL,
+                                                   frame_call_js, &g_frame_callback));
+    NAPI_CALL(env, napi_unref_threadsafe_function(env, g_frame_callback));
+  }
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
   return result;
 }
 
 /**
- * Get depth buffer as Float32Array for JS occlusion testing.
+ * Set the scene size and MSAA samples for frames from the next clear on
+ * (dynamic resolution). The scene is drawn into the buffers allocated at
+ * init and upscaled to the output size before overlays and encoding, so
+ * nothing is reallocated. Width/height must not exceed the init size and
+ * samples (1, 4, 16) not the init sample count; the output size restores
+ * full resolution.
+ * Args: width, height, msaaSamples. Returns false if out of range.
  */
-static napi_value render_get_depth_buffer(napi_env env, napi_callback_info info) {
-  if (!g_depth_buffer) {
-    napi_throw_error(env, NULL, "Renderer not initialized");
+static napi_value render_set_render_scale(napi_env env, napi_callback_info info) {
+  size_t argc = 3;
+  napi_value args[3];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  if (argc < 3) {
+    napi_throw_error(env, NULL, "Expected 3 arguments: width, height, msaaSamples");
     return NULL;
   }
 
-  size_t byte_length = (size_t)g_width * g_height * sizeof(float);
+  int32_t width, height, msaa;
+  NAPI_CALL(env, napi_get_value_int32(env, args[0], &width));
+  NAPI_CALL(env, napi_get_value_int32(env, args[1], &height));
+  NAPI_CALL(env, napi_get_value_int32(env, args[2], &msaa));
 
-  napi_value array_buffer;
-  NAPI_CALL(env, napi_create_external_arraybuffer(
-    env, g_depth_buffer, byte_length, NULL, NULL, &array_buffer
-  ));
+  bool ok = g_framebuffer &&
+            width > 0 && height > 0 && width <= g_out_width && height <= g_out_height &&
+            (msaa == 1 || msaa == 4 || msaa == 16) && msaa <= g_max_msaa_samples;
+  if (ok) {
+    // Read by clear_frame(), possibly on the render thread, as one word
+    bool full = width == g_out_width && height == g_out_height && msaa == g_max_msaa_samples;
+    uint32_t scene = full ? 0 : ((uint32_t)width << 18) | ((uint32_t)height << 5) | (uint32_t)msaa;
+    __atomic_store_n(&g_scene_request, scene, __ATOMIC_RELAXED);
+  }
 
   napi_value result;
-  NAPI_CALL(env, napi_create_typedarray(
-    env, napi_float32_array, (size_t)g_width * g_height, array_buffer, 0, &result
-  ));
-
+  NAPI_CALL(env, napi_get_boolean(env, ok, &result));
   return result;
 }
 
@@ -1118,8 +5955,8 @@ static napi_value render_get_depth_buffer(napi_env env, napi_callback_info info)
 static napi_value render_get_dimensions(napi_env env, napi_callback_info info) {
   napi_value result, w, h;
   NAPI_CALL(env, napi_create_object(env, &result));
-  NAPI_CALL(env, napi_create_int32(env, g_width, &w));
-  NAPI_CALL(env, napi_create_int32(env, g_height, &h));
+  NAPI_CALL(env, napi_create_int32(env, g_out_width, &w));
+  NAPI_CALL(env, napi_create_int32(env, g_out_height, &h));
   NAPI_CALL(env, napi_set_named_property(env, result, "width", w));
   NAPI_CALL(env, napi_set_named_property(env, result, "height", h));
   return result;
@@ -1129,25 +5966,61 @@ static napi_value render_get_dimensions(napi_env env, napi_callback_info info) {
  * Cleanup.
  */
 static napi_value render_cleanup(napi_env env, napi_callback_info info) {
-  // Shutdown thread pool first
-  shutdown_thread_pool();
+  // Stop the render thread; the shared job system outlives the renderer
+  shutdown_frame_pipeline();
+
+  free_tile_bins();
+  free_hiz();
+  free_glyph_layer();
+  free(g_raster_tris);
+  g_raster_tris = NULL;
+  g_raster_capacity = 0;
+  free(g_setup_job.chunk_counts);
+  g_setup_job.chunk_counts = NULL;
+  g_setup_job.chunk_capacity = 0;
+  free_vertex_cache();
+  free(g_submit_cmds);
+  g_submit_cmds = NULL;
+  g_submit_count = 0;
+  g_submit_capacity = 0;
 
   free(g_framebuffer);
   free(g_depth_buffer);
   free(g_msaa_buffer);
   free(g_msaa_depth);
-  free(g_texture_buffer);
+  free_tex_image(&g_texture_image);
+  destroy_all_meshes();
+  destroy_all_textures();
+  free_vis_world(g_vis);
+  g_vis = NULL;
+  free(g_sixel_indices);
+  free(g_sixel_bits);
+  free(g_prev_cells);
 
   g_framebuffer = NULL;
   g_depth_buffer = NULL;
   g_msaa_buffer = NULL;
   g_msaa_depth = NULL;
   g_current_texture = NULL;
-  g_texture_buffer = NULL;
-  g_texture_buffer_size = 0;
+  g_sixel_indices = NULL;
+  g_sixel_indices_cap = 0;
+  g_sixel_bits = NULL;
+  g_sixel_bits_cap = 0;
+  g_prev_cells = NULL;
+  g_prev_cells_w = 0;
+  g_prev_cells_rows = 0;
+  g_prev_cells_valid = false;
+  g_sixel_frame_valid = false;
   g_width = 0;
   g_height = 0;
   g_msaa_samples = 1;
+  g_out_width = 0;
+  g_out_height = 0;
+  g_max_msaa_samples = 1;
+  g_scene_request = 0;
+  g_scene_pending = false;
+  g_pixel_capacity = 0;
+  g_msaa_capacity = 0;
 
   napi_value result;
   NAPI_CALL(env, napi_get_undefined(env, &result));
@@ -1171,9 +6044,42 @@ static napi_value render_get_debug_stats(napi_env env, napi_callback_info info)
   NAPI_CALL(env, napi_create_int32(env, g_debug_near_clipped, &v));
   NAPI_CALL(env, napi_set_named_property(env, result, "nearClipped", v));
 
+  NAPI_CALL(env, napi_create_int32(env, g_debug_triangles_clipped, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "trianglesClipped", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_vertices_transformed, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "verticesTransformed", v));
+
   NAPI_CALL(env, napi_create_int32(env, g_debug_frustum_culled, &v));
   NAPI_CALL(env, napi_set_named_property(env, result, "frustumCulled", v));
 
+  NAPI_CALL(env, napi_create_int32(env, g_debug_hiz_culled, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "hizCulled", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_hiz_blocks_rejected, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "hizBlocksRejected", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_occlusion_tests, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "occlusionTests", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_occluded_objects, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "occludedObjects", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_overlay_cells, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "overlayCells", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_submitted_draws, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "submittedDraws", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_texture_binds, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "textureBinds", v));
+
+  NAPI_CALL(env, napi_create_double(env, g_frame_render_ms, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "frameRenderMs", v));
+
+  NAPI_CALL(env, napi_create_double(env, g_frame_wait_ms, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "frameWaitMs", v));
+
   NAPI_CALL(env, napi_create_int32(env, g_debug_backface_culled, &v));
   NAPI_CALL(env, napi_set_named_property(env, result, "backfaceCulled", v));
 
@@ -1189,6 +6095,9 @@ static napi_value render_get_debug_stats(napi_env env, napi_callback_info info)
   NAPI_CALL(env, napi_create_int32(env, g_debug_triangles_textured, &v));
   NAPI_CALL(env, napi_set_named_property(env, result, "trianglesTextured", v));
 
+  NAPI_CALL(env, napi_create_int32(env, g_debug_triangles_lightmapped, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "trianglesLightmapped", v));
+
   NAPI_CALL(env, napi_get_boolean(env, g_enable_backface_culling, &v));
   NAPI_CALL(env, napi_set_named_property(env, result, "backfaceCullingEnabled", v));
 
@@ -1204,22 +6113,308 @@ static napi_value render_get_debug_stats(napi_env env, napi_callback_info info)
   NAPI_CALL(env, napi_create_int32(env, g_texture_height, &v));
   NAPI_CALL(env, napi_set_named_property(env, result, "textureHeight", v));
 
+  NAPI_CALL(env, napi_create_int32(env, g_bound_texture_id, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "boundTextureId", v));
+
+  NAPI_CALL(env, napi_create_string_utf8(env, g_raster_kernel_name, NAPI_AUTO_LENGTH, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "simdKernel", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_texture_uploads, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "textureUploads", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_texture_resident_count, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "texturesResident", v));
+
+  NAPI_CALL(env, napi_create_double(env, (double)g_texture_resident_bytes, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "textureResidentBytes", v));
+
+  NAPI_CALL(env, napi_create_double(env, (double)g_texture_budget, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "textureBudgetBytes", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_texture_evictions, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "textureEvictions", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_mesh_count, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "meshCount", v));
+
+  NAPI_CALL(env, napi_create_double(env, (double)g_mesh_bytes, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "meshBytes", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_vis_leaf, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "visLeaf", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_vis_cluster, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "visCluster", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_vis_visible, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "visBatches", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_vis_pvs_culled, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "visPvsCulled", v));
+
+  NAPI_CALL(env, napi_create_int32(env, g_debug_vis_frustum_culled, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "visFrustumCulled", v));
+
+  return result;
+}
+
+/**
+ * Turn the frame profiler on or off. Enabling clears the recorded events
+ * and frames and restarts trace timestamps at zero.
+ * Args: enabled (boolean)
+ */
+static napi_value render_set_profiling(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  bool enabled = false;
+  if (argc >= 1) NAPI_CALL(env, napi_get_value_bool(env, args[0], &enabled));
+
+  // With no frame in flight only idle workers hold open scopes, and those
+  // started before the new epoch are dropped
+  wait_frame_idle();
+  JobSystem* js = jobs_get();
+  if (js) js->set_observer(js, enabled ? prof_job_span : NULL, NULL);
+  __atomic_store_n(&g_prof_enabled, false, __ATOMIC_RELAXED);
+  if (enabled) {
+    memset(g_prof_events, 0, sizeof(g_prof_events));
+    memset(g_prof_frames, 0, sizeof(g_prof_frames));
+    memset(g_prof_stage_ns, 0, sizeof(g_prof_stage_ns));
+    g_prof_head = 0;
+    g_prof_frame = 0;
+    g_prof_frames_done = 0;
+    g_prof_epoch_ns = prof_clock_ns();
+    __atomic_store_n(&g_prof_enabled, true, __ATOMIC_RELEASE);
+  }
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+/**
+ * Record a stage timed outside the addon (jsFrame, jsCopy, jsOutput), ending
+ * now on the calling thread.
+ * Args: stage (index into the stage list of getProfileStats), durationMs
+ */
+static napi_value render_record_profile_event(napi_env env, napi_callback_info info) {
+  size_t argc = 2;
+  napi_value args[2];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  if (argc < 2) {
+    napi_throw_error(env, NULL, "Expected 2 arguments: stage, durationMs");
+    return NULL;
+  }
+  int32_t stage;
+  double duration_ms;
+  NAPI_CALL(env, napi_get_value_int32(env, args[0], &stage));
+  NAPI_CALL(env, napi_get_value_double(env, args[1], &duration_ms));
+
+  if (stage >= 0 && stage < PROF_STAGE_COUNT && duration_ms >= 0 &&
+      __atomic_load_n(&g_prof_enabled, __ATOMIC_RELAXED)) {
+    uint64_t end = prof_clock_ns();
+    uint64_t dur = (uint64_t)(duration_ms * 1e6);
+    if (dur < end) prof_record(stage, 0, end - dur, end);
+  }
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_undefined(env, &result));
+  return result;
+}
+
+static int compare_u64(const void* a, const void* b) {
+  uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+  return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted values, in ms
+static double prof_percentile_ms(const uint64_t* sorted, int n, double p) {
+  int rank = (int)ceil(p * n) - 1;
+  return sorted[CLAMP(rank, 0, n - 1)] / 1e6;
+}
+
+/**
+ * Per-stage frame time percentiles over the last recorded frames. Stages that
+ * run on several threads (workerBusy, workerIdle) are summed over threads.
+ * Args: frames (optional, default and max 256)
+ * Returns: { frames, stages: [{ name, p50, p99, max, mean }] } in ms, in stage order
+ */
+static napi_value render_get_profile_stats(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  int32_t want = PROF_FRAMES;
+  if (argc >= 1) NAPI_CALL(env, napi_get_value_int32(env, args[0], &want));
+
+  // Frames are closed by whichever thread runs setOptions; let the render thread finish
+  wait_frame_idle();
+  uint32_t done = __atomic_load_n(&g_prof_frames_done, __ATOMIC_ACQUIRE);
+  int n = (int)MIN(done, (uint32_t)PROF_FRAMES);
+  n = CLAMP(want, 0, n);
+
+  napi_value result, stages, v;
+  NAPI_CALL(env, napi_create_object(env, &result));
+  NAPI_CALL(env, napi_create_int32(env, n, &v));
+  NAPI_CALL(env, napi_set_named_property(env, result, "frames", v));
+  NAPI_CALL(env, napi_create_array_with_length(env, PROF_STAGE_COUNT, &stages));
+  NAPI_CALL(env, napi_set_named_property(env, result, "stages", stages));
+
+  uint64_t values[PROF_FRAMES];
+  for (int s = 0; s < PROF_STAGE_COUNT; s++) {
+    uint64_t total = 0;
+    for (int i = 0; i < n; i++) {
+      values[i] = g_prof_frames[(done - 1 - i) % PROF_FRAMES].stage_ns[s];
+      total += values[i];
+    }
+    qsort(values, n, sizeof(uint64_t), compare_u64);
+
+    napi_value stage;
+    NAPI_CALL(env, napi_create_object(env, &stage));
+    NAPI_CALL(env, napi_create_string_utf8(env, g_prof_stage_names[s], NAPI_AUTO_LENGTH, &v));
+    NAPI_CALL(env, napi_set_named_property(env, stage, "name", v));
+    NAPI_CALL(env, napi_create_double(env, n ? prof_percentile_ms(values, n, 0.5) : 0, &v));
+    NAPI_CALL(env, napi_set_named_property(env, stage, "p50", v));
+    NAPI_CALL(env, napi_create_double(env, n ? prof_percentile_ms(values, n, 0.99) : 0, &v));
+    NAPI_CALL(env, napi_set_named_property(env, stage, "p99", v));
+    NAPI_CALL(env, napi_create_double(env, n ? values[n - 1] / 1e6 : 0, &v));
+    NAPI_CALL(env, napi_set_named_property(env, stage, "max", v));
+    NAPI_CALL(env, napi_create_double(env, n ? total / 1e6 / n : 0, &v));
+    NAPI_CALL(env, napi_set_named_property(env, stage, "mean", v));
+    NAPI_CALL(env, napi_set_element(env, stages, s, stage));
+  }
+  return result;
+}
+
+/**
+ * Export the event ring as Chrome trace JSON (chrome://tracing, Perfetto):
+ * one complete ("X") event per scope, one track per thread. Reading does not
+ * stop the threads; slots overwritten while copying are left out.
+ * Args: frames (optional: only the last N frames, default everything in the ring)
+ * Returns: JSON string
+ */
+static napi_value render_get_profile_trace(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  int32_t frames = 0;
+  if (argc >= 1) NAPI_CALL(env, napi_get_value_int32(env, args[0], &frames));
+
+  uint64_t head = __atomic_load_n(&g_prof_head, __ATOMIC_ACQUIRE);
+  uint64_t first = head > PROF_EVENTS ? head - PROF_EVENTS : 0;
+  uint32_t current = __atomic_load_n(&g_prof_frame, __ATOMIC_RELAXED);
+  uint32_t min_frame = frames > 0 && current >= (uint32_t)frames ? current - (uint32_t)frames + 1 : 0;
+
+  // Copy published slots out of the ring (seqlock read)
+  ProfEvent* events = (ProfEvent*)malloc(sizeof(ProfEvent) * (size_t)MAX(head - first, 1));
+  if (!events) {
+    napi_throw_error(env, NULL, "Failed to allocate trace");
+    return NULL;
+  }
+  size_t count = 0;
+  int max_tid = PROF_TID_RENDER;
+  for (uint64_t i = first; i < head; i++) {
+    const ProfEvent* slot = &g_prof_events[i & (PROF_EVENTS - 1)];
+    uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    ProfEvent e = *slot;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (seq != i + 1 || __atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) continue;
+    if (e.frame < min_frame) continue;
+    events[count++] = e;
+    max_tid = MAX(max_tid, (int)e.tid);
+  }
+
+  // Thread names, then events; no field is longer than a stage name or a 64-bit number
+  size_t cap = 256 + (size_t)(max_tid + 1) * 96 + count * 192;
+  char* json = (char*)malloc(cap);
+  if (!json) {
+    free(events);
+    napi_throw_error(env, NULL, "Failed to allocate trace");
+    return NULL;
+  }
+  size_t len = (size_t)snprintf(json, cap, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  for (int t = 0; t <= max_tid; t++) {
+    char name[32];
+    if (t == PROF_TID_JS) snprintf(name, sizeof(name), "js");
+    else if (t == PROF_TID_RENDER) snprintf(name, sizeof(name), "render");
+    else snprintf(name, sizeof(name), "worker %d", t - PROF_TID_WORKER0);
+    len += (size_t)snprintf(json + len, cap - len,
+                            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                            t ? "," : "", t, name);
+  }
+  for (size_t i = 0; i < count; i++) {
+    const ProfEvent* e = &events[i];
+    // Worker jobs are named after the stage they ran
+    bool job = e->stage == PROF_WORKER_BUSY && e->job < PROF_STAGE_COUNT && e->job != PROF_WORKER_BUSY;
+    len += (size_t)snprintf(json + len, cap - len,
+                            ",{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                            "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}",
+                            g_prof_stage_names[job ? e->job : e->stage],
+                            e->tid >= PROF_TID_WORKER0 ? g_prof_stage_names[e->stage] : "renderer",
+                            (int)e->tid, e->start_ns / 1000.0, e->dur_ns / 1000.0, e->frame);
+  }
+  len += (size_t)snprintf(json + len, cap - len, "]}");
+  free(events);
+
+  napi_value result;
+  napi_status created = napi_create_string_utf8(env, json, MIN(len, cap - 1), &result);
+  free(json);
+  NAPI_CALL(env, created);
   return result;
 }
 
 /**
- * Check SIMD availability.
+ * Check SIMD availability (true if a vector raster kernel is selected).
  */
 static napi_value render_has_simd(napi_env env, napi_callback_info info) {
   napi_value result;
-  bool has_simd = false;
-#if defined(USE_NEON) || defined(USE_SSE2)
-  has_simd = true;
-#endif
+  bool has_simd = g_raster_kernel != raster_kernel_scalar;
   NAPI_CALL(env, napi_get_boolean(env, has_simd, &result));
   return result;
 }
 
+/**
+ * Get the active raster kernel: "avx2", "sse4.1", "neon" or "scalar".
+ */
+static napi_value render_get_simd_level(napi_env env, napi_callback_info info) {
+  napi_value result;
+  NAPI_CALL(env, napi_create_string_utf8(env, g_raster_kernel_name, NAPI_AUTO_LENGTH, &result));
+  return result;
+}
+
+/**
+ * Force a raster kernel (for benchmarking and A/B checks).
+ * Args: name ("auto", "avx2", "sse4.1", "neon", "scalar")
+ * Returns false (and keeps the current kernel) if unsupported on this CPU.
+ */
+static napi_value render_set_simd_level(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  NAPI_CALL(env, napi_get_cb_info(env, info, &argc, args, NULL, NULL));
+
+  wait_frame_idle();
+
+  if (argc < 1) {
+    napi_throw_error(env, NULL, "Expected 1 argument: name");
+    return NULL;
+  }
+
+  char name[16];
+  size_t len;
+  NAPI_CALL(env, napi_get_value_string_utf8(env, args[0], name, sizeof(name), &len));
+
+  // Finish work queued with the previous kernel first
+  flush_tiles();
+  bool ok = select_raster_kernel(name);
+
+  napi_value result;
+  NAPI_CALL(env, napi_get_boolean(env, ok, &result));
+  return result;
+}
+
 // Module init
 static napi_value Init(napi_env env, napi_value exports) {
   napi_property_descriptor props[] = {
@@ -1227,17 +6422,54 @@ static napi_value Init(napi_env env, napi_value exports) {
     { "clear", NULL, render_clear, NULL, NULL, NULL, napi_default, NULL },
     { "setOptions", NULL, render_set_options, NULL, NULL, NULL, napi_default, NULL },
     { "setTexture", NULL, render_set_texture, NULL, NULL, NULL, napi_default, NULL },
+    { "setTextureFilter", NULL, render_set_texture_filter, NULL, NULL, NULL, napi_default, NULL },
     { "renderTrianglesBatch", NULL, render_triangles_batch, NULL, NULL, NULL, napi_default, NULL },
+    { "uploadTexture", NULL, render_upload_texture, NULL, NULL, NULL, napi_default, NULL },
+    { "bindTexture", NULL, render_bind_texture, NULL, NULL, NULL, napi_default, NULL },
+    { "bindLightmap", NULL, render_bind_lightmap, NULL, NULL, NULL, napi_default, NULL },
+    { "destroyTexture", NULL, render_destroy_texture, NULL, NULL, NULL, napi_default, NULL },
+    { "setTextureBudget", NULL, render_set_texture_budget, NULL, NULL, NULL, napi_default, NULL },
+    { "createMesh", NULL, render_create_mesh, NULL, NULL, NULL, napi_default, NULL },
+    { "destroyMesh", NULL, render_destroy_mesh, NULL, NULL, NULL, napi_default, NULL },
+    { "drawMesh", NULL, render_draw_mesh, NULL, NULL, NULL, napi_default, NULL },
+    { "testOcclusion", NULL, render_test_occlusion, NULL, NULL, NULL, napi_default, NULL },
+    { "isMeshOccluded", NULL, render_is_mesh_occluded, NULL, NULL, NULL, napi_default, NULL },
+    { "setVisibility", NULL, render_set_visibility, NULL, NULL, NULL, napi_default, NULL },
+    { "cullVisible", NULL, render_cull_visible, NULL, NULL, NULL, napi_default, NULL },
+    { "submit", NULL, render_submit, NULL, NULL, NULL, napi_default, NULL },
     { "resolveMSAA", NULL, render_resolve_msaa, NULL, NULL, NULL, napi_default, NULL },
+    { "flush", NULL, render_flush, NULL, NULL, NULL, napi_default, NULL },
     { "getFramebuffer", NULL, render_get_framebuffer, NULL, NULL, NULL, napi_default, NULL },
     { "getDepthBuffer", NULL, render_get_depth_buffer, NULL, NULL, NULL, napi_default, NULL },
+    { "drawGlyphs", NULL, render_draw_glyphs, NULL, NULL, NULL, napi_default, NULL },
+    { "compositeCells", NULL, render_composite_cells, NULL, NULL, NULL, napi_default, NULL },
+    { "tintGlyphs", NULL, render_tint_glyphs, NULL, NULL, NULL, napi_default, NULL },
+    { "beginFrame", NULL, render_begin_frame, NULL, NULL, NULL, napi_default, NULL },
+    { "submitFrame", NULL, render_submit_frame, NULL, NULL, NULL, napi_default, NULL },
+    { "waitFrame", NULL, render_wait_frame, NULL, NULL, NULL, napi_default, NULL },
+    { "setFrameCallback", NULL, render_set_frame_callback, NULL, NULL, NULL, napi_default, NULL },
+    { "encodeHalfBlock", NULL, render_encode_half_block, NULL, NULL, NULL, napi_default, NULL },
+    { "encodeHalfBlockDiff", NULL, render_encode_half_block_diff, NULL, NULL, NULL, napi_default, NULL },
+    { "encodeSixel", NULL, render_encode_sixel, NULL, NULL, NULL, napi_default, NULL },
+    { "resetEncoder", NULL, render_reset_encoder, NULL, NULL, NULL, napi_default, NULL },
+    { "getEncodeStats", NULL, render_get_encode_stats, NULL, NULL, NULL, napi_default, NULL },
+    { "setRenderScale", NULL, render_set_render_scale, NULL, NULL, NULL, napi_default, NULL },
     { "getDimensions", NULL, render_get_dimensions, NULL, NULL, NULL, napi_default, NULL },
     { "cleanup", NULL, render_cleanup, NULL, NULL, NULL, napi_default, NULL },
     { "hasSIMD", NULL, render_has_simd, NULL, NULL, NULL, napi_default, NULL },
+    { "getSIMDLevel", NULL, render_get_simd_level, NULL, NULL, NULL, napi_default, NULL },
+    { "setSIMDLevel", NULL, render_set_simd_level, NULL, NULL, NULL, napi_default, NULL },
     { "getDebugStats", NULL, render_get_debug_stats, NULL, NULL, NULL, napi_default, NULL },
+    { "setProfiling", NULL, render_set_profiling, NULL, NULL, NULL, napi_default, NULL },
+    { "recordProfileEvent", NULL, render_record_profile_event, NULL, NULL, NULL, napi_default, NULL },
+    { "getProfileStats", NULL, render_get_profile_stats, NULL, NULL, NULL, napi_default, NULL },
+    { "getProfileTrace", NULL, render_get_profile_trace, NULL, NULL, NULL, napi_default, NULL },
+    JOB_SYSTEM_PROPERTIES,
   };
 
   NAPI_CALL(env, napi_define_properties(env, exports, sizeof(props) / sizeof(props[0]), props));
+
+  select_raster_kernel("auto");
   return exports;
 }
 
@@ -33,6 +33,16 @@ import {
   WEAPON_DEFS,
   DEFAULT_ECONOMY_CONFIG,
 } from './types.js';
+import { MapOcclusion } from './NativeBVH.js';
+import { TickScheduler, TickTask, getTickScheduler } from './TickScheduler.js';
+import {
+  SnapshotEncoder,
+  SnapshotClient,
+  ENTITY_PLAYER,
+  ENTITY_BOT,
+  ENTITY_WEAPON,
+  MAX_SNAPSHOT_ENTITIES,
+} from './SnapshotEncoder.js';
 
 // Game timing constants
 const WARMUP_TIME = 5;
@@ -56,19 +66,49 @@ const BOT_ACCURACY_EASY = 0.3;
 const BOT_ACCURACY_MEDIUM = 0.5;
 const BOT_ACCURACY_HARD = 0.8;
 
+// Snapshot interest culling
+const INTEREST_NEAR_DISTANCE = 8;   // Enemies this close are always sent (sound, peeking)
+const INTEREST_LINGER_MS = 500;     // Keep sending an enemy this long after losing sight
+
+/**
+ * Binary snapshot delivery (implemented by Room)
+ */
+export interface SnapshotTransport {
+  // Nothing queued on the client's socket, so its snapshot buffer can be reused
+  isIdle(clientId: string): boolean;
+  send(clientId: string, data: Uint8Array): void;
+}
+
+export interface GameRunnerOptions {
+  roomId?: string;                     // Name the tick stats are kept under
+  scheduler?: TickScheduler;           // Default: this thread's scheduler
+  collisionWorld?: Uint8Array | null;  // Shared map tree (buildSharedCollisionWorld)
+}
+
 export class GameRunner {
   private state: ServerGameState;
   private mapData: MapData;
+  private occlusion: MapOcclusion;
   private roomConfig: RoomConfig;
   private serverConfig: ServerConfig;
 
   // Callbacks
   private broadcast: (msg: ServerMessage) => void;
   private sendToClient: (clientId: string, msg: ServerMessage) => void;
+  private snapshotTransport: SnapshotTransport | null;
+
+  // Binary delta snapshots, per client that acknowledged one
+  private snapshotEncoder: SnapshotEncoder = new SnapshotEncoder();
+  private snapshotClients: Map<string, SnapshotClient> = new Map();
+  private interestMask: Uint8Array = new Uint8Array(MAX_SNAPSHOT_ENTITIES);
+  private interestSlots: number[] = [];
+  private interestFeet: Vec3 = createVec3();
 
-  // Intervals
-  private gameLoopInterval: ReturnType<typeof setInterval> | null = null;
-  private broadcastInterval: ReturnType<typeof setInterval> | null = null;
+  // Tick loops
+  private roomId: string;
+  private scheduler: TickScheduler;
+  private gameLoopTask: TickTask | null = null;
+  private broadcastTask: TickTask | null = null;
 
   // Timing
   private lastTickTime: number = 0;
@@ -84,14 +124,20 @@ export class GameRunner {
     roomConfig: RoomConfig,
     serverConfig: ServerConfig,
     broadcast: (msg: ServerMessage) => void,
-    sendToClient: (clientId: string, msg: ServerMessage) => void
+    sendToClient: (clientId: string, msg: ServerMessage) => void,
+    snapshotTransport: SnapshotTransport | null = null,
+    options: GameRunnerOptions = {}
   ) {
     this.state = state;
     this.mapData = mapData;
+    this.occlusion = new MapOcclusion(mapData.colliders, options.collisionWorld ?? null);
+    this.roomId = options.roomId ?? roomConfig.name;
+    this.scheduler = options.scheduler ?? getTickScheduler();
     this.roomConfig = roomConfig;
     this.serverConfig = serverConfig;
     this.broadcast = broadcast;
     this.sendToClient = sendToClient;
+    this.snapshotTransport = snapshotTransport;
 
     this.tickDeltaMs = 1000 / serverConfig.tickRate;
     this.broadcastDeltaMs = 1000 / serverConfig.broadcastRate;
@@ -104,29 +150,21 @@ export class GameRunner {
     this.state.phaseStartTime = Date.now();
     this.state.phase = 'warmup';
 
-    // Start game loop
-    this.gameLoopInterval = setInterval(
-      () => this.tick(),
-      this.tickDeltaMs
-    );
-
-    // Start broadcast loop
-    this.broadcastInterval = setInterval(
-      () => this.broadcastState(),
-      this.broadcastDeltaMs
-    );
+    // Game and broadcast loops run on the thread's deadline scheduler
+    this.gameLoopTask = this.scheduler.add(this.roomId, this.tickDeltaMs, () => this.tick());
+    this.broadcastTask = this.scheduler.add(this.roomId, this.broadcastDeltaMs, () => this.broadcastState());
 
     console.log('GameRunner started');
   }
 
   stop(): void {
-    if (this.gameLoopInterval) {
-      clearInterval(this.gameLoopInterval);
-      this.gameLoopInterval = null;
+    if (this.gameLoopTask) {
+      this.gameLoopTask.cancel();
+      this.gameLoopTask = null;
     }
-    if (this.broadcastInterval) {
-      clearInterval(this.broadcastInterval);
-      this.broadcastInterval = null;
+    if (this.broadcastTask) {
+      this.broadcastTask.cancel();
+      this.broadcastTask = null;
     }
     console.log('GameRunner stopped');
   }
@@ -135,6 +173,14 @@ export class GameRunner {
     return this.state.phase;
   }
 
+  /**
+   * Position of a live player (null if dead or not in the game)
+   */
+  getPlayerPosition(clientId: string): Vec3 | null {
+    const player = this.state.players.get(clientId);
+    return player && player.isAlive ? player.position : null;
+  }
+
   // ============ Player Management ============
 
   addPlayer(clientId: string, name: string, team: TeamId): void {
@@ -174,6 +220,7 @@ export class GameRunner {
 
   removePlayer(clientId: string): void {
     this.state.players.delete(clientId);
+    this.snapshotClients.delete(clientId);
   }
 
   addBot(name: string, team: TeamId, difficulty: BotDifficulty): void {
@@ -214,6 +261,20 @@ export class GameRunner {
 
   // ============ Input Handling ============
 
+  /**
+   * Client acknowledged a binary snapshot. The first ack (sequence 0) switches
+   * it from JSON game_state to binary delta snapshots.
+   */
+  handleSnapshotAck(clientId: string, sequence: number): void {
+    if (!this.snapshotTransport || !this.state.players.has(clientId)) return;
+    let client = this.snapshotClients.get(clientId);
+    if (!client) {
+      client = new SnapshotClient();
+      this.snapshotClients.set(clientId, client);
+    }
+    client.acknowledge(sequence);
+  }
+
   handleInput(clientId: string, message: ClientMessage): void {
     const player = this.state.players.get(clientId);
     if (!player || !player.isAlive) return;
@@ -770,30 +831,34 @@ export class GameRunner {
   }
 
   private findBotTarget(bot: ServerBotState): { id: string; position: Vec3 } | null {
-    let closestDist = Infinity;
-    let closest: { id: string; position: Vec3 } | null = null;
+    const candidates: { id: string; position: Vec3; dist: number }[] = [];
 
     // Check players
     for (const player of this.state.players.values()) {
       if (!player.isAlive || player.team === bot.team) continue;
-      const dist = vec3Distance(bot.position, player.position);
-      if (dist < closestDist) {
-        closestDist = dist;
-        closest = { id: player.id, position: player.position };
-      }
+      candidates.push({ id: player.id, position: player.position, dist: vec3Distance(bot.position, player.position) });
     }
 
     // Check other bots
     for (const otherBot of this.state.bots.values()) {
       if (!otherBot.isAlive || otherBot.team === bot.team || otherBot.id === bot.id) continue;
-      const dist = vec3Distance(bot.position, otherBot.position);
-      if (dist < closestDist) {
-        closestDist = dist;
-        closest = { id: otherBot.id, position: otherBot.position };
-      }
+      candidates.push({ id: otherBot.id, position: otherBot.position, dist: vec3Distance(bot.position, otherBot.position) });
+    }
+
+    if (candidates.length === 0) return null;
+    candidates.sort((a, b) => a.dist - b.dist);
+
+    // Closest enemy with line of sight (one batched query for all candidates)
+    if (this.occlusion.isActive) {
+      this.occlusion.begin();
+      for (const c of candidates) this.occlusion.add(bot.position, c.position);
+      this.occlusion.run();
+      const visible = candidates.findIndex((_, i) => this.occlusion.isClear(i));
+      if (visible < 0) return null;
+      return { id: candidates[visible].id, position: candidates[visible].position };
     }
 
-    return closest;
+    return { id: candidates[0].id, position: candidates[0].position };
   }
 
   private botFire(bot: ServerBotState, target: { id: string; position: Vec3 }, now: number): void {
@@ -876,15 +941,17 @@ export class GameRunner {
     direction: Vec3,
     weaponDef: typeof WEAPON_DEFS[WeaponType]
   ): void {
-    // Check against all enemies
+    // Collect every enemy the ray passes, then discard those behind walls
+    // with one batched occlusion query
+    const hits: { player?: ServerPlayerState; bot?: ServerBotState; isHeadshot: boolean }[] = [];
+    this.occlusion.begin();
+
     for (const player of this.state.players.values()) {
       if (!player.isAlive || player.team === attacker.team) continue;
       const hit = this.checkRayHit(attacker.position, direction, player.position, weaponDef.range);
       if (hit) {
-        const damage = hit.isHeadshot
-          ? weaponDef.damage * weaponDef.headshotMultiplier
-          : weaponDef.damage;
-        this.damagePlayer(player, damage, hit.isHeadshot, attacker.id, attacker.name, attacker.currentWeapon);
+        this.occlusion.add(attacker.position, hit.point);
+        hits.push({ player, isHeadshot: hit.isHeadshot });
       }
     }
 
@@ -892,10 +959,24 @@ export class GameRunner {
       if (!bot.isAlive || bot.team === attacker.team) continue;
       const hit = this.checkRayHit(attacker.position, direction, bot.position, weaponDef.range);
       if (hit) {
-        const damage = hit.isHeadshot
-          ? weaponDef.damage * weaponDef.headshotMultiplier
-          : weaponDef.damage;
-        this.damageBot(bot, damage, hit.isHeadshot, attacker.id, attacker.name, attacker.currentWeapon);
+        this.occlusion.add(attacker.position, hit.point);
+        hits.push({ bot, isHeadshot: hit.isHeadshot });
+      }
+    }
+
+    if (hits.length === 0) return;
+    this.occlusion.run();
+
+    for (let i = 0; i < hits.length; i++) {
+      if (!this.occlusion.isClear(i)) continue;
+      const { player, bot, isHeadshot } = hits[i];
+      const damage = isHeadshot
+        ? weaponDef.damage * weaponDef.headshotMultiplier
+        : weaponDef.damage;
+      if (player) {
+        this.damagePlayer(player, damage, isHeadshot, attacker.id, attacker.name, attacker.currentWeapon);
+      } else if (bot) {
+        this.damageBot(bot, damage, isHeadshot, attacker.id, attacker.name, attacker.currentWeapon);
       }
     }
   }
@@ -905,7 +986,7 @@ export class GameRunner {
     direction: Vec3,
     targetPos: Vec3,
     maxDist: number
-  ): { isHeadshot: boolean } | null {
+  ): { isHeadshot: boolean; point: Vec3 } | null {
     // Simplified ray-sphere intersection
     const toTarget = vec3Sub(targetPos, origin);
     const dist = vec3Length(toTarget);
@@ -923,7 +1004,7 @@ export class GameRunner {
       // Hit! Check if headshot (target y is close to head height)
       const hitY = closestPoint.y - (targetPos.y - PLAYER_EYE_HEIGHT);
       const isHeadshot = hitY > 1.5;
-      return { isHeadshot };
+      return { isHeadshot, point: closestPoint };
     }
 
     return null;
@@ -1053,13 +1134,104 @@ export class GameRunner {
 
   private broadcastState(): void {
     const snapshot = this.createSnapshot();
-    this.broadcast({
+    const message: ServerMessage = {
       type: 'game_state',
       state: snapshot,
-    });
+    };
+
+    if (this.snapshotClients.size === 0) {
+      this.broadcast(message);
+    } else {
+      // JSON for clients that never acknowledged a binary snapshot
+      for (const clientId of this.state.players.keys()) {
+        if (!this.snapshotClients.has(clientId)) this.sendToClient(clientId, message);
+      }
+      this.broadcastSnapshots(snapshot);
+    }
     this.state.lastBroadcastTick = this.state.tick;
   }
 
+  /**
+   * Encode and send a binary delta snapshot to every client using them.
+   */
+  private broadcastSnapshots(snapshot: GameStateSnapshot): void {
+    const encoder = this.snapshotEncoder;
+    encoder.beginWorld(snapshot);
+    for (const p of snapshot.players) {
+      encoder.setEntity(ENTITY_PLAYER, p.id, p.name, p.position.x, p.position.y, p.position.z,
+        p.yaw, p.pitch, p.health, p.armor, p.isAlive, p.team, p.currentWeapon, p.money, p.kills, p.deaths);
+    }
+    for (const b of snapshot.bots) {
+      encoder.setEntity(ENTITY_BOT, b.id, b.name, b.position.x, b.position.y, b.position.z,
+        b.yaw, b.pitch, b.health, b.armor, b.isAlive, b.team, b.currentWeapon, 0, b.kills, b.deaths);
+    }
+    for (const w of snapshot.droppedWeapons) {
+      encoder.setEntity(ENTITY_WEAPON, w.id, '', w.position.x, w.position.y, w.position.z,
+        0, 0, 0, 0, false, 'SPECTATOR', w.weaponType, 0, 0, 0);
+    }
+    encoder.endWorld();
+
+    const transport = this.snapshotTransport!;
+    for (const [clientId, client] of this.snapshotClients) {
+      // Skip a backlogged client; it gets the next snapshot against the same baseline
+      if (!transport.isIdle(clientId)) continue;
+      const visible = this.computeInterest(clientId, client, snapshot.timestamp);
+      transport.send(clientId, encoder.encode(client, visible));
+    }
+  }
+
+  /**
+   * Interest culling: which entities a client is sent a position for (the
+   * rest are sent dormant, so the client keeps them on its scoreboard).
+   * The map has no PVS, so enemies are culled by line of sight through the
+   * collision BVH (eye to eye and eye to feet), kept for a short linger after
+   * losing sight and always sent when close. Self, teammates and dropped
+   * weapons are always sent; dead players and spectators get everything.
+   * @returns per-slot mask, or null for every entity
+   */
+  private computeInterest(clientId: string, client: SnapshotClient, now: number): Uint8Array | null {
+    const viewer = this.state.players.get(clientId);
+    if (!viewer || !viewer.isAlive || viewer.team === 'SPECTATOR' || !this.occlusion.isActive) return null;
+
+    const encoder = this.snapshotEncoder;
+    const mask = this.interestMask;
+    const slots = this.interestSlots;
+    mask.fill(1);
+    slots.length = 0;
+
+    const eye = viewer.position;
+    const feet = this.interestFeet;
+    this.occlusion.begin();
+    const consider = (id: string, team: TeamId, isAlive: boolean, position: Vec3): void => {
+      if (team === viewer.team || !isAlive) return;
+      const slot = encoder.slotOf(id);
+      if (slot < 0) return;
+      if (vec3Distance(eye, position) <= INTEREST_NEAR_DISTANCE) {
+        client.lastVisible[slot] = now;
+        return;
+      }
+      feet.x = position.x;
+      feet.y = position.y - PLAYER_EYE_HEIGHT + 0.1;
+      feet.z = position.z;
+      this.occlusion.add(eye, position);
+      this.occlusion.add(eye, feet);
+      slots.push(slot);
+    };
+    for (const p of this.state.players.values()) consider(p.id, p.team, p.isAlive, p.position);
+    for (const b of this.state.bots.values()) consider(b.id, b.team, b.isAlive, b.position);
+    this.occlusion.run();
+
+    for (let i = 0; i < slots.length; i++) {
+      const slot = slots[i];
+      if (this.occlusion.isClear(i * 2) || this.occlusion.isClear(i * 2 + 1)) {
+        client.lastVisible[slot] = now;
+      } else if (now - client.lastVisible[slot] > INTEREST_LINGER_MS) {
+        mask[slot] = 0;
+      }
+    }
+    return mask;
+  }
+
   private createSnapshot(): GameStateSnapshot {
     const now = Date.now();
     const elapsed = (now - this.state.phaseStartTime) / 1000;
@@ -0,0 +1,153 @@
+// Map occlusion for hit detection and bot sight, backed by the native bvh addon
+// (native/bvh_simd.c). Map colliders are boxes, so each one becomes 12 triangles.
+// Without the addon every query reports a clear line, which is the old behaviour.
+
+import { fileURLToPath } from 'url';
+import { dirname, join } from 'path';
+import { createRequire } from 'module';
+import { MapCollider, Vec3 } from './types.js';
+
+// Batch layouts (match RAY_STRIDE / HIT_STRIDE in native/bvh_simd.c)
+export const BVH_RAY_STRIDE = 7;  // ox, oy, oz, dx, dy, dz, maxDistance
+export const BVH_HIT_STRIDE = 5;  // distance (-1 = miss), triangle index, nx, ny, nz
+
+interface NativeBVHModule {
+  createBVH(triangles: Float32Array): object;
+  raycastBatch(handle: object, rays: Float32Array, hits: Float32Array, anyHit?: boolean): number;
+  serializeBVH?(handle: object): ArrayBuffer;
+  viewBVH?(blob: Uint8Array): object | null;
+}
+
+let nativeModule: NativeBVHModule | null | undefined;
+
+function loadNativeModule(): NativeBVHModule | null {
+  if (nativeModule !== undefined) return nativeModule;
+  try {
+    const require = createRequire(import.meta.url);
+    const here = dirname(fileURLToPath(import.meta.url));
+    nativeModule = require(join(here, '../../native/build/Release/bvh.node')) as NativeBVHModule;
+  } catch {
+    nativeModule = null;
+  }
+  return nativeModule;
+}
+
+// Two triangles per box face
+const BOX_FACES: [number, number, number][] = [
+  [0, 1, 3], [0, 3, 2],  // -X
+  [4, 6, 7], [4, 7, 5],  // +X
+  [0, 4, 5], [0, 5, 1],  // -Y
+  [2, 3, 7], [2, 7, 6],  // +Y
+  [0, 2, 6], [0, 6, 4],  // -Z
+  [1, 5, 7], [1, 7, 3],  // +Z
+];
+
+function packColliders(colliders: MapCollider[]): Float32Array {
+  const data = new Float32Array(colliders.length * BOX_FACES.length * 9);
+  let o = 0;
+  for (const c of colliders) {
+    // Corner i: bit 2 = x, bit 1 = y, bit 0 = z
+    const corner = (i: number, axis: number): number => {
+      const bit = 2 - axis;
+      const useMax = (i >> bit) & 1;
+      const src = useMax ? c.max : c.min;
+      return axis === 0 ? src.x : axis === 1 ? src.y : src.z;
+    };
+    for (const face of BOX_FACES) {
+      for (const i of face) {
+        data[o++] = corner(i, 0);
+        data[o++] = corner(i, 1);
+        data[o++] = corner(i, 2);
+      }
+    }
+  }
+  return data;
+}
+
+/**
+ * Build a map's tree once into shared memory, for every room worker to view
+ * in place (MapOcclusion's shared argument). Null without an addon that can
+ * serialize, or for a map without colliders.
+ */
+export function buildSharedCollisionWorld(colliders: MapCollider[]): Uint8Array | null {
+  const module = loadNativeModule();
+  if (!module || !module.serializeBVH || !module.viewBVH || colliders.length === 0) return null;
+  try {
+    const blob = new Uint8Array(module.serializeBVH(module.createBVH(packColliders(colliders))));
+    const shared = new Uint8Array(new SharedArrayBuffer(blob.length));
+    shared.set(blob);
+    return shared;
+  } catch (error) {
+    console.warn(`[MapOcclusion] Shared BVH build failed: ${error}`);
+    return null;
+  }
+}
+
+export class MapOcclusion {
+  private module: NativeBVHModule | null;
+  private handle: object | null = null;
+  private rays = new Float32Array(16 * BVH_RAY_STRIDE);
+  private hits = new Float32Array(16 * BVH_HIT_STRIDE);
+  private count = 0;
+
+  /**
+   * @param shared Tree from buildSharedCollisionWorld() to use in place of
+   *               building one (falls back to building if it can't be used)
+   */
+  constructor(colliders: MapCollider[], shared: Uint8Array | null = null) {
+    this.module = loadNativeModule();
+    if (!this.module || colliders.length === 0) return;
+    if (shared && this.module.viewBVH) {
+      this.handle = this.module.viewBVH(shared);
+      if (this.handle) return;
+    }
+    try {
+      this.handle = this.module.createBVH(packColliders(colliders));
+    } catch (error) {
+      console.warn(`[MapOcclusion] BVH build failed: ${error}`);
+      this.handle = null;
+    }
+  }
+
+  // True when walls are checked (addon built and map has colliders)
+  get isActive(): boolean {
+    return this.handle !== null;
+  }
+
+  // Start a new batch of segment queries
+  begin(): void {
+    this.count = 0;
+  }
+
+  // Queue a segment from -> to; returns its index in the batch
+  add(from: Vec3, to: Vec3): number {
+    if (this.count * BVH_RAY_STRIDE >= this.rays.length) {
+      const rays = new Float32Array(this.rays.length * 2);
+      rays.set(this.rays);
+      this.rays = rays;
+      this.hits = new Float32Array(this.hits.length * 2);
+    }
+    const o = this.count * BVH_RAY_STRIDE;
+    // Unnormalized direction: distance 1 is the end point
+    this.rays[o] = from.x;
+    this.rays[o + 1] = from.y;
+    this.rays[o + 2] = from.z;
+    this.rays[o + 3] = to.x - from.x;
+    this.rays[o + 4] = to.y - from.y;
+    this.rays[o + 5] = to.z - from.z;
+    this.rays[o + 6] = 1;
+    return this.count++;
+  }
+
+  // Trace every queued segment in one native call (any-hit)
+  run(): void {
+    if (!this.module || !this.handle || this.count === 0) return;
+    this.module.raycastBatch(this.handle, this.rays.subarray(0, this.count * BVH_RAY_STRIDE), this.hits, true);
+  }
+
+  // Whether segment `index` of the last run() is unobstructed
+  isClear(index: number): boolean {
+    if (!this.handle) return true;
+    return this.hits[index * BVH_HIT_STRIDE] < 0;
+  }
+}
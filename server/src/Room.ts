@@ -22,7 +22,7 @@ import {
   WEAPON_DEFS,
   DEFAULT_ECONOMY_CONFIG,
 } from './types.js';
-import { GameRunner } from './GameRunner.js';
+import { RoomRunner, RoomWorkerPool } from './workers/RoomWorkerPool.js';
 import { VoiceRelay, getVoiceRelay, removeVoiceRelay, isVoiceFrame } from './VoiceRelay.js';
 
 // Default map data for dm_arena
@@ -89,7 +89,8 @@ export class Room {
   public lastActivity: number;
 
   private clients: Map<string, ConnectedClient> = new Map();
-  private gameRunner: GameRunner | null = null;
+  private gameRunner: RoomRunner | null = null;
+  private runners: RoomWorkerPool;
   private serverConfig: ServerConfig;
   private mapData: MapData;
 
@@ -103,15 +104,18 @@ export class Room {
     id: string,
     config: RoomConfig,
     hostId: string,
-    serverConfig: ServerConfig
+    serverConfig: ServerConfig,
+    runners: RoomWorkerPool
   ) {
     this.id = id;
+    this.runners = runners;
     this.config = config;
     this.hostId = hostId;
     this.serverConfig = serverConfig;
     this.lastActivity = Date.now();
     this.mapData = DEFAULT_MAP;
     this.voiceRelay = getVoiceRelay(id);
+    this.voiceRelay.setPositionSource((clientId) => this.gameRunner?.getPlayerPosition(clientId) ?? null);
   }
 
   // ============ Player Management ============
@@ -230,7 +234,8 @@ export class Room {
       return;
     }
 
-    // Notify clients game is starting
+    // Notify clients game is starting (this also offers binary snapshots: the
+    // new runner has no snapshot clients, so each client acks 0 again)
     this.broadcast({
       type: 'game_starting',
       countdown: 0,  // Start immediately
@@ -239,14 +244,24 @@ export class Room {
     // Create game state
     const gameState = this.createInitialGameState();
 
-    // Create game runner
-    this.gameRunner = new GameRunner(
+    // Create game runner (on a room worker when the pool has them)
+    this.gameRunner = this.runners.createRunner(
+      this.id,
       gameState,
       this.mapData,
       this.config,
       this.serverConfig,
-      (msg) => this.broadcast(msg),
-      (clientId, msg) => this.sendToClient(clientId, msg)
+      {
+        broadcast: (msg) => this.broadcast(msg),
+        sendToClient: (clientId, msg) => this.sendToClient(clientId, msg),
+        broadcastSerialized: (data) => this.broadcastSerialized(data),
+        sendSerialized: (clientId, data) => this.sendSerialized(clientId, data),
+        snapshots: {
+          isIdle: (clientId) => this.isSocketIdle(clientId),
+          send: (clientId, data) => this.sendBinaryToClient(clientId, data),
+        },
+        lost: (reason) => this.endLostGame(reason),
+      }
     );
 
     // Add all connected players
@@ -313,6 +328,31 @@ export class Room {
     };
   }
 
+  /**
+   * The game stopped without us (its room worker died): back to the lobby so
+   * the players aren't left in a frozen match and a new game can start
+   */
+  private endLostGame(reason: string): void {
+    if (!this.gameRunner) return;
+    this.gameRunner = null;
+    console.error(`Game in room ${this.id} lost: ${reason}`);
+
+    this.broadcast({
+      type: 'chat_received',
+      senderId: '',
+      senderName: 'Server',
+      message: `Game ended: ${reason}`,
+      teamOnly: false,
+    });
+    this.broadcast({
+      type: 'phase_change',
+      phase: 'pre_match',
+      roundNumber: 0,
+      tScore: 0,
+      ctScore: 0,
+    });
+  }
+
   stop(): void {
     if (this.gameRunner) {
       this.gameRunner.stop();
@@ -367,6 +407,12 @@ export class Room {
         this.handleChat(clientId, message.message, message.teamOnly);
         break;
 
+      case 'snapshot_ack':
+        if (this.gameRunner && typeof message.sequence === 'number') {
+          this.gameRunner.handleSnapshotAck(clientId, message.sequence);
+        }
+        break;
+
       default:
         break;
     }
@@ -471,7 +517,10 @@ export class Room {
   // ============ Communication ============
 
   broadcast(message: ServerMessage): void {
-    const data = serializeServerMessage(message);
+    this.broadcastSerialized(serializeServerMessage(message));
+  }
+
+  broadcastSerialized(data: string): void {
     for (const client of this.clients.values()) {
       if (client.socket.readyState === WebSocket.OPEN) {
         try {
@@ -507,6 +556,34 @@ export class Room {
     }
   }
 
+  sendSerialized(clientId: string, data: string): void {
+    const client = this.clients.get(clientId);
+    if (!client || client.socket.readyState !== WebSocket.OPEN) return;
+
+    try {
+      client.socket.send(data);
+    } catch (e) {
+      // Ignore send errors
+    }
+  }
+
+  sendBinaryToClient(clientId: string, data: Uint8Array): void {
+    const client = this.clients.get(clientId);
+    if (!client || client.socket.readyState !== WebSocket.OPEN) return;
+
+    try {
+      client.socket.send(data);
+    } catch (e) {
+      // Ignore send errors
+    }
+  }
+
+  // Open with nothing left in its send queue
+  private isSocketIdle(clientId: string): boolean {
+    const client = this.clients.get(clientId);
+    return !!client && client.socket.readyState === WebSocket.OPEN && client.socket.bufferedAmount === 0;
+  }
+
   // ============ Info ============
 
   getInfo(): RoomInfo {
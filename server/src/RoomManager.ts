@@ -3,6 +3,7 @@
 import { v4 as uuidv4 } from 'uuid';
 import { WebSocket } from 'ws';
 import { Room } from './Room.js';
+import { PoolLoadReport, RoomWorkerPool } from './workers/RoomWorkerPool.js';
 import {
   RoomConfig,
   RoomInfo,
@@ -16,6 +17,7 @@ export class RoomManager {
   private rooms: Map<string, Room> = new Map();
   private clients: Map<string, ConnectedClient> = new Map();
   private config: ServerConfig;
+  private runners: RoomWorkerPool;
 
   // Cleanup interval
   private cleanupInterval: ReturnType<typeof setInterval> | null = null;
@@ -26,6 +28,7 @@ export class RoomManager {
 
   constructor(config: Partial<ServerConfig> = {}) {
     this.config = { ...DEFAULT_SERVER_CONFIG, ...config };
+    this.runners = new RoomWorkerPool(this.config);
 
     // Start cleanup interval (every 30 seconds)
     this.cleanupInterval = setInterval(() => this.cleanup(), 30000);
@@ -91,7 +94,7 @@ export class RoomManager {
     if (config.botCount > 8) config.botCount = 8;
 
     const roomId = uuidv4().substring(0, 8);
-    const room = new Room(roomId, config, clientId, this.config);
+    const room = new Room(roomId, config, clientId, this.config, this.runners);
     this.rooms.set(roomId, room);
 
     console.log(`Room created: ${roomId} by ${clientId} (${config.name})`);
@@ -320,6 +323,7 @@ export class RoomManager {
       room.stop();
     }
     this.rooms.clear();
+    this.runners.shutdown();
 
     // Close all client connections
     for (const client of this.clients.values()) {
@@ -342,4 +346,9 @@ export class RoomManager {
       clients: this.clients.size,
     };
   }
+
+  // Measured cost of the running games (see RoomWorkerPool)
+  getLoadReport(): PoolLoadReport {
+    return this.runners.getLoadReport();
+  }
 }
@@ -0,0 +1,517 @@
+/**
+ * SnapshotEncoder - Binary delta snapshots for the broadcast loop
+ *
+ * Instead of the full JSON game_state, clients that acknowledge snapshots
+ * (snapshot_ack) get a bit-packed binary message encoded against the last
+ * snapshot they acknowledged, so entities that did not change cost a few
+ * bits and unchanged clients almost nothing:
+ *
+ * - Entities (players, bots, dropped weapons) live in numbered slots; ids and
+ *   names are only sent when an entity enters a client's view
+ * - Positions are quantized to 1/64 unit and sent as small deltas when
+ *   possible, angles to 16 bits, the rest at the field's width
+ * - Without a usable baseline (first snapshot, ack too old) the snapshot is
+ *   encoded against nothing, i.e. in full
+ * - Each client can be sent a subset of entities (interest culling). A
+ *   culled entity stays in the client's snapshot as dormant: everything but
+ *   its position and angles keeps updating, so scoreboards and names stay and
+ *   only leaving the world is a remove
+ *
+ * Snapshots are written into a per-client buffer that is reused every tick,
+ * so the steady state allocates no buffers. The decoder is
+ * src/network/SnapshotDecoder.ts (keep the two in sync).
+ */
+
+import { GamePhase, TeamId, WeaponType } from './protocol.js';
+
+// Binary message type (voice uses 0x01/0x02)
+export const SNAPSHOT_FRAME_TYPE = 0x10;
+
+export const MAX_SNAPSHOT_ENTITIES = 256;  // Slot index is one byte
+const SLOT_BITS = 8;
+
+// Snapshots kept per client as possible baselines
+const FRAME_RING = 32;
+
+// Quantization
+const POS_SCALE = 64;            // 1/64 unit
+const POS_BITS = 18;             // +-2048 units
+const POS_DELTA_BITS = 8;        // +-2 units per snapshot
+const ANGLE_BITS = 16;
+const TIME_SCALE = 10;           // 0.1s
+const TIME_BITS = 12;
+const MAX_STRING_BYTES = 63;
+const VITAL_BITS = 7;            // Health and armor, 0-127
+const TEAM_BITS = 2;
+const WEAPON_BITS = 3;
+const MONEY_BITS = 16;
+const SCORE_BITS = 16;           // Kills and deaths each
+
+// Entity kinds
+const KIND_BITS = 2;
+export const ENTITY_PLAYER = 0;
+export const ENTITY_BOT = 1;
+export const ENTITY_WEAPON = 2;
+
+// Entity ops
+const OP_BITS = 2;
+const OP_UPDATE = 0;
+const OP_CREATE = 1;
+const OP_REMOVE = 2;
+const OP_DORMANT = 3; // Culled for this client: no position/angles, rest as create or update
+
+// Quantized entity fields (one Int32Array row per slot)
+const F_SERIAL = 0;   // Changes when a slot is reused by another entity
+const F_KIND = 1;
+const F_X = 2;
+const F_Y = 3;
+const F_Z = 4;
+const F_YAW = 5;
+const F_PITCH = 6;
+const F_HEALTH = 7;
+const F_ARMOR = 8;
+const F_ALIVE = 9;
+const F_TEAM = 10;
+const F_WEAPON = 11;
+const F_MONEY = 12;
+const F_KILLS = 13;
+const F_DEATHS = 14;
+const F_NAME = 15;    // Name version (the string is sent when it changes)
+const FIELD_COUNT = 16;
+
+// Change mask groups of an update
+const G_POS = 1 << 0;
+const G_ANGLES = 1 << 1;
+const G_VITALS = 1 << 2;
+const G_TEAM = 1 << 3;
+const G_WEAPON = 1 << 4;
+const G_MONEY = 1 << 5;
+const G_SCORE = 1 << 6;
+const G_NAME = 1 << 7;
+const GROUP_BITS = 8;
+const HIDDEN_GROUPS = G_POS | G_ANGLES;  // Not sent while dormant
+
+export const SNAPSHOT_PHASES: GamePhase[] = ['pre_match', 'warmup', 'freeze', 'live', 'round_end', 'halftime', 'match_end'];
+export const SNAPSHOT_TEAMS: TeamId[] = ['T', 'CT', 'SPECTATOR'];
+export const SNAPSHOT_WEAPONS: WeaponType[] = ['knife', 'pistol', 'rifle', 'shotgun', 'sniper'];
+
+// Worst-case bytes of one entity: more bit, slot and op, then the dormant
+// create bit and kind or an update mask, every group's fields, and two
+// byte-aligned strings (id and name), each with a pad before it
+const MAX_ENTRY_PREFIX_BITS = 1 + SLOT_BITS + OP_BITS + 1 + Math.max(KIND_BITS, GROUP_BITS);
+const MAX_GROUP_BITS =
+  3 * (1 + POS_BITS) +       // G_POS: delta flag and absolute value per axis
+  2 * ANGLE_BITS +           // G_ANGLES
+  2 * VITAL_BITS + 1 +       // G_VITALS (with alive)
+  TEAM_BITS + WEAPON_BITS + MONEY_BITS +
+  2 * SCORE_BITS;            // G_SCORE
+const MAX_ENTITY_BYTES = Math.ceil((MAX_ENTRY_PREFIX_BITS + MAX_GROUP_BITS) / 8) + 2 + 2 * (1 + MAX_STRING_BYTES);
+const MAX_REMOVE_BYTES = Math.ceil((1 + SLOT_BITS + OP_BITS) / 8);  // Slots gone since the baseline
+const HEADER_BYTES = 24;
+
+function quantizeAngle(radians: number): number {
+  return Math.round(radians * (1 << ANGLE_BITS) / (Math.PI * 2)) & ((1 << ANGLE_BITS) - 1);
+}
+
+function quantizePosition(value: number): number {
+  const limit = (1 << (POS_BITS - 1)) - 1;
+  return Math.max(-limit, Math.min(limit, Math.round(value * POS_SCALE)));
+}
+
+/**
+ * LSB-first bit writer over a reusable buffer. Values are at most 24 bits
+ * per call, so the accumulator never reaches the sign bit.
+ */
+class BitWriter {
+  buffer: Buffer = Buffer.alloc(0);
+  private offset = 0;
+  private acc = 0;
+  private accBits = 0;
+
+  reset(buffer: Buffer): void {
+    this.buffer = buffer;
+    this.offset = 0;
+    this.acc = 0;
+    this.accBits = 0;
+  }
+
+  write(value: number, bits: number): void {
+    this.acc |= (value & ((1 << bits) - 1)) << this.accBits;
+    this.accBits += bits;
+    while (this.accBits >= 8) {
+      this.buffer[this.offset++] = this.acc & 0xff;
+      this.acc >>>= 8;
+      this.accBits -= 8;
+    }
+  }
+
+  // Pad to a byte boundary
+  align(): void {
+    if (this.accBits > 0) {
+      this.buffer[this.offset++] = this.acc & 0xff;
+      this.acc = 0;
+      this.accBits = 0;
+    }
+  }
+
+  // Byte-aligned [u8 length][utf8], truncated to MAX_STRING_BYTES
+  writeString(value: string): void {
+    this.align();
+    const length = this.buffer.write(value, this.offset + 1, MAX_STRING_BYTES, 'utf8');
+    this.buffer[this.offset] = length;
+    this.offset += 1 + length;
+  }
+
+  // Bytes written so far (flushes the partial byte)
+  finish(): number {
+    this.align();
+    return this.offset;
+  }
+}
+
+// One snapshot as a client saw it
+interface SnapshotFrame {
+  sequence: number;
+  fields: Int32Array;
+  present: Uint8Array;
+  dormant: Uint8Array;  // Present but culled (position/angles as last sent)
+}
+
+/**
+ * Per-client delta state: snapshots sent (baselines), the newest one the
+ * client acknowledged and the buffer its snapshots are written into.
+ */
+export class SnapshotClient {
+  readonly frames: SnapshotFrame[] = [];
+  private next = 0;
+  ackedSequence = -1;
+  buffer: Buffer = Buffer.alloc(1024);
+
+  // Interest culling: last time each slot was visible to this client (ms)
+  readonly lastVisible = new Float64Array(MAX_SNAPSHOT_ENTITIES);
+
+  constructor() {
+    for (let i = 0; i < FRAME_RING; i++) {
+      this.frames.push({
+        sequence: -1,
+        fields: new Int32Array(MAX_SNAPSHOT_ENTITIES * FIELD_COUNT),
+        present: new Uint8Array(MAX_SNAPSHOT_ENTITIES),
+        dormant: new Uint8Array(MAX_SNAPSHOT_ENTITIES),
+      });
+    }
+  }
+
+  // Record an ack; sequence 0 asks for a full snapshot
+  acknowledge(sequence: number): void {
+    if (sequence <= 0) {
+      this.ackedSequence = -1;
+    } else if (sequence > this.ackedSequence) {
+      this.ackedSequence = sequence;
+    }
+  }
+
+  // The acknowledged snapshot if it is still in the ring
+  baseline(): SnapshotFrame | null {
+    if (this.ackedSequence < 0) return null;
+    for (const frame of this.frames) {
+      if (frame.sequence === this.ackedSequence) return frame;
+    }
+    return null;
+  }
+
+  nextFrame(): SnapshotFrame {
+    const frame = this.frames[this.next];
+    this.next = (this.next + 1) % FRAME_RING;
+    return frame;
+  }
+}
+
+export interface SnapshotGlobals {
+  tick: number;
+  timestamp: number;
+  phase: GamePhase;
+  roundTime: number;
+  freezeTime: number;
+  tScore: number;
+  ctScore: number;
+  roundNumber: number;
+}
+
+export interface SnapshotStats {
+  snapshots: number;      // Binary snapshots encoded
+  fullSnapshots: number;  // Of those, encoded without a baseline
+  bytes: number;
+}
+
+/**
+ * World state of one broadcast, shared by every client's encode.
+ * Call beginWorld(), set every present entity, endWorld(), then
+ * encode() once per client.
+ */
+export class SnapshotEncoder {
+  private fields = new Int32Array(MAX_SNAPSHOT_ENTITIES * FIELD_COUNT);
+  private present = new Uint8Array(MAX_SNAPSHOT_ENTITIES);
+  private ids: string[] = new Array(MAX_SNAPSHOT_ENTITIES).fill('');
+  private names: string[] = new Array(MAX_SNAPSHOT_ENTITIES).fill('');
+  private slots: Map<string, number> = new Map();
+  private freeSlots: number[] = [];
+  private serial = 0;
+  private sequence = 0;  // Numbers broadcasts; what clients acknowledge
+  private globals: SnapshotGlobals | null = null;
+  private writer = new BitWriter();
+  private stats: SnapshotStats = { snapshots: 0, fullSnapshots: 0, bytes: 0 };
+
+  constructor() {
+    for (let slot = MAX_SNAPSHOT_ENTITIES - 1; slot >= 0; slot--) this.freeSlots.push(slot);
+  }
+
+  beginWorld(globals: SnapshotGlobals): void {
+    this.globals = globals;
+    this.sequence++;
+    this.present.fill(0);
+  }
+
+  /**
+   * Add an entity to this broadcast.
+   * @returns its slot, or -1 if every slot is taken
+   */
+  setEntity(
+    kind: number,
+    id: string,
+    name: string,
+    x: number, y: number, z: number,
+    yaw: number, pitch: number,
+    health: number, armor: number, isAlive: boolean,
+    team: TeamId, weapon: WeaponType,
+    money: number, kills: number, deaths: number
+  ): number {
+    let slot = this.slots.get(id);
+    if (slot === undefined) {
+      slot = this.freeSlots.pop();
+      if (slot === undefined) return -1;
+      this.slots.set(id, slot);
+      this.ids[slot] = id;
+      this.names[slot] = name;
+      const row = slot * FIELD_COUNT;
+      this.fields[row + F_SERIAL] = this.serial = (this.serial + 1) & 0xffff;
+      this.fields[row + F_NAME] = 0;
+    }
+
+    const f = this.fields;
+    const row = slot * FIELD_COUNT;
+    if (this.names[slot] !== name) {
+      this.names[slot] = name;
+      f[row + F_NAME]++;
+    }
+    f[row + F_KIND] = kind;
+    f[row + F_X] = quantizePosition(x);
+    f[row + F_Y] = quantizePosition(y);
+    f[row + F_Z] = quantizePosition(z);
+    f[row + F_YAW] = quantizeAngle(yaw);
+    f[row + F_PITCH] = quantizeAngle(pitch);
+    f[row + F_HEALTH] = Math.max(0, Math.min(127, Math.round(health)));
+    f[row + F_ARMOR] = Math.max(0, Math.min(127, Math.round(armor)));
+    f[row + F_ALIVE] = isAlive ? 1 : 0;
+    f[row + F_TEAM] = Math.max(0, SNAPSHOT_TEAMS.indexOf(team));
+    f[row + F_WEAPON] = Math.max(0, SNAPSHOT_WEAPONS.indexOf(weapon));
+    f[row + F_MONEY] = Math.max(0, Math.min(0xffff, Math.round(money)));
+    f[row + F_KILLS] = Math.max(0, Math.min(0xffff, kills));
+    f[row + F_DEATHS] = Math.max(0, Math.min(0xffff, deaths));
+    this.present[slot] = 1;
+    return slot;
+  }
+
+  // Free the slots of entities that were not set this broadcast
+  endWorld(): void {
+    if (this.slots.size === 0) return;
+    for (const [id, slot] of this.slots) {
+      if (this.present[slot]) continue;
+      this.slots.delete(id);
+      this.freeSlots.push(slot);
+    }
+  }
+
+  // Slot of an entity set this broadcast (-1 if absent)
+  slotOf(id: string): number {
+    const slot = this.slots.get(id);
+    return slot !== undefined && this.present[slot] ? slot : -1;
+  }
+
+  get entityCount(): number {
+    return this.slots.size;
+  }
+
+  /**
+   * Encode this broadcast for one client against its acknowledged baseline.
+   * @param visible Per-slot interest mask (null = every entity); masked out
+   *                entities are sent dormant, without a position
+   * @returns View of the client's buffer, valid until its next encode
+   */
+  encode(client: SnapshotClient, visible: Uint8Array | null): Buffer {
+    const globals = this.globals!;
+    const frame = client.nextFrame();
+    // The ring slot about to be overwritten can't also be the baseline
+    const acked = client.baseline();
+    const base = acked === frame ? null : acked;
+
+    const capacity = HEADER_BYTES + this.slots.size * MAX_ENTITY_BYTES + MAX_SNAPSHOT_ENTITIES * MAX_REMOVE_BYTES;
+    if (client.buffer.length < capacity) {
+      client.buffer = Buffer.alloc(Math.max(capacity, client.buffer.length * 2));
+    }
+    const w = this.writer;
+    w.reset(client.buffer);
+
+    // Header
+    w.write(SNAPSHOT_FRAME_TYPE, 8);
+    w.write(this.sequence & 0xffffff, 24);
+    w.write(this.sequence >>> 24, 8);
+    // Baseline as an offset back from this sequence (0 = none)
+    const baseOffset = base ? this.sequence - base.sequence : 0;
+    w.write(baseOffset, 16);
+    w.write(globals.tick & 0xffffff, 24);
+    w.write(globals.tick >>> 24, 8);
+    w.write(globals.timestamp % 0x1000000, 24);
+    w.write(Math.floor(globals.timestamp / 0x1000000) & 0xffffff, 24);
+    w.write(Math.max(0, SNAPSHOT_PHASES.indexOf(globals.phase)), 3);
+    w.write(Math.min((1 << TIME_BITS) - 1, Math.round(globals.roundTime * TIME_SCALE)), TIME_BITS);
+    w.write(Math.min((1 << TIME_BITS) - 1, Math.round(globals.freezeTime * TIME_SCALE)), TIME_BITS);
+    w.write(Math.min(255, globals.tScore), 8);
+    w.write(Math.min(255, globals.ctScore), 8);
+    w.write(Math.min(255, globals.roundNumber), 8);
+
+    const cur = this.fields;
+    frame.sequence = this.sequence;
+    frame.present.fill(0);
+    frame.dormant.fill(0);
+
+    for (let slot = 0; slot < MAX_SNAPSHOT_ENTITIES; slot++) {
+      const inNow = this.present[slot] === 1;
+      const inBase = base !== null && base.present[slot] === 1;
+      if (!inNow && !inBase) continue;
+
+      const row = slot * FIELD_COUNT;
+      if (!inNow) {
+        this.writeSlot(slot, OP_REMOVE);
+        continue;
+      }
+
+      // Remember what this client was sent
+      const fresh = !inBase || base!.fields[row + F_SERIAL] !== cur[row + F_SERIAL];
+      const hidden = visible !== null && visible[slot] === 0;
+      frame.present[slot] = 1;
+      frame.fields.set(cur.subarray(row, row + FIELD_COUNT), row);
+
+      if (hidden) {
+        // The client keeps the position it last saw (none for a new entity)
+        frame.dormant[slot] = 1;
+        for (let i = F_X; i <= F_PITCH; i++) frame.fields[row + i] = fresh ? 0 : base!.fields[row + i];
+
+        if (fresh) {
+          this.writeSlot(slot, OP_DORMANT);
+          w.write(1, 1);
+          this.writeCreate(slot, row, HIDDEN_GROUPS);
+        } else {
+          const mask = this.changeMask(base!.fields, row) & ~HIDDEN_GROUPS;
+          if (mask === 0 && base!.dormant[slot]) continue;
+          this.writeSlot(slot, OP_DORMANT);
+          w.write(0, 1);
+          w.write(mask, GROUP_BITS);
+          this.writeGroups(slot, row, mask, base!.fields);
+        }
+      } else if (fresh) {
+        this.writeSlot(slot, OP_CREATE);
+        this.writeCreate(slot, row, 0);
+      } else {
+        // Leaving dormancy is always sent, even with nothing else changed
+        const mask = this.changeMask(base!.fields, row);
+        if (mask === 0 && !base!.dormant[slot]) continue;
+        this.writeSlot(slot, OP_UPDATE);
+        w.write(mask, GROUP_BITS);
+        this.writeGroups(slot, row, mask, base!.fields);
+      }
+    }
+    w.write(0, 1);  // No more entities
+
+    const length = w.finish();
+    this.stats.snapshots++;
+    if (!base) this.stats.fullSnapshots++;
+    this.stats.bytes += length;
+    return client.buffer.subarray(0, length);
+  }
+
+  getStats(): SnapshotStats {
+    return { ...this.stats };
+  }
+
+  resetStats(): void {
+    this.stats = { snapshots: 0, fullSnapshots: 0, bytes: 0 };
+  }
+
+  private writeSlot(slot: number, op: number): void {
+    const w = this.writer;
+    w.write(1, 1);  // Another entity follows
+    w.write(slot, SLOT_BITS);
+    w.write(op, OP_BITS);
+  }
+
+  // Kind, id and every group of the kind except those in omit
+  private writeCreate(slot: number, row: number, omit: number): void {
+    const kind = this.fields[row + F_KIND];
+    this.writer.write(kind, KIND_BITS);
+    this.writer.writeString(this.ids[slot]);
+    let mask = G_POS | G_WEAPON;
+    if (kind !== ENTITY_WEAPON) mask |= G_ANGLES | G_VITALS | G_TEAM | G_SCORE | G_NAME;
+    if (kind === ENTITY_PLAYER) mask |= G_MONEY;
+    this.writeGroups(slot, row, mask & ~omit, null);
+  }
+
+  private changeMask(base: Int32Array, row: number): number {
+    const cur = this.fields;
+    let mask = 0;
+    if (cur[row + F_X] !== base[row + F_X] || cur[row + F_Y] !== base[row + F_Y] || cur[row + F_Z] !== base[row + F_Z]) mask |= G_POS;
+    if (cur[row + F_YAW] !== base[row + F_YAW] || cur[row + F_PITCH] !== base[row + F_PITCH]) mask |= G_ANGLES;
+    if (cur[row + F_HEALTH] !== base[row + F_HEALTH] || cur[row + F_ARMOR] !== base[row + F_ARMOR] ||
+        cur[row + F_ALIVE] !== base[row + F_ALIVE]) mask |= G_VITALS;
+    if (cur[row + F_TEAM] !== base[row + F_TEAM]) mask |= G_TEAM;
+    if (cur[row + F_WEAPON] !== base[row + F_WEAPON]) mask |= G_WEAPON;
+    if (cur[row + F_MONEY] !== base[row + F_MONEY]) mask |= G_MONEY;
+    if (cur[row + F_KILLS] !== base[row + F_KILLS] || cur[row + F_DEATHS] !== base[row + F_DEATHS]) mask |= G_SCORE;
+    if (cur[row + F_NAME] !== base[row + F_NAME]) mask |= G_NAME;
+    return mask;
+  }
+
+  // Write the fields of every group in mask (positions as deltas when there is a baseline)
+  private writeGroups(slot: number, row: number, mask: number, base: Int32Array | null): void {
+    const w = this.writer;
+    const f = this.fields;
+    if (mask & G_POS) {
+      for (let axis = F_X; axis <= F_Z; axis++) {
+        const delta = base ? f[row + axis] - base[row + axis] : 0;
+        if (base && delta >= -(1 << (POS_DELTA_BITS - 1)) && delta < (1 << (POS_DELTA_BITS - 1))) {
+          w.write(1, 1);
+          w.write(delta, POS_DELTA_BITS);
+        } else {
+          w.write(0, 1);
+          w.write(f[row + axis], POS_BITS);
+        }
+      }
+    }
+    if (mask & G_ANGLES) {
+      w.write(f[row + F_YAW], ANGLE_BITS);
+      w.write(f[row + F_PITCH], ANGLE_BITS);
+    }
+    if (mask & G_VITALS) {
+      w.write(f[row + F_HEALTH], VITAL_BITS);
+      w.write(f[row + F_ARMOR], VITAL_BITS);
+      w.write(f[row + F_ALIVE], 1);
+    }
+    if (mask & G_TEAM) w.write(f[row + F_TEAM], TEAM_BITS);
+    if (mask & G_WEAPON) w.write(f[row + F_WEAPON], WEAPON_BITS);
+    if (mask & G_MONEY) w.write(f[row + F_MONEY], MONEY_BITS);
+    if (mask & G_SCORE) {
+      w.write(f[row + F_KILLS], SCORE_BITS);
+      w.write(f[row + F_DEATHS], SCORE_BITS);
+    }
+    if (mask & G_NAME) w.writeString(this.names[slot]);
+  }
+}
@@ -0,0 +1,261 @@
+/**
+ * TickScheduler - Deadline-driven tick loops for every room on a thread
+ *
+ * GameRunners schedule their game and broadcast loops here instead of on
+ * their own setIntervals, one scheduler per thread (main or room worker):
+ *
+ * - One timer, armed for the earliest deadline; due loops run earliest
+ *   deadline first, so a slow room delays the others by one tick at most
+ *   instead of piling timers up behind it
+ * - Fixed-step against the deadline (no drift); a loop more than
+ *   MAX_CATCH_UP steps behind skips ahead instead of running a burst
+ * - Per room: tick cost, lateness, overruns (a tick that started more than
+ *   half a step late or took longer than a step) and the room's cost as a
+ *   fraction of one core, which the pool reports as capacity
+ */
+
+import { performance } from 'perf_hooks';
+
+const MAX_CATCH_UP = 3;         // Steps a loop may fall behind before skipping
+const LOAD_WINDOW_MS = 1000;    // Cost/lateness window
+const LOAD_SMOOTHING = 0.5;     // EWMA weight of the newest window
+
+export interface RoomTickStats {
+  roomId: string;
+  load: number;        // Share of one core (smoothed)
+  ticks: number;       // Loop runs since the room was added
+  overruns: number;
+  skipped: number;     // Steps dropped after falling behind
+  avgCostMs: number;   // Last window
+  maxCostMs: number;   // Last window
+  maxLateMs: number;   // Last window
+}
+
+export interface TickSchedulerStats {
+  load: number;        // Sum of the rooms' loads
+  overruns: number;
+  rooms: RoomTickStats[];
+}
+
+export interface TickTask {
+  cancel(): void;
+}
+
+interface ScheduledTask {
+  owner: OwnerStats;
+  intervalMs: number;
+  fn: () => void;
+  deadline: number;
+  cancelled: boolean;
+  pass: number;        // Last run() pass that ran it
+}
+
+// Per room accounting
+class OwnerStats {
+  readonly roomId: string;
+  tasks = 0;
+  ticks = 0;
+  overruns = 0;
+  skipped = 0;
+  load = 0;
+  avgCostMs = 0;
+  maxCostMs = 0;
+  maxLateMs = 0;
+
+  // Current window
+  private windowStart = performance.now();
+  private windowCost = 0;
+  private windowTicks = 0;
+  private windowMaxCost = 0;
+  private windowMaxLate = 0;
+  private measured = false;
+
+  constructor(roomId: string) {
+    this.roomId = roomId;
+  }
+
+  record(costMs: number, lateMs: number, isTick: boolean): void {
+    this.windowCost += costMs;
+    if (!isTick) return;
+    this.ticks++;
+    this.windowTicks++;
+    if (costMs > this.windowMaxCost) this.windowMaxCost = costMs;
+    if (lateMs > this.windowMaxLate) this.windowMaxLate = lateMs;
+  }
+
+  // Close the window once it is long enough
+  roll(now: number): void {
+    const elapsed = now - this.windowStart;
+    if (elapsed < LOAD_WINDOW_MS) return;
+    const load = this.windowCost / elapsed;
+    this.load = this.measured ? this.load + (load - this.load) * LOAD_SMOOTHING : load;
+    this.measured = true;
+    this.avgCostMs = this.windowTicks > 0 ? this.windowCost / this.windowTicks : 0;
+    this.maxCostMs = this.windowMaxCost;
+    this.maxLateMs = this.windowMaxLate;
+    this.windowStart = now;
+    this.windowCost = 0;
+    this.windowTicks = 0;
+    this.windowMaxCost = 0;
+    this.windowMaxLate = 0;
+  }
+
+  toStats(): RoomTickStats {
+    return {
+      roomId: this.roomId,
+      load: this.load,
+      ticks: this.ticks,
+      overruns: this.overruns,
+      skipped: this.skipped,
+      avgCostMs: this.avgCostMs,
+      maxCostMs: this.maxCostMs,
+      maxLateMs: this.maxLateMs,
+    };
+  }
+}
+
+export class TickScheduler {
+  private tasks: ScheduledTask[] = [];
+  private owners: Map<string, OwnerStats> = new Map();
+  private timer: ReturnType<typeof setTimeout> | null = null;
+  private timerDeadline = Infinity;
+  private running = false;
+  private pass = 0;
+
+  /**
+   * Run fn every intervalMs on behalf of a room (first run one step from now)
+   */
+  add(roomId: string, intervalMs: number, fn: () => void): TickTask {
+    const owner = this.getOwner(roomId);
+    owner.tasks++;
+    const task: ScheduledTask = {
+      owner,
+      intervalMs,
+      fn,
+      deadline: performance.now() + intervalMs,
+      cancelled: false,
+      pass: 0,
+    };
+    this.tasks.push(task);
+    this.arm();
+    return {
+      cancel: () => this.cancel(task),
+    };
+  }
+
+  /**
+   * Run work for a room now and charge its cost to the room (e.g. input
+   * handling), so the room's load covers more than its loops
+   */
+  charge<T>(roomId: string, fn: () => T): T {
+    const owner = this.owners.get(roomId);
+    if (!owner) return fn();
+    const start = performance.now();
+    try {
+      return fn();
+    } finally {
+      owner.record(performance.now() - start, 0, false);
+    }
+  }
+
+  getStats(): TickSchedulerStats {
+    const now = performance.now();
+    const rooms: RoomTickStats[] = [];
+    let load = 0;
+    let overruns = 0;
+    for (const owner of this.owners.values()) {
+      owner.roll(now);
+      rooms.push(owner.toStats());
+      load += owner.load;
+      overruns += owner.overruns;
+    }
+    return { load, overruns, rooms };
+  }
+
+  private getOwner(roomId: string): OwnerStats {
+    let owner = this.owners.get(roomId);
+    if (!owner) {
+      owner = new OwnerStats(roomId);
+      this.owners.set(roomId, owner);
+    }
+    return owner;
+  }
+
+  private cancel(task: ScheduledTask): void {
+    if (task.cancelled) return;
+    task.cancelled = true;
+    const index = this.tasks.indexOf(task);
+    if (index >= 0) this.tasks.splice(index, 1);
+    // A room's stats go with its last loop
+    if (--task.owner.tasks === 0) this.owners.delete(task.owner.roomId);
+    if (this.tasks.length === 0 && this.timer) {
+      clearTimeout(this.timer);
+      this.timer = null;
+      this.timerDeadline = Infinity;
+    }
+  }
+
+  // Arm the timer for the earliest deadline (unless it already is)
+  private arm(): void {
+    if (this.running) return;
+    let earliest = Infinity;
+    for (const task of this.tasks) {
+      if (task.deadline < earliest) earliest = task.deadline;
+    }
+    if (earliest === Infinity || (this.timer && earliest >= this.timerDeadline)) return;
+    if (this.timer) clearTimeout(this.timer);
+    this.timerDeadline = earliest;
+    this.timer = setTimeout(() => this.run(), Math.max(0, earliest - performance.now()));
+  }
+
+  // Run every due loop once, earliest deadline first. Loops still behind
+  // run again on the next pass, after pending I/O.
+  private run(): void {
+    this.timer = null;
+    this.timerDeadline = Infinity;
+    this.running = true;
+    const pass = ++this.pass;
+
+    for (;;) {
+      const now = performance.now();
+      let next: ScheduledTask | null = null;
+      for (const task of this.tasks) {
+        if (task.pass !== pass && task.deadline <= now && (!next || task.deadline < next.deadline)) next = task;
+      }
+      if (!next) break;
+      next.pass = pass;
+
+      const late = now - next.deadline;
+      try {
+        next.fn();
+      } catch (error) {
+        console.error(`[TickScheduler] Room ${next.owner.roomId} tick failed:`, error);
+      }
+      const end = performance.now();
+      const cost = end - now;
+
+      const owner = next.owner;
+      owner.record(cost, late, true);
+      if (late > next.intervalMs / 2 || cost > next.intervalMs) owner.overruns++;
+      owner.roll(end);
+
+      next.deadline += next.intervalMs;
+      if (end - next.deadline > next.intervalMs * MAX_CATCH_UP) {
+        const behind = Math.floor((end - next.deadline) / next.intervalMs);
+        owner.skipped += behind;
+        next.deadline += behind * next.intervalMs;
+      }
+    }
+
+    this.running = false;
+    this.arm();
+  }
+}
+
+// The calling thread's scheduler (module state is per worker thread)
+let threadScheduler: TickScheduler | null = null;
+
+export function getTickScheduler(): TickScheduler {
+  if (!threadScheduler) threadScheduler = new TickScheduler();
+  return threadScheduler;
+}
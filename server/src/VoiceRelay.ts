@@ -2,16 +2,33 @@
  * VoiceRelay - Server-side voice frame relay
  *
  * Relays binary voice frames between clients in a room.
- * Handles team filtering and position tracking for spatial audio.
+ * Handles team filtering and proximity culling for spatial audio.
+ *
+ * Frames are not forwarded as they arrive. They are queued and flushed once
+ * per voice tick: each listener gets every frame it should hear in a single
+ * batch message, so N talkers cost one send per listener per tick instead of
+ * one per talker. A uniform grid over listener positions limits proximity
+ * voice to listeners within range.
  */
 
 import { WebSocket } from 'ws';
-import { TeamId } from './protocol.js';
+import { TeamId, Vec3 } from './protocol.js';
 import { ConnectedClient } from './types.js';
 
 // Voice protocol constants (matching client)
 const VOICE_FRAME_TYPE = 0x01;
+const VOICE_BATCH_FRAME_TYPE = 0x02;  // [type][count] then count x ([u16 length][frame])
 const VOICE_FLAG_TEAM_ONLY = 0x02;
+const VOICE_MAX_DISTANCE = 200;       // Largest client voice max distance setting
+
+// Relay tuning
+const VOICE_RELAY_TICK_MS = 20;       // One codec frame
+const VOICE_RELAY_IDLE_TICKS = 50;    // Stop the flush timer after 1s without voice
+const VOICE_RELAY_RANGE = VOICE_MAX_DISTANCE + 16;  // Proximity range: any client setting + margin
+const MAX_BATCH_BYTES = 1200;         // Keep batches well under a typical MTU
+const MAX_BATCH_FRAMES = 255;         // Count is one byte
+const BATCH_HEADER_SIZE = 2;
+const BATCH_ENTRY_HEADER_SIZE = 2;
 
 /**
  * Extract sender ID from voice frame (bytes 2-5)
@@ -51,6 +68,75 @@ interface VoicePosition {
   lastUpdate: number;
 }
 
+/**
+ * Lookup for live player positions (null = not in the world, hears everyone)
+ */
+export type VoicePositionSource = (clientId: string) => Vec3 | null;
+
+/**
+ * Frame waiting for the next flush
+ */
+interface PendingFrame {
+  senderClientId: string;
+  data: Uint8Array;
+}
+
+/**
+ * Relay counters (cumulative)
+ */
+export interface VoiceRelayStats {
+  framesIn: number;      // Frames received from talkers
+  framesOut: number;     // Frame deliveries (one per frame per listener)
+  messagesOut: number;   // socket.send calls
+  bytesOut: number;
+  flushes: number;
+}
+
+/**
+ * Uniform grid over listener positions (x/z plane)
+ * Cell size equals the relay range, so a query only visits the 3x3 cells
+ * around the talker.
+ */
+class VoiceGrid {
+  private cells: Map<number, string[]> = new Map();
+  private used: string[][] = [];
+
+  private static key(cx: number, cz: number): number {
+    return ((cx & 0xffff) << 16) | (cz & 0xffff);
+  }
+
+  clear(): void {
+    for (const cell of this.used) cell.length = 0;
+    this.used.length = 0;
+  }
+
+  insert(clientId: string, x: number, z: number): void {
+    const key = VoiceGrid.key(Math.floor(x / VOICE_RELAY_RANGE), Math.floor(z / VOICE_RELAY_RANGE));
+    let cell = this.cells.get(key);
+    if (!cell) {
+      cell = [];
+      this.cells.set(key, cell);
+    }
+    if (cell.length === 0) this.used.push(cell);
+    cell.push(clientId);
+  }
+
+  /**
+   * Visit every client in the cells around (x, z)
+   */
+  forEachNear(x: number, z: number, visit: (clientId: string) => void): void {
+    const cx = Math.floor(x / VOICE_RELAY_RANGE);
+    const cz = Math.floor(z / VOICE_RELAY_RANGE);
+    for (let dx = -1; dx <= 1; dx++) {
+      for (let dz = -1; dz <= 1; dz++) {
+        const cell = this.cells.get(VoiceGrid.key(cx + dx, cz + dz));
+        if (!cell) continue;
+        for (const clientId of cell) visit(clientId);
+      }
+    }
+  }
+}
+
 /**
  * Voice relay state for a room
  */
@@ -59,6 +145,29 @@ export class VoiceRelay {
   private senderIdToPlayerId: Map<number, string> = new Map();
   private playerIdToSenderId: Map<string, number> = new Map();
 
+  // Batching state
+  private pending: PendingFrame[] = [];
+  private outgoing: Map<string, Uint8Array[]> = new Map();  // Listener -> frames this tick
+  private clients: Map<string, ConnectedClient> | null = null;
+  private teamAssignments: Map<string, TeamId> | null = null;
+  private flushInterval: ReturnType<typeof setInterval> | null = null;
+  private idleTicks = 0;
+  private autoFlush: boolean;
+
+  // Interest management
+  private positionSource: VoicePositionSource | null = null;
+  private grid: VoiceGrid = new VoiceGrid();
+  private unpositioned: Set<string> = new Set();
+
+  private stats: VoiceRelayStats = { framesIn: 0, framesOut: 0, messagesOut: 0, bytesOut: 0, flushes: 0 };
+
+  /**
+   * @param autoFlush Flush on a timer (false = caller calls flush(), e.g. benchmarks)
+   */
+  constructor(autoFlush: boolean = true) {
+    this.autoFlush = autoFlush;
+  }
+
   /**
    * Register a player's sender ID
    */
@@ -77,16 +186,30 @@ export class VoiceRelay {
     }
     this.playerIdToSenderId.delete(playerId);
     this.positions.delete(playerId);
+    this.outgoing.delete(playerId);
   }
 
   /**
    * Update a player's position (for spatial audio)
+   * Overwritten on each flush when a position source is set.
    */
   updatePosition(playerId: string, x: number, y: number, z: number): void {
-    this.positions.set(playerId, {
-      x, y, z,
-      lastUpdate: Date.now(),
-    });
+    const pos = this.positions.get(playerId);
+    if (pos) {
+      pos.x = x;
+      pos.y = y;
+      pos.z = z;
+      pos.lastUpdate = Date.now();
+    } else {
+      this.positions.set(playerId, { x, y, z, lastUpdate: Date.now() });
+    }
+  }
+
+  /**
+   * Set the live position lookup (usually the room's game state)
+   */
+  setPositionSource(source: VoicePositionSource | null): void {
+    this.positionSource = source;
   }
 
   /**
@@ -96,13 +219,10 @@ export class VoiceRelay {
     return this.senderIdToPlayerId.get(senderId);
   }
 
-  // Debug counter
-  private debugRelayCount = 0;
-
   /**
-   * Relay a voice frame to room members
+   * Queue a voice frame for relay on the next flush
    *
-   * @param data Binary voice frame
+   * @param data Binary voice frame (kept until the flush; must not be reused)
    * @param senderClientId Client ID of sender
    * @param clients Map of all clients in room
    * @param teamAssignments Map of client ID to team
@@ -113,43 +233,197 @@ export class VoiceRelay {
     clients: Map<string, ConnectedClient>,
     teamAssignments: Map<string, TeamId>
   ): void {
-    const flags = getFrameFlags(data);
-    const teamOnly = (flags & VOICE_FLAG_TEAM_ONLY) !== 0;
-    const senderTeam = teamAssignments.get(senderClientId);
-    const senderId = getSenderIdFromFrame(data);
+    this.clients = clients;
+    this.teamAssignments = teamAssignments;
+    this.pending.push({ senderClientId, data });
+    this.stats.framesIn++;
 
-    this.debugRelayCount++;
-    if (this.debugRelayCount % 50 === 1) {
-      console.log(`[VoiceRelay] Relaying frame #${this.debugRelayCount} from ${senderClientId.slice(0, 8)} (sender ${senderId.toString(16)}), ${clients.size} clients in room`);
+    if (this.autoFlush && !this.flushInterval) {
+      this.idleTicks = 0;
+      this.flushInterval = setInterval(() => this.flush(), VOICE_RELAY_TICK_MS);
     }
+  }
 
-    let relayedTo = 0;
+  /**
+   * Refresh positions and rebuild the listener grid
+   */
+  private rebuildInterest(clients: Map<string, ConnectedClient>): void {
+    const now = Date.now();
+    this.grid.clear();
+    this.unpositioned.clear();
 
-    // Relay to all other clients (optionally filtered by team)
-    for (const [clientId, client] of clients) {
-      // Don't send back to sender
-      if (clientId === senderClientId) continue;
+    for (const clientId of clients.keys()) {
+      // The position source is authoritative: dead or absent players hear everyone
+      if (this.positionSource) {
+        const live = this.positionSource(clientId);
+        if (live) {
+          this.updatePosition(clientId, live.x, live.y, live.z);
+        } else {
+          this.positions.delete(clientId);
+        }
+      }
 
-      // Check team filter
-      if (teamOnly && senderTeam) {
-        const clientTeam = teamAssignments.get(clientId);
-        if (clientTeam !== senderTeam) continue;
+      const pos = this.positions.get(clientId);
+      if (pos && now - pos.lastUpdate < 10000) {
+        this.grid.insert(clientId, pos.x, pos.z);
+      } else {
+        this.unpositioned.add(clientId);
       }
+    }
+  }
 
-      // Send binary frame
-      if (client.socket.readyState === WebSocket.OPEN) {
-        try {
-          client.socket.send(data);
-          relayedTo++;
-        } catch {
-          // Ignore send errors
+  /**
+   * Add a frame to a listener's outgoing batch
+   */
+  private enqueueFor(clientId: string, data: Uint8Array): void {
+    let frames = this.outgoing.get(clientId);
+    if (!frames) {
+      frames = [];
+      this.outgoing.set(clientId, frames);
+    }
+    frames.push(data);
+  }
+
+  /**
+   * Route one frame to every listener that should hear it
+   */
+  private routeFrame(frame: PendingFrame, clients: Map<string, ConnectedClient>, teams: Map<string, TeamId>): void {
+    const { senderClientId, data } = frame;
+    const teamOnly = (getFrameFlags(data) & VOICE_FLAG_TEAM_ONLY) !== 0;
+    const senderTeam = teams.get(senderClientId);
+
+    // Team radio ignores distance
+    if (teamOnly && senderTeam) {
+      for (const clientId of clients.keys()) {
+        if (clientId !== senderClientId && teams.get(clientId) === senderTeam) {
+          this.enqueueFor(clientId, data);
         }
       }
+      return;
     }
 
-    if (this.debugRelayCount % 50 === 1) {
-      console.log(`[VoiceRelay] Relayed to ${relayedTo} clients`);
+    // Sender not in the world (lobby, dead): everyone hears them
+    const senderPos = this.positions.get(senderClientId);
+    if (!senderPos || this.unpositioned.has(senderClientId)) {
+      for (const clientId of clients.keys()) {
+        if (clientId !== senderClientId) this.enqueueFor(clientId, data);
+      }
+      return;
+    }
+
+    // Proximity voice: nearby listeners plus everyone without a position
+    const rangeSq = VOICE_RELAY_RANGE * VOICE_RELAY_RANGE;
+    this.grid.forEachNear(senderPos.x, senderPos.z, (clientId) => {
+      if (clientId === senderClientId) return;
+      const pos = this.positions.get(clientId)!;
+      const dx = pos.x - senderPos.x;
+      const dy = pos.y - senderPos.y;
+      const dz = pos.z - senderPos.z;
+      if (dx * dx + dy * dy + dz * dz <= rangeSq) this.enqueueFor(clientId, data);
+    });
+    for (const clientId of this.unpositioned) {
+      if (clientId !== senderClientId) this.enqueueFor(clientId, data);
+    }
+  }
+
+  /**
+   * Send one message to a client, counting it
+   */
+  private sendTo(client: ConnectedClient, data: Uint8Array, frameCount: number): void {
+    if (client.socket.readyState !== WebSocket.OPEN) return;
+    try {
+      client.socket.send(data);
+      this.stats.messagesOut++;
+      this.stats.framesOut += frameCount;
+      this.stats.bytesOut += data.length;
+    } catch {
+      // Ignore send errors
+    }
+  }
+
+  /**
+   * Send a listener's frames as batch messages (a lone frame goes as-is)
+   */
+  private sendBatches(client: ConnectedClient, frames: Uint8Array[]): void {
+    if (frames.length === 1) {
+      this.sendTo(client, frames[0], 1);
+      return;
     }
+
+    let start = 0;
+    while (start < frames.length) {
+      // Take as many frames as fit in one batch
+      let size = BATCH_HEADER_SIZE;
+      let end = start;
+      while (
+        end < frames.length &&
+        end - start < MAX_BATCH_FRAMES &&
+        (end === start || size + BATCH_ENTRY_HEADER_SIZE + frames[end].length <= MAX_BATCH_BYTES)
+      ) {
+        size += BATCH_ENTRY_HEADER_SIZE + frames[end].length;
+        end++;
+      }
+
+      if (end - start === 1) {
+        this.sendTo(client, frames[start], 1);
+      } else {
+        // ws may hold the buffer until the socket drains, so it is not reused
+        const batch = Buffer.allocUnsafe(size);
+        batch[0] = VOICE_BATCH_FRAME_TYPE;
+        batch[1] = end - start;
+        let offset = BATCH_HEADER_SIZE;
+        for (let i = start; i < end; i++) {
+          batch.writeUInt16LE(frames[i].length, offset);
+          batch.set(frames[i], offset + BATCH_ENTRY_HEADER_SIZE);
+          offset += BATCH_ENTRY_HEADER_SIZE + frames[i].length;
+        }
+        this.sendTo(client, batch, end - start);
+      }
+      start = end;
+    }
+  }
+
+  /**
+   * Relay every queued frame, one batch per listener
+   */
+  flush(): void {
+    if (this.pending.length === 0 || !this.clients || !this.teamAssignments) {
+      if (++this.idleTicks > VOICE_RELAY_IDLE_TICKS) this.stopFlushing();
+      return;
+    }
+    this.idleTicks = 0;
+    this.stats.flushes++;
+
+    const clients = this.clients;
+    this.rebuildInterest(clients);
+    for (const frame of this.pending) {
+      this.routeFrame(frame, clients, this.teamAssignments);
+    }
+    this.pending.length = 0;
+
+    for (const [clientId, frames] of this.outgoing) {
+      if (frames.length === 0) continue;
+      const client = clients.get(clientId);
+      if (client) this.sendBatches(client, frames);
+      frames.length = 0;
+    }
+  }
+
+  /**
+   * Stop the flush timer (restarts on the next frame)
+   */
+  private stopFlushing(): void {
+    if (this.flushInterval) {
+      clearInterval(this.flushInterval);
+      this.flushInterval = null;
+    }
+  }
+
+  /**
+   * Get relay counters
+   */
+  getStats(): VoiceRelayStats {
+    return { ...this.stats };
   }
 
   /**
@@ -168,6 +442,9 @@ export class VoiceRelay {
    * Clear all state
    */
   clear(): void {
+    this.stopFlushing();
+    this.pending.length = 0;
+    this.outgoing.clear();
     this.positions.clear();
     this.senderIdToPlayerId.clear();
     this.playerIdToSenderId.clear();
@@ -133,7 +133,8 @@ export class HubServer {
             connection.poolId,
             msg.rooms,
             msg.playerCount,
-            msg.load
+            msg.load,
+            msg.capacity
           );
         }
         break;
@@ -260,7 +261,7 @@ export class HubServer {
     if (preferredPool) {
       pool = this.poolRegistry.getPool(preferredPool);
       // Check if pool has capacity
-      if (pool && pool.info.currentRooms >= pool.info.maxRooms) {
+      if (pool && !this.poolRegistry.hasCapacity(pool)) {
         pool = undefined;
       }
     }
@@ -2,6 +2,7 @@
 import { WebSocket } from 'ws';
 import {
   PoolServerInfo,
+  PoolCapacity,
   RoomInfo,
   AggregatedRoomInfo,
   serializeHubToPoolMessage,
@@ -78,7 +79,8 @@ export class PoolRegistry {
     poolId: string,
     rooms: RoomInfo[],
     playerCount: number,
-    load: number
+    load: number,
+    capacity?: PoolCapacity
   ): void {
     const pool = this.pools.get(poolId);
     if (pool) {
@@ -86,6 +88,7 @@ export class PoolRegistry {
       pool.info.currentRooms = rooms.length;
       pool.info.playerCount = playerCount;
       pool.info.load = load;
+      pool.info.capacity = capacity;
       pool.info.lastHeartbeat = Date.now();
       pool.isAlive = true;
     }
@@ -101,6 +104,8 @@ export class PoolRegistry {
         pool.info.rooms[existingIndex] = room;
       } else {
         pool.info.rooms.push(room);
+        // Until the next heartbeat measures it
+        if (pool.info.capacity) pool.info.capacity.freeRooms = Math.max(0, pool.info.capacity.freeRooms - 1);
       }
       pool.info.currentRooms = pool.info.rooms.length;
     }
@@ -152,6 +157,13 @@ export class PoolRegistry {
     }));
   }
 
+  // Whether a pool can take another room: under its room limit and, if it
+  // reports measured capacity, with room for one more game of measured cost
+  hasCapacity(pool: RegisteredPool): boolean {
+    if (pool.info.currentRooms >= pool.info.maxRooms) return false;
+    return !pool.info.capacity || pool.info.capacity.freeRooms > 0;
+  }
+
   // Get pool with lowest load for room creation
   getLeastLoadedPool(): RegisteredPool | undefined {
     let leastLoaded: RegisteredPool | undefined;
@@ -159,7 +171,7 @@ export class PoolRegistry {
 
     for (const pool of this.pools.values()) {
       // Check if pool has capacity
-      if (pool.info.currentRooms < pool.info.maxRooms && pool.info.load < lowestLoad) {
+      if (this.hasCapacity(pool) && pool.info.load < lowestLoad) {
         lowestLoad = pool.info.load;
         leastLoaded = pool;
       }
@@ -16,6 +16,7 @@ function parseArgs(): {
   port: number;
   hubPort: number;
   maxRooms: number;
+  roomWorkers: number;
 } {
   const args = process.argv.slice(2);
   const parsed: ReturnType<typeof parseArgs> = {
@@ -24,6 +25,7 @@ function parseArgs(): {
     port: parseInt(process.env.PORT || '8080', 10),
     hubPort: parseInt(process.env.HUB_PORT || '8081', 10),
     maxRooms: parseInt(process.env.MAX_ROOMS || '100', 10),
+    roomWorkers: parseInt(process.env.ROOM_WORKERS || String(DEFAULT_SERVER_CONFIG.roomWorkers), 10),
   };
 
   for (const arg of args) {
@@ -41,6 +43,8 @@ function parseArgs(): {
       parsed.hubPort = parseInt(arg.substring(11), 10);
     } else if (arg.startsWith('--max-rooms=')) {
       parsed.maxRooms = parseInt(arg.substring(12), 10);
+    } else if (arg.startsWith('--room-workers=')) {
+      parsed.roomWorkers = parseInt(arg.substring(15), 10);
     }
   }
 
@@ -86,6 +90,7 @@ switch (config.mode) {
       ...DEFAULT_SERVER_CONFIG,
       port: config.port,
       maxRooms: config.maxRooms,
+      roomWorkers: config.roomWorkers,
       serverName: config.serverName,
       publicEndpoint: `ws://localhost:${config.port}`,
       hubUrl: `ws://localhost:${config.hubPort}`,
@@ -132,6 +137,7 @@ switch (config.mode) {
       ...DEFAULT_SERVER_CONFIG,
       port: config.port,
       maxRooms: config.maxRooms,
+      roomWorkers: config.roomWorkers,
       serverName: config.serverName,
       publicEndpoint: `ws://localhost:${config.port}`,
       hubUrl: config.hubUrl,
@@ -3,7 +3,7 @@ import { WebSocketServer, WebSocket } from 'ws';
 import { createServer, IncomingMessage, Server as HttpServer } from 'http';
 import { RoomManager } from '../RoomManager.js';
 import { PoolClient } from './PoolClient.js';
-import { parseClientMessage, RoomInfo } from '../protocol.js';
+import { parseClientMessage, RoomInfo, PoolCapacity } from '../protocol.js';
 import { ServerConfig, DEFAULT_SERVER_CONFIG } from '../types.js';
 
 export interface GameServerConfig extends ServerConfig {
@@ -64,7 +64,12 @@ export class GameServer {
     setInterval(() => {
       const stats = this.roomManager.getStats();
       if (stats.clients > 0 || stats.rooms > 0) {
-        console.log(`[GameServer] Stats: ${stats.clients} clients, ${stats.rooms} rooms`);
+        const report = this.roomManager.getLoadReport();
+        console.log(
+          `[GameServer] Stats: ${stats.clients} clients, ${stats.rooms} rooms, ` +
+          `${report.runningRooms} games on ${report.threads} thread(s), load ${report.load.toFixed(2)} cores, ` +
+          `${report.overruns} tick overruns`
+        );
       }
     }, 60000);
   }
@@ -169,17 +174,30 @@ export class GameServer {
     this.poolClient.setStateCallbacks(
       () => this.roomManager.listRooms(),
       () => this.roomManager.getStats().clients,
-      () => this.calculateLoad()
+      () => this.calculateLoad(),
+      () => this.calculateCapacity()
     );
 
     this.poolClient.connect();
   }
 
-  // Calculate server load (0-100)
+  // Calculate server load (0-100): measured game cost over the game threads
   private calculateLoad(): number {
-    const stats = this.roomManager.getStats();
-    const roomLoad = (stats.rooms / this.config.maxRooms) * 100;
-    return Math.min(100, Math.round(roomLoad));
+    const report = this.roomManager.getLoadReport();
+    const cpuLoad = (report.load / Math.max(1, report.threads)) * 100;
+    return Math.min(100, Math.round(cpuLoad));
+  }
+
+  // How many more games fit, from their measured cost (capped by maxRooms)
+  private calculateCapacity(): PoolCapacity {
+    const report = this.roomManager.getLoadReport();
+    const roomsLeft = Math.max(0, this.config.maxRooms - this.roomManager.getStats().rooms);
+    return {
+      threads: report.threads,
+      roomCost: report.roomCost,
+      freeRooms: Math.min(roomsLeft, report.freeRooms),
+      tickOverruns: report.overruns,
+    };
   }
 
   // Get room manager for external access
@@ -2,6 +2,7 @@
 import WebSocket from 'ws';
 import {
   RoomInfo,
+  PoolCapacity,
   serializePoolToHubMessage,
   HubToPoolMessage,
 } from '../protocol.js';
@@ -35,6 +36,7 @@ export class PoolClient {
   private getRoomsCallback: (() => RoomInfo[]) | null = null;
   private getPlayerCountCallback: (() => number) | null = null;
   private getLoadCallback: (() => number) | null = null;
+  private getCapacityCallback: (() => PoolCapacity) | null = null;
 
   constructor(config: PoolClientConfig, events: PoolClientEvents = {}) {
     this.config = {
@@ -49,11 +51,13 @@ export class PoolClient {
   setStateCallbacks(
     getRooms: () => RoomInfo[],
     getPlayerCount: () => number,
-    getLoad: () => number
+    getLoad: () => number,
+    getCapacity?: () => PoolCapacity
   ): void {
     this.getRoomsCallback = getRooms;
     this.getPlayerCountCallback = getPlayerCount;
     this.getLoadCallback = getLoad;
+    this.getCapacityCallback = getCapacity ?? null;
   }
 
   // Connect to the hub
@@ -228,12 +232,14 @@ export class PoolClient {
     const rooms = this.getRoomsCallback?.() ?? [];
     const playerCount = this.getPlayerCountCallback?.() ?? 0;
     const load = this.getLoadCallback?.() ?? 0;
+    const capacity = this.getCapacityCallback?.();
 
     this.send({
       type: 'pool_heartbeat',
       rooms,
       playerCount,
       load,
+      capacity,
     });
   }
 
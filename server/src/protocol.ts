@@ -75,6 +75,7 @@ export interface PlayerSnapshot {
   money: number;
   kills: number;
   deaths: number;
+  dormant?: boolean;  // Culled for this client (binary snapshots): position and angles are stale
 }
 
 export interface BotSnapshot {
@@ -90,6 +91,7 @@ export interface BotSnapshot {
   currentWeapon: WeaponType;
   kills: number;
   deaths: number;
+  dormant?: boolean;
 }
 
 export interface DroppedWeaponSnapshot {
@@ -211,6 +213,13 @@ export interface ChangeTeamMessage {
   team: TeamId;
 }
 
+// Acknowledge the newest binary snapshot decoded (0 = send a full one).
+// Also opts the client in to binary snapshots instead of JSON game_state.
+export interface SnapshotAckMessage {
+  type: 'snapshot_ack';
+  sequence: number;
+}
+
 export type ClientMessage =
   | ListRoomsMessage
   | CreateRoomMessage
@@ -226,7 +235,8 @@ export type ClientMessage =
   | ChatMessage
   | ReadyMessage
   | StartGameMessage
-  | ChangeTeamMessage;
+  | ChangeTeamMessage
+  | SnapshotAckMessage;
 
 // ============ Server → Client Messages ============
 
@@ -377,6 +387,15 @@ export interface PoolServerInfo {
   load: number;             // 0-100 percentage
   lastHeartbeat: number;    // Timestamp
   rooms: RoomInfo[];
+  capacity?: PoolCapacity;  // Measured capacity (pools that report it)
+}
+
+// Capacity measured from the games' tick cost (see RoomWorkerPool)
+export interface PoolCapacity {
+  threads: number;          // Threads running games
+  roomCost: number;         // Average cost of a running game, in cores
+  freeRooms: number;        // Games estimated to still fit
+  tickOverruns: number;     // Tick overruns of the running games
 }
 
 export interface AggregatedRoomInfo extends RoomInfo {
@@ -399,6 +418,7 @@ export interface PoolHeartbeatMessage {
   rooms: RoomInfo[];
   playerCount: number;
   load: number;
+  capacity?: PoolCapacity;
 }
 
 export interface PoolRoomCreatedMessage {
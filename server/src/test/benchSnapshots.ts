@@ -0,0 +1,153 @@
+#!/usr/bin/env npx ts-node
+// Benchmark for binary delta snapshots
+// Run with: npx ts-node server/src/test/benchSnapshots.ts
+//
+// Simulates N moving players, encodes a snapshot per client each broadcast
+// (acks arriving two broadcasts late) and reports bytes/tick and encode time
+// against the JSON game_state every client used to get.
+
+import { SnapshotEncoder, SnapshotClient, ENTITY_PLAYER } from '../SnapshotEncoder.js';
+import { GameStateSnapshot, PlayerSnapshot } from '../protocol.js';
+
+const PLAYER_COUNTS = [2, 4, 8, 16, 32, 64];
+const TICKS = 400;           // Broadcasts (20Hz)
+const ACK_DELAY = 2;         // Broadcasts before a snapshot is acknowledged
+const MOVE_PER_TICK = 0.4;   // 8 units/s at 20Hz
+const VIEW_DISTANCE = 30;    // Culled scenario: enemies further than this are hidden
+
+function createPlayers(count: number): PlayerSnapshot[] {
+  const players: PlayerSnapshot[] = [];
+  for (let i = 0; i < count; i++) {
+    players.push({
+      id: `0b9c6d1e-${i.toString().padStart(4, '0')}-4a7f-8e21-5c3d9f0a6b42`,
+      name: `Player${i}`,
+      position: { x: ((i * 7919) % 100) - 50, y: 1.7, z: ((i * 104729) % 100) - 50 },
+      yaw: (i * 0.7) % (Math.PI * 2),
+      pitch: 0,
+      health: 100,
+      armor: 0,
+      team: i % 2 === 0 ? 'T' : 'CT',
+      isAlive: true,
+      currentWeapon: 'rifle',
+      money: 800,
+      kills: 0,
+      deaths: 0,
+    });
+  }
+  return players;
+}
+
+// Advance one broadcast: everyone walks and turns, someone occasionally takes damage
+function stepPlayers(players: PlayerSnapshot[], tick: number): void {
+  for (let i = 0; i < players.length; i++) {
+    const p = players[i];
+    p.yaw += Math.sin(tick * 0.1 + i) * 0.05;
+    p.pitch = Math.sin(tick * 0.05 + i) * 0.2;
+    p.position.x = Math.max(-60, Math.min(60, p.position.x + Math.cos(p.yaw) * MOVE_PER_TICK));
+    p.position.z = Math.max(-60, Math.min(60, p.position.z + Math.sin(p.yaw) * MOVE_PER_TICK));
+    if ((tick + i * 13) % 97 === 0) {
+      p.health = p.health > 30 ? p.health - 27 : 100;
+    }
+    if ((tick + i * 31) % 173 === 0) p.kills++;
+  }
+}
+
+function createSnapshot(players: PlayerSnapshot[], tick: number): GameStateSnapshot {
+  return {
+    tick: tick * 3,
+    timestamp: 1700000000000 + tick * 50,
+    phase: 'live',
+    roundTime: 120 - tick * 0.05,
+    freezeTime: 0,
+    players,
+    bots: [],
+    droppedWeapons: [],
+    tScore: 3,
+    ctScore: 5,
+    roundNumber: 9,
+  };
+}
+
+/**
+ * Run one scenario
+ * @param culled Hide enemies beyond VIEW_DISTANCE (stands in for line of sight)
+ */
+function runScenario(playerCount: number, culled: boolean): void {
+  const players = createPlayers(playerCount);
+  const encoder = new SnapshotEncoder();
+  const clients: SnapshotClient[] = [];
+  const pendingAcks: number[][] = [];
+  for (let i = 0; i < playerCount; i++) {
+    clients.push(new SnapshotClient());
+    pendingAcks.push([]);
+  }
+  const visible = new Uint8Array(256);
+
+  let binaryBytes = 0;
+  let jsonBytes = 0;
+  let encodeNs = 0n;
+
+  for (let tick = 1; tick <= TICKS; tick++) {
+    stepPlayers(players, tick);
+    const snapshot = createSnapshot(players, tick);
+    jsonBytes += JSON.stringify({ type: 'game_state', state: snapshot }).length * playerCount;
+
+    const start = process.hrtime.bigint();
+    encoder.beginWorld(snapshot);
+    for (const p of players) {
+      encoder.setEntity(ENTITY_PLAYER, p.id, p.name, p.position.x, p.position.y, p.position.z,
+        p.yaw, p.pitch, p.health, p.armor, p.isAlive, p.team, p.currentWeapon, p.money, p.kills, p.deaths);
+    }
+    encoder.endWorld();
+
+    for (let c = 0; c < playerCount; c++) {
+      let mask: Uint8Array | null = null;
+      if (culled) {
+        const viewer = players[c];
+        for (let i = 0; i < playerCount; i++) {
+          const p = players[i];
+          const dx = p.position.x - viewer.position.x;
+          const dz = p.position.z - viewer.position.z;
+          visible[encoder.slotOf(p.id)] =
+            p.team === viewer.team || dx * dx + dz * dz <= VIEW_DISTANCE * VIEW_DISTANCE ? 1 : 0;
+        }
+        mask = visible;
+      }
+      binaryBytes += encoder.encode(clients[c], mask).length;
+    }
+    encodeNs += process.hrtime.bigint() - start;
+
+    // Acks arrive ACK_DELAY broadcasts after their snapshot
+    for (let c = 0; c < playerCount; c++) {
+      pendingAcks[c].push(tick);
+      if (pendingAcks[c].length > ACK_DELAY) clients[c].acknowledge(pendingAcks[c].shift()!);
+    }
+  }
+
+  const stats = encoder.getStats();
+  const binaryPerTick = binaryBytes / TICKS;
+  const jsonPerTick = jsonBytes / TICKS;
+  const encodeUs = Number(encodeNs) / 1000 / TICKS;
+  console.log(
+    `  players=${playerCount.toString().padStart(2)}  ` +
+    `bytes/tick=${binaryPerTick.toFixed(0).padStart(6)} (JSON: ${jsonPerTick.toFixed(0).padStart(7)}, ` +
+    `${(jsonPerTick / binaryPerTick).toFixed(1).padStart(5)}x)  ` +
+    `bytes/client=${(binaryPerTick / playerCount).toFixed(1).padStart(6)}  ` +
+    `encode=${encodeUs.toFixed(1).padStart(7)} us/tick (${(encodeUs / playerCount).toFixed(2)} us/client)  ` +
+    `full=${stats.fullSnapshots}`
+  );
+}
+
+function main(): void {
+  console.log(`=== Snapshot Encoding Benchmark (${TICKS} broadcasts, acks ${ACK_DELAY} late) ===\n`);
+
+  console.log('Every entity sent:');
+  for (const count of PLAYER_COUNTS) runScenario(count, false);
+
+  console.log(`\nInterest culled (enemies within ${VIEW_DISTANCE} units):`);
+  for (const count of PLAYER_COUNTS) runScenario(count, true);
+
+  console.log('\n=== Benchmark Complete ===');
+}
+
+main();
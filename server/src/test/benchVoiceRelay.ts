@@ -0,0 +1,124 @@
+#!/usr/bin/env npx ts-node
+// Benchmark for the batched voice relay
+// Run with: npx ts-node server/src/test/benchVoiceRelay.ts
+//
+// Feeds one 20ms tick of voice frames from N talkers into a VoiceRelay with
+// fake sockets and reports flush time and socket sends, against the
+// per-packet relay (one send per talker per listener).
+
+import { WebSocket } from 'ws';
+import { VoiceRelay } from '../VoiceRelay.js';
+import { ConnectedClient } from '../types.js';
+import { TeamId, Vec3 } from '../protocol.js';
+
+const CLIENT_COUNT = 32;
+const TALKER_COUNTS = [1, 2, 5, 10, 16, 32];
+const TICKS = 500;
+const FRAME_SIZE = 12 + 6;  // Header + codec2 2400 payload
+
+interface FakeSocket {
+  readyState: number;
+  sends: number;
+  bytes: number;
+  send(data: Uint8Array): void;
+}
+
+function createFakeSocket(): FakeSocket {
+  return {
+    readyState: WebSocket.OPEN,
+    sends: 0,
+    bytes: 0,
+    send(data: Uint8Array) {
+      this.sends++;
+      this.bytes += data.length;
+    },
+  };
+}
+
+function createFrame(senderId: number, sequence: number): Uint8Array {
+  const frame = new Uint8Array(FRAME_SIZE);
+  const view = new DataView(frame.buffer);
+  frame[0] = 0x01;
+  frame[1] = 0x01;  // VAD
+  view.setUint32(2, senderId, true);
+  view.setUint32(6, sequence, true);
+  return frame;
+}
+
+/**
+ * Run one scenario
+ * @param spread World size the players are scattered over (small = everyone in range)
+ */
+function runScenario(talkers: number, spread: number): void {
+  const clients = new Map<string, ConnectedClient>();
+  const teams = new Map<string, TeamId>();
+  const positions = new Map<string, Vec3>();
+  const sockets: FakeSocket[] = [];
+
+  for (let i = 0; i < CLIENT_COUNT; i++) {
+    const id = `client-${i}`;
+    const socket = createFakeSocket();
+    sockets.push(socket);
+    clients.set(id, {
+      id,
+      socket: socket as unknown as WebSocket,
+      name: id,
+      roomId: 'bench',
+      isReady: true,
+      lastActivity: Date.now(),
+      pendingInputs: [],
+    } as ConnectedClient);
+    teams.set(id, i % 2 === 0 ? 'T' : 'CT');
+    positions.set(id, {
+      x: ((i * 7919) % 1000) / 1000 * spread,
+      y: 0,
+      z: ((i * 104729) % 1000) / 1000 * spread,
+    });
+  }
+
+  const relay = new VoiceRelay(false);
+  relay.setPositionSource((clientId) => positions.get(clientId) ?? null);
+
+  const frames: Uint8Array[][] = [];
+  for (let tick = 0; tick < TICKS; tick++) {
+    const tickFrames: Uint8Array[] = [];
+    for (let t = 0; t < talkers; t++) tickFrames.push(createFrame(t + 1, tick));
+    frames.push(tickFrames);
+  }
+
+  const start = process.hrtime.bigint();
+  for (let tick = 0; tick < TICKS; tick++) {
+    for (let t = 0; t < talkers; t++) {
+      relay.relayVoiceFrame(frames[tick][t], `client-${t}`, clients, teams);
+    }
+    relay.flush();
+  }
+  const elapsedUs = Number(process.hrtime.bigint() - start) / 1000;
+
+  const stats = relay.getStats();
+  const naiveSends = talkers * (CLIENT_COUNT - 1);
+  const sendsPerTick = stats.messagesOut / TICKS;
+  const deliveriesPerTick = stats.framesOut / TICKS;
+  console.log(
+    `  talkers=${talkers.toString().padStart(2)}  ` +
+    `${(elapsedUs / TICKS).toFixed(1).padStart(7)} us/tick  ` +
+    `sends/tick=${sendsPerTick.toFixed(1).padStart(5)} (per-packet: ${naiveSends.toString().padStart(4)})  ` +
+    `frames/tick=${deliveriesPerTick.toFixed(1).padStart(6)}  ` +
+    `bytes/tick=${(stats.bytesOut / TICKS).toFixed(0).padStart(6)}`
+  );
+  relay.clear();
+}
+
+function main(): void {
+  console.log(`=== Voice Relay Benchmark (${CLIENT_COUNT} clients, ${TICKS} ticks) ===\n`);
+
+  console.log('Everyone in range (spread 40 units):');
+  for (const talkers of TALKER_COUNTS) runScenario(talkers, 40);
+
+  console.log('\nScattered (spread 2000 units, proximity culled):');
+  for (const talkers of TALKER_COUNTS) runScenario(talkers, 2000);
+
+  console.log('\n=== Benchmark Complete ===');
+}
+
+main();
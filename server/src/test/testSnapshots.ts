@@ -0,0 +1,216 @@
+#!/usr/bin/env npx ts-node
+// Round-trip test for binary delta snapshots
+// Run with: npx ts-node server/src/test/testSnapshots.ts
+//
+// Encodes a full room of entities with maximum-length ids and names (the
+// worst case for the encoder's buffer bound), decodes each snapshot with the
+// client's SnapshotDecoder and checks every field survives: a full snapshot,
+// far moves with renames, culled (dormant) entities and removes.
+
+import { SnapshotEncoder, SnapshotClient, MAX_SNAPSHOT_ENTITIES, ENTITY_PLAYER } from '../SnapshotEncoder.js';
+import { GameStateSnapshot, PlayerSnapshot } from '../protocol.js';
+
+// The decoder lives in the client tree (outside this package's rootDir)
+interface ClientSnapshotDecoder {
+  decode(data: Uint8Array): GameStateSnapshot | null;
+  getAckSequence(): number;
+}
+const DECODER_MODULE = '../../../src/network/SnapshotDecoder.js';
+
+const MAX_STRING_BYTES = 63;
+const POS_TOLERANCE = 1 / 64;
+const ANGLE_TOLERANCE = (Math.PI * 2) / 65536;
+
+let failures = 0;
+
+function check(condition: boolean, message: string): void {
+  if (!condition) {
+    failures++;
+    if (failures <= 20) console.log(`  ✗ ${message}`);
+  }
+}
+
+// Exactly MAX_STRING_BYTES of UTF-8, unique per index
+function longString(prefix: string, index: number): string {
+  const head = `${prefix}${index}-`;
+  return head + 'x'.repeat(MAX_STRING_BYTES - head.length);
+}
+
+function createPlayers(): PlayerSnapshot[] {
+  const players: PlayerSnapshot[] = [];
+  for (let i = 0; i < MAX_SNAPSHOT_ENTITIES; i++) {
+    players.push({
+      id: longString('id', i),
+      name: longString('name', i),
+      // Spread over most of the quantized range (with room for the moves below)
+      position: { x: -1900 + (i * 15.7) % 3800, y: (i * 3.3) % 100, z: 1900 - (i * 11.1) % 3800 },
+      yaw: (i * 0.37) % (Math.PI * 2),
+      pitch: ((i % 7) - 3) * 0.3,
+      health: 127,
+      armor: 127,
+      team: i % 2 === 0 ? 'T' : 'CT',
+      isAlive: true,
+      currentWeapon: 'sniper',
+      money: 0xffff,
+      kills: 0xffff,
+      deaths: 0xffff,
+    });
+  }
+  return players;
+}
+
+function createSnapshot(players: PlayerSnapshot[], tick: number): GameStateSnapshot {
+  return {
+    tick,
+    timestamp: 1700000000000 + tick * 50,
+    phase: 'live',
+    roundTime: 90,
+    freezeTime: 0,
+    players,
+    bots: [],
+    droppedWeapons: [],
+    tScore: 12,
+    ctScore: 14,
+    roundNumber: 27,
+  };
+}
+
+function angleDiff(a: number, b: number): number {
+  const d = Math.abs(a - b) % (Math.PI * 2);
+  return Math.min(d, Math.PI * 2 - d);
+}
+
+/**
+ * Encode one broadcast, decode it and compare with what was sent
+ * @param hidden Ids culled for this client (sent dormant)
+ * @param lastSeen Positions the client last saw, kept for dormant entities
+ */
+function roundTrip(
+  encoder: SnapshotEncoder,
+  client: SnapshotClient,
+  decoder: ClientSnapshotDecoder,
+  snapshot: GameStateSnapshot,
+  hidden: Set<string>,
+  lastSeen: Map<string, PlayerSnapshot>,
+  label: string
+): void {
+  encoder.beginWorld(snapshot);
+  for (const p of snapshot.players) {
+    encoder.setEntity(ENTITY_PLAYER, p.id, p.name, p.position.x, p.position.y, p.position.z,
+      p.yaw, p.pitch, p.health, p.armor, p.isAlive, p.team, p.currentWeapon, p.money, p.kills, p.deaths);
+  }
+  encoder.endWorld();
+
+  const visible = new Uint8Array(MAX_SNAPSHOT_ENTITIES).fill(1);
+  for (const id of hidden) visible[encoder.slotOf(id)] = 0;
+  const data = encoder.encode(client, visible);
+  check(data.length <= client.buffer.length, `${label}: wrote past the buffer`);
+
+  let decoded: GameStateSnapshot | null = null;
+  try {
+    decoded = decoder.decode(new Uint8Array(data));
+  } catch (error) {
+    check(false, `${label}: decode failed (${error})`);
+    return;
+  }
+  if (!decoded) {
+    check(false, `${label}: baseline not found`);
+    return;
+  }
+  client.acknowledge(decoder.getAckSequence());
+
+  check(decoded.tick === snapshot.tick && decoded.roundNumber === snapshot.roundNumber, `${label}: header`);
+  check(decoded.players.length === snapshot.players.length,
+    `${label}: ${decoded.players.length} players decoded, ${snapshot.players.length} sent`);
+
+  const byId = new Map(decoded.players.map(p => [p.id, p]));
+  for (const sent of snapshot.players) {
+    const got = byId.get(sent.id);
+    if (!got) {
+      check(false, `${label}: ${sent.id} missing`);
+      continue;
+    }
+    const dormant = hidden.has(sent.id);
+    check(got.dormant === dormant, `${label}: ${sent.id} dormant ${got.dormant}`);
+    check(got.name === sent.name, `${label}: ${sent.id} name "${got.name}"`);
+    check(got.health === sent.health && got.armor === sent.armor && got.isAlive === sent.isAlive,
+      `${label}: ${sent.id} vitals`);
+    check(got.team === sent.team && got.currentWeapon === sent.currentWeapon, `${label}: ${sent.id} team/weapon`);
+    check(got.money === sent.money && got.kills === sent.kills && got.deaths === sent.deaths,
+      `${label}: ${sent.id} money/score`);
+
+    // Dormant entities keep the position the client last saw
+    const expected = dormant ? lastSeen.get(sent.id) : sent;
+    if (expected) {
+      const dx = Math.abs(got.position.x - expected.position.x);
+      const dy = Math.abs(got.position.y - expected.position.y);
+      const dz = Math.abs(got.position.z - expected.position.z);
+      check(dx <= POS_TOLERANCE && dy <= POS_TOLERANCE && dz <= POS_TOLERANCE,
+        `${label}: ${sent.id} position off by (${dx}, ${dy}, ${dz})`);
+      check(angleDiff(got.yaw, expected.yaw) <= ANGLE_TOLERANCE, `${label}: ${sent.id} yaw`);
+    }
+    if (!dormant) lastSeen.set(sent.id, structuredClone(sent));
+  }
+}
+
+async function testSnapshots(): Promise<void> {
+  console.log('=== Snapshot Round-Trip Test ===\n');
+
+  const { SnapshotDecoder } = await import(DECODER_MODULE) as { SnapshotDecoder: new () => ClientSnapshotDecoder };
+  const encoder = new SnapshotEncoder();
+  const client = new SnapshotClient();
+  const decoder = new SnapshotDecoder();
+  const players = createPlayers();
+  const lastSeen = new Map<string, PlayerSnapshot>();
+  const none = new Set<string>();
+
+  console.log(`1. Full snapshot of ${players.length} max-length entities`);
+  roundTrip(encoder, client, decoder, createSnapshot(players, 1), none, lastSeen, 'full');
+
+  console.log('2. Far moves and renames against the baseline');
+  for (let i = 0; i < players.length; i++) {
+    const p = players[i];
+    p.position.x = -p.position.x;
+    p.position.z = -p.position.z;
+    p.yaw = (p.yaw + 1) % (Math.PI * 2);
+    p.name = longString('renamed', i);
+    p.kills = i;
+  }
+  roundTrip(encoder, client, decoder, createSnapshot(players, 2), none, lastSeen, 'update');
+
+  console.log('3. Half the room culled (dormant), the rest moving');
+  const hidden = new Set(players.filter((_, i) => i % 2 === 1).map(p => p.id));
+  for (const p of players) {
+    p.position.x += 50;
+    p.health = 40;
+  }
+  roundTrip(encoder, client, decoder, createSnapshot(players, 3), hidden, lastSeen, 'dormant');
+
+  console.log('4. Culled entities visible again');
+  for (const p of players) p.position.z += 1;
+  roundTrip(encoder, client, decoder, createSnapshot(players, 4), none, lastSeen, 'reveal');
+
+  console.log('5. Half the room removed');
+  const remaining = players.filter((_, i) => i % 2 === 0);
+  roundTrip(encoder, client, decoder, createSnapshot(remaining, 5), none, lastSeen, 'remove');
+
+  console.log('6. Room refilled with new max-length entities');
+  const refilled = [...remaining];
+  for (let i = 0; refilled.length < MAX_SNAPSHOT_ENTITIES; i++) {
+    refilled.push({ ...players[i], id: longString('new', i), position: { ...players[i].position } });
+  }
+  roundTrip(encoder, client, decoder, createSnapshot(refilled, 6), none, lastSeen, 'refill');
+
+  if (failures === 0) {
+    console.log('\n✓ SUCCESS: every snapshot decoded to what was sent');
+  } else {
+    console.log(`\n✗ FAILURE: ${failures} mismatch(es)`);
+    process.exitCode = 1;
+  }
+}
+
+// Run the test
+testSnapshots().catch((error) => {
+  console.error('Test failed:', error);
+  process.exitCode = 1;
+});
@@ -20,6 +20,7 @@ export interface ServerConfig {
   maxRooms: number;           // Maximum concurrent rooms
   maxPlayersPerRoom: number;  // Maximum players per room
   roomIdleTimeout: number;    // Ms before empty room is removed
+  roomWorkers: number;        // Threads running games (-1 = cores - 1, 0 = main thread)
 }
 
 export const DEFAULT_SERVER_CONFIG: ServerConfig = {
@@ -29,6 +30,7 @@ export const DEFAULT_SERVER_CONFIG: ServerConfig = {
   maxRooms: 100,
   maxPlayersPerRoom: 10,
   roomIdleTimeout: 300000,  // 5 minutes
+  roomWorkers: -1,
 };
 
 // ============ Connected Client ============
@@ -0,0 +1,49 @@
+// Messages between the main thread (RoomWorkerPool) and room workers
+// (roomWorker.ts). Sockets stay on the main thread; a worker runs the
+// GameRunners of its rooms and hands back serialized messages to send.
+
+import { BotDifficulty, ClientMessage, GamePhase, RoomConfig, TeamId } from '../protocol.js';
+import { MapData, ServerConfig, ServerGameState } from '../types.js';
+import { TickSchedulerStats } from '../TickScheduler.js';
+
+// ============ Main → Worker ============
+
+export interface WorkerCreateRoom {
+  type: 'create';
+  roomId: string;
+  state: ServerGameState;
+  mapData: MapData;
+  roomConfig: RoomConfig;
+  serverConfig: ServerConfig;
+  collisionWorld: Uint8Array | null;  // Backed by a SharedArrayBuffer
+}
+
+export type MainToWorkerMessage =
+  | WorkerCreateRoom
+  | { type: 'start'; roomId: string }
+  | { type: 'stop'; roomId: string }
+  | { type: 'add_player'; roomId: string; clientId: string; name: string; team: TeamId }
+  | { type: 'remove_player'; roomId: string; clientId: string }
+  | { type: 'add_bot'; roomId: string; name: string; team: TeamId; difficulty: BotDifficulty }
+  | { type: 'input'; roomId: string; clientId: string; message: ClientMessage }
+  | { type: 'snapshot_ack'; roomId: string; clientId: string; sequence: number }
+  // A client's socket is backlogged (or drained again): skip its snapshots meanwhile
+  | { type: 'socket_busy'; roomId: string; clientId: string; busy: boolean };
+
+// ============ Worker → Main ============
+
+// Live players' positions, flattened (for voice proximity on the main thread)
+export interface WorkerRoomStatus {
+  type: 'status';
+  roomId: string;
+  phase: GamePhase;
+  playerIds: string[];
+  positions: number[];  // x, y, z per playerIds entry
+}
+
+export type WorkerToMainMessage =
+  | { type: 'broadcast'; roomId: string; data: string }
+  | { type: 'send'; roomId: string; clientId: string; data: string }
+  | { type: 'snapshot'; roomId: string; clientId: string; data: Uint8Array }
+  | WorkerRoomStatus
+  | { type: 'stats'; stats: TickSchedulerStats };
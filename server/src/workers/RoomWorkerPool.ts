@@ -0,0 +1,375 @@
+// Room worker pool - spreads the rooms' GameRunners across worker threads
+//
+// Every room used to tick on the process's one event loop, so one busy room
+// (bots tracing line of sight, hit detection) showed up as tick jitter in all
+// the others. Rooms now run on worker threads (roomWorker.ts), each with its
+// own deadline scheduler; the main thread keeps the sockets and the lobby.
+//
+// - A new game goes to the worker with the lowest measured load
+// - Each map's collision tree is built once into a SharedArrayBuffer that
+//   every worker traces in place
+// - With roomWorkers = 0 (or no compiled worker script, e.g. under ts-node)
+//   games run on the main thread's scheduler as before
+//
+// getLoadReport() turns the measured per-room tick cost into the pool's
+// capacity for the hub.
+
+import { Worker } from 'worker_threads';
+import { existsSync } from 'fs';
+import { fileURLToPath } from 'url';
+import { availableParallelism } from 'os';
+import { GameRunner, SnapshotTransport } from '../GameRunner.js';
+import { buildSharedCollisionWorld } from '../NativeBVH.js';
+import { RoomTickStats, TickSchedulerStats, getTickScheduler } from '../TickScheduler.js';
+import {
+  BotDifficulty,
+  ClientMessage,
+  GamePhase,
+  RoomConfig,
+  ServerMessage,
+  TeamId,
+  Vec3,
+} from '../protocol.js';
+import { MapData, ServerConfig, ServerGameState } from '../types.js';
+import { MainToWorkerMessage, WorkerRoomStatus, WorkerToMainMessage } from './RoomWorkerMessages.js';
+
+// Capacity estimate
+const TARGET_UTILIZATION = 0.7;  // Share of a thread rooms may use before it counts as full
+const DEFAULT_ROOM_COST = 0.05;  // Cores per running room until one has been measured
+
+const RESPAWN_DELAY_MS = 1000;   // Before replacing a worker that died (no tight crash loop)
+
+// What a running game needs from its Room
+export interface RoomOutput {
+  broadcast(msg: ServerMessage): void;
+  sendToClient(clientId: string, msg: ServerMessage): void;
+  broadcastSerialized(data: string): void;
+  sendSerialized(clientId: string, data: string): void;
+  snapshots: SnapshotTransport;
+  // The game is gone without stop() (its worker died); the Room ends it
+  lost(reason: string): void;
+}
+
+// A running game, in this thread (GameRunner) or on a worker
+export interface RoomRunner {
+  start(): void;
+  stop(): void;
+  addPlayer(clientId: string, name: string, team: TeamId): void;
+  removePlayer(clientId: string): void;
+  addBot(name: string, team: TeamId, difficulty: BotDifficulty): void;
+  handleInput(clientId: string, message: ClientMessage): void;
+  handleSnapshotAck(clientId: string, sequence: number): void;
+  getPlayerPosition(clientId: string): Vec3 | null;
+  getPhase(): GamePhase;
+}
+
+export interface PoolLoadReport {
+  threads: number;       // Threads running games
+  runningRooms: number;
+  load: number;          // Measured cost of the running games, in cores
+  roomCost: number;      // Average cost of one running game, in cores
+  freeRooms: number;     // Games estimated to still fit under TARGET_UTILIZATION
+  overruns: number;      // Tick overruns of the running games
+  rooms: RoomTickStats[];
+}
+
+interface RoomWorker {
+  index: number;
+  worker: Worker;
+  runners: Map<string, WorkerGameRunner>;
+  stats: TickSchedulerStats | null;
+  alive: boolean;
+}
+
+/**
+ * Main-thread stand-in for a GameRunner on a worker. Calls are posted to
+ * the worker; phase and positions come back with each broadcast.
+ */
+class WorkerGameRunner implements RoomRunner {
+  readonly output: RoomOutput;
+  private host: RoomWorker;
+  private roomId: string;
+  private phase: GamePhase;
+  private positions: Map<string, Vec3> = new Map();
+  private busyClients: Set<string> = new Set();  // Told the worker their socket is backlogged
+
+  constructor(host: RoomWorker, roomId: string, phase: GamePhase, output: RoomOutput) {
+    this.host = host;
+    this.roomId = roomId;
+    this.phase = phase;
+    this.output = output;
+  }
+
+  start(): void {
+    this.post({ type: 'start', roomId: this.roomId });
+  }
+
+  stop(): void {
+    this.post({ type: 'stop', roomId: this.roomId });
+    this.host.runners.delete(this.roomId);
+  }
+
+  addPlayer(clientId: string, name: string, team: TeamId): void {
+    this.post({ type: 'add_player', roomId: this.roomId, clientId, name, team });
+  }
+
+  removePlayer(clientId: string): void {
+    this.post({ type: 'remove_player', roomId: this.roomId, clientId });
+    this.positions.delete(clientId);
+    this.busyClients.delete(clientId);
+  }
+
+  addBot(name: string, team: TeamId, difficulty: BotDifficulty): void {
+    this.post({ type: 'add_bot', roomId: this.roomId, name, team, difficulty });
+  }
+
+  handleInput(clientId: string, message: ClientMessage): void {
+    this.post({ type: 'input', roomId: this.roomId, clientId, message });
+  }
+
+  handleSnapshotAck(clientId: string, sequence: number): void {
+    this.post({ type: 'snapshot_ack', roomId: this.roomId, clientId, sequence });
+  }
+
+  getPlayerPosition(clientId: string): Vec3 | null {
+    return this.positions.get(clientId) ?? null;
+  }
+
+  getPhase(): GamePhase {
+    return this.phase;
+  }
+
+  /**
+   * Send a snapshot from the worker, or drop it for a backlogged socket.
+   * The worker's encoder only sees the socket through the busy state, so on
+   * a drop it is told to stop encoding for that client until it drains.
+   */
+  sendSnapshot(clientId: string, data: Uint8Array): void {
+    if (this.output.snapshots.isIdle(clientId)) {
+      this.output.snapshots.send(clientId, data);
+    } else if (!this.busyClients.has(clientId)) {
+      this.busyClients.add(clientId);
+      this.post({ type: 'socket_busy', roomId: this.roomId, clientId, busy: true });
+    }
+  }
+
+  applyStatus(status: WorkerRoomStatus): void {
+    // Status comes at the broadcast rate: resume clients whose socket drained
+    for (const clientId of this.busyClients) {
+      if (!this.output.snapshots.isIdle(clientId)) continue;
+      this.busyClients.delete(clientId);
+      this.post({ type: 'socket_busy', roomId: this.roomId, clientId, busy: false });
+    }
+
+    this.phase = status.phase;
+    this.positions.clear();
+    for (let i = 0; i < status.playerIds.length; i++) {
+      this.positions.set(status.playerIds[i], {
+        x: status.positions[i * 3],
+        y: status.positions[i * 3 + 1],
+        z: status.positions[i * 3 + 2],
+      });
+    }
+  }
+
+  private post(message: MainToWorkerMessage): void {
+    if (this.host.alive) this.host.worker.postMessage(message);
+  }
+}
+
+export class RoomWorkerPool {
+  private workers: RoomWorker[] = [];
+  private script: URL | null = null;
+  private collisionWorlds: Map<string, Uint8Array | null> = new Map();
+
+  constructor(config: ServerConfig) {
+    const count = config.roomWorkers < 0 ? Math.max(0, availableParallelism() - 1) : config.roomWorkers;
+    if (count === 0) return;
+
+    const script = new URL('./roomWorker.js', import.meta.url);
+    if (!existsSync(fileURLToPath(script))) {
+      console.warn('[RoomWorkerPool] Worker script not built; running rooms on the main thread');
+      return;
+    }
+    this.script = script;
+    for (let i = 0; i < count; i++) this.workers.push(this.spawn(i));
+    console.log(`[RoomWorkerPool] ${count} room worker thread${count === 1 ? '' : 's'}`);
+  }
+
+  /**
+   * Create a game for a room on the least loaded worker (or this thread)
+   */
+  createRunner(
+    roomId: string,
+    state: ServerGameState,
+    mapData: MapData,
+    roomConfig: RoomConfig,
+    serverConfig: ServerConfig,
+    output: RoomOutput
+  ): RoomRunner {
+    const collisionWorld = this.getCollisionWorld(mapData);
+    const host = this.pickWorker();
+
+    if (!host) {
+      return new GameRunner(
+        state,
+        mapData,
+        roomConfig,
+        serverConfig,
+        output.broadcast,
+        output.sendToClient,
+        output.snapshots,
+        { roomId, collisionWorld }
+      );
+    }
+
+    const runner = new WorkerGameRunner(host, roomId, state.phase, output);
+    host.runners.set(roomId, runner);
+    const create: MainToWorkerMessage = {
+      type: 'create',
+      roomId,
+      state,
+      mapData,
+      roomConfig,
+      serverConfig,
+      collisionWorld,
+    };
+    host.worker.postMessage(create);
+    return runner;
+  }
+
+  /**
+   * Capacity from measured tick cost: how loaded the game threads are and how
+   * many more games of the average measured cost still fit
+   */
+  getLoadReport(): PoolLoadReport {
+    const threads: { stats: TickSchedulerStats; running: number }[] = [];
+    const live = this.workers.filter(w => w.alive);
+    for (const w of live) {
+      threads.push({ stats: w.stats ?? { load: 0, overruns: 0, rooms: [] }, running: w.runners.size });
+    }
+    // Games on this thread (no workers, or every worker died)
+    const local = getTickScheduler().getStats();
+    if (live.length === 0 || local.rooms.length > 0) {
+      threads.push({ stats: local, running: local.rooms.length });
+    }
+
+    const rooms: RoomTickStats[] = [];
+    let measuredLoad = 0;
+    let measuredRooms = 0;
+    let overruns = 0;
+    let running = 0;
+    for (const t of threads) {
+      for (const room of t.stats.rooms) {
+        rooms.push(room);
+        if (room.load > 0) {
+          measuredLoad += room.load;
+          measuredRooms++;
+        }
+      }
+      overruns += t.stats.overruns;
+      running += t.running;
+    }
+    const roomCost = measuredRooms > 0 ? Math.max(measuredLoad / measuredRooms, 0.001) : DEFAULT_ROOM_COST;
+
+    // Games don't span threads, so count what fits on each one
+    let load = 0;
+    let freeRooms = 0;
+    for (const t of threads) {
+      const unmeasured = Math.max(0, t.running - t.stats.rooms.filter(r => r.load > 0).length);
+      const threadLoad = t.stats.load + unmeasured * roomCost;
+      load += threadLoad;
+      freeRooms += Math.max(0, Math.floor((TARGET_UTILIZATION - threadLoad) / roomCost));
+    }
+
+    return { threads: threads.length, runningRooms: running, load, roomCost, freeRooms, overruns, rooms };
+  }
+
+  shutdown(): void {
+    this.script = null;
+    for (const w of this.workers) {
+      w.alive = false;
+      w.worker.terminate();
+    }
+    this.workers = [];
+  }
+
+  private spawn(index: number): RoomWorker {
+    const worker = new Worker(this.script!);
+    const host: RoomWorker = { index, worker, runners: new Map(), stats: null, alive: true };
+
+    worker.on('message', (msg: WorkerToMainMessage) => this.handleWorkerMessage(host, msg));
+    worker.on('error', (error) => {
+      console.error(`[RoomWorkerPool] Room worker ${index} failed:`, error);
+    });
+    worker.on('exit', (code) => {
+      if (!host.alive) return;
+      host.alive = false;
+      console.error(`[RoomWorkerPool] Room worker ${index} exited (${code}); ${host.runners.size} game(s) lost`);
+      const lost = Array.from(host.runners.values());
+      host.runners.clear();
+      for (const runner of lost) runner.output.lost('the server hit an error');
+
+      // Replace it (new games go to the other workers meanwhile)
+      setTimeout(() => {
+        const slot = this.workers.indexOf(host);
+        if (!this.script || slot < 0) return;
+        this.workers[slot] = this.spawn(index);
+        console.log(`[RoomWorkerPool] Room worker ${index} restarted`);
+      }, RESPAWN_DELAY_MS);
+    });
+    return host;
+  }
+
+  private handleWorkerMessage(host: RoomWorker, msg: WorkerToMainMessage): void {
+    if (msg.type === 'stats') {
+      host.stats = msg.stats;
+      return;
+    }
+
+    const runner = host.runners.get(msg.roomId);
+    if (!runner) return;
+
+    switch (msg.type) {
+      case 'broadcast':
+        runner.output.broadcastSerialized(msg.data);
+        break;
+      case 'send':
+        runner.output.sendSerialized(msg.clientId, msg.data);
+        break;
+      case 'snapshot':
+        runner.sendSnapshot(msg.clientId, msg.data);
+        break;
+      case 'status':
+        runner.applyStatus(msg);
+        break;
+    }
+  }
+
+  // Least loaded live worker, counting unmeasured games at the default cost
+  private pickWorker(): RoomWorker | null {
+    let best: RoomWorker | null = null;
+    let bestLoad = Infinity;
+    for (const w of this.workers) {
+      if (!w.alive) continue;
+      const measured = w.stats ? w.stats.rooms.filter(r => w.runners.has(r.roomId) && r.load > 0) : [];
+      let load = (w.runners.size - measured.length) * DEFAULT_ROOM_COST;
+      for (const room of measured) load += room.load;
+      if (load < bestLoad) {
+        bestLoad = load;
+        best = w;
+      }
+    }
+    return best;
+  }
+
+  // One shared tree per map (null when the addon can't share one)
+  private getCollisionWorld(mapData: MapData): Uint8Array | null {
+    let world = this.collisionWorlds.get(mapData.id);
+    if (world === undefined) {
+      world = buildSharedCollisionWorld(mapData.colliders);
+      this.collisionWorlds.set(mapData.id, world);
+    }
+    return world;
+  }
+}
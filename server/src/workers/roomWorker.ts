@@ -0,0 +1,137 @@
+// Room worker - runs the GameRunners of the rooms placed on this thread
+//
+// Started by RoomWorkerPool. All rooms here share this thread's
+// TickScheduler; messages are serialized here so the main thread only
+// writes them to sockets. Every STATS_INTERVAL_MS the scheduler's per-room
+// cost is posted back for placement and the pool's capacity report.
+
+import { parentPort } from 'worker_threads';
+import { GameRunner } from '../GameRunner.js';
+import { TickTask, getTickScheduler } from '../TickScheduler.js';
+import { serializeServerMessage } from '../protocol.js';
+import { MainToWorkerMessage, WorkerCreateRoom, WorkerToMainMessage } from './RoomWorkerMessages.js';
+
+const STATS_INTERVAL_MS = 1000;
+
+interface WorkerRoom {
+  runner: GameRunner;
+  playerIds: Set<string>;
+  busyClients: Set<string>;  // Backlogged sockets, as reported by the main thread
+  statusIntervalMs: number;
+  statusTask: TickTask | null;
+}
+
+const port = parentPort!;
+const scheduler = getTickScheduler();
+const rooms: Map<string, WorkerRoom> = new Map();
+
+function post(message: WorkerToMainMessage, transfer?: ArrayBuffer[]): void {
+  port.postMessage(message, transfer);
+}
+
+function createRoom(msg: WorkerCreateRoom): void {
+  const roomId = msg.roomId;
+  const busyClients = new Set<string>();
+  const runner = new GameRunner(
+    msg.state,
+    msg.mapData,
+    msg.roomConfig,
+    msg.serverConfig,
+    (message) => post({ type: 'broadcast', roomId, data: serializeServerMessage(message) }),
+    (clientId, message) => post({ type: 'send', roomId, clientId, data: serializeServerMessage(message) }),
+    {
+      // Snapshots are copied out, so the encoder's buffer is always free;
+      // what matters is whether the main thread can still write the socket
+      isIdle: (clientId) => !busyClients.has(clientId),
+      send: (clientId, data) => {
+        const copy = new Uint8Array(data);
+        post({ type: 'snapshot', roomId, clientId, data: copy }, [copy.buffer]);
+      },
+    },
+    { roomId, scheduler, collisionWorld: msg.collisionWorld }
+  );
+  rooms.set(roomId, {
+    runner,
+    playerIds: new Set(),
+    busyClients,
+    statusIntervalMs: 1000 / msg.serverConfig.broadcastRate,
+    statusTask: null,
+  });
+}
+
+// Phase and live positions for the main thread's Room (voice, room list)
+function postStatus(roomId: string, room: WorkerRoom): void {
+  const playerIds: string[] = [];
+  const positions: number[] = [];
+  for (const id of room.playerIds) {
+    const position = room.runner.getPlayerPosition(id);
+    if (!position) continue;
+    playerIds.push(id);
+    positions.push(position.x, position.y, position.z);
+  }
+  post({ type: 'status', roomId, phase: room.runner.getPhase(), playerIds, positions });
+}
+
+function handleMessage(msg: MainToWorkerMessage): void {
+  if (msg.type === 'create') {
+    createRoom(msg);
+    return;
+  }
+
+  const roomId = msg.roomId;
+  const room = rooms.get(roomId);
+  if (!room) return;
+
+  switch (msg.type) {
+    case 'start':
+      room.runner.start();
+      room.statusTask = scheduler.add(roomId, room.statusIntervalMs, () => postStatus(roomId, room));
+      break;
+
+    case 'stop':
+      room.runner.stop();
+      room.statusTask?.cancel();
+      rooms.delete(roomId);
+      break;
+
+    case 'add_player':
+      room.runner.addPlayer(msg.clientId, msg.name, msg.team);
+      room.playerIds.add(msg.clientId);
+      break;
+
+    case 'remove_player':
+      room.runner.removePlayer(msg.clientId);
+      room.playerIds.delete(msg.clientId);
+      room.busyClients.delete(msg.clientId);
+      break;
+
+    case 'add_bot':
+      room.runner.addBot(msg.name, msg.team, msg.difficulty);
+      break;
+
+    case 'input': {
+      const { clientId, message } = msg;
+      scheduler.charge(roomId, () => room.runner.handleInput(clientId, message));
+      break;
+    }
+
+    case 'snapshot_ack':
+      room.runner.handleSnapshotAck(msg.clientId, msg.sequence);
+      break;
+
+    case 'socket_busy':
+      if (msg.busy) room.busyClients.add(msg.clientId);
+      else room.busyClients.delete(msg.clientId);
+      break;
+  }
+}
+
+port.on('message', (msg: MainToWorkerMessage) => {
+  try {
+    handleMessage(msg);
+  } catch (error) {
+    console.error(`[RoomWorker] Error handling ${msg.type}:`, error);
+  }
+});
+
+setInterval(() => post({ type: 'stats', stats: scheduler.getStats() }), STATS_INTERVAL_MS);
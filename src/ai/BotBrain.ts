@@ -164,6 +164,12 @@ export class BotBrain {
     // Try mesh collision first (for BSP maps)
     const collisionMesh = getGlobalCollisionMesh();
     if (collisionMesh && collisionMesh.triangles.length > 0) {
+      collisionMesh.ensureBVH();
+      if (collisionMesh.native) {
+        // Native BVH: any-hit query stops at the first blocking triangle
+        return collisionMesh.native.raycast(from.x, from.y, from.z, dirX, dirY, dirZ, distance - 0.1, true) === null;
+      }
+
       // Fast path: check only triangles in the ray's bounding box
       const minX = Math.min(from.x, to.x) - 0.5;
       const maxX = Math.max(from.x, to.x) + 0.5;
@@ -0,0 +1,185 @@
+/**
+ * NativeMixer - Native effect mixer and the one audio device stream
+ *
+ * Wraps the effect mixer thread in the codec2 addon. SoundEngine uploads
+ * each effect once as a wavetable; after that a play is a single queued
+ * command and the native thread does the voice allocation, distance gain,
+ * pan and mixing. Voice chat from the voice engine is routed into the same
+ * mix, so everything reaches the device through one Speaker that pulls
+ * mixed audio as it needs it (no per-sound buffers or device streams).
+ * Only a voice engine running at MIXER_SAMPLE_RATE is routed; at any other
+ * rate it keeps its own playback (the mixer does not resample).
+ */
+
+import Speaker from 'speaker';
+import { Readable } from 'stream';
+import { Vector3 } from '../engine/math/Vector3.js';
+import { getNativeCodec2, NativeCodec2, AudioMixerStats } from '../voice/Codec2.js';
+
+export const MIXER_SAMPLE_RATE = 48000;
+
+const CHUNK_FRAMES = 480;                 // 10ms per device write
+const CHUNK_BYTES = CHUNK_FRAMES * 2 * 2; // Stereo int16
+const CHUNK_POOL = 8;                     // Reused chunks; the streams hold at most ~3 at once
+const TARGET_MS = 40;                     // Mixed audio kept ready ahead of the device
+
+/**
+ * Native effect mixer (SoundEngine falls back to per-sound Speakers when unavailable)
+ */
+export class NativeMixer {
+  private native: NativeCodec2 | null;
+  private isRunning = false;
+  private speaker: Speaker | null = null;
+  private source: Readable | null = null;
+  private chunks: Buffer[] = [];
+  private chunkViews: Int16Array[] = [];
+  private nextChunk = 0;
+
+  constructor() {
+    const native = getNativeCodec2();
+    this.native = native && typeof native.audioStart === 'function' ? native : null;
+  }
+
+  /**
+   * Check if the native mixer can be used
+   */
+  static isAvailable(): boolean {
+    const native = getNativeCodec2();
+    return !!native && typeof native.audioStart === 'function';
+  }
+
+  /**
+   * Upload the effect wavetables, start the mixer thread and open the device
+   *
+   * @param effects Mono wavetables at MIXER_SAMPLE_RATE, indexed by effect id
+   * @param onError Called if the device stream fails (the mixer is stopped)
+   * @returns false if the native mixer is unavailable
+   */
+  start(effects: Float32Array[], onError: () => void): boolean {
+    if (!this.native) return false;
+    if (this.isRunning) return true;
+    try {
+      for (let id = 0; id < effects.length; id++) {
+        this.native.audioLoadEffect(id, effects[id]);
+      }
+      this.isRunning = this.native.audioStart(TARGET_MS, true);
+    } catch {
+      this.isRunning = false;
+    }
+    if (!this.isRunning) return false;
+
+    for (let i = 0; i < CHUNK_POOL; i++) {
+      const chunk = Buffer.alloc(CHUNK_BYTES);
+      this.chunks.push(chunk);
+      this.chunkViews.push(new Int16Array(chunk.buffer, chunk.byteOffset, CHUNK_BYTES / 2));
+    }
+
+    // The device pulls: each read drains one chunk of mixed audio, padded with
+    // silence if the mixer is behind. Small high water marks keep the streams
+    // from buffering much past the mixer's own target depth.
+    const native = this.native;
+    this.source = new Readable({
+      highWaterMark: CHUNK_BYTES,
+      read: () => {
+        const index = this.nextChunk;
+        this.nextChunk = (index + 1) % CHUNK_POOL;
+        const view = this.chunkViews[index];
+        const count = native.audioRead(view);
+        if (count < view.length) view.fill(0, count);
+        this.source?.push(this.chunks[index]);
+      },
+    });
+
+    try {
+      this.speaker = new Speaker({
+        channels: 2,
+        bitDepth: 16,
+        sampleRate: MIXER_SAMPLE_RATE,
+        signed: true,
+        highWaterMark: CHUNK_BYTES,
+      });
+    } catch {
+      this.stop();
+      return false;
+    }
+    this.speaker.on('error', () => {
+      this.stop();
+      onError();
+    });
+    this.source.pipe(this.speaker);
+    return true;
+  }
+
+  /**
+   * Stop the mixer thread and close the device (voice goes back to its own playback)
+   */
+  stop(): void {
+    if (!this.native || !this.isRunning) return;
+    this.isRunning = false;
+    this.native.audioStop();
+    if (this.source && this.speaker) this.source.unpipe(this.speaker);
+    this.source?.destroy();
+    this.source = null;
+    try {
+      this.speaker?.end();
+    } catch {}
+    this.speaker = null;
+    this.chunks = [];
+    this.chunkViews = [];
+    this.nextChunk = 0;
+  }
+
+  /**
+   * Play an effect
+   *
+   * @param position Source position, or null for centered at full volume
+   * @param volume 0-1
+   * @param priority 0-255; with every voice busy, the lowest priority one at or below this is cut
+   */
+  play(id: number, position: Vector3 | null, volume: number, priority: number): boolean {
+    if (!this.native || !this.isRunning) return false;
+    if (position) {
+      return this.native.audioPlay(id, position.x, position.y, position.z, volume, priority, true);
+    }
+    return this.native.audioPlay(id, 0, 0, 0, volume, priority, false);
+  }
+
+  /**
+   * Update listener position and orientation (shared with the voice engine)
+   */
+  setListener(position: Vector3, yaw: number): void {
+    if (!this.native) return;
+    this.native.voiceEngineSetListener(position.x, position.y, position.z, yaw);
+  }
+
+  /**
+   * Effect master volume, 0-1
+   */
+  setVolume(volume: number): void {
+    if (!this.native) return;
+    this.native.audioSetVolume(volume);
+  }
+
+  /**
+   * Silence every playing effect
+   */
+  stopAll(): void {
+    if (!this.native || !this.isRunning) return;
+    this.native.audioStopAll();
+  }
+
+  /**
+   * Get mixer counters
+   */
+  getStats(): AudioMixerStats | null {
+    if (!this.native) return null;
+    return this.native.audioGetStats();
+  }
+
+  /**
+   * Check if the mixer thread is running
+   */
+  get running(): boolean {
+    return this.isRunning;
+  }
+}
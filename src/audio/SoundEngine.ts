@@ -1,9 +1,14 @@
 // 8-bit procedural sound engine for CS-CLI
 // Generates retro-style sound effects without external samples
+//
+// With the native mixer (codec2 addon) every effect is synthesized once into
+// a wavetable and plays on the mixer thread's voice pool; otherwise each
+// play synthesizes its own buffer and opens its own Speaker.
 
 import Speaker from 'speaker';
 import { Readable, Writable } from 'stream';
 import { Vector3 } from '../engine/math/Vector3.js';
+import { NativeMixer, MIXER_SAMPLE_RATE } from './NativeMixer.js';
 import * as fs from 'fs';
 import * as path from 'path';
 import { execSync } from 'child_process';
@@ -43,6 +48,30 @@ export type SoundType =
   | 'round_start'
   | 'round_end';
 
+// Who keeps a voice when the native mixer's pool is full (0-255, higher
+// wins): your own weapon and UI cues, then hits and deaths, footsteps last
+const soundPriority: Record<SoundType, number> = {
+  shoot_pistol: 200,
+  shoot_rifle: 200,
+  shoot_shotgun: 200,
+  shoot_sniper: 200,
+  reload: 140,
+  empty_clip: 140,
+  hit_enemy: 180,
+  hit_headshot: 190,
+  player_hurt: 190,
+  player_death: 210,
+  bot_death: 150,
+  footstep: 40,
+  jump: 60,
+  land: 60,
+  spawn: 120,
+  pickup: 120,
+  menu_select: 255,
+  round_start: 255,
+  round_end: 255,
+};
+
 // Waveform generators
 type WaveformFn = (t: number, freq: number) => number;
 
@@ -225,12 +254,19 @@ class NullWritable extends Writable {
   }
 }
 
+// Native mixer effect id of each sound
+const SOUND_IDS = new Map<SoundType, number>(
+  (Object.keys(soundDefs) as SoundType[]).map((sound, id) => [sound, id])
+);
+
 export class SoundEngine {
   private enabled: boolean = true;
   private volume: number = 0.7;
   private activeSpeakers: Set<Speaker> = new Set();
   private listenerPos: Vector3 = new Vector3(0, 0, 0);
   private listenerYaw: number = 0;
+  private mixer: NativeMixer | null = NativeMixer.isAvailable() ? new NativeMixer() : null;
+  private wavetables: Float32Array[] | null = null;  // Rendered by preload() or the first play
 
   constructor() {
     // Note: Native audio libraries (CoreAudio, ALSA) may print warnings directly to stderr fd.
@@ -279,6 +315,7 @@ export class SoundEngine {
 
   setVolume(volume: number): void {
     this.volume = Math.max(0, Math.min(1, volume));
+    this.mixer?.setVolume(this.volume);
   }
 
   isEnabled(): boolean {
@@ -289,6 +326,61 @@ export class SoundEngine {
   setListenerPosition(pos: Vector3, yaw: number): void {
     this.listenerPos = pos.clone();
     this.listenerYaw = yaw;
+    this.mixer?.setListener(pos, yaw);
+  }
+
+  /**
+   * Render the mixer's wavetables now (call at load time). Otherwise the
+   * first play of a match renders every effect and hitches.
+   */
+  preload(): void {
+    if (this.mixer) this.getWavetables();
+  }
+
+  private getWavetables(): Float32Array[] {
+    if (!this.wavetables) {
+      const tables: Float32Array[] = [];
+      for (const [sound, id] of SOUND_IDS) {
+        tables[id] = this.renderWavetable(soundDefs[sound]);
+      }
+      this.wavetables = tables;
+    }
+    return this.wavetables;
+  }
+
+  // Start the native mixer on first use (false: use per-sound Speakers)
+  private ensureMixer(): boolean {
+    if (!this.mixer) return false;
+    if (this.mixer.running) return true;
+
+    this.mixer.setVolume(this.volume);
+    this.mixer.setListener(this.listenerPos, this.listenerYaw);
+    if (!this.mixer.start(this.getWavetables(), () => { this.mixer = null; })) {
+      this.mixer = null;
+      return false;
+    }
+    return true;
+  }
+
+  // Mono wavetable of a sound at the mixer rate (layers summed), with the
+  // def's volume applied and quantized to 8-bit steps like the Speaker path.
+  // Noise is frozen into the table, so every play of a sound is identical.
+  private renderWavetable(def: SoundDef | SoundDef[]): Float32Array {
+    const defs = Array.isArray(def) ? def : [def];
+    const duration = Math.max(...defs.map(d => d.duration));
+    const table = new Float32Array(Math.max(1, Math.floor(duration * MIXER_SAMPLE_RATE)));
+
+    for (const d of defs) {
+      const numSamples = Math.floor(d.duration * MIXER_SAMPLE_RATE);
+      const volume = d.volume ?? 1;
+      for (let i = 0; i < numSamples; i++) {
+        table[i] += this.synthesize(d, i / MIXER_SAMPLE_RATE) * volume;
+      }
+    }
+    for (let i = 0; i < table.length; i++) {
+      table[i] = Math.round(Math.max(-1, Math.min(1, table[i])) * 127) / 127;
+    }
+    return table;
   }
 
   // Calculate spatial audio parameters
@@ -329,8 +421,6 @@ export class SoundEngine {
   private generateStereoSamples(def: SoundDef, spatialVolume: number, pan: number): Buffer {
     const numSamples = Math.floor(def.duration * SAMPLE_RATE);
     const buffer = Buffer.alloc(numSamples * 2); // 2 bytes per sample (L+R)
-    const waveformFn = waveforms[def.waveform];
-    const noiseFn = waveforms.noise;
     const baseVolume = (def.volume ?? 1) * this.volume * spatialVolume;
 
     // Calculate left/right volumes from pan
@@ -339,27 +429,7 @@ export class SoundEngine {
     const rightVol = baseVolume * Math.sin((pan + 1) * Math.PI / 4);
 
     for (let i = 0; i < numSamples; i++) {
-      const t = i / SAMPLE_RATE;
-
-      let freq: number;
-      if (typeof def.frequency === 'function') {
-        freq = def.frequency(t, def.duration);
-      } else {
-        freq = def.frequency;
-      }
-
-      if (def.vibrato) {
-        freq += Math.sin(2 * Math.PI * def.vibrato.rate * t) * def.vibrato.depth;
-      }
-
-      let sample = waveformFn(t, Math.max(20, freq));
-
-      if (def.noiseMix && def.noiseMix > 0) {
-        sample = sample * (1 - def.noiseMix) + noiseFn(t, freq) * def.noiseMix;
-      }
-
-      const env = this.getEnvelopeValue(t, def.duration, def.envelope);
-      sample *= env;
+      const sample = this.synthesize(def, i / SAMPLE_RATE);
 
       // Convert to 8-bit unsigned for left and right channels
       const leftSample = Math.floor((sample * leftVol + 1) * 0.5 * 255);
@@ -372,6 +442,28 @@ export class SoundEngine {
     return buffer;
   }
 
+  // One sample (-1..1, enveloped) of a sound at time t
+  private synthesize(def: SoundDef, t: number): number {
+    let freq: number;
+    if (typeof def.frequency === 'function') {
+      freq = def.frequency(t, def.duration);
+    } else {
+      freq = def.frequency;
+    }
+
+    if (def.vibrato) {
+      freq += Math.sin(2 * Math.PI * def.vibrato.rate * t) * def.vibrato.depth;
+    }
+
+    let sample = waveforms[def.waveform](t, Math.max(20, freq));
+
+    if (def.noiseMix && def.noiseMix > 0) {
+      sample = sample * (1 - def.noiseMix) + waveforms.noise(t, freq) * def.noiseMix;
+    }
+
+    return sample * this.getEnvelopeValue(t, def.duration, def.envelope);
+  }
+
   private getEnvelopeValue(t: number, duration: number, env: Envelope): number {
     const { attack, decay, sustain, release } = env;
     const releaseStart = duration - release;
@@ -391,6 +483,10 @@ export class SoundEngine {
 
   // Play a sound at the listener position (no spatial effect)
   play(sound: SoundType): void {
+    if (this.enabled && this.ensureMixer()) {
+      this.mixer!.play(SOUND_IDS.get(sound)!, null, 1, soundPriority[sound]);
+      return;
+    }
     this.playAt(sound, this.listenerPos);
   }
 
@@ -402,6 +498,12 @@ export class SoundEngine {
       const def = soundDefs[sound];
       if (!def) return;
 
+      // Attenuation, pan and voice allocation happen on the mixer thread
+      if (this.ensureMixer()) {
+        this.mixer!.play(SOUND_IDS.get(sound)!, position, 1, soundPriority[sound]);
+        return;
+      }
+
       const { volume, pan } = this.calculateSpatial(position);
 
       // Don't play if too quiet
@@ -451,6 +553,7 @@ export class SoundEngine {
   }
 
   stopAll(): void {
+    this.mixer?.stopAll();
     for (const speaker of this.activeSpeakers) {
       try {
         speaker.end();
@@ -461,6 +564,7 @@ export class SoundEngine {
 
   destroy(): void {
     this.stopAll();
+    this.mixer?.stop();
     this.restoreNodeStderr();
   }
 }
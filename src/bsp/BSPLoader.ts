@@ -18,6 +18,8 @@ import { Texture } from '../engine/Texture.js';
 import { TextureManager, getTextureManager } from '../engine/TextureManager.js';
 import { AABB, SpawnPoint } from '../maps/MapFormat.js';
 import { CollisionMesh } from '../physics/MeshCollision.js';
+import { LightmapAtlas, LightmapFace } from './LightmapAtlas.js';
+import { VisibilityBuilder, BSPVisibilityData } from './BSPVisibility.js';
 
 // BSP uses Z-up, engine uses Y-up
 function bspToEngine(x: number, y: number, z: number): Vector3 {
@@ -39,6 +41,7 @@ export interface BSPLoadResult {
   skyColor: Color;
   ambientLight: number;
   textureManager: TextureManager;
+  visibility: BSPVisibilityData;  // Leaf tree, PVS and renderObjects[i].visBatch bounds
 }
 
 export class BSPLoader {
@@ -46,6 +49,9 @@ export class BSPLoader {
   private textureManager: TextureManager;
   private textures: Map<number, Texture> = new Map();
   private materials: Map<number, Material> = new Map();
+  private lightmapFaces: Map<number, LightmapFace> = new Map();
+  private lightmaps: LightmapAtlas | null = null;
+  private visibility: BSPVisibilityData | null = null;
 
   constructor(textureManager?: TextureManager) {
     this.textureManager = textureManager || getTextureManager();
@@ -71,6 +77,9 @@ export class BSPLoader {
     // Load embedded textures from BSP
     this.loadEmbeddedTextures();
 
+    // Pack baked face lightmaps into one atlas
+    this.buildLightmaps();
+
     // Build materials from textures
     this.buildMaterials();
 
@@ -105,6 +114,7 @@ export class BSPLoader {
       skyColor,
       ambientLight: 0.7, // Brighter ambient light for visibility
       textureManager: this.textureManager,
+      visibility: this.visibility!,
     };
   }
 
@@ -187,18 +197,49 @@ export class BSPLoader {
         name: mipTex.name || `texture_${i}`,
         color,
         texture,
+        lightmap: this.lightmaps?.texture,
       });
     }
   }
 
+  // Pack each face's baked lightmap into one atlas (RGB luxels where 255 is full 1x light).
+  // Static lighting is resolved once here instead of per frame.
+  private buildLightmaps(): void {
+    if (!this.bsp) return;
+
+    for (let faceIdx = 0; faceIdx < this.bsp.faces.length; faceIdx++) {
+      const face = this.bsp.faces[faceIdx];
+      const texInfo = this.bsp.texInfo[face.texInfo];
+      const s: number[] = [];
+      const t: number[] = [];
+
+      for (let i = 0; i < face.numEdges; i++) {
+        const edgeIdx = this.bsp.surfEdges[face.firstEdge + i];
+        const vertIdx = edgeIdx >= 0 ? this.bsp.edges[edgeIdx].v[0] : this.bsp.edges[-edgeIdx].v[1];
+        const vert = this.bsp.vertices[vertIdx];
+        s.push(vert.x * texInfo.s[0] + vert.y * texInfo.s[1] + vert.z * texInfo.s[2] + texInfo.s[3]);
+        t.push(vert.x * texInfo.t[0] + vert.y * texInfo.t[1] + vert.z * texInfo.t[2] + texInfo.t[3]);
+      }
+      if (s.length < 3) continue;
+
+      // Special surfaces (sky, water) and unlit faces have no baked light
+      const unlit = (texInfo.flags & 1) !== 0 || face.styles[0] === 255 || face.lightmapOffset < 0;
+      this.lightmapFaces.set(faceIdx, LightmapAtlas.faceExtents(s, t, unlit ? -1 : face.lightmapOffset));
+    }
+
+    this.lightmaps = LightmapAtlas.build(this.lightmapFaces, this.bsp.lighting, 3, 0.5);
+  }
+
   // Build render objects from BSP faces
   private buildRenderObjects(): RenderObject[] {
     if (!this.bsp) return [];
 
     const renderObjects: RenderObject[] = [];
 
-    // Group faces by texture for better batching
-    const facesByTexture: Map<number, number[]> = new Map();
+    // Group faces by BSP region, then texture: each group is a draw batch the
+    // renderer can cull against the PVS of the camera's leaf
+    const vis = new VisibilityBuilder(this.bsp, BSP_SCALE);
+    const facesByBatch: Map<number, Map<number, number[]>> = new Map();
 
     for (let faceIdx = 0; faceIdx < this.bsp.faces.length; faceIdx++) {
       const face = this.bsp.faces[faceIdx];
@@ -222,6 +263,12 @@ export class BSPLoader {
       if (texName.includes('tgt') || texName.includes('target')) continue;
       if (texName.includes('bombsite') || texName.includes('bomb')) continue;
 
+      const region = vis.faceRegion(faceIdx);
+      let facesByTexture = facesByBatch.get(region);
+      if (!facesByTexture) {
+        facesByTexture = new Map();
+        facesByBatch.set(region, facesByTexture);
+      }
       if (!facesByTexture.has(texIndex)) {
         facesByTexture.set(texIndex, []);
       }
@@ -229,32 +276,37 @@ export class BSPLoader {
     }
 
     // Create a mesh for each texture group
-    for (const [texIndex, faceIndices] of facesByTexture) {
-      const material = this.materials.get(texIndex) || {
-        name: 'default',
-        color: new Color(128, 128, 128),
-      };
+    for (const facesByTexture of facesByBatch.values()) {
+      for (const [texIndex, faceIndices] of facesByTexture) {
+        const material = this.materials.get(texIndex) || {
+          name: 'default',
+          color: new Color(128, 128, 128),
+        };
 
-      const mipTex = this.bsp!.mipTextures[texIndex];
-      const texWidth = mipTex?.width || 64;
-      const texHeight = mipTex?.height || 64;
+        const mipTex = this.bsp!.mipTextures[texIndex];
+        const texWidth = mipTex?.width || 64;
+        const texHeight = mipTex?.height || 64;
 
-      const mesh = new Mesh(material);
+        const mesh = new Mesh(material);
 
-      for (const faceIdx of faceIndices) {
-        this.addFaceToMesh(mesh, faceIdx, texWidth, texHeight);
-      }
+        for (const faceIdx of faceIndices) {
+          this.addFaceToMesh(mesh, faceIdx, texWidth, texHeight);
+        }
 
-      if (mesh.vertices.length > 0) {
-        const transform = new Transform(Vector3.zero());
-        renderObjects.push({
-          mesh,
-          transform,
-          visible: true,
-        });
+        if (mesh.vertices.length > 0) {
+          const transform = new Transform(Vector3.zero());
+          renderObjects.push({
+            mesh,
+            transform,
+            visible: true,
+            visBatch: vis.addBatch(faceIndices, mesh),
+          });
+        }
       }
     }
 
+    this.visibility = vis.build();
+
     return renderObjects;
   }
 
@@ -319,8 +371,12 @@ export class BSPLoader {
 
     // Add vertices to mesh
     const baseIndex = mesh.vertices.length;
+    const lightmapFace = this.lightmapFaces.get(faceIdx);
     for (let i = 0; i < vertices.length; i++) {
-      mesh.addVertex(vertices[i], faceNormal.clone(), uvs[i]);
+      const lightmapUv = this.lightmaps && lightmapFace
+        ? this.lightmaps.uv(faceIdx, lightmapFace, uvs[i][0] * texWidth, uvs[i][1] * texHeight)
+        : undefined;
+      mesh.addVertex(vertices[i], faceNormal.clone(), uvs[i], undefined, lightmapUv);
     }
 
     // Triangulate using fan method (BSP faces are convex)
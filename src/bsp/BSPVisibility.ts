@@ -0,0 +1,300 @@
+// BSPVisibility - Leaf tree, PVS and draw batches for visibility culling
+//
+// GoldSrc (v30) and Quake (v29) maps share the node/leaf/marksurface/visibility
+// layout, so both loaders build their batches through VisibilityBuilder. The
+// result goes to the native renderer (setVisibility / cullVisible); when the
+// addon is missing, cullVisibleJS runs the same test in JS.
+
+import { Mesh } from '../engine/Mesh.js';
+import { NativeVisibilityData } from '../engine/NativeRenderer.js';
+
+export type BSPVisibilityData = NativeVisibilityData;
+
+// Node contents of the shared solid leaf
+const CONTENTS_SOLID = -2;
+
+// Leaves are merged into regions (whole BSP subtrees) of up to this many face
+// references, so batches stay large enough to keep per-draw overhead down
+const REGION_MAX_FACES = 64;
+
+// The parts of a parsed v29/v30 BSP the visibility data is built from
+export interface BSPVisSource {
+  planes: { normal: { x: number; y: number; z: number }; dist: number }[];
+  nodes: { planeNum: number; children: [number, number] }[];
+  leaves: { contents: number; visOffset: number; firstMarkSurface: number; numMarkSurfaces: number }[];
+  markSurfaces: number[];
+  faces: unknown[];
+  models: { visLeafs: number }[];
+  visibility: Uint8Array | null;
+}
+
+// Decompress one PVS row (zero bytes are followed by a run length)
+function decompressRow(vis: Uint8Array | null, offset: number, out: Uint8Array, outOffset: number, rowBytes: number): void {
+  if (!vis || offset < 0 || offset >= vis.length) {
+    // No vis data for this leaf - everything is potentially visible
+    out.fill(0xff, outOffset, outOffset + rowBytes);
+    return;
+  }
+
+  let o = 0;
+  let i = offset;
+  while (o < rowBytes && i < vis.length) {
+    const b = vis[i++];
+    if (b !== 0) {
+      out[outOffset + o++] = b;
+      continue;
+    }
+    const run = i < vis.length ? vis[i++] : 0;
+    o += run;  // out is zero-filled
+  }
+}
+
+export class VisibilityBuilder {
+  private bsp: BSPVisSource;
+  private scale: number;
+  private visLeafs: number;
+
+  // Face -> leaves containing it (CSR)
+  private faceLeafOffsets: Int32Array;
+  private faceLeaves: Int32Array;
+  private leafRegion: Int32Array;
+
+  private bounds: number[] = [];
+  private offsets: number[] = [0];
+  private clusters: number[] = [];
+
+  constructor(bsp: BSPVisSource, scale: number) {
+    this.bsp = bsp;
+    this.scale = scale;
+    this.visLeafs = Math.min(bsp.models[0]?.visLeafs ?? 0, Math.max(0, bsp.leaves.length - 1));
+
+    const faceCount = bsp.faces.length;
+    const counts = new Int32Array(faceCount + 1);
+    this.forEachLeafFace((_, face) => { counts[face + 1]++; });
+    for (let f = 0; f < faceCount; f++) counts[f + 1] += counts[f];
+    this.faceLeafOffsets = counts.slice();
+    this.faceLeaves = new Int32Array(counts[faceCount]);
+    const fill = counts.slice(0, faceCount);
+    this.forEachLeafFace((leaf, face) => { this.faceLeaves[fill[face]++] = leaf; });
+
+    this.leafRegion = new Int32Array(bsp.leaves.length).fill(-1);
+    this.buildRegions();
+  }
+
+  // Split the world tree into subtrees of at most REGION_MAX_FACES face references
+  private buildRegions(): void {
+    const { nodes, leaves } = this.bsp;
+    if (nodes.length === 0) return;
+
+    const leafFaces = (leaf: number): number =>
+      leaf >= 1 && leaf <= this.visLeafs ? leaves[leaf].numMarkSurfaces : 0;
+    const subtreeFaces = new Int32Array(nodes.length);
+    const countFaces = (node: number, depth: number): number => {
+      if (depth > nodes.length) return 0;  // Malformed tree (cycle)
+      let total = 0;
+      for (const child of nodes[node].children) {
+        total += child < 0 ? leafFaces(~child) : child < nodes.length ? countFaces(child, depth + 1) : 0;
+      }
+      return (subtreeFaces[node] = total);
+    };
+    countFaces(0, 0);
+
+    let region = 0;
+    const assign = (node: number, id: number, depth: number): void => {
+      if (depth > nodes.length) return;
+      for (const child of nodes[node].children) {
+        if (child < 0) {
+          const leaf = ~child;
+          if (leaf < leaves.length && this.leafRegion[leaf] < 0) {
+            this.leafRegion[leaf] = id >= 0 ? id : region++;
+          }
+        } else if (child < nodes.length) {
+          const small = id >= 0 || subtreeFaces[child] <= REGION_MAX_FACES;
+          assign(child, id >= 0 ? id : small ? region++ : -1, depth + 1);
+        }
+      }
+    };
+    assign(0, subtreeFaces[0] <= REGION_MAX_FACES ? region++ : -1, 0);
+  }
+
+  private forEachLeafFace(fn: (leaf: number, face: number) => void): void {
+    const { leaves, markSurfaces, faces } = this.bsp;
+    for (let leaf = 1; leaf <= this.visLeafs; leaf++) {
+      const l = leaves[leaf];
+      for (let i = 0; i < l.numMarkSurfaces; i++) {
+        const face = markSurfaces[l.firstMarkSurface + i];
+        if (face >= 0 && face < faces.length) fn(leaf, face);
+      }
+    }
+  }
+
+  // Vis cluster of a leaf (leaf 0 is the shared solid leaf)
+  private leafCluster(leaf: number): number {
+    if (leaf < 1 || leaf > this.visLeafs) return -1;
+    return this.bsp.leaves[leaf].contents === CONTENTS_SOLID ? -1 : leaf - 1;
+  }
+
+  /**
+   * Region a face is drawn with: that of the first leaf referencing it
+   * (-1 for faces outside the world tree, e.g. brush entities)
+   */
+  faceRegion(face: number): number {
+    const start = this.faceLeafOffsets[face];
+    return start < this.faceLeafOffsets[face + 1] ? this.leafRegion[this.faceLeaves[start]] : -1;
+  }
+
+  /**
+   * Register a draw batch built from faces; returns its batch index
+   *
+   * The batch is potentially visible from every cluster any of its faces lies in.
+   */
+  addBatch(faceIndices: number[], mesh: Mesh): number {
+    const clusters = new Set<number>();
+    for (const face of faceIndices) {
+      for (let i = this.faceLeafOffsets[face]; i < this.faceLeafOffsets[face + 1]; i++) {
+        const cluster = this.leafCluster(this.faceLeaves[i]);
+        if (cluster >= 0) clusters.add(cluster);
+      }
+    }
+    // A batch with a face outside every leaf can't be PVS-culled
+    if (faceIndices.some(face => this.faceRegion(face) < 0)) clusters.clear();
+    for (const c of [...clusters].sort((a, b) => a - b)) this.clusters.push(c);
+    this.offsets.push(this.clusters.length);
+
+    let minX = Infinity, minY = Infinity, minZ = Infinity;
+    let maxX = -Infinity, maxY = -Infinity, maxZ = -Infinity;
+    for (const v of mesh.vertices) {
+      const p = v.position;
+      if (p.x < minX) minX = p.x;
+      if (p.y < minY) minY = p.y;
+      if (p.z < minZ) minZ = p.z;
+      if (p.x > maxX) maxX = p.x;
+      if (p.y > maxY) maxY = p.y;
+      if (p.z > maxZ) maxZ = p.z;
+    }
+    this.bounds.push(minX, minY, minZ, maxX, maxY, maxZ);
+
+    return this.offsets.length - 2;
+  }
+
+  // Finish: convert the tree to engine space and decompress the PVS
+  build(): BSPVisibilityData {
+    const { nodes, planes, leaves, visibility } = this.bsp;
+    const s = this.scale;
+
+    // BSP Z-up (x, y, z) maps to engine (x, z, -y); n.p >= dist keeps its sense
+    const nodePlanes = new Float32Array(nodes.length * 4);
+    const children = new Int32Array(nodes.length * 2);
+    for (let i = 0; i < nodes.length; i++) {
+      const plane = planes[nodes[i].planeNum];
+      nodePlanes[i * 4] = plane.normal.x;
+      nodePlanes[i * 4 + 1] = plane.normal.z;
+      nodePlanes[i * 4 + 2] = -plane.normal.y;
+      nodePlanes[i * 4 + 3] = plane.dist * s;
+      // Same encoding as the file: negative children are ~leaf
+      children[i * 2] = nodes[i].children[0];
+      children[i * 2 + 1] = nodes[i].children[1];
+    }
+
+    const leafClusters = new Int32Array(leaves.length);
+    for (let i = 0; i < leaves.length; i++) leafClusters[i] = this.leafCluster(i);
+
+    const rowBytes = visibility ? (this.visLeafs + 7) >> 3 : 0;
+    const pvs = new Uint8Array(rowBytes * this.visLeafs);
+    if (rowBytes > 0) {
+      for (let c = 0; c < this.visLeafs; c++) {
+        decompressRow(visibility, leaves[c + 1].visOffset, pvs, c * rowBytes, rowBytes);
+      }
+    }
+
+    return {
+      planes: nodePlanes,
+      children,
+      leafClusters,
+      pvs,
+      rowBytes,
+      batchBounds: new Float32Array(this.bounds),
+      batchOffsets: new Int32Array(this.offsets),
+      batchClusters: new Int32Array(this.clusters),
+    };
+  }
+}
+
+// Leaf containing a point (-1 for an empty or malformed tree)
+function findLeaf(vis: BSPVisibilityData, x: number, y: number, z: number): number {
+  const nodeCount = vis.planes.length >> 2;
+  if (nodeCount === 0) return vis.leafClusters.length > 0 ? 0 : -1;
+  let node = 0;
+  for (let steps = 0; steps <= nodeCount; steps++) {
+    const p = node * 4;
+    const d = vis.planes[p] * x + vis.planes[p + 1] * y + vis.planes[p + 2] * z - vis.planes[p + 3];
+    const child = vis.children[node * 2 + (d >= 0 ? 0 : 1)];
+    if (child < 0) {
+      const leaf = ~child;
+      return leaf < vis.leafClusters.length ? leaf : -1;
+    }
+    if (child >= nodeCount) return -1;
+    node = child;
+  }
+  return -1;
+}
+
+const frustumScratch = new Float32Array(5 * 4);
+
+/**
+ * JS version of the native cullVisible (same PVS and frustum tests)
+ *
+ * @param viewProjection Column-major 4x4
+ * @returns Number of batch indices written to out (ascending)
+ */
+export function cullVisibleJS(
+  vis: BSPVisibilityData,
+  x: number, y: number, z: number,
+  viewProjection: Float32Array,
+  out: Int32Array
+): number {
+  const m = viewProjection;
+  const planes = frustumScratch;
+  // w +/- x, w +/- y, w - z
+  for (let i = 0; i < 4; i++) {
+    const row = i >> 1;
+    const sign = (i & 1) ? -1 : 1;
+    for (let c = 0; c < 4; c++) planes[i * 4 + c] = m[c * 4 + 3] + sign * m[c * 4 + row];
+  }
+  for (let c = 0; c < 4; c++) planes[16 + c] = m[c * 4 + 3] - m[c * 4 + 2];
+
+  const leaf = findLeaf(vis, x, y, z);
+  const cluster = leaf >= 0 ? vis.leafClusters[leaf] : -1;
+  const clusterCount = vis.rowBytes > 0 ? Math.floor(vis.pvs.length / vis.rowBytes) : 0;
+  const rowStart = cluster >= 0 && cluster < clusterCount ? cluster * vis.rowBytes : -1;
+
+  const batchCount = vis.batchOffsets.length - 1;
+  const b6 = vis.batchBounds;
+  let count = 0;
+  for (let b = 0; b < batchCount && count < out.length; b++) {
+    if (rowStart >= 0) {
+      const first = vis.batchOffsets[b];
+      const last = vis.batchOffsets[b + 1];
+      let potentiallyVisible = first === last;
+      for (let i = first; i < last && !potentiallyVisible; i++) {
+        const c = vis.batchClusters[i];
+        potentiallyVisible = c === cluster ||
+          (c >= 0 && c < clusterCount && (vis.pvs[rowStart + (c >> 3)] & (1 << (c & 7))) !== 0);
+      }
+      if (!potentiallyVisible) continue;
+    }
+
+    let outside = false;
+    for (let i = 0; i < 5 && !outside; i++) {
+      const p = i * 4;
+      const px = planes[p] >= 0 ? b6[b * 6 + 3] : b6[b * 6];
+      const py = planes[p + 1] >= 0 ? b6[b * 6 + 4] : b6[b * 6 + 1];
+      const pz = planes[p + 2] >= 0 ? b6[b * 6 + 5] : b6[b * 6 + 2];
+      outside = planes[p] * px + planes[p + 1] * py + planes[p + 2] * pz + planes[p + 3] < 0;
+    }
+    if (outside) continue;
+
+    out[count++] = b;
+  }
+  return count;
+}
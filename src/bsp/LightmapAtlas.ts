@@ -0,0 +1,160 @@
+// LightmapAtlas - Pack baked BSP face lightmaps into one texture
+// Used by the Quake and GoldSrc loaders so the native renderer can light map
+// geometry per pixel instead of recomputing per-face lighting every frame.
+
+import { Texture } from '../engine/Texture.js';
+
+// One lightmap luxel covers 16x16 texels (Quake / GoldSrc)
+const LUXEL_SIZE = 16;
+
+// Atlas values are stored so 128 = 1x light (the native side applies 2x overbright)
+const NEUTRAL_LIGHT = 128;
+
+// Largest atlas side the native texture pool accepts
+const MAX_ATLAS_SIZE = 4096;
+
+// Lightmap rectangle of one face, in luxels
+export interface LightmapFace {
+  minS: number;     // floor(min s / 16): luxel (0, 0) sits at texel s = minS * 16
+  minT: number;
+  width: number;
+  height: number;
+  offset: number;   // Byte offset into the lighting lump (-1 = no baked light)
+}
+
+// Where a face's luxel (0, 0) landed in the atlas
+interface Placement {
+  x: number;
+  y: number;
+}
+
+export class LightmapAtlas {
+  public readonly texture: Texture;
+  private placements: Map<number, Placement>;
+
+  private constructor(texture: Texture, placements: Map<number, Placement>) {
+    this.texture = texture;
+    this.placements = placements;
+  }
+
+  /**
+   * Compute a face's lightmap rectangle from its vertices' texture-space
+   * s/t coordinates (in texels), matching the engine's CalcSurfaceExtents.
+   */
+  static faceExtents(s: number[], t: number[], offset: number): LightmapFace {
+    const minS = Math.floor(Math.min(...s) / LUXEL_SIZE);
+    const maxS = Math.ceil(Math.max(...s) / LUXEL_SIZE);
+    const minT = Math.floor(Math.min(...t) / LUXEL_SIZE);
+    const maxT = Math.ceil(Math.max(...t) / LUXEL_SIZE);
+    return { minS, minT, width: maxS - minS + 1, height: maxT - minT + 1, offset };
+  }
+
+  /**
+   * Pack face lightmaps into a power-of-two atlas.
+   * Each block gets a 1-luxel border copied from its edge so bilinear
+   * filtering never bleeds between faces. Faces without baked light share
+   * one neutral (1x) block.
+   *
+   * @param faces Lightmap rectangle per face index
+   * @param lighting Lighting lump
+   * @param bytesPerLuxel 1 for Quake (mono), 3 for GoldSrc (RGB)
+   * @param scale Multiplier taking lump values to atlas values (128 = 1x)
+   * @returns The atlas, or null if there is no lighting or it does not fit
+   */
+  static build(
+    faces: Map<number, LightmapFace>,
+    lighting: Uint8Array | null,
+    bytesPerLuxel: 1 | 3,
+    scale: number
+  ): LightmapAtlas | null {
+    if (!lighting || faces.size === 0) return null;
+
+    // Faces whose data runs past the lump fall back to the neutral block
+    const lit: [number, LightmapFace][] = [];
+    for (const [faceIdx, face] of faces) {
+      const end = face.offset + face.width * face.height * bytesPerLuxel;
+      if (face.offset >= 0 && end <= lighting.length && face.width <= MAX_ATLAS_SIZE - 2) {
+        lit.push([faceIdx, face]);
+      }
+    }
+    lit.sort((a, b) => b[1].height - a[1].height);
+
+    let area = 9; // Neutral block
+    for (const [, face] of lit) area += (face.width + 2) * (face.height + 2);
+
+    // Shelf pack, widening the atlas until the height fits
+    let width = 64;
+    while (width * width < area) width *= 2;
+
+    for (; width <= MAX_ATLAS_SIZE; width *= 2) {
+      const placements = new Map<number, Placement>();
+      let x = 3, y = 0, shelf = 3;  // Neutral block occupies (0, 0)-(2, 2)
+      let fits = true;
+      for (const [faceIdx, face] of lit) {
+        const w = face.width + 2, h = face.height + 2;
+        if (w > width) {
+          fits = false;
+          break;
+        }
+        if (x + w > width) {
+          x = 0;
+          y += shelf;
+          shelf = 0;
+        }
+        placements.set(faceIdx, { x: x + 1, y: y + 1 });
+        x += w;
+        shelf = Math.max(shelf, h);
+      }
+
+      let height = 1;
+      while (height < y + shelf) height *= 2;
+      if (!fits || height > MAX_ATLAS_SIZE) continue;
+
+      const data = new Uint8Array(width * height * 3).fill(NEUTRAL_LIGHT);
+      for (const [faceIdx, face] of lit) {
+        LightmapAtlas.blit(data, width, placements.get(faceIdx)!, face, lighting, bytesPerLuxel, scale);
+      }
+      return new LightmapAtlas(Texture.fromRGB('lightmap', width, height, data), placements);
+    }
+    return null;
+  }
+
+  // Copy one face's luxels (plus the replicated border) into the atlas
+  private static blit(
+    data: Uint8Array,
+    atlasWidth: number,
+    at: Placement,
+    face: LightmapFace,
+    lighting: Uint8Array,
+    bytesPerLuxel: 1 | 3,
+    scale: number
+  ): void {
+    for (let y = -1; y <= face.height; y++) {
+      const sy = Math.min(Math.max(y, 0), face.height - 1);
+      for (let x = -1; x <= face.width; x++) {
+        const sx = Math.min(Math.max(x, 0), face.width - 1);
+        const src = face.offset + (sy * face.width + sx) * bytesPerLuxel;
+        const dst = ((at.y + y) * atlasWidth + at.x + x) * 3;
+        for (let c = 0; c < 3; c++) {
+          const value = lighting[src + (bytesPerLuxel === 3 ? c : 0)];
+          data[dst + c] = Math.min(255, Math.round(value * scale));
+        }
+      }
+    }
+  }
+
+  /**
+   * Atlas UV of a point on a face, from its texture-space s/t (in texels).
+   * Faces without baked light map to the neutral block.
+   */
+  uv(faceIdx: number, face: LightmapFace, s: number, t: number): [number, number] {
+    const at = this.placements.get(faceIdx);
+    if (!at) {
+      return [1.5 / this.texture.width, 1.5 / this.texture.height];
+    }
+    // Luxel i's center is at texel s = (minS + i) * 16; atlas texel centers are at +0.5
+    const u = at.x + 0.5 + s / LUXEL_SIZE - face.minS;
+    const v = at.y + 0.5 + t / LUXEL_SIZE - face.minT;
+    return [u / this.texture.width, v / this.texture.height];
+  }
+}
@@ -18,6 +18,8 @@ import { Texture } from '../engine/Texture.js';
 import { TextureManager, getTextureManager } from '../engine/TextureManager.js';
 import { AABB, SpawnPoint } from '../maps/MapFormat.js';
 import { CollisionMesh } from '../physics/MeshCollision.js';
+import { LightmapAtlas, LightmapFace } from './LightmapAtlas.js';
+import { VisibilityBuilder, BSPVisibilityData } from './BSPVisibility.js';
 
 // Quake uses Z-up, engine uses Y-up
 function quakeToEngine(x: number, y: number, z: number): Vector3 {
@@ -37,6 +39,7 @@ export interface QuakeBSPLoadResult {
   skyColor: Color;
   ambientLight: number;
   textureManager: TextureManager;
+  visibility: BSPVisibilityData;  // Leaf tree, PVS and renderObjects[i].visBatch bounds
 }
 
 export class QuakeBSPLoader {
@@ -44,6 +47,9 @@ export class QuakeBSPLoader {
   private textureManager: TextureManager;
   private textures: Map<number, Texture> = new Map();
   private materials: Map<number, Material> = new Map();
+  private lightmapFaces: Map<number, LightmapFace> = new Map();
+  private lightmaps: LightmapAtlas | null = null;
+  private visibility: BSPVisibilityData | null = null;
 
   constructor(textureManager?: TextureManager) {
     this.textureManager = textureManager || getTextureManager();
@@ -68,6 +74,9 @@ export class QuakeBSPLoader {
     // Load textures from BSP (Quake embeds textures in BSP)
     this.loadEmbeddedTextures();
 
+    // Pack baked face lightmaps into one atlas
+    this.buildLightmaps();
+
     // Build materials from textures
     this.buildMaterials();
 
@@ -99,6 +108,7 @@ export class QuakeBSPLoader {
       skyColor: new Color(80, 80, 120), // Blue-gray for Quake
       ambientLight: 0.7, // Brighter ambient light for visibility
       textureManager: this.textureManager,
+      visibility: this.visibility!,
     };
   }
 
@@ -173,17 +183,47 @@ export class QuakeBSPLoader {
         name: mipTex.name || `texture_${i}`,
         color,
         texture,
+        lightmap: this.lightmaps?.texture,
       });
     }
   }
 
+  // Pack each face's baked lightmap into one atlas (mono luxels, already 128 = 1x).
+  // Static lighting is resolved once here instead of per frame.
+  private buildLightmaps(): void {
+    if (!this.bsp) return;
+
+    for (let faceIdx = 0; faceIdx < this.bsp.faces.length; faceIdx++) {
+      const face = this.bsp.faces[faceIdx];
+      const texInfo = this.bsp.texInfo[face.texInfo];
+      const s: number[] = [];
+      const t: number[] = [];
+
+      for (let i = 0; i < face.numEdges; i++) {
+        const edgeIdx = this.bsp.surfEdges[face.firstEdge + i];
+        const vertIdx = edgeIdx >= 0 ? this.bsp.edges[edgeIdx].v[0] : this.bsp.edges[-edgeIdx].v[1];
+        const vert = this.bsp.vertices[vertIdx];
+        s.push(vert.x * texInfo.s[0] + vert.y * texInfo.s[1] + vert.z * texInfo.s[2] + texInfo.s[3]);
+        t.push(vert.x * texInfo.t[0] + vert.y * texInfo.t[1] + vert.z * texInfo.t[2] + texInfo.t[3]);
+      }
+      if (s.length < 3) continue;
+
+      // Special surfaces (sky, water) and unlit faces have no baked light
+      const unlit = (texInfo.flags & 1) !== 0 || face.styles[0] === 255 || face.lightmapOffset < 0;
+      this.lightmapFaces.set(faceIdx, LightmapAtlas.faceExtents(s, t, unlit ? -1 : face.lightmapOffset));
+    }
+
+    this.lightmaps = LightmapAtlas.build(this.lightmapFaces, this.bsp.lighting, 1, 1);
+  }
+
   private buildRenderObjects(): RenderObject[] {
     if (!this.bsp) return [];
 
     const renderObjects: RenderObject[] = [];
 
-    // Group faces by texture
-    const facesByTexture: Map<number, number[]> = new Map();
+    // Group faces by BSP region, then texture (one PVS-culled draw batch each)
+    const vis = new VisibilityBuilder(this.bsp, QUAKE_SCALE);
+    const facesByBatch: Map<number, Map<number, number[]>> = new Map();
 
     for (let faceIdx = 0; faceIdx < this.bsp.faces.length; faceIdx++) {
       const face = this.bsp.faces[faceIdx];
@@ -202,6 +242,12 @@ export class QuakeBSPLoader {
       if (texName.startsWith('skip')) continue;
       if (texName.startsWith('hint')) continue;
 
+      const region = vis.faceRegion(faceIdx);
+      let facesByTexture = facesByBatch.get(region);
+      if (!facesByTexture) {
+        facesByTexture = new Map();
+        facesByBatch.set(region, facesByTexture);
+      }
       if (!facesByTexture.has(texIndex)) {
         facesByTexture.set(texIndex, []);
       }
@@ -209,32 +255,37 @@ export class QuakeBSPLoader {
     }
 
     // Create mesh for each texture group
-    for (const [texIndex, faceIndices] of facesByTexture) {
-      const material = this.materials.get(texIndex) || {
-        name: 'default',
-        color: new Color(85, 75, 65),
-      };
+    for (const facesByTexture of facesByBatch.values()) {
+      for (const [texIndex, faceIndices] of facesByTexture) {
+        const material = this.materials.get(texIndex) || {
+          name: 'default',
+          color: new Color(85, 75, 65),
+        };
 
-      const mipTex = this.bsp!.mipTextures[texIndex];
-      const texWidth = mipTex?.width || 64;
-      const texHeight = mipTex?.height || 64;
+        const mipTex = this.bsp!.mipTextures[texIndex];
+        const texWidth = mipTex?.width || 64;
+        const texHeight = mipTex?.height || 64;
 
-      const mesh = new Mesh(material);
+        const mesh = new Mesh(material);
 
-      for (const faceIdx of faceIndices) {
-        this.addFaceToMesh(mesh, faceIdx, texWidth, texHeight);
-      }
+        for (const faceIdx of faceIndices) {
+          this.addFaceToMesh(mesh, faceIdx, texWidth, texHeight);
+        }
 
-      if (mesh.vertices.length > 0) {
-        const transform = new Transform(Vector3.zero());
-        renderObjects.push({
-          mesh,
-          transform,
-          visible: true,
-        });
+        if (mesh.vertices.length > 0) {
+          const transform = new Transform(Vector3.zero());
+          renderObjects.push({
+            mesh,
+            transform,
+            visible: true,
+            visBatch: vis.addBatch(faceIndices, mesh),
+          });
+        }
       }
     }
 
+    this.visibility = vis.build();
+
     return renderObjects;
   }
 
@@ -292,8 +343,12 @@ export class QuakeBSPLoader {
 
     // Add vertices to mesh
     const baseIndex = mesh.vertices.length;
+    const lightmapFace = this.lightmapFaces.get(faceIdx);
     for (let i = 0; i < vertices.length; i++) {
-      mesh.addVertex(vertices[i], faceNormal.clone(), uvs[i]);
+      const lightmapUv = this.lightmaps && lightmapFace
+        ? this.lightmaps.uv(faceIdx, lightmapFace, uvs[i][0] * texWidth, uvs[i][1] * texHeight)
+        : undefined;
+      mesh.addVertex(vertices[i], faceNormal.clone(), uvs[i], undefined, lightmapUv);
     }
 
     // Triangulate with fan method
@@ -0,0 +1,114 @@
+// CameraPath - Recorded camera flights for reproducible benchmarks
+//
+// The `campath` console command samples the camera once per rendered frame
+// and saves the flight as JSON; the renderer benchmark replays it at a fixed
+// frame count by interpolating between samples on the recorded timeline.
+
+import { readFileSync, writeFileSync, mkdirSync, existsSync } from 'fs';
+import { join, dirname } from 'path';
+import { homedir } from 'os';
+import { Camera } from './Camera.js';
+
+// Default directory for recorded paths, one <mapId>.json per map
+export const CAMERA_PATH_DIR = join(homedir(), '.csterm', 'campaths');
+
+const CAMERA_PATH_VERSION = 1;
+
+export interface CameraPathSample {
+  t: number;  // ms since recording started
+  x: number;
+  y: number;
+  z: number;
+  yaw: number;    // radians
+  pitch: number;  // radians
+}
+
+export interface CameraPath {
+  version: number;
+  map: string;
+  fov: number;  // radians
+  samples: CameraPathSample[];
+}
+
+export class CameraPathRecorder {
+  private samples: CameraPathSample[] = [];
+  private startTime: number = 0;
+  private fov: number = Math.PI / 2;
+
+  constructor(private map: string) {}
+
+  get sampleCount(): number {
+    return this.samples.length;
+  }
+
+  // Record the camera's current pose (call once per rendered frame)
+  sample(camera: Camera, now: number = performance.now()): void {
+    if (this.samples.length === 0) this.startTime = now;
+    const p = camera.position;
+    this.samples.push({ t: now - this.startTime, x: p.x, y: p.y, z: p.z, yaw: camera.yaw, pitch: camera.pitch });
+    this.fov = camera.fov;
+  }
+
+  finish(): CameraPath {
+    return { version: CAMERA_PATH_VERSION, map: this.map, fov: this.fov, samples: this.samples };
+  }
+}
+
+export function saveCameraPath(path: CameraPath, file: string = join(CAMERA_PATH_DIR, `${path.map}.json`)): string {
+  mkdirSync(dirname(file), { recursive: true });
+  writeFileSync(file, JSON.stringify(path));
+  return file;
+}
+
+// Load a recorded path (null if missing, unreadable or of another version)
+export function loadCameraPath(file: string): CameraPath | null {
+  if (!existsSync(file)) return null;
+  try {
+    const path = JSON.parse(readFileSync(file, 'utf8')) as CameraPath;
+    if (path.version !== CAMERA_PATH_VERSION || !Array.isArray(path.samples) || path.samples.length === 0) return null;
+    return path;
+  } catch {
+    return null;
+  }
+}
+
+// Wrap an angle difference to [-PI, PI] so yaw interpolates the short way round
+function wrapAngle(a: number): number {
+  return a - Math.round(a / (Math.PI * 2)) * Math.PI * 2;
+}
+
+/**
+ * Pose at fraction u (0..1) of the path's recorded duration, interpolated
+ * between neighbouring samples.
+ */
+export function sampleCameraPath(path: CameraPath, u: number): CameraPathSample {
+  const samples = path.samples;
+  const last = samples[samples.length - 1];
+  const t = Math.max(0, Math.min(1, u)) * last.t;
+
+  // Binary search for the last sample at or before t
+  let lo = 0;
+  let hi = samples.length - 1;
+  while (lo < hi) {
+    const mid = (lo + hi + 1) >> 1;
+    if (samples[mid].t <= t) lo = mid;
+    else hi = mid - 1;
+  }
+  const a = samples[lo];
+  const b = samples[Math.min(lo + 1, samples.length - 1)];
+  const k = b.t > a.t ? (t - a.t) / (b.t - a.t) : 0;
+  return {
+    t,
+    x: a.x + (b.x - a.x) * k,
+    y: a.y + (b.y - a.y) * k,
+    z: a.z + (b.z - a.z) * k,
+    yaw: a.yaw + wrapAngle(b.yaw - a.yaw) * k,
+    pitch: a.pitch + (b.pitch - a.pitch) * k,
+  };
+}
+
+export function applyCameraPathSample(camera: Camera, sample: CameraPathSample): void {
+  camera.setPosition(sample.x, sample.y, sample.z);
+  camera.setYaw(sample.yaw);
+  camera.setPitch(sample.pitch);
+}
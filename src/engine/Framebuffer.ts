@@ -23,6 +23,19 @@ export class Framebuffer {
   private frameHash: number = 0;
   private lastSixelOutput: string = '';
 
+  // Packed cell arrays for the native terminal encoder (reused across frames)
+  private packedBg: Uint8Array = new Uint8Array(0);
+  private packedFg: Uint8Array = new Uint8Array(0);
+  private packedGlyphs: Uint32Array = new Uint32Array(0);
+
+  // Touch tracking: cells written since the last clearTouched(), so only the
+  // overlay (HUD/UI) has to be handed to the native compositor each frame
+  private trackTouched: boolean = false;
+  private touchedFlags: Uint8Array = new Uint8Array(0);
+  private touchedIndices: Uint32Array = new Uint32Array(0);
+  private touchedCount: number = 0;
+  private packedTouched: Uint32Array = new Uint32Array(0);
+
   constructor(width: number, height: number) {
     this.width = width;
     this.height = height;
@@ -49,6 +62,61 @@ export class Framebuffer {
         bg: clearBg.clone()
       };
     }
+
+    if (this.trackTouched) {
+      if (this.touchedFlags.length !== this.pixels.length) {
+        this.touchedFlags = new Uint8Array(this.pixels.length);
+        this.touchedIndices = new Uint32Array(this.pixels.length);
+      } else {
+        this.touchedFlags.fill(0);
+      }
+      this.touchedCount = 0;
+    }
+  }
+
+  // Enable/disable touch tracking (clears the buffer so tracking starts clean)
+  setTouchTracking(enabled: boolean): void {
+    if (enabled === this.trackTouched) return;
+    this.trackTouched = enabled;
+    this.clear();
+  }
+
+  isTouched(x: number, y: number): boolean {
+    if (x < 0 || x >= this.width || y < 0 || y >= this.height) {
+      return false;
+    }
+    return !this.trackTouched || this.touchedFlags[y * this.width + x] === 1;
+  }
+
+  private markTouched(index: number): void {
+    if (this.touchedFlags[index] === 0) {
+      this.touchedFlags[index] = 1;
+      this.touchedIndices[this.touchedCount++] = index;
+    }
+  }
+
+  // Reset only the cells touched since the last call (cheap per-frame clear
+  // when the rest of the frame is composed elsewhere)
+  clearTouched(char?: string, fg?: Color, bg?: Color): void {
+    if (!this.trackTouched) {
+      this.clear(char, fg, bg);
+      return;
+    }
+
+    const clearChar = char ?? this.defaultChar;
+    const clearFg = fg ?? this.defaultFg;
+    const clearBg = bg ?? this.defaultBg;
+
+    for (let i = 0; i < this.touchedCount; i++) {
+      const index = this.touchedIndices[i];
+      const pixel = this.pixels[index];
+      // Colors are shared: cells get new Color references, they are never mutated
+      pixel.char = clearChar;
+      pixel.fg = clearFg;
+      pixel.bg = clearBg;
+      this.touchedFlags[index] = 0;
+    }
+    this.touchedCount = 0;
   }
 
   setDefaultColors(char: string, fg: Color, bg: Color): void {
@@ -70,6 +138,7 @@ export class Framebuffer {
     }
 
     const index = y * this.width + x;
+    if (this.trackTouched) this.markTouched(index);
     const pixel = this.pixels[index];
     pixel.char = char;
     pixel.fg = fg;
@@ -82,21 +151,27 @@ export class Framebuffer {
     if (x < 0 || x >= this.width || y < 0 || y >= this.height) {
       return;
     }
-    this.pixels[y * this.width + x].char = char;
+    const index = y * this.width + x;
+    if (this.trackTouched) this.markTouched(index);
+    this.pixels[index].char = char;
   }
 
   setPixelFg(x: number, y: number, fg: Color): void {
     if (x < 0 || x >= this.width || y < 0 || y >= this.height) {
       return;
     }
-    this.pixels[y * this.width + x].fg = fg;
+    const index = y * this.width + x;
+    if (this.trackTouched) this.markTouched(index);
+    this.pixels[index].fg = fg;
   }
 
   setPixelBg(x: number, y: number, bg: Color): void {
     if (x < 0 || x >= this.width || y < 0 || y >= this.height) {
       return;
     }
-    this.pixels[y * this.width + x].bg = bg;
+    const index = y * this.width + x;
+    if (this.trackTouched) this.markTouched(index);
+    this.pixels[index].bg = bg;
   }
 
   // Draw a horizontal line
@@ -251,6 +326,60 @@ export class Framebuffer {
     return CURSOR_HOME + lines.join('\n') + RESET;
   }
 
+  // Pack cells into flat arrays for the native encoders (no per-pixel allocation)
+  // bg/fg are RGB per cell; glyphs holds the code point of text cells, 0 for solid pixels
+  packCells(withGlyphs: boolean = true): { bg: Uint8Array; fg: Uint8Array; glyphs: Uint32Array } {
+    const count = this.width * this.height;
+    if (this.packedBg.length !== count * 3) {
+      this.packedBg = new Uint8Array(count * 3);
+      this.packedFg = new Uint8Array(count * 3);
+      this.packedGlyphs = new Uint32Array(count);
+    }
+
+    const bg = this.packedBg;
+    const fg = this.packedFg;
+    const glyphs = this.packedGlyphs;
+
+    for (let i = 0; i < count; i++) {
+      const pixel = this.pixels[i];
+      const o = i * 3;
+      bg[o] = pixel.bg.r;
+      bg[o + 1] = pixel.bg.g;
+      bg[o + 2] = pixel.bg.b;
+
+      if (withGlyphs) {
+        fg[o] = pixel.fg.r;
+        fg[o + 1] = pixel.fg.g;
+        fg[o + 2] = pixel.fg.b;
+        glyphs[i] = Framebuffer.isSolidPixel(pixel.char) ? 0 : pixel.char.codePointAt(0)!;
+      }
+    }
+
+    return { bg, fg, glyphs };
+  }
+
+  // Pack the touched cells for NativeRenderer.compositeCells():
+  // 4 words per cell (pixel index, code point, fg 0xRRGGBB, bg 0xRRGGBB)
+  packTouchedCells(): { cells: Uint32Array; count: number } {
+    const count = this.touchedCount;
+    if (this.packedTouched.length < count * 4) {
+      this.packedTouched = new Uint32Array(this.pixels.length * 4);
+    }
+
+    const cells = this.packedTouched;
+    for (let i = 0; i < count; i++) {
+      const index = this.touchedIndices[i];
+      const pixel = this.pixels[index];
+      const o = i * 4;
+      cells[o] = index;
+      cells[o + 1] = pixel.char.codePointAt(0) ?? 0x20;
+      cells[o + 2] = pixel.fg.toRGB24();
+      cells[o + 3] = pixel.bg.toRGB24();
+    }
+
+    return { cells, count };
+  }
+
   // Render to Sixel graphics format (true pixel rendering)
   // Sixel is supported by iTerm2, mlterm, xterm (with config), etc.
   // Optimized algorithm: process by row, track colors per column, use RLE
@@ -6,6 +6,7 @@ export interface Vertex {
   position: Vector3;
   normal?: Vector3;
   uv?: [number, number];
+  lightmapUv?: [number, number]; // UV into the material's lightmap atlas
   color?: Color;
 }
 
@@ -20,6 +21,7 @@ export interface Material {
   emissive?: boolean; // If true, not affected by lighting
   texture?: Texture;  // Optional texture
   textureScale?: number; // Scale factor for texture UVs
+  lightmap?: Texture; // Baked light atlas addressed by vertex lightmapUv (native renderer only)
 }
 
 export class Mesh {
@@ -34,9 +36,15 @@ export class Mesh {
     };
   }
 
-  addVertex(position: Vector3, normal?: Vector3, uv?: [number, number], color?: Color): number {
+  addVertex(
+    position: Vector3,
+    normal?: Vector3,
+    uv?: [number, number],
+    color?: Color,
+    lightmapUv?: [number, number]
+  ): number {
     const index = this.vertices.length;
-    this.vertices.push({ position, normal, uv, color });
+    this.vertices.push({ position, normal, uv, color, lightmapUv });
     return index;
   }
 
@@ -120,7 +128,8 @@ export class Mesh {
         position: vertex.position.clone(),
         normal: vertex.normal?.clone(),
         uv: vertex.uv ? [...vertex.uv] : undefined,
-        color: vertex.color?.clone()
+        color: vertex.color?.clone(),
+        lightmapUv: vertex.lightmapUv ? [...vertex.lightmapUv] : undefined
       });
     }
 
@@ -0,0 +1,50 @@
+// NativeJobs - One native worker pool shared by the addons
+//
+// The renderer, bvh and codec2 addons each compile the job system
+// (native/job_system.c), but only one pool should run: the first addon
+// loaded owns it and every later one adopts it before its first job, so
+// raster, collision and voice work share one set of workers instead of each
+// spawning a thread per core. Worker count and pinning come from
+// CSTERM_JOB_THREADS / CSTERM_JOB_PIN (read when the pool starts).
+
+export interface NativeJobStats {
+  workers: number;        // Worker threads (the submitting thread also runs jobs)
+  physicalCores: number;  // Physical cores in the process's CPU set
+  pinned: boolean;        // Workers pinned one per core
+  shared: boolean;        // This addon runs on another addon's pool
+  jobs: number;           // Jobs split across the workers
+  inlineJobs: number;     // Jobs too small to split
+  parks: number;          // Times an idle worker went to sleep
+}
+
+// Exports every addon built with the job system adds
+export interface NativeJobsModule {
+  getJobSystem(): object;
+  setJobSystem(handle: object): boolean;
+  configureJobs(config: { threads?: number; pin?: boolean }): boolean;
+  getJobStats(): NativeJobStats;
+}
+
+let owner: NativeJobsModule | null = null;
+
+/**
+ * Register a freshly loaded addon: the first becomes the pool owner, later
+ * ones adopt its pool. Call before the addon runs any work. Addons built
+ * before the job system existed are ignored.
+ */
+export function shareNativeJobs(module: object | null): void {
+  const jobs = module as NativeJobsModule | null;
+  if (!jobs || typeof jobs.getJobSystem !== 'function' || typeof jobs.setJobSystem !== 'function') return;
+  if (!owner) {
+    owner = jobs;
+    return;
+  }
+  if (owner !== jobs && !jobs.setJobSystem(owner.getJobSystem())) {
+    console.warn('[Jobs] Addon already started its own worker pool');
+  }
+}
+
+// Stats of the shared pool (null when no addon with a job system is loaded)
+export function getNativeJobStats(): NativeJobStats | null {
+  return owner ? owner.getJobStats() : null;
+}
@@ -6,6 +6,7 @@
  */
 
 import { createRequire } from 'module';
+import { shareNativeJobs } from './NativeJobs.js';
 import { fileURLToPath } from 'url';
 import { dirname, join } from 'path';
 
@@ -14,25 +15,130 @@ export interface NativeDebugStats {
   frame: number;
   totalTris: number;
   nearClipped: number;
+  trianglesClipped: number;   // Straddled the near plane (the rest were accepted or rejected by outcode)
+  verticesTransformed: number; // By the vertex stage (once per referenced vertex per draw)
   frustumCulled: number;
+  hizCulled: number;
+  hizBlocksRejected: number;
+  occlusionTests: number;
+  occludedObjects: number;
+  overlayCells: number;
+  submittedDraws: number;
+  textureBinds: number;       // Texture switches (rebinding the bound texture is free)
+  frameRenderMs: number;      // Last pipelined frame's replay + encode time (render thread)
+  frameWaitMs: number;        // Last time submitFrame() blocked on the frame in flight
   backfaceCulled: number;
   degenerate: number;
   texturesSet: number;
   trianglesWithUV: number;
   trianglesTextured: number;
+  trianglesLightmapped: number;
   backfaceCullingEnabled: boolean;
   texturesEnabled: boolean;
   hasTexture: boolean;
   textureWidth: number;
   textureHeight: number;
+  boundTextureId: number;
+  textureUploads: number;
+  texturesResident: number;
+  textureResidentBytes: number;
+  textureBudgetBytes: number;
+  textureEvictions: number;
+  meshCount: number;
+  meshBytes: number;
+  visLeaf: number;            // Camera leaf at the last cullVisible (-1 = outside the tree)
+  visCluster: number;
+  visBatches: number;         // Batches kept by the last cullVisible
+  visPvsCulled: number;
+  visFrustumCulled: number;
+  simdKernel: string;
 }
 
+// World visibility data for setVisibility (see BSPVisibility)
+export interface NativeVisibilityData {
+  planes: Float32Array;         // nx, ny, nz, dist per node (engine space)
+  children: Int32Array;         // front, back per node: >= 0 node, < 0 ~leaf
+  leafClusters: Int32Array;     // Cluster per leaf, -1 = solid
+  pvs: Uint8Array;              // Decompressed PVS, one row of rowBytes per cluster
+  rowBytes: number;
+  batchBounds: Float32Array;    // Engine-space AABB per batch (6 floats)
+  batchOffsets: Int32Array;     // batchCount + 1 offsets into batchClusters
+  batchClusters: Int32Array;
+}
+
+// Terminal encoder bandwidth stats (cumulative since load)
+export interface NativeEncodeStats {
+  frames: number;
+  lastBytes: number;
+  lastFullBytes: number;      // Bytes a full redraw of the last frame would have taken
+  lastChangedCells: number;
+  lastTotalCells: number;
+  fullRedraws: number;
+  totalBytes: number;
+  totalFullBytes: number;
+}
+
+// Terminal encoding run by the render thread at the end of a pipelined frame
+export enum FrameEncode {
+  None = 0,
+  HalfBlock = 1,
+  HalfBlockDiff = 2,
+  Sixel = 3,
+}
+
+// Frame profiler stages (match ProfStage in native/renderer_simd.c)
+export enum ProfileStage {
+  Submit = 0,
+  Clear,
+  Setup,         // Triangle transform, clip and binning
+  Raster,        // Tile rasterization
+  MSAAResolve,
+  FrameExecute,  // Recorded frame replay (render thread)
+  FrameEncode,   // Recorded frame terminal encoding (render thread)
+  FrameWait,     // Main thread blocked on the frame in flight
+  WorkerBusy,    // Summed over job system workers
+  WorkerIdle,
+  JSFrame,       // Stages below are timed in JS and reported with recordProfileEvent()
+  JSCopy,
+  JSOutput,
+  Voice,         // Worker time on other addons' jobs (shared job system)
+  Collision,
+  Upscale,       // Scene upscale to the output size (dynamic resolution)
+  Vertex,        // Vertex stage: transform and outcodes (included in Setup)
+}
+
+// Frame time percentiles of one profiler stage (ms)
+export interface ProfileStageStats {
+  name: string;
+  p50: number;
+  p99: number;
+  max: number;
+  mean: number;
+}
+
+export interface NativeProfileStats {
+  frames: number;               // Frames the percentiles cover
+  stages: ProfileStageStats[];  // Indexed by ProfileStage
+}
+
+// Receives a pipelined frame's output (data null = nothing to write)
+export type FrameCallback = (frameId: number, data: Buffer | null, renderMs: number) => void;
+
+// Native texture filters (textures are mip-mapped at upload)
+export type NativeTextureFilter = 'nearest' | 'bilinear' | 'trilinear' | 'pixelated' | 'blockavg';
+
 // Interface for the native renderer module
 interface NativeRendererModule {
   init(width: number, height: number, msaaSamples: number): boolean;
   clear(r: number, g: number, b: number): void;
   setOptions(backfaceCulling: boolean, texturesEnabled: boolean): void;
   setTexture(data: Uint8Array | null, width: number, height: number): void;
+  setTextureFilter(mode: NativeTextureFilter, blockSize: number): void;
+  uploadTexture(data: Uint8Array, width: number, height: number): number;
+  bindTexture(id: number): boolean;
+  bindLightmap(id: number): boolean;
+  destroyTexture(id: number): void;
+  setTextureBudget(bytes: number): void;
   renderTrianglesBatch(
     vertices: Float32Array,
     indices: Uint32Array,
@@ -41,13 +147,79 @@ interface NativeRendererModule {
     normals: Float32Array,
     uvs?: Float32Array | null
   ): number;
+  createMesh(
+    vertices: Float32Array,
+    indices: Uint32Array,
+    colors: Uint8Array,
+    normals: Float32Array,
+    uvs?: Float32Array | null,
+    lightmapUvs?: Float32Array | null
+  ): number;
+  destroyMesh(handle: number): void;
+  drawMesh(handle: number, mvpMatrix: Float32Array, textureId?: number): number;
+  testOcclusion(bounds: Float32Array, mvpMatrix: Float32Array): boolean;
+  isMeshOccluded(handle: number, mvpMatrix: Float32Array): boolean;
+  setVisibility(
+    planes?: Float32Array,
+    children?: Int32Array,
+    leafClusters?: Int32Array,
+    pvs?: Uint8Array,
+    rowBytes?: number,
+    batchBounds?: Float32Array,
+    batchOffsets?: Int32Array,
+    batchClusters?: Int32Array
+  ): number;
+  cullVisible(x: number, y: number, z: number, viewProjection: Float32Array, out: Int32Array): number;
+  submit(commands: Int32Array): number;
   resolveMSAA(): void;
+  flush(): void;
   getFramebuffer(): Uint8Array;
   getDepthBuffer(): Float32Array;
+  drawGlyphs(cells: Float32Array, count: number): number;
+  compositeCells(cells: Uint32Array, count: number): void;
+  tintGlyphs(r: number, g: number, b: number, amount: number): void;
+  encodeHalfBlock(
+    out: Buffer,
+    width: number,
+    height: number,
+    bg: Uint8Array | null,
+    fg?: Uint8Array | null,
+    glyphs?: Uint32Array | null
+  ): number;
+  encodeHalfBlockDiff(
+    out: Buffer,
+    width: number,
+    height: number,
+    bg: Uint8Array | null,
+    fg?: Uint8Array | null,
+    glyphs?: Uint32Array | null
+  ): number;
+  resetEncoder(): void;
+  getEncodeStats(): NativeEncodeStats;
+  encodeSixel(
+    out: Buffer,
+    width: number,
+    height: number,
+    rgb: Uint8Array | null,
+    scale?: number,
+    quant?: number,
+    maxColors?: number
+  ): number;
+  beginFrame(): void;
+  submitFrame(encode: number, sixelScale?: number, sixelQuant?: number, sixelMaxColors?: number): number;
+  waitFrame(): void;
+  setFrameCallback(callback: FrameCallback | null): void;
+  setRenderScale?(width: number, height: number, msaaSamples: number): boolean;
   getDimensions(): { width: number; height: number };
   cleanup(): void;
   hasSIMD(): boolean;
+  getSIMDLevel(): string;
+  setSIMDLevel(name: string): boolean;
   getDebugStats(): NativeDebugStats;
+  setProfiling?(enabled: boolean): void;
+  recordProfileEvent?(stage: number, durationMs: number): void;
+  getProfileStats?(frames?: number): NativeProfileStats;
+  getProfileTrace?(frames?: number): string;
 }
 
 export class NativeRenderer {
@@ -57,6 +229,18 @@ export class NativeRenderer {
   private _width: number = 0;
   private _height: number = 0;
   private _msaaSamples: number = 1;
+  private _isProfiling: boolean = false;
+
+  // Reusable output buffers for terminal encoding, alternated so the previous
+  // frame's bytes stay intact while stdout may still be flushing them
+  private encodeBuffers: Buffer[] = [Buffer.allocUnsafe(64 * 1024), Buffer.allocUnsafe(64 * 1024)];
+  private encodeBufferIndex: number = 0;
+
+  // Depth-tested overlay cells queued for drawGlyphs()
+  // (x, y, depth, codePoint, fg, bg per cell)
+  private static readonly GLYPH_CELL_FLOATS = 6;
+  private glyphBatch: Float32Array = new Float32Array(NativeRenderer.GLYPH_CELL_FLOATS * 1024);
+  private glyphCount: number = 0;
 
   constructor() {
     this.tryLoadNativeModule();
@@ -78,6 +262,7 @@ export class NativeRenderer {
       // Path is relative to the compiled dist directory
       const modulePath = join(__dirname, '../../native/build/Release/renderer.node');
       this.module = require(modulePath) as NativeRendererModule;
+      shareNativeJobs(this.module as object);
       this._isAvailable = true;
       this._hasSIMD = this.module.hasSIMD();
     } catch (error) {
@@ -118,6 +303,7 @@ export class NativeRenderer {
 
   /**
    * Initialize the renderer with specified dimensions.
+   * Buffers are only reallocated when the size or sample count grows.
    *
    * @param width Framebuffer width
    * @param height Framebuffer height
@@ -177,6 +363,68 @@ export class NativeRenderer {
     this.module.setTexture(data, width, height);
   }
 
+  /**
+   * Select the native texture filter for subsequent frames.
+   *
+   * @param mode Filter mode ('trilinear' samples the mip chain by per-pixel LOD)
+   * @param blockSize Texels per block for 'pixelated' and 'blockavg' (rounded to a power of two)
+   */
+  setTextureFilter(mode: NativeTextureFilter, blockSize: number = 4): void {
+    if (!this.module || typeof this.module.setTextureFilter !== 'function') return;
+    this.module.setTextureFilter(mode, blockSize);
+  }
+
+  /**
+   * Upload a texture into the native resident pool.
+   * Textures are evicted least-recently-bound first when the pool exceeds its budget.
+   *
+   * @param data RGB texture data (Uint8Array)
+   * @param width Texture width
+   * @param height Texture height
+   * @returns Texture id (> 0), or 0 if the native module is unavailable
+   */
+  uploadTexture(data: Uint8Array, width: number, height: number): number {
+    if (!this.module) return 0;
+    return this.module.uploadTexture(data, width, height);
+  }
+
+  /**
+   * Bind a resident texture for subsequent draws (0 = no texture).
+   *
+   * @returns false if the texture was evicted or the id is invalid (re-upload it)
+   */
+  bindTexture(id: number): boolean {
+    if (!this.module) return false;
+    return this.module.bindTexture(id);
+  }
+
+  /**
+   * Bind a resident texture as the lightmap atlas for subsequent draws (0 = none).
+   * Meshes created with lightmap UVs are lit per pixel by it instead of per face.
+   *
+   * @returns false if the texture was evicted or the id is invalid (re-upload it)
+   */
+  bindLightmap(id: number): boolean {
+    if (!this.module || typeof this.module.bindLightmap !== 'function') return false;
+    return this.module.bindLightmap(id);
+  }
+
+  /**
+   * Free a texture previously created with uploadTexture().
+   */
+  destroyTexture(id: number): void {
+    if (!this.module) return;
+    this.module.destroyTexture(id);
+  }
+
+  /**
+   * Set the resident texture memory budget in bytes.
+   */
+  setTextureBudget(bytes: number): void {
+    if (!this.module) return;
+    this.module.setTextureBudget(bytes);
+  }
+
   /**
    * Render a batch of triangles.
    *
@@ -200,6 +448,114 @@ export class NativeRenderer {
     return this.module.renderTrianglesBatch(vertices, indices, mvpMatrix, colors, normals, uvs);
   }
 
+  /**
+   * Upload a mesh to native memory once. The returned handle can be drawn
+   * every frame with drawMesh() without re-sending vertex data.
+   *
+   * @param vertices Float32Array of vertex positions (x, y, z per vertex)
+   * @param indices Uint32Array of triangle indices (3 per triangle)
+   * @param colors Uint8Array of RGB colors per vertex
+   * @param normals Float32Array of vertex normals (x, y, z per vertex)
+   * @param uvs Float32Array of UV coordinates (u, v per vertex) - optional
+   * @param lightmapUvs Float32Array of lightmap atlas UVs (u, v per vertex) - optional
+   * @returns Mesh handle (> 0), or 0 if the native module is unavailable
+   */
+  createMesh(
+    vertices: Float32Array,
+    indices: Uint32Array,
+    colors: Uint8Array,
+    normals: Float32Array,
+    uvs?: Float32Array | null,
+    lightmapUvs?: Float32Array | null
+  ): number {
+    if (!this.module) return 0;
+    return this.module.createMesh(vertices, indices, colors, normals, uvs, lightmapUvs);
+  }
+
+  /**
+   * Free a mesh previously created with createMesh().
+   */
+  destroyMesh(handle: number): void {
+    if (!this.module) return;
+    this.module.destroyMesh(handle);
+  }
+
+  /**
+   * Draw a resident mesh with the current texture and options.
+   *
+   * @param handle Mesh handle from createMesh()
+   * @param mvpMatrix Float32Array of 16 floats (4x4 MVP matrix, column-major)
+   * @param textureId Resident texture to bind before drawing (optional, 0 = none)
+   * @returns Number of triangles rendered
+   */
+  drawMesh(handle: number, mvpMatrix: Float32Array, textureId?: number): number {
+    if (!this.module) return 0;
+    return this.module.drawMesh(handle, mvpMatrix, textureId);
+  }
+
+  /**
+   * Test a bounding box against the native hi-Z buffer.
+   * Only geometry rasterized by a previous flush() occludes.
+   *
+   * @param bounds Float32Array [minX, minY, minZ, maxX, maxY, maxZ] in model space
+   * @param mvpMatrix Float32Array of 16 floats (4x4 MVP matrix, column-major)
+   * @returns true if the box is certainly hidden
+   */
+  testOcclusion(bounds: Float32Array, mvpMatrix: Float32Array): boolean {
+    if (!this.module) return false;
+    return this.module.testOcclusion(bounds, mvpMatrix);
+  }
+
+  /**
+   * Test a resident mesh's bounding box against the native hi-Z buffer.
+   */
+  isMeshOccluded(handle: number, mvpMatrix: Float32Array): boolean {
+    if (!this.module) return false;
+    return this.module.isMeshOccluded(handle, mvpMatrix);
+  }
+
+  /**
+   * Set the world's leaf tree, PVS and draw batches (null clears them).
+   *
+   * @returns false if the native module lacks visibility support
+   */
+  setVisibility(data: NativeVisibilityData | null): boolean {
+    if (!this.module || typeof this.module.setVisibility !== 'function') return false;
+    if (!data) {
+      this.module.setVisibility();
+      return true;
+    }
+    this.module.setVisibility(
+      data.planes, data.children, data.leafClusters, data.pvs, data.rowBytes,
+      data.batchBounds, data.batchOffsets, data.batchClusters
+    );
+    return true;
+  }
+
+  /**
+   * Batches that can be seen from a camera (PVS of its leaf, then frustum).
+   *
+   * @param viewProjection Float32Array of 16 floats (column-major)
+   * @param out Receives batch indices in ascending order
+   * @returns Number of indices written, or -1 if unsupported
+   */
+  cullVisible(x: number, y: number, z: number, viewProjection: Float32Array, out: Int32Array): number {
+    if (!this.module || typeof this.module.cullVisible !== 'function') return -1;
+    return this.module.cullVisible(x, y, z, viewProjection, out);
+  }
+
+  /**
+   * Execute a command buffer (one native call for the whole frame's draws).
+   * Draws are occlusion-tested natively and, if the buffer asks for it,
+   * grouped by texture. Check commands.missingTextures afterwards.
+   *
+   * @returns Number of draws rendered (-1 if the native module lacks submit())
+   */
+  submit(commands: NativeCommandBuffer): number {
+    if (!this.module || typeof this.module.submit !== 'function') return -1;
+    return this.module.submit(commands.finish());
+  }
+
   /**
    * Resolve MSAA samples to final framebuffer.
    */
@@ -208,6 +564,16 @@ export class NativeRenderer {
     this.module.resolveMSAA();
   }
 
+  /**
+   * Rasterize all triangles queued since the last flush.
+   * Draw calls only set up and bin triangles into screen tiles; the tiles are
+   * rasterized in parallel here, or implicitly by resolveMSAA()/getFramebuffer().
+   */
+  flush(): void {
+    if (!this.module) return;
+    this.module.flush();
+  }
+
   /**
    * Get the framebuffer as RGB data.
    * Returns a Uint8Array view of the internal buffer.
@@ -226,6 +592,81 @@ export class NativeRenderer {
     return this.module.getDepthBuffer();
   }
 
+  /**
+   * Whether the loaded module can compose overlays natively
+   * (glyph layer + encoding of the composed frame).
+   */
+  hasOverlayCompositing(): boolean {
+    return !!this.module && typeof this.module.drawGlyphs === 'function';
+  }
+
+  /**
+   * Queue one overlay cell (decal, billboard, tracer segment) for flushGlyphs().
+   *
+   * @param depth NDC depth tested and written like DepthBuffer.testAndSet(); NaN = always on top
+   * @param fg Text color as 0xRRGGBB
+   * @param bg Cell background (pixel color for full blocks/spaces) as 0xRRGGBB
+   */
+  queueGlyph(x: number, y: number, depth: number, codePoint: number, fg: number, bg: number): void {
+    const stride = NativeRenderer.GLYPH_CELL_FLOATS;
+    if ((this.glyphCount + 1) * stride > this.glyphBatch.length) {
+      const grown = new Float32Array(this.glyphBatch.length * 2);
+      grown.set(this.glyphBatch);
+      this.glyphBatch = grown;
+    }
+    const o = this.glyphCount++ * stride;
+    const batch = this.glyphBatch;
+    batch[o] = x;
+    batch[o + 1] = y;
+    batch[o + 2] = depth;
+    batch[o + 3] = codePoint;
+    batch[o + 4] = fg;
+    batch[o + 5] = bg;
+  }
+
+  /**
+   * Draw all queued overlay cells into the native glyph layer, depth-tested
+   * against the scene. Call after the scene (and MSAA resolve) is complete.
+   * Returns the number of cells that passed the depth test.
+   */
+  flushGlyphs(): number {
+    const count = this.glyphCount;
+    this.glyphCount = 0;
+    if (!this.module || count === 0) return 0;
+    return this.module.drawGlyphs(this.glyphBatch, count);
+  }
+
+  /**
+   * Composite screen-space cells (no depth test), as packed by
+   * Framebuffer.packTouchedCells().
+   */
+  compositeCells(cells: Uint32Array, count: number): void {
+    if (!this.module || count === 0) return;
+    this.module.compositeCells(cells, count);
+  }
+
+  /**
+   * Blend the text color of all glyph-layer cells toward (r, g, b).
+   */
+  tintGlyphs(r: number, g: number, b: number, amount: number): void {
+    if (!this.module) return;
+    this.module.tintGlyphs(r, g, b, amount);
+  }
+
+  /**
+   * Render frames from the next clear at a scene size below the init size
+   * and/or with fewer MSAA samples; the scene is upscaled natively before
+   * overlays and readback, so framebuffer reads keep the init size. Uses the
+   * buffers allocated by init(), so it is cheap to call every frame.
+   * init() resets to full size.
+   *
+   * @returns false if the size or samples exceed the init values or the module predates it
+   */
+  setRenderScale(width: number, height: number, msaaSamples: number): boolean {
+    if (!this.module || typeof this.module.setRenderScale !== 'function') return false;
+    return this.module.setRenderScale(width, height, msaaSamples);
+  }
+
   /**
    * Get renderer dimensions.
    */
@@ -246,6 +687,160 @@ export class NativeRenderer {
     this._height = 0;
   }
 
+  /**
+   * Get the raster kernel picked for this CPU ("avx2", "sse4.1", "neon" or "scalar").
+   */
+  getSIMDLevel(): string {
+    if (!this.module) return 'none';
+    return this.module.getSIMDLevel();
+  }
+
+  /**
+   * Force a raster kernel ("auto" restores the best one). Returns false if unsupported.
+   */
+  setSIMDLevel(name: string): boolean {
+    if (!this.module) return false;
+    const ok = this.module.setSIMDLevel(name);
+    this._hasSIMD = this.module.hasSIMD();
+    return ok;
+  }
+
+  /**
+   * Encode cells as half-block ANSI directly into a reusable Buffer.
+   * Output is byte-identical to Framebuffer.toHalfBlockAnsiString().
+   *
+   * @param bg RGB per cell (pixel color for solid cells), or null to encode the
+   *           natively composed frame (scene + glyph layer)
+   * @param fg RGB per cell for text glyphs (null = all solid)
+   * @param glyphs Code point per cell, 0 = solid pixel (null = all solid)
+   * @returns View of the encoded bytes (valid until the call after next), or null
+   */
+  encodeHalfBlock(
+    width: number,
+    height: number,
+    bg: Uint8Array | null,
+    fg: Uint8Array | null = null,
+    glyphs: Uint32Array | null = null
+  ): Buffer | null {
+    if (!this.module) return null;
+    return this.runEncoder((out) => this.module!.encodeHalfBlock(out, width, height, bg, fg, glyphs));
+  }
+
+  /**
+   * Encode only the cells that changed since the previous call (half-block ANSI).
+   * The first call, a size change or resetEncoder() redraws everything.
+   *
+   * @returns View of the encoded bytes (empty if nothing changed), or null
+   */
+  encodeHalfBlockDiff(
+    width: number,
+    height: number,
+    bg: Uint8Array | null,
+    fg: Uint8Array | null = null,
+    glyphs: Uint32Array | null = null
+  ): Buffer | null {
+    if (!this.module) return null;
+    return this.runEncoder((out) => this.module!.encodeHalfBlockDiff(out, width, height, bg, fg, glyphs));
+  }
+
+  /**
+   * Force the next encodeHalfBlockDiff() to redraw every cell and the next
+   * native-frame encodeSixel() to be sent
+   * (after the terminal was cleared or written to elsewhere).
+   */
+  resetEncoder(): void {
+    if (!this.module) return;
+    this.module.resetEncoder();
+  }
+
+  /**
+   * Get terminal output bandwidth stats.
+   */
+  getEncodeStats(): NativeEncodeStats | null {
+    if (!this.module) return null;
+    return this.module.getEncodeStats();
+  }
+
+  /**
+   * Encode an RGB image as Sixel (quantized palette, scale x scale pixels)
+   * directly into a reusable Buffer.
+   *
+   * @param rgb Pixels, or null to encode the natively composed frame
+   *            (empty result when it is unchanged since the last one sent)
+   * @returns View of the encoded bytes (valid until the call after next), or null
+   */
+  encodeSixel(
+    width: number,
+    height: number,
+    rgb: Uint8Array | null,
+    scale: number = 1,
+    quant: number = 16,
+    maxColors: number = 256
+  ): Buffer | null {
+    if (!this.module) return null;
+    return this.runEncoder((out) => this.module!.encodeSixel(out, width, height, rgb, scale, quant, maxColors));
+  }
+
+  /**
+   * Whether the loaded module can record frames and render them on its own thread.
+   */
+  hasFramePipeline(): boolean {
+    return !!this.module && typeof this.module.beginFrame === 'function';
+  }
+
+  /**
+   * Start recording a frame: until submitFrame(), clear/setOptions/drawMesh/
+   * resolveMSAA/flush and the overlay calls are queued for the render thread.
+   * While recording, drawMesh() returns 0 and occlusion queries return false
+   * (replayed draws are occlusion-tested on the render thread instead).
+   */
+  beginFrame(): void {
+    if (!this.module) return;
+    this.module.beginFrame();
+  }
+
+  /**
+   * Hand the recorded frame to the render thread and return without waiting
+   * for it. Blocks only while the previous frame is still rendering.
+   * The encoded output is delivered to the setFrameCallback() callback.
+   *
+   * @returns Frame id passed to the callback (0 if unavailable)
+   */
+  submitFrame(encode: FrameEncode, sixelScale: number = 1, sixelQuant: number = 16, sixelMaxColors: number = 256): number {
+    if (!this.module) return 0;
+    return this.module.submitFrame(encode, sixelScale, sixelQuant, sixelMaxColors);
+  }
+
+  /**
+   * Block until the frame in flight has finished rendering.
+   */
+  waitFrame(): void {
+    if (!this.module) return;
+    this.module.waitFrame();
+  }
+
+  /**
+   * Set the receiver of pipelined frame output (null drops it).
+   * Callbacks run on the main thread in submission order.
+   */
+  setFrameCallback(callback: FrameCallback | null): void {
+    if (!this.module) return;
+    this.module.setFrameCallback(callback);
+  }
+
+  // Run an encoder into the next output buffer, growing it once if too small
+  private runEncoder(encode: (out: Buffer) => number): Buffer {
+    this.encodeBufferIndex ^= 1;
+    let out = this.encodeBuffers[this.encodeBufferIndex];
+    let length = encode(out);
+    if (length < 0) {
+      out = Buffer.allocUnsafe(Math.ceil(-length * 1.25));
+      this.encodeBuffers[this.encodeBufferIndex] = out;
+      length = encode(out);
+    }
+    return out.subarray(0, length);
+  }
+
   /**
    * Get debug stats from native renderer.
    */
@@ -253,6 +848,189 @@ export class NativeRenderer {
     if (!this.module) return null;
     return this.module.getDebugStats();
   }
+
+  /**
+   * Whether the loaded module has the frame profiler.
+   */
+  hasProfiler(): boolean {
+    return !!this.module && typeof this.module.setProfiling === 'function';
+  }
+
+  /**
+   * Whether profiling is on (JS stages should be reported).
+   */
+  get isProfiling(): boolean {
+    return this._isProfiling;
+  }
+
+  /**
+   * Turn the frame profiler on (clearing earlier samples) or off.
+   * Recorded samples stay readable after turning it off.
+   *
+   * @returns false if the module has no profiler
+   */
+  setProfiling(enabled: boolean): boolean {
+    if (!this.module || !this.hasProfiler()) return false;
+    this.module.setProfiling!(enabled);
+    this._isProfiling = enabled;
+    return true;
+  }
+
+  /**
+   * Report a stage timed in JS, ending now.
+   */
+  recordProfileEvent(stage: ProfileStage, durationMs: number): void {
+    if (!this._isProfiling) return;
+    this.module!.recordProfileEvent!(stage, durationMs);
+  }
+
+  /**
+   * Per-stage p50/p99/max/mean over the last `frames` profiled frames (at most 256).
+   */
+  getProfileStats(frames?: number): NativeProfileStats | null {
+    if (!this.module || !this.hasProfiler()) return null;
+    return this.module.getProfileStats!(frames);
+  }
+
+  /**
+   * Profiled events of the last `frames` frames (default: all still recorded)
+   * as Chrome trace JSON, for chrome://tracing or Perfetto.
+   */
+  getProfileTrace(frames?: number): string | null {
+    if (!this.module || !this.hasProfiler()) return null;
+    return this.module.getProfileTrace!(frames);
+  }
+}
+
+/**
+ * Binary draw command stream for NativeRenderer.submit(), reused every frame.
+ * Layout (int32 words; MVP floats share the buffer): a 4-word header
+ * (length, flags, drawn, missing textures) followed by opcode + arguments.
+ */
+export class NativeCommandBuffer {
+  private static readonly HEADER_WORDS = 4;
+  private static readonly SORT_BY_TEXTURE = 1;
+
+  private static readonly CLEAR = 1;
+  private static readonly SET_STATE = 2;
+  private static readonly BIND_MESH = 3;
+  private static readonly BIND_TEXTURE = 4;
+  private static readonly SET_MVP = 5;
+  private static readonly DRAW = 6;
+  private static readonly FLUSH = 7;
+  private static readonly RESOLVE_MSAA = 8;
+  private static readonly BIND_LIGHTMAP = 9;
+
+  private words: Int32Array;
+  private floats: Float32Array;
+  private length: number = NativeCommandBuffer.HEADER_WORDS;
+
+  /**
+   * @param sortByTexture Let the native side group draws by texture between
+   *                      state changes and flushes (draw order is otherwise kept)
+   */
+  constructor(sortByTexture: boolean = true, initialWords: number = 4096) {
+    this.words = new Int32Array(initialWords);
+    this.floats = new Float32Array(this.words.buffer);
+    this.words[1] = sortByTexture ? NativeCommandBuffer.SORT_BY_TEXTURE : 0;
+  }
+
+  /** Start a new frame (keeps the allocation). */
+  reset(): void {
+    this.length = NativeCommandBuffer.HEADER_WORDS;
+  }
+
+  /** Draws rendered by the last submit. */
+  get drawn(): number {
+    return this.words[2];
+  }
+
+  /** Draws in the last submit whose texture or lightmap was evicted (drawn untextured / face-lit). */
+  get missingTextures(): number {
+    return this.words[3];
+  }
+
+  clear(r: number, g: number, b: number): void {
+    const o = this.reserve(4);
+    this.words[o] = NativeCommandBuffer.CLEAR;
+    this.words[o + 1] = r;
+    this.words[o + 2] = g;
+    this.words[o + 3] = b;
+  }
+
+  setState(backfaceCulling: boolean, texturesEnabled: boolean): void {
+    const o = this.reserve(3);
+    this.words[o] = NativeCommandBuffer.SET_STATE;
+    this.words[o + 1] = backfaceCulling ? 1 : 0;
+    this.words[o + 2] = texturesEnabled ? 1 : 0;
+  }
+
+  bindMesh(handle: number): void {
+    const o = this.reserve(2);
+    this.words[o] = NativeCommandBuffer.BIND_MESH;
+    this.words[o + 1] = handle;
+  }
+
+  /** Bind a resident texture id for the following draws (0 = untextured). */
+  bindTexture(id: number): void {
+    const o = this.reserve(2);
+    this.words[o] = NativeCommandBuffer.BIND_TEXTURE;
+    this.words[o + 1] = id;
+  }
+
+  /** Bind a resident lightmap atlas id for the following draws (0 = face lighting). */
+  bindLightmap(id: number): void {
+    const o = this.reserve(2);
+    this.words[o] = NativeCommandBuffer.BIND_LIGHTMAP;
+    this.words[o + 1] = id;
+  }
+
+  /** Set the MVP matrix (16 floats, column-major) for the following draws. */
+  setMVP(elements: ArrayLike<number>): void {
+    const o = this.reserve(17);
+    this.words[o] = NativeCommandBuffer.SET_MVP;
+    for (let i = 0; i < 16; i++) {
+      this.floats[o + 1 + i] = elements[i];
+    }
+  }
+
+  /** Draw the bound mesh with the bound texture and MVP. */
+  draw(): void {
+    const o = this.reserve(1);
+    this.words[o] = NativeCommandBuffer.DRAW;
+  }
+
+  /** Rasterize queued draws so later draws are hi-Z tested against them. */
+  flush(): void {
+    const o = this.reserve(1);
+    this.words[o] = NativeCommandBuffer.FLUSH;
+  }
+
+  resolveMSAA(): void {
+    const o = this.reserve(1);
+    this.words[o] = NativeCommandBuffer.RESOLVE_MSAA;
+  }
+
+  /** Write the header and return the words to submit. */
+  finish(): Int32Array {
+    this.words[0] = this.length;
+    this.words[2] = 0;
+    this.words[3] = 0;
+    return this.words;
+  }
+
+  // Grow the buffer so count more words fit, returning their offset
+  private reserve(count: number): number {
+    if (this.length + count > this.words.length) {
+      const grown = new Int32Array(Math.max(this.words.length * 2, this.length + count));
+      grown.set(this.words.subarray(0, this.length));
+      this.words = grown;
+      this.floats = new Float32Array(grown.buffer);
+    }
+    const offset = this.length;
+    this.length += count;
+    return offset;
+  }
 }
 
 // Singleton instance
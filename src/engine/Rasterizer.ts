@@ -65,7 +65,7 @@ export class Rasterizer {
   public maxDepth: number = 50;
   public enableBackfaceCulling: boolean = false;  // Off by default - BSP geometry needs this
   public enableTextures: boolean = true;
-  public textureFilter: 'normal' | 'pixelated' | 'blockavg' = 'blockavg';  // blockavg looks best
+  public textureFilter: 'normal' | 'bilinear' | 'trilinear' | 'pixelated' | 'blockavg' = 'blockavg';  // blockavg looks best
   public texturePixelSize: number = 4;  // Block size for pixelated/blockavg modes
   public whiteTextureMode: boolean = false;  // Force white textures to see lighting/shading
   public enableAmbientOcclusion: boolean = false;
@@ -483,6 +483,9 @@ export class Rasterizer {
                     texColor = tri.material.texture.samplePixelated(u * scale, v * scale, this.texturePixelSize);
                   } else if (this.textureFilter === 'blockavg') {
                     texColor = tri.material.texture.sampleBlockAverage(u * scale, v * scale, this.texturePixelSize);
+                  } else if (this.textureFilter === 'bilinear' || this.textureFilter === 'trilinear') {
+                    // No mip chain on the JS path; trilinear is native-only
+                    texColor = tri.material.texture.sampleBilinear(u * scale, v * scale);
                   } else {
                     texColor = tri.material.texture.sample(u * scale, v * scale);
                   }
@@ -559,6 +562,9 @@ export class Rasterizer {
                   texColor = tri.material.texture.samplePixelated(u * scale, v * scale, this.texturePixelSize);
                 } else if (this.textureFilter === 'blockavg') {
                   texColor = tri.material.texture.sampleBlockAverage(u * scale, v * scale, this.texturePixelSize);
+                } else if (this.textureFilter === 'bilinear' || this.textureFilter === 'trilinear') {
+                  // No mip chain on the JS path; trilinear is native-only
+                  texColor = tri.material.texture.sampleBilinear(u * scale, v * scale);
                 } else {
                   texColor = tri.material.texture.sample(u * scale, v * scale);
                 }
@@ -2,6 +2,7 @@ import { Vector3 } from './math/Vector3.js';
 import { Matrix4 } from './math/Matrix4.js';
 import { Camera } from './Camera.js';
 import { Mesh } from './Mesh.js';
+import { Texture } from './Texture.js';
 import { Transform } from './Transform.js';
 import { Framebuffer } from './Framebuffer.js';
 import { DepthBuffer } from './DepthBuffer.js';
@@ -19,13 +20,16 @@ import { ServerBrowser, ServerBrowserState } from '../ui/ServerBrowser.js';
 import { LobbyScreen, LobbyState } from '../ui/LobbyScreen.js';
 import { TeamId, TEAMS } from '../game/Team.js';
 import { DroppedWeapon } from '../game/DroppedWeapon.js';
-import { getNativeRenderer, NativeRenderer } from './NativeRenderer.js';
+import { getNativeRenderer, NativeRenderer, NativeCommandBuffer, FrameEncode, ProfileStage, NativeProfileStats } from './NativeRenderer.js';
+import { BSPVisibilityData, cullVisibleJS } from '../bsp/BSPVisibility.js';
+import { ResolutionController, RenderScale } from './ResolutionController.js';
 import * as fs from 'fs';
 
 export interface RenderObject {
   mesh: Mesh;
   transform: Transform;
   visible?: boolean;
+  visBatch?: number;  // Draw batch in the map's visibility data (see setVisibility)
 }
 
 export interface RenderStats {
@@ -48,6 +52,13 @@ export class Renderer {
   private objects: RenderObject[] = [];
   private camera: Camera;
 
+  // BSP leaf/PVS culling: batches visible from the camera, refreshed each frame
+  private visibility: BSPVisibilityData | null = null;
+  private visibleBatchList: Int32Array = new Int32Array(0);
+  private visibleBatches: Uint8Array = new Uint8Array(0);
+  private nativeVisibilityUploaded: boolean = false;
+  private nativeVisibility: boolean = false;
+
   private clearColor: Color = new Color(135, 206, 235); // Sky blue
   private lastFrameTime: number = 0;
   private frameCount: number = 0;
@@ -169,6 +180,52 @@ export class Renderer {
   private useNativeRenderer: boolean = false;
   private nativeRendererInitialized: boolean = false;
 
+  // Resident native mesh handles (uploaded once on first native draw)
+  private nativeMeshHandles: Map<Mesh, number> = new Map();
+
+  // Reused per-frame draw command stream for the native renderer
+  private nativeCommands: NativeCommandBuffer = new NativeCommandBuffer(true);
+
+  // Resident native texture ids (uploaded once, re-uploaded only if evicted)
+  private nativeTextureIds: Map<Texture, number> = new Map();
+
+  // Consecutive frames that missed textures after the last one re-uploaded them all
+  private nativeTextureMissFrames: number = 0;
+
+  // Output mode written last frame (a change forces a full redraw)
+  private lastOutputMode: RenderMode | null = null;
+
+  // Colors the native framebuffer copy writes into (one per pixel, reused)
+  private nativePixelColors: Color[] = [];
+
+  // Frame composed in native memory: overlays go to the native glyph layer and
+  // the JS framebuffer only holds this frame's HUD/UI cells (no color/depth copy)
+  private composeNatively: boolean = false;
+
+  // Composed frames are recorded and rendered/encoded on the native render
+  // thread; output arrives in onNativeFrame() while JS builds the next frame
+  private recordingNativeFrame: boolean = false;
+  private lastSubmittedFrameId: number = 0;
+  private lastWrittenFrameId: number = 0;
+  private staleFrameId: number = 0;  // Output of frames up to this id is dropped
+
+  // Dynamic resolution / adaptive MSAA for the native path (null = off, see setDynamicResolution)
+  private resolutionController: ResolutionController | null = null;
+
+  // Meshes at least this big are flushed right after drawing to feed hi-Z occlusion
+  private static readonly NATIVE_OCCLUDER_TRIANGLES = 1024;
+
+  // Texture bytes re-uploaded per frame after evictions (bounds the hitch; the rest follow next frame)
+  private static readonly NATIVE_TEXTURE_REUPLOAD_BYTES = 16 * 1024 * 1024;
+
+  // Frames in a row that lose re-uploaded textures again before the budget is raised,
+  // and the most it is raised to
+  private static readonly NATIVE_TEXTURE_THRASH_FRAMES = 4;
+  private static readonly NATIVE_TEXTURE_BUDGET_MAX = 1024 * 1024 * 1024;
+
+  // Background of overlay cells drawn over the scene
+  private static readonly TRANSPARENT = new Color(0, 0, 0, 0);
+
   constructor(width?: number, height?: number) {
     // Get terminal size if not specified
     this.terminalWidth = width || process.stdout.columns || 80;
@@ -199,10 +256,15 @@ export class Renderer {
       this.nativeRenderer = getNativeRenderer();
       if (this.nativeRenderer.isAvailable) {
         // Initialize with current framebuffer dimensions
-        const msaaSamples = this.msaaMode === '16x' ? 16 : this.msaaMode === '4x' ? 4 : 1;
-        this.nativeRendererInitialized = this.nativeRenderer.init(this.width, this.height, msaaSamples);
+        this.nativeRendererInitialized = this.nativeRenderer.init(this.width, this.height, this.nativeMsaaSamples());
+        this.nativeVisibilityUploaded = false;
+        this.applyRenderScale();
         // Native rendering disabled by default until fully tested - enable with settings
         this.useNativeRenderer = false;
+        if (this.nativeRenderer.hasFramePipeline()) {
+          this.nativeRenderer.setFrameCallback((frameId, data, renderMs) => this.onNativeFrame(frameId, data, renderMs));
+        }
+        this.applyNativeTextureFilter();
       }
     } catch {
       this.nativeRenderer = null;
@@ -375,8 +437,9 @@ export class Renderer {
     // Reinitialize native renderer with new dimensions (if it was enabled)
     if (this.nativeRenderer?.isAvailable) {
       const wasEnabled = this.useNativeRenderer;
-      const msaaSamples = this.msaaMode === '16x' ? 16 : this.msaaMode === '4x' ? 4 : 1;
-      this.nativeRendererInitialized = this.nativeRenderer.init(this.width, this.height, msaaSamples);
+      this.nativeRendererInitialized = this.nativeRenderer.init(this.width, this.height, this.nativeMsaaSamples());
+      this.nativeVisibilityUploaded = false;
+      this.applyRenderScale();
       // Restore enabled state only if reinit succeeded
       this.useNativeRenderer = wasEnabled && this.nativeRendererInitialized;
     }
@@ -385,8 +448,8 @@ export class Renderer {
     this.framebuffer.clear('█', this.clearColor, this.clearColor);
     this.prevFramebuffer.clear('█', this.clearColor, this.clearColor);
 
-    // Invalidate sixel frame hash to force redraw
-    this.framebuffer.invalidateFrameHash();
+    // Invalidate sixel frame hash / native diff state to force redraw
+    this.invalidateOutput();
 
     this.camera.setAspect(aspect);
   }
@@ -467,7 +530,7 @@ export class Renderer {
   }
 
   // Write output in chunks to avoid blocking (for sixel)
-  private writeOutputAsync(output: string): void {
+  private writeOutputAsync(output: string | Buffer): void {
     if (!this.asyncSixelOutput || output.length < 10000) {
       // Small outputs: write directly
       process.stdout.write(output);
@@ -476,9 +539,11 @@ export class Renderer {
 
     // Large sixel outputs: split into chunks and write with setImmediate
     const CHUNK_SIZE = 16384; // 16KB chunks
-    const chunks: string[] = [];
+    const chunks: (string | Buffer)[] = [];
     for (let i = 0; i < output.length; i += CHUNK_SIZE) {
-      chunks.push(output.slice(i, i + CHUNK_SIZE));
+      chunks.push(typeof output === 'string'
+        ? output.slice(i, i + CHUNK_SIZE)
+        : output.subarray(i, i + CHUNK_SIZE));
     }
 
     // Write first chunk immediately
@@ -494,6 +559,130 @@ export class Renderer {
       });
     }
   }
+  // Force the next frame to be sent in full (terminal was cleared or resized)
+  invalidateOutput(): void {
+    this.framebuffer.invalidateFrameHash();
+    this.nativeRenderer?.resetEncoder();
+    // Frames still rendering were encoded for the old screen contents
+    this.staleFrameId = this.lastSubmittedFrameId;
+  }
+
+  // Output of a pipelined frame, delivered in submission order
+  private onNativeFrame(frameId: number, data: Buffer | null, renderMs: number): void {
+    // Replay + encode time on the render thread drives dynamic resolution for pipelined frames
+    this.updateRenderScale(renderMs);
+    if (frameId <= this.staleFrameId) return;
+    this.lastWrittenFrameId = frameId;
+    if (!data) return;
+    if (this.renderMode === 'sixel') {
+      this.writeOutputAsync(data);
+    } else {
+      process.stdout.write(data);
+    }
+  }
+
+  // Writing a frame directly: pipelined output not yet delivered would land after it
+  private dropPendingNativeFrames(): void {
+    if (this.lastWrittenFrameId < this.lastSubmittedFrameId && this.staleFrameId < this.lastSubmittedFrameId) {
+      this.invalidateOutput();
+    }
+  }
+
+  // Can the whole frame be composed and encoded in native memory?
+  private canComposeNatively(): boolean {
+    return this.useNativeRenderer &&
+           this.nativeRendererInitialized &&
+           !!this.nativeRenderer?.hasOverlayCompositing() &&
+           this.nativeRenderer.width === this.width &&
+           this.nativeRenderer.height === this.height &&
+           (this.renderMode === 'halfblock' || this.renderMode === 'sixel');
+  }
+
+  // Hand this frame's HUD/UI cells to the native compositor
+  private compositeTouchedCells(): void {
+    const { cells, count } = this.framebuffer.packTouchedCells();
+    this.nativeRenderer!.compositeCells(cells, count);
+  }
+
+  // Write the framebuffer as half-block ANSI (native encoder when available)
+  private writeHalfBlockOutput(): void {
+    if (this.recordingNativeFrame) {
+      // Rendered and encoded on the native render thread
+      this.compositeTouchedCells();
+      this.submitNativeFrame(this.enableDifferentialRendering ? FrameEncode.HalfBlockDiff : FrameEncode.HalfBlock);
+      return;
+    }
+    this.dropPendingNativeFrames();
+    if (this.nativeRenderer?.isAvailable) {
+      const width = this.framebuffer.width;
+      const height = this.framebuffer.height;
+      let bg: Uint8Array | null = null;
+      let fg: Uint8Array | null = null;
+      let glyphs: Uint32Array | null = null;
+      if (this.composeNatively) {
+        // Encode the native frame in place
+        this.compositeTouchedCells();
+      } else {
+        ({ bg, fg, glyphs } = this.framebuffer.packCells());
+      }
+      const encoded = this.enableDifferentialRendering
+        ? this.nativeRenderer.encodeHalfBlockDiff(width, height, bg, fg, glyphs)
+        : this.nativeRenderer.encodeHalfBlock(width, height, bg, fg, glyphs);
+      if (encoded) {
+        if (encoded.length > 0) process.stdout.write(encoded);
+        return;
+      }
+    }
+    process.stdout.write(this.framebuffer.toHalfBlockAnsiString());
+  }
+
+  // Write the framebuffer as Sixel if it changed (native encoder when available)
+  private writeSixelOutput(): void {
+    if (this.recordingNativeFrame) {
+      this.compositeTouchedCells();
+      this.submitNativeFrame(
+        FrameEncode.Sixel,
+        this.sixelOutputScale,
+        this.framebuffer.sixelQuantLevel,
+        this.framebuffer.sixelMaxColors
+      );
+      return;
+    }
+    this.dropPendingNativeFrames();
+    if (this.nativeRenderer?.isAvailable) {
+      let bg: Uint8Array | null = null;
+      if (this.composeNatively) {
+        // The native encoder skips unchanged composed frames itself
+        this.compositeTouchedCells();
+      } else {
+        if (!this.framebuffer.hasFrameChanged()) return;
+        bg = this.framebuffer.packCells(false).bg;
+      }
+      const encoded = this.nativeRenderer.encodeSixel(
+        this.framebuffer.width,
+        this.framebuffer.height,
+        bg,
+        this.sixelOutputScale,
+        this.framebuffer.sixelQuantLevel,
+        this.framebuffer.sixelMaxColors
+      );
+      if (encoded) {
+        if (encoded.length > 0) this.writeOutputAsync(encoded);
+        return;
+      }
+    }
+    const outputString = this.framebuffer.toScaledSixelString(this.sixelOutputScale);
+    if (outputString.length > 0) {
+      this.writeOutputAsync(outputString);
+    }
+  }
+
+
+  // Hand the recorded frame to the native render thread
+  private submitNativeFrame(encode: FrameEncode, sixelScale?: number, sixelQuant?: number, sixelMaxColors?: number): void {
+    this.recordingNativeFrame = false;
+    this.lastSubmittedFrameId = this.nativeRenderer!.submitFrame(encode, sixelScale, sixelQuant, sixelMaxColors);
+  }
 
   setMSAAMode(mode: MSAAMode): void {
     this.msaaMode = mode;
@@ -504,18 +693,80 @@ export class Renderer {
     // Re-initialize native renderer with new MSAA samples
     if (this.nativeRenderer?.isAvailable) {
       const wasEnabled = this.useNativeRenderer;
-      const msaaSamples = mode === '16x' ? 16 : mode === '4x' ? 4 : 1;
+      const msaaSamples = this.nativeMsaaSamples();
       this.nativeRendererInitialized = this.nativeRenderer.init(this.width, this.height, msaaSamples);
+      this.nativeVisibilityUploaded = false;
       this.useNativeRenderer = wasEnabled && this.nativeRendererInitialized;
+      // The MSAA setting is the controller's ceiling
+      this.resolutionController?.setMaxSamples(msaaSamples);
+      this.applyRenderScale();
     }
+
+    // Callers clear the screen when switching MSAA
+    this.invalidateOutput();
   }
 
   getMSAAMode(): MSAAMode {
     return this.msaaMode;
   }
 
+  private nativeMsaaSamples(): number {
+    return this.msaaMode === '16x' ? 16 : this.msaaMode === '4x' ? 4 : 1;
+  }
+
+  /**
+   * Dynamic resolution: hold the native renderer's frame time near targetMs by
+   * rendering the scene below the output size and stepping MSAA down (never
+   * above the MSAA setting). The scene is upscaled natively, overlays and HUD
+   * stay at full resolution. 0 turns it off and restores full quality.
+   */
+  setDynamicResolution(targetMs: number): void {
+    if (targetMs > 0) {
+      if (this.resolutionController) {
+        this.resolutionController.setTarget(targetMs);
+      } else {
+        this.resolutionController = new ResolutionController(targetMs, this.nativeMsaaSamples());
+      }
+    } else {
+      this.resolutionController = null;
+    }
+    this.applyRenderScale();
+  }
+
+  // Target and current scale/samples, null when off
+  getDynamicResolution(): (RenderScale & { targetMs: number }) | null {
+    const controller = this.resolutionController;
+    return controller ? { ...controller.scale, targetMs: controller.target } : null;
+  }
+
+  // Push the controller's scene size to the native renderer (init() resets it to full size)
+  private applyRenderScale(): void {
+    if (!this.nativeRenderer || !this.nativeRendererInitialized) return;
+    const { scale, msaaSamples } = this.resolutionController?.scale ?? { scale: 1, msaaSamples: this.nativeMsaaSamples() };
+    this.nativeRenderer.setRenderScale(
+      Math.max(1, Math.round(this.width * scale)),
+      Math.max(1, Math.round(this.height * scale)),
+      msaaSamples
+    );
+  }
+
+  // Feed one native frame's render time to the controller
+  private updateRenderScale(renderMs: number): void {
+    if (this.resolutionController?.update(renderMs)) {
+      this.applyRenderScale();
+    }
+  }
+
   setTextureFilter(mode: TextureFilterMode): void {
     this.rasterizer.textureFilter = mode;
+    this.applyNativeTextureFilter();
+  }
+
+  // Mirror the JS filter setting in the native sampler ('normal' is nearest)
+  private applyNativeTextureFilter(): void {
+    if (!this.nativeRenderer?.isAvailable) return;
+    const mode = this.rasterizer.textureFilter;
+    this.nativeRenderer.setTextureFilter(mode === 'normal' ? 'nearest' : mode, this.rasterizer.texturePixelSize);
   }
 
   getTextureFilter(): TextureFilterMode {
@@ -542,11 +793,84 @@ export class Renderer {
     const index = this.objects.indexOf(object);
     if (index !== -1) {
       this.objects.splice(index, 1);
+      // Free the native copy unless another object still shares this mesh
+      if (!this.objects.some(o => o.mesh === object.mesh)) {
+        this.releaseNativeMesh(object.mesh);
+      }
     }
   }
 
   clearObjects(): void {
     this.objects = [];
+    this.setVisibility(null);
+    for (const mesh of [...this.nativeMeshHandles.keys()]) {
+      this.releaseNativeMesh(mesh);
+    }
+    for (const id of this.nativeTextureIds.values()) {
+      this.nativeRenderer?.destroyTexture(id);
+    }
+    this.nativeTextureIds.clear();
+  }
+
+  // Native frame profiler (per-stage timers, see NativeRenderer.setProfiling); false without the addon
+  setProfiling(enabled: boolean): boolean {
+    return !!this.nativeRenderer?.setProfiling(enabled);
+  }
+
+  getProfileStats(frames?: number): NativeProfileStats | null {
+    return this.nativeRenderer?.getProfileStats(frames) ?? null;
+  }
+
+  // Chrome trace JSON of the profiled frames
+  getProfileTrace(frames?: number): string | null {
+    return this.nativeRenderer?.getProfileTrace(frames) ?? null;
+  }
+
+  /**
+   * Set the map's leaf tree, PVS and batch bounds (null disables culling)
+   *
+   * Objects with a visBatch are then only drawn while their batch can be
+   * seen from the camera's leaf and overlaps the view frustum.
+   */
+  setVisibility(visibility: BSPVisibilityData | null): void {
+    this.visibility = visibility;
+    const batchCount = visibility ? visibility.batchOffsets.length - 1 : 0;
+    this.visibleBatchList = new Int32Array(batchCount);
+    this.visibleBatches = new Uint8Array(batchCount);
+    this.nativeVisibilityUploaded = false;
+    this.nativeVisibility = false;
+    if (!visibility && this.nativeRenderer && this.nativeRendererInitialized) {
+      this.nativeRenderer.setVisibility(null);
+    }
+  }
+
+  // Mark the batches visible this frame (natively when the addon supports it)
+  private cullVisibleBatches(viewProjection: Matrix4): void {
+    const vis = this.visibility;
+    if (!vis) return;
+
+    if (!this.nativeVisibilityUploaded && this.nativeRenderer && this.nativeRendererInitialized) {
+      this.nativeVisibility = this.nativeRenderer.setVisibility(vis);
+      this.nativeVisibilityUploaded = true;
+    }
+
+    const p = this.camera.position;
+    let count = this.nativeVisibility
+      ? this.nativeRenderer!.cullVisible(p.x, p.y, p.z, viewProjection.elements, this.visibleBatchList)
+      : -1;
+    if (count < 0) {
+      count = cullVisibleJS(vis, p.x, p.y, p.z, viewProjection.elements, this.visibleBatchList);
+    }
+
+    this.visibleBatches.fill(0);
+    for (let i = 0; i < count; i++) {
+      this.visibleBatches[this.visibleBatchList[i]] = 1;
+    }
+  }
+
+  // Whether leaf/PVS culling rejected an object this frame
+  private isBatchCulled(obj: RenderObject): boolean {
+    return this.visibility !== null && obj.visBatch !== undefined && this.visibleBatches[obj.visBatch] === 0;
   }
 
   resize(width?: number, height?: number): void {
@@ -557,6 +881,7 @@ export class Renderer {
     this.prevFramebuffer.resize(this.width, this.height);
     this.depthBuffer.resize(this.width, this.height);
     this.rasterizer.resize(this.framebuffer, this.depthBuffer);
+    this.invalidateOutput();
 
     // Update camera aspect ratio
     const aspect = this.width / (this.height * 2);
@@ -564,6 +889,12 @@ export class Renderer {
   }
 
   private clear(): void {
+    if (this.composeNatively) {
+      // Scene, depth and MSAA samples live in the native renderer; only last frame's overlay cells need resetting
+      this.framebuffer.clearTouched('█', this.clearColor, this.clearColor);
+      return;
+    }
+
     // Clear with clearColor for both fg and bg (fg for basic mode, bg for half-block/sixel)
     this.framebuffer.clear('█', this.clearColor, this.clearColor);
     this.depthBuffer.clear();
@@ -600,8 +931,15 @@ export class Renderer {
       }
     }
 
-    // Swap buffers for differential rendering
-    if (this.enableDifferentialRendering) {
+    // Compose natively when the native renderer draws the scene and encodes the output
+    const composeNatively = !isFullScreenUI && this.canComposeNatively();
+    if (composeNatively !== this.composeNatively) {
+      this.composeNatively = composeNatively;
+      this.framebuffer.setTouchTracking(composeNatively);
+    }
+
+    // Swap buffers for differential rendering (basic mode diffs the JS framebuffer)
+    if (this.enableDifferentialRendering && !this.composeNatively) {
       this.framebuffer.copyTo(this.prevFramebuffer);
     }
 
@@ -617,64 +955,90 @@ export class Renderer {
       // Get camera matrices
       const viewProjection = this.camera.viewProjectionMatrix;
 
+      // Drop map batches outside the camera's PVS and frustum before any transform work
+      this.cullVisibleBatches(viewProjection);
+
       // Use native SIMD renderer if available and enabled
       const canUseNative = this.useNativeRenderer &&
                            this.nativeRenderer &&
                            this.nativeRendererInitialized;
       if (canUseNative) {
-        // Native rendering path - batch all meshes
-        this.nativeRenderer.clear(
-          this.clearColor.r,
-          this.clearColor.g,
-          this.clearColor.b
-        );
+        // Record the frame for the render thread when the output is encoded natively
+        // (draws are then occlusion-tested on that thread and all count as visible)
+        if (this.composeNatively && this.nativeRenderer.hasFramePipeline()) {
+          this.nativeRenderer.beginFrame();
+          this.recordingNativeFrame = true;
+        }
+
+        // Native rendering path - the whole scene goes down in one command buffer
+        const commands = this.nativeCommands;
+        commands.reset();
+        commands.clear(this.clearColor.r, this.clearColor.g, this.clearColor.b);
 
         // Set rendering options (backface culling, textures)
-        this.nativeRenderer.setOptions(
-          this.rasterizer.enableBackfaceCulling,
-          this.rasterizer.enableTextures
-        );
+        commands.setState(this.rasterizer.enableBackfaceCulling, this.rasterizer.enableTextures);
 
         for (const obj of this.objects) {
-          if (obj.visible === false) continue;
-
-          visibleObjects++;
-          totalTriangles += obj.mesh.triangles.length;
-          totalVertices += obj.mesh.vertices.length;
+          if (obj.visible === false || this.isBatchCulled(obj)) continue;
 
           // Compute MVP matrix
           const modelMatrix = obj.transform.matrix;
           const mvpMatrix = Matrix4.multiply(viewProjection, modelMatrix);
 
-          // Extract mesh data for native renderer (including UVs)
-          const { vertices, indices, colors, normals, uvs } = this.extractMeshData(obj.mesh);
+          // Resident native mesh (uploaded on first draw, then drawn by handle)
+          commands.bindMesh(this.getNativeMeshHandle(obj.mesh));
+          commands.setMVP(mvpMatrix.elements);
+
+          totalTriangles += obj.mesh.triangles.length;
+          totalVertices += obj.mesh.vertices.length;
 
-          // Set texture for this mesh if available
+          // Resident texture for this mesh if available (the native side groups draws by texture)
           const texture = obj.mesh.material?.texture;
-          if (texture && this.rasterizer.enableTextures) {
-            this.nativeRenderer.setTexture(texture.getRawRGB(), texture.width, texture.height);
-          } else {
-            this.nativeRenderer.setTexture(null, 0, 0);
-          }
+          commands.bindTexture(texture && this.rasterizer.enableTextures ? this.getNativeTextureId(texture) : 0);
+
+          // Baked lighting replaces per-face lighting for meshes with lightmap UVs
+          const lightmap = obj.mesh.material?.lightmap;
+          commands.bindLightmap(lightmap ? this.getNativeTextureId(lightmap) : 0);
 
-          // Convert MVP matrix to column-major Float32Array
-          const mvpArray = new Float32Array(mvpMatrix.elements);
+          // Occluded objects are skipped natively against hi-Z
+          commands.draw();
 
-          // Render via native SIMD
-          this.nativeRenderer.renderTrianglesBatch(vertices, indices, mvpArray, colors, normals, uvs);
+          // Rasterize large occluders (map geometry) now so hi-Z can reject what follows
+          if (obj.mesh.triangles.length >= Renderer.NATIVE_OCCLUDER_TRIANGLES) {
+            commands.flush();
+          }
         }
 
         // Resolve MSAA in native renderer
         if (this.msaaMode !== 'none') {
-          this.nativeRenderer.resolveMSAA();
+          commands.resolveMSAA();
+        }
+
+        const submitStart = performance.now();
+        visibleObjects = Math.max(0, this.nativeRenderer.submit(commands));
+        // Recorded frames report their time from the render thread instead (onNativeFrame)
+        if (!this.recordingNativeFrame) {
+          this.updateRenderScale(performance.now() - submitStart);
+        }
+
+        // Evicted textures drew untextured this frame; re-upload them for the next one
+        if (commands.missingTextures > 0) {
+          this.reuploadEvictedTextures();
+        } else {
+          this.nativeTextureMissFrames = 0;
         }
 
         // Copy native framebuffer to JS framebuffer for overlays and output
-        this.copyNativeFramebufferToJS();
+        // (not needed when the frame is composed natively)
+        if (!this.composeNatively) {
+          const copyStart = performance.now();
+          this.copyNativeFramebufferToJS();
+          this.nativeRenderer.recordProfileEvent(ProfileStage.JSCopy, performance.now() - copyStart);
+        }
       } else {
         // JavaScript rendering path (fallback)
         for (const obj of this.objects) {
-          if (obj.visible === false) continue;
+          if (obj.visible === false || this.isBatchCulled(obj)) continue;
 
           visibleObjects++;
           totalTriangles += obj.mesh.triangles.length;
@@ -703,6 +1067,11 @@ export class Renderer {
 
       // Render bullet tracers - drawn on top of resolved 3D scene
       this.renderTracers(viewProjection);
+
+      // Depth-test queued overlay cells against the native depth buffer
+      if (this.composeNatively) {
+        this.nativeRenderer!.flushGlyphs();
+      }
     }
 
     // Only draw game HUD elements when not in full-screen UI
@@ -769,20 +1138,21 @@ export class Renderer {
     // Only force basic for full-screen UI (menu/browser/lobby) where framebuffer is resized to terminal dims
     // In-game overlays (freeze time, scoreboard, buy menu, console) work fine with halfblock output
     const effectiveMode = isFullScreenUI ? 'basic' : this.renderMode;
+    if (effectiveMode !== this.lastOutputMode) {
+      this.invalidateOutput();
+      this.lastOutputMode = effectiveMode;
+    }
 
     // Output to terminal based on render mode
+    const outputStart = performance.now();
     let outputString: string;
     switch (effectiveMode) {
       case 'halfblock':
-        outputString = this.framebuffer.toHalfBlockAnsiString();
-        process.stdout.write(outputString);
+        this.writeHalfBlockOutput();
         break;
       case 'sixel':
-        // Sixel uses differential rendering internally (returns empty if unchanged)
-        outputString = this.framebuffer.toScaledSixelString(this.sixelOutputScale);
-        if (outputString.length > 0) {
-          this.writeOutputAsync(outputString);
-        }
+        // Sixel uses differential rendering (nothing written if unchanged)
+        this.writeSixelOutput();
         break;
       case 'basic':
       default:
@@ -801,6 +1171,8 @@ export class Renderer {
     // Calculate timing
     const endTime = performance.now();
     const frameTime = endTime - startTime;
+    this.nativeRenderer?.recordProfileEvent(ProfileStage.JSOutput, endTime - outputStart);
+    this.nativeRenderer?.recordProfileEvent(ProfileStage.JSFrame, frameTime);
     this.lastFrameTime = frameTime;
     this.frameCount++;
 
@@ -833,6 +1205,18 @@ export class Renderer {
       `Res: ${this.width}x${this.height}`
     ];
 
+    const dynamic = this.resolutionController?.scale;
+    if (dynamic && this.isUsingNativeRenderer()) {
+      lines.push(`Scale: ${Math.round(dynamic.scale * 100)}% ${dynamic.msaaSamples}x`);
+    }
+
+    // Terminal bandwidth of the last native-encoded frame
+    const encodeStats = this.nativeRenderer?.getEncodeStats();
+    if (encodeStats && encodeStats.frames > 0) {
+      const saved = encodeStats.lastFullBytes > 0 ? 100 * (1 - encodeStats.lastBytes / encodeStats.lastFullBytes) : 0;
+      lines.push(`Out: ${(encodeStats.lastBytes / 1024).toFixed(1)}KB (-${saved.toFixed(0)}%)`);
+    }
+
     for (let i = 0; i < lines.length; i++) {
       this.framebuffer.drawText(1, 1 + i, lines[i], fg, bg);
     }
@@ -1089,6 +1473,18 @@ export class Renderer {
     return this.decalPool;
   }
 
+  // Draw one world-overlay cell (decal, billboard, tracer), depth-tested like
+  // DepthBuffer.testAndSet() unless depth is NaN. When composing natively the
+  // cell is queued for the native glyph layer and tested against native depth.
+  private drawOverlayCell(x: number, y: number, depth: number, char: string, fg: Color, bg: Color): void {
+    if (this.composeNatively) {
+      this.nativeRenderer!.queueGlyph(x, y, depth, char.charCodeAt(0), fg.toRGB24(), bg.toRGB24());
+      return;
+    }
+    if (!Number.isNaN(depth) && !this.depthBuffer.testAndSet(x, y, depth)) return;
+    this.framebuffer.setPixel(x, y, char, fg, bg);
+  }
+
   // Render all active decals as 3D points
   private renderDecals(viewProjection: Matrix4): void {
     const decals = this.decalPool.getActiveDecals();
@@ -1120,14 +1516,11 @@ export class Renderer {
       // Clamp to screen bounds
       if (screenX < 0 || screenX >= this.width || screenY < 0 || screenY >= this.height) continue;
 
-      // Depth test
-      if (!this.depthBuffer.testAndSet(screenX, screenY, ndc.z)) continue;
-
       // Choose character based on distance
       const char = distance > 15 ? '·' : distance > 8 ? '•' : '○';
 
-      // Draw the decal
-      this.framebuffer.setPixel(screenX, screenY, char, decal.color, new Color(0, 0, 0, 0));
+      // Draw the decal (depth-tested)
+      this.drawOverlayCell(screenX, screenY, ndc.z, char, decal.color, Renderer.TRANSPARENT);
     }
   }
 
@@ -1211,7 +1604,7 @@ export class Renderer {
         Math.floor(255 * intensity * 0.9),
         Math.floor(150 * intensity)
       );
-      this.framebuffer.setPixel(x, y, coreChar, coreColor, new Color(0, 0, 0, 0));
+      this.drawOverlayCell(x, y, NaN, coreChar, coreColor, Renderer.TRANSPARENT);
 
       // Add glow effect - draw dimmer pixels adjacent to the main line
       // Only for high-intensity parts (near the tip)
@@ -1227,12 +1620,12 @@ export class Renderer {
         // Perpendicular glow (thickens the line)
         if (Math.abs(dx) > Math.abs(dy)) {
           // More horizontal - add glow above/below
-          if (y - 1 >= 0) this.framebuffer.setPixel(x, y - 1, glowChar, glowColor, new Color(0, 0, 0, 0));
-          if (y + 1 < this.height) this.framebuffer.setPixel(x, y + 1, glowChar, glowColor, new Color(0, 0, 0, 0));
+          if (y - 1 >= 0) this.drawOverlayCell(x, y - 1, NaN, glowChar, glowColor, Renderer.TRANSPARENT);
+          if (y + 1 < this.height) this.drawOverlayCell(x, y + 1, NaN, glowChar, glowColor, Renderer.TRANSPARENT);
         } else {
           // More vertical - add glow left/right
-          if (x - 1 >= 0) this.framebuffer.setPixel(x - 1, y, glowChar, glowColor, new Color(0, 0, 0, 0));
-          if (x + 1 < this.width) this.framebuffer.setPixel(x + 1, y, glowChar, glowColor, new Color(0, 0, 0, 0));
+          if (x - 1 >= 0) this.drawOverlayCell(x - 1, y, NaN, glowChar, glowColor, Renderer.TRANSPARENT);
+          if (x + 1 < this.width) this.drawOverlayCell(x + 1, y, NaN, glowChar, glowColor, Renderer.TRANSPARENT);
         }
       }
     }
@@ -1360,9 +1753,6 @@ export class Renderer {
       // Draw filled hitbox rectangle
       for (let y = minY; y <= maxY; y++) {
         for (let x = minX; x <= maxX; x++) {
-          // Depth test
-          if (!this.depthBuffer.testAndSet(x, y, depth)) continue;
-
           // Check if on border (outline)
           const isOutline = x === minX || x === maxX || y === minY || y === maxY;
 
@@ -1392,7 +1782,8 @@ export class Renderer {
             color = bodyColor;
           }
 
-          this.framebuffer.setPixel(x, y, char, color, new Color(0, 0, 0, 0));
+          // Depth-tested against the scene and earlier bots
+          this.drawOverlayCell(x, y, depth, char, color, Renderer.TRANSPARENT);
         }
       }
 
@@ -1402,7 +1793,10 @@ export class Renderer {
         if (nameY >= 0) {
           const name = bot.name.substring(0, 12);
           const nameX = Math.floor((minX + maxX) / 2) - Math.floor(name.length / 2);
-          this.framebuffer.drawText(nameX, nameY, name, Color.white(), new Color(0, 0, 0, 0.7));
+          const nameBg = new Color(0, 0, 0, 0.7);
+          for (let i = 0; i < name.length; i++) {
+            this.drawOverlayCell(nameX + i, nameY, NaN, name[i], Color.white(), nameBg);
+          }
         }
       }
 
@@ -1426,7 +1820,7 @@ export class Renderer {
                 ? new Color(255, 255, 100)
                 : new Color(255, 100, 100);
 
-            this.framebuffer.setPixel(x, barY, char, barColor, new Color(0, 0, 0, 0));
+            this.drawOverlayCell(x, barY, NaN, char, barColor, Renderer.TRANSPARENT);
           }
         }
       }
@@ -1727,9 +2121,16 @@ export class Renderer {
       const redIntensity = Math.floor(80 * this.deathFadeToRed);
       const overlayColor = new Color(redIntensity, 0, 0, this.deathFadeToRed * 0.6);
 
+      // Native scene pixels are solid (fg unused); tint the glyph layer there
+      // and only the HUD cells drawn into the JS framebuffer this frame
+      if (this.composeNatively) {
+        this.nativeRenderer!.tintGlyphs(180, 20, 20, this.deathFadeToRed * 0.5);
+      }
+
       // Apply red tint to entire screen
       for (let y = 0; y < this.height; y++) {
         for (let x = 0; x < this.width; x++) {
+          if (!this.framebuffer.isTouched(x, y)) continue;
           const existingPixel = this.framebuffer.getPixel(x, y);
           if (existingPixel) {
             // Blend existing color with red overlay
@@ -2708,14 +3109,10 @@ export class Renderer {
     let outputString: string;
     switch (this.renderMode) {
       case 'halfblock':
-        outputString = this.framebuffer.toHalfBlockAnsiString();
-        process.stdout.write(outputString);
+        this.writeHalfBlockOutput();
         break;
       case 'sixel':
-        outputString = this.framebuffer.toScaledSixelString(this.sixelOutputScale);
-        if (outputString.length > 0) {
-          this.writeOutputAsync(outputString);
-        }
+        this.writeSixelOutput();
         break;
       case 'basic':
       default:
@@ -2746,6 +3143,7 @@ export class Renderer {
 
     // Get camera matrices
     const viewProjection = this.camera.viewProjectionMatrix;
+    this.cullVisibleBatches(viewProjection);
 
     let totalTriangles = 0;
     let totalVertices = 0;
@@ -2753,7 +3151,7 @@ export class Renderer {
 
     // Render all objects
     for (const obj of this.objects) {
-      if (obj.visible === false) continue;
+      if (obj.visible === false || this.isBatchCulled(obj)) continue;
 
       visibleObjects++;
       totalTriangles += obj.mesh.triangles.length;
@@ -2850,6 +3248,7 @@ export class Renderer {
     colors: Uint8Array;
     normals: Float32Array;
     uvs: Float32Array;
+    lightmapUvs: Float32Array | null;
   } {
     const vertCount = mesh.vertices.length;
     const triCount = mesh.triangles.length;
@@ -2885,6 +3284,19 @@ export class Renderer {
       }
     }
 
+    // Lightmap UVs: only when the material has a baked lightmap atlas
+    let lightmapUvs: Float32Array | null = null;
+    if (mesh.material?.lightmap) {
+      lightmapUvs = new Float32Array(vertCount * 2);
+      for (let i = 0; i < vertCount; i++) {
+        const lm = mesh.vertices[i].lightmapUv;
+        if (lm) {
+          lightmapUvs[i * 2] = lm[0];
+          lightmapUvs[i * 2 + 1] = lm[1];
+        }
+      }
+    }
+
     // Indices: 3 per triangle
     const indices = new Uint32Array(triCount * 3);
     for (let i = 0; i < triCount; i++) {
@@ -2903,7 +3315,81 @@ export class Renderer {
       colors[i * 3 + 2] = meshColor.b;
     }
 
-    return { vertices, indices, colors, normals, uvs };
+    return { vertices, indices, colors, normals, uvs, lightmapUvs };
+  }
+
+  // Get (or create) the resident native handle for a mesh
+  private getNativeMeshHandle(mesh: Mesh): number {
+    let handle = this.nativeMeshHandles.get(mesh);
+    if (handle === undefined) {
+      const { vertices, indices, colors, normals, uvs, lightmapUvs } = this.extractMeshData(mesh);
+      handle = this.nativeRenderer!.createMesh(vertices, indices, colors, normals, uvs, lightmapUvs);
+      this.nativeMeshHandles.set(mesh, handle);
+    }
+    return handle;
+  }
+
+  // Free the native copy of a mesh (no-op if it was never uploaded)
+  private releaseNativeMesh(mesh: Mesh): void {
+    const handle = this.nativeMeshHandles.get(mesh);
+    if (handle !== undefined) {
+      this.nativeRenderer?.destroyMesh(handle);
+      this.nativeMeshHandles.delete(mesh);
+    }
+  }
+
+  // Resident native texture id, uploading the texture on first use
+  private getNativeTextureId(texture: Texture): number {
+    let id = this.nativeTextureIds.get(texture);
+    if (id === undefined) {
+      id = this.nativeRenderer!.uploadTexture(texture.getRawRGB(), texture.width, texture.height);
+      this.nativeTextureIds.set(texture, id);
+    }
+    return id;
+  }
+
+  // Re-upload the textures this frame drew that the native pool evicted to stay within its budget.
+  // At most NATIVE_TEXTURE_REUPLOAD_BYTES go up per frame. If the frame keeps missing textures
+  // after they were all re-uploaded, its textures don't fit the budget and re-uploading would
+  // just evict them again every frame, so the budget is doubled (see getDebugStats().textureBudgetBytes).
+  private reuploadEvictedTextures(): void {
+    let uploadedBytes = 0;
+    for (const obj of this.objects) {
+      if (obj.visible === false || this.isBatchCulled(obj)) continue;
+      const texture = obj.mesh.material?.texture;
+      if (texture && this.rasterizer.enableTextures) uploadedBytes += this.bindNativeTexture(texture);
+      const lightmap = obj.mesh.material?.lightmap;
+      if (lightmap) uploadedBytes += this.bindNativeTexture(lightmap);
+      if (uploadedBytes >= Renderer.NATIVE_TEXTURE_REUPLOAD_BYTES) {
+        // Still catching up: the misses next frame are expected
+        this.nativeTextureMissFrames = 0;
+        return;
+      }
+    }
+
+    if (++this.nativeTextureMissFrames < Renderer.NATIVE_TEXTURE_THRASH_FRAMES) return;
+    this.nativeTextureMissFrames = 0;
+    const budget = this.nativeRenderer!.getDebugStats()?.textureBudgetBytes ?? 0;
+    if (budget > 0 && budget < Renderer.NATIVE_TEXTURE_BUDGET_MAX) {
+      this.nativeRenderer!.setTextureBudget(Math.min(Renderer.NATIVE_TEXTURE_BUDGET_MAX, budget * 2));
+    }
+  }
+
+  // Bind a texture from the native resident pool, uploading it on first use or after eviction.
+  // Returns the bytes uploaded (0 if it was resident).
+  private bindNativeTexture(texture: Texture): number {
+    const renderer = this.nativeRenderer!;
+    const id = this.nativeTextureIds.get(texture);
+    if (id !== undefined && renderer.bindTexture(id)) return 0;
+
+    if (id !== undefined) {
+      renderer.destroyTexture(id);
+    }
+    const data = texture.getRawRGB();
+    const newId = renderer.uploadTexture(data, texture.width, texture.height);
+    this.nativeTextureIds.set(texture, newId);
+    renderer.bindTexture(newId);
+    return data.length;
   }
 
   // Copy native framebuffer RGB data to JS Framebuffer for overlays and output
@@ -2916,15 +3402,21 @@ export class Renderer {
     const w = this.width;
     const h = this.height;
 
+    // Per-pixel colors owned by this copy, reused every frame (no allocation)
+    if (this.nativePixelColors.length !== w * h) {
+      this.nativePixelColors = Array.from({ length: w * h }, () => new Color());
+    }
+
     // Copy RGB data to framebuffer
     for (let y = 0; y < h; y++) {
       for (let x = 0; x < w; x++) {
-        const idx = (y * w + x) * 3;
-        const r = fb[idx];
-        const g = fb[idx + 1];
-        const b = fb[idx + 2];
+        const i = y * w + x;
+        const color = this.nativePixelColors[i];
+        color.r = fb[i * 3];
+        color.g = fb[i * 3 + 1];
+        color.b = fb[i * 3 + 2];
         // Set pixel with full block char and the color
-        this.framebuffer.setPixel(x, y, '█', new Color(r, g, b), new Color(r, g, b));
+        this.framebuffer.setPixel(x, y, '█', color, color);
       }
     }
 
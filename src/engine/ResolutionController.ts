@@ -0,0 +1,101 @@
+// ResolutionController - Dynamic resolution and adaptive MSAA
+//
+// Holds the native renderer's frame cost near a target by lowering the
+// scene resolution below the output grid and dropping MSAA samples, then
+// restoring them when there is headroom. Over budget it sheds MSAA first
+// (samples multiply raster cost), then resolution; under budget it restores
+// resolution first, then MSAA up to the user's MSAA setting. Frame times are
+// smoothed and every change is followed by a cooldown so the scale does not
+// oscillate between two steps.
+
+export interface RenderScale {
+  scale: number;        // Scene size / output size, per axis
+  msaaSamples: number;  // 1, 4 or 16
+}
+
+const MSAA_STEPS = [1, 4, 16];
+
+export class ResolutionController {
+  static readonly MIN_SCALE = 0.5;
+  static readonly SCALE_STEP = 0.1;
+
+  private static readonly SMOOTHING = 0.15;     // EWMA weight of the newest frame
+  private static readonly OVER_BUDGET = 1.05;   // Step down above target * this
+  private static readonly UNDER_BUDGET = 0.7;   // Step up below target * this
+  private static readonly COOLDOWN_FRAMES = 12; // Frames to let the average settle after a change
+
+  private average: number = 0;
+  private cooldown: number = 0;
+  private current: RenderScale;
+
+  constructor(private targetMs: number, private maxSamples: number) {
+    this.current = { scale: 1, msaaSamples: maxSamples };
+  }
+
+  get target(): number {
+    return this.targetMs;
+  }
+
+  get scale(): RenderScale {
+    return { ...this.current };
+  }
+
+  setTarget(ms: number): void {
+    this.targetMs = ms;
+    this.cooldown = 0;
+  }
+
+  // New MSAA ceiling (the user's setting); starts again from full quality
+  setMaxSamples(samples: number): void {
+    this.maxSamples = samples;
+    this.reset();
+  }
+
+  reset(): void {
+    this.current = { scale: 1, msaaSamples: this.maxSamples };
+    this.average = 0;
+    this.cooldown = ResolutionController.COOLDOWN_FRAMES;
+  }
+
+  /**
+   * Feed one frame's render time (ms).
+   * @returns true if the scale or sample count changed
+   */
+  update(frameMs: number): boolean {
+    if (!(frameMs >= 0)) return false;
+    this.average = this.average > 0
+      ? this.average + (frameMs - this.average) * ResolutionController.SMOOTHING
+      : frameMs;
+
+    if (this.cooldown > 0) {
+      this.cooldown--;
+      return false;
+    }
+
+    const next = { ...this.current };
+    const step = MSAA_STEPS.indexOf(next.msaaSamples);
+    if (this.average > this.targetMs * ResolutionController.OVER_BUDGET) {
+      if (step > 0) {
+        next.msaaSamples = MSAA_STEPS[step - 1];
+      } else {
+        next.scale = Math.max(ResolutionController.MIN_SCALE, next.scale - ResolutionController.SCALE_STEP);
+      }
+    } else if (this.average < this.targetMs * ResolutionController.UNDER_BUDGET) {
+      if (next.scale < 1) {
+        next.scale = Math.min(1, next.scale + ResolutionController.SCALE_STEP);
+      } else if (step + 1 < MSAA_STEPS.length && MSAA_STEPS[step + 1] <= this.maxSamples) {
+        next.msaaSamples = MSAA_STEPS[step + 1];
+      }
+    }
+
+    // Round so repeated steps land exactly on 1
+    next.scale = Math.round(next.scale * 100) / 100;
+    if (next.scale === this.current.scale && next.msaaSamples === this.current.msaaSamples) return false;
+
+    this.current = next;
+    this.cooldown = ResolutionController.COOLDOWN_FRAMES;
+    // Reseed the average from the new setting's frames
+    this.average = 0;
+    return true;
+  }
+}
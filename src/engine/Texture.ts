@@ -7,13 +7,27 @@ export class Texture {
   public readonly name: string;
   public readonly width: number;
   public readonly height: number;
-  private pixels: Color[];
+  private decoded: Color[] | null;
+  private raw: Uint8Array | null = null;  // Row-major RGB, when created from bytes
 
   constructor(name: string, width: number, height: number, pixels: Color[]) {
     this.name = name;
     this.width = width;
     this.height = height;
-    this.pixels = pixels;
+    this.decoded = pixels;
+  }
+
+  // Color texels, expanded from the RGB bytes on first JS-side sample
+  private get pixels(): Color[] {
+    if (!this.decoded) {
+      const data = this.raw!;
+      const pixels: Color[] = new Array(this.width * this.height);
+      for (let i = 0; i < pixels.length; i++) {
+        pixels[i] = new Color(data[i * 3], data[i * 3 + 1], data[i * 3 + 2]);
+      }
+      this.decoded = pixels;
+    }
+    return this.decoded;
   }
 
   // Sample texture at UV coordinates (0-1 range, wrapping)
@@ -176,6 +190,16 @@ export class Texture {
     return new Texture(mipTex.name, mipTex.width, mipTex.height, pixels);
   }
 
+  // Create texture from row-major RGB bytes (e.g. generated lightmap atlases, map caches)
+  // The bytes are kept as-is: the native renderer uploads them directly and
+  // Color texels are only built if the JS rasterizer samples the texture.
+  static fromRGB(name: string, width: number, height: number, data: Uint8Array): Texture {
+    const texture = new Texture(name, width, height, []);
+    texture.decoded = null;
+    texture.raw = data.subarray(0, width * height * 3);
+    return texture;
+  }
+
   // Create solid color texture (for fallback/debug)
   static solid(name: string, color: Color, width: number = 16, height: number = 16): Texture {
     const pixels: Color[] = [];
@@ -207,6 +231,7 @@ export class Texture {
 
   // Get raw RGB data as Uint8Array (for native renderer)
   getRawRGB(): Uint8Array {
+    if (this.raw) return this.raw;
     const data = new Uint8Array(this.width * this.height * 3);
     for (let i = 0; i < this.pixels.length; i++) {
       const pixel = this.pixels[i];
@@ -1,11 +1,14 @@
 #!/usr/bin/env node
 import React, { useState, useEffect, useRef } from 'react';
+import { writeFileSync } from 'fs';
 import { render, useApp, useStdout } from 'ink';
 import { Renderer, RenderObject } from './engine/Renderer.js';
 import { Camera } from './engine/Camera.js';
 import { Mesh } from './engine/Mesh.js';
 import { Transform } from './engine/Transform.js';
 import { Vector3 } from './engine/math/Vector3.js';
+import { CameraPathRecorder, saveCameraPath } from './engine/CameraPath.js';
+import { getNativeJobStats } from './engine/NativeJobs.js';
 import { Color, Materials, CURSOR_HIDE, CURSOR_SHOW, ALT_SCREEN_ON, ALT_SCREEN_OFF, RESET } from './utils/Colors.js';
 import { degToRad } from './engine/math/MathUtils.js';
 import { MouseHandler } from './input/MouseHandler.js';
@@ -723,6 +726,7 @@ async function runMapDebugMode(mapId: string, initialRenderMode: RenderMode, ini
   for (const obj of loadedMap.renderObjects) {
     renderer.addObject(obj);
   }
+  renderer.setVisibility(loadedMap.visibility ?? null);
 
   // Camera setup - start at first spawn
   const camera = renderer.getCamera();
@@ -1169,6 +1173,9 @@ function Game({ initialRenderMode = 'halfblock', initialMSAAMode = '4x' }: GameP
   const loadedMapRef = useRef<LoadedMap>(MapLoader.load(dm_arena));
   const currentMapIdRef = useRef<string>('dm_arena');
 
+  // Camera flight being recorded for the renderer benchmark (campath command)
+  const cameraPathRecorderRef = useRef<CameraPathRecorder | null>(null);
+
   // Colliders ref for physics
   const collidersRef = useRef<AABB[]>(loadedMapRef.current.colliders);
 
@@ -1201,6 +1208,7 @@ function Game({ initialRenderMode = 'halfblock', initialMSAAMode = '4x' }: GameP
       for (const obj of newMap.renderObjects) {
         renderer.addObject(obj);
       }
+      renderer.setVisibility(newMap.visibility ?? null);
 
       // Update sky and lighting
       renderer.setClearColor(newMap.skyColor);
@@ -1263,6 +1271,7 @@ function Game({ initialRenderMode = 'halfblock', initialMSAAMode = '4x' }: GameP
     for (const obj of scene) {
       renderer.addObject(obj);
     }
+    renderer.setVisibility(loadedMapRef.current.visibility ?? null);
     renderer.showStats = true;
 
     // Set sky color from map
@@ -1439,6 +1448,83 @@ function Game({ initialRenderMode = 'halfblock', initialMSAAMode = '4x' }: GameP
       return bots.map(b => `${b.name}: ${b.health}hp, ${b.kills}K/${b.deaths}D`).join('\n');
     });
 
+    gameConsole.registerCommand('prof', (args) => {
+      const usage = 'Usage: prof <on|off|stats [frames]|trace [file] [frames]>';
+      switch (args[0]) {
+        case 'on':
+        case 'off':
+          if (!renderer.setProfiling(args[0] === 'on')) return 'Profiler needs the native renderer';
+          return `Profiler: ${args[0].toUpperCase()}`;
+        case 'stats': {
+          const stats = renderer.getProfileStats(args[1] ? parseInt(args[1]) : undefined);
+          if (!stats) return 'Profiler needs the native renderer';
+          if (stats.frames === 0) return 'No profiled frames (prof on)';
+          const rows = stats.stages
+            .filter(s => s.max > 0)
+            .map(s => `${s.name.padEnd(13)} p50 ${s.p50.toFixed(2).padStart(7)}  p99 ${s.p99.toFixed(2).padStart(7)}  max ${s.max.toFixed(2).padStart(7)} ms`);
+          const jobs = getNativeJobStats();
+          if (jobs) {
+            rows.push(`Jobs: ${jobs.workers} workers on ${jobs.physicalCores} cores${jobs.pinned ? ' (pinned)' : ''}, ${jobs.jobs} split / ${jobs.inlineJobs} inline`);
+          }
+          return [`Last ${stats.frames} frames:`, ...rows].join('\n');
+        }
+        case 'trace': {
+          const trace = renderer.getProfileTrace(args[2] ? parseInt(args[2]) : undefined);
+          if (!trace) return 'Profiler needs the native renderer';
+          const file = args[1] || `csterm-trace-${Date.now()}.json`;
+          try {
+            writeFileSync(file, trace);
+          } catch (error) {
+            return `Failed to write ${file}: ${error}`;
+          }
+          return `Trace written to ${file} (open in chrome://tracing or ui.perfetto.dev)`;
+        }
+        default:
+          return usage;
+      }
+    });
+
+    gameConsole.registerCommand('dynres', (args) => {
+      if (args.length === 0) {
+        const dynamic = renderer.getDynamicResolution();
+        if (!dynamic) return 'Dynamic resolution: OFF';
+        return `Dynamic resolution: ${dynamic.targetMs}ms target, scene at ${Math.round(dynamic.scale * 100)}%, ${dynamic.msaaSamples}x MSAA`;
+      }
+      if (args[0] === 'off') {
+        renderer.setDynamicResolution(0);
+        return 'Dynamic resolution: OFF';
+      }
+      const target = parseFloat(args[0]);
+      if (isNaN(target) || target <= 0 || target > 1000) {
+        return 'Usage: dynres <target ms|off>';
+      }
+      if (!renderer.isUsingNativeRenderer()) {
+        return 'Dynamic resolution needs the native renderer';
+      }
+      renderer.setDynamicResolution(target);
+      return `Dynamic resolution: ${target}ms target`;
+    });
+
+    gameConsole.registerCommand('campath', (args) => {
+      if (args[0] === 'record') {
+        cameraPathRecorderRef.current = new CameraPathRecorder(currentMapIdRef.current);
+        return `Recording camera path on ${currentMapIdRef.current} (campath stop [file] to save)`;
+      }
+      if (args[0] === 'stop') {
+        const recorder = cameraPathRecorderRef.current;
+        if (!recorder) return 'Not recording';
+        cameraPathRecorderRef.current = null;
+        if (recorder.sampleCount < 2) return 'Camera path too short, discarded';
+        try {
+          const file = saveCameraPath(recorder.finish(), args[1]);
+          return `Saved ${recorder.sampleCount} samples to ${file}`;
+        } catch (error) {
+          return `Failed to save camera path: ${error}`;
+        }
+      }
+      return 'Usage: campath <record|stop [file]>';
+    });
+
     // Log startup message
     consoleLog('CS-CLI v0.1.0 - Type "help" for commands');
 
@@ -1841,7 +1927,8 @@ function Game({ initialRenderMode = 'halfblock', initialMSAAMode = '4x' }: GameP
               // Update voice spatial positions
               if (voiceManagerRef.current) {
                 for (const player of state.players) {
-                  if (player.id !== localId) {
+                  // Dormant (culled) players keep their last known position
+                  if (player.id !== localId && !player.dormant) {
                     voiceManagerRef.current.updatePlayerPosition(
                       player.id,
                       new Vector3(player.position.x, player.position.y, player.position.z)
@@ -1922,6 +2009,17 @@ function Game({ initialRenderMode = 'halfblock', initialMSAAMode = '4x' }: GameP
             // Phase changes
             onPhaseChange: (phase, roundNumber, tScore, ctScore) => {
               consoleLog(`Phase: ${phase}, Round ${roundNumber} (T: ${tScore}, CT: ${ctScore})`);
+              // The server ended the game (e.g. it lost the room's worker): back to the lobby
+              if (phase === 'pre_match' && appModeRef.current === 'playing' && isMultiplayerRef.current) {
+                mpState.deactivate();
+                mouseHandler.release();
+                mouseHandler.setAllowClickCapture(false);
+                appModeRef.current = 'lobby';
+                renderer.setLobbyScreen(lobbyScreen, true);
+              }
+            },
+            onChatReceived: (_senderId, senderName, message) => {
+              consoleLog(`${senderName}: ${message}`);
             },
             // Game starting from lobby
             onGameStarting: async (countdown) => {
@@ -2194,6 +2292,9 @@ function Game({ initialRenderMode = 'halfblock', initialMSAAMode = '4x' }: GameP
       }
     };
 
+    // Synthesize the sound effects now rather than on the first shot of a match
+    getSoundEngine().preload();
+
     // Enable mouse tracking (user must click to capture)
     mouseHandler.enable();
 
@@ -2853,6 +2954,7 @@ function Game({ initialRenderMode = 'halfblock', initialMSAAMode = '4x' }: GameP
 
       // Render
       const stats = renderer.render();
+      cameraPathRecorderRef.current?.sample(camera);
 
       // Update React state (for any React-based UI elements)
       setGameState({
@@ -1,5 +1,11 @@
-// Native keyboard input using CGEventTap on macOS
+// Native keyboard input using CGEventTap on macOS or evdev on Linux
 // Falls back to stdin-based input if native module unavailable
+//
+// Both backends report macOS virtual key codes. The native input thread
+// queues timestamped events in a lock-free ring. Once per frame (on the first
+// query after update) everything is drained with a single drainInput() call;
+// all key, button and mouse queries then read the JS-side snapshot without
+// crossing into native code.
 
 // ESM-compatible imports for native module loading
 import { createRequire } from 'module';
@@ -11,7 +17,7 @@ const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
 const require = createRequire(import.meta.url);
 
-// macOS virtual key codes
+// macOS virtual key codes (the Linux backend translates evdev codes to these)
 export const MacKeyCode = {
   // Letters
   A: 0, S: 1, D: 2, F: 3, H: 4, G: 5, Z: 6, X: 7, C: 8, V: 9,
@@ -88,21 +94,31 @@ export const GameKeyMap = {
 
 export type GameKeyName = keyof typeof GameKeyMap;
 
+// Input event types (match INPUT_EVENT_* in keyboard_mac.c / keyboard_linux.c)
+export const INPUT_EVENT_KEY = 1;     // code = keycode, value = 1 down / 0 up
+export const INPUT_EVENT_BUTTON = 2;  // code = button, value = 1 down / 0 up
+export const INPUT_EVENT_MOTION = 3;  // code = dx, value = dy (1/256 pixel units)
+export const INPUT_MOTION_SCALE = 256;
+
+// drainInput() buffer layout
+const DRAIN_COUNT = 0;
+const DRAIN_DROPPED = 1;
+const DRAIN_KEYS = 2;       // 8 words of key state bits
+const DRAIN_BUTTONS = 10;
+export const DRAIN_HEADER_SIZE = 12;
+export const DRAIN_EVENT_STRIDE = 4;  // type, code, value, ageUs
+const DRAIN_MAX_EVENTS = 4096;
+
 // Native module interface
 interface NativeKeyboardModule {
   start(): boolean;
   stop(): boolean;
   // Keyboard
   isKeyDown(keycode: number): boolean;
-  wasKeyJustPressed(keycode: number): boolean;
-  wasKeyJustReleased(keycode: number): boolean;
-  update(): void;
+  drainInput(out: Int32Array): number;
   isRunning(): boolean;
   // Mouse
-  getMouseDelta(): { x: number; y: number };
   isMouseButtonDown(button: number): boolean;
-  wasMouseButtonJustPressed(button: number): boolean;
-  wasMouseButtonJustReleased(button: number): boolean;
   // Cursor capture
   setCursorCaptured(captured: boolean): boolean;
   isCursorCaptured(): boolean;
@@ -111,6 +127,69 @@ interface NativeKeyboardModule {
 let nativeModule: NativeKeyboardModule | null = null;
 let useNative = false;
 
+// Per-frame input snapshot, filled by drainNativeInput()
+const drainBuffer = new Int32Array(DRAIN_HEADER_SIZE + DRAIN_MAX_EVENTS * DRAIN_EVENT_STRIDE);
+const keyBits = new Uint32Array(8);
+const keyJustPressed = new Uint8Array(256);
+const keyJustReleased = new Uint8Array(256);
+let mouseButtonBits = 0;
+const mouseJustPressed = new Uint8Array(8);
+const mouseJustReleased = new Uint8Array(8);
+const frameMouseDelta = { x: 0, y: 0 };
+let frameEventCount = 0;
+let droppedEventCount = 0;
+let frameDrained = false;
+
+// Drain the native event ring into this frame's snapshot (once per frame)
+function drainNativeInput(): void {
+  if (frameDrained || !nativeModule) return;
+  frameDrained = true;
+
+  const count = nativeModule.drainInput(drainBuffer);
+  frameEventCount = count;
+  droppedEventCount += drainBuffer[DRAIN_DROPPED];
+
+  // Replay events against the previous state to find edges
+  for (let i = 0; i < count; i++) {
+    const base = DRAIN_HEADER_SIZE + i * DRAIN_EVENT_STRIDE;
+    const type = drainBuffer[base];
+    const code = drainBuffer[base + 1];
+    const value = drainBuffer[base + 2];
+
+    if (type === INPUT_EVENT_KEY && code >= 0 && code < 256) {
+      const word = code >> 5, bit = 1 << (code & 31);
+      const wasDown = (keyBits[word] & bit) !== 0;
+      if (value && !wasDown) keyJustPressed[code] = 1;
+      if (!value) keyJustReleased[code] = 1;
+      keyBits[word] = value ? keyBits[word] | bit : keyBits[word] & ~bit;
+    } else if (type === INPUT_EVENT_BUTTON && code >= 0 && code < 8) {
+      const bit = 1 << code;
+      if (value && !(mouseButtonBits & bit)) mouseJustPressed[code] = 1;
+      if (!value) mouseJustReleased[code] = 1;
+      mouseButtonBits = value ? mouseButtonBits | bit : mouseButtonBits & ~bit;
+    } else if (type === INPUT_EVENT_MOTION) {
+      frameMouseDelta.x += code / INPUT_MOTION_SCALE;
+      frameMouseDelta.y += value / INPUT_MOTION_SCALE;
+    }
+  }
+
+  // Native bitsets are authoritative (covers dropped events)
+  for (let i = 0; i < 8; i++) keyBits[i] = drainBuffer[DRAIN_KEYS + i] >>> 0;
+  mouseButtonBits = drainBuffer[DRAIN_BUTTONS];
+}
+
+// Clear the per-frame snapshot; the next query drains again
+function resetFrameInput(): void {
+  keyJustPressed.fill(0);
+  keyJustReleased.fill(0);
+  mouseJustPressed.fill(0);
+  mouseJustReleased.fill(0);
+  frameMouseDelta.x = 0;
+  frameMouseDelta.y = 0;
+  frameEventCount = 0;
+  frameDrained = false;
+}
+
 // Try to load native module
 export function initNativeKeyboard(): boolean {
   if (nativeModule) return useNative;
@@ -131,7 +210,9 @@ export function initNativeKeyboard(): boolean {
       useNative = true;
       return true;
     } else {
-      console.warn('Native keyboard failed to start (need accessibility permissions?)');
+      console.warn(process.platform === 'linux'
+        ? 'Native keyboard failed to start (need read access to /dev/input, e.g. the "input" group?)'
+        : 'Native keyboard failed to start (need accessibility permissions?)');
       return false;
     }
   } catch (e: any) {
@@ -144,6 +225,9 @@ export function stopNativeKeyboard(): void {
   if (nativeModule && useNative) {
     nativeModule.stop();
     useNative = false;
+    keyBits.fill(0);
+    mouseButtonBits = 0;
+    resetFrameInput();
   }
 }
 
@@ -157,29 +241,46 @@ export function getInputMode(): 'native' | 'stdin' {
 
 // Check if a key is currently held
 export function isKeyDown(keycode: number): boolean {
-  if (!useNative || !nativeModule) return false;
-  return nativeModule.isKeyDown(keycode);
+  if (!useNative || !nativeModule || keycode < 0 || keycode >= 256) return false;
+  drainNativeInput();
+  return (keyBits[keycode >> 5] & (1 << (keycode & 31))) !== 0;
 }
 
 // Check if a key was just pressed this frame
 export function wasKeyJustPressed(keycode: number): boolean {
-  if (!useNative || !nativeModule) return false;
-  return nativeModule.wasKeyJustPressed(keycode);
+  if (!useNative || !nativeModule || keycode < 0 || keycode >= 256) return false;
+  drainNativeInput();
+  return keyJustPressed[keycode] !== 0;
 }
 
 // Check if a key was just released this frame
 export function wasKeyJustReleased(keycode: number): boolean {
-  if (!useNative || !nativeModule) return false;
-  return nativeModule.wasKeyJustReleased(keycode);
+  if (!useNative || !nativeModule || keycode < 0 || keycode >= 256) return false;
+  drainNativeInput();
+  return keyJustReleased[keycode] !== 0;
 }
 
 // Clear just pressed/released flags (call once per frame)
 export function updateNativeKeyboard(): void {
   if (useNative && nativeModule) {
-    nativeModule.update();
+    resetFrameInput();
   }
 }
 
+// Raw events drained this frame, for sub-frame input handling.
+// Event i is at DRAIN_HEADER_SIZE + i * DRAIN_EVENT_STRIDE: type, code, value,
+// and age in microseconds before the drain. Valid until the next update.
+export function getNativeInputEvents(): { buffer: Int32Array; count: number } {
+  if (!useNative || !nativeModule) return { buffer: drainBuffer, count: 0 };
+  drainNativeInput();
+  return { buffer: drainBuffer, count: frameEventCount };
+}
+
+// Events lost to native ring overflow since startup
+export function getDroppedInputEventCount(): number {
+  return droppedEventCount;
+}
+
 // Convenience: check game key by name
 export function isGameKeyDown(key: GameKeyName): boolean {
   return isKeyDown(GameKeyMap[key]);
@@ -202,15 +303,15 @@ export function getMovementInput(): { forward: number; strafe: number; jump: boo
   let forward = 0;
   let strafe = 0;
 
-  if (nativeModule.isKeyDown(MacKeyCode.W)) forward += 1;
-  if (nativeModule.isKeyDown(MacKeyCode.S)) forward -= 1;
-  if (nativeModule.isKeyDown(MacKeyCode.A)) strafe -= 1;
-  if (nativeModule.isKeyDown(MacKeyCode.D)) strafe += 1;
+  if (isKeyDown(MacKeyCode.W)) forward += 1;
+  if (isKeyDown(MacKeyCode.S)) forward -= 1;
+  if (isKeyDown(MacKeyCode.A)) strafe -= 1;
+  if (isKeyDown(MacKeyCode.D)) strafe += 1;
 
   return {
     forward,
     strafe,
-    jump: nativeModule.isKeyDown(MacKeyCode.Space),
+    jump: isKeyDown(MacKeyCode.Space),
   };
 }
 
@@ -223,10 +324,10 @@ export function getLookInput(): { yaw: number; pitch: number } {
   let yaw = 0;
   let pitch = 0;
 
-  if (nativeModule.isKeyDown(MacKeyCode.Left)) yaw -= 1;
-  if (nativeModule.isKeyDown(MacKeyCode.Right)) yaw += 1;
-  if (nativeModule.isKeyDown(MacKeyCode.Up)) pitch += 1;
-  if (nativeModule.isKeyDown(MacKeyCode.Down)) pitch -= 1;
+  if (isKeyDown(MacKeyCode.Left)) yaw -= 1;
+  if (isKeyDown(MacKeyCode.Right)) yaw += 1;
+  if (isKeyDown(MacKeyCode.Up)) pitch += 1;
+  if (isKeyDown(MacKeyCode.Down)) pitch -= 1;
 
   return { yaw, pitch };
 }
@@ -235,11 +336,11 @@ export function getLookInput(): { yaw: number; pitch: number } {
 export function getWeaponSlotPressed(): number | null {
   if (!useNative || !nativeModule) return null;
 
-  if (nativeModule.wasKeyJustPressed(MacKeyCode.Num1)) return 1;
-  if (nativeModule.wasKeyJustPressed(MacKeyCode.Num2)) return 2;
-  if (nativeModule.wasKeyJustPressed(MacKeyCode.Num3)) return 3;
-  if (nativeModule.wasKeyJustPressed(MacKeyCode.Num4)) return 4;
-  if (nativeModule.wasKeyJustPressed(MacKeyCode.Num5)) return 5;
+  if (wasKeyJustPressed(MacKeyCode.Num1)) return 1;
+  if (wasKeyJustPressed(MacKeyCode.Num2)) return 2;
+  if (wasKeyJustPressed(MacKeyCode.Num3)) return 3;
+  if (wasKeyJustPressed(MacKeyCode.Num4)) return 4;
+  if (wasKeyJustPressed(MacKeyCode.Num5)) return 5;
 
   return null;
 }
@@ -265,25 +366,29 @@ export function getNativeMouseDelta(): { x: number; y: number } {
   if (!useNative || !nativeModule) {
     return { x: 0, y: 0 };
   }
-  return nativeModule.getMouseDelta();
+  drainNativeInput();
+  return { x: frameMouseDelta.x, y: frameMouseDelta.y };
 }
 
 // Check if mouse button is held
 export function isNativeMouseButtonDown(button: number): boolean {
-  if (!useNative || !nativeModule) return false;
-  return nativeModule.isMouseButtonDown(button);
+  if (!useNative || !nativeModule || button < 0 || button >= 8) return false;
+  drainNativeInput();
+  return (mouseButtonBits & (1 << button)) !== 0;
 }
 
 // Check if mouse button was just pressed
 export function wasNativeMouseButtonJustPressed(button: number): boolean {
-  if (!useNative || !nativeModule) return false;
-  return nativeModule.wasMouseButtonJustPressed(button);
+  if (!useNative || !nativeModule || button < 0 || button >= 8) return false;
+  drainNativeInput();
+  return mouseJustPressed[button] !== 0;
 }
 
 // Check if mouse button was just released
 export function wasNativeMouseButtonJustReleased(button: number): boolean {
-  if (!useNative || !nativeModule) return false;
-  return nativeModule.wasMouseButtonJustReleased(button);
+  if (!useNative || !nativeModule || button < 0 || button >= 8) return false;
+  drainNativeInput();
+  return mouseJustReleased[button] !== 0;
 }
 
 // Convenience: check mouse button by name
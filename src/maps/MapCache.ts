@@ -0,0 +1,460 @@
+// MapCache - Precompiled binary cache of loaded BSP maps
+//
+// A BSP load parses the .bsp and its WADs, expands palettized textures,
+// triangulates faces into meshes and builds the collision BVH. The cache keeps
+// the result of all that: vertex/index buffers, RGB texels (lightmap atlas
+// included), collision triangles, PVS data and the serialized native BVH, each
+// in a 64-byte aligned section. A load reads the file once and views the
+// sections in place; the bvh addon mmaps its section directly.
+//
+// Layout: 16-byte header (magic, version, metadata length, reserved), JSON
+// metadata, then the sections; section offsets are relative to the first
+// 64-byte boundary after the metadata.
+
+import { readFileSync, writeFileSync, statSync, mkdirSync, renameSync, existsSync } from 'fs';
+import { join, basename, resolve } from 'path';
+import { homedir } from 'os';
+import { createHash } from 'crypto';
+import { Mesh, Material, Vertex, Triangle } from '../engine/Mesh.js';
+import { Transform } from '../engine/Transform.js';
+import { Texture } from '../engine/Texture.js';
+import { getTextureManager } from '../engine/TextureManager.js';
+import { RenderObject } from '../engine/Renderer.js';
+import { Vector3 } from '../engine/math/Vector3.js';
+import { Color } from '../utils/Colors.js';
+import { AABB, SpawnPoint } from './MapFormat.js';
+import { CollisionMesh } from '../physics/MeshCollision.js';
+import { NativeBVH } from '../physics/NativeBVH.js';
+import { LoadedMap } from './MapLoader.js';
+
+const CACHE_MAGIC = 0x434d5343;  // "CSMC"
+// Bump whenever loader output or this layout changes; older caches are rebuilt
+const CACHE_VERSION = 1;
+const HEADER_BYTES = 16;
+const SECTION_ALIGN = 64;
+const CACHE_DIR = join(homedir(), '.csterm', 'cache', 'maps');
+
+// Vertex layout: position, normal, uv, lightmap uv, color
+const VERTEX_STRIDE = 13;
+const HAS_NORMAL = 1;
+const HAS_UV = 2;
+const HAS_LIGHTMAP_UV = 4;
+const HAS_COLOR = 8;
+const HAS_TRIANGLE_NORMALS = 16;
+
+// Byte range relative to the start of the section data
+interface Section {
+  offset: number;
+  length: number;
+}
+
+// A source file the cache was built from; any change invalidates the cache
+interface SourceStamp {
+  path: string;
+  size: number;
+  mtimeMs: number;
+}
+
+type Vec3Array = [number, number, number];
+
+interface CachedMaterial {
+  name: string;
+  color: Vec3Array;
+  emissive?: boolean;
+  textureScale?: number;
+  texture?: number;   // Index into textures
+  lightmap?: number;
+}
+
+interface CachedObject {
+  material: CachedMaterial;
+  position: Vec3Array;
+  flags: number;
+  vertices: Section;  // VERTEX_STRIDE floats per vertex
+  indices: Section;   // 3 uint32 per triangle
+  triangleNormals?: Section;
+  visBatch?: number;
+}
+
+interface CachedTexture {
+  name: string;
+  width: number;
+  height: number;
+  rgb: Section;
+}
+
+interface CacheMetadata {
+  sources: SourceStamp[];
+  name: string;
+  skyColor: Vec3Array;
+  ambientLight: number;
+  bounds: { min: Vec3Array; max: Vec3Array };
+  colliders: { min: Vec3Array; max: Vec3Array }[];
+  spawns: SpawnPoint[];
+  textures: CachedTexture[];
+  objects: CachedObject[];
+  collision?: { vertices: Section; normals: Section };
+  bvh?: Section;
+  visibility?: {
+    rowBytes: number;
+    planes: Section;
+    children: Section;
+    leafClusters: Section;
+    pvs: Section;
+    batchBounds: Section;
+    batchOffsets: Section;
+    batchClusters: Section;
+  };
+}
+
+function alignUp(value: number): number {
+  return Math.ceil(value / SECTION_ALIGN) * SECTION_ALIGN;
+}
+
+function stampSources(paths: string[]): SourceStamp[] {
+  return paths.map(path => {
+    const stat = statSync(path);
+    return { path: resolve(path), size: stat.size, mtimeMs: stat.mtimeMs };
+  });
+}
+
+function sourcesMatch(stamps: SourceStamp[], paths: string[]): boolean {
+  if (stamps.length !== paths.length) return false;
+  for (let i = 0; i < paths.length; i++) {
+    const path = resolve(paths[i]);
+    if (stamps[i].path !== path || !existsSync(path)) return false;
+    const stat = statSync(path);
+    if (stat.size !== stamps[i].size || stat.mtimeMs !== stamps[i].mtimeMs) return false;
+  }
+  return true;
+}
+
+const vec3 = (v: Vector3): Vec3Array => [v.x, v.y, v.z];
+const rgb = (c: Color): Vec3Array => [c.r, c.g, c.b];
+
+// Collects sections for the writer at aligned offsets
+class SectionWriter {
+  private chunks: Uint8Array[] = [];
+  private size = 0;
+
+  add(data: ArrayBufferView): Section {
+    const bytes = new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+    const section = { offset: this.size, length: bytes.byteLength };
+    this.chunks.push(bytes);
+    this.size += bytes.byteLength;
+    const padded = alignUp(this.size);
+    if (padded > this.size) {
+      this.chunks.push(new Uint8Array(padded - this.size));
+      this.size = padded;
+    }
+    return section;
+  }
+
+  get byteLength(): number {
+    return this.size;
+  }
+
+  get parts(): Uint8Array[] {
+    return this.chunks;
+  }
+}
+
+export class MapCache {
+  // Cache file for a BSP (name plus a hash of its absolute path)
+  static pathFor(bspPath: string): string {
+    const absolute = resolve(bspPath);
+    const hash = createHash('sha1').update(absolute).digest('hex').slice(0, 10);
+    return join(CACHE_DIR, `${basename(absolute, '.bsp')}-${hash}.csmap`);
+  }
+
+  /**
+   * Load a map from its cache
+   *
+   * @param sourcePaths The BSP and WAD files the map is built from
+   * @returns null when there is no cache or it is stale, corrupt or from another version
+   */
+  static load(bspPath: string, sourcePaths: string[]): LoadedMap | null {
+    const cachePath = this.pathFor(bspPath);
+    if (!existsSync(cachePath)) return null;
+
+    const start = performance.now();
+    let file: Buffer;
+    try {
+      file = readFileSync(cachePath);
+    } catch {
+      return null;
+    }
+    if (file.length < HEADER_BYTES) return null;
+    if (file.readUInt32LE(0) !== CACHE_MAGIC || file.readUInt32LE(4) !== CACHE_VERSION) return null;
+
+    const jsonLength = file.readUInt32LE(8);
+    let meta: CacheMetadata;
+    try {
+      meta = JSON.parse(file.toString('utf8', HEADER_BYTES, HEADER_BYTES + jsonLength));
+    } catch {
+      return null;
+    }
+    if (!sourcesMatch(meta.sources, sourcePaths)) return null;
+
+    // Typed views need aligned offsets; readFileSync normally returns an unpooled buffer
+    const bytes = file.byteOffset % SECTION_ALIGN === 0 ? file : Buffer.from(file);
+    const dataStart = alignUp(HEADER_BYTES + jsonLength);
+    const view = <T>(section: Section, Type: { new(buffer: ArrayBufferLike, offset: number, length: number): T; BYTES_PER_ELEMENT: number }): T => {
+      if (dataStart + section.offset + section.length > bytes.length) {
+        throw new RangeError('Section outside the cache file');
+      }
+      return new Type(bytes.buffer, bytes.byteOffset + dataStart + section.offset, section.length / Type.BYTES_PER_ELEMENT);
+    };
+
+    try {
+      const textureManager = getTextureManager();
+      const textures = meta.textures.map(t => {
+        const texture = Texture.fromRGB(t.name, t.width, t.height, view(t.rgb, Uint8Array));
+        textureManager.addTexture(t.name, texture);
+        return texture;
+      });
+
+      const renderObjects: RenderObject[] = meta.objects.map(o => {
+        const m = o.material;
+        const material: Material = {
+          name: m.name,
+          color: new Color(m.color[0], m.color[1], m.color[2]),
+          emissive: m.emissive,
+          textureScale: m.textureScale,
+          texture: m.texture !== undefined ? textures[m.texture] : undefined,
+          lightmap: m.lightmap !== undefined ? textures[m.lightmap] : undefined,
+        };
+        const mesh = new Mesh(material);
+        const v = view(o.vertices, Float32Array);
+        const vertexCount = v.length / VERTEX_STRIDE;
+        const vertices: Vertex[] = new Array(vertexCount);
+        for (let i = 0; i < vertexCount; i++) {
+          const b = i * VERTEX_STRIDE;
+          vertices[i] = {
+            position: new Vector3(v[b], v[b + 1], v[b + 2]),
+            normal: o.flags & HAS_NORMAL ? new Vector3(v[b + 3], v[b + 4], v[b + 5]) : undefined,
+            uv: o.flags & HAS_UV ? [v[b + 6], v[b + 7]] : undefined,
+            color: o.flags & HAS_COLOR ? new Color(v[b + 10], v[b + 11], v[b + 12]) : undefined,
+            lightmapUv: o.flags & HAS_LIGHTMAP_UV ? [v[b + 8], v[b + 9]] : undefined,
+          };
+        }
+        mesh.vertices = vertices;
+
+        const idx = view(o.indices, Uint32Array);
+        const normals = o.triangleNormals ? view(o.triangleNormals, Float32Array) : null;
+        const triangles: Triangle[] = new Array(idx.length / 3);
+        for (let i = 0; i < triangles.length; i++) {
+          triangles[i] = {
+            indices: [idx[i * 3], idx[i * 3 + 1], idx[i * 3 + 2]],
+            normal: normals ? new Vector3(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]) : undefined,
+          };
+        }
+        mesh.triangles = triangles;
+
+        return {
+          mesh,
+          transform: new Transform(new Vector3(o.position[0], o.position[1], o.position[2])),
+          visible: true,
+          visBatch: o.visBatch,
+        };
+      });
+
+      const collisionMesh = new CollisionMesh();
+      let mapped = false;
+      if (meta.collision) {
+        collisionMesh.addPackedTriangles(
+          view(meta.collision.vertices, Float32Array),
+          view(meta.collision.normals, Float32Array)
+        );
+        if (meta.bvh) {
+          const source = { path: cachePath, byteOffset: dataStart + meta.bvh.offset, byteLength: meta.bvh.length };
+          const native = NativeBVH.map(source);
+          if (native) {
+            collisionMesh.adoptNativeBVH(native, source);
+            mapped = true;
+          }
+        }
+      }
+
+      const vis = meta.visibility;
+      const toAABB = (box: { min: Vec3Array; max: Vec3Array }): AABB => ({
+        min: new Vector3(box.min[0], box.min[1], box.min[2]),
+        max: new Vector3(box.max[0], box.max[1], box.max[2]),
+      });
+
+      const map: LoadedMap = {
+        name: meta.name,
+        renderObjects,
+        colliders: meta.colliders.map(toAABB),
+        collisionMesh,
+        spawns: meta.spawns,
+        bounds: toAABB(meta.bounds),
+        skyColor: new Color(meta.skyColor[0], meta.skyColor[1], meta.skyColor[2]),
+        ambientLight: meta.ambientLight,
+        source: 'bsp',
+        textureManager,
+        visibility: vis
+          ? {
+              planes: view(vis.planes, Float32Array),
+              children: view(vis.children, Int32Array),
+              leafClusters: view(vis.leafClusters, Int32Array),
+              pvs: view(vis.pvs, Uint8Array),
+              rowBytes: vis.rowBytes,
+              batchBounds: view(vis.batchBounds, Float32Array),
+              batchOffsets: view(vis.batchOffsets, Int32Array),
+              batchClusters: view(vis.batchClusters, Int32Array),
+            }
+          : undefined,
+      };
+
+      console.log(`[MapCache] Loaded ${meta.name} in ${(performance.now() - start).toFixed(1)}ms (${(file.length / 1048576).toFixed(1)} MB${mapped ? ', BVH mapped' : ''})`);
+      return map;
+    } catch (error) {
+      console.warn(`[MapCache] Ignoring unreadable cache ${cachePath}: ${error}`);
+      return null;
+    }
+  }
+
+  /**
+   * Write a loaded BSP map to its cache (builds the collision BVH if needed)
+   *
+   * @returns The cache path, or null if it could not be written
+   */
+  static save(map: LoadedMap, bspPath: string, sourcePaths: string[]): string | null {
+    const cachePath = this.pathFor(bspPath);
+    try {
+      const sections = new SectionWriter();
+
+      // Textures referenced by materials, each stored once
+      const textureIndex = new Map<Texture, number>();
+      const textures: CachedTexture[] = [];
+      const addTexture = (texture: Texture | undefined): number | undefined => {
+        if (!texture) return undefined;
+        let index = textureIndex.get(texture);
+        if (index === undefined) {
+          index = textures.length;
+          textureIndex.set(texture, index);
+          textures.push({ name: texture.name, width: texture.width, height: texture.height, rgb: sections.add(texture.getRawRGB()) });
+        }
+        return index;
+      };
+
+      const objects: CachedObject[] = map.renderObjects.map(obj => {
+        const { mesh } = obj;
+        let flags = 0;
+        for (const v of mesh.vertices) {
+          if (v.normal) flags |= HAS_NORMAL;
+          if (v.uv) flags |= HAS_UV;
+          if (v.lightmapUv) flags |= HAS_LIGHTMAP_UV;
+          if (v.color) flags |= HAS_COLOR;
+        }
+        if (mesh.triangles.some(t => t.normal)) flags |= HAS_TRIANGLE_NORMALS;
+
+        const vertices = new Float32Array(mesh.vertices.length * VERTEX_STRIDE);
+        for (let i = 0; i < mesh.vertices.length; i++) {
+          const v = mesh.vertices[i];
+          const b = i * VERTEX_STRIDE;
+          vertices[b] = v.position.x; vertices[b + 1] = v.position.y; vertices[b + 2] = v.position.z;
+          if (v.normal) { vertices[b + 3] = v.normal.x; vertices[b + 4] = v.normal.y; vertices[b + 5] = v.normal.z; }
+          if (v.uv) { vertices[b + 6] = v.uv[0]; vertices[b + 7] = v.uv[1]; }
+          if (v.lightmapUv) { vertices[b + 8] = v.lightmapUv[0]; vertices[b + 9] = v.lightmapUv[1]; }
+          if (v.color) { vertices[b + 10] = v.color.r; vertices[b + 11] = v.color.g; vertices[b + 12] = v.color.b; }
+        }
+
+        const indices = new Uint32Array(mesh.triangles.length * 3);
+        const triangleNormals = flags & HAS_TRIANGLE_NORMALS ? new Float32Array(mesh.triangles.length * 3) : null;
+        for (let i = 0; i < mesh.triangles.length; i++) {
+          const t = mesh.triangles[i];
+          indices.set(t.indices, i * 3);
+          if (triangleNormals && t.normal) {
+            triangleNormals[i * 3] = t.normal.x;
+            triangleNormals[i * 3 + 1] = t.normal.y;
+            triangleNormals[i * 3 + 2] = t.normal.z;
+          }
+        }
+
+        const m = mesh.material;
+        return {
+          material: {
+            name: m.name,
+            color: rgb(m.color),
+            emissive: m.emissive,
+            textureScale: m.textureScale,
+            texture: addTexture(m.texture),
+            lightmap: addTexture(m.lightmap),
+          },
+          position: vec3(obj.transform.position),
+          flags,
+          vertices: sections.add(vertices),
+          indices: sections.add(indices),
+          triangleNormals: triangleNormals ? sections.add(triangleNormals) : undefined,
+          visBatch: obj.visBatch,
+        };
+      });
+
+      let collision: CacheMetadata['collision'];
+      let bvh: Section | undefined;
+      const collisionMesh = map.collisionMesh;
+      if (collisionMesh && collisionMesh.triangles.length > 0) {
+        const tris = collisionMesh.triangles;
+        const vertices = new Float32Array(tris.length * 9);
+        const normals = new Float32Array(tris.length * 3);
+        for (let i = 0; i < tris.length; i++) {
+          const t = tris[i];
+          vertices.set([t.v0.x, t.v0.y, t.v0.z, t.v1.x, t.v1.y, t.v1.z, t.v2.x, t.v2.y, t.v2.z], i * 9);
+          normals.set([t.normal.x, t.normal.y, t.normal.z], i * 3);
+        }
+        collision = { vertices: sections.add(vertices), normals: sections.add(normals) };
+
+        collisionMesh.ensureBVH();
+        const blob = collisionMesh.native?.serialize();
+        if (blob) bvh = sections.add(blob);
+      }
+
+      const vis = map.visibility;
+      const meta: CacheMetadata = {
+        sources: stampSources(sourcePaths),
+        name: map.name,
+        skyColor: rgb(map.skyColor),
+        ambientLight: map.ambientLight,
+        bounds: { min: vec3(map.bounds.min), max: vec3(map.bounds.max) },
+        colliders: map.colliders.map(c => ({ min: vec3(c.min), max: vec3(c.max) })),
+        spawns: map.spawns,
+        textures,
+        objects,
+        collision,
+        bvh,
+        visibility: vis
+          ? {
+              rowBytes: vis.rowBytes,
+              planes: sections.add(vis.planes),
+              children: sections.add(vis.children),
+              leafClusters: sections.add(vis.leafClusters),
+              pvs: sections.add(vis.pvs),
+              batchBounds: sections.add(vis.batchBounds),
+              batchOffsets: sections.add(vis.batchOffsets),
+              batchClusters: sections.add(vis.batchClusters),
+            }
+          : undefined,
+      };
+
+      const json = Buffer.from(JSON.stringify(meta), 'utf8');
+      const dataStart = alignUp(HEADER_BYTES + json.length);
+      const header = Buffer.alloc(dataStart);
+      header.writeUInt32LE(CACHE_MAGIC, 0);
+      header.writeUInt32LE(CACHE_VERSION, 4);
+      header.writeUInt32LE(json.length, 8);
+      json.copy(header, HEADER_BYTES);
+
+      // Write then rename, so a reader (or a crash) never sees half a cache
+      mkdirSync(CACHE_DIR, { recursive: true });
+      const tmpPath = `${cachePath}.${process.pid}.tmp`;
+      writeFileSync(tmpPath, Buffer.concat([header, ...sections.parts], dataStart + sections.byteLength));
+      renameSync(tmpPath, cachePath);
+      return cachePath;
+    } catch (error) {
+      console.warn(`[MapCache] Could not write ${cachePath}: ${error}`);
+      return null;
+    }
+  }
+}
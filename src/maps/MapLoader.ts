@@ -10,8 +10,10 @@ import { BSPLoader, BSPLoadResult } from '../bsp/BSPLoader.js';
 import { QuakeBSPLoader, QuakeBSPLoadResult } from '../bsp/QuakeBSPLoader.js';
 import { Q3BSPLoader, Q3BSPLoadResult } from '../bsp/Q3BSPLoader.js';
 import { TextureManager } from '../engine/TextureManager.js';
-import { readFileSync } from 'fs';
+import { readFileSync, existsSync } from 'fs';
 import { CollisionMesh } from '../physics/MeshCollision.js';
+import { BSPVisibilityData } from '../bsp/BSPVisibility.js';
+import { MapCache } from './MapCache.js';
 
 // Q3 BSP magic number "IBSP" in little-endian
 const Q3BSP_MAGIC = 0x50534249;
@@ -27,6 +29,7 @@ export interface LoadedMap {
   ambientLight: number;
   source?: 'bsp' | 'brushdef';
   textureManager?: TextureManager;
+  visibility?: BSPVisibilityData;  // PVS culling data for v29/v30 BSP maps
 }
 
 export class MapLoader {
@@ -126,8 +129,22 @@ export class MapLoader {
     };
   }
 
-  // Load a map from a BSP file (auto-detects format: v29 Quake, v30 GoldSrc, or IBSP Q3)
-  static async loadBSP(bspPath: string, wadPaths?: string[]): Promise<LoadedMap> {
+  // Load a map from a BSP file, through the map cache unless rebuildCache is set
+  // (the cache is written after every full load)
+  static async loadBSP(bspPath: string, wadPaths?: string[], rebuildCache: boolean = false): Promise<LoadedMap> {
+    const sources = [bspPath, ...(wadPaths ?? []).filter(p => existsSync(p))];
+    if (!rebuildCache) {
+      const cached = MapCache.load(bspPath, sources);
+      if (cached) return cached;
+    }
+
+    const map = await this.parseBSP(bspPath, wadPaths);
+    MapCache.save(map, bspPath, sources);
+    return map;
+  }
+
+  // Parse a BSP file (auto-detects format: v29 Quake, v30 GoldSrc, or IBSP Q3)
+  private static async parseBSP(bspPath: string, wadPaths?: string[]): Promise<LoadedMap> {
     // Read first 8 bytes to detect BSP format
     const data = readFileSync(bspPath);
     const magic = data.readUInt32LE(0);
@@ -165,6 +182,7 @@ export class MapLoader {
       ambientLight: result.ambientLight,
       source: 'bsp',
       textureManager: result.textureManager,
+      visibility: 'visibility' in result ? result.visibility : undefined,
     };
   }
 }
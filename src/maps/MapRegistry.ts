@@ -284,8 +284,8 @@ export class MapRegistry {
     return this.maps.get(id);
   }
 
-  // Load a map by ID
-  static async loadMap(id: string): Promise<LoadedMap> {
+  // Load a map by ID (rebuildCache recompiles a BSP map's cache)
+  static async loadMap(id: string, rebuildCache: boolean = false): Promise<LoadedMap> {
     this.initialize();
 
     const mapInfo = this.maps.get(id);
@@ -298,7 +298,7 @@ export class MapRegistry {
     } else if (mapInfo.type === 'bsp' && mapInfo.bspPath) {
       const bspPath = this.resolvePath(mapInfo.bspPath);
       const wadPaths = mapInfo.wadPaths?.map(p => this.resolvePath(p));
-      return MapLoader.loadBSP(bspPath, wadPaths);
+      return MapLoader.loadBSP(bspPath, wadPaths, rebuildCache);
     }
 
     throw new Error(`Invalid map configuration: ${id}`);
@@ -0,0 +1,35 @@
+// Compile BSP maps into the map cache ahead of time
+// Usage: npx tsx src/maps/compileMaps.ts [mapId ...]   (default: every BSP map)
+
+import { MapRegistry } from './MapRegistry.js';
+
+async function compileMaps(): Promise<void> {
+  MapRegistry.initialize();
+  const requested = process.argv.slice(2);
+  const maps = MapRegistry.getAvailableMaps().filter(
+    m => m.type === 'bsp' && (requested.length === 0 || requested.includes(m.id))
+  );
+
+  let failed = 0;
+  for (const map of maps) {
+    const start = performance.now();
+    try {
+      await MapRegistry.loadMap(map.id, true);
+      const compileMs = performance.now() - start;
+
+      // Time the load a map switch now takes
+      const loadStart = performance.now();
+      await MapRegistry.loadMap(map.id);
+      const loadMs = performance.now() - loadStart;
+      console.log(`${map.id}: compiled in ${compileMs.toFixed(0)}ms, cached load ${loadMs.toFixed(0)}ms`);
+    } catch (error) {
+      failed++;
+      console.error(`${map.id}: ${error}`);
+    }
+  }
+
+  console.log(`\n${maps.length - failed}/${maps.length} maps compiled`);
+  process.exit(failed > 0 ? 1 : 0);
+}
+
+compileMaps();
@@ -3,6 +3,7 @@
 
 import WebSocket, { CloseEvent, ErrorEvent, MessageEvent, RawData } from 'ws';
 import { isVoiceFrame } from '../voice/types.js';
+import { SnapshotDecoder, isSnapshotFrame } from './SnapshotDecoder.js';
 import {
   ClientMessage,
   ServerMessage,
@@ -90,6 +91,10 @@ export class GameClient {
   private inputSequence: number = 0;
   private pendingInputs: Map<number, PlayerInput> = new Map();
 
+  // Binary delta snapshots (requested on the first JSON game_state)
+  private snapshotDecoder: SnapshotDecoder = new SnapshotDecoder();
+  private snapshotsRequested: boolean = false;
+
   // Reconnection state
   private reconnectAttempt: number = 0;
   private reconnectTimer: ReturnType<typeof setTimeout> | null = null;
@@ -158,12 +163,14 @@ export class GameClient {
     this.playerId = null;
     this.currentRoomId = null;
     this.pendingInputs.clear();
+    this.resetSnapshots();
   }
 
   private handleDisconnect(reason: string): void {
     this.state = 'disconnected';
     this.playerId = null;
     this.currentRoomId = null;
+    this.resetSnapshots();
     this.callbacks.onDisconnect?.(reason);
 
     // Attempt reconnection if configured
@@ -317,31 +324,58 @@ export class GameClient {
   private handleRawMessage(data: RawData): void {
     // Check if it's binary data
     if (data instanceof ArrayBuffer) {
-      const uint8 = new Uint8Array(data);
-      if (isVoiceFrame(uint8)) {
-        this.callbacks.onVoiceData?.(uint8);
-        return;
-      }
+      if (this.handleBinary(new Uint8Array(data))) return;
     } else if (Buffer.isBuffer(data)) {
-      if (data.length > 0 && data[0] === 0x01) {
-        const uint8 = new Uint8Array(data.buffer, data.byteOffset, data.length);
-        this.callbacks.onVoiceData?.(uint8);
-        return;
-      }
+      if (this.handleBinary(new Uint8Array(data.buffer, data.byteOffset, data.length))) return;
     } else if (Array.isArray(data)) {
       // ws sometimes sends array of buffers
       const combined = Buffer.concat(data);
-      if (combined.length > 0 && combined[0] === 0x01) {
-        const uint8 = new Uint8Array(combined.buffer, combined.byteOffset, combined.length);
-        this.callbacks.onVoiceData?.(uint8);
-        return;
-      }
+      if (this.handleBinary(new Uint8Array(combined.buffer, combined.byteOffset, combined.length))) return;
     }
 
     // Handle as text JSON message
     this.handleMessage(data.toString());
   }
 
+  /**
+   * Handle a binary message (voice or snapshot)
+   * @returns false if it is not one (treat as text)
+   */
+  private handleBinary(uint8: Uint8Array): boolean {
+    if (isVoiceFrame(uint8)) {
+      this.callbacks.onVoiceData?.(uint8);
+      return true;
+    }
+    if (isSnapshotFrame(uint8)) {
+      this.handleSnapshot(uint8);
+      return true;
+    }
+    return false;
+  }
+
+  private handleSnapshot(data: Uint8Array): void {
+    let snapshot: GameStateSnapshot | null = null;
+    try {
+      snapshot = this.snapshotDecoder.decode(data);
+    } catch (error) {
+      console.error('Failed to decode snapshot:', error);
+      this.snapshotDecoder.requestFullSnapshot();
+    }
+
+    // Ack every snapshot; 0 (nothing decodable) asks for a full one
+    this.send({ type: 'snapshot_ack', sequence: this.snapshotDecoder.getAckSequence() });
+
+    if (snapshot) {
+      this.state = 'in_game';
+      this.callbacks.onGameState?.(snapshot);
+    }
+  }
+
+  private resetSnapshots(): void {
+    this.snapshotDecoder.reset();
+    this.snapshotsRequested = false;
+  }
+
   private handleMessage(data: string): void {
     try {
       const message = JSON.parse(data) as ServerMessage;
@@ -359,6 +393,7 @@ export class GameClient {
         break;
 
       case 'room_joined':
+        this.resetSnapshots();
         this.playerId = message.playerId;
         this.currentRoomId = message.roomId;
         this.state = 'in_lobby';
@@ -386,6 +421,8 @@ export class GameClient {
         break;
 
       case 'game_starting':
+        // Each game has its own runner and snapshot sequence: opt in again
+        this.resetSnapshots();
         this.callbacks.onGameStarting?.(message.countdown);
         break;
 
@@ -396,6 +433,11 @@ export class GameClient {
       // Game state messages
       case 'game_state':
         this.state = 'in_game';
+        // Switch to binary delta snapshots from here on
+        if (!this.snapshotsRequested) {
+          this.snapshotsRequested = true;
+          this.send({ type: 'snapshot_ack', sequence: 0 });
+        }
         this.callbacks.onGameState?.(message.state);
         break;
 
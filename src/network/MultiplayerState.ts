@@ -53,6 +53,7 @@ interface RemoteEntity {
   currentWeapon: string;
   kills: number;
   deaths: number;
+  dormant: boolean;  // Culled by the server: still in the game, position unknown
 
   // Interpolation buffer (last N states)
   states: InterpolationState[];
@@ -181,7 +182,7 @@ export class MultiplayerState {
       this.updateRemoteEntity(this.remotePlayers, playerData, state.timestamp);
     }
 
-    // Remove players no longer in state
+    // Remove players no longer in state (culled ones are sent as dormant)
     for (const id of this.remotePlayers.keys()) {
       if (!seenPlayers.has(id)) {
         this.remotePlayers.delete(id);
@@ -225,6 +226,7 @@ export class MultiplayerState {
         currentWeapon: data.currentWeapon,
         kills: data.kills,
         deaths: data.deaths,
+        dormant: false,
         states: [],
         position: toVector3(data.position),
         yaw: data.yaw,
@@ -243,6 +245,20 @@ export class MultiplayerState {
     entity.kills = data.kills;
     entity.deaths = data.deaths;
 
+    // Dormant: keep the entity but not its (stale) position. History from
+    // before it was culled would interpolate across the gap, so drop it.
+    if (data.dormant) {
+      entity.dormant = true;
+      entity.states.length = 0;
+      return;
+    }
+    if (entity.dormant) {
+      entity.dormant = false;
+      entity.position = toVector3(data.position);
+      entity.yaw = data.yaw;
+      entity.pitch = data.pitch;
+    }
+
     // Add to interpolation buffer
     entity.states.push({
       timestamp,
@@ -463,8 +479,9 @@ export class MultiplayerState {
       pitch: number;
     }> = [];
 
-    // Add remote players
+    // Add remote players (dormant ones have no position to draw at)
     for (const player of this.remotePlayers.values()) {
+      if (player.dormant) continue;
       entities.push({
         position: player.position,
         config: { eyeHeight: 1.7 },
@@ -480,6 +497,7 @@ export class MultiplayerState {
 
     // Add remote bots
     for (const bot of this.remoteBots.values()) {
+      if (bot.dormant) continue;
       entities.push({
         position: bot.position,
         config: { eyeHeight: 1.7 },
@@ -0,0 +1,394 @@
+// Client-side decoder for binary delta snapshots
+// Mirrors server/src/SnapshotEncoder.ts (keep the two in sync): rebuilds the
+// GameStateSnapshot the server would have sent as JSON, so everything after
+// GameClient sees the same state either way.
+
+import {
+  GameStateSnapshot,
+  PlayerSnapshot,
+  BotSnapshot,
+  DroppedWeaponSnapshot,
+  GamePhase,
+  TeamId,
+  WeaponType,
+} from '../shared/types/Protocol.js';
+
+// Binary message type (matching server SNAPSHOT_FRAME_TYPE)
+export const SNAPSHOT_FRAME_TYPE = 0x10;
+
+export function isSnapshotFrame(data: Uint8Array): boolean {
+  return data.length >= 1 && data[0] === SNAPSHOT_FRAME_TYPE;
+}
+
+// Format constants (matching server)
+const MAX_SNAPSHOT_ENTITIES = 256;
+const SLOT_BITS = 8;
+const FRAME_RING = 32;
+const POS_SCALE = 64;
+const POS_BITS = 18;
+const POS_DELTA_BITS = 8;
+const ANGLE_BITS = 16;
+const TIME_SCALE = 10;
+const TIME_BITS = 12;
+const VITAL_BITS = 7;
+const TEAM_BITS = 2;
+const WEAPON_BITS = 3;
+const MONEY_BITS = 16;
+const SCORE_BITS = 16;
+
+const KIND_BITS = 2;
+const ENTITY_PLAYER = 0;
+const ENTITY_BOT = 1;
+const ENTITY_WEAPON = 2;
+
+const OP_BITS = 2;
+const OP_UPDATE = 0;
+const OP_CREATE = 1;
+const OP_REMOVE = 2;
+const OP_DORMANT = 3;
+
+const F_SERIAL = 0;
+const F_KIND = 1;
+const F_X = 2;
+const F_Y = 3;
+const F_Z = 4;
+const F_YAW = 5;
+const F_PITCH = 6;
+const F_HEALTH = 7;
+const F_ARMOR = 8;
+const F_ALIVE = 9;
+const F_TEAM = 10;
+const F_WEAPON = 11;
+const F_MONEY = 12;
+const F_KILLS = 13;
+const F_DEATHS = 14;
+const FIELD_COUNT = 16;
+
+const G_POS = 1 << 0;
+const G_ANGLES = 1 << 1;
+const G_VITALS = 1 << 2;
+const G_TEAM = 1 << 3;
+const G_WEAPON = 1 << 4;
+const G_MONEY = 1 << 5;
+const G_SCORE = 1 << 6;
+const G_NAME = 1 << 7;
+const GROUP_BITS = 8;
+const HIDDEN_GROUPS = G_POS | G_ANGLES;
+
+const PHASES = ['pre_match', 'warmup', 'freeze', 'live', 'round_end', 'halftime', 'match_end'] as GamePhase[];
+const TEAMS: TeamId[] = ['T', 'CT', 'SPECTATOR'];
+const WEAPONS: WeaponType[] = ['knife', 'pistol', 'rifle', 'shotgun', 'sniper'];
+
+const ANGLE_TO_RADIANS = (Math.PI * 2) / (1 << ANGLE_BITS);
+
+// LSB-first bit reader (matching server BitWriter)
+class BitReader {
+  private data: Uint8Array = new Uint8Array(0);
+  private offset = 0;
+  private acc = 0;
+  private accBits = 0;
+  private decoder = new TextDecoder();
+
+  reset(data: Uint8Array): void {
+    this.data = data;
+    this.offset = 0;
+    this.acc = 0;
+    this.accBits = 0;
+  }
+
+  read(bits: number): number {
+    while (this.accBits < bits) {
+      if (this.offset >= this.data.length) throw new Error('Truncated snapshot');
+      this.acc |= this.data[this.offset++] << this.accBits;
+      this.accBits += 8;
+    }
+    const value = this.acc & ((1 << bits) - 1);
+    this.acc >>>= bits;
+    this.accBits -= bits;
+    return value;
+  }
+
+  readSigned(bits: number): number {
+    const shift = 32 - bits;
+    return (this.read(bits) << shift) >> shift;
+  }
+
+  // Skip to the next byte boundary
+  align(): void {
+    this.acc = 0;
+    this.accBits = 0;
+  }
+
+  readString(): string {
+    this.align();
+    const length = this.read(8);
+    if (this.offset + length > this.data.length) throw new Error('Truncated snapshot');
+    const value = this.decoder.decode(this.data.subarray(this.offset, this.offset + length));
+    this.offset += length;
+    return value;
+  }
+}
+
+// One decoded snapshot, kept as a baseline for later ones
+interface DecodedFrame {
+  sequence: number;
+  fields: Int32Array;
+  present: Uint8Array;
+  dormant: Uint8Array;  // Culled by the server; position/angles are stale
+  ids: string[];
+  names: string[];
+}
+
+function createFrame(): DecodedFrame {
+  return {
+    sequence: -1,
+    fields: new Int32Array(MAX_SNAPSHOT_ENTITIES * FIELD_COUNT),
+    present: new Uint8Array(MAX_SNAPSHOT_ENTITIES),
+    dormant: new Uint8Array(MAX_SNAPSHOT_ENTITIES),
+    ids: new Array(MAX_SNAPSHOT_ENTITIES).fill(''),
+    names: new Array(MAX_SNAPSHOT_ENTITIES).fill(''),
+  };
+}
+
+export class SnapshotDecoder {
+  private frames: DecodedFrame[] = [];
+  private next = 0;
+  private reader = new BitReader();
+  private lastSequence = 0;   // Newest decoded; older snapshots are stale
+  private needFull = false;   // Baseline lost: ack 0 until a snapshot decodes
+
+  constructor() {
+    for (let i = 0; i < FRAME_RING; i++) this.frames.push(createFrame());
+  }
+
+  /**
+   * Sequence to acknowledge: the newest snapshot decoded (0 = none, which
+   * asks the server for a full snapshot)
+   */
+  getAckSequence(): number {
+    return this.needFull ? 0 : this.lastSequence;
+  }
+
+  /**
+   * Ask for a full snapshot with the next ack (e.g. after a decode error),
+   * still rejecting anything older than what was already decoded
+   */
+  requestFullSnapshot(): void {
+    this.needFull = true;
+  }
+
+  // Forget every baseline (e.g. after joining another room)
+  reset(): void {
+    for (const frame of this.frames) frame.sequence = -1;
+    this.lastSequence = 0;
+    this.needFull = false;
+  }
+
+  /**
+   * Decode a snapshot frame.
+   * @returns the snapshot, or null if its baseline is no longer known (the
+   *          next ack then asks for a full snapshot)
+   */
+  decode(data: Uint8Array): GameStateSnapshot | null {
+    const r = this.reader;
+    r.reset(data);
+    r.read(8);  // Frame type
+
+    const sequence = r.read(24) + r.read(8) * 0x1000000;
+    const baseOffset = r.read(16);
+    const tick = r.read(24) + r.read(8) * 0x1000000;
+    const timestamp = r.read(24) + r.read(24) * 0x1000000;
+    const phase = PHASES[r.read(3)] ?? 'warmup';
+    const roundTime = r.read(TIME_BITS) / TIME_SCALE;
+    const freezeTime = r.read(TIME_BITS) / TIME_SCALE;
+    const tScore = r.read(8);
+    const ctScore = r.read(8);
+    const roundNumber = r.read(8);
+
+    // Older than what we already have (reordered)
+    if (sequence <= this.lastSequence && this.lastSequence !== 0) return null;
+
+    let base: DecodedFrame | null = null;
+    if (baseOffset !== 0) {
+      base = this.findFrame(sequence - baseOffset);
+      if (!base) {
+        this.needFull = true;
+        return null;
+      }
+    }
+
+    // Never decode over the baseline itself
+    let frame = this.frames[this.next];
+    if (frame === base) {
+      this.next = (this.next + 1) % FRAME_RING;
+      frame = this.frames[this.next];
+    }
+    frame.sequence = -1;  // Not a baseline until fully decoded
+    if (base) {
+      frame.fields.set(base.fields);
+      frame.present.set(base.present);
+      frame.dormant.set(base.dormant);
+      for (let i = 0; i < MAX_SNAPSHOT_ENTITIES; i++) {
+        frame.ids[i] = base.ids[i];
+        frame.names[i] = base.names[i];
+      }
+    } else {
+      frame.present.fill(0);
+      frame.dormant.fill(0);
+    }
+
+    const f = frame.fields;
+    while (r.read(1) === 1) {
+      const slot = r.read(SLOT_BITS);
+      const op = r.read(OP_BITS);
+      const row = slot * FIELD_COUNT;
+
+      if (op === OP_REMOVE) {
+        frame.present[slot] = 0;
+        frame.dormant[slot] = 0;
+      } else if (op === OP_CREATE) {
+        this.readCreate(frame, slot, 0);
+        frame.dormant[slot] = 0;
+      } else if (op === OP_UPDATE) {
+        const mask = r.read(GROUP_BITS);
+        this.readGroups(frame, slot, mask, true);
+        frame.dormant[slot] = 0;
+      } else {
+        // OP_DORMANT: created without a position, or an update without one
+        if (r.read(1) === 1) {
+          this.readCreate(frame, slot, HIDDEN_GROUPS);
+        } else {
+          const mask = r.read(GROUP_BITS);
+          if (mask & HIDDEN_GROUPS) throw new Error('Position in a dormant update');
+          this.readGroups(frame, slot, mask, true);
+        }
+        frame.dormant[slot] = 1;
+      }
+    }
+
+    frame.sequence = sequence;
+    this.next = (this.next + 1) % FRAME_RING;
+    this.lastSequence = sequence;
+    this.needFull = false;
+
+    return {
+      tick,
+      timestamp,
+      phase,
+      roundTime,
+      freezeTime,
+      ...this.buildEntities(frame),
+      tScore,
+      ctScore,
+      roundNumber,
+    };
+  }
+
+  private findFrame(sequence: number): DecodedFrame | null {
+    for (const frame of this.frames) {
+      if (frame.sequence === sequence) return frame;
+    }
+    return null;
+  }
+
+  // Kind, id and every group of the kind except those in omit
+  private readCreate(frame: DecodedFrame, slot: number, omit: number): void {
+    const r = this.reader;
+    const f = frame.fields;
+    const row = slot * FIELD_COUNT;
+    const kind = r.read(KIND_BITS);
+    frame.ids[slot] = r.readString();
+    frame.names[slot] = '';
+    f.fill(0, row, row + FIELD_COUNT);
+    f[row + F_KIND] = kind;
+    let mask = G_POS | G_WEAPON;
+    if (kind !== ENTITY_WEAPON) mask |= G_ANGLES | G_VITALS | G_TEAM | G_SCORE | G_NAME;
+    if (kind === ENTITY_PLAYER) mask |= G_MONEY;
+    this.readGroups(frame, slot, mask & ~omit, false);
+    frame.present[slot] = 1;
+  }
+
+  private readGroups(frame: DecodedFrame, slot: number, mask: number, delta: boolean): void {
+    const r = this.reader;
+    const f = frame.fields;
+    const row = slot * FIELD_COUNT;
+    if (mask & G_POS) {
+      for (let axis = F_X; axis <= F_Z; axis++) {
+        if (r.read(1) === 1) {
+          const d = r.readSigned(POS_DELTA_BITS);
+          if (!delta) throw new Error('Position delta without a baseline');
+          f[row + axis] += d;
+        } else {
+          f[row + axis] = r.readSigned(POS_BITS);
+        }
+      }
+    }
+    if (mask & G_ANGLES) {
+      f[row + F_YAW] = r.readSigned(ANGLE_BITS);
+      f[row + F_PITCH] = r.readSigned(ANGLE_BITS);
+    }
+    if (mask & G_VITALS) {
+      f[row + F_HEALTH] = r.read(VITAL_BITS);
+      f[row + F_ARMOR] = r.read(VITAL_BITS);
+      f[row + F_ALIVE] = r.read(1);
+    }
+    if (mask & G_TEAM) f[row + F_TEAM] = r.read(TEAM_BITS);
+    if (mask & G_WEAPON) f[row + F_WEAPON] = r.read(WEAPON_BITS);
+    if (mask & G_MONEY) f[row + F_MONEY] = r.read(MONEY_BITS);
+    if (mask & G_SCORE) {
+      f[row + F_KILLS] = r.read(SCORE_BITS);
+      f[row + F_DEATHS] = r.read(SCORE_BITS);
+    }
+    if (mask & G_NAME) frame.names[slot] = r.readString();
+  }
+
+  private buildEntities(frame: DecodedFrame): {
+    players: PlayerSnapshot[];
+    bots: BotSnapshot[];
+    droppedWeapons: DroppedWeaponSnapshot[];
+  } {
+    const players: PlayerSnapshot[] = [];
+    const bots: BotSnapshot[] = [];
+    const droppedWeapons: DroppedWeaponSnapshot[] = [];
+    const f = frame.fields;
+
+    for (let slot = 0; slot < MAX_SNAPSHOT_ENTITIES; slot++) {
+      if (!frame.present[slot]) continue;
+      const row = slot * FIELD_COUNT;
+      const position = {
+        x: f[row + F_X] / POS_SCALE,
+        y: f[row + F_Y] / POS_SCALE,
+        z: f[row + F_Z] / POS_SCALE,
+      };
+      const weapon = WEAPONS[f[row + F_WEAPON]] ?? 'pistol';
+
+      if (f[row + F_KIND] === ENTITY_WEAPON) {
+        droppedWeapons.push({ id: frame.ids[slot], weaponType: weapon, position });
+        continue;
+      }
+
+      const entity = {
+        id: frame.ids[slot],
+        name: frame.names[slot],
+        position,
+        yaw: f[row + F_YAW] * ANGLE_TO_RADIANS,
+        pitch: f[row + F_PITCH] * ANGLE_TO_RADIANS,
+        health: f[row + F_HEALTH],
+        armor: f[row + F_ARMOR],
+        team: TEAMS[f[row + F_TEAM]] ?? 'SPECTATOR',
+        isAlive: f[row + F_ALIVE] === 1,
+        currentWeapon: weapon,
+        kills: f[row + F_KILLS],
+        deaths: f[row + F_DEATHS],
+        dormant: frame.dormant[slot] === 1,
+      };
+      if (f[row + F_KIND] === ENTITY_BOT) {
+        bots.push(entity);
+      } else {
+        players.push({ ...entity, money: f[row + F_MONEY] });
+      }
+    }
+
+    return { players, bots, droppedWeapons };
+  }
+}
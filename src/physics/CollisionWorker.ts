@@ -1,6 +1,8 @@
 /**
  * Collision Worker - Handles collision queries in a worker thread.
  * Processes batched raycast and sphere collision queries.
+ * Builds its own native BVH when the addon is available, so a batch of rays
+ * is traced in one raycastBatch() call.
  */
 
 import { parentPort, workerData } from 'worker_threads';
@@ -12,6 +14,7 @@ import {
   queryCollisionBVHSphere,
   sphereAABBIntersect,
 } from './BVH.js';
+import { NativeBVH, MappedBVHSource, BVH_RAY_STRIDE, BVH_HIT_STRIDE } from './NativeBVH.js';
 
 // Worker message types
 export interface RaycastQuery {
@@ -36,12 +39,8 @@ export interface BatchQuery {
 
 export interface SetBVHMessage {
   type: 'setBVH';
-  triangles: {
-    v0: { x: number; y: number; z: number };
-    v1: { x: number; y: number; z: number };
-    v2: { x: number; y: number; z: number };
-    normal: { x: number; y: number; z: number };
-  }[];
+  vertices: Float32Array;  // 9 floats per triangle (see packTriangles)
+  source?: MappedBVHSource;  // Map cache holding the built tree (skips the build)
 }
 
 export interface RaycastResult {
@@ -77,18 +76,24 @@ interface CollisionTriangle {
 
 let triangles: CollisionTriangle[] = [];
 let bvh: CollisionBVHNode | null = null;
-
-// Rebuild BVH from triangles (simplified version for worker)
-function buildWorkerBVH(): void {
-  if (triangles.length === 0) {
-    bvh = null;
-    return;
+let nativeBVH: NativeBVH | null = null;
+
+// Unpack triangles and build this worker's BVH (native when available, mapped from the map cache if possible)
+function buildWorkerBVH(vertices: Float32Array, source?: MappedBVHSource): void {
+  nativeBVH?.destroy();
+  nativeBVH = (source && NativeBVH.map(source)) || NativeBVH.build(vertices);
+
+  triangles = [];
+  for (let i = 0; i + 9 <= vertices.length; i += 9) {
+    const v0 = new Vector3(vertices[i], vertices[i + 1], vertices[i + 2]);
+    const v1 = new Vector3(vertices[i + 3], vertices[i + 4], vertices[i + 5]);
+    const v2 = new Vector3(vertices[i + 6], vertices[i + 7], vertices[i + 8]);
+    const normal = Vector3.cross(Vector3.sub(v1, v0), Vector3.sub(v2, v0)).normalize();
+    triangles.push({ v0, v1, v2, normal });
   }
 
-  // Import buildCollisionBVH dynamically since we have the triangles
-  // For simplicity, we'll use a simple spatial structure here
-  // The main BVH is maintained in the main thread and we query it
-  bvh = null;  // Workers receive pre-serialized data for queries
+  // The JS fallback scans triangles linearly
+  bvh = null;
 }
 
 // Ray-triangle intersection (Moller-Trumbore)
@@ -169,8 +174,52 @@ function processRaycast(query: RaycastQuery): RaycastResult {
   };
 }
 
+// Process all raycasts of a batch with one native call
+function processRaycastsNative(bvhNative: NativeBVH, queries: RaycastQuery[]): RaycastResult[] {
+  const rays = new Float32Array(queries.length * BVH_RAY_STRIDE);
+  for (let i = 0; i < queries.length; i++) {
+    const q = queries[i];
+    const o = i * BVH_RAY_STRIDE;
+    rays[o] = q.origin.x; rays[o + 1] = q.origin.y; rays[o + 2] = q.origin.z;
+    rays[o + 3] = q.direction.x; rays[o + 4] = q.direction.y; rays[o + 5] = q.direction.z;
+    rays[o + 6] = q.maxDistance;
+  }
+
+  const hits = bvhNative.raycastBatch(rays);
+  const results: RaycastResult[] = new Array(queries.length);
+  for (let i = 0; i < queries.length; i++) {
+    const q = queries[i];
+    const h = i * BVH_HIT_STRIDE;
+    const distance = hits[h];
+    const hit = distance >= 0;
+    results[i] = {
+      type: 'raycast',
+      id: q.id,
+      hit,
+      distance: hit ? distance : Infinity,
+      point: hit
+        ? {
+            x: q.origin.x + q.direction.x * distance,
+            y: q.origin.y + q.direction.y * distance,
+            z: q.origin.z + q.direction.z * distance,
+          }
+        : { x: 0, y: 0, z: 0 },
+      normal: hit ? { x: hits[h + 2], y: hits[h + 3], z: hits[h + 4] } : { x: 0, y: 0, z: 0 },
+    };
+  }
+  return results;
+}
+
 // Process sphere query
 function processSphere(query: SphereQuery): SphereResult {
+  if (nativeBVH) {
+    return {
+      type: 'sphere',
+      id: query.id,
+      candidateCount: nativeBVH.querySphere(query.center.x, query.center.y, query.center.z, query.radius).length,
+    };
+  }
+
   const center = new Vector3(query.center.x, query.center.y, query.center.z);
   let candidateCount = 0;
 
@@ -199,27 +248,29 @@ function processSphere(query: SphereQuery): SphereResult {
 if (parentPort) {
   parentPort.on('message', (message: WorkerMessage) => {
     if (message.type === 'setBVH') {
-      // Receive triangle data from main thread
-      triangles = message.triangles.map(t => ({
-        v0: new Vector3(t.v0.x, t.v0.y, t.v0.z),
-        v1: new Vector3(t.v1.x, t.v1.y, t.v1.z),
-        v2: new Vector3(t.v2.x, t.v2.y, t.v2.z),
-        normal: new Vector3(t.normal.x, t.normal.y, t.normal.z),
-      }));
-      buildWorkerBVH();
+      // Receive packed triangle data from main thread
+      buildWorkerBVH(message.vertices, message.source);
       parentPort!.postMessage({ type: 'bvhSet' });
     } else if (message.type === 'batch') {
       const results: (RaycastResult | SphereResult)[] = [];
+      const raycasts: RaycastQuery[] = [];
       for (const query of message.queries) {
         if (query.type === 'raycast') {
-          results.push(processRaycast(query));
+          if (nativeBVH) {
+            raycasts.push(query);
+          } else {
+            results.push(processRaycast(query));
+          }
         } else {
           results.push(processSphere(query));
         }
       }
+      if (nativeBVH && raycasts.length > 0) {
+        results.push(...processRaycastsNative(nativeBVH, raycasts));
+      }
       parentPort!.postMessage({ type: 'batch', results });
     } else if (message.type === 'raycast') {
-      parentPort!.postMessage(processRaycast(message));
+      parentPort!.postMessage(nativeBVH ? processRaycastsNative(nativeBVH, [message])[0] : processRaycast(message));
     } else if (message.type === 'sphere') {
       parentPort!.postMessage(processSphere(message));
     }
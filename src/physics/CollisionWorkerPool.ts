@@ -12,6 +12,7 @@ import { fileURLToPath } from 'url';
 import { dirname, join } from 'path';
 import { Vector3 } from '../engine/math/Vector3.js';
 import { CollisionTriangle, CollisionMesh } from './MeshCollision.js';
+import { packTriangles } from './NativeBVH.js';
 import {
   RaycastQuery,
   SphereQuery,
@@ -133,17 +134,12 @@ export class CollisionWorkerPool {
   updateCollisionMesh(mesh: CollisionMesh): void {
     if (!this._isInitialized || mesh.triangles.length === 0) return;
 
-    // Serialize triangles for workers
-    const triangleData = mesh.triangles.map((tri) => ({
-      v0: { x: tri.v0.x, y: tri.v0.y, z: tri.v0.z },
-      v1: { x: tri.v1.x, y: tri.v1.y, z: tri.v1.z },
-      v2: { x: tri.v2.x, y: tri.v2.y, z: tri.v2.z },
-      normal: { x: tri.normal.x, y: tri.normal.y, z: tri.normal.z },
-    }));
-
+    // Pack triangles once; each worker gets a structured-clone copy and builds its own BVH
+    // (or maps the tree from the map cache, sharing its pages with this thread)
     const message: SetBVHMessage = {
       type: 'setBVH',
-      triangles: triangleData,
+      vertices: packTriangles(mesh.triangles),
+      source: mesh.nativeSource ?? undefined,
     };
 
     // Send to all workers
@@ -10,6 +10,7 @@ import {
   createRay,
   getCollisionBVHStats,
 } from './BVH.js';
+import { NativeBVH, MappedBVHSource, packTriangles } from './NativeBVH.js';
 
 // A collision triangle
 export interface CollisionTriangle {
@@ -23,6 +24,8 @@ export interface CollisionTriangle {
 export class CollisionMesh {
   triangles: CollisionTriangle[] = [];
   bvh: CollisionBVHNode | null = null;
+  native: NativeBVH | null = null;  // Used instead of bvh when the addon is built
+  nativeSource: MappedBVHSource | null = null;  // Cache file native was mapped from (workers map it too)
   private bvhDirty: boolean = true;
 
   // Add a triangle to the collision mesh
@@ -41,9 +44,38 @@ export class CollisionMesh {
     this.bvhDirty = true;
   }
 
+  // Append triangles already filtered by addTriangle (9 vertex floats + 3 normal floats each)
+  addPackedTriangles(vertices: Float32Array, normals: Float32Array): void {
+    const count = Math.floor(vertices.length / 9);
+    for (let i = 0; i < count; i++) {
+      const v = i * 9;
+      const n = i * 3;
+      this.triangles.push({
+        v0: new Vector3(vertices[v], vertices[v + 1], vertices[v + 2]),
+        v1: new Vector3(vertices[v + 3], vertices[v + 4], vertices[v + 5]),
+        v2: new Vector3(vertices[v + 6], vertices[v + 7], vertices[v + 8]),
+        normal: new Vector3(normals[n], normals[n + 1], normals[n + 2]),
+      });
+    }
+    this.bvhDirty = true;
+  }
+
   // Build or rebuild the BVH acceleration structure
   buildBVH(): void {
-    if (!this.bvhDirty && this.bvh) return;
+    if (!this.bvhDirty && (this.bvh || this.native)) return;
+
+    this.native?.destroy();
+    this.nativeSource = null;
+    this.native = NativeBVH.build(packTriangles(this.triangles));
+    if (this.native) {
+      this.bvh = null;
+      this.bvhDirty = false;
+      const stats = this.native.getStats();
+      if (stats) {
+        console.log(`[BVH] Native: ${stats.triangles} tris, ${stats.nodes} nodes, ${stats.leaves} leaves in ${stats.buildMs.toFixed(1)}ms (${stats.buildThreads} threads)`);
+      }
+      return;
+    }
 
     this.bvh = buildCollisionBVH(this.triangles);
     this.bvhDirty = false;
@@ -55,9 +87,18 @@ export class CollisionMesh {
     }
   }
 
+  // Use a prebuilt native tree over the current triangles (e.g. mmap'd from a map cache)
+  adoptNativeBVH(native: NativeBVH, source: MappedBVHSource | null = null): void {
+    this.native?.destroy();
+    this.native = native;
+    this.nativeSource = source;
+    this.bvh = null;
+    this.bvhDirty = false;
+  }
+
   // Ensure BVH is built (call this before collision queries)
   ensureBVH(): void {
-    if (this.bvhDirty || !this.bvh) {
+    if (this.bvhDirty || (!this.bvh && !this.native)) {
       this.buildBVH();
     }
   }
@@ -66,10 +107,33 @@ export class CollisionMesh {
   clear(): void {
     this.triangles = [];
     this.bvh = null;
+    this.native?.destroy();
+    this.native = null;
+    this.nativeSource = null;
     this.bvhDirty = true;
   }
 }
 
+// Candidate triangles near a sphere (native BVH, JS BVH, or every triangle)
+export function querySphereCandidates(
+  mesh: CollisionMesh,
+  center: Vector3,
+  radius: number
+): CollisionTriangle[] {
+  if (mesh.native) {
+    const indices = mesh.native.querySphere(center.x, center.y, center.z, radius);
+    const candidates: CollisionTriangle[] = new Array(indices.length);
+    for (let i = 0; i < indices.length; i++) {
+      candidates[i] = mesh.triangles[indices[i]];
+    }
+    return candidates;
+  }
+  if (mesh.bvh) {
+    return queryCollisionBVHSphere(mesh.bvh, center, radius);
+  }
+  return mesh.triangles;
+}
+
 // Ray-triangle intersection using Möller–Trumbore algorithm (double-sided)
 export function rayTriangleIntersection(
   rayOrigin: Vector3,
@@ -132,8 +196,24 @@ export function raycastMesh(
   // Ensure BVH is built
   mesh.ensureBVH();
 
-  // Use BVH to get candidate triangles
-  if (mesh.bvh) {
+  if (mesh.native) {
+    const hit = mesh.native.raycast(
+      rayOrigin.x, rayOrigin.y, rayOrigin.z,
+      rayDirection.x, rayDirection.y, rayDirection.z,
+      maxDistance
+    );
+    if (hit) {
+      const tri = mesh.triangles[hit.triangle];
+      closestHit = {
+        hit: true,
+        distance: hit.distance,
+        point: Vector3.add(rayOrigin, Vector3.scale(rayDirection, hit.distance)),
+        normal: tri.normal.clone(),
+        triangle: tri,
+      };
+    }
+  } else if (mesh.bvh) {
+    // Use BVH to get candidate triangles
     const ray = createRay(rayOrigin, rayDirection);
     const candidates = queryCollisionBVH(mesh.bvh, ray, maxDistance);
 
@@ -359,9 +439,7 @@ function checkPositionBlocked(
 
   // Ensure BVH is built and query candidates
   mesh.ensureBVH();
-  const candidates = mesh.bvh
-    ? queryCollisionBVHSphere(mesh.bvh, checkPos, radius + 0.1)  // Slight margin for safety
-    : mesh.triangles;
+  const candidates = querySphereCandidates(mesh, checkPos, radius + 0.1);  // Slight margin for safety
 
   for (const tri of candidates) {
     const collision = sphereTriangleCollision(checkPos, radius, tri);
@@ -415,9 +493,7 @@ function resolveWallCollisions(
     const capsuleHalfHeight = (capsuleTop.y - capsuleBottom.y) / 2;
     const queryRadius = radius + capsuleHalfHeight + 0.1;  // Enclosing sphere + margin
 
-    const candidates = mesh.bvh
-      ? queryCollisionBVHSphere(mesh.bvh, capsuleCenter, queryRadius)
-      : mesh.triangles;
+    const candidates = querySphereCandidates(mesh, capsuleCenter, queryRadius);
 
     for (const tri of candidates) {
       const collision = capsuleTriangleCollision(capsuleBottom, capsuleTop, radius, tri);
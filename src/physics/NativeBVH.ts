@@ -0,0 +1,212 @@
+/**
+ * NativeBVH - Flat 4-wide BVH and batched raycasts in the bvh addon
+ *
+ * The tree is built in C (binned SAH, on the shared native job system) from
+ * packed triangle vertices and lives outside the JS heap. Queries go through
+ * typed arrays: one raycastBatch() call traces every ray of a frame, so
+ * callers pay the N-API crossing once instead of once per ray or per BVH node.
+ *
+ * Each instance is independent, so the main thread, CollisionWorker threads
+ * and the server can each build their own from the same Float32Array.
+ *
+ * A built tree can be serialized into a map cache (see MapCache) and later
+ * mmap'd straight from that file instead of being rebuilt.
+ */
+
+import { fileURLToPath } from 'url';
+import { dirname, join } from 'path';
+import { createRequire } from 'module';
+import { shareNativeJobs } from '../engine/NativeJobs.js';
+
+// Batch layouts (match RAY_STRIDE / HIT_STRIDE in native/bvh_simd.c)
+export const BVH_RAY_STRIDE = 7;  // ox, oy, oz, dx, dy, dz, maxDistance
+export const BVH_HIT_STRIDE = 5;  // distance (-1 = miss), triangle index, nx, ny, nz
+
+// Opaque handle owned by the addon (freed when garbage collected)
+export type BVHHandle = object;
+
+export interface NativeBVHStats {
+  triangles: number;
+  nodes: number;
+  leaves: number;
+  buildMs: number;
+  buildThreads: number;
+  bytes: number;
+  mapped: boolean;      // Tree lives in an mmap'd cache file
+}
+
+// Where a serialized tree sits in a cache file (see NativeBVH.map)
+export interface MappedBVHSource {
+  path: string;
+  byteOffset: number;
+  byteLength: number;
+}
+
+interface NativeBVHModule {
+  createBVH(triangles: Float32Array): BVHHandle;
+  raycastBatch(handle: BVHHandle, rays: Float32Array, hits: Float32Array, anyHit?: boolean): number;
+  querySphere(handle: BVHHandle, x: number, y: number, z: number, radius: number, out: Int32Array): number;
+  getStats(handle: BVHHandle): NativeBVHStats;
+  serializeBVH(handle: BVHHandle): ArrayBuffer;
+  mapBVH(path: string, byteOffset: number, byteLength: number): BVHHandle | null;
+  hasSIMD(): boolean;
+}
+
+let nativeModule: NativeBVHModule | null | undefined;
+
+function loadNativeModule(): NativeBVHModule | null {
+  if (nativeModule !== undefined) return nativeModule;
+  try {
+    const __filename = fileURLToPath(import.meta.url);
+    const __dirname = dirname(__filename);
+    const require = createRequire(import.meta.url);
+    nativeModule = require(join(__dirname, '../../native/build/Release/bvh.node')) as NativeBVHModule;
+    shareNativeJobs(nativeModule as object);
+  } catch {
+    // Not built - callers use the JS BVH
+    nativeModule = null;
+  }
+  return nativeModule;
+}
+
+/**
+ * Pack triangles into the 9-floats-per-triangle layout createBVH expects
+ */
+export function packTriangles(
+  triangles: ReadonlyArray<{ v0: { x: number; y: number; z: number }; v1: { x: number; y: number; z: number }; v2: { x: number; y: number; z: number } }>
+): Float32Array {
+  const data = new Float32Array(triangles.length * 9);
+  for (let i = 0; i < triangles.length; i++) {
+    const t = triangles[i];
+    const o = i * 9;
+    data[o] = t.v0.x; data[o + 1] = t.v0.y; data[o + 2] = t.v0.z;
+    data[o + 3] = t.v1.x; data[o + 4] = t.v1.y; data[o + 5] = t.v1.z;
+    data[o + 6] = t.v2.x; data[o + 7] = t.v2.y; data[o + 8] = t.v2.z;
+  }
+  return data;
+}
+
+export class NativeBVH {
+  private module: NativeBVHModule;
+  private handle: BVHHandle | null;
+  private sphereScratch = new Int32Array(1024);
+  private singleRay = new Float32Array(BVH_RAY_STRIDE);
+  private singleHit = new Float32Array(BVH_HIT_STRIDE);
+
+  private constructor(module: NativeBVHModule, handle: BVHHandle) {
+    this.module = module;
+    this.handle = handle;
+  }
+
+  /**
+   * Check if the bvh addon is built
+   */
+  static isAvailable(): boolean {
+    return loadNativeModule() !== null;
+  }
+
+  /**
+   * Build a BVH from packed vertices (see packTriangles)
+   * @returns null when the addon is unavailable or there are no triangles
+   */
+  static build(vertices: Float32Array): NativeBVH | null {
+    const module = loadNativeModule();
+    if (!module || vertices.length < 9) return null;
+    try {
+      return new NativeBVH(module, module.createBVH(vertices));
+    } catch (error) {
+      console.warn(`[NativeBVH] Build failed: ${error}`);
+      return null;
+    }
+  }
+
+  /**
+   * Map a tree written by serialize() from a file (read-only, shared pages)
+   *
+   * The blob's byteOffset in the file must be 64-byte aligned.
+   *
+   * @returns null when the addon is unavailable or the blob is stale or corrupt
+   */
+  static map(source: MappedBVHSource): NativeBVH | null {
+    const module = loadNativeModule();
+    if (!module || typeof module.mapBVH !== 'function') return null;
+    const handle = module.mapBVH(source.path, source.byteOffset, source.byteLength);
+    return handle ? new NativeBVH(module, handle) : null;
+  }
+
+  /**
+   * Flat copy of the tree for a map cache
+   */
+  serialize(): Uint8Array | null {
+    if (!this.handle || typeof this.module.serializeBVH !== 'function') return null;
+    return new Uint8Array(this.module.serializeBVH(this.handle));
+  }
+
+  /**
+   * Trace a batch of rays (BVH_RAY_STRIDE floats each)
+   *
+   * Directions need not be normalized; distances are in units of their length.
+   *
+   * @param hits Output, BVH_HIT_STRIDE floats per ray (allocated when omitted)
+   * @param anyHit Stop at the first hit (occlusion / line of sight)
+   */
+  raycastBatch(rays: Float32Array, hits?: Float32Array, anyHit: boolean = false): Float32Array {
+    const count = Math.floor(rays.length / BVH_RAY_STRIDE);
+    const out = hits ?? new Float32Array(count * BVH_HIT_STRIDE);
+    if (this.handle) {
+      this.module.raycastBatch(this.handle, rays, out, anyHit);
+    } else {
+      for (let i = 0; i < count; i++) out[i * BVH_HIT_STRIDE] = -1;
+    }
+    return out;
+  }
+
+  /**
+   * Trace one ray
+   * @returns Hit distance and triangle index, or null on a miss
+   */
+  raycast(
+    ox: number, oy: number, oz: number,
+    dx: number, dy: number, dz: number,
+    maxDistance: number,
+    anyHit: boolean = false
+  ): { distance: number; triangle: number } | null {
+    const ray = this.singleRay;
+    ray[0] = ox; ray[1] = oy; ray[2] = oz;
+    ray[3] = dx; ray[4] = dy; ray[5] = dz;
+    ray[6] = maxDistance;
+    this.raycastBatch(ray, this.singleHit, anyHit);
+    if (this.singleHit[0] < 0) return null;
+    return { distance: this.singleHit[0], triangle: this.singleHit[1] };
+  }
+
+  /**
+   * Indices of triangles whose leaves overlap a sphere
+   *
+   * The returned view is reused by the next call.
+   */
+  querySphere(x: number, y: number, z: number, radius: number): Int32Array {
+    if (!this.handle) return this.sphereScratch.subarray(0, 0);
+    let count = this.module.querySphere(this.handle, x, y, z, radius, this.sphereScratch);
+    while (count === this.sphereScratch.length) {
+      // Scratch was full - grow and query again
+      this.sphereScratch = new Int32Array(this.sphereScratch.length * 2);
+      count = this.module.querySphere(this.handle, x, y, z, radius, this.sphereScratch);
+    }
+    return this.sphereScratch.subarray(0, count);
+  }
+
+  /**
+   * Get build statistics
+   */
+  getStats(): NativeBVHStats | null {
+    return this.handle ? this.module.getStats(this.handle) : null;
+  }
+
+  /**
+   * Drop the handle (memory is released once it is garbage collected)
+   */
+  destroy(): void {
+    this.handle = null;
+  }
+}
@@ -70,6 +70,7 @@ export interface PlayerSnapshot {
   money: number;
   kills: number;
   deaths: number;
+  dormant?: boolean;  // Culled for this client (binary snapshots): position and angles are stale
 }
 
 export interface BotSnapshot {
@@ -85,6 +86,7 @@ export interface BotSnapshot {
   currentWeapon: WeaponType;
   kills: number;
   deaths: number;
+  dormant?: boolean;
 }
 
 export interface DroppedWeaponSnapshot {
@@ -201,6 +203,13 @@ export interface StartGameMessage {
   type: 'start_game';
 }
 
+// Acknowledge the newest binary snapshot decoded (0 = send a full one).
+// Also opts the client in to binary snapshots instead of JSON game_state.
+export interface SnapshotAckMessage {
+  type: 'snapshot_ack';
+  sequence: number;
+}
+
 export type ClientMessage =
   | ListRoomsMessage
   | CreateRoomMessage
@@ -215,7 +224,8 @@ export type ClientMessage =
   | SelectWeaponMessage
   | ChatMessage
   | ReadyMessage
-  | StartGameMessage;
+  | StartGameMessage
+  | SnapshotAckMessage;
 
 // ============ Server → Client Messages ============
 
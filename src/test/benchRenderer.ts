@@ -0,0 +1,364 @@
+#!/usr/bin/env npx tsx
+// Headless renderer benchmark over the bundled maps
+// Run with: npx tsx src/test/benchRenderer.ts [mapId ...] [options]   (default: every BSP map)
+//
+// Replays a camera path through each map at fixed terminal sizes and MSAA
+// levels, on the JS Rasterizer and the native renderer, with terminal output
+// counted instead of written. Reports frame-time percentiles, triangles/sec
+// and output bytes per frame, and writes the results as JSON.
+//
+// Options:
+//   --frames N          Measured frames per run (default 120, after 10 warmup frames)
+//   --sizes WxH,...     Terminal sizes in cells (default 80x24,160x48; half-block doubles rows)
+//   --msaa 1,4,16       MSAA sample counts (default 1,4,16)
+//   --backends js,native
+//   --mode halfblock|sixel
+//   --paths DIR         Recorded camera paths, <mapId>.json (default ~/.csterm/campaths,
+//                       record with the campath console command); maps without one fly
+//                       between their spawn points
+//   --out FILE          Results file (default bench-renderer-<timestamp>.json)
+//   --compare FILE      Print p50/p99 changes against an earlier results file
+
+import { readFileSync, writeFileSync } from 'fs';
+import { join } from 'path';
+import { cpus } from 'os';
+import { Renderer } from '../engine/Renderer.js';
+import { getNativeRenderer } from '../engine/NativeRenderer.js';
+import { CameraPath, CAMERA_PATH_DIR, loadCameraPath, sampleCameraPath, applyCameraPathSample } from '../engine/CameraPath.js';
+import { degToRad } from '../engine/math/MathUtils.js';
+import { MapRegistry } from '../maps/MapRegistry.js';
+import { LoadedMap } from '../maps/MapLoader.js';
+import { RenderMode, MSAAMode } from '../ui/MainMenu.js';
+
+const RESULTS_VERSION = 1;
+const WARMUP_FRAMES = 10;
+
+type Backend = 'js' | 'native';
+
+interface BenchOptions {
+  maps: string[];
+  frames: number;
+  sizes: [number, number][];
+  msaa: number[];
+  backends: Backend[];
+  mode: RenderMode;
+  pathsDir: string;
+  out: string;
+  compare: string | null;
+}
+
+interface RunResult {
+  map: string;
+  backend: Backend;
+  cols: number;
+  rows: number;
+  width: number;   // Framebuffer pixels
+  height: number;
+  msaa: number;
+  path: 'recorded' | 'spawns';
+  frames: number;
+  frameMs: { mean: number; p50: number; p95: number; p99: number; max: number };
+  fps: number;
+  trianglesPerFrame: number;
+  trianglesPerSec: number;
+  bytesPerFrame: number;
+}
+
+interface BenchResults {
+  version: number;
+  date: string;
+  host: { platform: string; arch: string; cpu: string; cores: number; node: string; simd: string | null };
+  options: { frames: number; mode: RenderMode };
+  runs: RunResult[];
+}
+
+function parseArgs(argv: string[]): BenchOptions {
+  const options: BenchOptions = {
+    maps: [],
+    frames: 120,
+    sizes: [[80, 24], [160, 48]],
+    msaa: [1, 4, 16],
+    backends: ['js', 'native'],
+    mode: 'halfblock',
+    pathsDir: CAMERA_PATH_DIR,
+    out: `bench-renderer-${new Date().toISOString().replace(/[:.]/g, '-')}.json`,
+    compare: null,
+  };
+
+  for (let i = 0; i < argv.length; i++) {
+    const arg = argv[i];
+    const value = (): string => {
+      if (i + 1 >= argv.length) throw new Error(`Missing value for ${arg}`);
+      return argv[++i];
+    };
+    switch (arg) {
+      case '--frames': options.frames = Math.max(2, parseInt(value())); break;
+      case '--sizes':
+        options.sizes = value().split(',').map(s => {
+          const [w, h] = s.split('x').map(n => parseInt(n));
+          if (!(w > 0 && h > 0)) throw new Error(`Bad size: ${s}`);
+          return [w, h] as [number, number];
+        });
+        break;
+      case '--msaa': options.msaa = value().split(',').map(n => parseInt(n)).filter(n => n === 1 || n === 4 || n === 16); break;
+      case '--backends': options.backends = value().split(',').filter((b): b is Backend => b === 'js' || b === 'native'); break;
+      case '--mode': options.mode = value() === 'sixel' ? 'sixel' : 'halfblock'; break;
+      case '--paths': options.pathsDir = value(); break;
+      case '--out': options.out = value(); break;
+      case '--compare': options.compare = value(); break;
+      default:
+        if (arg.startsWith('--')) throw new Error(`Unknown option: ${arg}`);
+        options.maps.push(arg);
+    }
+  }
+  return options;
+}
+
+/**
+ * Fallback flight when a map has no recorded path: eye height at each spawn
+ * (up to 8), a full look-around there, then a straight move to the next one.
+ */
+function spawnCameraPath(mapId: string, map: LoadedMap): CameraPath {
+  const spawns = map.spawns.length > 0 ? map.spawns.slice(0, 8) : [{ position: [0, 2, 0] as [number, number, number], angle: 0 }];
+  const samples: CameraPath['samples'] = [];
+  const LOOK_MS = 2000;
+  const MOVE_MS = 1000;
+  let t = 0;
+  for (let i = 0; i < spawns.length; i++) {
+    const [x, y, z] = spawns[i].position;
+    const yaw = degToRad(spawns[i].angle);
+    for (let k = 0; k <= 8; k++) {
+      samples.push({ t: t + (LOOK_MS * k) / 8, x, y: y + 1.7, z, yaw: yaw + (Math.PI * 2 * k) / 8, pitch: 0.15 * Math.sin(k) });
+    }
+    t += LOOK_MS + MOVE_MS;
+  }
+  return { version: 1, map: mapId, fov: degToRad(90), samples };
+}
+
+function percentile(sorted: number[], p: number): number {
+  if (sorted.length === 0) return 0;
+  return sorted[Math.min(sorted.length - 1, Math.max(0, Math.ceil(p * sorted.length) - 1))];
+}
+
+const yieldToEventLoop = (): Promise<void> => new Promise(resolve => setImmediate(resolve));
+
+/**
+ * Render one configuration. Terminal output is counted, not written; each
+ * frame yields to the event loop like the game loop does, so pipelined
+ * native frames deliver their output as they would in play.
+ */
+async function runBenchmark(
+  mapId: string, map: LoadedMap, path: CameraPath, recorded: boolean,
+  backend: Backend, cols: number, rows: number, msaa: number, options: BenchOptions
+): Promise<RunResult | null> {
+  const renderer = new Renderer(cols, rows);
+  renderer.setRenderMode(options.mode);
+  renderer.setMSAAMode((msaa === 16 ? '16x' : msaa === 4 ? '4x' : 'none') as MSAAMode);
+  renderer.setUseNativeRenderer(backend === 'native');
+  if (backend === 'native' && !renderer.isUsingNativeRenderer()) return null;
+
+  // Same scene setup as a BSP map in game (no HUD so runs only differ in the scene)
+  renderer.showCrosshair = false;
+  renderer.showHUD = false;
+  renderer.showStats = false;
+  renderer.setClearColor(map.skyColor);
+  const rasterizer = renderer.getRasterizer();
+  rasterizer.ambientLight = map.ambientLight;
+  rasterizer.enableLighting = true;
+  rasterizer.enableDepthShading = true;
+  rasterizer.maxDepth = 500;
+  rasterizer.nearPlane = 0.01;
+  rasterizer.enableBackfaceCulling = false;
+  for (const obj of map.renderObjects) {
+    renderer.addObject(obj);
+  }
+  renderer.setVisibility(map.visibility ?? null);
+
+  const camera = renderer.getCamera();
+  camera.near = 0.01;
+  camera.far = 500;
+  camera.setFov(path.fov * 180 / Math.PI);
+
+  // Count output instead of writing it
+  let bytes = 0;
+  const write = process.stdout.write;
+  process.stdout.write = ((chunk: string | Uint8Array, encoding?: unknown, callback?: unknown): boolean => {
+    bytes += typeof chunk === 'string' ? Buffer.byteLength(chunk) : chunk.length;
+    const done = typeof encoding === 'function' ? encoding : callback;
+    if (typeof done === 'function') done();
+    return true;
+  }) as typeof process.stdout.write;
+
+  const frameMs: number[] = [];
+  let triangles = 0;
+  let measuredBytes = 0;
+  try {
+    for (let f = 0; f < WARMUP_FRAMES + options.frames; f++) {
+      const measured = f >= WARMUP_FRAMES;
+      const u = measured ? (f - WARMUP_FRAMES) / (options.frames - 1) : 0;
+      applyCameraPathSample(camera, sampleCameraPath(path, u));
+
+      if (measured && frameMs.length === 0) bytes = 0;
+      const start = performance.now();
+      const stats = renderer.render();
+      await yieldToEventLoop();
+      if (!measured) continue;
+      frameMs.push(performance.now() - start);
+      triangles += stats.triangles;
+    }
+
+    // Let the last pipelined frame's output arrive
+    await new Promise(resolve => setTimeout(resolve, 50));
+    measuredBytes = bytes;
+  } finally {
+    process.stdout.write = write;
+    renderer.clearObjects();
+  }
+
+  const totalMs = frameMs.reduce((a, b) => a + b, 0);
+  const sorted = [...frameMs].sort((a, b) => a - b);
+  const mean = totalMs / frameMs.length;
+  return {
+    map: mapId,
+    backend,
+    cols,
+    rows,
+    width: renderer.getWidth(),
+    height: renderer.getHeight(),
+    msaa,
+    path: recorded ? 'recorded' : 'spawns',
+    frames: frameMs.length,
+    frameMs: {
+      mean,
+      p50: percentile(sorted, 0.5),
+      p95: percentile(sorted, 0.95),
+      p99: percentile(sorted, 0.99),
+      max: sorted[sorted.length - 1],
+    },
+    fps: 1000 / mean,
+    trianglesPerFrame: triangles / frameMs.length,
+    trianglesPerSec: triangles / (totalMs / 1000),
+    bytesPerFrame: measuredBytes / frameMs.length,
+  };
+}
+
+function runKey(r: RunResult): string {
+  return `${r.map}/${r.backend}/${r.cols}x${r.rows}/msaa${r.msaa}`;
+}
+
+function printRun(r: RunResult): void {
+  console.log(
+    `  ${r.backend.padEnd(6)} ${`${r.cols}x${r.rows}`.padStart(7)} msaa=${r.msaa.toString().padEnd(2)}  ` +
+    `p50 ${r.frameMs.p50.toFixed(2).padStart(7)}ms  p99 ${r.frameMs.p99.toFixed(2).padStart(7)}ms  ` +
+    `${r.fps.toFixed(1).padStart(6)} fps  ${(r.trianglesPerSec / 1e6).toFixed(2).padStart(6)} Mtri/s  ` +
+    `${(r.bytesPerFrame / 1024).toFixed(1).padStart(7)} KB/frame`
+  );
+}
+
+// Native speedup over JS for each map/size/MSAA measured on both
+function printSpeedups(runs: RunResult[]): void {
+  const js = new Map(runs.filter(r => r.backend === 'js').map(r => [runKey({ ...r, backend: 'native' }), r] as [string, RunResult]));
+  const rows = runs.filter(r => r.backend === 'native' && js.has(runKey(r)));
+  if (rows.length === 0) return;
+  console.log('\nNative vs JS (p50 frame time):');
+  for (const r of rows) {
+    const base = js.get(runKey(r))!;
+    console.log(`  ${r.map.padEnd(14)} ${`${r.cols}x${r.rows}`.padStart(7)} msaa=${r.msaa.toString().padEnd(2)}  ${(base.frameMs.p50 / r.frameMs.p50).toFixed(1).padStart(6)}x`);
+  }
+}
+
+function printComparison(runs: RunResult[], file: string): void {
+  let previous: BenchResults;
+  try {
+    previous = JSON.parse(readFileSync(file, 'utf8')) as BenchResults;
+  } catch (error) {
+    console.error(`Cannot read ${file}: ${error}`);
+    return;
+  }
+  if (previous.version !== RESULTS_VERSION) {
+    console.error(`${file}: results version ${previous.version}, expected ${RESULTS_VERSION}`);
+    return;
+  }
+  const before = new Map(previous.runs.map(r => [runKey(r), r] as [string, RunResult]));
+  const pct = (now: number, then: number): string => {
+    const change = ((now - then) / then) * 100;
+    return `${change >= 0 ? '+' : ''}${change.toFixed(1)}%`.padStart(8);
+  };
+  console.log(`\nChange vs ${file} (negative = faster):`);
+  for (const r of runs) {
+    const old = before.get(runKey(r));
+    if (!old) continue;
+    console.log(`  ${runKey(r).padEnd(36)} p50 ${pct(r.frameMs.p50, old.frameMs.p50)}  p99 ${pct(r.frameMs.p99, old.frameMs.p99)}`);
+  }
+}
+
+async function main(): Promise<void> {
+  const options = parseArgs(process.argv.slice(2));
+  MapRegistry.initialize();
+  const maps = MapRegistry.getAvailableMaps().filter(
+    m => m.type === 'bsp' && (options.maps.length === 0 || options.maps.includes(m.id))
+  );
+  if (maps.length === 0) {
+    console.error('No maps to benchmark');
+    process.exit(1);
+  }
+
+  const native = getNativeRenderer();
+  if (options.backends.includes('native') && !native.isAvailable) {
+    console.log('Native renderer not built; running the JS backend only (npm run build:native)');
+  }
+
+  console.log(`=== Renderer Benchmark (${options.mode}, ${options.frames} frames per run) ===`);
+  const runs: RunResult[] = [];
+  for (const info of maps) {
+    let map: LoadedMap;
+    try {
+      map = await MapRegistry.loadMap(info.id);
+    } catch (error) {
+      console.error(`${info.id}: ${error}`);
+      continue;
+    }
+    const recordedPath = loadCameraPath(join(options.pathsDir, `${info.id}.json`));
+    const path = recordedPath ?? spawnCameraPath(info.id, map);
+    console.log(`\n${info.id} (${recordedPath ? `recorded path, ${path.samples.length} samples` : 'spawn flight'}):`);
+
+    for (const [cols, rows] of options.sizes) {
+      for (const msaa of options.msaa) {
+        for (const backend of options.backends) {
+          const result = await runBenchmark(info.id, map, path, !!recordedPath, backend, cols, rows, msaa, options);
+          if (!result) continue;
+          runs.push(result);
+          printRun(result);
+        }
+      }
+    }
+  }
+
+  printSpeedups(runs);
+  if (options.compare) printComparison(runs, options.compare);
+
+  const cpuList = cpus();
+  const results: BenchResults = {
+    version: RESULTS_VERSION,
+    date: new Date().toISOString(),
+    host: {
+      platform: process.platform,
+      arch: process.arch,
+      cpu: cpuList[0]?.model ?? 'unknown',
+      cores: cpuList.length,
+      node: process.version,
+      simd: native.isAvailable ? native.getSIMDLevel() : null,
+    },
+    options: { frames: options.frames, mode: options.mode },
+    runs,
+  };
+  writeFileSync(options.out, JSON.stringify(results, null, 2));
+  console.log(`\nResults written to ${options.out}`);
+  console.log('\n=== Benchmark Complete ===');
+  process.exit(0);
+}
+
+main().catch(error => {
+  console.error(error);
+  process.exit(1);
+});
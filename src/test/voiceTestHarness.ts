@@ -17,6 +17,7 @@ import {
   serializeVoiceFrame,
   deserializeVoiceFrame,
   isVoiceFrame,
+  unpackVoiceBatch,
   VoiceFrame,
   VOICE_FRAME_TYPE,
   VOICE_HEADER_SIZE,
@@ -148,7 +149,9 @@ class TestVoiceClient {
   private handleMessage(data: Buffer | string) {
     // Check if it's binary (voice frame)
     if (Buffer.isBuffer(data) && isVoiceFrame(new Uint8Array(data))) {
-      this.handleVoiceFrame(new Uint8Array(data));
+      for (const frame of unpackVoiceBatch(new Uint8Array(data))) {
+        this.handleVoiceFrame(frame);
+      }
       return;
     }
 
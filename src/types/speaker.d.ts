@@ -9,6 +9,7 @@ declare module 'speaker' {
     float?: boolean;
     samplesPerFrame?: number;
     device?: string;
+    highWaterMark?: number;  // Passed through to Writable
   }
 
   class Speaker extends Writable {
@@ -3,11 +3,12 @@
 
 import { GameModeType } from '../game/GameMode.js';
 import { MapRegistry, MapInfo as RegistryMapInfo } from '../maps/MapRegistry.js';
+import { VOICE_MIN_DISTANCE, VOICE_MAX_DISTANCE } from '../voice/types.js';
 
 // Rendering mode types
 export type RenderMode = 'basic' | 'halfblock' | 'sixel';
 export type MSAAMode = 'none' | '4x' | '16x';
-export type TextureFilterMode = 'normal' | 'pixelated' | 'blockavg';
+export type TextureFilterMode = 'normal' | 'bilinear' | 'trilinear' | 'pixelated' | 'blockavg';
 
 // Settings tab types
 export type SettingsTab = 'controls' | 'graphics' | 'audio';
@@ -114,7 +115,7 @@ function loadSettingsFromDisk(): Partial<Settings> {
       // Graphics
       if (['basic', 'halfblock', 'sixel'].includes(parsed.renderMode)) settings.renderMode = parsed.renderMode;
       if (['none', '4x', '16x'].includes(parsed.msaaMode)) settings.msaaMode = parsed.msaaMode;
-      if (['normal', 'pixelated', 'blockavg'].includes(parsed.textureFilter)) settings.textureFilter = parsed.textureFilter;
+      if (['normal', 'bilinear', 'trilinear', 'pixelated', 'blockavg'].includes(parsed.textureFilter)) settings.textureFilter = parsed.textureFilter;
       if (typeof parsed.sixelResolution === 'number') settings.sixelResolution = parsed.sixelResolution;
       if (typeof parsed.targetFps === 'number') settings.targetFps = parsed.targetFps;
       if (typeof parsed.fov === 'number') settings.fov = parsed.fov;
@@ -128,7 +129,9 @@ function loadSettingsFromDisk(): Partial<Settings> {
       if (typeof parsed.voicePTTEnabled === 'boolean') settings.voicePTTEnabled = parsed.voicePTTEnabled;
       if (typeof parsed.voicePTTKey === 'string') settings.voicePTTKey = parsed.voicePTTKey;
       if (typeof parsed.voiceVADSensitivity === 'number') settings.voiceVADSensitivity = parsed.voiceVADSensitivity;
-      if (typeof parsed.voiceMaxDistance === 'number') settings.voiceMaxDistance = parsed.voiceMaxDistance;
+      if (typeof parsed.voiceMaxDistance === 'number') {
+        settings.voiceMaxDistance = Math.max(VOICE_MIN_DISTANCE, Math.min(VOICE_MAX_DISTANCE, parsed.voiceMaxDistance));
+      }
       if (typeof parsed.voiceSpatialEnabled === 'boolean') settings.voiceSpatialEnabled = parsed.voiceSpatialEnabled;
       if (parsed.voiceCodec === 'codec2' || parsed.voiceCodec === 'lpc') settings.voiceCodec = parsed.voiceCodec;
       if (typeof parsed.voiceCodec2Mode === 'string') settings.voiceCodec2Mode = parsed.voiceCodec2Mode;
@@ -198,7 +201,7 @@ export class MainMenu {
   // Render mode options for cycling (sixel kept in type for debug mode but hidden from UI)
   private renderModes: RenderMode[] = ['basic', 'halfblock'];
   private msaaModes: MSAAMode[] = ['none', '4x', '16x'];
-  private textureFilterModes: TextureFilterMode[] = ['normal', 'pixelated', 'blockavg'];
+  private textureFilterModes: TextureFilterMode[] = ['normal', 'bilinear', 'trilinear', 'pixelated', 'blockavg'];
 
   // FOV options
   private fovOptions = [70, 80, 90, 100, 110, 120];
@@ -721,7 +724,7 @@ export class MainMenu {
   }
 
   private adjustVoiceMaxDistance(delta: number): void {
-    this.settings.voiceMaxDistance = Math.max(10, Math.min(200, this.settings.voiceMaxDistance + delta * 10));
+    this.settings.voiceMaxDistance = Math.max(VOICE_MIN_DISTANCE, Math.min(VOICE_MAX_DISTANCE, this.settings.voiceMaxDistance + delta * 10));
     this.onSettingsChange?.(this.settings);
     saveSettingsToDisk(this.settings);
   }
@@ -881,6 +884,8 @@ export class MainMenu {
       case 'Texture Filter':
         const filterNames: Record<TextureFilterMode, string> = {
           'normal': 'Normal',
+          'bilinear': 'Bilinear',
+          'trilinear': 'Trilinear',
           'pixelated': 'Pixelated',
           'blockavg': 'Block Avg',
         };
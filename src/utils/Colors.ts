@@ -208,6 +208,11 @@ export class Color {
     return `#${toHex(this.r)}${toHex(this.g)}${toHex(this.b)}`;
   }
 
+  // Pack as 0xRRGGBB (channels wrapped to bytes, as a Uint8Array store would)
+  toRGB24(): number {
+    return ((this.r & 255) << 16) | ((this.g & 255) << 8) | (this.b & 255);
+  }
+
   brightness(): number {
     return (this.r * 299 + this.g * 587 + this.b * 114) / 1000;
   }
@@ -24,6 +24,7 @@ import {
   VOICE_FRAME_SAMPLES,
 } from "./types.js";
 import { voiceLog } from "./voiceLog.js";
+import { shareNativeJobs } from "../engine/NativeJobs.js";
 
 // Re-export the enum for backwards compatibility
 export { Codec2Mode as Codec2ModeEnum } from "./types.js";
@@ -44,15 +45,77 @@ export type Codec2ModeString =
   | "700C";
 
 // Native module interface
-interface NativeCodec2 {
+export interface NativeCodec2 {
   getModes(): Codec2ModeString[];
   getModeInfo(mode: Codec2ModeString): Codec2ModeInfo;
   encode(mode: Codec2ModeString, samples: Int16Array): Uint8Array;
   decode(mode: Codec2ModeString, bytes: Uint8Array): Int16Array;
   encodeFrame(mode: Codec2ModeString, samples: Int16Array): Uint8Array;
   decodeFrame(mode: Codec2ModeString, bytes: Uint8Array): Int16Array;
+  // Per-stream handles (own codec state, caller-provided output buffers)
+  createEncoder(mode: Codec2ModeString): Codec2Handle;
+  createDecoder(mode: Codec2ModeString): Codec2Handle;
+  destroy(handle: Codec2Handle): void;
+  encodeInto(handle: Codec2Handle, samples: Int16Array, out: Uint8Array): number;
+  decodeInto(handle: Codec2Handle, bytes: Uint8Array, out: Int16Array): number;
+  // SIMD mix / resample kernels (write into caller buffers)
+  mixInto(streams: Int16Array[], gains: Float32Array, out: Int16Array): number;
+  createResampler(channels: 1 | 2): ResamplerHandle;
+  resampleInto(handle: ResamplerHandle, input: Int16Array, out: Int16Array): number;
+  // Voice engine thread (jitter, decode and spatial mix off the main thread)
+  voiceEngineStart(mode: Codec2ModeString, outputRate?: number): boolean;
+  voiceEngineStop(): void;
+  voiceEnginePush(senderId: number, sequence: number, bytes: Uint8Array): boolean;
+  voiceEngineSetListener(x: number, y: number, z: number, yaw: number): void;
+  voiceEngineSetSourcePosition(senderId: number, x: number, y: number, z: number): void;
+  voiceEngineRemoveSource(senderId: number): void;
+  voiceEngineClear(): void;
+  voiceEngineSetMix(maxDistance: number, outputVolume: number, spatialEnabled: boolean): void;
+  voiceEngineRead(out: Int16Array): number;
+  voiceEngineGetSpeaking(windowMs: number): number[];
+  voiceEngineGetStats(): VoiceEngineStats;
+  // Effect mixer thread (wavetable voices + routed voice, 48kHz stereo)
+  audioLoadEffect(id: number, samples: Float32Array): void;
+  audioStart(targetMs?: number, routeVoice?: boolean): boolean;
+  audioStop(): void;
+  audioPlay(id: number, x: number, y: number, z: number, volume: number, priority: number, positional: boolean): boolean;
+  audioStopAll(): void;
+  audioSetVolume(volume: number): void;
+  audioRead(out: Int16Array): number;
+  audioGetStats(): AudioMixerStats;
 }
 
+export interface VoiceEngineStats {
+  running: boolean;
+  packetsDropped: number;   // Packets the engine could not queue
+  framesMixed: number;      // Output frames produced
+  framesLost: number;       // Missing packets played as silence
+  outputOverflows: number;  // Frames dropped because nobody drained the output
+  outputQueued: number;     // Samples waiting to be read
+}
+
+export interface AudioMixerStats {
+  running: boolean;
+  voiceRouted: boolean;     // Voice engine output is mixed in (48kHz engine only; voiceEngineRead returns 0)
+  activeVoices: number;     // Effects playing
+  started: number;          // Effects started
+  stolen: number;           // Playing effects cut off for a higher priority one
+  dropped: number;          // Effects not played (pool full of higher priorities)
+  underruns: number;        // Reads that found less audio than asked for
+  voiceDropped: number;     // Voice frames dropped because the backlog grew too long
+  outputQueued: number;     // Samples waiting to be read
+}
+
+// Opaque native stream handle
+type Codec2Handle = object;
+
+// Opaque native resampler handle
+type ResamplerHandle = object;
+
+// Native resampler ratio (codec2 8kHz -> 48kHz device rate)
+export const RESAMPLE_OUTPUT_RATE = 48000;
+const RESAMPLE_FACTOR = RESAMPLE_OUTPUT_RATE / VOICE_SAMPLE_RATE;
+
 export interface Codec2ModeInfo {
   samplesPerFrame: number; // Audio samples per frame (160 or 320 @ 8kHz)
   bytesPerFrame: number; // Compressed bytes per frame
@@ -72,7 +135,9 @@ const nativeCodec2: NativeCodec2 | null = (() => {
 
     for (const p of paths) {
       try {
-        return require(p);
+        const module = require(p);
+        shareNativeJobs(module);
+        return module;
       } catch {
         continue;
       }
@@ -84,8 +149,15 @@ const nativeCodec2: NativeCodec2 | null = (() => {
   }
 })();
 
+/**
+ * Get the native codec2 module (null when not built)
+ */
+export function getNativeCodec2(): NativeCodec2 | null {
+  return nativeCodec2;
+}
+
 // Map enum to string mode
-function modeEnumToString(mode: Codec2ModeEnum): Codec2ModeString {
+export function modeEnumToString(mode: Codec2ModeEnum): Codec2ModeString {
   switch (mode) {
     case Codec2ModeEnum.MODE_3200:
       return "3200";
@@ -110,6 +182,10 @@ function modeEnumToString(mode: Codec2ModeEnum): Codec2ModeString {
  *
  * Now uses native Codec2 library via N-API bindings.
  * Falls back to LPC-based synthesis when native module unavailable.
+ *
+ * Each instance owns its own native encoder and decoder state, so use one
+ * instance per remote speaker when decoding (Codec2 frames depend on the
+ * previous frames of the same stream).
  */
 export class Codec2 {
   private modeEnum: Codec2ModeEnum;
@@ -117,6 +193,10 @@ export class Codec2 {
   private modeInfo: Codec2ModeInfo | null = null;
   private _isInitialized = false;
 
+  // Native stream handles (created on first use)
+  private encoderHandle: Codec2Handle | null = null;
+  private decoderHandle: Codec2Handle | null = null;
+
   // Fallback LPC state
   private hpState1 = 0;
   private hpState2 = 0;
@@ -249,7 +329,12 @@ export class Codec2 {
     let result: Uint8Array;
 
     if (nativeCodec2) {
-      result = nativeCodec2.encode(this.modeString, samples);
+      const frames = Math.floor(samples.length / this.getSamplesPerFrame());
+      if (frames === 0) {
+        throw new Error("Input too short for even one frame");
+      }
+      result = new Uint8Array(frames * this.getBytesPerFrame());
+      this.encodeInto(samples, result);
     } else {
       result = this.fallbackEncode(samples);
     }
@@ -280,7 +365,12 @@ export class Codec2 {
     let result: Int16Array;
 
     if (nativeCodec2) {
-      result = nativeCodec2.decode(this.modeString, bits);
+      const frames = Math.floor(bits.length / this.getBytesPerFrame());
+      if (frames === 0) {
+        throw new Error("Input too short for even one frame");
+      }
+      result = new Int16Array(frames * this.getSamplesPerFrame());
+      this.decodeInto(bits, result);
     } else {
       result = this.fallbackDecode(bits);
     }
@@ -293,6 +383,50 @@ export class Codec2 {
     return result;
   }
 
+  /**
+   * Encode into a caller-provided buffer (native only, no allocation)
+   *
+   * @param samples 16-bit signed PCM samples at 8kHz (whole frames are encoded)
+   * @param out Destination, at least frames * bytesPerFrame long
+   * @returns Number of bytes written
+   */
+  encodeInto(samples: Int16Array, out: Uint8Array): number {
+    if (!this._isInitialized) {
+      throw new Error("Codec2 not initialized");
+    }
+    if (!nativeCodec2) {
+      const encoded = this.fallbackEncode(samples);
+      out.set(encoded);
+      return encoded.length;
+    }
+    if (!this.encoderHandle) {
+      this.encoderHandle = nativeCodec2.createEncoder(this.modeString);
+    }
+    return nativeCodec2.encodeInto(this.encoderHandle, samples, out);
+  }
+
+  /**
+   * Decode into a caller-provided buffer (native only, no allocation)
+   *
+   * @param bits Compressed codec2 data (whole frames are decoded)
+   * @param out Destination, at least frames * samplesPerFrame long
+   * @returns Number of samples written
+   */
+  decodeInto(bits: Uint8Array, out: Int16Array): number {
+    if (!this._isInitialized) {
+      throw new Error("Codec2 not initialized");
+    }
+    if (!nativeCodec2) {
+      const decoded = this.fallbackDecode(bits);
+      out.set(decoded);
+      return decoded.length;
+    }
+    if (!this.decoderHandle) {
+      this.decoderHandle = nativeCodec2.createDecoder(this.modeString);
+    }
+    return nativeCodec2.decodeInto(this.decoderHandle, bits, out);
+  }
+
   /**
    * Get samples per frame
    */
@@ -307,6 +441,20 @@ export class Codec2 {
     return this.modeInfo?.bytesPerFrame || 16;
   }
 
+  /**
+   * Get codec mode
+   */
+  get mode(): Codec2ModeEnum {
+    return this.modeEnum;
+  }
+
+  /**
+   * Get codec mode as the native mode string
+   */
+  get modeName(): Codec2ModeString {
+    return this.modeString;
+  }
+
   /**
    * Check if initialized
    */
@@ -326,6 +474,12 @@ export class Codec2 {
    * Cleanup resources
    */
   destroy(): void {
+    if (nativeCodec2) {
+      if (this.encoderHandle) nativeCodec2.destroy(this.encoderHandle);
+      if (this.decoderHandle) nativeCodec2.destroy(this.decoderHandle);
+    }
+    this.encoderHandle = null;
+    this.decoderHandle = null;
     this._isInitialized = false;
   }
 
@@ -643,6 +797,46 @@ export function destroyCodec2(): void {
   }
 }
 
+/**
+ * Streaming 8kHz -> 48kHz polyphase upsampler (native only)
+ *
+ * Keeps filter history between calls, so use one per continuous stream.
+ * Output goes into a reused buffer that is valid until the next call.
+ */
+export class Resampler8kTo48k {
+  private handle: ResamplerHandle | null = null;
+  private output: Int16Array = new Int16Array(0);
+
+  constructor(private channels: 1 | 2 = 2) {
+    if (nativeCodec2 && typeof nativeCodec2.createResampler === "function") {
+      this.handle = nativeCodec2.createResampler(channels);
+    }
+  }
+
+  /**
+   * Check if the native resampler is available
+   */
+  get isAvailable(): boolean {
+    return this.handle !== null;
+  }
+
+  /**
+   * Upsample 8kHz samples (interleaved if stereo)
+   *
+   * @returns 48kHz samples, or the input unchanged when unavailable
+   */
+  process(samples: Int16Array): Int16Array {
+    if (!nativeCodec2 || !this.handle) return samples;
+
+    const needed = samples.length * RESAMPLE_FACTOR;
+    if (this.output.length < needed) {
+      this.output = new Int16Array(needed);
+    }
+    const written = nativeCodec2.resampleInto(this.handle, samples, this.output);
+    return this.output.subarray(0, written);
+  }
+}
+
 /**
  * Resample audio from one sample rate to 8kHz
  */
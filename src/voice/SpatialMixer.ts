@@ -8,10 +8,19 @@
 import { Vector3 } from '../engine/math/Vector3.js';
 import { SpatialParams, VOICE_FRAME_SAMPLES, VOICE_SAMPLE_RATE } from './types.js';
 import { voiceLog } from './voiceLog.js';
+import { getNativeCodec2 } from './Codec2.js';
+
+// Native SIMD mix kernel (null = mix in JS)
+const nativeMix = (() => {
+  const native = getNativeCodec2();
+  return native && typeof native.mixInto === 'function' ? native : null;
+})();
 
 // Spatial audio constants (matching SoundEngine)
 const DEFAULT_MAX_DISTANCE = 50;  // Beyond this, voice is silent
 const REFERENCE_DISTANCE = 5;      // Distance at which voice is at full volume
+const MIN_VOLUME = 0.01;           // Quieter than this is not mixed
+const MAX_MIX_STREAMS = 64;        // Matches the native kernel's limit
 
 /**
  * Voice stream state for mixing
@@ -37,6 +46,11 @@ export class SpatialMixer {
   // Output buffer (stereo interleaved at 8kHz)
   private outputBuffer: Int16Array = new Int16Array(VOICE_FRAME_SAMPLES * 2);
 
+  // Scratch reused by mixVoices
+  private mixFrames: Int16Array[] = [];
+  private mixGains: Float32Array = new Float32Array(MAX_MIX_STREAMS * 2);
+  private mixAccum: Float32Array = new Float32Array(VOICE_FRAME_SAMPLES * 2);
+
   /**
    * Update listener position and orientation
    */
@@ -211,6 +225,61 @@ export class SpatialMixer {
     return output;
   }
 
+  /**
+   * Spatialize and mix one mono frame per sender in a single pass
+   * Uses the native SIMD kernel when available; never allocates per stream.
+   *
+   * @param senderIds Sender for each frame
+   * @param frames Mono 16-bit frames from the decoders
+   * @returns Mixed stereo frame (reused buffer, valid until the next call),
+   *          or null if every sender is too quiet
+   */
+  mixVoices(senderIds: number[], frames: Int16Array[]): Int16Array | null {
+    this.mixFrames.length = 0;
+    let longest = 0;
+
+    for (let i = 0; i < frames.length && this.mixFrames.length < MAX_MIX_STREAMS; i++) {
+      const spatial = this.getStreamSpatial(senderIds[i]);
+      if (spatial.volume < MIN_VOLUME) continue;
+
+      // Constant-power pan, same as applySpatial
+      const slot = this.mixFrames.length * 2;
+      this.mixGains[slot] = spatial.volume * Math.cos((spatial.pan + 1) * Math.PI / 4);
+      this.mixGains[slot + 1] = spatial.volume * Math.sin((spatial.pan + 1) * Math.PI / 4);
+      this.mixFrames.push(frames[i]);
+      longest = Math.max(longest, frames[i].length);
+    }
+
+    if (this.mixFrames.length === 0) return null;
+
+    if (this.outputBuffer.length < longest * 2) {
+      this.outputBuffer = new Int16Array(longest * 2);
+      this.mixAccum = new Float32Array(longest * 2);
+    }
+    const output = this.outputBuffer.subarray(0, longest * 2);
+
+    if (nativeMix) {
+      nativeMix.mixInto(this.mixFrames, this.mixGains, output);
+      return output;
+    }
+
+    const accum = this.mixAccum;
+    accum.fill(0, 0, longest * 2);
+    for (let s = 0; s < this.mixFrames.length; s++) {
+      const frame = this.mixFrames[s];
+      const left = this.mixGains[s * 2];
+      const right = this.mixGains[s * 2 + 1];
+      for (let i = 0; i < frame.length; i++) {
+        accum[i * 2] += frame[i] * left;
+        accum[i * 2 + 1] += frame[i] * right;
+      }
+    }
+    for (let i = 0; i < longest * 2; i++) {
+      output[i] = Math.max(-32768, Math.min(32767, Math.round(accum[i])));
+    }
+    return output;
+  }
+
   // Debug counter
   private debugProcessCount = 0;
 
@@ -230,7 +299,7 @@ export class SpatialMixer {
       voiceLog(`[SpatialMixer] processVoice: sender=${senderId.toString(16)}, volume=${spatial.volume.toFixed(3)}, pan=${spatial.pan.toFixed(2)}`);
     }
 
-    if (spatial.volume < 0.01) {
+    if (spatial.volume < MIN_VOLUME) {
       if (this.debugProcessCount % 50 === 1) {
         voiceLog(`[SpatialMixer] Volume too low (${spatial.volume}), returning null`);
       }
@@ -11,16 +11,19 @@ import {
   VoiceEventCallback,
   VoiceEvent,
   VOICE_FRAME_TYPE,
+  VOICE_BATCH_FRAME_TYPE,
   VOICE_FLAG_VAD,
   VOICE_FLAG_TEAM_ONLY,
   serializeVoiceFrame,
   deserializeVoiceFrame,
   truncatePlayerId,
   isVoiceFrame,
+  unpackVoiceBatch,
 } from './types.js';
 import { voiceLog } from './voiceLog.js';
 import { Codec2, getCodec2Encoder } from './Codec2.js';
 import { JitterBuffer, JitterBufferManager } from './JitterBuffer.js';
+import { VoiceEngine } from './VoiceEngine.js';
 
 // WebSocket binary send callback type
 type SendBinaryCallback = (data: Uint8Array) => void;
@@ -35,9 +38,12 @@ export class VoiceClient {
   private startTime: number = 0;
   private sendBinary: SendBinaryCallback | null = null;
   private codec: Codec2;
+  private decoders: Map<number, Codec2> = new Map();  // Per-sender decoder state
+  private payloadBuffer: Uint8Array = new Uint8Array(64);
   private jitterManager: JitterBufferManager;
   private eventCallbacks: Set<VoiceEventCallback> = new Set();
   private teamOnly: boolean = false;
+  private engine: VoiceEngine | null = null;  // Receives packets instead of the JS pipeline
 
   constructor() {
     this.codec = getCodec2Encoder();
@@ -60,6 +66,13 @@ export class VoiceClient {
     this.sendBinary = callback;
   }
 
+  /**
+   * Route received packets to the native voice engine (null = decode in JS)
+   */
+  setVoiceEngine(engine: VoiceEngine | null): void {
+    this.engine = engine;
+  }
+
   /**
    * Set team-only mode
    */
@@ -105,7 +118,13 @@ export class VoiceClient {
     // Encode samples - wrap in try-catch to prevent crashes
     let payload: Uint8Array;
     try {
-      payload = this.codec.encode(samples);
+      const frames = Math.floor(samples.length / this.codec.getSamplesPerFrame());
+      const size = frames * this.codec.getBytesPerFrame();
+      if (size > this.payloadBuffer.length) {
+        this.payloadBuffer = new Uint8Array(size);
+      }
+      // serializeVoiceFrame copies the payload, so the buffer can be reused
+      payload = this.payloadBuffer.subarray(0, this.codec.encodeInto(samples, this.payloadBuffer));
     } catch (error) {
       console.error('[VoiceClient] Encode error:', error);
       return;
@@ -150,6 +169,14 @@ export class VoiceClient {
       return false;
     }
 
+    // Relay batches carry one frame per talker
+    if (data[0] === VOICE_BATCH_FRAME_TYPE) {
+      for (const single of unpackVoiceBatch(data)) {
+        this.handleBinaryData(single);
+      }
+      return true;
+    }
+
     const frame = deserializeVoiceFrame(data);
     if (!frame) {
       console.warn('[VoiceClient] Failed to deserialize voice frame');
@@ -166,13 +193,19 @@ export class VoiceClient {
       voiceLog(`[VoiceClient] Received frame #${this.debugRecvCount} from sender ${frame.senderId.toString(16)}, seq=${frame.sequence}`);
     }
 
+    // Native engine jitter-buffers and decodes on its own thread
+    if (this.engine?.running) {
+      this.engine.pushPacket(frame.senderId, frame.sequence, frame.payload);
+      return true;
+    }
+
     // Decode audio - wrap in try-catch to prevent crashes
     let samples: Int16Array;
     try {
       if (!this.codec || !this.codec.isInitialized) {
         return true;  // Codec not ready
       }
-      samples = this.codec.decode(frame.payload);
+      samples = this.getDecoder(frame.senderId).decode(frame.payload);
       if (!samples || samples.length === 0) {
         return true;  // Decoding failed
       }
@@ -196,6 +229,20 @@ export class VoiceClient {
     return true;
   }
 
+  /**
+   * Get or create the decoder for a sender
+   * Each speaker needs its own Codec2 state; sharing one mixes their streams.
+   */
+  private getDecoder(senderId: number): Codec2 {
+    let decoder = this.decoders.get(senderId);
+    if (!decoder) {
+      decoder = new Codec2(this.codec.mode);
+      void decoder.initialize();  // Synchronous for native and fallback
+      this.decoders.set(senderId, decoder);
+    }
+    return decoder;
+  }
+
   /**
    * Get next frame from jitter buffer for a sender
    * Returns null if not ready
@@ -225,6 +272,8 @@ export class VoiceClient {
    */
   resetSender(senderId: number): void {
     this.jitterManager.removeBuffer(senderId);
+    this.decoders.get(senderId)?.destroy();
+    this.decoders.delete(senderId);
   }
 
   /**
@@ -232,6 +281,10 @@ export class VoiceClient {
    */
   reset(): void {
     this.jitterManager.clear();
+    for (const decoder of this.decoders.values()) {
+      decoder.destroy();
+    }
+    this.decoders.clear();
     this.sequenceNumber = 0;
     this.startTime = Date.now();
   }
@@ -0,0 +1,170 @@
+/**
+ * VoiceEngine - Native voice receive pipeline
+ *
+ * Wraps the voice engine thread in the codec2 addon. The thread owns one
+ * jitter queue and decoder per sender, applies the same distance gain and
+ * pan as SpatialMixer, and mixes into a lock-free ring buffer. JS only
+ * pushes packets, updates positions and drains mixed audio, so a slow
+ * render frame no longer stalls voice decode.
+ */
+
+import { Vector3 } from '../engine/math/Vector3.js';
+import { getNativeCodec2, NativeCodec2, VoiceEngineStats, Codec2ModeString } from './Codec2.js';
+import { voiceLog } from './voiceLog.js';
+
+/**
+ * Native voice engine (falls back to the JS pipeline when unavailable)
+ */
+export class VoiceEngine {
+  private native: NativeCodec2 | null;
+  private isRunning = false;
+
+  constructor() {
+    const native = getNativeCodec2();
+    this.native = native && typeof native.voiceEngineStart === 'function' ? native : null;
+  }
+
+  /**
+   * Check if the native engine can be used
+   */
+  static isAvailable(): boolean {
+    const native = getNativeCodec2();
+    return !!native && typeof native.voiceEngineStart === 'function';
+  }
+
+  /**
+   * Start the engine thread
+   *
+   * @param mode Codec2 mode every sender uses
+   * @param outputRate 8000, or 48000 to upsample inside the engine
+   * @returns false if the native engine is unavailable
+   */
+  start(mode: Codec2ModeString, outputRate: number = 8000): boolean {
+    if (!this.native) return false;
+    try {
+      this.isRunning = this.native.voiceEngineStart(mode, outputRate);
+    } catch (error) {
+      voiceLog(`[VoiceEngine] Failed to start: ${error}`);
+      this.isRunning = false;
+    }
+    voiceLog(`[VoiceEngine] ${this.isRunning ? 'Started' : 'Unavailable'}, mode=${mode}, rate=${outputRate}`);
+    return this.isRunning;
+  }
+
+  /**
+   * Stop the engine thread and drop all streams
+   */
+  stop(): void {
+    if (!this.native || !this.isRunning) return;
+    this.native.voiceEngineStop();
+    this.isRunning = false;
+  }
+
+  /**
+   * Queue a received packet (one codec2 frame)
+   */
+  pushPacket(senderId: number, sequence: number, payload: Uint8Array): boolean {
+    if (!this.native || !this.isRunning) return false;
+    return this.native.voiceEnginePush(senderId >>> 0, sequence >>> 0, payload);
+  }
+
+  /**
+   * Update listener position and orientation
+   */
+  setListener(position: Vector3, yaw: number): void {
+    if (!this.native) return;
+    this.native.voiceEngineSetListener(position.x, position.y, position.z, yaw);
+  }
+
+  /**
+   * Update position for a sender
+   */
+  setSourcePosition(senderId: number, position: Vector3): void {
+    if (!this.native) return;
+    this.native.voiceEngineSetSourcePosition(senderId >>> 0, position.x, position.y, position.z);
+  }
+
+  /**
+   * Drop a sender's stream and position
+   */
+  removeSource(senderId: number): void {
+    if (!this.native) return;
+    this.native.voiceEngineRemoveSource(senderId >>> 0);
+  }
+
+  /**
+   * Drop every stream and position
+   */
+  clear(): void {
+    if (!this.native) return;
+    this.native.voiceEngineClear();
+  }
+
+  /**
+   * Set mix parameters
+   *
+   * @param maxDistance Beyond this, voices are silent
+   * @param outputVolume 0-100
+   * @param spatialEnabled false = every voice centered at full volume
+   */
+  setMix(maxDistance: number, outputVolume: number, spatialEnabled: boolean): void {
+    if (!this.native) return;
+    this.native.voiceEngineSetMix(maxDistance, outputVolume, spatialEnabled);
+  }
+
+  /**
+   * Drain mixed stereo audio (at the output rate) into a caller buffer
+   *
+   * @returns Number of int16 values written
+   */
+  read(out: Int16Array): number {
+    if (!this.native || !this.isRunning) return 0;
+    return this.native.voiceEngineRead(out);
+  }
+
+  /**
+   * Senders that played audio within the last windowMs
+   */
+  getSpeaking(windowMs: number): number[] {
+    if (!this.native || !this.isRunning) return [];
+    return this.native.voiceEngineGetSpeaking(windowMs);
+  }
+
+  /**
+   * Get engine counters
+   */
+  getStats(): VoiceEngineStats | null {
+    if (!this.native) return null;
+    return this.native.voiceEngineGetStats();
+  }
+
+  /**
+   * Check if the engine thread is running
+   */
+  get running(): boolean {
+    return this.isRunning;
+  }
+}
+
+// Singleton instance
+let engineInstance: VoiceEngine | null = null;
+
+/**
+ * Get shared VoiceEngine instance
+ */
+export function getVoiceEngine(): VoiceEngine {
+  if (!engineInstance) {
+    engineInstance = new VoiceEngine();
+  }
+  return engineInstance;
+}
+
+/**
+ * Destroy shared VoiceEngine
+ */
+export function destroyVoiceEngine(): void {
+  if (engineInstance) {
+    engineInstance.stop();
+    engineInstance = null;
+  }
+}
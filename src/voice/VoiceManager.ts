@@ -19,18 +19,22 @@ import {
   VOICE_FRAME_MS,
   truncatePlayerId,
 } from './types.js';
-import { Codec2, initializeCodec2, destroyCodec2 } from './Codec2.js';
+import { Codec2, initializeCodec2, destroyCodec2, Resampler8kTo48k, RESAMPLE_OUTPUT_RATE } from './Codec2.js';
 import { MicCapture, initializeMicCapture, destroyMicCapture } from './MicCapture.js';
 import { VADProcessor } from './VADProcessor.js';
 import { VoiceClient, getVoiceClient, destroyVoiceClient } from './VoiceClient.js';
 import { SpatialMixer, getSpatialMixer, destroySpatialMixer } from './SpatialMixer.js';
 import { VoicePlayback, getVoicePlayback, destroyVoicePlayback } from './VoicePlayback.js';
 import { VoicePostProcessor, getVoicePostProcessor, destroyVoicePostProcessor } from './VoicePostProcessor.js';
+import { VoiceEngine, getVoiceEngine, destroyVoiceEngine } from './VoiceEngine.js';
 import { voiceLog } from './voiceLog.js';
 
 // Playback tick interval (process received audio)
 const PLAYBACK_TICK_MS = 20;  // Match codec frame rate
 
+// Silence after which a speaker stops showing as speaking
+const SPEAKING_TIMEOUT_MS = 300;
+
 /**
  * Voice manager state
  */
@@ -61,6 +65,11 @@ export class VoiceManager {
   private mixer: SpatialMixer;
   private playback: VoicePlayback;
   private postProcessor: VoicePostProcessor;
+  private engine: VoiceEngine;
+  private engineBuffer: Int16Array = new Int16Array(16384);  // Drained engine output
+  private upsampler: Resampler8kTo48k | null = null;          // JS pipeline 8k -> 48k
+  private playbackSenders: number[] = [];
+  private playbackFrames: Int16Array[] = [];
 
   // State
   private localPlayerId: string = '';
@@ -86,6 +95,7 @@ export class VoiceManager {
     this.mixer = getSpatialMixer();
     this.playback = getVoicePlayback();
     this.postProcessor = getVoicePostProcessor();  // CSterm radio effects
+    this.engine = getVoiceEngine();
   }
 
   /**
@@ -111,6 +121,20 @@ export class VoiceManager {
       this.mixer.setOutputVolume(this.settings.voiceOutputVolume);
       this.mixer.setSpatialEnabled(this.settings.voiceSpatialEnabled);
 
+      // Prefer the native engine for receive (falls back to the JS pipeline).
+      // Both native paths upsample to 48kHz, which every output device supports.
+      if (this.engine.start(this.codec.modeName, RESAMPLE_OUTPUT_RATE)) {
+        this.applyEngineMix();
+        this.client.setVoiceEngine(this.engine);
+        this.playback.setSampleRate(RESAMPLE_OUTPUT_RATE);
+      } else {
+        const upsampler = new Resampler8kTo48k(2);
+        if (upsampler.isAvailable) {
+          this.upsampler = upsampler;
+          this.playback.setSampleRate(RESAMPLE_OUTPUT_RATE);
+        }
+      }
+
       this.state = 'running';
       this.emitEvent({ type: 'connected' });
     } catch (error) {
@@ -205,14 +229,31 @@ export class VoiceManager {
   // Debug counter for logging
   private debugCounter = 0;
 
+  /**
+   * Push current mix settings to the native engine
+   */
+  private applyEngineMix(): void {
+    this.engine.setMix(
+      this.settings.voiceMaxDistance,
+      this.settings.voiceOutputVolume,
+      this.settings.voiceSpatialEnabled
+    );
+  }
+
   /**
    * Process received audio for playback
    */
   private processPlayback(): void {
+    if (this.engine.running) {
+      this.processEnginePlayback();
+      return;
+    }
+
     try {
       const now = Date.now();
       const activeSenders = this.client.getActiveSenders();
-      const stereoStreams: Int16Array[] = [];
+      this.playbackSenders.length = 0;
+      this.playbackFrames.length = 0;
 
       // Debug: Log active senders periodically
       this.debugCounter++;
@@ -248,52 +289,85 @@ export class VoiceManager {
           voiceLog(`[VoiceManager] After postprocess: ${processed.length} samples, max amp: ${maxAmp}`);
         }
 
-        // Apply spatial processing
-        const stereo = this.mixer.processVoice(senderId, processed);
-        if (stereo) {
-          stereoStreams.push(stereo);
-          if (shouldLog) {
-            voiceLog(`[VoiceManager] Spatial OK: ${stereo.length} stereo samples`);
-          }
-        } else {
-          if (shouldLog) {
-            voiceLog(`[VoiceManager] Spatial returned null for sender ${senderId.toString(16)}`);
-          }
-        }
+        // Spatial processing happens in one pass in mixVoices
+        this.playbackSenders.push(senderId);
+        this.playbackFrames.push(processed);
 
         // Track speaking player
-        let speaker = this.speakingPlayers.get(senderId);
-        if (!speaker) {
-          speaker = {
-            playerId: '',  // Will be resolved from network state
-            senderId,
-            lastActivity: now,
-          };
-          this.speakingPlayers.set(senderId, speaker);
-          this.emitEvent({ type: 'speaking-start', playerId: speaker.playerId });
-        }
-        speaker.lastActivity = now;
+        this.markSpeaking(senderId, now);
       }
 
-      // Mix and play
-      if (stereoStreams.length > 0) {
-        const mixed = this.mixer.mixStreams(stereoStreams);
-        this.playback.queueFrame(mixed);
-      }
-
-      // Cleanup inactive speakers
-      for (const [senderId, speaker] of this.speakingPlayers) {
-        if (now - speaker.lastActivity > 300) {  // 300ms timeout
-          this.speakingPlayers.delete(senderId);
-          this.emitEvent({ type: 'speaking-stop', playerId: speaker.playerId });
+      // Mix and play (mixVoices reuses its buffer, so hand playback a copy)
+      const mixed = this.mixer.mixVoices(this.playbackSenders, this.playbackFrames);
+      if (mixed) {
+        if (shouldLog) {
+          voiceLog(`[VoiceManager] Mixed ${this.playbackFrames.length} streams: ${mixed.length} stereo samples`);
         }
+        const output = this.upsampler ? this.upsampler.process(mixed) : mixed;
+        this.playback.queueFrame(output.slice());
       }
+
+      this.expireSpeakers(now);
     } catch (error) {
       // Log errors instead of silently swallowing
       voiceLog(`[VoiceManager] processPlayback ERROR: ${error}`);
     }
   }
 
+  /**
+   * Forward audio mixed by the native engine to the speaker
+   * Decode and mixing already happened on the engine thread.
+   */
+  private processEnginePlayback(): void {
+    try {
+      const now = Date.now();
+
+      for (;;) {
+        const count = this.engine.read(this.engineBuffer);
+        if (count === 0) break;
+        // VoicePlayback hands the buffer to the speaker asynchronously, so copy it
+        this.playback.queueFrame(this.engineBuffer.slice(0, count));
+        if (count < this.engineBuffer.length) break;
+      }
+
+      for (const senderId of this.engine.getSpeaking(PLAYBACK_TICK_MS * 2)) {
+        this.markSpeaking(senderId, now);
+      }
+      this.expireSpeakers(now);
+    } catch (error) {
+      voiceLog(`[VoiceManager] processEnginePlayback ERROR: ${error}`);
+    }
+  }
+
+  /**
+   * Track a sender as speaking
+   */
+  private markSpeaking(senderId: number, now: number): void {
+    let speaker = this.speakingPlayers.get(senderId);
+    if (!speaker) {
+      speaker = {
+        playerId: '',  // Will be resolved from network state
+        senderId,
+        lastActivity: now,
+      };
+      this.speakingPlayers.set(senderId, speaker);
+      this.emitEvent({ type: 'speaking-start', playerId: speaker.playerId });
+    }
+    speaker.lastActivity = now;
+  }
+
+  /**
+   * Cleanup inactive speakers
+   */
+  private expireSpeakers(now: number): void {
+    for (const [senderId, speaker] of this.speakingPlayers) {
+      if (now - speaker.lastActivity > SPEAKING_TIMEOUT_MS) {
+        this.speakingPlayers.delete(senderId);
+        this.emitEvent({ type: 'speaking-stop', playerId: speaker.playerId });
+      }
+    }
+  }
+
   /**
    * Handle binary data from network
    * Returns true if it was a voice frame
@@ -324,6 +398,7 @@ export class VoiceManager {
     this.localPosition = position.clone();
     this.localYaw = yaw;
     this.mixer.setListenerPosition(position, yaw);
+    this.engine.setListener(position, yaw);
   }
 
   /**
@@ -332,6 +407,7 @@ export class VoiceManager {
   updatePlayerPosition(playerId: string, position: Vector3): void {
     const senderId = truncatePlayerId(playerId);
     this.mixer.updateStreamPosition(senderId, position);
+    this.engine.setSourcePosition(senderId, position);
 
     // Update speaking player mapping
     const speaker = this.speakingPlayers.get(senderId);
@@ -346,6 +422,7 @@ export class VoiceManager {
   removePlayer(playerId: string): void {
     const senderId = truncatePlayerId(playerId);
     this.mixer.removeStream(senderId);
+    this.engine.removeSource(senderId);
     this.client.resetSender(senderId);
     this.speakingPlayers.delete(senderId);
   }
@@ -383,6 +460,9 @@ export class VoiceManager {
     if ('voiceSpatialEnabled' in settings) {
       this.mixer.setSpatialEnabled(this.settings.voiceSpatialEnabled);
     }
+    if ('voiceMaxDistance' in settings || 'voiceOutputVolume' in settings || 'voiceSpatialEnabled' in settings) {
+      this.applyEngineMix();
+    }
     if ('voiceInputDevice' in settings && this.mic) {
       this.mic.setInputDevice(this.settings.voiceInputDevice);
     }
@@ -489,6 +569,8 @@ export class VoiceManager {
   destroy(): void {
     this.stop();
 
+    this.client.setVoiceEngine(null);
+    destroyVoiceEngine();
     destroyCodec2();
     destroyMicCapture();
     destroyVoiceClient();
@@ -8,8 +8,8 @@ import Speaker from 'speaker';
 import { VOICE_SAMPLE_RATE } from './types.js';
 import { voiceLog } from './voiceLog.js';
 
-// Output format - 16-bit stereo at voice sample rate
-const OUTPUT_SAMPLE_RATE = VOICE_SAMPLE_RATE; // 8kHz
+// Output format - 16-bit stereo, at the voice sample rate unless upsampled
+const DEFAULT_SAMPLE_RATE = VOICE_SAMPLE_RATE; // 8kHz
 const OUTPUT_CHANNELS = 2;
 const OUTPUT_BIT_DEPTH = 16;
 
@@ -19,6 +19,7 @@ const OUTPUT_BIT_DEPTH = 16;
 export class VoicePlayback {
   private speaker: Speaker | null = null;
   private isPlaying = false;
+  private sampleRate = DEFAULT_SAMPLE_RATE;
 
   // Stats
   private frameCount = 0;
@@ -27,20 +28,40 @@ export class VoicePlayback {
 
   constructor() {}
 
+  /**
+   * Set the output sample rate (restarts the stream if it changed)
+   *
+   * @param rate 8000 for raw codec output, 48000 when upsampled
+   */
+  setSampleRate(rate: number): void {
+    if (rate === this.sampleRate) return;
+    const wasPlaying = this.isPlaying;
+    this.stop();
+    this.sampleRate = rate;
+    if (wasPlaying) this.start();
+  }
+
+  /**
+   * Get the output sample rate
+   */
+  getSampleRate(): number {
+    return this.sampleRate;
+  }
+
   /**
    * Start the audio stream
    */
   start(): void {
     if (this.isPlaying) return;
 
-    voiceLog(`[VoicePlayback] Starting streaming playback at ${OUTPUT_SAMPLE_RATE}Hz stereo`);
+    voiceLog(`[VoicePlayback] Starting streaming playback at ${this.sampleRate}Hz stereo`);
 
     try {
       // Create the speaker - it will start playing when we write to it
       this.speaker = new Speaker({
         channels: OUTPUT_CHANNELS,
         bitDepth: OUTPUT_BIT_DEPTH,
-        sampleRate: OUTPUT_SAMPLE_RATE,
+        sampleRate: this.sampleRate,
         signed: true,
       });
 
@@ -70,7 +91,7 @@ export class VoicePlayback {
   /**
    * Queue a stereo audio frame for playback
    *
-   * @param samples Stereo interleaved 16-bit samples at 8kHz
+   * @param samples Stereo interleaved 16-bit samples at the output sample rate
    */
   queueFrame(samples: Int16Array): void {
     if (!this.speaker) {
@@ -72,6 +72,13 @@ export {
   destroySpatialMixer,
 } from './SpatialMixer.js';
 
+// Native voice engine (off-thread jitter/decode/mix)
+export {
+  VoiceEngine,
+  getVoiceEngine,
+  destroyVoiceEngine,
+} from './VoiceEngine.js';
+
 // Voice playback
 export {
   VoicePlayback,
@@ -11,11 +11,13 @@ import {
   VoiceFrame,
   DecodedVoiceFrame,
   VOICE_FRAME_TYPE,
+  VOICE_BATCH_FRAME_TYPE,
   VOICE_FRAME_MS,
   VOICE_FLAG_VAD,
   serializeVoiceFrame,
   deserializeVoiceFrame,
   isVoiceFrame,
+  unpackVoiceBatch,
   truncatePlayerId,
 } from '../types.js';
 import { Codec2, initializeCodec2 } from '../Codec2.js';
@@ -157,6 +159,12 @@ export class HeadlessVoiceClient {
       this.handleVoiceFrame(data);
       return;
     }
+    if (data.length > 0 && data[0] === VOICE_BATCH_FRAME_TYPE) {
+      for (const frame of unpackVoiceBatch(new Uint8Array(data.buffer, data.byteOffset, data.length))) {
+        this.handleVoiceFrame(Buffer.from(frame.buffer, frame.byteOffset, frame.length));
+      }
+      return;
+    }
 
     // Handle JSON message
     try {
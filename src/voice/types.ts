@@ -6,12 +6,18 @@
 
 // Binary protocol constants
 export const VOICE_FRAME_TYPE = 0x01;
+export const VOICE_BATCH_FRAME_TYPE = 0x02;  // Server relay: several frames in one message
 export const VOICE_HEADER_SIZE = 12;  // Header size (frameType + flags + senderId + seq + timestamp)
 // Payload size varies: 6 bytes for native Codec2 2400, 16 bytes for LPC fallback
 export const VOICE_SAMPLE_RATE = 8000;
 export const VOICE_FRAME_SAMPLES = 160; // 20ms at 8kHz
 export const VOICE_FRAME_MS = 20;
 
+// Voice max distance setting bounds (game units); the server relay's
+// proximity range (VoiceRelay.ts) is derived from the maximum
+export const VOICE_MIN_DISTANCE = 10;
+export const VOICE_MAX_DISTANCE = 200;
+
 // Voice frame flags
 export const VOICE_FLAG_VAD = 0x01;      // Bit 0: Voice activity detected
 export const VOICE_FLAG_TEAM_ONLY = 0x02; // Bit 1: Team-only broadcast
@@ -196,10 +202,38 @@ export function deserializeVoiceFrame(data: Uint8Array): VoiceFrame | null {
 }
 
 /**
- * Check if a binary message is a voice frame
+ * Check if a binary message is a voice frame (or a relay batch of them)
  */
 export function isVoiceFrame(data: Uint8Array): boolean {
-  return data.length >= 1 && data[0] === VOICE_FRAME_TYPE;
+  return data.length >= 1 && (data[0] === VOICE_FRAME_TYPE || data[0] === VOICE_BATCH_FRAME_TYPE);
+}
+
+/**
+ * Split a relayed message into single voice frames
+ *
+ * Batch layout:
+ * 0       1     frameType (0x02)
+ * 1       1     frame count
+ * 2       ...   count x ([u16 LE length][voice frame])
+ *
+ * A plain voice frame is returned as-is. Frames are views into data.
+ */
+export function unpackVoiceBatch(data: Uint8Array): Uint8Array[] {
+  if (data.length < 1) return [];
+  if (data[0] === VOICE_FRAME_TYPE) return [data];
+  if (data[0] !== VOICE_BATCH_FRAME_TYPE || data.length < 2) return [];
+
+  const frames: Uint8Array[] = [];
+  const count = data[1];
+  let offset = 2;
+  for (let i = 0; i < count && offset + 2 <= data.length; i++) {
+    const length = data[offset] | (data[offset + 1] << 8);
+    offset += 2;
+    if (offset + length > data.length) break;
+    frames.push(data.subarray(offset, offset + length));
+    offset += length;
+  }
+  return frames;
 }
 
 /**